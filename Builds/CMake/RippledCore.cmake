@@ -60,6 +60,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/basics/impl/IOUAmount.cpp
   src/ripple/basics/impl/Log.cpp
   src/ripple/basics/impl/Number.cpp
+  src/ripple/basics/impl/parallel.cpp
   src/ripple/basics/impl/StringUtilities.cpp
   #[===============================[
     main sources:
@@ -69,6 +70,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/json/impl/Object.cpp
   src/ripple/json/impl/Output.cpp
   src/ripple/json/impl/Writer.cpp
+  src/ripple/json/impl/json_arena.cpp
   src/ripple/json/impl/json_reader.cpp
   src/ripple/json/impl/json_value.cpp
   src/ripple/json/impl/json_valueiterator.cpp
@@ -86,6 +88,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/protocol/impl/Indexes.cpp
   src/ripple/protocol/impl/InnerObjectFormats.cpp
   src/ripple/protocol/impl/Issue.cpp
+  src/ripple/protocol/impl/JsonMembers.cpp
   src/ripple/protocol/impl/Keylet.cpp
   src/ripple/protocol/impl/LedgerFormats.cpp
   src/ripple/protocol/impl/PublicKey.cpp
@@ -117,6 +120,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/protocol/impl/TxMeta.cpp
   src/ripple/protocol/impl/UintTypes.cpp
   src/ripple/protocol/impl/digest.cpp
+  src/ripple/protocol/impl/sha512_batch.cpp
   src/ripple/protocol/impl/tokens.cpp
   #[===============================[
     main sources:
@@ -193,6 +197,7 @@ install (
     src/ripple/json/Object.h
     src/ripple/json/Output.h
     src/ripple/json/Writer.h
+    src/ripple/json/json_arena.h
     src/ripple/json/json_forwards.h
     src/ripple/json/json_reader.h
     src/ripple/json/json_value.h
@@ -215,6 +220,7 @@ install (
     src/ripple/protocol/Indexes.h
     src/ripple/protocol/InnerObjectFormats.h
     src/ripple/protocol/Issue.h
+    src/ripple/protocol/JsonMembers.h
     src/ripple/protocol/KeyType.h
     src/ripple/protocol/Keylet.h
     src/ripple/protocol/KnownFormats.h
@@ -351,7 +357,6 @@ target_sources (rippled PRIVATE
   src/ripple/app/ledger/AcceptedLedger.cpp
   src/ripple/app/ledger/AcceptedLedgerTx.cpp
   src/ripple/app/ledger/AccountStateSF.cpp
-  src/ripple/app/ledger/BookListeners.cpp
   src/ripple/app/ledger/ConsensusTransSetSF.cpp
   src/ripple/app/ledger/Ledger.cpp
   src/ripple/app/ledger/LedgerHistory.cpp
@@ -372,6 +377,8 @@ target_sources (rippled PRIVATE
   src/ripple/app/ledger/impl/LocalTxs.cpp
   src/ripple/app/ledger/impl/OpenLedger.cpp
   src/ripple/app/ledger/impl/SkipListAcquire.cpp
+  src/ripple/app/ledger/impl/StateExport.cpp
+  src/ripple/app/ledger/impl/SpeculativeApply.cpp
   src/ripple/app/ledger/impl/TimeoutCounter.cpp
   src/ripple/app/ledger/impl/TransactionAcquire.cpp
   src/ripple/app/ledger/impl/TransactionMaster.cpp
@@ -397,6 +404,7 @@ target_sources (rippled PRIVATE
   src/ripple/app/misc/impl/AmendmentTable.cpp
   src/ripple/app/misc/impl/LoadFeeTrack.cpp
   src/ripple/app/misc/impl/Manifest.cpp
+  src/ripple/app/misc/impl/SubscriptionMatcher.cpp
   src/ripple/app/misc/impl/Transaction.cpp
   src/ripple/app/misc/impl/TxQ.cpp
   src/ripple/app/misc/impl/ValidatorKeys.cpp
@@ -415,11 +423,15 @@ target_sources (rippled PRIVATE
   src/ripple/app/paths/impl/DirectStep.cpp
   src/ripple/app/paths/impl/PaySteps.cpp
   src/ripple/app/paths/impl/XRPEndpointStep.cpp
+  src/ripple/app/rdb/backend/detail/impl/LedgerWriter.cpp
   src/ripple/app/rdb/backend/detail/impl/Node.cpp
   src/ripple/app/rdb/backend/detail/impl/Shard.cpp
+  src/ripple/app/rdb/backend/detail/impl/TxIndex.cpp
   src/ripple/app/rdb/backend/impl/PostgresDatabase.cpp
   src/ripple/app/rdb/backend/impl/SQLiteDatabase.cpp
+  src/ripple/app/rdb/backend/impl/TxIndexDatabase.cpp
   src/ripple/app/rdb/impl/Download.cpp
+  src/ripple/app/rdb/impl/MigrateTxIndex.cpp
   src/ripple/app/rdb/impl/PeerFinder.cpp
   src/ripple/app/rdb/impl/RelationalDatabase.cpp
   src/ripple/app/rdb/impl/ShardArchive.cpp
@@ -442,6 +454,7 @@ target_sources (rippled PRIVATE
   src/ripple/app/tx/impl/Escrow.cpp
   src/ripple/app/tx/impl/GenesisMint.cpp
   src/ripple/app/tx/impl/Import.cpp
+  src/ripple/app/tx/impl/ImportVLCache.cpp
   src/ripple/app/tx/impl/InvariantCheck.cpp
   src/ripple/app/tx/impl/Invoke.cpp
   src/ripple/app/tx/impl/NFTokenAcceptOffer.cpp
@@ -465,6 +478,9 @@ target_sources (rippled PRIVATE
   src/ripple/app/tx/impl/apply.cpp
   src/ripple/app/tx/impl/applySteps.cpp
   src/ripple/app/hook/impl/applyHook.cpp
+  src/ripple/app/hook/impl/HookStateMap.cpp
+  src/ripple/app/hook/impl/ModuleCache.cpp
+  src/ripple/app/hook/impl/ModuleCompiler.cpp
   src/ripple/app/tx/impl/details/NFTokenUtils.cpp
   #[===============================[
      main sources:
@@ -550,11 +566,14 @@ target_sources (rippled PRIVATE
   src/ripple/nodestore/impl/DeterministicShard.cpp
   src/ripple/nodestore/impl/DecodedBlob.cpp
   src/ripple/nodestore/impl/DummyScheduler.cpp
+  src/ripple/nodestore/impl/IoUring.cpp
   src/ripple/nodestore/impl/ManagerImp.cpp
   src/ripple/nodestore/impl/NodeObject.cpp
+  src/ripple/nodestore/impl/NuDBPrefetcher.cpp
   src/ripple/nodestore/impl/Shard.cpp
   src/ripple/nodestore/impl/ShardInfo.cpp
   src/ripple/nodestore/impl/TaskQueue.cpp
+  src/ripple/nodestore/impl/ZstdDictionary.cpp
   #[===============================[
      main sources:
        subdir: overlay
@@ -620,6 +639,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/LedgerData.cpp
   src/ripple/rpc/handlers/LedgerDiff.cpp
   src/ripple/rpc/handlers/LedgerEntry.cpp
+  src/ripple/rpc/handlers/LedgerExport.cpp
   src/ripple/rpc/handlers/LedgerHandler.cpp
   src/ripple/rpc/handlers/LedgerHeader.cpp
   src/ripple/rpc/handlers/LedgerRequest.cpp
@@ -667,6 +687,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/impl/ServerHandlerImp.cpp
   src/ripple/rpc/impl/ShardArchiveHandler.cpp
   src/ripple/rpc/impl/ShardVerificationScheduler.cpp
+  src/ripple/rpc/impl/StateExportWriter.cpp
   src/ripple/rpc/impl/Status.cpp
   src/ripple/rpc/impl/TransactionSign.cpp
   #[===============================[
@@ -718,12 +739,16 @@ if (tests)
     src/test/app/Freeze_test.cpp
     src/test/app/GenesisMint_test.cpp
     src/test/app/HashRouter_test.cpp
+    src/test/app/HookModuleCache_test.cpp
+    src/test/app/HookStateMap_test.cpp
     src/test/app/Import_test.cpp
+    src/test/app/ImportVLCache_test.cpp
     src/test/app/Invoke_test.cpp
     src/test/app/LedgerHistory_test.cpp
     src/test/app/LedgerLoad_test.cpp
     src/test/app/LedgerMaster_test.cpp
     src/test/app/LedgerReplay_test.cpp
+    src/test/app/LedgerWriter_test.cpp
     src/test/app/LoadFeeTrack_test.cpp
     src/test/app/Manifest_test.cpp
     src/test/app/MultiSign_test.cpp
@@ -733,6 +758,7 @@ if (tests)
     src/test/app/NFTokenDir_test.cpp
     src/test/app/OfferStream_test.cpp
     src/test/app/Offer_test.cpp
+    src/test/app/OrderBookDB_test.cpp
     src/test/app/OversizeMeta_test.cpp
     src/test/app/Path_test.cpp
     src/test/app/PayChan_test.cpp
@@ -746,11 +772,13 @@ if (tests)
     src/test/app/SetAuth_test.cpp
     src/test/app/SetRegularKey_test.cpp
     src/test/app/SetTrust_test.cpp
+    src/test/app/SubscriptionMatcher_test.cpp
     src/test/app/Taker_test.cpp
     src/test/app/TheoreticalQuality_test.cpp
     src/test/app/Ticket_test.cpp
     src/test/app/Transaction_ordering_test.cpp
     src/test/app/TrustAndBalance_test.cpp
+    src/test/app/TxIndex_test.cpp
     src/test/app/TxQ_test.cpp
     src/test/app/URIToken_test.cpp
     src/test/app/ValidatorKeys_test.cpp
@@ -769,8 +797,10 @@ if (tests)
     src/test/basics/DetectCrash_test.cpp
     src/test/basics/Expected_test.cpp
     src/test/basics/FileUtilities_test.cpp
+    src/test/basics/IntrusivePointer_test.cpp
     src/test/basics/IOUAmount_test.cpp
     src/test/basics/KeyCache_test.cpp
+    src/test/basics/MPSCQueue_test.cpp
     src/test/basics/Number_test.cpp
     src/test/basics/PerfLog_test.cpp
     src/test/basics/RangeSet_test.cpp
@@ -786,6 +816,7 @@ if (tests)
     src/test/basics/hardened_hash_test.cpp
     src/test/basics/join_test.cpp
     src/test/basics/mulDiv_test.cpp
+    src/test/basics/parallel_test.cpp
     src/test/basics/tagged_integer_test.cpp
     #[===============================[
        test sources:
@@ -827,6 +858,7 @@ if (tests)
     #]===============================]
     src/test/core/ClosureCounter_test.cpp
     src/test/core/Config_test.cpp
+    src/test/core/CoroTask_test.cpp
     src/test/core/Coroutine_test.cpp
     src/test/core/CryptoPRNG_test.cpp
     src/test/core/JobQueue_test.cpp
@@ -849,6 +881,7 @@ if (tests)
     src/test/json/Object_test.cpp
     src/test/json/Output_test.cpp
     src/test/json/Writer_test.cpp
+    src/test/json/json_arena_test.cpp
     src/test/json/json_value_test.cpp
     #[===============================[
        test sources:
@@ -928,9 +961,11 @@ if (tests)
     src/test/nodestore/Basics_test.cpp
     src/test/nodestore/DatabaseShard_test.cpp
     src/test/nodestore/Database_test.cpp
+    src/test/nodestore/NuDBPrefetcher_test.cpp
     src/test/nodestore/Timing_test.cpp
     src/test/nodestore/import_test.cpp
     src/test/nodestore/varint_test.cpp
+    src/test/nodestore/zstd_test.cpp
     #[===============================[
        test sources:
          subdir: overlay
@@ -955,6 +990,7 @@ if (tests)
     src/test/protocol/BuildInfo_test.cpp
     src/test/protocol/InnerObjectFormats_test.cpp
     src/test/protocol/Issue_test.cpp
+    src/test/protocol/JsonMembers_test.cpp
     src/test/protocol/Hooks_test.cpp
     src/test/protocol/Memo_test.cpp
     src/test/protocol/PublicKey_test.cpp
@@ -997,6 +1033,7 @@ if (tests)
     src/test/rpc/KeyGeneration_test.cpp
     src/test/rpc/LedgerClosed_test.cpp
     src/test/rpc/LedgerData_test.cpp
+    src/test/rpc/LedgerExport_test.cpp
     src/test/rpc/LedgerRPC_test.cpp
     src/test/rpc/LedgerRequestRPC_test.cpp
     src/test/rpc/ManifestRPC_test.cpp
@@ -1032,6 +1069,8 @@ if (tests)
          subdir: shamap
     #]===============================]
     src/test/shamap/FetchPack_test.cpp
+    src/test/shamap/SHAMapHash_test.cpp
+    src/test/shamap/SHAMapNode_test.cpp
     src/test/shamap/SHAMapSync_test.cpp
     src/test/shamap/SHAMap_test.cpp
     #[===============================[
@@ -0,0 +1,81 @@
+#[===================================================================[
+   NIH dep: zstd
+#]===================================================================]
+
+add_library (zstd_lib STATIC IMPORTED GLOBAL)
+
+if (NOT WIN32)
+  find_package(zstd)
+endif()
+
+if(zstd)
+  set_target_properties (zstd_lib PROPERTIES
+    IMPORTED_LOCATION_DEBUG
+      ${zstd}
+    IMPORTED_LOCATION_RELEASE
+      ${zstd}
+    INTERFACE_INCLUDE_DIRECTORIES
+      ${ZSTD_INCLUDE_DIR})
+
+else()
+  ExternalProject_Add (zstd
+    PREFIX ${nih_cache_path}
+    GIT_REPOSITORY https://github.com/facebook/zstd.git
+    GIT_TAG v1.5.5
+    SOURCE_SUBDIR build/cmake
+    CMAKE_ARGS
+      -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+      -DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}
+      $<$<BOOL:${CMAKE_VERBOSE_MAKEFILE}>:-DCMAKE_VERBOSE_MAKEFILE=ON>
+      -DCMAKE_DEBUG_POSTFIX=_d
+      $<$<NOT:$<BOOL:${is_multiconfig}>>:-DCMAKE_BUILD_TYPE=${CMAKE_BUILD_TYPE}>
+      -DZSTD_BUILD_STATIC=ON
+      -DZSTD_BUILD_SHARED=OFF
+      -DZSTD_BUILD_PROGRAMS=OFF
+      -DZSTD_BUILD_TESTS=OFF
+      -DZSTD_LEGACY_SUPPORT=OFF
+      $<$<BOOL:${MSVC}>:
+        "-DCMAKE_C_FLAGS=-GR -Gd -fp:precise -FS -MP"
+        "-DCMAKE_C_FLAGS_DEBUG=-MTd"
+        "-DCMAKE_C_FLAGS_RELEASE=-MT"
+      >
+    LOG_BUILD ON
+    LOG_CONFIGURE ON
+    BUILD_COMMAND
+      ${CMAKE_COMMAND}
+      --build .
+      --config $<CONFIG>
+      --target libzstd_static
+      --parallel ${ep_procs}
+      $<$<BOOL:${is_multiconfig}>:
+        COMMAND
+          ${CMAKE_COMMAND} -E copy
+          <BINARY_DIR>/lib/$<CONFIG>/${ep_lib_prefix}zstd$<$<CONFIG:Debug>:_d>${ep_lib_suffix}
+          <BINARY_DIR>/lib
+        >
+    TEST_COMMAND ""
+    INSTALL_COMMAND ""
+    BUILD_BYPRODUCTS
+      <BINARY_DIR>/lib/${ep_lib_prefix}zstd${ep_lib_suffix}
+      <BINARY_DIR>/lib/${ep_lib_prefix}zstd_d${ep_lib_suffix}
+  )
+  ExternalProject_Get_Property (zstd BINARY_DIR)
+  ExternalProject_Get_Property (zstd SOURCE_DIR)
+
+  set_target_properties (zstd_lib PROPERTIES
+    IMPORTED_LOCATION_DEBUG
+      ${BINARY_DIR}/lib/${ep_lib_prefix}zstd_d${ep_lib_suffix}
+    IMPORTED_LOCATION_RELEASE
+      ${BINARY_DIR}/lib/${ep_lib_prefix}zstd${ep_lib_suffix}
+    INTERFACE_INCLUDE_DIRECTORIES
+      ${SOURCE_DIR}/lib)
+
+  if (CMAKE_VERBOSE_MAKEFILE)
+    print_ep_logs (zstd)
+  endif ()
+  add_dependencies (zstd_lib zstd)
+  exclude_if_included (zstd)
+endif()
+
+target_link_libraries (ripple_libs INTERFACE zstd_lib)
+exclude_if_included (zstd_lib)
@@ -0,0 +1,179 @@
+#ifndef HOOK_HOOKSTATEMAP_INCLUDED
+#define HOOK_HOOKSTATEMAP_INCLUDED 1
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/protocol/AccountID.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hook {
+
+/**
+ * Read and write cache for hook state, preserved across the execution of the
+ * set of hook chains run for the current transaction. It is committed to the
+ * ledger only upon tesSUCCESS for the otxn.
+ *
+ * Entries are held in a flat open addressing table keyed by
+ * (account, namespace, key), and their values are copied into an arena owned
+ * by the map, so that a cache hit costs a single probe and no allocation. The
+ * arena is released in one piece when the map is destroyed or cleared.
+ *
+ * Pointers to entries are invalidated by insert(). Iteration order is
+ * insertion order. Callers that need a deterministic order
+ * when writing to the ledger use sortedModified().
+ */
+class HookStateMap
+{
+public:
+    struct Key
+    {
+        ripple::AccountID account;
+        ripple::uint256 ns;
+        ripple::uint256 key;
+
+        bool
+        operator==(Key const&) const = default;
+
+        template <class Hasher>
+        friend void
+        hash_append(Hasher& h, Key const& k) noexcept
+        {
+            using beast::hash_append;
+            hash_append(h, k.account, k.ns, k.key);
+        }
+    };
+
+    struct Entry
+    {
+        Key id;
+        bool modified;  // differs from the ledger value
+        std::uint8_t* data;
+        std::uint32_t size;
+        std::uint32_t capacity;
+
+        ripple::Slice
+        value() const
+        {
+            return {data, size};
+        }
+    };
+
+    // per account bookkeeping used to enforce reserves and namespace limits
+    struct Account
+    {
+        std::int64_t availableReserves;  // remaining available ownercount
+        std::int64_t namespaceCount;     // total namespace count
+        std::vector<ripple::uint256> namespaces;  // namespaces seen so far
+    };
+
+    HookStateMap() = default;
+    HookStateMap(HookStateMap const&) = delete;
+    HookStateMap&
+    operator=(HookStateMap const&) = delete;
+
+    Account*
+    findAccount(ripple::AccountID const& account);
+
+    Account&
+    insertAccount(
+        ripple::AccountID const& account,
+        std::int64_t availableReserves,
+        std::int64_t namespaceCount);
+
+    // true if any entry of this account and namespace has been cached
+    bool
+    hasNamespace(ripple::AccountID const& account, ripple::uint256 const& ns)
+        const;
+
+    Entry*
+    find(
+        ripple::AccountID const& account,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key);
+
+    Entry const*
+    find(
+        ripple::AccountID const& account,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key) const;
+
+    // the account must already have been inserted and the entry must not
+    Entry&
+    insert(
+        ripple::AccountID const& account,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key,
+        bool modified,
+        ripple::Slice value);
+
+    // replace an entry's value, reusing its storage when it fits
+    void
+    assign(Entry& entry, ripple::Slice value);
+
+    // modified entries ordered by account, namespace and key
+    std::vector<Entry const*>
+    sortedModified() const;
+
+    std::vector<Entry>::const_iterator
+    begin() const
+    {
+        return entries_.begin();
+    }
+
+    std::vector<Entry>::const_iterator
+    end() const
+    {
+        return entries_.end();
+    }
+
+    std::size_t
+    size() const
+    {
+        return entries_.size();
+    }
+
+    // bytes held by the value arena
+    std::size_t
+    arenaBytes() const;
+
+    void
+    clear();
+
+    // compares contents, independent of insertion order
+    bool
+    operator==(HookStateMap const& other) const;
+
+    // track the number of total modified
+    std::uint32_t modified_entry_count = 0;
+
+private:
+    static constexpr std::uint32_t empty = 0xFFFFFFFF;
+    static constexpr std::size_t blockSize = 16 * 1024;
+
+    std::uint8_t*
+    allocate(std::size_t size);
+
+    std::size_t
+    probe(Key const& k) const;
+
+    void
+    rehash(std::size_t capacity);
+
+    ripple::hardened_hash<> hasher_;
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> slots_;  // indexes into entries_, or empty
+    ripple::hardened_hash_map<ripple::AccountID, Account> accounts_;
+
+    std::vector<std::unique_ptr<std::uint8_t[]>> blocks_;
+    std::uint8_t* current_ = nullptr;  // block being carved up
+    std::size_t blockUsed_ = blockSize;
+    std::size_t arenaBytes_ = 0;
+};
+
+}  // namespace hook
+
+#endif
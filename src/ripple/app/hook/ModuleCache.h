@@ -0,0 +1,126 @@
+#ifndef HOOK_MODULECACHE_INCLUDED
+#define HOOK_MODULECACHE_INCLUDED 1
+#include <ripple/basics/Expected.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <wasmedge/wasmedge.h>
+
+namespace hook {
+
+/**
+ * Process-wide cache of parsed and validated hook modules.
+ *
+ * A HookDefinition's bytecode is immutable and identified by its HookHash, so
+ * the result of parsing and validating it can be shared by every execution of
+ * that hook. An execution then only needs to instantiate the cached module,
+ * which gives it a fresh memory, table and globals bound to its own import
+ * object.
+ *
+ * The cache is bounded both by entry count and by the total size of the
+ * bytecode it holds, evicting the least recently used module first. Evicted
+ * modules remain alive until the last execution holding them completes.
+ *
+ * Each entry also counts how often it has been fetched so that hot hooks can
+ * be promoted to a natively compiled module (see ModuleCompiler.h). Once
+ * installed, the native module is handed out in place of the interpreted one.
+ */
+class ModuleCache
+{
+public:
+    using Module = std::shared_ptr<WasmEdge_ASTModuleContext const>;
+
+    static constexpr std::size_t defaultMaxEntries = 1024;
+    static constexpr std::size_t defaultMaxBytes = 64 * 1024 * 1024;
+
+    explicit ModuleCache(
+        std::size_t maxEntries = defaultMaxEntries,
+        std::size_t maxBytes = defaultMaxBytes);
+
+    ModuleCache(ModuleCache const&) = delete;
+    ModuleCache&
+    operator=(ModuleCache const&) = delete;
+
+    // the cache shared by all hook executions in this process
+    static ModuleCache&
+    instance();
+
+    /**
+     * Return the validated module for hookHash. On a miss the supplied
+     * bytecode is parsed and validated and, if that succeeds, cached.
+     * Modules which fail to load are never cached.
+     */
+    ripple::Expected<Module, std::string>
+    fetch(ripple::uint256 const& hookHash, void const* wasm, std::size_t len);
+
+    // parse and validate a module without touching any cache
+    static ripple::Expected<Module, std::string>
+    load(void const* wasm, std::size_t len);
+
+    /**
+     * Claim the native compilation of a cached module. Returns true exactly
+     * once per cache entry, when the entry has been fetched at least
+     * threshold times and is still interpreted.
+     */
+    bool
+    claimCompilation(ripple::uint256 const& hookHash, std::uint64_t threshold);
+
+    /**
+     * Replace the cached module for hookHash with a natively compiled one.
+     * Returns false if the entry was evicted in the meantime, in which case
+     * the module is not retained.
+     */
+    bool
+    installNative(ripple::uint256 const& hookHash, Module module);
+
+    bool
+    isNative(ripple::uint256 const& hookHash) const;
+
+    void
+    clear();
+
+    std::size_t
+    size() const;
+
+    std::size_t
+    bytes() const;
+
+    std::uint64_t
+    hits() const;
+
+    std::uint64_t
+    misses() const;
+
+private:
+    struct Entry
+    {
+        Module module;
+        std::size_t bytes;
+        std::list<ripple::uint256>::iterator lru;
+        std::uint64_t fetches = 0;
+        bool compileClaimed = false;  // never retried, even on failure
+        bool native = false;
+    };
+
+    // evict least recently used entries until the cache is within bounds
+    void
+    trim(std::lock_guard<std::mutex> const&);
+
+    std::size_t const maxEntries_;
+    std::size_t const maxBytes_;
+
+    mutable std::mutex mutex_;
+    ripple::hardened_hash_map<ripple::uint256, Entry> map_;
+    std::list<ripple::uint256> lru_;  // most recently used at the front
+    std::size_t bytes_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+}  // namespace hook
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef HOOK_MODULECOMPILER_INCLUDED
+#define HOOK_MODULECOMPILER_INCLUDED 1
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/basics/Blob.h>
+#include <boost/filesystem.hpp>
+#include <optional>
+#include <string>
+
+namespace ripple {
+class Application;
+class Config;
+}  // namespace ripple
+
+namespace hook {
+
+/**
+ * Ahead of time (native) compilation tier for hot hooks.
+ *
+ * Hooks start out interpreted. Once a HookDefinition has been executed
+ * [hooks] aot_threshold times a job compiles its bytecode to native code
+ * stored under the node's database_path, keyed by HookHash, and the
+ * ModuleCache entry is switched over to the native module. The artifact is
+ * reused after a restart instead of being compiled again.
+ *
+ * Each artifact has a header file next to it recording the hash of the
+ * bytecode it was compiled from, the WasmEdge version and compiler options
+ * used, and the hash of the artifact itself. An artifact whose header does
+ * not match exactly is never loaded, it is compiled again.
+ *
+ * Native modules are compiled with instruction counting so that
+ * HookInstructionCount, and therefore hook fees, are the same in both tiers.
+ */
+
+// the directory holding native artifacts, empty if the tier is disabled
+boost::filesystem::path
+nativeModuleDir(ripple::Config const& config);
+
+boost::filesystem::path
+nativeModulePath(
+    boost::filesystem::path const& dir,
+    ripple::uint256 const& hookHash);
+
+// the header describing the artifact at `path`
+boost::filesystem::path
+nativeHeaderPath(boost::filesystem::path const& path);
+
+// compile bytecode to a native artifact at `out`, replacing it and its
+// header atomically. Returns an error description on failure.
+std::optional<std::string>
+compileNative(
+    void const* wasm,
+    std::size_t len,
+    boost::filesystem::path const& out);
+
+// load and validate a native artifact produced by compileNative from
+// the bytecode whose hash is `bytecodeHash`. Fails if the header is missing
+// or does not match the bytecode, this build or the artifact.
+ripple::Expected<ModuleCache::Module, std::string>
+loadNative(
+    boost::filesystem::path const& path,
+    ripple::uint256 const& bytecodeHash);
+
+/**
+ * Called after each execution of a hook. When the hook has become hot and
+ * the tier is enabled, its native compilation is queued on the JobQueue.
+ */
+void
+promoteIfHot(
+    ripple::Application& app,
+    ripple::uint256 const& hookHash,
+    ripple::Blob const& wasm);
+
+}  // namespace hook
+
+#endif
@@ -1,8 +1,10 @@
 #ifndef APPLY_HOOK_INCLUDED
 #define APPLY_HOOK_INCLUDED 1
 #include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/HookStateMap.h>
 #include <ripple/app/hook/Macro.h>
 #include <ripple/app/hook/Misc.h>
+#include <ripple/app/hook/ModuleCache.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/tx/impl/ApplyContext.h>
 #include <ripple/basics/Blob.h>
@@ -23,30 +25,21 @@ struct HookResult;
 bool
 isEmittedTxn(ripple::STTx const& tx);
 
-// This map type acts as both a read and write cache for hook execution
-// and is preserved across the execution of the set of hook chains
-// being executed in the current transaction. It is committed to lgr
-// only upon tesSuccess for the otxn.
-class HookStateMap : public std::map<
-                         ripple::AccountID,  // account that owns the state
-                         std::tuple<
-                             int64_t,  // remaining available ownercount
-                             int64_t,  // total namespace count
-                             std::map<
-                                 ripple::uint256,  // namespace
-                                 std::map<
-                                     ripple::uint256,  // key
-                                     std::pair<
-                                         bool,  // is modified from ledger value
-                                         ripple::Blob>>>>>  // the value
-{
-public:
-    uint32_t modified_entry_count = 0;  // track the number of total modified
-};
-
 using namespace ripple;
 std::vector<std::pair<AccountID, bool>>
 getTransactionalStakeHolders(STTx const& tx, ReadView const& rv);
+
+// Number of reads hooks on this thread made outside of the view they execute
+// against, such as of the open ledger or the transaction database. A result
+// that depends on such a read cannot be replayed on another view.
+std::uint64_t&
+externalReads();
+
+// When set, the transactions hooks on this thread emit are collected here
+// rather than marked as emitted in the HashRouter. An execution that may be
+// thrown away sets this and marks them itself once its result is kept.
+std::vector<uint256>*&
+deferredEmissions();
 }  // namespace hook
 
 namespace hook_api {
@@ -566,6 +559,24 @@ setHookState(
     ripple::uint256 const& key,
     ripple::Slice const& data);
 
+// check the execution's state cache, returns nullptr on a miss
+HookStateMap::Entry const*
+lookup_state_cache(
+    HookContext& hookCtx,
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key);
+
+// update the state cache, returns 1 on success or a negative hook return code
+int64_t
+set_state_cache(
+    HookContext& hookCtx,
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key,
+    ripple::Slice const& data,
+    bool modified);
+
 // write hook execution metadata and remove emitted transaction ledger entries
 ripple::TER
 finalizeHookResult(
@@ -709,11 +720,62 @@ public:
         return {};
     }
 
+    /**
+     * A single use runtime in which a cached module is instantiated and run.
+     * The store, executor and statistics are private to one execution so the
+     * instantiated memory and instruction count never leak between hooks.
+     */
+    class WasmEdgeRuntime
+    {
+    public:
+        WasmEdge_ConfigureContext* conf = NULL;
+        WasmEdge_StatisticsContext* stats = NULL;
+        WasmEdge_StoreContext* store = NULL;
+        WasmEdge_ExecutorContext* executor = NULL;
+        WasmEdge_ModuleInstanceContext* instance = NULL;
+
+        WasmEdgeRuntime()
+        {
+            conf = WasmEdge_ConfigureCreate();
+            if (!conf)
+                return;
+            WasmEdge_ConfigureStatisticsSetInstructionCounting(conf, true);
+            stats = WasmEdge_StatisticsCreate();
+            store = WasmEdge_StoreCreate();
+            if (!stats || !store)
+                return;
+            executor = WasmEdge_ExecutorCreate(conf, stats);
+        }
+
+        bool
+        sane()
+        {
+            return conf && stats && store && executor;
+        }
+
+        ~WasmEdgeRuntime()
+        {
+            if (instance)
+                WasmEdge_ModuleInstanceDelete(instance);
+            if (executor)
+                WasmEdge_ExecutorDelete(executor);
+            if (store)
+                WasmEdge_StoreDelete(store);
+            if (stats)
+                WasmEdge_StatisticsDelete(stats);
+            if (conf)
+                WasmEdge_ConfigureDelete(conf);
+        }
+    };
+
     /**
      * Execute web assembly byte code against the constructed Hook Context
      * Once execution has occured the exector is spent and cannot be used again
      * and should be destructed Information about the execution is populated
      * into hookCtx
+     * The parsed and validated module is taken from (or added to) the process
+     * wide ModuleCache under the hook's HookHash, so only instantiation is
+     * repeated for each execution.
      */
     void
     executeWasm(
@@ -733,9 +795,20 @@ public:
 
         WasmEdge_LogOff();
 
-        WasmEdgeVM vm;
+        auto const module =
+            ModuleCache::instance().fetch(hookCtx.result.hookHash, wasm, len);
 
-        if (!vm.sane())
+        if (!module)
+        {
+            JLOG(j.warn()) << "HookError[" << HC_ACC()
+                           << "]: WASM VM error: " << module.error();
+            hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
+            return;
+        }
+
+        WasmEdgeRuntime rt;
+
+        if (!rt.sane())
         {
             JLOG(j.warn()) << "HookError[" << HC_ACC()
                            << "]: Could not create WASMEDGE instance.";
@@ -744,8 +817,8 @@ public:
             return;
         }
 
-        WasmEdge_Result res =
-            WasmEdge_VMRegisterModuleFromImport(vm.ctx, this->importObj);
+        WasmEdge_Result res = WasmEdge_ExecutorRegisterImport(
+            rt.executor, rt.store, this->importObj);
 
         if (auto err = getWasmError("Import phase failed", res); err)
         {
@@ -754,18 +827,32 @@ public:
             return;
         }
 
+        res = WasmEdge_ExecutorInstantiate(
+            rt.executor, &rt.instance, rt.store, module->get());
+
+        if (auto err = getWasmError("WASM VM error", res); err)
+        {
+            JLOG(j.warn()) << "HookError[" << HC_ACC() << "]: " << *err;
+            hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
+            return;
+        }
+
+        WasmEdge_FunctionInstanceContext* func =
+            WasmEdge_ModuleInstanceFindFunction(
+                rt.instance, callback ? cbakFunctionName : hookFunctionName);
+
+        if (!func)
+        {
+            JLOG(j.warn()) << "HookError[" << HC_ACC()
+                           << "]: WASM VM error: function not found";
+            hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
+            return;
+        }
+
         WasmEdge_Value params[1] = {WasmEdge_ValueGenI32((int64_t)wasmParam)};
         WasmEdge_Value returns[1];
 
-        res = WasmEdge_VMRunWasmFromBuffer(
-            vm.ctx,
-            reinterpret_cast<const uint8_t*>(wasm),
-            len,
-            callback ? cbakFunctionName : hookFunctionName,
-            params,
-            1,
-            returns,
-            1);
+        res = WasmEdge_ExecutorInvoke(rt.executor, func, params, 1, returns, 1);
 
         if (auto err = getWasmError("WASM VM error", res); err)
         {
@@ -774,11 +861,10 @@ public:
             return;
         }
 
-        auto* statsCtx = WasmEdge_VMGetStatisticsContext(vm.ctx);
         hookCtx.result.instructionCount =
-            WasmEdge_StatisticsGetInstrCount(statsCtx);
+            WasmEdge_StatisticsGetInstrCount(rt.stats);
 
-        // RH NOTE: stack unwind will clean up WasmEdgeVM
+        // RH NOTE: stack unwind will clean up WasmEdgeRuntime
     }
 
     HookExecutor(HookContext& ctx)
@@ -0,0 +1,226 @@
+#include <ripple/app/hook/HookStateMap.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <tuple>
+
+namespace hook {
+
+HookStateMap::Account*
+HookStateMap::findAccount(ripple::AccountID const& account)
+{
+    auto it = accounts_.find(account);
+    return it == accounts_.end() ? nullptr : &it->second;
+}
+
+HookStateMap::Account&
+HookStateMap::insertAccount(
+    ripple::AccountID const& account,
+    std::int64_t availableReserves,
+    std::int64_t namespaceCount)
+{
+    auto& acc = accounts_[account];
+    acc.availableReserves = availableReserves;
+    acc.namespaceCount = namespaceCount;
+    return acc;
+}
+
+bool
+HookStateMap::hasNamespace(
+    ripple::AccountID const& account,
+    ripple::uint256 const& ns) const
+{
+    auto it = accounts_.find(account);
+    if (it == accounts_.end())
+        return false;
+
+    // bounded by the namespaces present on ledger plus those created by
+    // at most max_state_modifications writes
+    auto const& namespaces = it->second.namespaces;
+    return std::find(namespaces.begin(), namespaces.end(), ns) !=
+        namespaces.end();
+}
+
+std::size_t
+HookStateMap::probe(Key const& k) const
+{
+    std::size_t const mask = slots_.size() - 1;
+    std::size_t i = hasher_(k) & mask;
+    while (slots_[i] != empty && !(entries_[slots_[i]].id == k))
+        i = (i + 1) & mask;
+    return i;
+}
+
+HookStateMap::Entry const*
+HookStateMap::find(
+    ripple::AccountID const& account,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key) const
+{
+    if (slots_.empty())
+        return nullptr;
+
+    auto const slot = slots_[probe(Key{account, ns, key})];
+    return slot == empty ? nullptr : &entries_[slot];
+}
+
+HookStateMap::Entry*
+HookStateMap::find(
+    ripple::AccountID const& account,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key)
+{
+    return const_cast<Entry*>(
+        static_cast<HookStateMap const&>(*this).find(account, ns, key));
+}
+
+void
+HookStateMap::rehash(std::size_t capacity)
+{
+    slots_.assign(capacity, empty);
+    for (std::uint32_t i = 0; i < entries_.size(); ++i)
+        slots_[probe(entries_[i].id)] = i;
+}
+
+HookStateMap::Entry&
+HookStateMap::insert(
+    ripple::AccountID const& account,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key,
+    bool modified,
+    ripple::Slice value)
+{
+    // keep the load factor at or below one half
+    if ((entries_.size() + 1) * 2 > slots_.size())
+        rehash(std::max<std::size_t>(16, slots_.size() * 2));
+
+    Key k{account, ns, key};
+    auto const slot = probe(k);
+    assert(slots_[slot] == empty);
+
+    if (!hasNamespace(account, ns))
+        accounts_[account].namespaces.push_back(ns);
+
+    auto const size = static_cast<std::uint32_t>(value.size());
+    auto* data = allocate(size);
+    if (size)
+        std::memcpy(data, value.data(), size);
+
+    slots_[slot] = static_cast<std::uint32_t>(entries_.size());
+    return entries_.emplace_back(
+        Entry{std::move(k), modified, data, size, size});
+}
+
+void
+HookStateMap::assign(Entry& entry, ripple::Slice value)
+{
+    auto const size = static_cast<std::uint32_t>(value.size());
+
+    // values are capped at a few kilobytes and rewritten at most
+    // max_state_modifications times, so abandoned storage is not reclaimed
+    if (size > entry.capacity)
+    {
+        entry.data = allocate(size);
+        entry.capacity = size;
+    }
+
+    if (size)
+        std::memmove(entry.data, value.data(), size);
+    entry.size = size;
+}
+
+std::uint8_t*
+HookStateMap::allocate(std::size_t size)
+{
+    if (size == 0)
+        return current_;
+
+    if (size > blockSize / 4)
+    {
+        // large values get a block of their own so the current one is kept
+        blocks_.emplace_back(std::make_unique<std::uint8_t[]>(size));
+        arenaBytes_ += size;
+        return blocks_.back().get();
+    }
+
+    if (blockUsed_ + size > blockSize)
+    {
+        blocks_.emplace_back(std::make_unique<std::uint8_t[]>(blockSize));
+        arenaBytes_ += blockSize;
+        current_ = blocks_.back().get();
+        blockUsed_ = 0;
+    }
+
+    auto* p = current_ + blockUsed_;
+    blockUsed_ += size;
+    return p;
+}
+
+std::vector<HookStateMap::Entry const*>
+HookStateMap::sortedModified() const
+{
+    std::vector<Entry const*> result;
+    result.reserve(modified_entry_count);
+    for (auto const& entry : entries_)
+    {
+        if (entry.modified)
+            result.push_back(&entry);
+    }
+
+    std::sort(
+        result.begin(), result.end(), [](Entry const* a, Entry const* b) {
+            return std::tie(a->id.account, a->id.ns, a->id.key) <
+                std::tie(b->id.account, b->id.ns, b->id.key);
+        });
+    return result;
+}
+
+std::size_t
+HookStateMap::arenaBytes() const
+{
+    return arenaBytes_;
+}
+
+void
+HookStateMap::clear()
+{
+    entries_.clear();
+    slots_.clear();
+    accounts_.clear();
+    blocks_.clear();
+    current_ = nullptr;
+    blockUsed_ = blockSize;
+    arenaBytes_ = 0;
+    modified_entry_count = 0;
+}
+
+bool
+HookStateMap::operator==(HookStateMap const& other) const
+{
+    if (modified_entry_count != other.modified_entry_count ||
+        entries_.size() != other.entries_.size() ||
+        accounts_.size() != other.accounts_.size())
+        return false;
+
+    for (auto const& [id, acc] : accounts_)
+    {
+        auto it = other.accounts_.find(id);
+        if (it == other.accounts_.end() ||
+            it->second.availableReserves != acc.availableReserves ||
+            it->second.namespaceCount != acc.namespaceCount)
+            return false;
+    }
+
+    for (auto const& entry : entries_)
+    {
+        auto const* match =
+            other.find(entry.id.account, entry.id.ns, entry.id.key);
+        if (!match || match->modified != entry.modified ||
+            match->value() != entry.value())
+            return false;
+    }
+
+    return true;
+}
+
+}  // namespace hook
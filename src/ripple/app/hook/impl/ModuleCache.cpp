@@ -0,0 +1,231 @@
+#include <ripple/app/hook/ModuleCache.h>
+#include <limits>
+
+namespace hook {
+
+namespace {
+
+// owns the WasmEdge contexts needed to turn bytecode into a validated module
+struct ModuleLoader
+{
+    WasmEdge_ConfigureContext* conf = NULL;
+    WasmEdge_LoaderContext* loader = NULL;
+    WasmEdge_ValidatorContext* validator = NULL;
+
+    ModuleLoader()
+    {
+        conf = WasmEdge_ConfigureCreate();
+        if (!conf)
+            return;
+        loader = WasmEdge_LoaderCreate(conf);
+        validator = WasmEdge_ValidatorCreate(conf);
+    }
+
+    bool
+    sane() const
+    {
+        return conf && loader && validator;
+    }
+
+    ~ModuleLoader()
+    {
+        if (validator)
+            WasmEdge_ValidatorDelete(validator);
+        if (loader)
+            WasmEdge_LoaderDelete(loader);
+        if (conf)
+            WasmEdge_ConfigureDelete(conf);
+    }
+};
+
+std::string
+wasmError(std::string prefix, WasmEdge_Result const& res)
+{
+    const char* msg = WasmEdge_ResultGetMessage(res);
+    return prefix + ": " + (msg ? msg : "unknown error");
+}
+
+}  // namespace
+
+ModuleCache::ModuleCache(std::size_t maxEntries, std::size_t maxBytes)
+    : maxEntries_(maxEntries), maxBytes_(maxBytes)
+{
+}
+
+ModuleCache&
+ModuleCache::instance()
+{
+    static ModuleCache cache;
+    return cache;
+}
+
+ripple::Expected<ModuleCache::Module, std::string>
+ModuleCache::load(void const* wasm, std::size_t len)
+{
+    if (len > std::numeric_limits<uint32_t>::max())
+        return ripple::Unexpected(std::string("Wasm too large"));
+
+    ModuleLoader ml;
+    if (!ml.sane())
+        return ripple::Unexpected(
+            std::string("Could not create WASMEDGE loader"));
+
+    WasmEdge_ASTModuleContext* ast = NULL;
+    WasmEdge_Result res = WasmEdge_LoaderParseFromBuffer(
+        ml.loader,
+        &ast,
+        reinterpret_cast<const uint8_t*>(wasm),
+        static_cast<uint32_t>(len));
+
+    if (!WasmEdge_ResultOK(res))
+        return ripple::Unexpected(
+            wasmError("LoaderParseFromBuffer failed", res));
+
+    Module module{ast, [](WasmEdge_ASTModuleContext const* p) {
+                      WasmEdge_ASTModuleDelete(
+                          const_cast<WasmEdge_ASTModuleContext*>(p));
+                  }};
+
+    res = WasmEdge_ValidatorValidate(ml.validator, ast);
+
+    if (!WasmEdge_ResultOK(res))
+        return ripple::Unexpected(wasmError("ValidatorValidate failed", res));
+
+    return module;
+}
+
+ripple::Expected<ModuleCache::Module, std::string>
+ModuleCache::fetch(
+    ripple::uint256 const& hookHash,
+    void const* wasm,
+    std::size_t len)
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = map_.find(hookHash); it != map_.end())
+        {
+            ++hits_;
+            ++it->second.fetches;
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.module;
+        }
+        ++misses_;
+    }
+
+    // parse and validate outside the lock so that a large module does not
+    // stall executions of other, already cached, hooks
+    auto loaded = load(wasm, len);
+    if (!loaded)
+        return loaded;
+
+    std::lock_guard lock(mutex_);
+
+    // another thread may have loaded the same module in the meantime
+    if (auto it = map_.find(hookHash); it != map_.end())
+    {
+        ++it->second.fetches;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return it->second.module;
+    }
+
+    // a module larger than the whole cache is handed out but not retained
+    if (len > maxBytes_ || maxEntries_ == 0)
+        return loaded;
+
+    lru_.push_front(hookHash);
+    map_.emplace(hookHash, Entry{*loaded, len, lru_.begin(), 1});
+    bytes_ += len;
+    trim(lock);
+
+    return loaded;
+}
+
+bool
+ModuleCache::claimCompilation(
+    ripple::uint256 const& hookHash,
+    std::uint64_t threshold)
+{
+    std::lock_guard lock(mutex_);
+    auto it = map_.find(hookHash);
+    if (it == map_.end())
+        return false;
+
+    auto& entry = it->second;
+    if (entry.native || entry.compileClaimed || entry.fetches < threshold)
+        return false;
+
+    entry.compileClaimed = true;
+    return true;
+}
+
+bool
+ModuleCache::installNative(ripple::uint256 const& hookHash, Module module)
+{
+    std::lock_guard lock(mutex_);
+    auto it = map_.find(hookHash);
+    if (it == map_.end())
+        return false;
+
+    it->second.module = std::move(module);
+    it->second.native = true;
+    return true;
+}
+
+bool
+ModuleCache::isNative(ripple::uint256 const& hookHash) const
+{
+    std::lock_guard lock(mutex_);
+    auto it = map_.find(hookHash);
+    return it != map_.end() && it->second.native;
+}
+
+void
+ModuleCache::trim(std::lock_guard<std::mutex> const&)
+{
+    while (!lru_.empty() && (map_.size() > maxEntries_ || bytes_ > maxBytes_))
+    {
+        auto it = map_.find(lru_.back());
+        bytes_ -= it->second.bytes;
+        map_.erase(it);
+        lru_.pop_back();
+    }
+}
+
+void
+ModuleCache::clear()
+{
+    std::lock_guard lock(mutex_);
+    map_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+std::size_t
+ModuleCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return map_.size();
+}
+
+std::size_t
+ModuleCache::bytes() const
+{
+    std::lock_guard lock(mutex_);
+    return bytes_;
+}
+
+std::uint64_t
+ModuleCache::hits() const
+{
+    std::lock_guard lock(mutex_);
+    return hits_;
+}
+
+std::uint64_t
+ModuleCache::misses() const
+{
+    std::lock_guard lock(mutex_);
+    return misses_;
+}
+
+}  // namespace hook
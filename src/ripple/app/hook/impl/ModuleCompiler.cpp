@@ -0,0 +1,311 @@
+#include <ripple/app/hook/ModuleCompiler.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/Config.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/protocol/digest.h>
+
+namespace hook {
+
+namespace {
+
+std::string
+wasmError(std::string prefix, WasmEdge_Result const& res)
+{
+    const char* msg = WasmEdge_ResultGetMessage(res);
+    return prefix + ": " + (msg ? msg : "unknown error");
+}
+
+// owns a configuration suitable both for compiling and for loading native
+// modules. Instruction counting must be compiled in so that the statistics
+// seen by the executor match those of the interpreter. The native code is
+// emitted into a custom section of a wasm module rather than a shared object
+// so that loadNative can parse it from the bytes it has already verified.
+struct NativeConfigure
+{
+    WasmEdge_ConfigureContext* conf = NULL;
+
+    NativeConfigure()
+    {
+        conf = WasmEdge_ConfigureCreate();
+        if (!conf)
+            return;
+        WasmEdge_ConfigureStatisticsSetInstructionCounting(conf, true);
+        WasmEdge_ConfigureCompilerSetInstructionCounting(conf, true);
+        WasmEdge_ConfigureCompilerSetOptimizationLevel(
+            conf, WasmEdge_CompilerOptimizationLevel_O2);
+        WasmEdge_ConfigureCompilerSetOutputFormat(
+            conf, WasmEdge_CompilerOutputFormat_Wasm);
+        // the artifact may outlive the machine it was built on if the
+        // database directory is moved, so do not target the host cpu
+        WasmEdge_ConfigureCompilerSetGenericBinary(conf, true);
+    }
+
+    ~NativeConfigure()
+    {
+        if (conf)
+            WasmEdge_ConfigureDelete(conf);
+    }
+};
+
+// Identifies the code NativeConfigure makes the compiler generate. Change it
+// along with NativeConfigure so that existing artifacts are compiled again.
+char const* const nativeOptions =
+    "2 O2 generic instruction-counting universal";
+
+std::string
+nativeHeader(ripple::uint256 const& bytecodeHash, std::string const& artifact)
+{
+    return std::string("xahau native hook\n") + "options " + nativeOptions +
+        "\n" + "wasmedge " + WasmEdge_VersionGet() + "\n" + "bytecode " +
+        to_string(bytecodeHash) + "\n" + "artifact " +
+        to_string(ripple::sha512Half(ripple::makeSlice(artifact))) + "\n";
+}
+
+}  // namespace
+
+boost::filesystem::path
+nativeModuleDir(ripple::Config const& config)
+{
+    if (config.HOOK_AOT_THRESHOLD == 0)
+        return {};
+
+    auto const dbPath = config.legacy("database_path");
+    if (dbPath.empty())
+        return {};
+
+    return boost::filesystem::path(dbPath) / "hooks_native";
+}
+
+boost::filesystem::path
+nativeModulePath(
+    boost::filesystem::path const& dir,
+    ripple::uint256 const& hookHash)
+{
+    return dir / (to_string(hookHash) + ".wasm");
+}
+
+boost::filesystem::path
+nativeHeaderPath(boost::filesystem::path const& path)
+{
+    return boost::filesystem::path(path).concat(".hdr");
+}
+
+std::optional<std::string>
+compileNative(
+    void const* wasm,
+    std::size_t len,
+    boost::filesystem::path const& out)
+{
+    namespace fs = boost::filesystem;
+    boost::system::error_code ec;
+
+    fs::create_directories(out.parent_path(), ec);
+    if (ec)
+        return "Could not create " + out.parent_path().string() + ": " +
+            ec.message();
+
+    // the compiler only works on files, so stage the bytecode next to the
+    // destination and publish the artifact with an atomic rename
+    auto const input = fs::path(out).concat(".wasm.tmp");
+    auto const output = fs::path(out).concat(".tmp");
+    auto const header = nativeHeaderPath(out);
+    auto const headerOutput = fs::path(header).concat(".tmp");
+
+    ripple::writeFileContents(
+        ec, input, std::string(static_cast<char const*>(wasm), len));
+    if (ec)
+        return "Could not write " + input.string() + ": " + ec.message();
+
+    std::optional<std::string> error;
+    {
+        NativeConfigure nc;
+        WasmEdge_CompilerContext* compiler =
+            nc.conf ? WasmEdge_CompilerCreate(nc.conf) : NULL;
+
+        if (!compiler)
+            error = "Could not create WASMEDGE compiler";
+        else
+        {
+            WasmEdge_Result res = WasmEdge_CompilerCompile(
+                compiler, input.string().c_str(), output.string().c_str());
+            if (!WasmEdge_ResultOK(res))
+                error = wasmError("CompilerCompile failed", res);
+            WasmEdge_CompilerDelete(compiler);
+        }
+    }
+
+    fs::remove(input, ec);
+
+    if (!error)
+    {
+        auto const artifact = ripple::getFileContents(ec, output);
+        if (ec)
+            error = "Could not read " + output.string() + ": " + ec.message();
+        else
+        {
+            ripple::writeFileContents(
+                ec,
+                headerOutput,
+                nativeHeader(
+                    ripple::sha512Half_s(ripple::Slice(wasm, len)),
+                    artifact));
+            if (ec)
+                error = "Could not write " + headerOutput.string() + ": " +
+                    ec.message();
+        }
+    }
+
+    // the artifact is published before its header, an artifact left with
+    // the header of an older one fails the check in loadNative
+    if (!error)
+    {
+        fs::rename(output, out, ec);
+        if (ec)
+            error = "Could not rename " + output.string() + ": " + ec.message();
+    }
+
+    if (!error)
+    {
+        fs::rename(headerOutput, header, ec);
+        if (ec)
+            error = "Could not rename " + headerOutput.string() + ": " +
+                ec.message();
+    }
+
+    if (error)
+    {
+        fs::remove(output, ec);
+        fs::remove(headerOutput, ec);
+    }
+
+    return error;
+}
+
+ripple::Expected<ModuleCache::Module, std::string>
+loadNative(
+    boost::filesystem::path const& path,
+    ripple::uint256 const& bytecodeHash)
+{
+    boost::system::error_code ec;
+    auto const header = ripple::getFileContents(ec, nativeHeaderPath(path));
+    if (ec)
+        return ripple::Unexpected(
+            "Could not read header of " + path.string() + ": " + ec.message());
+
+    auto const artifact = ripple::getFileContents(ec, path);
+    if (ec)
+        return ripple::Unexpected(
+            "Could not read " + path.string() + ": " + ec.message());
+
+    if (header != nativeHeader(bytecodeHash, artifact))
+        return ripple::Unexpected(
+            std::string("Header does not match the bytecode, WasmEdge "
+                        "version or artifact"));
+
+    NativeConfigure nc;
+    if (!nc.conf)
+        return ripple::Unexpected(
+            std::string("Could not create WASMEDGE configuration"));
+
+    WasmEdge_LoaderContext* loader = WasmEdge_LoaderCreate(nc.conf);
+    if (!loader)
+        return ripple::Unexpected(
+            std::string("Could not create WASMEDGE loader"));
+
+    // parse the bytes that were checked against the header, reopening the
+    // path would load whatever has replaced the file since
+    WasmEdge_ASTModuleContext* ast = NULL;
+    WasmEdge_Result res = WasmEdge_LoaderParseFromBuffer(
+        loader,
+        &ast,
+        reinterpret_cast<const uint8_t*>(artifact.data()),
+        static_cast<uint32_t>(artifact.size()));
+    WasmEdge_LoaderDelete(loader);
+
+    if (!WasmEdge_ResultOK(res))
+        return ripple::Unexpected(
+            wasmError("LoaderParseFromBuffer failed", res));
+
+    ModuleCache::Module module{ast, [](WasmEdge_ASTModuleContext const* p) {
+                                   WasmEdge_ASTModuleDelete(
+                                       const_cast<WasmEdge_ASTModuleContext*>(
+                                           p));
+                               }};
+
+    WasmEdge_ValidatorContext* validator = WasmEdge_ValidatorCreate(nc.conf);
+    if (!validator)
+        return ripple::Unexpected(
+            std::string("Could not create WASMEDGE validator"));
+
+    res = WasmEdge_ValidatorValidate(validator, ast);
+    WasmEdge_ValidatorDelete(validator);
+
+    if (!WasmEdge_ResultOK(res))
+        return ripple::Unexpected(wasmError("ValidatorValidate failed", res));
+
+    return module;
+}
+
+void
+promoteIfHot(
+    ripple::Application& app,
+    ripple::uint256 const& hookHash,
+    ripple::Blob const& wasm)
+{
+    auto const dir = nativeModuleDir(app.config());
+    if (dir.empty())
+        return;
+
+    if (!ModuleCache::instance().claimCompilation(
+            hookHash, app.config().HOOK_AOT_THRESHOLD))
+        return;
+
+    app.getJobQueue().addJob(
+        ripple::jtHOOK_COMPILE,
+        "hookCompile",
+        [&app, dir, hookHash, wasm]() {
+            auto const j = app.journal("View");
+            auto const path = nativeModulePath(dir, hookHash);
+            auto const bytecodeHash =
+                ripple::sha512Half_s(ripple::Slice(wasm.data(), wasm.size()));
+
+            // an artifact from an earlier run is only trusted if its header
+            // matches, otherwise it is compiled again
+            auto native = loadNative(path, bytecodeHash);
+            if (!native)
+            {
+                JLOG(j.debug()) << "HookInfo: compiling " << hookHash
+                                << " to native code: " << native.error();
+
+                if (auto err = compileNative(wasm.data(), wasm.size(), path))
+                {
+                    JLOG(j.warn()) << "HookError: native compilation of "
+                                   << hookHash << " failed: " << *err;
+                    return;
+                }
+
+                native = loadNative(path, bytecodeHash);
+            }
+
+            if (!native)
+            {
+                JLOG(j.warn()) << "HookError: loading native " << hookHash
+                               << " failed: " << native.error();
+                boost::system::error_code ec;
+                boost::filesystem::remove(path, ec);
+                boost::filesystem::remove(nativeHeaderPath(path), ec);
+                return;
+            }
+
+            if (ModuleCache::instance().installNative(
+                    hookHash, std::move(*native)))
+            {
+                JLOG(j.debug())
+                    << "HookInfo: " << hookHash << " now runs natively";
+            }
+        });
+}
+
+}  // namespace hook
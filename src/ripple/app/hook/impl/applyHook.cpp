@@ -1,3 +1,4 @@
+#include <ripple/app/hook/ModuleCompiler.h>
 #include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/TransactionMaster.h>
@@ -507,6 +508,20 @@ getTransactionalStakeHolders(STTx const& tx, ReadView const& rv)
     return ret;
 }
 
+std::uint64_t&
+externalReads()
+{
+    thread_local std::uint64_t reads = 0;
+    return reads;
+}
+
+std::vector<uint256>*&
+deferredEmissions()
+{
+    thread_local std::vector<uint256>* emissions = nullptr;
+    return emissions;
+}
+
 }  // namespace hook
 
 namespace hook_float {
@@ -1243,6 +1258,8 @@ hook::apply(
     executor.executeWasm(
         wasm.data(), (size_t)wasm.size(), isCallback, wasmParam, j);
 
+    promoteIfHot(applyCtx.app, hookHash, wasm);
+
     JLOG(j.trace()) << "HookInfo[" << HC_ACC() << "]: "
                     << (hookCtx.result.exitType == hook_api::ExitType::ROLLBACK
                             ? "ROLLBACK"
@@ -1402,41 +1419,23 @@ std::optional<ripple::uint256> inline make_state_key(std::string_view source)
     return ripple::uint256::fromVoid(key_buffer);
 }
 
-// check the state cache
-inline std::optional<
-    std::reference_wrapper<std::pair<bool, ripple::Blob> const>>
-lookup_state_cache(
+hook::HookStateMap::Entry const*
+hook::lookup_state_cache(
     hook::HookContext& hookCtx,
     ripple::AccountID const& acc,
     ripple::uint256 const& ns,
     ripple::uint256 const& key)
 {
-    auto& stateMap = hookCtx.result.stateMap;
-    if (stateMap.find(acc) == stateMap.end())
-        return std::nullopt;
-
-    auto& stateMapAcc = std::get<2>(stateMap[acc]);
-    if (stateMapAcc.find(ns) == stateMapAcc.end())
-        return std::nullopt;
-
-    auto& stateMapNs = stateMapAcc[ns];
-
-    auto const& ret = stateMapNs.find(key);
-
-    if (ret == stateMapNs.end())
-        return std::nullopt;
-
-    return std::cref(ret->second);
+    return hookCtx.result.stateMap.find(acc, ns, key);
 }
 
-// update the state cache
-inline int64_t  // if negative a hook return code, if == 1 then success
-set_state_cache(
+int64_t  // if negative a hook return code, if == 1 then success
+hook::set_state_cache(
     hook::HookContext& hookCtx,
     ripple::AccountID const& acc,
     ripple::uint256 const& ns,
     ripple::uint256 const& key,
-    ripple::Blob& data,
+    ripple::Slice const& data,
     bool modified)
 {
     auto& stateMap = hookCtx.result.stateMap;
@@ -1448,7 +1447,8 @@ set_state_cache(
     bool const createNamespace = view.rules().enabled(fixXahauV1) &&
         !view.exists(keylet::hookStateDir(acc, ns));
 
-    if (stateMap.find(acc) == stateMap.end())
+    auto* accState = stateMap.findAccount(acc);
+    if (!accState)
     {
         // if this is the first time this account has been interacted with
         // we will compute how many available reserve positions there are
@@ -1490,19 +1490,16 @@ set_state_cache(
 
         stateMap.modified_entry_count++;
 
-        stateMap[acc] = {
-            availableForReserves - 1,
-            namespaceCount,
-            {{ns, {{key, {modified, data}}}}}};
+        stateMap.insertAccount(acc, availableForReserves - 1, namespaceCount);
+        stateMap.insert(acc, ns, key, modified, data);
         return 1;
     }
 
-    auto& availableForReserves = std::get<0>(stateMap[acc]);
-    auto& namespaceCount = std::get<1>(stateMap[acc]);
-    auto& stateMapAcc = std::get<2>(stateMap[acc]);
+    auto& availableForReserves = accState->availableReserves;
+    auto& namespaceCount = accState->namespaceCount;
     bool const canReserveNew = availableForReserves > 0;
 
-    if (stateMapAcc.find(ns) == stateMapAcc.end())
+    if (!stateMap.hasNamespace(acc, ns))
     {
         if (modified)
         {
@@ -1525,13 +1522,13 @@ set_state_cache(
             stateMap.modified_entry_count++;
         }
 
-        stateMapAcc[ns] = {{key, {modified, data}}};
+        stateMap.insert(acc, ns, key, modified, data);
 
         return 1;
     }
 
-    auto& stateMapNs = stateMapAcc[ns];
-    if (stateMapNs.find(key) == stateMapNs.end())
+    auto* entry = stateMap.find(acc, ns, key);
+    if (!entry)
     {
         if (modified)
         {
@@ -1541,21 +1538,21 @@ set_state_cache(
             stateMap.modified_entry_count++;
         }
 
-        stateMapNs[key] = {modified, data};
+        stateMap.insert(acc, ns, key, modified, data);
         hookCtx.result.changedStateCount++;
         return 1;
     }
 
     if (modified)
     {
-        if (!stateMapNs[key].first)
+        if (!entry->modified)
             hookCtx.result.changedStateCount++;
 
         stateMap.modified_entry_count++;
-        stateMapNs[key].first = true;
+        entry->modified = true;
     }
 
-    stateMapNs[key].second = data;
+    stateMap.assign(*entry, data);
     return 1;
 }
 
@@ -1659,7 +1656,7 @@ DEFINE_HOOK_FUNCTION(
     if (!key)
         return INTERNAL_ERROR;
 
-    ripple::Blob data{memory + read_ptr, memory + read_ptr + read_len};
+    ripple::Slice data{memory + read_ptr, read_len};
 
     // local modifications are always allowed
     if (aread_len == 0 || acc == hookCtx.result.account)
@@ -1677,7 +1674,7 @@ DEFINE_HOOK_FUNCTION(
 
     // first check if we've already modified this state
     auto cacheEntry = lookup_state_cache(hookCtx, acc, ns, *key);
-    if (cacheEntry && cacheEntry->get().first)
+    if (cacheEntry && cacheEntry->modified)
     {
         // if a cache entry already exists and it has already been modified
         // don't check grants again
@@ -1774,47 +1771,33 @@ hook::finalizeHookState(
     auto const& j = applyCtx.app.journal("View");
     uint16_t changeCount = 0;
 
-    // write all changes to state, if in "apply" mode
-    for (const auto& accEntry : stateMap)
+    // write all changes to state, if in "apply" mode. The cache is unordered
+    // so sort the modified entries for a deterministic directory layout.
+    for (auto const* entry : stateMap.sortedModified())
     {
-        const auto& acc = accEntry.first;
-        for (const auto& nsEntry : std::get<2>(accEntry.second))
+        auto const& [acc, ns, key] = entry->id;
+
+        changeCount++;
+        if (changeCount > max_state_modifications + 1)
         {
-            const auto& ns = nsEntry.first;
-            for (const auto& cacheEntry : nsEntry.second)
-            {
-                bool is_modified = cacheEntry.second.first;
-                const auto& key = cacheEntry.first;
-                const auto& blob = cacheEntry.second.second;
-                if (is_modified)
-                {
-                    changeCount++;
-                    if (changeCount > max_state_modifications + 1)
-                    {
-                        // overflow
-                        JLOG(j.warn())
-                            << "HooKError[TX:" << txnID
-                            << "]: SetHooKState failed: Too many state changes";
-                        return tecHOOK_REJECTED;
-                    }
+            // overflow
+            JLOG(j.warn()) << "HooKError[TX:" << txnID
+                           << "]: SetHooKState failed: Too many state changes";
+            return tecHOOK_REJECTED;
+        }
 
-                    // this entry isn't just cached, it was actually modified
-                    auto slice = Slice(blob.data(), blob.size());
+        auto const slice = entry->value();
 
-                    TER result = setHookState(applyCtx, acc, ns, key, slice);
+        TER result = setHookState(applyCtx, acc, ns, key, slice);
 
-                    if (!isTesSuccess(result))
-                    {
-                        JLOG(j.warn())
-                            << "HookError[TX:" << txnID
-                            << "]: SetHookState failed: " << result
-                            << " Key: " << key << " Value: " << slice;
-                        return result;
-                    }
-                    // ^ should not fail... checks were done before map insert
-                }
-            }
+        if (!isTesSuccess(result))
+        {
+            JLOG(j.warn()) << "HookError[TX:" << txnID
+                           << "]: SetHookState failed: " << result
+                           << " Key: " << key << " Value: " << slice;
+            return result;
         }
+        // ^ should not fail... checks were done before map insert
     }
     return tesSUCCESS;
 }
@@ -1913,7 +1896,10 @@ hook::finalizeHookResult(
             auto& id = tpTrans->getID();
             JLOG(j.trace()) << "HookEmit[" << HR_ACC() << "]: " << id;
 
-            applyCtx.app.getHashRouter().setFlags(id, SF_EMITTED);
+            if (auto const deferred = hook::deferredEmissions())
+                deferred->push_back(id);
+            else
+                applyCtx.app.getHashRouter().setFlags(id, SF_EMITTED);
 
             std::shared_ptr<const ripple::STTx> ptr =
                 tpTrans->getSTransaction();
@@ -2114,16 +2100,13 @@ DEFINE_HOOK_FUNCTION(
         return INVALID_ARGUMENT;
 
     // first check if the requested state was previously cached this session
-    auto cacheEntryLookup = lookup_state_cache(hookCtx, acc, ns, *key);
-    if (cacheEntryLookup)
+    if (auto const cacheEntry = lookup_state_cache(hookCtx, acc, ns, *key))
     {
-        auto const& cacheEntry = cacheEntryLookup->get();
-
         WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
             write_ptr,
             write_len,
-            cacheEntry.second.data(),
-            cacheEntry.second.size(),
+            cacheEntry->data,
+            cacheEntry->size,
             false);
     }
 
@@ -2135,7 +2118,7 @@ DEFINE_HOOK_FUNCTION(
     Blob b = hsSLE->getFieldVL(sfHookStateData);
 
     // it exists add it to cache and return it
-    if (set_state_cache(hookCtx, acc, ns, *key, b, false) < 0)
+    if (set_state_cache(hookCtx, acc, ns, *key, makeSlice(b), false) < 0)
         return INTERNAL_ERROR;  // should never happen
 
     WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
@@ -2546,6 +2529,7 @@ DEFINE_HOOK_FUNCTION(
 
         ripple::error_code_i ec{ripple::error_code_i::rpcUNKNOWN};
 
+        ++hook::externalReads();
         auto hTx = applyCtx.app.getMasterTransaction().fetch(hash, ec);
 
         if (auto const* p = std::get_if<std::pair<
@@ -4611,6 +4595,7 @@ DEFINE_HOOK_FUNCTION(
         std::unique_ptr<STTx const> stpTrans;
         stpTrans = std::make_unique<STTx const>(std::ref(sitTrans));
 
+        ++hook::externalReads();
         return Transactor::calculateBaseFee(
                    *(applyCtx.app.openLedger().current()), *stpTrans)
             .drops();
@@ -85,6 +85,11 @@ public:
     {
         return mMeta.getIndex();
     }
+    Blob const&
+    getRawMeta() const
+    {
+        return mRawMeta;
+    }
     std::string
     getEscMeta() const;
 
@@ -52,6 +52,7 @@
 #include <ripple/protocol/jss.h>
 #include <boost/optional.hpp>
 #include <cassert>
+#include <future>
 #include <utility>
 #include <vector>
 
@@ -995,11 +996,16 @@ isFlagLedger(LedgerIndex seq)
     return seq % FLAG_LEDGER_INTERVAL == 0;
 }
 
-static bool
+/** Save a fully-validated ledger, possibly in one group with others.
+
+    Calls `onSaved` once the ledger is saved, with false on error.
+*/
+static void
 saveValidatedLedger(
     Application& app,
     std::shared_ptr<Ledger const> const& ledger,
-    bool current)
+    bool current,
+    std::function<void(bool)> onSaved)
 {
     auto j = app.journal("Ledger");
     auto seq = ledger->info().seq;
@@ -1007,19 +1013,38 @@ saveValidatedLedger(
     {
         // The save was completed synchronously
         JLOG(j.debug()) << "Save aborted";
-        return true;
+        onSaved(true);
+        return;
     }
 
     auto const db = dynamic_cast<SQLiteDatabase*>(&app.getRelationalDatabase());
     if (!db)
         Throw<std::runtime_error>("Failed to get relational database");
 
-    auto const res = db->saveValidatedLedger(ledger, current);
+    db->saveValidatedLedger(
+        ledger, current, [&app, seq, onSaved = std::move(onSaved)](bool res) {
+            // Clients can now trust the database for
+            // information about this ledger sequence.
+            app.pendingSaves().finishWork(seq);
+            onSaved(res);
+        });
+}
+
+/** Save a fully-validated ledger, returning once it is saved.
 
-    // Clients can now trust the database for
-    // information about this ledger sequence.
-    app.pendingSaves().finishWork(seq);
-    return res;
+    Returns false on error
+*/
+static bool
+saveValidatedLedger(
+    Application& app,
+    std::shared_ptr<Ledger const> const& ledger,
+    bool current)
+{
+    std::promise<bool> saved;
+    auto result = saved.get_future();
+    saveValidatedLedger(
+        app, ledger, current, [&saved](bool res) { saved.set_value(res); });
+    return result.get();
 }
 
 /** Save, or arrange to save, a fully-validated ledger
@@ -1064,7 +1089,7 @@ pendSaveValidated(
     // See if we can use the JobQueue.
     if (!isSynchronous &&
         app.getJobQueue().addJob(jobType, jobName, [&app, ledger, isCurrent]() {
-            saveValidatedLedger(app, ledger, isCurrent);
+            saveValidatedLedger(app, ledger, isCurrent, [](bool) {});
         }))
     {
         return true;
@@ -25,6 +25,7 @@
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Indexes.h>
+#include <optional>
 
 namespace ripple {
 
@@ -143,11 +144,165 @@ OrderBookDB::update(std::shared_ptr<ReadView const> const& ledger)
         std::lock_guard sl(mLock);
         allBooks_.swap(allBooks);
         xrpBooks_.swap(xrpBooks);
+        applied_ = ledger->seq();
+
+        // Catch up with the ledgers validated during the update
+        while (!pending_.empty())
+        {
+            auto const pending = pending_.extract(pending_.begin());
+            if (pending.key() <= applied_)
+                continue;
+            if (pending.key() != applied_ + 1)
+                break;
+            applyDelta(pending.mapped());
+            applied_ = pending.key();
+        }
+        pending_.clear();
     }
 
     app_.getLedgerMaster().newOrderBookDB();
 }
 
+void
+OrderBookDB::applyLedger(AcceptedLedger const& ledger)
+{
+    if (app_.config().PATH_SEARCH_MAX == 0)
+        return;  // pathfinding has been disabled
+
+    auto const& view = ledger.getLedger();
+    auto const seq = view->seq();
+
+    std::optional<Delta> delta;
+    try
+    {
+        delta = makeDelta(ledger);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.info()) << "Unable to read the book changes of " << seq
+                        << ": " << e.what();
+    }
+
+    std::uint32_t applied;
+    {
+        std::lock_guard sl(mLock);
+        applied = applied_;
+
+        if (seq <= applied_)
+            return;
+
+        if (delta && seq_.load() > applied_)
+        {
+            // A full update is running, the delta is applied once it is done
+            if (pending_.size() < 256)
+                pending_.emplace(seq, std::move(*delta));
+            return;
+        }
+
+        if (delta && applied_ != 0 && seq == applied_ + 1)
+        {
+            applyDelta(*delta);
+            applied_ = seq;
+            return;
+        }
+    }
+
+    JLOG(j_.debug()) << "Ledger " << seq << " does not follow " << applied
+                     << ", starting a full order book update";
+    setup(view);
+}
+
+OrderBookDB::Delta
+OrderBookDB::makeDelta(AcceptedLedger const& ledger) const
+{
+    hash_set<Book> created;
+    hash_set<Book> deleted;
+
+    for (auto const& tx : ledger)
+    {
+        for (auto const& node : tx->getMeta().getNodes())
+        {
+            if (node.getFieldU16(sfLedgerEntryType) != ltDIR_NODE)
+                continue;
+
+            bool const isCreated = node.getFName() == sfCreatedNode;
+            if (!isCreated && node.getFName() != sfDeletedNode)
+                continue;
+
+            auto const fields = dynamic_cast<STObject const*>(
+                node.peekAtPField(isCreated ? sfNewFields : sfFinalFields));
+
+            // Only the root page of a quality directory is of interest
+            if (!fields || !fields->isFieldPresent(sfExchangeRate) ||
+                !fields->isFieldPresent(sfRootIndex) ||
+                fields->getFieldH256(sfRootIndex) !=
+                    node.getFieldH256(sfLedgerIndex))
+                continue;
+
+            // The default values of XRP are left out of created nodes
+            auto const h160 = [fields](SField const& field) {
+                return fields->isFieldPresent(field)
+                    ? fields->getFieldH160(field)
+                    : uint160{};
+            };
+
+            Book book;
+
+            book.in.currency = h160(sfTakerPaysCurrency);
+            book.in.account = h160(sfTakerPaysIssuer);
+            book.out.currency = h160(sfTakerGetsCurrency);
+            book.out.account = h160(sfTakerGetsIssuer);
+
+            if (isCreated)
+                created.insert(book);
+            else
+                deleted.insert(book);
+        }
+    }
+
+    Delta delta;
+    delta.added.assign(created.begin(), created.end());
+
+    // A book remains for as long as any of its quality directories does
+    auto const& view = *ledger.getLedger();
+    for (auto const& book : deleted)
+    {
+        auto const base = getBookBase(book);
+        if (!view.succ(base, getQualityNext(base)))
+            delta.removed.push_back(book);
+    }
+
+    return delta;
+}
+
+void
+OrderBookDB::applyDelta(Delta const& delta)
+{
+    for (auto const& book : delta.added)
+    {
+        allBooks_[book.in].insert(book.out);
+
+        if (isXRP(book.out))
+            xrpBooks_.insert(book.in);
+    }
+
+    for (auto const& book : delta.removed)
+    {
+        if (auto it = allBooks_.find(book.in); it != allBooks_.end())
+        {
+            it->second.erase(book.out);
+            if (it->second.empty())
+                allBooks_.erase(it);
+        }
+
+        if (isXRP(book.out))
+            xrpBooks_.erase(book.in);
+    }
+
+    JLOG(j_.trace()) << "Applied " << delta.added.size() << " new and "
+                     << delta.removed.size() << " removed books";
+}
+
 void
 OrderBookDB::addOrderBook(Book const& book)
 {
@@ -198,89 +353,4 @@ OrderBookDB::isBookToXRP(Issue const& issue)
     return xrpBooks_.count(issue) > 0;
 }
 
-BookListeners::pointer
-OrderBookDB::makeBookListeners(Book const& book)
-{
-    std::lock_guard sl(mLock);
-    auto ret = getBookListeners(book);
-
-    if (!ret)
-    {
-        ret = std::make_shared<BookListeners>();
-
-        mListeners[book] = ret;
-        assert(getBookListeners(book) == ret);
-    }
-
-    return ret;
-}
-
-BookListeners::pointer
-OrderBookDB::getBookListeners(Book const& book)
-{
-    BookListeners::pointer ret;
-    std::lock_guard sl(mLock);
-
-    auto it0 = mListeners.find(book);
-    if (it0 != mListeners.end())
-        ret = it0->second;
-
-    return ret;
-}
-
-// Based on the meta, send the meta to the streams that are listening.
-// We need to determine which streams a given meta effects.
-void
-OrderBookDB::processTxn(
-    std::shared_ptr<ReadView const> const& ledger,
-    const AcceptedLedgerTx& alTx,
-    Json::Value const& jvObj)
-{
-    std::lock_guard sl(mLock);
-
-    // For this particular transaction, maintain the set of unique
-    // subscriptions that have already published it.  This prevents sending
-    // the transaction multiple times if it touches multiple ltOFFER
-    // entries for the same book, or if it touches multiple books and a
-    // single client has subscribed to those books.
-    hash_set<std::uint64_t> havePublished;
-
-    for (auto const& node : alTx.getMeta().getNodes())
-    {
-        try
-        {
-            if (node.getFieldU16(sfLedgerEntryType) == ltOFFER)
-            {
-                auto process = [&, this](SField const& field) {
-                    if (auto data = dynamic_cast<STObject const*>(
-                            node.peekAtPField(field));
-                        data && data->isFieldPresent(sfTakerPays) &&
-                        data->isFieldPresent(sfTakerGets))
-                    {
-                        auto listeners = getBookListeners(
-                            {data->getFieldAmount(sfTakerGets).issue(),
-                             data->getFieldAmount(sfTakerPays).issue()});
-                        if (listeners)
-                            listeners->publish(jvObj, havePublished);
-                    }
-                };
-
-                // We need a field that contains the TakerGets and TakerPays
-                // parameters.
-                if (node.getFName() == sfModifiedNode)
-                    process(sfPreviousFields);
-                else if (node.getFName() == sfCreatedNode)
-                    process(sfNewFields);
-                else if (node.getFName() == sfDeletedNode)
-                    process(sfFinalFields);
-            }
-        }
-        catch (std::exception const& ex)
-        {
-            JLOG(j_.info())
-                << "processTxn: field not found (" << ex.what() << ")";
-        }
-    }
-}
-
 }  // namespace ripple
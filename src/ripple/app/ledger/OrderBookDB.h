@@ -20,9 +20,10 @@
 #ifndef RIPPLE_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 #define RIPPLE_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 
+#include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/AcceptedLedgerTx.h>
-#include <ripple/app/ledger/BookListeners.h>
 #include <ripple/app/main/Application.h>
+#include <map>
 #include <mutex>
 
 namespace ripple {
@@ -37,6 +38,16 @@ public:
     void
     update(std::shared_ptr<ReadView const> const& ledger);
 
+    /** Bring the books up to date with a validated ledger.
+
+        Books are added and removed as the ledger's transactions create
+        and delete the root page of their quality directories. A full
+        update is started instead if the ledger does not follow the last
+        one applied.
+    */
+    void
+    applyLedger(AcceptedLedger const& ledger);
+
     void
     addOrderBook(Book const&);
 
@@ -53,19 +64,21 @@ public:
     bool
     isBookToXRP(Issue const&);
 
-    BookListeners::pointer
-    getBookListeners(Book const&);
-    BookListeners::pointer
-    makeBookListeners(Book const&);
+private:
+    // The books a validated ledger added and removed
+    struct Delta
+    {
+        std::vector<Book> added;
+        std::vector<Book> removed;
+    };
+
+    Delta
+    makeDelta(AcceptedLedger const& ledger) const;
 
-    // see if this txn effects any orderbook
+    // Requires mLock
     void
-    processTxn(
-        std::shared_ptr<ReadView const> const& ledger,
-        const AcceptedLedgerTx& alTx,
-        Json::Value const& jvObj);
+    applyDelta(Delta const& delta);
 
-private:
     Application& app_;
 
     // Maps order books by "issue in" to "issue out":
@@ -76,11 +89,13 @@ private:
 
     std::recursive_mutex mLock;
 
-    using BookToListenersMap = hash_map<Book, BookListeners::pointer>;
+    std::atomic<std::uint32_t> seq_;
 
-    BookToListenersMap mListeners;
+    // The last ledger the books reflect, 0 before the first full update
+    std::uint32_t applied_ = 0;
 
-    std::atomic<std::uint32_t> seq_;
+    // Deltas of ledgers validated while a full update is running
+    std::map<std::uint32_t, Delta> pending_;
 
     beast::Journal const j_;
 };
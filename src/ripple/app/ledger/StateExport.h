@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_STATEEXPORT_H_INCLUDED
+#define RIPPLE_APP_LEDGER_STATEEXPORT_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/protocol/Serializer.h>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+
+namespace ripple {
+
+class Ledger;
+
+/** Writes the state of a ledger as a stream of binary frames.
+
+    The entries are copied from the leaves of the state map as they are
+    stored, without being parsed, converted to JSON or hex encoded.
+
+    Every frame is a one byte type, then the length of the payload as a
+    32-bit big endian integer, then the payload:
+
+        header   The sequence (32 bits), the hash and the account state hash
+                 of the ledger. Always the first frame.
+        entries  One or more entries, each a 256-bit key followed by the
+                 length (32 bits) and the bytes of the serialized entry.
+        end      The number of entries exported (64 bits), followed by a key
+                 to resume from if the export stopped at its limit.
+        error    A message, if the state could not be read. Ends the stream.
+
+    Entries are in key order. An export resumed with the last key of any
+    complete entries frame as its marker continues right after that entry.
+*/
+class StateExport
+{
+public:
+    enum class Frame : std::uint8_t {
+        header = 1,
+        entries = 2,
+        end = 3,
+        error = 4,
+    };
+
+    static constexpr std::uint64_t noLimit =
+        std::numeric_limits<std::uint64_t>::max();
+
+    /** Export the entries of a ledger following a marker.
+
+        @param ledger The ledger, which must be immutable.
+        @param marker Only entries with greater keys are exported.
+        @param limit The most entries to export.
+    */
+    StateExport(
+        std::shared_ptr<Ledger const> ledger,
+        uint256 const& marker = beast::zero,
+        std::uint64_t limit = noLimit);
+
+    /** Append the next frames to s.
+
+        Entries are added to a frame until it holds about `bytes` of them.
+
+        @return `false` once the last frame has been appended.
+    */
+    bool
+    next(Serializer& s, std::size_t bytes);
+
+    /** The number of entries exported so far. */
+    std::uint64_t
+    count() const
+    {
+        return count_;
+    }
+
+    /** Whether the export ended with an error frame. */
+    bool
+    failed() const
+    {
+        return failed_;
+    }
+
+private:
+    std::shared_ptr<Ledger const> const ledger_;
+    uint256 marker_;
+    std::uint64_t const limit_;
+    std::uint64_t count_ = 0;
+    bool started_ = false;
+    bool done_ = false;
+    bool failed_ = false;
+};
+
+/** Write the whole state of a ledger to a stream, in StateExport frames.
+
+    @return `true` if every entry could be read.
+*/
+bool
+exportState(std::shared_ptr<Ledger const> const& ledger, std::ostream& out);
+
+}  // namespace ripple
+
+#endif
@@ -21,10 +21,13 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerReplay.h>
 #include <ripple/app/ledger/OpenLedger.h>
+#include <ripple/app/ledger/impl/SpeculativeApply.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/tx/apply.h>
+#include <ripple/core/Config.h>
 #include <ripple/protocol/Feature.h>
+#include <optional>
 
 namespace ripple {
 
@@ -67,7 +70,8 @@ buildLedgerImpl(
         // Write the final version of all modified SHAMap
         // nodes to the node store to preserve the new LCL
 
-        int const asf = built->stateMap().flushDirty(hotACCOUNT_NODE);
+        int const asf = built->stateMap().flushDirty(
+            hotACCOUNT_NODE, app.config().FLUSH_WORKERS);
         int const tmf = built->txMap().flushDirty(hotTRANSACTION_NODE);
         JLOG(j.debug()) << "Flushed " << asf << " accounts and " << tmf
                         << " transaction nodes";
@@ -103,6 +107,9 @@ applyTransactions(
     bool certainRetry = true;
     std::size_t count = 0;
 
+    // check all the signatures up front, rather than one per transaction
+    checkValidity(app.getHashRouter(), txns, view.rules(), app.config());
+
     // Attempt to apply all of the retriable transactions
     for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
     {
@@ -110,11 +117,27 @@ applyTransactions(
                         << " begins (" << txns.size() << " transactions)";
         int changes = 0;
 
+        // optionally pre-execute the pass on worker threads
+        std::optional<SpeculativeApply> speculative;
+        if (auto const threads = app.config().HOOK_SPECULATIVE_THREADS;
+            threads > 0 && txns.size() > 1)
+        {
+            std::vector<std::shared_ptr<STTx const>> pending;
+            pending.reserve(txns.size());
+            for (auto const& item : txns)
+                pending.push_back(item.second);
+
+            speculative.emplace(
+                app, view, std::move(pending), certainRetry, threads, j);
+        }
+
         auto it = txns.begin();
+        std::size_t position = 0;
 
         while (it != txns.end())
         {
             auto const txid = it->first.getTXID();
+            auto const index = position++;
 
 #ifndef DEBUG
             try
@@ -126,8 +149,12 @@ applyTransactions(
                     continue;
                 }
 
-                switch (applyTransaction(
-                    app, view, *it->second, certainRetry, tapNONE, j))
+                auto const result = speculative
+                    ? speculative->apply(view, index)
+                    : applyTransaction(
+                          app, view, *it->second, certainRetry, tapNONE, j);
+
+                switch (result)
                 {
                     case ApplyResult::Success:
                         it = txns.erase(it);
@@ -157,6 +184,14 @@ applyTransactions(
         JLOG(j.debug()) << (certainRetry ? "Pass: " : "Final pass: ") << pass
                         << " completed (" << changes << " changes)";
 
+        if (speculative)
+        {
+            JLOG(j.debug()) << "Pass: " << pass << " committed "
+                            << speculative->committed()
+                            << " speculative results, re-executed "
+                            << speculative->reexecuted();
+        }
+
         // Accumulate changes.
         count += changes;
 
@@ -0,0 +1,405 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/applyHook.h>
+#include <ripple/app/ledger/impl/SpeculativeApply.h>
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/scope.h>
+#include <ripple/protocol/STObject.h>
+#include <ripple/protocol/Serializer.h>
+
+namespace ripple {
+
+namespace {
+
+// A read only view which forwards to another view, recording what is read.
+class RecordingView : public ReadView
+{
+    ReadView const& base_;
+
+public:
+    // (from, to] ranges examined by succ, to is unbounded when empty
+    using Range = std::pair<uint256, std::optional<uint256>>;
+
+    mutable std::vector<uint256> reads;
+    mutable std::vector<Range> ranges;
+    mutable std::vector<uint256> txReads;
+    mutable bool iterated = false;
+
+    explicit RecordingView(ReadView const& base) : base_(base)
+    {
+    }
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    bool
+    open() const override
+    {
+        return base_.open();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    bool
+    exists(Keylet const& k) const override
+    {
+        reads.push_back(k.key);
+        return base_.exists(k);
+    }
+
+    std::optional<key_type>
+    succ(key_type const& key, std::optional<key_type> const& last)
+        const override
+    {
+        auto const next = base_.succ(key, last);
+        ranges.emplace_back(key, next ? next : last);
+        return next;
+    }
+
+    std::shared_ptr<SLE const>
+    read(Keylet const& k) const override
+    {
+        reads.push_back(k.key);
+        return base_.read(k);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        iterated = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        iterated = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound(key_type const& key) const override
+    {
+        iterated = true;
+        return base_.slesUpperBound(key);
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        iterated = true;
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        iterated = true;
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists(key_type const& key) const override
+    {
+        txReads.push_back(key);
+        return base_.txExists(key);
+    }
+
+    tx_type
+    txRead(key_type const& key) const override
+    {
+        txReads.push_back(key);
+        return base_.txRead(key);
+    }
+};
+
+// Forwards the changes of a transaction to the view being built, recording
+// the keys written. Without a destination only the keys are recorded.
+class CommitView : public TxsRawView
+{
+    OpenView* to_;
+
+public:
+    std::vector<uint256> keys;
+    std::vector<uint256> txs;
+
+    explicit CommitView(OpenView* to) : to_(to)
+    {
+    }
+
+    void
+    rawErase(std::shared_ptr<SLE> const& sle) override
+    {
+        keys.push_back(sle->key());
+        if (to_)
+            to_->rawErase(sle);
+    }
+
+    void
+    rawInsert(std::shared_ptr<SLE> const& sle) override
+    {
+        keys.push_back(sle->key());
+        if (to_)
+            to_->rawInsert(sle);
+    }
+
+    void
+    rawReplace(std::shared_ptr<SLE> const& sle) override
+    {
+        keys.push_back(sle->key());
+        if (to_)
+            to_->rawReplace(sle);
+    }
+
+    void
+    rawDestroyXRP(XRPAmount const& fee) override
+    {
+        if (to_)
+            to_->rawDestroyXRP(fee);
+    }
+
+    void
+    rawTxInsert(
+        ReadView::key_type const& key,
+        std::shared_ptr<Serializer const> const& txn,
+        std::shared_ptr<Serializer const> const& metaData) override
+    {
+        txs.push_back(key);
+        if (!to_)
+            return;
+
+        // the transaction was executed in a view of its own, so its
+        // metadata carries the wrong position within the ledger
+        auto meta = metaData;
+        if (meta)
+        {
+            SerialIter sit(meta->slice());
+            STObject obj(sit, sfMetadata);
+            auto const index = static_cast<std::uint32_t>(to_->txCount());
+            if (obj.getFieldU32(sfTransactionIndex) != index)
+            {
+                obj.setFieldU32(sfTransactionIndex, index);
+                auto s = std::make_shared<Serializer>();
+                obj.add(*s);
+                meta = std::move(s);
+            }
+        }
+
+        to_->rawTxInsert(key, txn, meta);
+    }
+};
+
+bool
+speculable(STTx const& tx)
+{
+    // these depend on, or change, the total XRP in the view header
+    auto const tt = tx.getTxnType();
+    return !isPseudoTx(tx) && tt != ttIMPORT && tt != ttGENESIS_MINT;
+}
+
+// Kept for the life of the process, sized by the first pass to use it.
+detail::ParallelPool&
+pool(std::size_t threads)
+{
+    static detail::ParallelPool pool(threads);
+    return pool;
+}
+
+}  // namespace
+
+struct SpeculativeApply::Speculation
+{
+    std::unique_ptr<RecordingView> recorder;
+    std::unique_ptr<OpenView> view;
+    ApplyResult result = ApplyResult::Retry;
+
+    // transactions emitted by its hooks, marked in the HashRouter only if
+    // the result is committed
+    std::vector<uint256> emitted;
+};
+
+SpeculativeApply::SpeculativeApply(
+    Application& app,
+    OpenView const& view,
+    std::vector<std::shared_ptr<STTx const>> txns,
+    bool retryAssured,
+    std::size_t threads,
+    beast::Journal j)
+    : app_(app)
+    , j_(j)
+    , snapshot_(view)
+    , txns_(std::move(txns))
+    , retryAssured_(retryAssured)
+    , results_(txns_.size())
+    , done_(txns_.size(), false)
+    , pool_(pool(threads))
+{
+    batch_ = pool_.start(
+        std::min(threads, txns_.size()), [this](std::size_t) { work(); });
+}
+
+SpeculativeApply::~SpeculativeApply()
+{
+    stop_ = true;
+    pool_.finish(batch_);
+}
+
+void
+SpeculativeApply::work()
+{
+    // speculative executions are not logged, they may be thrown away
+    beast::Journal const quiet{beast::Journal::getNullSink()};
+
+    while (!stop_)
+    {
+        auto const index = next_++;
+        if (index >= txns_.size())
+            return;
+
+        std::unique_ptr<Speculation> spec;
+        auto const& tx = *txns_[index];
+
+        if (speculable(tx))
+        {
+            try
+            {
+                auto const reads = hook::externalReads();
+                auto s = std::make_unique<Speculation>();
+                s->recorder = std::make_unique<RecordingView>(snapshot_);
+                s->view = std::make_unique<OpenView>(s->recorder.get());
+                {
+                    hook::deferredEmissions() = &s->emitted;
+                    scope_exit restore(
+                        []() { hook::deferredEmissions() = nullptr; });
+                    s->result = applyTransaction(
+                        app_, *s->view, tx, retryAssured_, tapNONE, quiet);
+                }
+                if (hook::externalReads() == reads)
+                    spec = std::move(s);
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(j_.debug()) << "Speculation of " << tx.getTransactionID()
+                                 << " throws: " << e.what();
+            }
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            results_[index] = std::move(spec);
+            done_[index] = true;
+        }
+        ready_.notify_all();
+    }
+}
+
+bool
+SpeculativeApply::conflicts(Speculation const& spec) const
+{
+    auto const& rec = *spec.recorder;
+    if (rec.iterated)
+        return true;
+
+    if (written_.empty() && inserted_.empty())
+        return false;
+
+    for (auto const& key : rec.reads)
+    {
+        if (written_.count(key))
+            return true;
+    }
+
+    for (auto const& [from, to] : rec.ranges)
+    {
+        auto const it = written_.upper_bound(from);
+        if (it != written_.end() && (!to || *it <= *to))
+            return true;
+    }
+
+    for (auto const& key : rec.txReads)
+    {
+        if (inserted_.count(key))
+            return true;
+    }
+
+    // entries created without being read first
+    CommitView keys(nullptr);
+    spec.view->apply(keys);
+    for (auto const& key : keys.keys)
+    {
+        if (written_.count(key))
+            return true;
+    }
+
+    return false;
+}
+
+ApplyResult
+SpeculativeApply::apply(OpenView& view, std::size_t index)
+{
+    std::unique_ptr<Speculation> spec;
+    {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [&]() { return done_[index]; });
+        spec = std::move(results_[index]);
+    }
+
+    auto record = [this](CommitView const& commit) {
+        written_.insert(commit.keys.begin(), commit.keys.end());
+        inserted_.insert(commit.txs.begin(), commit.txs.end());
+    };
+
+    if (spec && !conflicts(*spec))
+    {
+        CommitView commit(&view);
+        spec->view->apply(commit);
+        record(commit);
+        for (auto const& id : spec->emitted)
+            app_.getHashRouter().setFlags(id, SF_EMITTED);
+        ++committed_;
+        return spec->result;
+    }
+
+    // executing in a child view lets us see what the transaction wrote
+    OpenView child(&view);
+    auto const result = applyTransaction(
+        app_, child, *txns_[index], retryAssured_, tapNONE, j_);
+    CommitView commit(&view);
+    child.apply(commit);
+    record(commit);
+    ++reexecuted_;
+    return result;
+}
+
+}  // namespace ripple
@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_SPECULATIVEAPPLY_H_INCLUDED
+#define RIPPLE_APP_LEDGER_SPECULATIVEAPPLY_H_INCLUDED
+
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/parallel.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/protocol/STTx.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+
+/** Speculative execution of one pass of consensus transactions.
+
+    The threads of a pool kept for the process execute the transactions,
+    hooks included, in canonical order against a snapshot of the view taken
+    when the pass starts. Each speculative execution records every ledger
+    entry it read. The caller then
+    commits the transactions one at a time, in the same order, with apply().
+
+    A speculative result is committed only if no transaction committed
+    earlier in the pass wrote anything it read or wrote. Otherwise the
+    transaction is executed again against the current view. Either way the
+    view ends up exactly as if every transaction had been applied serially.
+    Transactions emitted by hooks are only marked as emitted in the
+    HashRouter once the speculation that emitted them is committed.
+
+    Transactions whose outcome depends on more than the ledger entries they
+    read, such as pseudo-transactions, those minting XRP and those whose
+    hooks read the open ledger, are always executed again.
+*/
+class SpeculativeApply
+{
+public:
+    SpeculativeApply(
+        Application& app,
+        OpenView const& view,
+        std::vector<std::shared_ptr<STTx const>> txns,
+        bool retryAssured,
+        std::size_t threads,
+        beast::Journal j);
+
+    SpeculativeApply(SpeculativeApply const&) = delete;
+    SpeculativeApply&
+    operator=(SpeculativeApply const&) = delete;
+
+    ~SpeculativeApply();
+
+    /** Apply the transaction at position index of the pass to view.
+
+        Must be called with increasing positions, although positions may be
+        skipped. Has the same effect and result as applyTransaction.
+    */
+    ApplyResult
+    apply(OpenView& view, std::size_t index);
+
+    // transactions whose speculative result was used
+    std::size_t
+    committed() const
+    {
+        return committed_;
+    }
+
+    // transactions that had to be executed again
+    std::size_t
+    reexecuted() const
+    {
+        return reexecuted_;
+    }
+
+private:
+    struct Speculation;
+
+    void
+    work();
+
+    bool
+    conflicts(Speculation const& spec) const;
+
+    Application& app_;
+    beast::Journal const j_;
+    OpenView const snapshot_;
+    std::vector<std::shared_ptr<STTx const>> const txns_;
+    bool const retryAssured_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::vector<std::unique_ptr<Speculation>> results_;
+    std::vector<bool> done_;
+    std::atomic<std::size_t> next_{0};
+    std::atomic<bool> stop_{false};
+    detail::ParallelPool& pool_;
+    std::shared_ptr<detail::ParallelPool::Batch> batch_;
+
+    // touched only by the thread calling apply()
+    std::set<uint256> written_;  // ordered, for successor range checks
+    hash_set<uint256> inserted_;  // transactions committed in this pass
+    std::size_t committed_ = 0;
+    std::size_t reexecuted_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
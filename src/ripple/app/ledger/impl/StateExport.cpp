@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/StateExport.h>
+
+namespace ripple {
+
+namespace {
+
+void
+addFrame(Serializer& s, StateExport::Frame type, Slice payload)
+{
+    s.add8(static_cast<std::uint8_t>(type));
+    s.add32(static_cast<std::uint32_t>(payload.size()));
+    s.addRaw(payload);
+}
+
+}  // namespace
+
+StateExport::StateExport(
+    std::shared_ptr<Ledger const> ledger,
+    uint256 const& marker,
+    std::uint64_t limit)
+    : ledger_(std::move(ledger)), marker_(marker), limit_(limit)
+{
+    assert(ledger_ && ledger_->isImmutable());
+}
+
+bool
+StateExport::next(Serializer& s, std::size_t bytes)
+{
+    if (done_)
+        return false;
+
+    if (!started_)
+    {
+        auto const& info = ledger_->info();
+        Serializer header(4 + 2 * uint256::size());
+        header.add32(info.seq);
+        header.addBitString(info.hash);
+        header.addBitString(info.accountHash);
+        addFrame(s, Frame::header, header.slice());
+        started_ = true;
+    }
+
+    Serializer entries(static_cast<int>(bytes) + 4096);
+    bool full = false;
+    try
+    {
+        auto const& map = ledger_->stateMap();
+        auto const end = map.end();
+        for (auto it = map.upper_bound(marker_); it != end; ++it)
+        {
+            if (count_ == limit_ || entries.size() >= bytes)
+            {
+                full = true;
+                break;
+            }
+
+            auto const& item = *it;
+            entries.addBitString(item.key());
+            entries.add32(static_cast<std::uint32_t>(item.size()));
+            entries.addRaw(item.slice());
+            marker_ = item.key();
+            ++count_;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        if (entries.size() != 0)
+            addFrame(s, Frame::entries, entries.slice());
+        addFrame(s, Frame::error, makeSlice(std::string(e.what())));
+        done_ = true;
+        failed_ = true;
+        return false;
+    }
+
+    if (entries.size() != 0)
+        addFrame(s, Frame::entries, entries.slice());
+
+    // Stopping short of the limit only to start a new frame
+    if (full && count_ != limit_)
+        return true;
+
+    Serializer tail(8 + uint256::size());
+    tail.add64(count_);
+    if (full)
+        tail.addBitString(marker_);
+    addFrame(s, Frame::end, tail.slice());
+    done_ = true;
+    return false;
+}
+
+bool
+exportState(std::shared_ptr<Ledger const> const& ledger, std::ostream& out)
+{
+    StateExport state(ledger);
+    Serializer s;
+    bool more;
+    do
+    {
+        s.erase();
+        more = state.next(s, 1024 * 1024);
+        out.write(static_cast<char const*>(s.data()), s.size());
+    } while (more && out);
+
+    return out && !state.failed();
+}
+
+}  // namespace ripple
@@ -47,6 +47,7 @@
 #include <ripple/app/paths/PathRequests.h>
 #include <ripple/app/rdb/Wallet.h>
 #include <ripple/app/rdb/backend/PostgresDatabase.h>
+#include <ripple/app/rdb/backend/SQLiteDatabase.h>
 #include <ripple/app/reporting/ReportingETL.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/basics/ByteUtilities.h>
@@ -84,6 +85,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstring>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <mutex>
@@ -1477,8 +1479,27 @@ ApplicationImp::setup(boost::program_options::variables_map const& cmdline)
              RPC::apiMaximumSupportedVersion},
             jvCommand};
 
+        // Run as any other request, on a coroutine it may suspend
         Json::Value jvResult;
-        RPC::doCommand(context, jvResult);
+        std::promise<void> done;
+        auto const coro = m_jobQueue->postCoroTask(
+            jtCLIENT_RPC,
+            "RPC-Startup",
+            [&](std::shared_ptr<JobQueue::CoroTask> coro)
+                -> JobQueue::CoroTask::Body {
+                context.coro = std::move(coro);
+                try
+                {
+                    co_await RPC::doCommand(context, jvResult);
+                    done.set_value();
+                }
+                catch (...)
+                {
+                    done.set_exception(std::current_exception());
+                }
+            });
+        if (coro)
+            done.get_future().get();
 
         if (!config_->quiet())
         {
@@ -1646,6 +1667,8 @@ ApplicationImp::run()
         reportingETL_->stop();
     if (auto pg = dynamic_cast<PostgresDatabase*>(&*mRelationalDatabase))
         pg->stop();
+    if (auto sqlite = dynamic_cast<SQLiteDatabase*>(&*mRelationalDatabase))
+        sqlite->stop();
     m_nodeStore->stop();
     perfLog_->stop();
 
@@ -60,7 +60,9 @@ template <
     bool IsKeyCache,
     class Hash,
     class KeyEqual,
-    class Mutex>
+    class Mutex,
+    class SharedPointerType,
+    class WeakPointerType>
 class TaggedCache;
 class STLedgerEntry;
 using SLE = STLedgerEntry;
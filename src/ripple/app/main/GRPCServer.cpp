@@ -119,11 +119,13 @@ GRPCServerImpl::CallData<Request, Response>::process()
     // ensures that finished is always true when this CallData object
     // is returned as a tag in handleRpcs(), after sending the response
     finished_ = true;
-    auto coro = app_.getJobQueue().postCoro(
+    auto coro = app_.getJobQueue().postCoroTask(
         JobType::jtRPC,
         "gRPC-Client",
-        [thisShared](std::shared_ptr<JobQueue::Coro> coro) {
+        [thisShared](std::shared_ptr<JobQueue::CoroTask> coro)
+            -> JobQueue::CoroTask::Body {
             thisShared->process(coro);
+            co_return;
         });
 
     // If coro is null, then the JobQueue has already been shutdown
@@ -138,7 +140,7 @@ GRPCServerImpl::CallData<Request, Response>::process()
 template <class Request, class Response>
 void
 GRPCServerImpl::CallData<Request, Response>::process(
-    std::shared_ptr<JobQueue::Coro> coro)
+    std::shared_ptr<JobQueue::CoroTask> coro)
 {
     try
     {
@@ -227,7 +227,7 @@ private:
     private:
         // process the request. Called inside the coroutine passed to JobQueue
         void
-        process(std::shared_ptr<JobQueue::Coro> coro);
+        process(std::shared_ptr<JobQueue::CoroTask> coro);
 
         // return load type of this RPC
         Resource::Charge
@@ -16,8 +16,11 @@
     OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 //==============================================================================
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/StateExport.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/DBInit.h>
+#include <ripple/app/rdb/MigrateTxIndex.h>
 #include <ripple/app/rdb/Vacuum.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/StringUtilities.h>
@@ -46,6 +49,7 @@
 #include <boost/program_options.hpp>
 
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <utility>
@@ -384,7 +388,11 @@ run(int argc, char** argv)
         "version", "Display the build version.");
 
     po::options_description data("Ledger/Data Options");
-    data.add_options()("import", importText.c_str())(
+    data.add_options()(
+        "export-state",
+        po::value<std::string>(),
+        "Write the state of the loaded ledger to the given file and exit.")(
+        "import", importText.c_str())(
         "ledger",
         po::value<std::string>(),
         "Load the specified ledger and start from the value given.")(
@@ -392,6 +400,8 @@ run(int argc, char** argv)
         po::value<std::string>(),
         "Load the specified ledger file.")(
         "load", "Load the current ledger from the local DB.")(
+        "migrate-txindex",
+        "Copy the transaction db into a transaction index.")(
         "net", "Get the initial ledger from the network.")(
         "nodetoshard", "Import node store into shards")(
         "replay", "Replay a ledger close.")(
@@ -604,6 +614,30 @@ run(int argc, char** argv)
         return 0;
     }
 
+    if (vm.count("migrate-txindex"))
+    {
+        if (config->standalone())
+        {
+            std::cerr << "migrate-txindex not applicable in standalone mode.\n";
+            return -1;
+        }
+
+        try
+        {
+            auto setup = setup_DatabaseCon(*config);
+            if (!doMigrateTxIndex(setup))
+                return -1;
+        }
+        catch (std::exception const& e)
+        {
+            std::cerr << "exception " << e.what() << " in function " << __func__
+                      << std::endl;
+            return -1;
+        }
+
+        return 0;
+    }
+
     if (vm.count("start"))
     {
         config->START_UP = Config::FRESH;
@@ -762,6 +796,25 @@ run(int argc, char** argv)
         if (!app->setup(vm))
             return -1;
 
+        if (vm.count("export-state"))
+        {
+            auto const path = vm["export-state"].as<std::string>();
+            auto const ledger = app->getLedgerMaster().getClosedLedger();
+            auto j = app->logs().journal("Application");
+
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            bool const ok = out && exportState(ledger, out);
+            if (ok)
+                JLOG(j.warn()) << "Exported the state of ledger "
+                               << ledger->info().seq << " to " << path;
+            else
+                JLOG(j.fatal()) << "Unable to export ledger state to " << path;
+
+            app->signalStop();
+            app->run();
+            return ok ? 0 : -1;
+        }
+
         // With our configuration parsed, ensure we have
         // enough file descriptors available:
         if (!adjustDescriptorLimit(
@@ -33,6 +33,7 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SubscriptionMatcher.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
@@ -60,6 +61,7 @@
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/BuildInfo.h>
 #include <ripple/protocol/Feature.h>
+#include <ripple/protocol/JsonMembers.h>
 #include <ripple/protocol/STParsedJSON.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/resource/ResourceManager.h>
@@ -287,6 +289,21 @@ public:
         bool bLocal,
         FailHard failType) override;
 
+    void
+    processTransactionSet(
+        std::vector<std::shared_ptr<Transaction>>& transactions,
+        bool bUnlimited) override;
+
+    /**
+     * Checks shared by all transactions before they are queued to be applied.
+     *
+     * @param transaction Transaction object, replaced by the canonical
+     *        instance of the transaction.
+     * @return false if the transaction must not be applied.
+     */
+    bool
+    preProcessTransaction(std::shared_ptr<Transaction>& transaction);
+
     /**
      * For transactions submitted directly by a client, apply batch of
      * transactions and wait for this transaction to complete.
@@ -626,15 +643,30 @@ private:
         bool validated,
         std::shared_ptr<ReadView const> const& ledger);
 
+    Json::Value
+    metaJson(
+        AcceptedLedgerTx const& transaction,
+        std::shared_ptr<ReadView const> const& ledger);
+
+    // Time spent publishing the transactions of a ledger, per stream.
+    struct PublishTimes
+    {
+        std::chrono::steady_clock::duration transactions{};
+        std::chrono::steady_clock::duration books{};
+        std::chrono::steady_clock::duration accounts{};
+    };
+
     void
     pubValidatedTransaction(
         std::shared_ptr<ReadView const> const& ledger,
-        AcceptedLedgerTx const& transaction);
+        AcceptedLedgerTx const& transaction,
+        PublishTimes& times);
 
     void
     pubAccountTransaction(
         std::shared_ptr<ReadView const> const& ledger,
-        AcceptedLedgerTx const& transaction);
+        AcceptedLedgerTx const& transaction,
+        std::shared_ptr<InfoSub::Message const> const& message);
 
     void
     pubProposedAccountTransaction(
@@ -652,7 +684,6 @@ private:
 
 private:
     using SubMapType = hash_map<std::uint64_t, InfoSub::wptr>;
-    using SubInfoMapType = hash_map<AccountID, SubMapType>;
     using subRpcMapType = hash_map<std::string, InfoSub::pointer>;
 
     /*
@@ -737,8 +768,7 @@ private:
 
     LedgerMaster& m_ledgerMaster;
 
-    SubInfoMapType mSubAccount;
-    SubInfoMapType mSubRTAccount;
+    SubscriptionMatcher mSubscriptions;
 
     subRpcMapType mRpcSubMap;
 
@@ -816,6 +846,11 @@ private:
                   "Tracking_transitions"))
             , full_transitions(
                   collector->make_gauge("State_Accounting", "Full_transitions"))
+            , ledger_publish(collector->make_event("Publish", "ledger"))
+            , transactions_publish(
+                  collector->make_event("Publish", "transactions"))
+            , books_publish(collector->make_event("Publish", "books"))
+            , accounts_publish(collector->make_event("Publish", "accounts"))
         {
         }
 
@@ -831,6 +866,12 @@ private:
         beast::insight::Gauge syncing_transitions;
         beast::insight::Gauge tracking_transitions;
         beast::insight::Gauge full_transitions;
+
+        // time taken to publish each validated ledger, per stream
+        beast::insight::Event ledger_publish;
+        beast::insight::Event transactions_publish;
+        beast::insight::Event books_publish;
+        beast::insight::Event accounts_publish;
     };
 
     std::mutex m_statsMutex;  // Mutex to lock m_stats
@@ -1214,6 +1255,53 @@ NetworkOPsImp::processTransaction(
 {
     auto ev = m_job_queue.makeLoadEvent(jtTXN_PROC, "ProcessTXN");
 
+    if (!preProcessTransaction(transaction))
+        return;
+
+    if (bLocal)
+        doTransactionSync(transaction, bUnlimited, failType);
+    else
+        doTransactionAsync(transaction, bUnlimited, failType);
+}
+
+void
+NetworkOPsImp::processTransactionSet(
+    std::vector<std::shared_ptr<Transaction>>& transactions,
+    bool bUnlimited)
+{
+    auto ev = m_job_queue.makeLoadEvent(jtTXN_PROC, "ProcessTXNSet");
+
+    std::vector<bool> accepted;
+    accepted.reserve(transactions.size());
+    for (auto& transaction : transactions)
+        accepted.push_back(preProcessTransaction(transaction));
+
+    std::lock_guard lock(mMutex);
+
+    for (std::size_t i = 0; i < transactions.size(); ++i)
+    {
+        auto const& transaction = transactions[i];
+        if (!accepted[i] || transaction->getApplying())
+            continue;
+
+        mTransactions.push_back(
+            TransactionStatus(transaction, bUnlimited, false, FailHard::no));
+        transaction->setApplying();
+    }
+
+    if (!mTransactions.empty() && mDispatchState == DispatchState::none)
+    {
+        if (m_job_queue.addJob(
+                jtBATCH, "transactionBatch", [this]() { transactionBatch(); }))
+        {
+            mDispatchState = DispatchState::scheduled;
+        }
+    }
+}
+
+bool
+NetworkOPsImp::preProcessTransaction(std::shared_ptr<Transaction>& transaction)
+{
     auto const view = m_ledgerMaster.getCurrentLedger();
 
     // This function is called by several different parts of the codebase
@@ -1228,7 +1316,7 @@ NetworkOPsImp::processTransaction(
     {
         // RH NOTE: cannot set SF_BAD because if the tx will be generated by a
         // hook we are about to execute
-        return;
+        return false;
     }
 
     auto const newFlags = app_.getHashRouter().getFlags(transaction->getID());
@@ -1239,7 +1327,7 @@ NetworkOPsImp::processTransaction(
         JLOG(m_journal.warn()) << transaction->getID() << ": cached bad!\n";
         transaction->setStatus(INVALID);
         transaction->setResult(temBAD_SIGNATURE);
-        return;
+        return false;
     }
 
     // NOTE eahennis - I think this check is redundant,
@@ -1259,16 +1347,13 @@ NetworkOPsImp::processTransaction(
         transaction->setStatus(INVALID);
         transaction->setResult(temBAD_SIGNATURE);
         app_.getHashRouter().setFlags(transaction->getID(), SF_BAD);
-        return;
+        return false;
     }
 
     // canonicalize can change our pointer
     app_.getMasterTransaction().canonicalize(&transaction);
 
-    if (bLocal)
-        doTransactionSync(transaction, bUnlimited, failType);
-    else
-        doTransactionAsync(transaction, bUnlimited, failType);
+    return true;
 }
 
 void
@@ -2539,6 +2624,10 @@ NetworkOPsImp::getServerInfo(bool human, bool admin, bool counters)
         {
             info[jss::pubkey_validator] = "none";
         }
+
+        if (auto const db = dynamic_cast<SQLiteDatabase*>(
+                &app_.getRelationalDatabase()))
+            info[jss::ledger_writes] = db->getLedgerWriteInfo();
     }
 
     if (counters)
@@ -2914,15 +3003,9 @@ getAccounts(Json::Value const& jvObj, std::vector<AccountID>& accounts)
 void
 NetworkOPsImp::forwardProposedAccountTransaction(Json::Value const& jvObj)
 {
-    hash_set<InfoSub::pointer> notify;
-    int iProposed = 0;
     // check if there are any subscribers before attempting to parse the JSON
-    {
-        std::lock_guard sl(mSubLock);
-
-        if (mSubRTAccount.empty())
-            return;
-    }
+    if (!mSubscriptions.hasAccounts(true))
+        return;
 
     // parse the JSON outside of the lock
     std::vector<AccountID> accounts;
@@ -2940,43 +3023,12 @@ NetworkOPsImp::forwardProposedAccountTransaction(Json::Value const& jvObj)
             return;
         }
     }
-    {
-        std::lock_guard sl(mSubLock);
-
-        if (!mSubRTAccount.empty())
-        {
-            for (auto const& affectedAccount : accounts)
-            {
-                auto simiIt = mSubRTAccount.find(affectedAccount);
-                if (simiIt != mSubRTAccount.end())
-                {
-                    auto it = simiIt->second.begin();
-
-                    while (it != simiIt->second.end())
-                    {
-                        InfoSub::pointer p = it->second.lock();
-
-                        if (p)
-                        {
-                            notify.insert(p);
-                            ++it;
-                            ++iProposed;
-                        }
-                        else
-                            it = simiIt->second.erase(it);
-                    }
-                }
-            }
-        }
-    }
+    auto const notify = mSubscriptions.matchAccounts(accounts, false);
     JLOG(m_journal.trace()) << "forwardProposedAccountTransaction:"
-                            << " iProposed=" << iProposed;
+                            << " iProposed=" << notify.size();
 
-    if (!notify.empty())
-    {
-        for (InfoSub::ref isrListener : notify)
-            isrListener->send(jvObj, true);
-    }
+    for (InfoSub::ref isrListener : notify)
+        isrListener->send(jvObj, true);
 }
 
 void
@@ -2996,6 +3048,8 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
 
     assert(alpAccepted->getLedger().get() == lpAccepted.get());
 
+    app_.getOrderBookDB().applyLedger(*alpAccepted);
+
     {
         JLOG(m_journal.debug())
             << "Publishing ledger " << lpAccepted->info().seq << " "
@@ -3005,6 +3059,7 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
 
         if (!mStreamMaps[sLedger].empty())
         {
+            auto const start = std::chrono::steady_clock::now();
             Json::Value jvObj(Json::objectValue);
 
             jvObj[jss::type] = "ledgerClosed";
@@ -3041,6 +3096,9 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
                 else
                     it = mStreamMaps[sLedger].erase(it);
             }
+
+            m_stats.ledger_publish.notify(
+                std::chrono::steady_clock::now() - start);
         }
 
         if (!mStreamMaps[sBookChanges].empty())
@@ -3084,11 +3142,16 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
     }
 
     // Don't lock since pubAcceptedTransaction is locking.
+    PublishTimes times;
     for (auto const& accTx : *alpAccepted)
     {
         JLOG(m_journal.trace()) << "pubAccepted: " << accTx->getJson();
-        pubValidatedTransaction(lpAccepted, *accTx);
+        pubValidatedTransaction(lpAccepted, *accTx, times);
     }
+
+    m_stats.transactions_publish.notify(times.transactions);
+    m_stats.books_publish.notify(times.books);
+    m_stats.accounts_publish.notify(times.accounts);
 }
 
 void
@@ -3147,7 +3210,10 @@ NetworkOPsImp::transJson(
     transResultInfo(result, sToken, sHuman);
 
     jvObj[jss::type] = "transaction";
-    jvObj[jss::transaction] = transaction.getJson(JsonOptions::none);
+
+    // the transaction goes straight to JSON text, see JsonMembers
+    JsonMembers tx(transaction);
+    tx[jss::hash] = to_string(transaction.getTransactionID());
 
     // add CTID where the needed data for it exists
     if (auto const& lookup = ledger->txRead(transaction.getTransactionID());
@@ -3172,8 +3238,7 @@ NetworkOPsImp::transJson(
     {
         jvObj[jss::ledger_index] = ledger->info().seq;
         jvObj[jss::ledger_hash] = to_string(ledger->info().hash);
-        jvObj[jss::transaction][jss::date] =
-            ledger->info().closeTime.time_since_epoch().count();
+        tx[jss::date] = ledger->info().closeTime.time_since_epoch().count();
         jvObj[jss::validated] = true;
 
         // WRITEME: Put the account next seq here
@@ -3203,28 +3268,46 @@ NetworkOPsImp::transJson(
                 amount,
                 fhIGNORE_FREEZE,
                 app_.journal("View"));
-            jvObj[jss::transaction][jss::owner_funds] = ownerFunds.getText();
+            tx[jss::owner_funds] = ownerFunds.getText();
         }
     }
 
+    jvObj[jss::transaction] = tx.raw();
     return jvObj;
 }
 
+// The metadata of a validated transaction, as JSON text.
+Json::Value
+NetworkOPsImp::metaJson(
+    AcceptedLedgerTx const& transaction,
+    std::shared_ptr<ReadView const> const& ledger)
+{
+    auto const& meta = transaction.getMeta();
+    auto const object = meta.getAsObject();
+    JsonMembers members(object);
+    RPC::insertDeliveredAmount(members, *ledger, transaction.getTxn(), meta);
+    return members.raw();
+}
+
 void
 NetworkOPsImp::pubValidatedTransaction(
     std::shared_ptr<ReadView const> const& ledger,
-    const AcceptedLedgerTx& transaction)
+    const AcceptedLedgerTx& transaction,
+    PublishTimes& times)
 {
+    using clock_type = std::chrono::steady_clock;
+    auto start = clock_type::now();
+
     auto const& stTxn = transaction.getTxn();
 
     Json::Value jvObj =
         transJson(*stTxn, transaction.getResult(), true, ledger);
+    jvObj[jss::meta] = metaJson(transaction, ledger);
 
-    {
-        auto const& meta = transaction.getMeta();
-        jvObj[jss::meta] = meta.getJson(JsonOptions::none);
-        RPC::insertDeliveredAmount(jvObj[jss::meta], *ledger, stTxn, meta);
-    }
+    // Every stream and subscriber is sent this one message, so the
+    // transaction is serialized at most once.
+    auto const message =
+        std::make_shared<InfoSub::Message const>(std::move(jvObj));
 
     {
         std::lock_guard sl(mSubLock);
@@ -3236,7 +3319,7 @@ NetworkOPsImp::pubValidatedTransaction(
 
             if (p)
             {
-                p->send(jvObj, true);
+                p->send(message, true);
                 ++it;
             }
             else
@@ -3251,7 +3334,7 @@ NetworkOPsImp::pubValidatedTransaction(
 
             if (p)
             {
-                p->send(jvObj, true);
+                p->send(message, true);
                 ++it;
             }
             else
@@ -3259,70 +3342,42 @@ NetworkOPsImp::pubValidatedTransaction(
         }
     }
 
+    auto now = clock_type::now();
+    times.transactions += now - start;
+
     if (isTesSuccess(transaction.getResult()))
-        app_.getOrderBookDB().processTxn(ledger, transaction, jvObj);
+    {
+        start = now;
+        for (InfoSub::ref isrListener :
+             mSubscriptions.matchBooks(transaction.getMeta()))
+            isrListener->send(message, true);
+        now = clock_type::now();
+        times.books += now - start;
+    }
 
-    pubAccountTransaction(ledger, transaction);
+    start = now;
+    pubAccountTransaction(ledger, transaction, message);
+    times.accounts += clock_type::now() - start;
 }
 
 void
 NetworkOPsImp::pubAccountTransaction(
     std::shared_ptr<ReadView const> const& ledger,
-    AcceptedLedgerTx const& transaction)
+    AcceptedLedgerTx const& transaction,
+    std::shared_ptr<InfoSub::Message const> const& message)
 {
-    hash_set<InfoSub::pointer> notify;
-    int iProposed = 0;
-    int iAccepted = 0;
+    auto const notify =
+        mSubscriptions.matchAccounts(transaction.getAffected(), true);
 
     std::vector<SubAccountHistoryInfo> accountHistoryNotify;
     auto const currLedgerSeq = ledger->seq();
     {
         std::lock_guard sl(mSubLock);
 
-        if (!mSubAccount.empty() || !mSubRTAccount.empty() ||
-            !mSubAccountHistory.empty())
+        if (!mSubAccountHistory.empty())
         {
             for (auto const& affectedAccount : transaction.getAffected())
             {
-                if (auto simiIt = mSubRTAccount.find(affectedAccount);
-                    simiIt != mSubRTAccount.end())
-                {
-                    auto it = simiIt->second.begin();
-
-                    while (it != simiIt->second.end())
-                    {
-                        InfoSub::pointer p = it->second.lock();
-
-                        if (p)
-                        {
-                            notify.insert(p);
-                            ++it;
-                            ++iProposed;
-                        }
-                        else
-                            it = simiIt->second.erase(it);
-                    }
-                }
-
-                if (auto simiIt = mSubAccount.find(affectedAccount);
-                    simiIt != mSubAccount.end())
-                {
-                    auto it = simiIt->second.begin();
-                    while (it != simiIt->second.end())
-                    {
-                        InfoSub::pointer p = it->second.lock();
-
-                        if (p)
-                        {
-                            notify.insert(p);
-                            ++it;
-                            ++iAccepted;
-                        }
-                        else
-                            it = simiIt->second.erase(it);
-                    }
-                }
-
                 if (auto histoIt = mSubAccountHistory.find(affectedAccount);
                     histoIt != mSubAccountHistory.end())
                 {
@@ -3356,25 +3411,15 @@ NetworkOPsImp::pubAccountTransaction(
     }
 
     JLOG(m_journal.trace())
-        << "pubAccountTransaction: "
-        << "proposed=" << iProposed << ", accepted=" << iAccepted;
-
-    if (!notify.empty() || !accountHistoryNotify.empty())
-    {
-        auto const& stTxn = transaction.getTxn();
+        << "pubAccountTransaction: notify=" << notify.size();
 
-        Json::Value jvObj =
-            transJson(*stTxn, transaction.getResult(), true, ledger);
+    for (InfoSub::ref isrListener : notify)
+        isrListener->send(message, true);
 
-        {
-            auto const& meta = transaction.getMeta();
-
-            jvObj[jss::meta] = meta.getJson(JsonOptions::none);
-            RPC::insertDeliveredAmount(jvObj[jss::meta], *ledger, stTxn, meta);
-        }
-
-        for (InfoSub::ref isrListener : notify)
-            isrListener->send(jvObj, true);
+    if (!accountHistoryNotify.empty())
+    {
+        // each history subscriber is told its own position in the stream
+        Json::Value jvObj = message->json();
 
         assert(!jvObj.isMember(jss::account_history_tx_stream));
         for (auto& info : accountHistoryNotify)
@@ -3394,63 +3439,22 @@ NetworkOPsImp::pubProposedAccountTransaction(
     std::shared_ptr<STTx const> const& tx,
     TER result)
 {
-    hash_set<InfoSub::pointer> notify;
-    int iProposed = 0;
-
-    std::vector<SubAccountHistoryInfo> accountHistoryNotify;
-
-    {
-        std::lock_guard sl(mSubLock);
-
-        if (mSubRTAccount.empty())
-            return;
-
-        if (!mSubAccount.empty() || !mSubRTAccount.empty() ||
-            !mSubAccountHistory.empty())
-        {
-            for (auto const& affectedAccount : tx->getMentionedAccounts())
-            {
-                if (auto simiIt = mSubRTAccount.find(affectedAccount);
-                    simiIt != mSubRTAccount.end())
-                {
-                    auto it = simiIt->second.begin();
-
-                    while (it != simiIt->second.end())
-                    {
-                        InfoSub::pointer p = it->second.lock();
+    if (!mSubscriptions.hasAccounts(true))
+        return;
 
-                        if (p)
-                        {
-                            notify.insert(p);
-                            ++it;
-                            ++iProposed;
-                        }
-                        else
-                            it = simiIt->second.erase(it);
-                    }
-                }
-            }
-        }
-    }
+    auto const notify =
+        mSubscriptions.matchAccounts(tx->getMentionedAccounts(), false);
 
-    JLOG(m_journal.trace()) << "pubProposedAccountTransaction: " << iProposed;
+    JLOG(m_journal.trace())
+        << "pubProposedAccountTransaction: " << notify.size();
 
-    if (!notify.empty() || !accountHistoryNotify.empty())
+    if (!notify.empty())
     {
-        Json::Value jvObj = transJson(*tx, result, false, ledger);
+        auto const message = std::make_shared<InfoSub::Message const>(
+            transJson(*tx, result, false, ledger));
 
         for (InfoSub::ref isrListener : notify)
-            isrListener->send(jvObj, true);
-
-        assert(!jvObj.isMember(jss::account_history_tx_stream));
-        for (auto& info : accountHistoryNotify)
-        {
-            auto& index = info.index_;
-            if (index->forwardTxIndex_ == 0 && !index->haveHistorical_)
-                jvObj[jss::account_history_tx_first] = true;
-            jvObj[jss::account_history_tx_index] = index->forwardTxIndex_++;
-            info.sink_->send(jvObj, true);
-        }
+            isrListener->send(message, true);
     }
 }
 
@@ -3464,8 +3468,6 @@ NetworkOPsImp::subAccount(
     hash_set<AccountID> const& vnaAccountIDs,
     bool rt)
 {
-    SubInfoMapType& subMap = rt ? mSubRTAccount : mSubAccount;
-
     for (auto const& naAccountID : vnaAccountIDs)
     {
         JLOG(m_journal.trace())
@@ -3474,25 +3476,8 @@ NetworkOPsImp::subAccount(
         isrListener->insertSubAccountInfo(naAccountID, rt);
     }
 
-    std::lock_guard sl(mSubLock);
-
     for (auto const& naAccountID : vnaAccountIDs)
-    {
-        auto simIterator = subMap.find(naAccountID);
-        if (simIterator == subMap.end())
-        {
-            // Not found, note that account has a new single listner.
-            SubMapType usisElement;
-            usisElement[isrListener->getSeq()] = isrListener;
-            // VFALCO NOTE This is making a needless copy of naAccountID
-            subMap.insert(simIterator, make_pair(naAccountID, usisElement));
-        }
-        else
-        {
-            // Found, note that the account has another listener.
-            simIterator->second[isrListener->getSeq()] = isrListener;
-        }
-    }
+        mSubscriptions.addAccount(isrListener, naAccountID, rt);
 }
 
 void
@@ -3517,26 +3502,8 @@ NetworkOPsImp::unsubAccountInternal(
     hash_set<AccountID> const& vnaAccountIDs,
     bool rt)
 {
-    std::lock_guard sl(mSubLock);
-
-    SubInfoMapType& subMap = rt ? mSubRTAccount : mSubAccount;
-
     for (auto const& naAccountID : vnaAccountIDs)
-    {
-        auto simIterator = subMap.find(naAccountID);
-
-        if (simIterator != subMap.end())
-        {
-            // Found
-            simIterator->second.erase(uSeq);
-
-            if (simIterator->second.empty())
-            {
-                // Don't need hash entry.
-                subMap.erase(simIterator);
-            }
-        }
-    }
+        mSubscriptions.removeAccount(uSeq, naAccountID, rt);
 }
 
 void
@@ -3994,19 +3961,15 @@ NetworkOPsImp::unsubAccountHistoryInternal(
 bool
 NetworkOPsImp::subBook(InfoSub::ref isrListener, Book const& book)
 {
-    if (auto listeners = app_.getOrderBookDB().makeBookListeners(book))
-        listeners->addSubscriber(isrListener);
-    else
-        assert(false);
+    isrListener->insertSubBook(book);
+    mSubscriptions.addBook(isrListener, book);
     return true;
 }
 
 bool
 NetworkOPsImp::unsubBook(std::uint64_t uSeq, Book const& book)
 {
-    if (auto listeners = app_.getOrderBookDB().getBookListeners(book))
-        listeners->removeSubscriber(uSeq);
-
+    mSubscriptions.removeBook(uSeq, book);
     return true;
 }
 
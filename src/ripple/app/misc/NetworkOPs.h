@@ -31,6 +31,7 @@
 #include <deque>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 namespace ripple {
 
@@ -139,6 +140,20 @@ public:
         bool bLocal,
         FailHard failType) = 0;
 
+    /**
+     * Process transactions which arrived together from the network. They
+     * are queued to be applied under a single acquisition of the batch lock,
+     * and at most one job is scheduled to apply them.
+     *
+     * @param transactions Transaction objects. An entry may be replaced by
+     *        the canonical instance of its transaction.
+     * @param bUnlimited Whether they came from a trusted source.
+     */
+    virtual void
+    processTransactionSet(
+        std::vector<std::shared_ptr<Transaction>>& transactions,
+        bool bUnlimited) = 0;
+
     //--------------------------------------------------------------------------
     //
     // Owner functions
@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_SUBSCRIPTIONMATCHER_H_INCLUDED
+#define RIPPLE_APP_MISC_SUBSCRIPTIONMATCHER_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/net/InfoSub.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/Book.h>
+#include <ripple/protocol/TxMeta.h>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace ripple {
+
+/** The subscriptions to accounts and order books.
+
+    Each subscriber is given a small slot number for as long as it has any
+    subscription here, and the subscribers to an account or a book are kept
+    as a sorted vector of slots. Matching a transaction looks every account
+    and book it touches up once, marking the slots found in a bitmap, so a
+    subscriber interested in several of them is found only once. Slots are
+    resolved to subscribers at the very end.
+
+    Matching takes a shared lock, so publishing does not block other
+    publishing. Only subscribing and unsubscribing take it exclusively.
+*/
+class SubscriptionMatcher
+{
+public:
+    using Subscribers = std::vector<InfoSub::pointer>;
+
+    SubscriptionMatcher() = default;
+    SubscriptionMatcher(SubscriptionMatcher const&) = delete;
+    SubscriptionMatcher&
+    operator=(SubscriptionMatcher const&) = delete;
+
+    void
+    addAccount(InfoSub::ref sub, AccountID const& account, bool rt);
+
+    void
+    removeAccount(std::uint64_t seq, AccountID const& account, bool rt);
+
+    void
+    addBook(InfoSub::ref sub, Book const& book);
+
+    void
+    removeBook(std::uint64_t seq, Book const& book);
+
+    // whether anyone subscribes to an account, in real time or not
+    bool
+    hasAccounts(bool rt) const;
+
+    /** The subscribers to any of the accounts, each listed once.
+
+        Real time subscribers are always included, the others only for
+        validated transactions.
+    */
+    template <class Accounts>
+    Subscribers
+    matchAccounts(Accounts const& accounts, bool validated) const
+    {
+        std::shared_lock lock(mutex_);
+        if (rtAccounts_.empty() && (!validated || accounts_.empty()))
+            return {};
+
+        Marks marks(slots_.size());
+        for (auto const& account : accounts)
+        {
+            mark(rtAccounts_, account, marks);
+            if (validated)
+                mark(accounts_, account, marks);
+        }
+        return resolve(marks);
+    }
+
+    /** The subscribers to any of the books whose offers the metadata shows
+        being created, modified or deleted, each listed once.
+    */
+    Subscribers
+    matchBooks(TxMeta const& meta) const;
+
+    // the number of subscribers with at least one subscription
+    std::size_t
+    size() const;
+
+private:
+    struct Slot
+    {
+        std::uint64_t seq = 0;
+        InfoSub::wptr sub;
+        std::size_t subscriptions = 0;
+    };
+
+    template <class Key>
+    using Index = hash_map<Key, std::vector<std::uint32_t>>;
+
+    // The slots matched so far, each listed once.
+    class Marks
+    {
+        std::vector<std::uint64_t> bits_;
+        std::vector<std::uint32_t> slots_;
+
+    public:
+        explicit Marks(std::size_t size) : bits_((size + 63) / 64)
+        {
+        }
+
+        void
+        add(std::uint32_t slot)
+        {
+            auto& word = bits_[slot / 64];
+            auto const bit = std::uint64_t(1) << (slot % 64);
+            if (!(word & bit))
+            {
+                word |= bit;
+                slots_.push_back(slot);
+            }
+        }
+
+        std::vector<std::uint32_t> const&
+        slots() const
+        {
+            return slots_;
+        }
+    };
+
+    template <class Key>
+    static void
+    mark(Index<Key> const& index, Key const& key, Marks& marks)
+    {
+        if (auto const it = index.find(key); it != index.end())
+        {
+            for (auto const slot : it->second)
+                marks.add(slot);
+        }
+    }
+
+    // Requires a lock
+    Subscribers
+    resolve(Marks const& marks) const;
+
+    template <class Key>
+    void
+    add(Index<Key>& index, Key const& key, InfoSub::ref sub);
+
+    template <class Key>
+    void
+    remove(Index<Key>& index, Key const& key, std::uint64_t seq);
+
+    std::shared_mutex mutable mutex_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_;
+    hash_map<std::uint64_t, std::uint32_t> slotOf_;
+    Index<AccountID> accounts_;
+    Index<AccountID> rtAccounts_;
+    Index<Book> books_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -23,6 +23,7 @@
 #include <ripple/basics/RangeSet.h>
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/JsonMembers.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/protocol/STTx.h>
 #include <ripple/protocol/TER.h>
@@ -312,6 +313,10 @@ public:
     Json::Value
     getJson(JsonOptions options, bool binary = false) const;
 
+    /** The same members as getJson(options), to be written as JSON text. */
+    JsonMembers
+    getJsonMembers(JsonOptions options) const;
+
     // Information used to locate a transaction.
     // Contains a nodestore hash and ledger sequence pair if the transaction was
     // found. Otherwise, contains the range of ledgers present in the database
@@ -379,6 +384,10 @@ public:
         error_code_i& ec);
 
 private:
+    template <class Object>
+    void
+    addLedgerJson(Object& ret, JsonOptions options) const;
+
     static std::variant<
         std::pair<std::shared_ptr<Transaction>, std::shared_ptr<TxMeta>>,
         TxSearched>
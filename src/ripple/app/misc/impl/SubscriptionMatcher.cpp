@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/SubscriptionMatcher.h>
+#include <algorithm>
+
+namespace ripple {
+
+template <class Key>
+void
+SubscriptionMatcher::add(Index<Key>& index, Key const& key, InfoSub::ref sub)
+{
+    std::lock_guard lock(mutex_);
+
+    auto [it, inserted] = slotOf_.emplace(sub->getSeq(), 0);
+    if (inserted)
+    {
+        if (free_.empty())
+        {
+            it->second = static_cast<std::uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        else
+        {
+            it->second = free_.back();
+            free_.pop_back();
+        }
+        slots_[it->second] = {sub->getSeq(), sub, 0};
+    }
+
+    auto const slot = it->second;
+    auto& slots = index[key];
+    auto const pos = std::lower_bound(slots.begin(), slots.end(), slot);
+    if (pos != slots.end() && *pos == slot)
+        return;
+
+    slots.insert(pos, slot);
+    ++slots_[slot].subscriptions;
+}
+
+template <class Key>
+void
+SubscriptionMatcher::remove(
+    Index<Key>& index,
+    Key const& key,
+    std::uint64_t seq)
+{
+    std::lock_guard lock(mutex_);
+
+    auto const it = slotOf_.find(seq);
+    auto const entry = index.find(key);
+    if (it == slotOf_.end() || entry == index.end())
+        return;
+
+    auto const slot = it->second;
+    auto& slots = entry->second;
+    auto const pos = std::lower_bound(slots.begin(), slots.end(), slot);
+    if (pos == slots.end() || *pos != slot)
+        return;
+
+    slots.erase(pos);
+    if (slots.empty())
+        index.erase(entry);
+
+    if (--slots_[slot].subscriptions == 0)
+    {
+        slots_[slot] = {};
+        free_.push_back(slot);
+        slotOf_.erase(it);
+    }
+}
+
+void
+SubscriptionMatcher::addAccount(
+    InfoSub::ref sub,
+    AccountID const& account,
+    bool rt)
+{
+    add(rt ? rtAccounts_ : accounts_, account, sub);
+}
+
+void
+SubscriptionMatcher::removeAccount(
+    std::uint64_t seq,
+    AccountID const& account,
+    bool rt)
+{
+    remove(rt ? rtAccounts_ : accounts_, account, seq);
+}
+
+void
+SubscriptionMatcher::addBook(InfoSub::ref sub, Book const& book)
+{
+    add(books_, book, sub);
+}
+
+void
+SubscriptionMatcher::removeBook(std::uint64_t seq, Book const& book)
+{
+    remove(books_, book, seq);
+}
+
+bool
+SubscriptionMatcher::hasAccounts(bool rt) const
+{
+    std::shared_lock lock(mutex_);
+    return !(rt ? rtAccounts_ : accounts_).empty();
+}
+
+SubscriptionMatcher::Subscribers
+SubscriptionMatcher::matchBooks(TxMeta const& meta) const
+{
+    std::shared_lock lock(mutex_);
+    if (books_.empty())
+        return {};
+
+    Marks marks(slots_.size());
+    for (auto const& node : meta.getNodes())
+    {
+        if (node.getFieldU16(sfLedgerEntryType) != ltOFFER)
+            continue;
+
+        // the fields holding the offer's TakerGets and TakerPays
+        SField const* field = nullptr;
+        if (node.getFName() == sfModifiedNode)
+            field = &sfPreviousFields;
+        else if (node.getFName() == sfCreatedNode)
+            field = &sfNewFields;
+        else if (node.getFName() == sfDeletedNode)
+            field = &sfFinalFields;
+        else
+            continue;
+
+        if (auto const data =
+                dynamic_cast<STObject const*>(node.peekAtPField(*field));
+            data && data->isFieldPresent(sfTakerPays) &&
+            data->isFieldPresent(sfTakerGets))
+        {
+            mark(
+                books_,
+                Book{
+                    data->getFieldAmount(sfTakerGets).issue(),
+                    data->getFieldAmount(sfTakerPays).issue()},
+                marks);
+        }
+    }
+    return resolve(marks);
+}
+
+std::size_t
+SubscriptionMatcher::size() const
+{
+    std::shared_lock lock(mutex_);
+    return slotOf_.size();
+}
+
+SubscriptionMatcher::Subscribers
+SubscriptionMatcher::resolve(Marks const& marks) const
+{
+    Subscribers subscribers;
+    subscribers.reserve(marks.slots().size());
+    for (auto const slot : marks.slots())
+    {
+        if (auto sub = slots_[slot].sub.lock())
+            subscribers.push_back(std::move(sub));
+    }
+    return subscribers;
+}
+
+}  // namespace ripple
@@ -172,12 +172,10 @@ Transaction::load(
     return db->getTransaction(id, range, ec);
 }
 
-// options 1 to include the date of the transaction
-Json::Value
-Transaction::getJson(JsonOptions options, bool binary) const
+template <class Object>
+void
+Transaction::addLedgerJson(Object& ret, JsonOptions options) const
 {
-    Json::Value ret(mTransaction->getJson(JsonOptions::none, binary));
-
     if (mInLedger)
     {
         ret[jss::inLedger] = mInLedger;  // Deprecated.
@@ -205,7 +203,23 @@ Transaction::getJson(JsonOptions options, bool binary) const
                 ret[jss::ctid] = *ctid;
         }
     }
+}
+
+// options 1 to include the date of the transaction
+Json::Value
+Transaction::getJson(JsonOptions options, bool binary) const
+{
+    Json::Value ret(mTransaction->getJson(JsonOptions::none, binary));
+    addLedgerJson(ret, options);
+    return ret;
+}
 
+JsonMembers
+Transaction::getJsonMembers(JsonOptions options) const
+{
+    JsonMembers ret(*mTransaction);
+    ret[jss::hash] = to_string(mTransaction->getTransactionID());
+    addLedgerJson(ret, options);
     return ret;
 }
 
@@ -1,7 +1,7 @@
 //------------------------------------------------------------------------------
 /*
     This file is part of rippled: https://github.com/ripple/rippled
-    Copyright (c) 2012, 2013 Ripple Labs Inc.
+    Copyright (c) 2024 XRPL Labs
 
     Permission to use, copy, modify, and/or distribute this software for any
     purpose  with  or without fee is hereby granted, provided that the above
@@ -17,50 +17,23 @@
 */
 //==============================================================================
 
-#include <ripple/app/ledger/OrderBookDB.h>
-#include <ripple/app/misc/NetworkOPs.h>
-#include <ripple/json/to_string.h>
+#ifndef RIPPLE_APP_RDB_MIGRATETXINDEX_H_INCLUDED
+#define RIPPLE_APP_RDB_MIGRATETXINDEX_H_INCLUDED
 
-namespace ripple {
-
-void
-BookListeners::addSubscriber(InfoSub::ref sub)
-{
-    std::lock_guard sl(mLock);
-    mListeners[sub->getSeq()] = sub;
-}
-
-void
-BookListeners::removeSubscriber(std::uint64_t seq)
-{
-    std::lock_guard sl(mLock);
-    mListeners.erase(seq);
-}
+#include <ripple/core/DatabaseCon.h>
 
-void
-BookListeners::publish(
-    Json::Value const& jvObj,
-    hash_set<std::uint64_t>& havePublished)
-{
-    std::lock_guard sl(mLock);
-    auto it = mListeners.cbegin();
-
-    while (it != mListeners.cend())
-    {
-        InfoSub::pointer p = it->second.lock();
+namespace ripple {
 
-        if (p)
-        {
-            // Only publish jvObj if this is the first occurence
-            if (havePublished.emplace(p->getSeq()).second)
-            {
-                p->send(jvObj, true);
-            }
-            ++it;
-        }
-        else
-            it = mListeners.erase(it);
-    }
-}
+/**
+ * @brief doMigrateTxIndex Copies the transactions of the SQLite transaction
+ *        database into a new transaction index, for the txindex relational
+ *        database backend. The SQLite database is left as it is.
+ * @param setup Path to the databases and other opening parameters.
+ * @return True if the migration completed successfully.
+ */
+bool
+doMigrateTxIndex(DatabaseCon::Setup const& setup);
 
 }  // namespace ripple
+
+#endif
@@ -21,6 +21,8 @@
 #define RIPPLE_APP_RDB_BACKEND_SQLITEDATABASE_H_INCLUDED
 
 #include <ripple/app/rdb/RelationalDatabase.h>
+#include <ripple/json/json_value.h>
+#include <functional>
 
 namespace ripple {
 
@@ -102,15 +104,33 @@ public:
     getLedgerCountMinMax() = 0;
 
     /**
-     * @brief saveValidatedLedger Saves a ledger into the database.
+     * @brief saveValidatedLedger Saves a ledger into the database, possibly
+     *        in one group with other ledgers saved at the same time.
      * @param ledger The ledger.
      * @param current True if the ledger is current.
-     * @return True if saving was successful.
+     * @param onSaved Called with true once the ledger is saved, or with
+     *        false if saving it failed. May be called before this returns.
      */
-    virtual bool
+    virtual void
     saveValidatedLedger(
         std::shared_ptr<Ledger const> const& ledger,
-        bool current) = 0;
+        bool current,
+        std::function<void(bool)> onSaved) = 0;
+
+    /**
+     * @brief getLedgerWriteInfo Returns how many ledgers were saved in how
+     *        many groups, and how long writing them took.
+     * @return Json object.
+     */
+    virtual Json::Value
+    getLedgerWriteInfo() const = 0;
+
+    /**
+     * @brief stop Saves the ledgers waiting to be saved. Ledgers saved
+     *        afterwards are written before saveValidatedLedger returns.
+     */
+    virtual void
+    stop() = 0;
 
     /**
      * @brief getLimitedOldestLedgerInfo Returns the info of the oldest ledger
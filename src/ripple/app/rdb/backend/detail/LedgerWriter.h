@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_RDB_BACKEND_DETAIL_LEDGERWRITER_H_INCLUDED
+#define RIPPLE_APP_RDB_BACKEND_DETAIL_LEDGERWRITER_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/json/json_value.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class AcceptedLedger;
+
+namespace detail {
+
+/** Saves validated ledgers into the relational database in groups.
+
+    Ledgers are handed over once they are prepared. A background thread
+    writes every ledger waiting when it becomes free, up to a limit, as one
+    group, so under load each database transaction covers many ledgers
+    while an idle writer adds no delay. Handing over a ledger while too
+    many are waiting blocks until the writer catches up, which bounds how
+    far the database falls behind.
+*/
+class LedgerWriter
+{
+public:
+    using AcceptedLedgers = std::vector<std::shared_ptr<AcceptedLedger const>>;
+
+    struct Setup
+    {
+        /** The most ledgers written as one group. */
+        std::size_t maxGroup = 32;
+
+        /** The most ledgers waiting to be written. */
+        std::size_t maxPending = 128;
+    };
+
+    /** Writes a group of ledgers, throwing if that fails. */
+    using Write = std::function<void(AcceptedLedgers const&)>;
+
+    /** Told whether the ledger was saved, once its group is written. */
+    using OnSaved = std::function<void(bool)>;
+
+    LedgerWriter(Setup const& setup, Write write, beast::Journal j);
+
+    /** Writes the ledgers still waiting. */
+    ~LedgerWriter();
+
+    LedgerWriter(LedgerWriter const&) = delete;
+    LedgerWriter&
+    operator=(LedgerWriter const&) = delete;
+
+    /** Arranges to save a ledger.
+
+        Blocks while too many ledgers are waiting. Once the writer is
+        stopped, the ledger is written before this returns.
+
+        @param aLedger The prepared ledger.
+        @param onSaved Called, from the thread writing the ledger, once
+                       the ledger is saved or saving it failed.
+    */
+    void
+    save(std::shared_ptr<AcceptedLedger const> aLedger, OnSaved onSaved);
+
+    /** Writes the ledgers still waiting and stops the background thread. */
+    void
+    stop();
+
+    /** Returns the number of groups and ledgers written and how long
+        writing them took.
+    */
+    Json::Value
+    getInfo() const;
+
+private:
+    struct Pending
+    {
+        std::shared_ptr<AcceptedLedger const> aLedger;
+        OnSaved onSaved;
+    };
+
+    void
+    run();
+
+    void
+    write(std::vector<Pending>& group);
+
+    Setup const setup_;
+    Write const write_;
+    beast::Journal const j_;
+
+    std::mutex mutable mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable drained_;
+    std::deque<Pending> pending_;
+    bool stopping_ = false;
+
+    std::uint64_t groups_ = 0;
+    std::uint64_t ledgers_ = 0;
+    std::size_t lastGroup_ = 0;
+    std::size_t maxGroup_ = 0;
+    std::chrono::steady_clock::duration lastWrite_{};
+    std::chrono::steady_clock::duration maxWrite_{};
+    std::chrono::steady_clock::duration totalWrite_{};
+
+    std::thread thread_;
+};
+
+}  // namespace detail
+}  // namespace ripple
+
+#endif
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_APP_RDB_BACKEND_DETAIL_NODE_H_INCLUDED
 #define RIPPLE_APP_RDB_BACKEND_DETAIL_NODE_H_INCLUDED
 
+#include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/misc/Manifest.h>
 #include <ripple/app/rdb/RelationalDatabase.h>
@@ -27,6 +28,8 @@
 #include <ripple/overlay/PeerReservationTable.h>
 #include <ripple/peerfinder/impl/Store.h>
 #include <boost/filesystem.hpp>
+#include <functional>
+#include <vector>
 
 namespace ripple {
 namespace detail {
@@ -121,22 +124,52 @@ RelationalDatabase::CountMinMax
 getRowsMinMax(soci::session& session, TableType type);
 
 /**
- * @brief saveValidatedLedger Saves ledger into database.
- * @param lgrDB Link to ledgers database.
+ * @brief saveTransactions Saves the transactions of a group of ledgers into
+ *        the transaction database, replacing any saved before, in a single
+ *        database transaction.
  * @param txnDB Link to transactions database.
  * @param app Application object.
+ * @param aLedgers The transactions of the ledgers.
+ */
+void
+saveTransactions(
+    DatabaseCon& txnDB,
+    Application& app,
+    std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers);
+
+/**
+ * @brief prepareValidatedLedger Checks a ledger about to be saved, stores
+ *        its header in the node store and builds its accepted ledger.
+ * @param app Application object.
  * @param ledger The ledger.
  * @param current True if ledger is current.
- * @return True is saving was successfull.
+ * @return The accepted ledger, or nullptr if the ledger is missing nodes,
+ *         in which case the failed save has been reported.
  */
-bool
-saveValidatedLedger(
-    DatabaseCon& ldgDB,
-    DatabaseCon& txnDB,
+std::shared_ptr<AcceptedLedger const>
+prepareValidatedLedger(
     Application& app,
     std::shared_ptr<Ledger const> const& ledger,
     bool current);
 
+/**
+ * @brief saveValidatedLedgers Saves a group of prepared ledgers into
+ *        database. Each database is written in a single transaction.
+ * @param lgrDB Link to ledgers database.
+ * @param saveTransactions Saves the transactions of the ledgers, if
+ *        transaction tables are in use.
+ * @param app Application object.
+ * @param aLedgers The ledgers, as returned by prepareValidatedLedger.
+ */
+void
+saveValidatedLedgers(
+    DatabaseCon& ldgDB,
+    std::function<void(
+        std::vector<std::shared_ptr<AcceptedLedger const>> const&)> const&
+        saveTransactions,
+    Application& app,
+    std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers);
+
 /**
  * @brief getLedgerInfoByIndex Returns ledger by its sequence.
  * @param session Session with database.
@@ -0,0 +1,321 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_RDB_BACKEND_DETAIL_TXINDEX_H_INCLUDED
+#define RIPPLE_APP_RDB_BACKEND_DETAIL_TXINDEX_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/AccountID.h>
+#include <boost/container/flat_set.hpp>
+#include <boost/filesystem.hpp>
+#include <compare>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace detail {
+
+/** An append-only store of validated transactions, indexed by account.
+
+    The transactions of each saved ledger are appended as one block to a
+    log file. A directory, indexed by ledger sequence, gives the place of
+    each block, so a transaction is found by its position: the sequence of
+    its ledger and its index within the ledger.
+
+    For each account the index keeps the positions of the transactions
+    which affected it. New positions collect in memory and are written out
+    as an immutable segment, sorted by account, in which the positions of
+    each account are delta encoded in blocks of fixed count. A background
+    thread writes the segments and merges runs of them, so a query visits
+    a handful of segments and, in each, reads only the blocks which hold
+    the positions it returns. The segments also map each transaction ID to
+    its position.
+
+    Deleting a ledger, or every ledger below a sequence, hides the
+    positions of its transactions in the segments written before; they are
+    dropped when those segments are merged.
+*/
+class TxIndex
+{
+public:
+    /** Where a transaction is: its ledger and its index in the ledger. */
+    struct Position
+    {
+        std::uint32_t ledgerSeq = 0;
+        std::uint32_t txnSeq = 0;
+
+        auto
+        operator<=>(Position const&) const = default;
+    };
+
+    /** A transaction to save, with the accounts it affected. */
+    struct Tx
+    {
+        uint256 id;
+        std::uint32_t txnSeq = 0;
+        char status = 0;
+        Blob txn;
+        Blob meta;
+        boost::container::flat_set<AccountID> accounts;
+    };
+
+    /** A transaction read back from the index. */
+    struct Record
+    {
+        uint256 id;
+        Position position;
+        char status = 0;
+        Blob txn;
+        Blob meta;
+    };
+
+    /** Tuning for the index; the defaults suit a full history server. */
+    struct Setup
+    {
+        /** Number of positions held in memory before writing a segment. */
+        std::size_t memtablePositions = 1 << 20;
+
+        /** Number of segments a merge takes at least. */
+        std::size_t mergeWidth = 4;
+
+        /** Whether a saved ledger is durable when saveLedger returns.
+
+            Otherwise ledgers are made durable only as segments are
+            written, which suits a bulk load that can start over.
+        */
+        bool sync = true;
+    };
+
+    /** Opens, or creates, the index in the given directory.
+
+        Positions of the ledgers saved since the last segment are rebuilt
+        from the log.
+    */
+    TxIndex(
+        boost::filesystem::path const& dir,
+        Setup const& setup,
+        beast::Journal j);
+
+    ~TxIndex();
+
+    TxIndex(TxIndex const&) = delete;
+    TxIndex&
+    operator=(TxIndex const&) = delete;
+
+    /** Saves the transactions of a ledger.
+
+        A ledger saved before is replaced.
+    */
+    void
+    saveLedger(std::uint32_t ledgerSeq, std::vector<Tx> const& txs);
+
+    /** Deletes the transactions of a ledger. */
+    void
+    deleteLedger(std::uint32_t ledgerSeq);
+
+    /** Deletes the transactions of every ledger below a sequence. */
+    void
+    deleteBefore(std::uint32_t ledgerSeq);
+
+    /** Returns the transaction with the given ID, if saved. */
+    std::optional<Record>
+    fetch(uint256 const& id) const;
+
+    /** Returns the transaction at the given position, if saved. */
+    std::optional<Record>
+    fetch(Position const& position) const;
+
+    /** Returns the transactions of a ledger, in the order they applied. */
+    std::vector<Record>
+    fetchLedger(std::uint32_t ledgerSeq) const;
+
+    /** Visits the positions of the transactions which affected an account.
+
+        Positions are visited in ascending or descending order, starting at
+        `from` if given, and limited to ledgers in [minLedger, maxLedger].
+        The visit ends when `f` returns false.
+    */
+    void
+    forEach(
+        AccountID const& account,
+        std::uint32_t minLedger,
+        std::uint32_t maxLedger,
+        bool forward,
+        std::optional<Position> const& from,
+        std::function<bool(Position const&)> const& f) const;
+
+    /** Returns the number of transactions in a ledger, if it is saved. */
+    std::optional<std::uint32_t>
+    transactionsIn(std::uint32_t ledgerSeq) const;
+
+    /** Returns the number of ledgers in [first, last] which are saved. */
+    std::uint32_t
+    ledgersIn(std::uint32_t first, std::uint32_t last) const;
+
+    std::optional<std::uint32_t>
+    minLedger() const;
+
+    std::optional<std::uint32_t>
+    maxLedger() const;
+
+    /** Returns the number of transactions saved. */
+    std::uint64_t
+    transactionCount() const;
+
+    /** Returns the number of positions saved, over all accounts. */
+    std::uint64_t
+    positionCount() const;
+
+    /** Returns the number of bytes held in memory. */
+    std::uint64_t
+    memoryUsed() const;
+
+    /** Writes the positions held in memory as a segment. */
+    void
+    flush();
+
+    /** Merges every segment into one. */
+    void
+    compact();
+
+    /** Returns the number of segments. */
+    std::size_t
+    segmentCount() const;
+
+private:
+    class File;
+    class Segment;
+    class SegmentWriter;
+    class Cursor;
+    struct Memtable;
+
+    struct DirEntry
+    {
+        std::uint64_t offset = 0;
+        std::uint32_t size = 0;
+        std::uint32_t count = 0;
+        std::uint32_t positions = 0;
+    };
+
+    using Tombstones = std::map<std::uint32_t, std::uint64_t>;
+
+    boost::filesystem::path const dir_;
+    Setup const setup_;
+    beast::Journal const j_;
+
+    std::unique_ptr<File> directory_;
+
+    // Serializes changes to the files: the logs, the directory, the
+    // pending file and the manifest. Taken before mutex_, and held while
+    // they are written and synced, so that readers only wait for mutex_.
+    std::mutex write_;
+    std::unique_ptr<File> pending_;
+
+    // Guards everything below, but not the contents of the segments or of
+    // a frozen memtable, which never change once published.
+    mutable std::mutex mutex_;
+    mutable std::map<std::uint32_t, std::shared_ptr<File>> logs_;
+    std::unique_ptr<Memtable> active_;
+    std::shared_ptr<Memtable const> frozen_;
+    std::uint64_t frozenId_ = 0;
+    std::vector<std::shared_ptr<Segment const>> segments_;
+    std::uint64_t nextId_ = 1;
+    Tombstones tombstones_;
+    std::uint32_t floor_ = 0;
+    std::optional<std::uint32_t> minLedger_;
+    std::optional<std::uint32_t> maxLedger_;
+    std::uint64_t transactions_ = 0;
+    std::uint64_t positions_ = 0;
+
+    // Serializes writing and merging segments
+    std::mutex maintenance_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread worker_;
+
+    std::shared_ptr<File>
+    log(std::uint32_t ledgerSeq, std::lock_guard<std::mutex> const&) const;
+
+    std::optional<std::uint32_t>
+    scan(std::uint32_t from, std::uint32_t to, bool forward) const;
+
+    std::optional<DirEntry>
+    readEntry(std::uint32_t ledgerSeq) const;
+
+    void
+    writeEntry(std::uint32_t ledgerSeq, DirEntry const& entry);
+
+    void
+    remove(
+        std::uint32_t ledgerSeq,
+        DirEntry const& entry,
+        std::vector<std::uint8_t> const& block,
+        std::lock_guard<std::mutex> const&);
+
+    void
+    retireTombstones(std::lock_guard<std::mutex> const&);
+
+    void
+    readManifest();
+
+    std::string
+    manifest(std::lock_guard<std::mutex> const&) const;
+
+    // The lock is of write_
+    void
+    writeManifest(
+        std::string const& contents,
+        std::lock_guard<std::mutex> const&);
+
+    // The lock is of write_
+    void
+    writePending(
+        std::vector<std::uint32_t> const& ledgers,
+        std::lock_guard<std::mutex> const&);
+
+    void
+    replay();
+
+    bool
+    freeze(std::lock_guard<std::mutex> const&);
+
+    void
+    writeFrozen();
+
+    bool
+    mergeSome(bool all);
+
+    void
+    run();
+};
+
+}  // namespace detail
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/rdb/backend/detail/LedgerWriter.h>
+#include <ripple/basics/Log.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/protocol/jss.h>
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace ripple {
+namespace detail {
+
+LedgerWriter::LedgerWriter(Setup const& setup, Write write, beast::Journal j)
+    : setup_(setup), write_(std::move(write)), j_(j)
+{
+    assert(setup_.maxGroup > 0 && setup_.maxPending > 0);
+    thread_ = std::thread(&LedgerWriter::run, this);
+}
+
+LedgerWriter::~LedgerWriter()
+{
+    stop();
+}
+
+void
+LedgerWriter::save(
+    std::shared_ptr<AcceptedLedger const> aLedger,
+    OnSaved onSaved)
+{
+    {
+        std::unique_lock lock(mutex_);
+        drained_.wait(lock, [this] {
+            return stopping_ || pending_.size() < setup_.maxPending;
+        });
+
+        if (!stopping_)
+        {
+            pending_.push_back({std::move(aLedger), std::move(onSaved)});
+            wakeup_.notify_one();
+            return;
+        }
+    }
+
+    // Nothing writes in the background any more, so write the ledger now.
+    std::vector<Pending> group;
+    group.push_back({std::move(aLedger), std::move(onSaved)});
+    write(group);
+}
+
+void
+LedgerWriter::stop()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    drained_.notify_all();
+
+    if (thread_.joinable())
+        thread_.join();
+}
+
+Json::Value
+LedgerWriter::getInfo() const
+{
+    using namespace std::chrono;
+    auto const ms = [](steady_clock::duration d) {
+        return static_cast<Json::UInt>(duration_cast<milliseconds>(d).count());
+    };
+
+    std::lock_guard lock(mutex_);
+
+    Json::Value ret(Json::objectValue);
+    ret[jss::queued] = static_cast<Json::UInt>(pending_.size());
+    ret[jss::groups] = std::to_string(groups_);
+    ret[jss::ledgers] = std::to_string(ledgers_);
+    ret[jss::last_group_size] = static_cast<Json::UInt>(lastGroup_);
+    ret[jss::max_group_size] = static_cast<Json::UInt>(maxGroup_);
+    ret[jss::last_write_ms] = ms(lastWrite_);
+    ret[jss::max_write_ms] = ms(maxWrite_);
+    ret[jss::avg_write_ms] =
+        groups_ ? ms(totalWrite_ / groups_) : Json::UInt{0};
+    return ret;
+}
+
+void
+LedgerWriter::run()
+{
+    beast::setCurrentThreadName("LedgerWriter");
+
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        wakeup_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+
+        // When stopping, keep writing until nothing is left.
+        if (pending_.empty())
+            return;
+
+        auto const end = pending_.begin() +
+            std::min(pending_.size(), setup_.maxGroup);
+        std::vector<Pending> group(
+            std::make_move_iterator(pending_.begin()),
+            std::make_move_iterator(end));
+        pending_.erase(pending_.begin(), end);
+        drained_.notify_all();
+
+        lock.unlock();
+        write(group);
+        lock.lock();
+    }
+}
+
+void
+LedgerWriter::write(std::vector<Pending>& group)
+{
+    AcceptedLedgers aLedgers;
+    aLedgers.reserve(group.size());
+    for (auto const& pending : group)
+        aLedgers.push_back(pending.aLedger);
+
+    bool saved = false;
+    auto const start = std::chrono::steady_clock::now();
+    try
+    {
+        write_(aLedgers);
+        saved = true;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.fatal()) << "Failed to save a group of " << group.size()
+                         << " ledgers: " << e.what();
+    }
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    JLOG(j_.debug()) << "Saved a group of " << group.size() << " ledgers in "
+                     << std::chrono::duration_cast<std::chrono::milliseconds>(
+                            elapsed)
+                            .count()
+                     << "ms";
+
+    {
+        std::lock_guard lock(mutex_);
+        ++groups_;
+        ledgers_ += group.size();
+        lastGroup_ = group.size();
+        maxGroup_ = std::max(maxGroup_, lastGroup_);
+        lastWrite_ = elapsed;
+        maxWrite_ = std::max(maxWrite_, elapsed);
+        totalWrite_ += elapsed;
+    }
+
+    for (auto& pending : group)
+        pending.onSaved(saved);
+}
+
+}  // namespace detail
+}  // namespace ripple
@@ -183,10 +183,159 @@ getRowsMinMax(soci::session& session, TableType type)
     return res;
 }
 
-bool
-saveValidatedLedger(
-    DatabaseCon& ldgDB,
+// Rows written by one multi-row INSERT, which keeps every statement well
+// below the limit SQLite puts on the length of an SQL statement.
+static constexpr std::size_t maxRowsPerInsert = 512;
+
+/**
+ * @brief sequenceList Returns the sequences of the given ledgers as a comma
+ *        separated list, for use in an SQL "IN" clause.
+ * @param aLedgers The ledgers.
+ * @return The list.
+ */
+static std::string
+sequenceList(std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers)
+{
+    std::string list;
+    for (auto const& aLedger : aLedgers)
+    {
+        if (!list.empty())
+            list += ',';
+        list += std::to_string(aLedger->getLedger()->info().seq);
+    }
+    return list;
+}
+
+/**
+ * @brief The MultiRowInsert class collects rows to insert into a table and
+ *        writes them with as few INSERT statements as possible.
+ */
+class MultiRowInsert
+{
+    soci::session& session_;
+    std::string const header_;
+    std::string sql_;
+    std::size_t rows_ = 0;
+
+public:
+    /**
+     * @param session Session with the database.
+     * @param header The statement up to and including "VALUES ".
+     */
+    MultiRowInsert(soci::session& session, std::string header)
+        : session_(session), header_(std::move(header))
+    {
+    }
+
+    /**
+     * @brief add Adds a row, writing the collected rows if there are
+     *        enough of them.
+     * @param row The values of the row, in parentheses.
+     */
+    void
+    add(std::string const& row)
+    {
+        if (rows_ == 0)
+            sql_ = header_;
+        else
+            sql_ += ", ";
+        sql_ += row;
+
+        if (++rows_ == maxRowsPerInsert)
+            flush();
+    }
+
+    /**
+     * @brief flush Writes the rows collected so far.
+     */
+    void
+    flush()
+    {
+        if (rows_ == 0)
+            return;
+
+        sql_ += ';';
+        session_ << sql_;
+        rows_ = 0;
+    }
+};
+
+void
+saveTransactions(
     DatabaseCon& txnDB,
+    Application& app,
+    std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers)
+{
+    auto j = app.journal("Ledger");
+    auto const seqs = sequenceList(aLedgers);
+
+    auto db = txnDB.checkoutDb();
+
+    soci::transaction tr(*db);
+
+    *db << "DELETE FROM Transactions WHERE LedgerSeq IN (" + seqs + ");";
+    *db << "DELETE FROM AccountTransactions WHERE LedgerSeq IN (" + seqs +
+            ");";
+
+    std::string txnId;
+    soci::statement deleteAcctTrans =
+        (db->prepare
+             << "DELETE FROM AccountTransactions WHERE TransID = :txnId;",
+         soci::use(txnId));
+
+    MultiRowInsert insertAcctTrans(
+        *db,
+        "INSERT INTO AccountTransactions "
+        "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
+    MultiRowInsert insertTrans(*db, STTx::getMetaSQLInsertReplaceHeader());
+
+    for (auto const& aLedger : aLedgers)
+    {
+        auto const seq = aLedger->getLedger()->info().seq;
+        std::string const ledgerSeq(std::to_string(seq));
+
+        for (auto const& acceptedLedgerTx : *aLedger)
+        {
+            txnId = to_string(acceptedLedgerTx->getTransactionID());
+            std::string const txnSeq(
+                std::to_string(acceptedLedgerTx->getTxnSeq()));
+
+            deleteAcctTrans.execute(true);
+
+            auto const& accts = acceptedLedgerTx->getAffected();
+
+            if (!accts.empty())
+            {
+                for (auto const& account : accts)
+                {
+                    insertAcctTrans.add(
+                        "('" + txnId + "','" + toBase58(account) + "'," +
+                        ledgerSeq + "," + txnSeq + ")");
+                }
+            }
+            else if (auto const& sleTxn = acceptedLedgerTx->getTxn();
+                     !isPseudoTx(*sleTxn))
+            {
+                // It's okay for pseudo transactions to not affect any
+                // accounts.  But otherwise...
+                JLOG(j.warn()) << "Transaction in ledger " << seq
+                               << " affects no accounts";
+                JLOG(j.warn()) << sleTxn->getJson(JsonOptions::none);
+            }
+
+            insertTrans.add(acceptedLedgerTx->getTxn()->getMetaSQL(
+                seq, acceptedLedgerTx->getEscMeta()));
+        }
+    }
+
+    insertAcctTrans.flush();
+    insertTrans.flush();
+
+    tr.commit();
+}
+
+std::shared_ptr<AcceptedLedger const>
+prepareValidatedLedger(
     Application& app,
     std::shared_ptr<Ledger const> const& ledger,
     bool current)
@@ -194,7 +343,6 @@ saveValidatedLedger(
     auto j = app.journal("Ledger");
     auto seq = ledger->info().seq;
 
-    // TODO(tom): Fix this hard-coded SQL!
     JLOG(j.trace()) << "saveValidatedLedger " << (current ? "" : "fromAcquire ")
                     << seq;
 
@@ -242,145 +390,98 @@ saveValidatedLedger(
         // Clients can now trust the database for information about this
         // ledger sequence.
         app.pendingSaves().finishWork(seq);
-        return false;
+        return {};
     }
 
-    {
-        static boost::format deleteLedger(
-            "DELETE FROM Ledgers WHERE LedgerSeq = %u;");
-        static boost::format deleteTrans1(
-            "DELETE FROM Transactions WHERE LedgerSeq = %u;");
-        static boost::format deleteTrans2(
-            "DELETE FROM AccountTransactions WHERE LedgerSeq = %u;");
-        static boost::format deleteAcctTrans(
-            "DELETE FROM AccountTransactions WHERE TransID = '%s';");
-
-        {
-            auto db = ldgDB.checkoutDb();
-            *db << boost::str(deleteLedger % seq);
-        }
-
-        if (app.config().useTxTables())
-        {
-            auto db = txnDB.checkoutDb();
+    return aLedger;
+}
 
-            soci::transaction tr(*db);
+void
+saveValidatedLedgers(
+    DatabaseCon& ldgDB,
+    std::function<void(
+        std::vector<std::shared_ptr<AcceptedLedger const>> const&)> const&
+        saveTransactions,
+    Application& app,
+    std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers)
+{
+    if (aLedgers.empty())
+        return;
 
-            *db << boost::str(deleteTrans1 % seq);
-            *db << boost::str(deleteTrans2 % seq);
+    // TODO(tom): Fix this hard-coded SQL!
+    {
+        auto db = ldgDB.checkoutDb();
+        *db << "DELETE FROM Ledgers WHERE LedgerSeq IN (" +
+                sequenceList(aLedgers) + ");";
+    }
 
-            std::string const ledgerSeq(std::to_string(seq));
+    if (app.config().useTxTables())
+    {
+        saveTransactions(aLedgers);
 
+        for (auto const& aLedger : aLedgers)
+        {
+            auto const seq = aLedger->getLedger()->info().seq;
             for (auto const& acceptedLedgerTx : *aLedger)
-            {
-                uint256 transactionID = acceptedLedgerTx->getTransactionID();
-
-                std::string const txnId(to_string(transactionID));
-                std::string const txnSeq(
-                    std::to_string(acceptedLedgerTx->getTxnSeq()));
-
-                *db << boost::str(deleteAcctTrans % transactionID);
-
-                auto const& accts = acceptedLedgerTx->getAffected();
-
-                if (!accts.empty())
-                {
-                    std::string sql(
-                        "INSERT INTO AccountTransactions "
-                        "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
-
-                    // Try to make an educated guess on how much space we'll
-                    // need for our arguments. In argument order we have: 64
-                    // + 34 + 10 + 10 = 118 + 10 extra = 128 bytes
-                    sql.reserve(sql.length() + (accts.size() * 128));
-
-                    bool first = true;
-                    for (auto const& account : accts)
-                    {
-                        if (!first)
-                            sql += ", ('";
-                        else
-                        {
-                            sql += "('";
-                            first = false;
-                        }
-
-                        sql += txnId;
-                        sql += "','";
-                        sql += toBase58(account);
-                        sql += "',";
-                        sql += ledgerSeq;
-                        sql += ",";
-                        sql += txnSeq;
-                        sql += ")";
-                    }
-                    sql += ";";
-                    JLOG(j.trace()) << "ActTx: " << sql;
-                    *db << sql;
-                }
-                else if (auto const& sleTxn = acceptedLedgerTx->getTxn();
-                         !isPseudoTx(*sleTxn))
-                {
-                    // It's okay for pseudo transactions to not affect any
-                    // accounts.  But otherwise...
-                    JLOG(j.warn()) << "Transaction in ledger " << seq
-                                   << " affects no accounts";
-                    JLOG(j.warn()) << sleTxn->getJson(JsonOptions::none);
-                }
-
-                *db
-                    << (STTx::getMetaSQLInsertReplaceHeader() +
-                        acceptedLedgerTx->getTxn()->getMetaSQL(
-                            seq, acceptedLedgerTx->getEscMeta()) +
-                        ";");
-
                 app.getMasterTransaction().inLedger(
-                    transactionID,
+                    acceptedLedgerTx->getTransactionID(),
                     seq,
                     acceptedLedgerTx->getTxnSeq(),
                     app.config().NETWORK_ID);
-            }
-
-            tr.commit();
         }
+    }
 
-        {
-            static std::string addLedger(
-                R"sql(INSERT OR REPLACE INTO Ledgers
+    {
+        static std::string addLedger(
+            R"sql(INSERT OR REPLACE INTO Ledgers
                 (LedgerHash,LedgerSeq,PrevHash,TotalCoins,ClosingTime,PrevClosingTime,
                 CloseTimeRes,CloseFlags,AccountSetHash,TransSetHash)
             VALUES
                 (:ledgerHash,:ledgerSeq,:prevHash,:totalCoins,:closingTime,:prevClosingTime,
                 :closeTimeRes,:closeFlags,:accountSetHash,:transSetHash);)sql");
 
-            auto db(ldgDB.checkoutDb());
-
-            soci::transaction tr(*db);
-
-            auto const hash = to_string(ledger->info().hash);
-            auto const parentHash = to_string(ledger->info().parentHash);
-            auto const drops = to_string(ledger->info().drops);
-            auto const closeTime =
-                ledger->info().closeTime.time_since_epoch().count();
-            auto const parentCloseTime =
-                ledger->info().parentCloseTime.time_since_epoch().count();
-            auto const closeTimeResolution =
-                ledger->info().closeTimeResolution.count();
-            auto const closeFlags = ledger->info().closeFlags;
-            auto const accountHash = to_string(ledger->info().accountHash);
-            auto const txHash = to_string(ledger->info().txHash);
-
-            *db << addLedger, soci::use(hash), soci::use(seq),
-                soci::use(parentHash), soci::use(drops), soci::use(closeTime),
-                soci::use(parentCloseTime), soci::use(closeTimeResolution),
-                soci::use(closeFlags), soci::use(accountHash),
-                soci::use(txHash);
-
-            tr.commit();
+        auto db(ldgDB.checkoutDb());
+
+        soci::transaction tr(*db);
+
+        std::string hash, parentHash, drops, accountHash, txHash;
+        LedgerIndex seq;
+        NetClock::rep closeTime, parentCloseTime, closeTimeResolution;
+        int closeFlags;
+
+        soci::statement st =
+            (db->prepare << addLedger,
+             soci::use(hash),
+             soci::use(seq),
+             soci::use(parentHash),
+             soci::use(drops),
+             soci::use(closeTime),
+             soci::use(parentCloseTime),
+             soci::use(closeTimeResolution),
+             soci::use(closeFlags),
+             soci::use(accountHash),
+             soci::use(txHash));
+
+        for (auto const& aLedger : aLedgers)
+        {
+            auto const& info = aLedger->getLedger()->info();
+
+            hash = to_string(info.hash);
+            seq = info.seq;
+            parentHash = to_string(info.parentHash);
+            drops = to_string(info.drops);
+            closeTime = info.closeTime.time_since_epoch().count();
+            parentCloseTime = info.parentCloseTime.time_since_epoch().count();
+            closeTimeResolution = info.closeTimeResolution.count();
+            closeFlags = info.closeFlags;
+            accountHash = to_string(info.accountHash);
+            txHash = to_string(info.txHash);
+
+            st.execute(true);
         }
-    }
 
-    return true;
+        tr.commit();
+    }
 }
 
 /**
@@ -0,0 +1,2128 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/rdb/backend/detail/TxIndex.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/contract.h>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ripple {
+namespace detail {
+
+namespace {
+
+// Each log file holds the blocks of a range of ledgers, so that deleting
+// old ledgers can remove whole files.
+constexpr std::uint32_t ledgersPerLog = 1 << 16;
+
+// A directory entry is the offset of the block plus one, so that zero
+// means absent, the size of the block, its number of transactions and its
+// number of positions, and four reserved bytes.
+constexpr std::size_t entrySize = 24;
+
+// A block is a header, a slot for each transaction giving its index in
+// the ledger and the offset of its record, and the records. A record is
+// the ID, the status, the affected accounts, and the sizes and contents
+// of the transaction and its metadata.
+constexpr std::uint32_t blockMagic = 0x424c5854;  // "TXLB"
+constexpr std::size_t blockHeaderSize = 16;
+constexpr std::size_t slotSize = 8;
+
+// A segment is a header, the encoded positions of each account, the
+// sorted IDs with their positions, a directory of the blocks of
+// positions, a table of the accounts, and a footer.
+constexpr std::uint64_t segmentMagic = 0x3147455358444954ull;  // "TIDXSEG1"
+constexpr std::size_t segmentHeaderSize = 16;
+constexpr std::size_t positionsPerBlock = 128;
+constexpr std::size_t blockRefSize = 16;
+constexpr std::size_t idEntrySize = 40;
+constexpr std::size_t idsPerFence = 256;
+constexpr std::size_t accountEntrySize = 36;
+constexpr std::size_t footerSize = 56;
+
+void
+put32(std::uint8_t* p, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+void
+put64(std::uint8_t* p, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+std::uint32_t
+get32(std::uint8_t const* p)
+{
+    std::uint32_t v = 0;
+    for (int i = 3; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t
+get64(std::uint8_t const* p)
+{
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+void
+append32(std::vector<std::uint8_t>& b, std::uint32_t v)
+{
+    b.resize(b.size() + 4);
+    put32(b.data() + b.size() - 4, v);
+}
+
+void
+append64(std::vector<std::uint8_t>& b, std::uint64_t v)
+{
+    b.resize(b.size() + 8);
+    put64(b.data() + b.size() - 8, v);
+}
+
+void
+appendBytes(std::vector<std::uint8_t>& b, void const* data, std::size_t size)
+{
+    auto const p = static_cast<std::uint8_t const*>(data);
+    b.insert(b.end(), p, p + size);
+}
+
+void
+appendVarint(std::vector<std::uint8_t>& b, std::uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        b.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    b.push_back(static_cast<std::uint8_t>(v));
+}
+
+std::uint32_t
+getVarint(std::uint8_t const*& p, std::uint8_t const* end)
+{
+    std::uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (p == end)
+            break;
+        std::uint8_t const b = *p++;
+        v |= static_cast<std::uint32_t>(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+    Throw<std::runtime_error>("txindex: bad position encoding");
+    return 0;
+}
+
+// Appends the positions of an account, starting from the first position
+// of its block, which the block directory records.
+void
+encode(
+    std::vector<std::uint8_t>& b,
+    TxIndex::Position prev,
+    TxIndex::Position const& p)
+{
+    std::uint32_t const ledgerDelta = p.ledgerSeq - prev.ledgerSeq;
+    appendVarint(b, ledgerDelta);
+    appendVarint(b, ledgerDelta ? p.txnSeq : p.txnSeq - prev.txnSeq - 1);
+}
+
+boost::filesystem::path
+segmentPath(boost::filesystem::path const& dir, std::uint64_t id)
+{
+    return dir / ("seg-" + std::to_string(id) + ".dat");
+}
+
+// The transaction IDs and affected accounts of a block, as needed to
+// rebuild or remove its positions.
+struct BlockTx
+{
+    uint256 id;
+    std::uint32_t txnSeq;
+    std::vector<AccountID> accounts;
+};
+
+std::vector<BlockTx>
+parseBlock(std::vector<std::uint8_t> const& block)
+{
+    auto const bad = [] {
+        Throw<std::runtime_error>("txindex: bad ledger block");
+    };
+
+    if (block.size() < blockHeaderSize || get32(block.data()) != blockMagic)
+        bad();
+
+    std::uint32_t const count = get32(block.data() + 8);
+    if (block.size() < blockHeaderSize + count * slotSize)
+        bad();
+
+    std::vector<BlockTx> txs;
+    txs.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        auto const slot = block.data() + blockHeaderSize + i * slotSize;
+        std::size_t const offset = get32(slot + 4);
+        if (offset + uint256::bytes + 3 > block.size())
+            bad();
+
+        BlockTx tx;
+        tx.txnSeq = get32(slot);
+        auto p = block.data() + offset;
+        std::memcpy(tx.id.data(), p, uint256::bytes);
+        p += uint256::bytes + 1;
+        std::size_t const accounts = p[0] | (p[1] << 8);
+        p += 2;
+        if (p + accounts * AccountID::bytes > block.data() + block.size())
+            bad();
+        tx.accounts.resize(accounts);
+        for (auto& account : tx.accounts)
+        {
+            std::memcpy(account.data(), p, AccountID::bytes);
+            p += AccountID::bytes;
+        }
+        txs.push_back(std::move(tx));
+    }
+    return txs;
+}
+
+TxIndex::Record
+parseRecord(
+    std::uint8_t const* data,
+    std::size_t size,
+    TxIndex::Position const& position)
+{
+    auto const end = data + size;
+    auto const bad = [] {
+        Throw<std::runtime_error>("txindex: bad ledger block");
+    };
+
+    if (size < uint256::bytes + 3)
+        bad();
+
+    TxIndex::Record record;
+    record.position = position;
+    auto p = data;
+    std::memcpy(record.id.data(), p, uint256::bytes);
+    p += uint256::bytes;
+    record.status = static_cast<char>(*p++);
+    std::size_t const accounts = p[0] | (p[1] << 8);
+    p += 2;
+    if (static_cast<std::size_t>(end - p) < accounts * AccountID::bytes + 8)
+        bad();
+    p += accounts * AccountID::bytes;
+    std::size_t const txnSize = get32(p);
+    std::size_t const metaSize = get32(p + 4);
+    p += 8;
+    if (static_cast<std::size_t>(end - p) != txnSize + metaSize)
+        bad();
+    record.txn.assign(p, p + txnSize);
+    record.meta.assign(p + txnSize, end);
+    return record;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+
+class TxIndex::File
+{
+public:
+    File(boost::filesystem::path const& path, int flags)
+        : path_(path.string())
+        , fd_(::open(path_.c_str(), flags | O_CLOEXEC, 0644))
+    {
+        if (fd_ < 0)
+            throw std::system_error(errno, std::system_category(), path_);
+    }
+
+    ~File()
+    {
+        ::close(fd_);
+    }
+
+    File(File const&) = delete;
+    File&
+    operator=(File const&) = delete;
+
+    // Returns the number of bytes read, fewer only at the end of the file.
+    std::size_t
+    readSome(void* buffer, std::size_t size, std::uint64_t offset) const
+    {
+        auto p = static_cast<char*>(buffer);
+        std::size_t done = 0;
+        while (done < size)
+        {
+            auto const n = ::pread(fd_, p + done, size - done, offset + done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                throw std::system_error(errno, std::system_category(), path_);
+            if (n == 0)
+                break;
+            done += n;
+        }
+        return done;
+    }
+
+    void
+    read(void* buffer, std::size_t size, std::uint64_t offset) const
+    {
+        if (readSome(buffer, size, offset) != size)
+            Throw<std::runtime_error>("txindex: short read of " + path_);
+    }
+
+    void
+    write(void const* buffer, std::size_t size, std::uint64_t offset)
+    {
+        auto p = static_cast<char const*>(buffer);
+        std::size_t done = 0;
+        while (done < size)
+        {
+            auto const n =
+                ::pwrite(fd_, p + done, size - done, offset + done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                throw std::system_error(errno, std::system_category(), path_);
+            done += n;
+        }
+    }
+
+    std::uint64_t
+    size() const
+    {
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+            throw std::system_error(errno, std::system_category(), path_);
+        return st.st_size;
+    }
+
+    void
+    truncate(std::uint64_t size)
+    {
+        if (::ftruncate(fd_, size) != 0)
+            throw std::system_error(errno, std::system_category(), path_);
+    }
+
+    void
+    sync()
+    {
+        if (::fsync(fd_) != 0)
+            throw std::system_error(errno, std::system_category(), path_);
+    }
+
+    // Makes the files created, renamed or removed in a directory durable.
+    static void
+    syncDirectory(boost::filesystem::path const& dir)
+    {
+        File(dir, O_RDONLY | O_DIRECTORY).sync();
+    }
+
+private:
+    std::string const path_;
+    int const fd_;
+};
+
+//------------------------------------------------------------------------------
+
+struct TxIndex::Memtable
+{
+    hash_map<AccountID, std::vector<Position>> accounts;
+    hash_map<uint256, Position> ids;
+    std::set<std::uint32_t> ledgers;
+    std::size_t positions = 0;
+
+    void
+    add(std::uint32_t ledgerSeq, std::vector<BlockTx> const& txs)
+    {
+        for (auto const& tx : txs)
+        {
+            Position const position{ledgerSeq, tx.txnSeq};
+            ids[tx.id] = position;
+            for (auto const& account : tx.accounts)
+                accounts[account].push_back(position);
+            positions += tx.accounts.size();
+        }
+        ledgers.insert(ledgerSeq);
+    }
+
+    void
+    erase(std::uint32_t ledgerSeq, std::vector<BlockTx> const& txs)
+    {
+        if (ledgers.erase(ledgerSeq) == 0)
+            return;
+
+        for (auto const& tx : txs)
+        {
+            Position const position{ledgerSeq, tx.txnSeq};
+            if (auto it = ids.find(tx.id);
+                it != ids.end() && it->second == position)
+                ids.erase(it);
+            for (auto const& account : tx.accounts)
+            {
+                auto it = accounts.find(account);
+                if (it == accounts.end())
+                    continue;
+                auto& v = it->second;
+                auto const before = v.size();
+                v.erase(std::remove(v.begin(), v.end(), position), v.end());
+                positions -= before - v.size();
+                if (v.empty())
+                    accounts.erase(it);
+            }
+        }
+    }
+
+    // Removes everything below a ledger sequence.
+    void
+    eraseBefore(std::uint32_t ledgerSeq)
+    {
+        auto const below = [ledgerSeq](Position const& p) {
+            return p.ledgerSeq < ledgerSeq;
+        };
+        for (auto it = accounts.begin(); it != accounts.end();)
+        {
+            auto& v = it->second;
+            auto const before = v.size();
+            v.erase(std::remove_if(v.begin(), v.end(), below), v.end());
+            positions -= before - v.size();
+            if (v.empty())
+                it = accounts.erase(it);
+            else
+                ++it;
+        }
+        for (auto it = ids.begin(); it != ids.end();)
+        {
+            if (below(it->second))
+                it = ids.erase(it);
+            else
+                ++it;
+        }
+        ledgers.erase(ledgers.begin(), ledgers.lower_bound(ledgerSeq));
+    }
+
+    std::vector<Position>
+    sorted(AccountID const& account) const
+    {
+        auto it = accounts.find(account);
+        if (it == accounts.end())
+            return {};
+        auto v = it->second;
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+
+    std::uint64_t
+    bytes() const
+    {
+        return positions * sizeof(Position) + accounts.size() * 64 +
+            ids.size() * 64 + ledgers.size() * 32;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class TxIndex::Segment
+{
+public:
+    struct Account
+    {
+        AccountID account;
+        std::uint64_t firstBlock;
+        std::uint32_t blocks;
+        std::uint32_t count;
+    };
+
+    struct BlockRef
+    {
+        Position first;
+        std::uint64_t offset;
+        std::uint64_t end;
+        std::uint32_t count;
+    };
+
+    struct IdEntry
+    {
+        uint256 id;
+        Position position;
+    };
+
+    Segment(boost::filesystem::path const& dir, std::uint64_t id)
+        : id_(id), file_(segmentPath(dir, id), O_RDONLY), size_(file_.size())
+    {
+        std::uint8_t footer[footerSize];
+        if (size_ < segmentHeaderSize + footerSize)
+            Throw<std::runtime_error>("txindex: truncated segment");
+        file_.read(footer, footerSize, size_ - footerSize);
+        if (get64(footer + 48) != segmentMagic)
+            Throw<std::runtime_error>("txindex: bad segment");
+
+        blockDirOffset_ = get64(footer);
+        blockCount_ = get64(footer + 8);
+        idOffset_ = get64(footer + 16);
+        idCount_ = get64(footer + 24);
+        auto const accountOffset = get64(footer + 32);
+        auto const accountCount = get64(footer + 40);
+
+        std::vector<std::uint8_t> table(accountCount * accountEntrySize);
+        file_.read(table.data(), table.size(), accountOffset);
+        accounts_.resize(accountCount);
+        for (std::size_t i = 0; i < accountCount; ++i)
+        {
+            auto const p = table.data() + i * accountEntrySize;
+            auto& a = accounts_[i];
+            std::memcpy(a.account.data(), p, AccountID::bytes);
+            a.firstBlock = get64(p + 20);
+            a.blocks = get32(p + 28);
+            a.count = get32(p + 32);
+        }
+
+        fences_.resize((idCount_ + idsPerFence - 1) / idsPerFence);
+        for (std::size_t i = 0; i < fences_.size(); ++i)
+            file_.read(
+                fences_[i].data(),
+                uint256::bytes,
+                idOffset_ + i * idsPerFence * idEntrySize);
+    }
+
+    std::uint64_t
+    id() const
+    {
+        return id_;
+    }
+
+    std::uint64_t
+    bytes() const
+    {
+        return size_;
+    }
+
+    std::uint64_t
+    memoryUsed() const
+    {
+        return accounts_.size() * sizeof(Account) +
+            fences_.size() * uint256::bytes;
+    }
+
+    std::vector<Account> const&
+    accounts() const
+    {
+        return accounts_;
+    }
+
+    std::uint64_t
+    idCount() const
+    {
+        return idCount_;
+    }
+
+    Account const*
+    find(AccountID const& account) const
+    {
+        auto it = std::lower_bound(
+            accounts_.begin(),
+            accounts_.end(),
+            account,
+            [](Account const& a, AccountID const& b) { return a.account < b; });
+        if (it == accounts_.end() || it->account != account)
+            return nullptr;
+        return &*it;
+    }
+
+    std::vector<BlockRef>
+    blocks(Account const& account) const
+    {
+        // Read one entry past the account, if there is one, for the end
+        // of its last block.
+        bool const more = account.firstBlock + account.blocks < blockCount_;
+        std::vector<std::uint8_t> buffer(
+            (account.blocks + (more ? 1 : 0)) * blockRefSize);
+        file_.read(
+            buffer.data(),
+            buffer.size(),
+            blockDirOffset_ + account.firstBlock * blockRefSize);
+
+        std::vector<BlockRef> refs(account.blocks);
+        for (std::size_t i = 0; i < refs.size(); ++i)
+        {
+            auto const p = buffer.data() + i * blockRefSize;
+            refs[i].first = {get32(p), get32(p + 4)};
+            refs[i].offset = get64(p + 8);
+            refs[i].count = static_cast<std::uint32_t>(std::min<std::size_t>(
+                positionsPerBlock, account.count - i * positionsPerBlock));
+            if (i > 0)
+                refs[i - 1].end = refs[i].offset;
+        }
+        if (!refs.empty())
+            refs.back().end =
+                more ? get64(buffer.data() + refs.size() * blockRefSize + 8)
+                     : idOffset_;
+        return refs;
+    }
+
+    void
+    decode(BlockRef const& ref, std::vector<Position>& out) const
+    {
+        std::vector<std::uint8_t> buffer(ref.end - ref.offset);
+        file_.read(buffer.data(), buffer.size(), ref.offset);
+
+        out.clear();
+        out.reserve(ref.count);
+        out.push_back(ref.first);
+        std::uint8_t const* p = buffer.data();
+        auto const end = p + buffer.size();
+        for (std::uint32_t i = 1; i < ref.count; ++i)
+        {
+            auto const prev = out.back();
+            auto const ledgerDelta = getVarint(p, end);
+            auto const txn = getVarint(p, end);
+            if (ledgerDelta)
+                out.push_back(Position{prev.ledgerSeq + ledgerDelta, txn});
+            else
+                out.push_back(
+                    Position{prev.ledgerSeq, prev.txnSeq + txn + 1});
+        }
+    }
+
+    std::vector<Position>
+    positions(Account const& account) const
+    {
+        std::vector<Position> all, block;
+        all.reserve(account.count);
+        for (auto const& ref : blocks(account))
+        {
+            decode(ref, block);
+            all.insert(all.end(), block.begin(), block.end());
+        }
+        return all;
+    }
+
+    std::optional<Position>
+    find(uint256 const& id) const
+    {
+        auto it = std::upper_bound(fences_.begin(), fences_.end(), id);
+        if (it == fences_.begin())
+            return std::nullopt;
+
+        std::vector<IdEntry> entries;
+        readIds((it - fences_.begin() - 1) * idsPerFence, idsPerFence, entries);
+        auto e = std::lower_bound(
+            entries.begin(),
+            entries.end(),
+            id,
+            [](IdEntry const& a, uint256 const& b) { return a.id < b; });
+        if (e == entries.end() || e->id != id)
+            return std::nullopt;
+        return e->position;
+    }
+
+    void
+    readIds(std::uint64_t first, std::size_t n, std::vector<IdEntry>& out)
+        const
+    {
+        out.clear();
+        if (first >= idCount_)
+            return;
+        n = std::min<std::uint64_t>(n, idCount_ - first);
+        std::vector<std::uint8_t> buffer(n * idEntrySize);
+        file_.read(
+            buffer.data(), buffer.size(), idOffset_ + first * idEntrySize);
+        out.resize(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto const p = buffer.data() + i * idEntrySize;
+            std::memcpy(out[i].id.data(), p, uint256::bytes);
+            out[i].position = {get32(p + 32), get32(p + 36)};
+        }
+    }
+
+private:
+    std::uint64_t const id_;
+    File const file_;
+    std::uint64_t const size_;
+    std::uint64_t blockDirOffset_;
+    std::uint64_t blockCount_;
+    std::uint64_t idOffset_;
+    std::uint64_t idCount_;
+    std::vector<Account> accounts_;
+    std::vector<uint256> fences_;
+};
+
+//------------------------------------------------------------------------------
+
+/*  Writes a segment: accounts, in order, with their sorted positions, then
+    IDs, in order, with their positions.
+*/
+class TxIndex::SegmentWriter
+{
+public:
+    SegmentWriter(boost::filesystem::path const& path, std::uint64_t id)
+        : file_(path, O_WRONLY | O_CREAT | O_TRUNC)
+    {
+        std::uint8_t header[segmentHeaderSize];
+        put64(header, segmentMagic);
+        put64(header + 8, id);
+        put(header, sizeof(header));
+    }
+
+    void
+    add(AccountID const& account, std::vector<Position> const& positions)
+    {
+        assert(!positions.empty() && idOffset_ == 0);
+
+        appendBytes(accountTable_, account.data(), AccountID::bytes);
+        append64(accountTable_, blockCount_);
+        append32(
+            accountTable_,
+            (positions.size() + positionsPerBlock - 1) / positionsPerBlock);
+        append32(accountTable_, positions.size());
+
+        std::vector<std::uint8_t> block;
+        for (std::size_t i = 0; i < positions.size(); i += positionsPerBlock)
+        {
+            auto const& first = positions[i];
+            append32(blockDir_, first.ledgerSeq);
+            append32(blockDir_, first.txnSeq);
+            append64(blockDir_, offset_);
+            ++blockCount_;
+
+            block.clear();
+            auto const end =
+                std::min(positions.size(), i + positionsPerBlock);
+            for (std::size_t j = i + 1; j < end; ++j)
+                encode(block, positions[j - 1], positions[j]);
+            put(block.data(), block.size());
+        }
+    }
+
+    void
+    addId(uint256 const& id, Position const& position)
+    {
+        if (idOffset_ == 0)
+            idOffset_ = offset_;
+
+        std::uint8_t entry[idEntrySize];
+        std::memcpy(entry, id.data(), uint256::bytes);
+        put32(entry + 32, position.ledgerSeq);
+        put32(entry + 36, position.txnSeq);
+        put(entry, sizeof(entry));
+        ++idCount_;
+    }
+
+    void
+    finish()
+    {
+        if (idOffset_ == 0)
+            idOffset_ = offset_;
+
+        auto const blockDirOffset = offset_;
+        put(blockDir_.data(), blockDir_.size());
+        auto const accountOffset = offset_;
+        put(accountTable_.data(), accountTable_.size());
+
+        std::uint8_t footer[footerSize];
+        put64(footer, blockDirOffset);
+        put64(footer + 8, blockCount_);
+        put64(footer + 16, idOffset_);
+        put64(footer + 24, idCount_);
+        put64(footer + 32, accountOffset);
+        put64(footer + 40, accountTable_.size() / accountEntrySize);
+        put64(footer + 48, segmentMagic);
+        put(footer, sizeof(footer));
+
+        drain();
+        file_.sync();
+    }
+
+private:
+    File file_;
+    std::vector<std::uint8_t> buffer_;
+    std::uint64_t written_ = 0;
+    std::uint64_t offset_ = 0;
+    std::vector<std::uint8_t> blockDir_;
+    std::vector<std::uint8_t> accountTable_;
+    std::uint64_t blockCount_ = 0;
+    std::uint64_t idOffset_ = 0;
+    std::uint64_t idCount_ = 0;
+
+    void
+    put(void const* data, std::size_t size)
+    {
+        appendBytes(buffer_, data, size);
+        offset_ += size;
+        if (buffer_.size() >= (1 << 20))
+            drain();
+    }
+
+    void
+    drain()
+    {
+        file_.write(buffer_.data(), buffer_.size(), written_);
+        written_ += buffer_.size();
+        buffer_.clear();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/*  Steps through the positions of one account in one source, a segment or
+    a memtable, within bounds, reading the blocks of a segment as needed.
+*/
+class TxIndex::Cursor
+{
+public:
+    Cursor(
+        std::vector<Position> positions,
+        std::uint64_t source,
+        bool forward,
+        Position const& lo,
+        Position const& hi)
+        : source_(source)
+        , forward_(forward)
+        , lo_(lo)
+        , hi_(hi)
+        , buffer_(std::move(positions))
+    {
+        start(buffer_.empty() ? 0 : 1);
+    }
+
+    Cursor(
+        std::shared_ptr<Segment const> segment,
+        Segment::Account const& account,
+        bool forward,
+        Position const& lo,
+        Position const& hi)
+        : segment_(std::move(segment))
+        , source_(segment_->id())
+        , forward_(forward)
+        , lo_(lo)
+        , hi_(hi)
+        , blocks_(segment_->blocks(account))
+    {
+        start(blocks_.size());
+    }
+
+    bool
+    valid() const
+    {
+        return valid_;
+    }
+
+    Position const&
+    get() const
+    {
+        return buffer_[index_];
+    }
+
+    std::uint64_t
+    source() const
+    {
+        return source_;
+    }
+
+    void
+    next()
+    {
+        if (forward_)
+        {
+            if (++index_ == buffer_.size() && !load(block_ + 1))
+                valid_ = false;
+            else
+                valid_ = get() <= hi_;
+        }
+        else
+        {
+            if (index_ == 0 && !load(block_ - 1))
+                valid_ = false;
+            else
+                valid_ = buffer_[--index_] >= lo_;
+        }
+    }
+
+private:
+    std::shared_ptr<Segment const> segment_;
+    std::uint64_t source_;
+    bool forward_;
+    Position lo_;
+    Position hi_;
+    std::vector<Segment::BlockRef> blocks_;
+    std::vector<Position> buffer_;
+    std::ptrdiff_t block_ = 0;
+    std::size_t index_ = 0;
+    bool valid_ = false;
+
+    // Makes the given block current, leaving the index at its start when
+    // going forward and past its end when going back.
+    bool
+    load(std::ptrdiff_t block)
+    {
+        auto const count = segment_ ? blocks_.size() : 1;
+        if (block < 0 || block >= static_cast<std::ptrdiff_t>(count))
+            return false;
+        block_ = block;
+        if (segment_)
+            segment_->decode(blocks_[block], buffer_);
+        index_ = forward_ ? 0 : buffer_.size();
+        return true;
+    }
+
+    void
+    start(std::size_t blocks)
+    {
+        if (blocks == 0 || lo_ > hi_)
+            return;
+
+        auto const target = forward_ ? lo_ : hi_;
+        std::ptrdiff_t block = 0;
+        if (segment_)
+        {
+            // The last block starting at or before the target
+            auto it = std::upper_bound(
+                blocks_.begin(),
+                blocks_.end(),
+                target,
+                [](Position const& p, Segment::BlockRef const& b) {
+                    return p < b.first;
+                });
+            block = (it - blocks_.begin()) - 1;
+            if (block < 0)
+            {
+                if (!forward_)
+                    return;
+                block = 0;
+            }
+        }
+        load(block);
+
+        if (forward_)
+        {
+            index_ = std::lower_bound(buffer_.begin(), buffer_.end(), lo_) -
+                buffer_.begin();
+            if (index_ == buffer_.size() && !load(block_ + 1))
+                return;
+            valid_ = get() <= hi_;
+        }
+        else
+        {
+            index_ = std::upper_bound(buffer_.begin(), buffer_.end(), hi_) -
+                buffer_.begin();
+            if (index_ == 0)
+                return;
+            --index_;
+            valid_ = get() >= lo_;
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+TxIndex::TxIndex(
+    boost::filesystem::path const& dir,
+    Setup const& setup,
+    beast::Journal j)
+    : dir_(dir), setup_(setup), j_(j), active_(std::make_unique<Memtable>())
+{
+    boost::filesystem::create_directories(dir_);
+
+    readManifest();
+
+    // Remove what an interrupted write or merge left behind
+    std::set<std::string> live;
+    for (auto const& segment : segments_)
+        live.insert(segmentPath(dir_, segment->id()).filename().string());
+    for (auto const& entry : boost::filesystem::directory_iterator(dir_))
+    {
+        auto const name = entry.path().filename().string();
+        if (entry.path().extension() == ".tmp" ||
+            (name.rfind("seg-", 0) == 0 && !live.count(name)))
+            boost::filesystem::remove(entry.path());
+    }
+
+    directory_ =
+        std::make_unique<File>(dir_ / "ledgers.dir", O_RDWR | O_CREAT);
+    pending_ = std::make_unique<File>(dir_ / "pending", O_RDWR | O_CREAT);
+
+    replay();
+
+    worker_ = std::thread([this] { run(); });
+}
+
+TxIndex::~TxIndex()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    worker_.join();
+}
+
+void
+TxIndex::saveLedger(std::uint32_t ledgerSeq, std::vector<Tx> const& txs)
+{
+    std::vector<Tx const*> sorted;
+    sorted.reserve(txs.size());
+    for (auto const& tx : txs)
+        sorted.push_back(&tx);
+    std::sort(sorted.begin(), sorted.end(), [](auto const& a, auto const& b) {
+        return a->txnSeq < b->txnSeq;
+    });
+
+    std::vector<std::uint8_t> block(blockHeaderSize + txs.size() * slotSize);
+    put32(block.data(), blockMagic);
+    put32(block.data() + 4, ledgerSeq);
+    put32(block.data() + 8, txs.size());
+
+    std::vector<BlockTx> added;
+    added.reserve(txs.size());
+    std::uint32_t positions = 0;
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+    {
+        auto const& tx = *sorted[i];
+        auto const slot = block.data() + blockHeaderSize + i * slotSize;
+        put32(slot, tx.txnSeq);
+        put32(slot + 4, block.size());
+
+        appendBytes(block, tx.id.data(), uint256::bytes);
+        block.push_back(static_cast<std::uint8_t>(tx.status));
+        block.push_back(static_cast<std::uint8_t>(tx.accounts.size()));
+        block.push_back(static_cast<std::uint8_t>(tx.accounts.size() >> 8));
+        for (auto const& account : tx.accounts)
+            appendBytes(block, account.data(), AccountID::bytes);
+        append32(block, tx.txn.size());
+        append32(block, tx.meta.size());
+        appendBytes(block, tx.txn.data(), tx.txn.size());
+        appendBytes(block, tx.meta.data(), tx.meta.size());
+
+        added.push_back(
+            {tx.id,
+             tx.txnSeq,
+             std::vector<AccountID>(tx.accounts.begin(), tx.accounts.end())});
+        positions += tx.accounts.size();
+    }
+
+    std::lock_guard writing(write_);
+
+    std::shared_ptr<File> file;
+    {
+        std::lock_guard lock(mutex_);
+        file = log(ledgerSeq, lock);
+    }
+
+    // A ledger saved before is replaced, so its positions must go
+    auto const old = readEntry(ledgerSeq);
+    std::vector<std::uint8_t> oldBlock;
+    if (old)
+    {
+        oldBlock.resize(old->size);
+        file->read(oldBlock.data(), oldBlock.size(), old->offset);
+    }
+
+    // The block, its directory entry and its place in the pending file
+    // are each durable before the next is written, and all of them before
+    // the manifest counts the ledger. So after a crash a ledger is either
+    // whole or not there; see replay().
+    auto const offset = file->size();
+    file->write(block.data(), block.size(), offset);
+    if (setup_.sync)
+        file->sync();
+    writeEntry(
+        ledgerSeq,
+        {offset,
+         static_cast<std::uint32_t>(block.size()),
+         static_cast<std::uint32_t>(txs.size()),
+         positions});
+    if (setup_.sync)
+        directory_->sync();
+
+    std::uint8_t seq[4];
+    put32(seq, ledgerSeq);
+    pending_->write(seq, sizeof(seq), pending_->size());
+    if (setup_.sync)
+        pending_->sync();
+
+    std::string contents;
+    bool frozen = false;
+    {
+        std::lock_guard lock(mutex_);
+
+        if (old)
+            remove(ledgerSeq, *old, oldBlock, lock);
+
+        active_->add(ledgerSeq, added);
+        transactions_ += txs.size();
+        positions_ += positions;
+        if (!minLedger_ || ledgerSeq < *minLedger_)
+            minLedger_ = ledgerSeq;
+        if (!maxLedger_ || ledgerSeq > *maxLedger_)
+            maxLedger_ = ledgerSeq;
+        if (setup_.sync)
+            contents = manifest(lock);
+
+        frozen =
+            active_->positions >= setup_.memtablePositions && freeze(lock);
+    }
+    if (setup_.sync)
+        writeManifest(contents, writing);
+
+    if (frozen)
+        wake_.notify_all();
+}
+
+void
+TxIndex::deleteLedger(std::uint32_t ledgerSeq)
+{
+    // Only writers change the directory and the ledger range, so holding
+    // write_ the files are read and written without holding mutex_
+    std::lock_guard writing(write_);
+
+    auto const entry = readEntry(ledgerSeq);
+    if (!entry)
+        return;
+
+    std::shared_ptr<File> file;
+    std::optional<std::uint32_t> minLedger;
+    std::optional<std::uint32_t> maxLedger;
+    {
+        std::lock_guard lock(mutex_);
+        file = log(ledgerSeq, lock);
+        minLedger = minLedger_;
+        maxLedger = maxLedger_;
+    }
+
+    std::vector<std::uint8_t> block(entry->size);
+    file->read(block.data(), block.size(), entry->offset);
+    writeEntry(ledgerSeq, {});
+
+    if (ledgerSeq == minLedger)
+        minLedger = scan(ledgerSeq, *maxLedger, true);
+    if (!minLedger)
+        maxLedger.reset();
+    else if (ledgerSeq == maxLedger)
+        maxLedger = scan(*minLedger, ledgerSeq, false);
+
+    std::string contents;
+    {
+        std::lock_guard lock(mutex_);
+        remove(ledgerSeq, *entry, block, lock);
+        minLedger_ = minLedger;
+        maxLedger_ = maxLedger;
+        contents = manifest(lock);
+    }
+    directory_->sync();
+    writeManifest(contents, writing);
+}
+
+void
+TxIndex::deleteBefore(std::uint32_t ledgerSeq)
+{
+    std::lock_guard writing(write_);
+
+    // Readers stop returning anything below the floor as soon as it is
+    // raised, so the directory and the logs are cleared after, without
+    // holding them up.
+    std::optional<std::uint32_t> minLedger;
+    std::optional<std::uint32_t> maxLedger;
+    {
+        std::lock_guard lock(mutex_);
+        if (ledgerSeq <= floor_)
+            return;
+        floor_ = ledgerSeq;
+        active_->eraseBefore(ledgerSeq);
+        minLedger = minLedger_;
+        maxLedger = maxLedger_;
+    }
+
+    std::uint64_t transactions = 0;
+    std::uint64_t positions = 0;
+    if (minLedger && *minLedger < ledgerSeq)
+    {
+        // Clear the directory below the floor, counting what goes
+        std::uint32_t const end = std::min(ledgerSeq, *maxLedger + 1);
+        std::uint32_t constexpr chunk = 4096;
+        std::vector<std::uint8_t> buffer(chunk * entrySize);
+        for (std::uint32_t first = *minLedger; first < end; first += chunk)
+        {
+            auto const n = std::min(chunk, end - first);
+            auto const bytes = directory_->readSome(
+                buffer.data(), n * entrySize, first * entrySize);
+            for (std::size_t i = 0; i + entrySize <= bytes; i += entrySize)
+            {
+                if (get64(buffer.data() + i) == 0)
+                    continue;
+                transactions += get32(buffer.data() + i + 12);
+                positions += get32(buffer.data() + i + 16);
+            }
+            std::fill(buffer.begin(), buffer.end(), 0);
+            if (bytes)
+                directory_->write(buffer.data(), bytes, first * entrySize);
+        }
+
+        minLedger = ledgerSeq <= *maxLedger
+            ? scan(ledgerSeq, *maxLedger, true)
+            : std::nullopt;
+        if (!minLedger)
+            maxLedger.reset();
+    }
+
+    std::string contents;
+    {
+        std::lock_guard lock(mutex_);
+        transactions_ -= transactions;
+        positions_ -= positions;
+        minLedger_ = minLedger;
+        maxLedger_ = maxLedger;
+
+        // Whole log files below the floor are no longer needed
+        for (auto it = logs_.begin(); it != logs_.end();)
+        {
+            if ((it->first + 1) * std::uint64_t(ledgersPerLog) > ledgerSeq)
+                break;
+            it = logs_.erase(it);
+        }
+
+        contents = manifest(lock);
+    }
+
+    // A reader still holding one of these files keeps it open
+    for (auto const& entry : boost::filesystem::directory_iterator(dir_))
+    {
+        auto const name = entry.path().filename().string();
+        if (name.rfind("txs-", 0) != 0 || entry.path().extension() != ".log")
+            continue;
+        auto const index = std::stoul(name.substr(4));
+        if ((index + 1) * std::uint64_t(ledgersPerLog) <= ledgerSeq)
+            boost::filesystem::remove(entry.path());
+    }
+
+    directory_->sync();
+    writeManifest(contents, writing);
+}
+
+std::optional<TxIndex::Record>
+TxIndex::fetch(uint256 const& id) const
+{
+    std::vector<std::shared_ptr<Segment const>> segments;
+    std::shared_ptr<Memtable const> frozen;
+    std::uint64_t frozenId;
+    Tombstones tombstones;
+    std::uint32_t floor;
+    std::optional<Position> position;
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = active_->ids.find(id); it != active_->ids.end())
+            position = it->second;
+        segments = segments_;
+        frozen = frozen_;
+        frozenId = frozenId_;
+        tombstones = tombstones_;
+        floor = floor_;
+    }
+
+    auto const dead = [&](Position const& p, std::uint64_t source) {
+        if (p.ledgerSeq < floor)
+            return true;
+        auto it = tombstones.find(p.ledgerSeq);
+        return it != tombstones.end() && source < it->second;
+    };
+
+    if (!position && frozen)
+    {
+        if (auto it = frozen->ids.find(id); it != frozen->ids.end())
+        {
+            if (dead(it->second, frozenId))
+                return std::nullopt;
+            position = it->second;
+        }
+    }
+    for (auto it = segments.rbegin(); !position && it != segments.rend();
+         ++it)
+    {
+        if (auto const p = (*it)->find(id))
+        {
+            if (dead(*p, (*it)->id()))
+                return std::nullopt;
+            position = p;
+        }
+    }
+
+    if (!position)
+        return std::nullopt;
+
+    auto record = fetch(*position);
+    if (record && record->id != id)
+        return std::nullopt;
+    return record;
+}
+
+std::optional<TxIndex::Record>
+TxIndex::fetch(Position const& position) const
+{
+    auto const entry = readEntry(position.ledgerSeq);
+    if (!entry || entry->count == 0)
+        return std::nullopt;
+
+    std::shared_ptr<File> file;
+    {
+        std::lock_guard lock(mutex_);
+        file = log(position.ledgerSeq, lock);
+    }
+
+    std::vector<std::uint8_t> slots(entry->count * slotSize);
+    file->read(slots.data(), slots.size(), entry->offset + blockHeaderSize);
+
+    // Slots are sorted by index in the ledger
+    std::size_t lo = 0, hi = entry->count;
+    while (lo < hi)
+    {
+        auto const mid = lo + (hi - lo) / 2;
+        if (get32(slots.data() + mid * slotSize) < position.txnSeq)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == entry->count ||
+        get32(slots.data() + lo * slotSize) != position.txnSeq)
+        return std::nullopt;
+
+    std::uint32_t const begin = get32(slots.data() + lo * slotSize + 4);
+    std::uint32_t const end = lo + 1 < entry->count
+        ? get32(slots.data() + (lo + 1) * slotSize + 4)
+        : entry->size;
+    if (begin > end || end > entry->size)
+        Throw<std::runtime_error>("txindex: bad ledger block");
+
+    std::vector<std::uint8_t> buffer(end - begin);
+    file->read(buffer.data(), buffer.size(), entry->offset + begin);
+    return parseRecord(buffer.data(), buffer.size(), position);
+}
+
+std::vector<TxIndex::Record>
+TxIndex::fetchLedger(std::uint32_t ledgerSeq) const
+{
+    auto const entry = readEntry(ledgerSeq);
+    if (!entry)
+        return {};
+
+    std::shared_ptr<File> file;
+    {
+        std::lock_guard lock(mutex_);
+        file = log(ledgerSeq, lock);
+    }
+
+    std::vector<std::uint8_t> block(entry->size);
+    file->read(block.data(), block.size(), entry->offset);
+
+    std::vector<Record> records;
+    records.reserve(entry->count);
+    for (std::uint32_t i = 0; i < entry->count; ++i)
+    {
+        auto const slot = block.data() + blockHeaderSize + i * slotSize;
+        std::uint32_t const begin = get32(slot + 4);
+        std::uint32_t const end =
+            i + 1 < entry->count ? get32(slot + slotSize + 4) : entry->size;
+        if (begin > end || end > entry->size)
+            Throw<std::runtime_error>("txindex: bad ledger block");
+        records.push_back(parseRecord(
+            block.data() + begin, end - begin, {ledgerSeq, get32(slot)}));
+    }
+    return records;
+}
+
+void
+TxIndex::forEach(
+    AccountID const& account,
+    std::uint32_t minLedger,
+    std::uint32_t maxLedger,
+    bool forward,
+    std::optional<Position> const& from,
+    std::function<bool(Position const&)> const& f) const
+{
+    Position lo{minLedger, 0};
+    Position hi{maxLedger, std::numeric_limits<std::uint32_t>::max()};
+    if (from)
+    {
+        if (forward)
+            lo = std::max(lo, *from);
+        else
+            hi = std::min(hi, *from);
+    }
+    if (lo > hi)
+        return;
+
+    std::vector<std::shared_ptr<Segment const>> segments;
+    std::shared_ptr<Memtable const> frozen;
+    std::uint64_t frozenId;
+    std::vector<Position> active;
+    Tombstones tombstones;
+    std::uint32_t floor;
+    {
+        std::lock_guard lock(mutex_);
+        segments = segments_;
+        frozen = frozen_;
+        frozenId = frozenId_;
+        active = active_->sorted(account);
+        tombstones = tombstones_;
+        floor = floor_;
+    }
+
+    // The active memtable is newer than every tombstone
+    std::vector<Cursor> cursors;
+    cursors.reserve(segments.size() + 2);
+    cursors.emplace_back(
+        std::move(active),
+        std::numeric_limits<std::uint64_t>::max(),
+        forward,
+        lo,
+        hi);
+    if (frozen)
+        cursors.emplace_back(
+            frozen->sorted(account), frozenId, forward, lo, hi);
+    for (auto const& segment : segments)
+    {
+        if (auto const a = segment->find(account))
+            cursors.emplace_back(segment, *a, forward, lo, hi);
+    }
+
+    auto const dead = [&](Position const& p, std::uint64_t source) {
+        if (p.ledgerSeq < floor)
+            return true;
+        auto it = tombstones.find(p.ledgerSeq);
+        return it != tombstones.end() && source < it->second;
+    };
+    auto const settle = [&](Cursor& c) {
+        while (c.valid() && dead(c.get(), c.source()))
+            c.next();
+    };
+    for (auto& c : cursors)
+        settle(c);
+
+    while (true)
+    {
+        std::optional<Position> best;
+        for (auto const& c : cursors)
+        {
+            if (c.valid() &&
+                (!best || (forward ? c.get() < *best : c.get() > *best)))
+                best = c.get();
+        }
+        if (!best)
+            return;
+
+        // The same position may be in more than one source
+        for (auto& c : cursors)
+        {
+            while (c.valid() && c.get() == *best)
+            {
+                c.next();
+                settle(c);
+            }
+        }
+
+        if (!f(*best))
+            return;
+    }
+}
+
+std::optional<std::uint32_t>
+TxIndex::transactionsIn(std::uint32_t ledgerSeq) const
+{
+    if (auto const entry = readEntry(ledgerSeq))
+        return entry->count;
+    return std::nullopt;
+}
+
+std::uint32_t
+TxIndex::ledgersIn(std::uint32_t first, std::uint32_t last) const
+{
+    std::uint32_t found = 0;
+    std::uint32_t constexpr chunk = 4096;
+    std::vector<std::uint8_t> buffer(chunk * entrySize);
+    for (std::uint64_t seq = first; seq <= last; seq += chunk)
+    {
+        auto const n = std::min<std::uint64_t>(chunk, last - seq + 1);
+        auto const bytes =
+            directory_->readSome(buffer.data(), n * entrySize, seq * entrySize);
+        for (std::size_t i = 0; i + entrySize <= bytes; i += entrySize)
+        {
+            if (get64(buffer.data() + i) != 0)
+                ++found;
+        }
+        if (bytes < n * entrySize)
+            break;
+    }
+    return found;
+}
+
+std::optional<std::uint32_t>
+TxIndex::minLedger() const
+{
+    std::lock_guard lock(mutex_);
+    return minLedger_;
+}
+
+std::optional<std::uint32_t>
+TxIndex::maxLedger() const
+{
+    std::lock_guard lock(mutex_);
+    return maxLedger_;
+}
+
+std::uint64_t
+TxIndex::transactionCount() const
+{
+    std::lock_guard lock(mutex_);
+    return transactions_;
+}
+
+std::uint64_t
+TxIndex::positionCount() const
+{
+    std::lock_guard lock(mutex_);
+    return positions_;
+}
+
+std::uint64_t
+TxIndex::memoryUsed() const
+{
+    std::lock_guard lock(mutex_);
+    std::uint64_t bytes = active_->bytes();
+    if (frozen_)
+        bytes += frozen_->bytes();
+    for (auto const& segment : segments_)
+        bytes += segment->memoryUsed();
+    return bytes;
+}
+
+void
+TxIndex::flush()
+{
+    std::lock_guard maintenance(maintenance_);
+    writeFrozen();
+    {
+        std::lock_guard lock(mutex_);
+        if (!freeze(lock))
+            return;
+    }
+    writeFrozen();
+}
+
+void
+TxIndex::compact()
+{
+    std::lock_guard maintenance(maintenance_);
+    writeFrozen();
+    mergeSome(true);
+}
+
+std::size_t
+TxIndex::segmentCount() const
+{
+    std::lock_guard lock(mutex_);
+    return segments_.size();
+}
+
+std::shared_ptr<TxIndex::File>
+TxIndex::log(std::uint32_t ledgerSeq, std::lock_guard<std::mutex> const&)
+    const
+{
+    auto const index = ledgerSeq / ledgersPerLog;
+    auto& file = logs_[index];
+    if (!file)
+        file = std::make_shared<File>(
+            dir_ / ("txs-" + std::to_string(index) + ".log"),
+            O_RDWR | O_CREAT);
+    return file;
+}
+
+std::optional<std::uint32_t>
+TxIndex::scan(std::uint32_t from, std::uint32_t to, bool forward) const
+{
+    if (from > to)
+        return std::nullopt;
+
+    std::uint32_t constexpr chunk = 4096;
+    std::vector<std::uint8_t> buffer(chunk * entrySize);
+    std::uint64_t const span = std::uint64_t(to) - from + 1;
+    for (std::uint64_t done = 0; done < span; done += chunk)
+    {
+        auto const n = std::min<std::uint64_t>(chunk, span - done);
+        std::uint64_t const first = forward ? from + done : to - done - n + 1;
+        auto const bytes = directory_->readSome(
+            buffer.data(), n * entrySize, first * entrySize);
+        for (std::uint64_t k = 0; k < n; ++k)
+        {
+            auto const i = forward ? k : n - 1 - k;
+            if ((i + 1) * entrySize <= bytes &&
+                get64(buffer.data() + i * entrySize) != 0)
+                return static_cast<std::uint32_t>(first + i);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<TxIndex::DirEntry>
+TxIndex::readEntry(std::uint32_t ledgerSeq) const
+{
+    std::uint8_t buffer[entrySize];
+    if (directory_->readSome(
+            buffer, entrySize, std::uint64_t(ledgerSeq) * entrySize) !=
+            entrySize ||
+        get64(buffer) == 0)
+        return std::nullopt;
+    return DirEntry{
+        get64(buffer) - 1,
+        get32(buffer + 8),
+        get32(buffer + 12),
+        get32(buffer + 16)};
+}
+
+void
+TxIndex::writeEntry(std::uint32_t ledgerSeq, DirEntry const& entry)
+{
+    std::uint8_t buffer[entrySize] = {};
+    if (entry.size != 0)
+    {
+        put64(buffer, entry.offset + 1);
+        put32(buffer + 8, entry.size);
+        put32(buffer + 12, entry.count);
+        put32(buffer + 16, entry.positions);
+    }
+    directory_->write(buffer, entrySize, std::uint64_t(ledgerSeq) * entrySize);
+}
+
+void
+TxIndex::remove(
+    std::uint32_t ledgerSeq,
+    DirEntry const& entry,
+    std::vector<std::uint8_t> const& block,
+    std::lock_guard<std::mutex> const&)
+{
+    active_->erase(ledgerSeq, parseBlock(block));
+
+    // Hide what was written before from here on
+    if (frozen_ || !segments_.empty())
+        tombstones_[ledgerSeq] = nextId_;
+
+    transactions_ -= entry.count;
+    positions_ -= entry.positions;
+}
+
+void
+TxIndex::retireTombstones(std::lock_guard<std::mutex> const&)
+{
+    // A tombstone hides sources older than itself; once none is left it
+    // has nothing to hide.
+    auto oldest = std::numeric_limits<std::uint64_t>::max();
+    if (frozen_)
+        oldest = frozenId_;
+    for (auto const& segment : segments_)
+        oldest = std::min(oldest, segment->id());
+    for (auto it = tombstones_.begin(); it != tombstones_.end();)
+    {
+        if (it->second <= oldest)
+            it = tombstones_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void
+TxIndex::readManifest()
+{
+    std::ifstream in((dir_ / "MANIFEST").string());
+    if (!in)
+        return;
+
+    std::string word;
+    std::uint64_t version = 0;
+    if (!(in >> word >> version) || word != "txindex" || version != 1)
+        Throw<std::runtime_error>("txindex: bad manifest");
+
+    std::uint64_t v;
+    while (in >> word)
+    {
+        if (word == "next" && in >> v)
+            nextId_ = v;
+        else if (word == "floor" && in >> v)
+            floor_ = v;
+        else if (word == "min" && in >> v)
+            minLedger_ = v;
+        else if (word == "max" && in >> v)
+            maxLedger_ = v;
+        else if (word == "transactions" && in >> v)
+            transactions_ = v;
+        else if (word == "positions" && in >> v)
+            positions_ = v;
+        else if (word == "segment" && in >> v)
+            segments_.push_back(std::make_shared<Segment const>(dir_, v));
+        else if (std::uint64_t epoch; word == "tombstone" && in >> v >> epoch)
+            tombstones_[v] = epoch;
+        else
+            Throw<std::runtime_error>("txindex: bad manifest");
+    }
+}
+
+std::string
+TxIndex::manifest(std::lock_guard<std::mutex> const&) const
+{
+    std::ostringstream out;
+    out << "txindex 1\n"
+        << "next " << nextId_ << '\n'
+        << "floor " << floor_ << '\n'
+        << "transactions " << transactions_ << '\n'
+        << "positions " << positions_ << '\n';
+    if (minLedger_)
+        out << "min " << *minLedger_ << '\n'
+            << "max " << *maxLedger_ << '\n';
+    for (auto const& segment : segments_)
+        out << "segment " << segment->id() << '\n';
+    for (auto const& [seq, epoch] : tombstones_)
+        out << "tombstone " << seq << ' ' << epoch << '\n';
+    return out.str();
+}
+
+void
+TxIndex::writeManifest(
+    std::string const& contents,
+    std::lock_guard<std::mutex> const&)
+{
+    // Written aside and renamed over the old one, syncing each step, so
+    // that a crash leaves one whole manifest or the other. The directory
+    // is synced first so the segments the manifest names are there.
+    auto const temp = dir_ / "MANIFEST.tmp";
+    {
+        File file(temp, O_WRONLY | O_CREAT | O_TRUNC);
+        file.write(contents.data(), contents.size(), 0);
+        file.sync();
+    }
+    File::syncDirectory(dir_);
+    boost::filesystem::rename(temp, dir_ / "MANIFEST");
+    File::syncDirectory(dir_);
+}
+
+void
+TxIndex::writePending(
+    std::vector<std::uint32_t> const& ledgers,
+    std::lock_guard<std::mutex> const&)
+{
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(ledgers.size() * 4);
+    for (auto const seq : ledgers)
+        append32(buffer, seq);
+
+    // Replaced as the manifest is, since truncating it in place could
+    // lose ledgers yet to be written to a segment.
+    auto const path = dir_ / "pending";
+    auto const temp = dir_ / "pending.tmp";
+    {
+        File file(temp, O_WRONLY | O_CREAT | O_TRUNC);
+        file.write(buffer.data(), buffer.size(), 0);
+        file.sync();
+    }
+    boost::filesystem::rename(temp, path);
+    File::syncDirectory(dir_);
+    pending_ = std::make_unique<File>(path, O_RDWR);
+}
+
+void
+TxIndex::replay()
+{
+    // A crash while saving a ledger can leave part of its sequence at the
+    // end of the pending file or, if the ledger was saved before, a
+    // directory entry which does not point at a whole block. Both are
+    // dropped, as a save which did not complete, rather than refusing to
+    // open.
+    auto const size = pending_->size();
+    std::vector<std::uint8_t> buffer(size & ~std::uint64_t(3));
+    pending_->read(buffer.data(), buffer.size(), 0);
+    if (buffer.size() != size)
+    {
+        JLOG(j_.warn()) << "txindex: dropping torn end of pending ledgers";
+        pending_->truncate(buffer.size());
+        pending_->sync();
+    }
+
+    std::set<std::uint32_t> ledgers;
+    for (std::size_t i = 0; i < buffer.size(); i += 4)
+        ledgers.insert(get32(buffer.data() + i));
+
+    std::lock_guard lock(mutex_);
+    bool dropped = false;
+    for (auto const seq : ledgers)
+    {
+        auto const entry = readEntry(seq);
+        if (!entry)
+            continue;
+        try
+        {
+            std::vector<std::uint8_t> block(entry->size);
+            log(seq, lock)->read(block.data(), block.size(), entry->offset);
+            active_->add(seq, parseBlock(block));
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.warn()) << "txindex: dropping torn ledger " << seq
+                            << ": " << e.what();
+            writeEntry(seq, {});
+            dropped = true;
+        }
+    }
+    if (dropped)
+        directory_->sync();
+
+    JLOG(j_.info()) << "txindex: " << segments_.size() << " segments, "
+                    << ledgers.size() << " ledgers replayed";
+}
+
+bool
+TxIndex::freeze(std::lock_guard<std::mutex> const&)
+{
+    if (frozen_ || active_->positions == 0)
+        return false;
+    frozen_ = std::move(active_);
+    frozenId_ = nextId_++;
+    active_ = std::make_unique<Memtable>();
+    return true;
+}
+
+void
+TxIndex::writeFrozen()
+{
+    std::shared_ptr<Memtable const> frozen;
+    std::uint64_t id;
+    Tombstones tombstones;
+    std::uint32_t floor;
+    {
+        std::lock_guard lock(mutex_);
+        if (!frozen_)
+            return;
+        frozen = frozen_;
+        id = frozenId_;
+        tombstones = tombstones_;
+        floor = floor_;
+    }
+
+    auto const dead = [&](Position const& p) {
+        if (p.ledgerSeq < floor)
+            return true;
+        auto it = tombstones.find(p.ledgerSeq);
+        return it != tombstones.end() && id < it->second;
+    };
+
+    auto const temp = dir_ / ("seg-" + std::to_string(id) + ".tmp");
+    {
+        SegmentWriter writer(temp, id);
+
+        std::vector<AccountID> accounts;
+        accounts.reserve(frozen->accounts.size());
+        for (auto const& [account, _] : frozen->accounts)
+            accounts.push_back(account);
+        std::sort(accounts.begin(), accounts.end());
+        for (auto const& account : accounts)
+        {
+            auto positions = frozen->sorted(account);
+            positions.erase(
+                std::unique(positions.begin(), positions.end()),
+                positions.end());
+            positions.erase(
+                std::remove_if(positions.begin(), positions.end(), dead),
+                positions.end());
+            if (!positions.empty())
+                writer.add(account, positions);
+        }
+
+        std::vector<std::pair<uint256, Position>> ids(
+            frozen->ids.begin(), frozen->ids.end());
+        std::sort(ids.begin(), ids.end());
+        for (auto const& [txId, position] : ids)
+        {
+            if (!dead(position))
+                writer.addId(txId, position);
+        }
+
+        writer.finish();
+    }
+    boost::filesystem::rename(temp, segmentPath(dir_, id));
+    auto segment = std::make_shared<Segment const>(dir_, id);
+
+    // The manifest must name the segment before the pending file forgets
+    // the ledgers in it.
+    std::lock_guard writing(write_);
+    std::string contents;
+    std::vector<std::uint32_t> pending;
+    std::vector<std::shared_ptr<File>> logs;
+    {
+        std::lock_guard lock(mutex_);
+        segments_.push_back(std::move(segment));
+        frozen_.reset();
+        retireTombstones(lock);
+        contents = manifest(lock);
+        pending.assign(active_->ledgers.begin(), active_->ledgers.end());
+        if (!setup_.sync)
+        {
+            for (auto const& [_, log] : logs_)
+                logs.push_back(log);
+        }
+    }
+
+    // Ledgers saved without syncing become durable with the segment
+    for (auto const& log : logs)
+        log->sync();
+    if (!setup_.sync)
+        directory_->sync();
+    writeManifest(contents, writing);
+    writePending(pending, writing);
+
+    JLOG(j_.debug()) << "txindex: wrote segment " << id;
+}
+
+bool
+TxIndex::mergeSome(bool all)
+{
+    std::vector<std::shared_ptr<Segment const>> inputs;
+    std::uint64_t id;
+    Tombstones tombstones;
+    std::uint32_t floor;
+    {
+        std::lock_guard lock(mutex_);
+
+        // A frozen memtable is newer than any segment and must be written
+        // first, so the merged segment can take the next ID.
+        if (frozen_ || segments_.empty())
+            return false;
+
+        if (all)
+        {
+            if (segments_.size() == 1 && tombstones_.empty() && floor_ == 0)
+                return false;
+            inputs = segments_;
+        }
+        else
+        {
+            // Take the newest segments while each older one is no bigger
+            // than a few times all those taken, so that every position is
+            // rewritten only a logarithmic number of times.
+            std::uint64_t total = segments_.back()->bytes();
+            std::size_t taken = 1;
+            for (auto it = segments_.rbegin() + 1; it != segments_.rend();
+                 ++it)
+            {
+                if ((*it)->bytes() > 4 * total)
+                    break;
+                total += (*it)->bytes();
+                ++taken;
+            }
+            if (taken < setup_.mergeWidth)
+                return false;
+            inputs.assign(segments_.end() - taken, segments_.end());
+        }
+
+        id = nextId_++;
+        tombstones = tombstones_;
+        floor = floor_;
+    }
+
+    auto const dead = [&](Position const& p, std::uint64_t source) {
+        if (p.ledgerSeq < floor)
+            return true;
+        auto it = tombstones.find(p.ledgerSeq);
+        return it != tombstones.end() && source < it->second;
+    };
+
+    auto const temp = dir_ / ("seg-" + std::to_string(id) + ".tmp");
+    {
+        SegmentWriter writer(temp, id);
+
+        // Accounts, merged across the inputs in order
+        std::vector<std::size_t> next(inputs.size(), 0);
+        std::vector<Position> positions;
+        while (true)
+        {
+            AccountID const* account = nullptr;
+            for (std::size_t i = 0; i < inputs.size(); ++i)
+            {
+                auto const& a = inputs[i]->accounts();
+                if (next[i] < a.size() &&
+                    (!account || a[next[i]].account < *account))
+                    account = &a[next[i]].account;
+            }
+            if (!account)
+                break;
+
+            AccountID const current = *account;
+            positions.clear();
+            for (std::size_t i = 0; i < inputs.size(); ++i)
+            {
+                auto const& a = inputs[i]->accounts();
+                if (next[i] == a.size() || a[next[i]].account != current)
+                    continue;
+                for (auto const& p : inputs[i]->positions(a[next[i]]))
+                {
+                    if (!dead(p, inputs[i]->id()))
+                        positions.push_back(p);
+                }
+                ++next[i];
+            }
+            std::sort(positions.begin(), positions.end());
+            positions.erase(
+                std::unique(positions.begin(), positions.end()),
+                positions.end());
+            if (!positions.empty())
+                writer.add(current, positions);
+        }
+
+        // IDs, read in runs from each input. Where inputs disagree, the
+        // newest wins.
+        struct Run
+        {
+            std::uint64_t next = 0;
+            std::vector<Segment::IdEntry> entries;
+            std::size_t index = 0;
+        };
+        std::vector<Run> runs(inputs.size());
+        auto const refill = [&](std::size_t i) {
+            auto& run = runs[i];
+            if (run.index < run.entries.size())
+                return;
+            inputs[i]->readIds(run.next, 4096, run.entries);
+            run.next += run.entries.size();
+            run.index = 0;
+        };
+        for (std::size_t i = 0; i < inputs.size(); ++i)
+            refill(i);
+
+        while (true)
+        {
+            std::optional<std::size_t> pick;
+            for (std::size_t i = 0; i < inputs.size(); ++i)
+            {
+                auto const& run = runs[i];
+                if (run.index == run.entries.size())
+                    continue;
+                // Later inputs are newer and win ties
+                if (!pick ||
+                    run.entries[run.index].id <=
+                        runs[*pick].entries[runs[*pick].index].id)
+                    pick = i;
+            }
+            if (!pick)
+                break;
+
+            auto const entry = runs[*pick].entries[runs[*pick].index];
+            for (std::size_t i = 0; i < inputs.size(); ++i)
+            {
+                auto& run = runs[i];
+                if (run.index < run.entries.size() &&
+                    run.entries[run.index].id == entry.id)
+                {
+                    ++run.index;
+                    refill(i);
+                }
+            }
+            if (!dead(entry.position, inputs[*pick]->id()))
+                writer.addId(entry.id, entry.position);
+        }
+
+        writer.finish();
+    }
+    boost::filesystem::rename(temp, segmentPath(dir_, id));
+    auto merged = std::make_shared<Segment const>(dir_, id);
+
+    {
+        std::lock_guard writing(write_);
+        std::string contents;
+        {
+            std::lock_guard lock(mutex_);
+            auto const first =
+                std::find(segments_.begin(), segments_.end(), inputs.front());
+            assert(first + inputs.size() == segments_.end());
+            segments_.erase(first, first + inputs.size());
+            segments_.push_back(std::move(merged));
+            retireTombstones(lock);
+            contents = manifest(lock);
+        }
+        writeManifest(contents, writing);
+    }
+
+    // Readers may still hold the inputs open, which is fine
+    for (auto const& input : inputs)
+        boost::filesystem::remove(segmentPath(dir_, input->id()));
+
+    JLOG(j_.debug()) << "txindex: merged " << inputs.size()
+                     << " segments into " << id;
+    return true;
+}
+
+void
+TxIndex::run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || frozen_; });
+            if (stop_)
+                return;
+        }
+
+        try
+        {
+            std::lock_guard maintenance(maintenance_);
+            writeFrozen();
+            while (mergeSome(false))
+                ;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.fatal()) << "txindex: unable to write segment: "
+                             << e.what();
+
+            // Try again later rather than spin
+            std::unique_lock lock(mutex_);
+            wake_.wait_for(
+                lock, std::chrono::seconds(10), [this] { return stop_; });
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace ripple
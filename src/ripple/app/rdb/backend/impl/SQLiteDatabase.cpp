@@ -24,6 +24,7 @@
 #include <ripple/app/misc/Manifest.h>
 #include <ripple/app/misc/impl/AccountTxPaging.h>
 #include <ripple/app/rdb/backend/SQLiteDatabase.h>
+#include <ripple/app/rdb/backend/detail/LedgerWriter.h>
 #include <ripple/app/rdb/backend/detail/Node.h>
 #include <ripple/app/rdb/backend/detail/Shard.h>
 #include <ripple/basics/BasicConfig.h>
@@ -46,6 +47,12 @@ public:
         : app_(app)
         , useTxTables_(config.useTxTables())
         , j_(app_.journal("SQLiteDatabaseImp"))
+        , writer_(
+              detail::LedgerWriter::Setup{},
+              [this](detail::LedgerWriter::AcceptedLedgers const& aLedgers) {
+                  writeValidatedLedgers(aLedgers);
+              },
+              j_)
     {
         DatabaseCon::Setup const setup = setup_DatabaseCon(config, j_);
         if (!makeLedgerDBs(
@@ -107,10 +114,17 @@ public:
     RelationalDatabase::CountMinMax
     getLedgerCountMinMax() override;
 
-    bool
+    void
     saveValidatedLedger(
         std::shared_ptr<Ledger const> const& ledger,
-        bool current) override;
+        bool current,
+        std::function<void(bool)> onSaved) override;
+
+    Json::Value
+    getLedgerWriteInfo() const override;
+
+    void
+    stop() override;
 
     std::optional<LedgerInfo>
     getLedgerInfoByIndex(LedgerIndex ledgerSeq) override;
@@ -197,6 +211,29 @@ private:
     std::unique_ptr<DatabaseCon> lgrdb_, txdb_;
     std::unique_ptr<DatabaseCon> lgrMetaDB_, txMetaDB_;
 
+    // Declared last so that it stops, writing the ledgers still waiting,
+    // before the databases close.
+    detail::LedgerWriter writer_;
+
+    /**
+     * @brief writeValidatedLedgers Writes a group of prepared ledgers into
+     *        the node store ledger and transaction databases.
+     * @param aLedgers The ledgers.
+     */
+    void
+    writeValidatedLedgers(
+        std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers);
+
+    /**
+     * @brief saveLedgerMeta Saves the shard index lookup entries of a
+     *        ledger, if the shard store should accept the ledger.
+     * @param ledger The ledger.
+     * @return False if the shard store should accept the ledger but
+     *         saving the entries failed.
+     */
+    bool
+    saveLedgerMeta(std::shared_ptr<Ledger const> const& ledger);
+
     /**
      * @brief makeLedgerDBs Opens ledger and transaction databases for the node
      *        store, and stores their descriptors in private member variables.
@@ -759,40 +796,88 @@ SQLiteDatabaseImp::getLedgerCountMinMax()
     return {0, 0, 0};
 }
 
-bool
+void
 SQLiteDatabaseImp::saveValidatedLedger(
     std::shared_ptr<Ledger const> const& ledger,
-    bool current)
+    bool current,
+    std::function<void(bool)> onSaved)
 {
-    if (existsLedger())
+    bool const savedMeta = saveLedgerMeta(ledger);
+
+    if (!existsLedger())
     {
-        if (!detail::saveValidatedLedger(
-                *lgrdb_, *txdb_, app_, ledger, current))
-            return false;
+        onSaved(savedMeta);
+        return;
     }
 
-    if (auto shardStore = app_.getShardStore(); shardStore)
+    auto aLedger = detail::prepareValidatedLedger(app_, ledger, current);
+    if (!aLedger)
     {
-        if (ledger->info().seq < shardStore->earliestLedgerSeq())
-            // For the moment return false only when the ShardStore
-            // should accept the ledger, but fails when attempting
-            // to do so, i.e. when saveLedgerMeta fails. Later when
-            // the ShardStore supercedes the NodeStore, change this
-            // line to return false if the ledger is too early.
-            return true;
+        onSaved(false);
+        return;
+    }
 
-        auto lgrMetaSession = lgrMetaDB_->checkoutDb();
-        auto txMetaSession = txMetaDB_->checkoutDb();
+    writer_.save(
+        std::move(aLedger),
+        [this,
+         seq = ledger->info().seq,
+         hash = ledger->info().hash,
+         savedMeta,
+         onSaved = std::move(onSaved)](bool saved) {
+            if (!saved)
+                app_.getLedgerMaster().failedSave(seq, hash);
+            onSaved(saved && savedMeta);
+        });
+}
 
-        return detail::saveLedgerMeta(
-            ledger,
-            app_,
-            *lgrMetaSession,
-            *txMetaSession,
-            shardStore->seqToShardIndex(ledger->info().seq));
-    }
+Json::Value
+SQLiteDatabaseImp::getLedgerWriteInfo() const
+{
+    return writer_.getInfo();
+}
 
-    return true;
+void
+SQLiteDatabaseImp::stop()
+{
+    writer_.stop();
+}
+
+void
+SQLiteDatabaseImp::writeValidatedLedgers(
+    std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers)
+{
+    auto const saveTransactions =
+        [this](std::vector<std::shared_ptr<AcceptedLedger const>> const&
+                   aLedgers) {
+            detail::saveTransactions(*txdb_, app_, aLedgers);
+        };
+    detail::saveValidatedLedgers(*lgrdb_, saveTransactions, app_, aLedgers);
+}
+
+bool
+SQLiteDatabaseImp::saveLedgerMeta(std::shared_ptr<Ledger const> const& ledger)
+{
+    auto shardStore = app_.getShardStore();
+    if (!shardStore)
+        return true;
+
+    if (ledger->info().seq < shardStore->earliestLedgerSeq())
+        // For the moment return false only when the ShardStore
+        // should accept the ledger, but fails when attempting
+        // to do so, i.e. when saveLedgerMeta fails. Later when
+        // the ShardStore supercedes the NodeStore, change this
+        // line to return false if the ledger is too early.
+        return true;
+
+    auto lgrMetaSession = lgrMetaDB_->checkoutDb();
+    auto txMetaSession = txMetaDB_->checkoutDb();
+
+    return detail::saveLedgerMeta(
+        ledger,
+        app_,
+        *lgrMetaSession,
+        *txMetaSession,
+        shardStore->seqToShardIndex(ledger->info().seq));
 }
 
 std::optional<LedgerInfo>
@@ -1723,12 +1808,14 @@ SQLiteDatabaseImp::getKBUsedTransaction()
 void
 SQLiteDatabaseImp::closeLedgerDB()
 {
+    writer_.stop();
     lgrdb_.reset();
 }
 
 void
 SQLiteDatabaseImp::closeTransactionDB()
 {
+    writer_.stop();
     txdb_.reset();
 }
 
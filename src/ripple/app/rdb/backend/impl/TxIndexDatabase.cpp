@@ -0,0 +1,1027 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/DBInit.h>
+#include <ripple/app/misc/impl/AccountTxPaging.h>
+#include <ripple/app/rdb/backend/SQLiteDatabase.h>
+#include <ripple/app/rdb/backend/detail/LedgerWriter.h>
+#include <ripple/app/rdb/backend/detail/Node.h>
+#include <ripple/app/rdb/backend/detail/TxIndex.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/core/SociDB.h>
+#include <ripple/protocol/STTx.h>
+#include <soci/sqlite3/soci-sqlite3.h>
+
+namespace ripple {
+
+/*  A relational database which keeps ledger headers in SQLite, like the
+    default backend, and transactions in a TxIndex, which is much smaller
+    and faster than the SQLite transaction tables for a server with a long
+    history. It implements the same interface as the default backend, so
+    the rest of the server cannot tell the difference.
+*/
+class TxIndexDatabaseImp final : public SQLiteDatabase
+{
+public:
+    TxIndexDatabaseImp(
+        Application& app,
+        Config const& config,
+        JobQueue& jobQueue)
+        : app_(app)
+        , useTxTables_(config.useTxTables())
+        , j_(app_.journal("TxIndexDatabaseImp"))
+        , writer_(
+              detail::LedgerWriter::Setup{},
+              [this](detail::LedgerWriter::AcceptedLedgers const& aLedgers) {
+                  writeValidatedLedgers(aLedgers);
+              },
+              j_)
+    {
+        if (app.getShardStore())
+        {
+            std::string_view constexpr error =
+                "The txindex relational database does not support shards";
+
+            JLOG(j_.fatal()) << error;
+            Throw<std::runtime_error>(error.data());
+        }
+
+        DatabaseCon::Setup const setup = setup_DatabaseCon(config, j_);
+        lgrdb_ = std::make_unique<DatabaseCon>(
+            setup,
+            LgrDBName,
+            LgrDBPragma,
+            LgrDBInit,
+            DatabaseCon::CheckpointerSetup{&jobQueue, &app_.logs()});
+        lgrdb_->getSession() << boost::str(
+            boost::format("PRAGMA cache_size=-%d;") %
+            kilobytes(config.getValueFor(SizedItem::lgrDBCache)));
+
+        if (useTxTables_)
+            txIndex_ = std::make_unique<detail::TxIndex>(
+                setup.dataDir / "txindex",
+                detail::TxIndex::Setup{},
+                app_.journal("TxIndex"));
+    }
+
+    std::optional<LedgerIndex>
+    getMinLedgerSeq() override;
+
+    std::optional<LedgerIndex>
+    getTransactionsMinLedgerSeq() override;
+
+    std::optional<LedgerIndex>
+    getAccountTransactionsMinLedgerSeq() override;
+
+    std::optional<LedgerIndex>
+    getMaxLedgerSeq() override;
+
+    void
+    deleteTransactionByLedgerSeq(LedgerIndex ledgerSeq) override;
+
+    void
+    deleteBeforeLedgerSeq(LedgerIndex ledgerSeq) override;
+
+    void
+    deleteTransactionsBeforeLedgerSeq(LedgerIndex ledgerSeq) override;
+
+    void
+    deleteAccountTransactionsBeforeLedgerSeq(LedgerIndex ledgerSeq) override;
+
+    std::size_t
+    getTransactionCount() override;
+
+    std::size_t
+    getAccountTransactionCount() override;
+
+    RelationalDatabase::CountMinMax
+    getLedgerCountMinMax() override;
+
+    void
+    saveValidatedLedger(
+        std::shared_ptr<Ledger const> const& ledger,
+        bool current,
+        std::function<void(bool)> onSaved) override;
+
+    Json::Value
+    getLedgerWriteInfo() const override;
+
+    void
+    stop() override;
+
+    std::optional<LedgerInfo>
+    getLedgerInfoByIndex(LedgerIndex ledgerSeq) override;
+
+    std::optional<LedgerInfo>
+    getNewestLedgerInfo() override;
+
+    std::optional<LedgerInfo>
+    getLimitedOldestLedgerInfo(LedgerIndex ledgerFirstIndex) override;
+
+    std::optional<LedgerInfo>
+    getLimitedNewestLedgerInfo(LedgerIndex ledgerFirstIndex) override;
+
+    std::optional<LedgerInfo>
+    getLedgerInfoByHash(uint256 const& ledgerHash) override;
+
+    uint256
+    getHashByIndex(LedgerIndex ledgerIndex) override;
+
+    std::optional<LedgerHashPair>
+    getHashesByIndex(LedgerIndex ledgerIndex) override;
+
+    std::map<LedgerIndex, LedgerHashPair>
+    getHashesByIndex(LedgerIndex minSeq, LedgerIndex maxSeq) override;
+
+    std::vector<std::shared_ptr<Transaction>>
+    getTxHistory(LedgerIndex startIndex) override;
+
+    AccountTxs
+    getOldestAccountTxs(AccountTxOptions const& options) override;
+
+    AccountTxs
+    getNewestAccountTxs(AccountTxOptions const& options) override;
+
+    MetaTxsList
+    getOldestAccountTxsB(AccountTxOptions const& options) override;
+
+    MetaTxsList
+    getNewestAccountTxsB(AccountTxOptions const& options) override;
+
+    std::pair<AccountTxs, std::optional<AccountTxMarker>>
+    oldestAccountTxPage(AccountTxPageOptions const& options) override;
+
+    std::pair<AccountTxs, std::optional<AccountTxMarker>>
+    newestAccountTxPage(AccountTxPageOptions const& options) override;
+
+    std::pair<MetaTxsList, std::optional<AccountTxMarker>>
+    oldestAccountTxPageB(AccountTxPageOptions const& options) override;
+
+    std::pair<MetaTxsList, std::optional<AccountTxMarker>>
+    newestAccountTxPageB(AccountTxPageOptions const& options) override;
+
+    std::variant<AccountTx, TxSearched>
+    getTransaction(
+        uint256 const& id,
+        std::optional<ClosedInterval<std::uint32_t>> const& range,
+        error_code_i& ec) override;
+
+    bool
+    ledgerDbHasSpace(Config const& config) override;
+
+    bool
+    transactionDbHasSpace(Config const& config) override;
+
+    std::uint32_t
+    getKBUsedAll() override;
+
+    std::uint32_t
+    getKBUsedLedger() override;
+
+    std::uint32_t
+    getKBUsedTransaction() override;
+
+    void
+    closeLedgerDB() override;
+
+    void
+    closeTransactionDB() override;
+
+private:
+    Application& app_;
+    bool const useTxTables_;
+    beast::Journal j_;
+    std::unique_ptr<DatabaseCon> lgrdb_;
+    std::unique_ptr<detail::TxIndex> txIndex_;
+
+    // Declared last so that it stops, writing the ledgers still waiting,
+    // before the databases close.
+    detail::LedgerWriter writer_;
+
+    using OnTransaction = std::function<
+        void(std::uint32_t, std::string const&, Blob&&, Blob&&)>;
+
+    /**
+     * @brief existsTransaction Checks if the transaction index is open.
+     * @return True if the transaction index is open.
+     */
+    bool
+    existsTransaction()
+    {
+        return static_cast<bool>(txIndex_);
+    }
+
+    /**
+     * @brief saveTransactions Saves the transactions of a ledger into the
+     *        index, replacing any saved before.
+     * @param aLedger The transactions of the ledger.
+     */
+    void
+    saveTransactions(AcceptedLedger const& aLedger);
+
+    /**
+     * @brief writeValidatedLedgers Writes a group of prepared ledgers into
+     *        the ledger database and the index.
+     * @param aLedgers The ledgers.
+     */
+    void
+    writeValidatedLedgers(
+        std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers);
+
+    /**
+     * @brief accountTxs Calls the callback for the oldest or newest
+     *        transactions of an account, in the ledger range and after the
+     *        offset given by the options, and as many as the options allow,
+     *        like detail::getOldestAccountTxs.
+     * @param options Criteria to match.
+     * @param descending True for newest first, false for oldest first.
+     * @param binary True if the result is binary, which allows more
+     *        transactions.
+     * @param onTransaction Callback function to call on each transaction.
+     */
+    void
+    accountTxs(
+        AccountTxOptions const& options,
+        bool descending,
+        bool binary,
+        OnTransaction const& onTransaction);
+
+    /**
+     * @brief accountTxPage Calls the callback for a page of transactions of
+     *        an account, starting from the marker given by the options, like
+     *        detail::oldestAccountTxPage.
+     * @param options Criteria to match.
+     * @param page_length Number of transactions to return, if the options
+     *        do not say otherwise.
+     * @param forward True for oldest first, false for newest first.
+     * @param onTransaction Callback function to call on each transaction.
+     * @return Marker for the next page, if there is one.
+     */
+    std::optional<AccountTxMarker>
+    accountTxPage(
+        AccountTxPageOptions const& options,
+        std::uint32_t page_length,
+        bool forward,
+        OnTransaction const& onTransaction);
+
+    /**
+     * @brief hasSpace Checks that the disk holding the databases has room.
+     * @param config Config object.
+     * @return True if at least 512MB are free.
+     */
+    bool
+    hasSpace(Config const& config);
+};
+
+void
+TxIndexDatabaseImp::saveTransactions(AcceptedLedger const& aLedger)
+{
+    std::vector<detail::TxIndex::Tx> txs;
+    txs.reserve(aLedger.size());
+    for (auto const& acceptedLedgerTx : aLedger)
+    {
+        Serializer s;
+        acceptedLedgerTx->getTxn()->add(s);
+
+        auto& tx = txs.emplace_back();
+        tx.id = acceptedLedgerTx->getTransactionID();
+        tx.txnSeq = acceptedLedgerTx->getTxnSeq();
+        tx.status = txnSqlValidated;
+        tx.txn = std::move(s.modData());
+        tx.meta = acceptedLedgerTx->getRawMeta();
+        tx.accounts = acceptedLedgerTx->getAffected();
+
+        if (tx.accounts.empty() && !isPseudoTx(*acceptedLedgerTx->getTxn()))
+        {
+            // It's okay for pseudo transactions to not affect any
+            // accounts.  But otherwise...
+            JLOG(j_.warn()) << "Transaction in ledger "
+                            << aLedger.getLedger()->info().seq
+                            << " affects no accounts";
+        }
+    }
+
+    txIndex_->saveLedger(aLedger.getLedger()->info().seq, txs);
+}
+
+void
+TxIndexDatabaseImp::accountTxs(
+    AccountTxOptions const& options,
+    bool descending,
+    bool binary,
+    OnTransaction const& onTransaction)
+{
+    constexpr std::uint32_t NONBINARY_PAGE_LENGTH = 200;
+    constexpr std::uint32_t BINARY_PAGE_LENGTH = 500;
+
+    std::uint32_t numberOfResults;
+    if (options.limit == UINT32_MAX)
+        numberOfResults = binary ? BINARY_PAGE_LENGTH : NONBINARY_PAGE_LENGTH;
+    else if (!options.bUnlimited)
+        numberOfResults = std::min(
+            binary ? BINARY_PAGE_LENGTH : NONBINARY_PAGE_LENGTH, options.limit);
+    else
+        numberOfResults = options.limit;
+
+    if (numberOfResults == 0)
+        return;
+
+    std::uint32_t skip = options.offset;
+    txIndex_->forEach(
+        options.account,
+        options.minLedger,
+        options.maxLedger ? options.maxLedger : UINT32_MAX,
+        !descending,
+        std::nullopt,
+        [&](detail::TxIndex::Position const& position) {
+            if (skip > 0)
+            {
+                --skip;
+                return true;
+            }
+
+            auto record = txIndex_->fetch(position);
+            if (!record)
+                return true;
+
+            onTransaction(
+                position.ledgerSeq,
+                std::string(1, record->status),
+                std::move(record->txn),
+                std::move(record->meta));
+            return --numberOfResults > 0;
+        });
+}
+
+std::optional<RelationalDatabase::AccountTxMarker>
+TxIndexDatabaseImp::accountTxPage(
+    AccountTxPageOptions const& options,
+    std::uint32_t page_length,
+    bool forward,
+    OnTransaction const& onTransaction)
+{
+    auto onUnsavedLedger =
+        std::bind(saveLedgerAsync, std::ref(app_), std::placeholders::_1);
+
+    std::uint32_t numberOfResults;
+    if (options.limit == 0 || options.limit == UINT32_MAX ||
+        (options.limit > page_length && !options.bAdmin))
+        numberOfResults = page_length;
+    else
+        numberOfResults = options.limit;
+
+    std::optional<detail::TxIndex::Position> from;
+    if (options.marker)
+        from = {options.marker->ledgerSeq, options.marker->txnSeq};
+
+    // A page starts at its marker. If the marker is not there, neither is
+    // the page.
+    bool lookingForMarker = from.has_value();
+    std::optional<AccountTxMarker> newmarker;
+    txIndex_->forEach(
+        options.account,
+        options.minLedger,
+        options.maxLedger,
+        forward,
+        from,
+        [&](detail::TxIndex::Position const& position) {
+            if (lookingForMarker)
+            {
+                if (position != *from)
+                    return false;
+                lookingForMarker = false;
+            }
+            else if (numberOfResults == 0)
+            {
+                newmarker = {position.ledgerSeq, position.txnSeq};
+                return false;
+            }
+
+            auto record = txIndex_->fetch(position);
+            if (!record)
+                return true;
+
+            // Work around a bug that could leave the metadata missing
+            if (record->meta.empty())
+                onUnsavedLedger(position.ledgerSeq);
+
+            onTransaction(
+                position.ledgerSeq,
+                std::string(1, record->status),
+                std::move(record->txn),
+                std::move(record->meta));
+            --numberOfResults;
+            return true;
+        });
+
+    return newmarker;
+}
+
+bool
+TxIndexDatabaseImp::hasSpace(Config const& config)
+{
+    boost::filesystem::space_info space =
+        boost::filesystem::space(config.legacy("database_path"));
+
+    if (space.available < megabytes(512))
+    {
+        JLOG(j_.fatal()) << "Remaining free disk space is less than 512MB";
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<LedgerIndex>
+TxIndexDatabaseImp::getMinLedgerSeq()
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getMinLedgerSeq(*db, detail::TableType::Ledgers);
+}
+
+std::optional<LedgerIndex>
+TxIndexDatabaseImp::getTransactionsMinLedgerSeq()
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    return txIndex_->minLedger();
+}
+
+std::optional<LedgerIndex>
+TxIndexDatabaseImp::getAccountTransactionsMinLedgerSeq()
+{
+    // Transactions and their accounts are saved and deleted together
+    return getTransactionsMinLedgerSeq();
+}
+
+std::optional<LedgerIndex>
+TxIndexDatabaseImp::getMaxLedgerSeq()
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getMaxLedgerSeq(*db, detail::TableType::Ledgers);
+}
+
+void
+TxIndexDatabaseImp::deleteTransactionByLedgerSeq(LedgerIndex ledgerSeq)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return;
+
+    txIndex_->deleteLedger(ledgerSeq);
+}
+
+void
+TxIndexDatabaseImp::deleteBeforeLedgerSeq(LedgerIndex ledgerSeq)
+{
+    if (!lgrdb_)
+        return;
+
+    auto db = lgrdb_->checkoutDb();
+    detail::deleteBeforeLedgerSeq(*db, detail::TableType::Ledgers, ledgerSeq);
+}
+
+void
+TxIndexDatabaseImp::deleteTransactionsBeforeLedgerSeq(LedgerIndex ledgerSeq)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return;
+
+    txIndex_->deleteBefore(ledgerSeq);
+}
+
+void
+TxIndexDatabaseImp::deleteAccountTransactionsBeforeLedgerSeq(
+    LedgerIndex ledgerSeq)
+{
+    // Deleting a transaction deletes its accounts too
+    deleteTransactionsBeforeLedgerSeq(ledgerSeq);
+}
+
+std::size_t
+TxIndexDatabaseImp::getTransactionCount()
+{
+    if (!useTxTables_ || !existsTransaction())
+        return 0;
+
+    return txIndex_->transactionCount();
+}
+
+std::size_t
+TxIndexDatabaseImp::getAccountTransactionCount()
+{
+    if (!useTxTables_ || !existsTransaction())
+        return 0;
+
+    return txIndex_->positionCount();
+}
+
+RelationalDatabase::CountMinMax
+TxIndexDatabaseImp::getLedgerCountMinMax()
+{
+    if (!lgrdb_)
+        return {0, 0, 0};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getRowsMinMax(*db, detail::TableType::Ledgers);
+}
+
+void
+TxIndexDatabaseImp::saveValidatedLedger(
+    std::shared_ptr<Ledger const> const& ledger,
+    bool current,
+    std::function<void(bool)> onSaved)
+{
+    if (!lgrdb_)
+    {
+        onSaved(true);
+        return;
+    }
+
+    auto aLedger = detail::prepareValidatedLedger(app_, ledger, current);
+    if (!aLedger)
+    {
+        onSaved(false);
+        return;
+    }
+
+    writer_.save(
+        std::move(aLedger),
+        [this,
+         seq = ledger->info().seq,
+         hash = ledger->info().hash,
+         onSaved = std::move(onSaved)](bool saved) {
+            if (!saved)
+                app_.getLedgerMaster().failedSave(seq, hash);
+            onSaved(saved);
+        });
+}
+
+Json::Value
+TxIndexDatabaseImp::getLedgerWriteInfo() const
+{
+    return writer_.getInfo();
+}
+
+void
+TxIndexDatabaseImp::stop()
+{
+    writer_.stop();
+}
+
+void
+TxIndexDatabaseImp::writeValidatedLedgers(
+    std::vector<std::shared_ptr<AcceptedLedger const>> const& aLedgers)
+{
+    auto const saveTransactions =
+        [this](std::vector<std::shared_ptr<AcceptedLedger const>> const&
+                   aLedgers) {
+            if (!existsTransaction())
+                return;
+
+            for (auto const& aLedger : aLedgers)
+                this->saveTransactions(*aLedger);
+        };
+    detail::saveValidatedLedgers(*lgrdb_, saveTransactions, app_, aLedgers);
+}
+
+std::optional<LedgerInfo>
+TxIndexDatabaseImp::getLedgerInfoByIndex(LedgerIndex ledgerSeq)
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getLedgerInfoByIndex(*db, ledgerSeq, j_);
+}
+
+std::optional<LedgerInfo>
+TxIndexDatabaseImp::getNewestLedgerInfo()
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getNewestLedgerInfo(*db, j_);
+}
+
+std::optional<LedgerInfo>
+TxIndexDatabaseImp::getLimitedOldestLedgerInfo(LedgerIndex ledgerFirstIndex)
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getLimitedOldestLedgerInfo(*db, ledgerFirstIndex, j_);
+}
+
+std::optional<LedgerInfo>
+TxIndexDatabaseImp::getLimitedNewestLedgerInfo(LedgerIndex ledgerFirstIndex)
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getLimitedNewestLedgerInfo(*db, ledgerFirstIndex, j_);
+}
+
+std::optional<LedgerInfo>
+TxIndexDatabaseImp::getLedgerInfoByHash(uint256 const& ledgerHash)
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getLedgerInfoByHash(*db, ledgerHash, j_);
+}
+
+uint256
+TxIndexDatabaseImp::getHashByIndex(LedgerIndex ledgerIndex)
+{
+    if (!lgrdb_)
+        return uint256();
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getHashByIndex(*db, ledgerIndex);
+}
+
+std::optional<LedgerHashPair>
+TxIndexDatabaseImp::getHashesByIndex(LedgerIndex ledgerIndex)
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getHashesByIndex(*db, ledgerIndex, j_);
+}
+
+std::map<LedgerIndex, LedgerHashPair>
+TxIndexDatabaseImp::getHashesByIndex(LedgerIndex minSeq, LedgerIndex maxSeq)
+{
+    if (!lgrdb_)
+        return {};
+
+    auto db = lgrdb_->checkoutDb();
+    return detail::getHashesByIndex(*db, minSeq, maxSeq, j_);
+}
+
+std::vector<std::shared_ptr<Transaction>>
+TxIndexDatabaseImp::getTxHistory(LedgerIndex startIndex)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    auto const minLedger = txIndex_->minLedger();
+    auto const maxLedger = txIndex_->maxLedger();
+    if (!minLedger)
+        return {};
+
+    // The 20 transactions after the first startIndex, newest ledger first
+    std::vector<std::shared_ptr<Transaction>> txs;
+    std::uint32_t skip = startIndex;
+    for (std::uint32_t seq = *maxLedger; seq >= *minLedger && txs.size() < 20;
+         --seq)
+    {
+        auto const count = txIndex_->transactionsIn(seq).value_or(0);
+        if (skip >= count)
+        {
+            skip -= count;
+            continue;
+        }
+
+        auto const records = txIndex_->fetchLedger(seq);
+        for (auto it = records.rbegin() + skip;
+             it != records.rend() && txs.size() < 20;
+             ++it)
+        {
+            if (auto trans = Transaction::transactionFromSQL(
+                    boost::optional<std::uint64_t>(seq),
+                    boost::optional<std::string>(std::string(1, it->status)),
+                    it->txn,
+                    app_))
+                txs.push_back(trans);
+        }
+        skip = 0;
+
+        if (seq == 0)
+            break;
+    }
+
+    return txs;
+}
+
+RelationalDatabase::AccountTxs
+TxIndexDatabaseImp::getOldestAccountTxs(AccountTxOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    AccountTxs ret;
+    Application& app = app_;
+    accountTxs(
+        options,
+        false,
+        false,
+        [&ret, &app](
+            std::uint32_t ledger_index,
+            std::string const& status,
+            Blob&& rawTxn,
+            Blob&& rawMeta) {
+            convertBlobsToTxResult(
+                ret, ledger_index, status, rawTxn, rawMeta, app);
+        });
+    return ret;
+}
+
+RelationalDatabase::AccountTxs
+TxIndexDatabaseImp::getNewestAccountTxs(AccountTxOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    AccountTxs ret;
+    Application& app = app_;
+    accountTxs(
+        options,
+        true,
+        false,
+        [&ret, &app](
+            std::uint32_t ledger_index,
+            std::string const& status,
+            Blob&& rawTxn,
+            Blob&& rawMeta) {
+            convertBlobsToTxResult(
+                ret, ledger_index, status, rawTxn, rawMeta, app);
+        });
+    return ret;
+}
+
+RelationalDatabase::MetaTxsList
+TxIndexDatabaseImp::getOldestAccountTxsB(AccountTxOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    MetaTxsList ret;
+    accountTxs(
+        options,
+        false,
+        true,
+        [&ret](
+            std::uint32_t ledgerIndex,
+            std::string const& status,
+            Blob&& rawTxn,
+            Blob&& rawMeta) {
+            ret.emplace_back(
+                std::move(rawTxn), std::move(rawMeta), ledgerIndex);
+        });
+    return ret;
+}
+
+RelationalDatabase::MetaTxsList
+TxIndexDatabaseImp::getNewestAccountTxsB(AccountTxOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    MetaTxsList ret;
+    accountTxs(
+        options,
+        true,
+        true,
+        [&ret](
+            std::uint32_t ledgerIndex,
+            std::string const& status,
+            Blob&& rawTxn,
+            Blob&& rawMeta) {
+            ret.emplace_back(
+                std::move(rawTxn), std::move(rawMeta), ledgerIndex);
+        });
+    return ret;
+}
+
+std::pair<
+    RelationalDatabase::AccountTxs,
+    std::optional<RelationalDatabase::AccountTxMarker>>
+TxIndexDatabaseImp::oldestAccountTxPage(AccountTxPageOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    static std::uint32_t const page_length(200);
+    AccountTxs ret;
+    Application& app = app_;
+    auto onTransaction = [&ret, &app](
+                             std::uint32_t ledger_index,
+                             std::string const& status,
+                             Blob&& rawTxn,
+                             Blob&& rawMeta) {
+        convertBlobsToTxResult(ret, ledger_index, status, rawTxn, rawMeta, app);
+    };
+
+    auto newmarker = accountTxPage(options, page_length, true, onTransaction);
+    return {ret, newmarker};
+}
+
+std::pair<
+    RelationalDatabase::AccountTxs,
+    std::optional<RelationalDatabase::AccountTxMarker>>
+TxIndexDatabaseImp::newestAccountTxPage(AccountTxPageOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    static std::uint32_t const page_length(200);
+    AccountTxs ret;
+    Application& app = app_;
+    auto onTransaction = [&ret, &app](
+                             std::uint32_t ledger_index,
+                             std::string const& status,
+                             Blob&& rawTxn,
+                             Blob&& rawMeta) {
+        convertBlobsToTxResult(ret, ledger_index, status, rawTxn, rawMeta, app);
+    };
+
+    auto newmarker = accountTxPage(options, page_length, false, onTransaction);
+    return {ret, newmarker};
+}
+
+std::pair<
+    RelationalDatabase::MetaTxsList,
+    std::optional<RelationalDatabase::AccountTxMarker>>
+TxIndexDatabaseImp::oldestAccountTxPageB(AccountTxPageOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    static std::uint32_t const page_length(500);
+    MetaTxsList ret;
+    auto onTransaction = [&ret](
+                             std::uint32_t ledgerIndex,
+                             std::string const& status,
+                             Blob&& rawTxn,
+                             Blob&& rawMeta) {
+        ret.emplace_back(std::move(rawTxn), std::move(rawMeta), ledgerIndex);
+    };
+
+    auto newmarker = accountTxPage(options, page_length, true, onTransaction);
+    return {ret, newmarker};
+}
+
+std::pair<
+    RelationalDatabase::MetaTxsList,
+    std::optional<RelationalDatabase::AccountTxMarker>>
+TxIndexDatabaseImp::newestAccountTxPageB(AccountTxPageOptions const& options)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return {};
+
+    static std::uint32_t const page_length(500);
+    MetaTxsList ret;
+    auto onTransaction = [&ret](
+                             std::uint32_t ledgerIndex,
+                             std::string const& status,
+                             Blob&& rawTxn,
+                             Blob&& rawMeta) {
+        ret.emplace_back(std::move(rawTxn), std::move(rawMeta), ledgerIndex);
+    };
+
+    auto newmarker = accountTxPage(options, page_length, false, onTransaction);
+    return {ret, newmarker};
+}
+
+std::variant<RelationalDatabase::AccountTx, TxSearched>
+TxIndexDatabaseImp::getTransaction(
+    uint256 const& id,
+    std::optional<ClosedInterval<std::uint32_t>> const& range,
+    error_code_i& ec)
+{
+    if (!useTxTables_ || !existsTransaction())
+        return TxSearched::unknown;
+
+    auto const record = txIndex_->fetch(id);
+    if (!record)
+    {
+        if (!range)
+            return TxSearched::unknown;
+
+        return txIndex_->ledgersIn(range->first(), range->last()) ==
+                (range->last() - range->first() + 1)
+            ? TxSearched::all
+            : TxSearched::some;
+    }
+
+    try
+    {
+        auto const inLedger = record->position.ledgerSeq;
+        auto txn = Transaction::transactionFromSQL(
+            boost::optional<std::uint64_t>(inLedger),
+            boost::optional<std::string>(std::string(1, record->status)),
+            record->txn,
+            app_);
+        auto txMeta = std::make_shared<TxMeta>(id, inLedger, record->meta);
+
+        return std::pair{std::move(txn), std::move(txMeta)};
+    }
+    catch (std::exception& e)
+    {
+        JLOG(j_.warn())
+            << "Unable to deserialize transaction from the index. Error: "
+            << e.what();
+
+        ec = rpcDB_DESERIALIZATION;
+    }
+
+    return TxSearched::unknown;
+}
+
+bool
+TxIndexDatabaseImp::ledgerDbHasSpace(Config const& config)
+{
+    return hasSpace(config);
+}
+
+bool
+TxIndexDatabaseImp::transactionDbHasSpace(Config const& config)
+{
+    if (!useTxTables_)
+        return true;
+
+    return hasSpace(config);
+}
+
+std::uint32_t
+TxIndexDatabaseImp::getKBUsedAll()
+{
+    std::uint32_t kb = 0;
+    if (lgrdb_)
+        kb += ripple::getKBUsedAll(lgrdb_->getSession());
+    if (existsTransaction())
+        kb += txIndex_->memoryUsed() / 1024;
+    return kb;
+}
+
+std::uint32_t
+TxIndexDatabaseImp::getKBUsedLedger()
+{
+    if (!lgrdb_)
+        return 0;
+
+    return ripple::getKBUsedDB(lgrdb_->getSession());
+}
+
+std::uint32_t
+TxIndexDatabaseImp::getKBUsedTransaction()
+{
+    if (!useTxTables_ || !existsTransaction())
+        return 0;
+
+    return txIndex_->memoryUsed() / 1024;
+}
+
+void
+TxIndexDatabaseImp::closeLedgerDB()
+{
+    writer_.stop();
+    lgrdb_.reset();
+}
+
+void
+TxIndexDatabaseImp::closeTransactionDB()
+{
+    writer_.stop();
+    txIndex_.reset();
+}
+
+std::unique_ptr<RelationalDatabase>
+getTxIndexDatabase(Application& app, Config const& config, JobQueue& jobQueue)
+{
+    return std::make_unique<TxIndexDatabaseImp>(app, config, jobQueue);
+}
+
+}  // namespace ripple
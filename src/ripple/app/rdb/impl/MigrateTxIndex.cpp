@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/rdb/MigrateTxIndex.h>
+#include <ripple/app/rdb/RelationalDatabase.h>
+#include <ripple/app/rdb/backend/detail/TxIndex.h>
+#include <ripple/core/SociDB.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/TxMeta.h>
+#include <boost/optional.hpp>
+#include <soci/sqlite3/soci-sqlite3.h>
+
+namespace ripple {
+
+bool
+doMigrateTxIndex(DatabaseCon::Setup const& setup)
+{
+    boost::filesystem::path const dbPath = setup.dataDir / TxDBName;
+    if (!exists(dbPath))
+    {
+        std::cerr << "There is no transaction database at " << dbPath.string()
+                  << " to migrate.\n";
+        return false;
+    }
+
+    // An interrupted migration starts over, so ledgers need not be made
+    // durable one by one
+    detail::TxIndex::Setup indexSetup;
+    indexSetup.sync = false;
+    detail::TxIndex index(
+        setup.dataDir / "txindex",
+        indexSetup,
+        beast::Journal{beast::Journal::getNullSink()});
+    if (index.maxLedger())
+    {
+        std::cerr << "The transaction index already holds transactions.\n";
+        return false;
+    }
+
+    auto txnDB =
+        std::make_unique<DatabaseCon>(setup, TxDBName, TxDBPragma, TxDBInit);
+    auto& session = txnDB->getSession();
+
+    std::cout << "Migration beginning." << std::endl;
+
+    // SOCI requires boost::optional (not std::optional) as parameters.
+    boost::optional<std::uint64_t> ledgerSeq;
+    boost::optional<std::string> transID, status;
+    soci::blob sociRawTxnBlob(session), sociRawMetaBlob(session);
+    soci::indicator rti, tmi;
+
+    soci::statement st =
+        (session.prepare << "SELECT LedgerSeq, TransID, Status, RawTxn, "
+                            "TxnMeta FROM Transactions ORDER BY LedgerSeq;",
+         soci::into(ledgerSeq),
+         soci::into(transID),
+         soci::into(status),
+         soci::into(sociRawTxnBlob, rti),
+         soci::into(sociRawMetaBlob, tmi));
+
+    std::vector<detail::TxIndex::Tx> txs;
+    std::uint32_t current = 0;
+    std::uint64_t ledgers = 0, transactions = 0, skipped = 0;
+
+    auto const save = [&]() {
+        if (txs.empty())
+            return;
+        index.saveLedger(current, txs);
+        transactions += txs.size();
+        txs.clear();
+        if (++ledgers % 100000 == 0)
+            std::cout << "Migrated " << ledgers << " ledgers, up to "
+                      << current << std::endl;
+    };
+
+    st.execute();
+    while (st.fetch())
+    {
+        auto const seq = rangeCheckedCast<std::uint32_t>(ledgerSeq.value_or(0));
+        if (seq != current)
+        {
+            save();
+            current = seq;
+        }
+
+        uint256 id;
+        Blob rawTxn, rawMeta;
+        if (soci::i_ok == rti)
+            convert(sociRawTxnBlob, rawTxn);
+        if (soci::i_ok == tmi)
+            convert(sociRawMetaBlob, rawMeta);
+
+        // Without metadata there is no index in the ledger and no accounts
+        if (!transID || !id.parseHex(*transID) || rawTxn.empty() ||
+            rawMeta.empty())
+        {
+            ++skipped;
+            continue;
+        }
+
+        TxMeta const meta(id, seq, rawMeta);
+
+        auto& tx = txs.emplace_back();
+        tx.id = id;
+        tx.txnSeq = meta.getIndex();
+        tx.status = status && !status->empty() ? status->front()
+                                               : txnSqlValidated;
+        tx.txn = std::move(rawTxn);
+        tx.meta = std::move(rawMeta);
+        tx.accounts = meta.getAffectedAccounts();
+    }
+    save();
+
+    std::cout << "Compacting the index." << std::endl;
+    index.flush();
+    index.compact();
+
+    std::cout << "Migration finished. Ledgers: " << ledgers
+              << ", transactions: " << transactions
+              << ", skipped without metadata: " << skipped << std::endl;
+
+    return true;
+}
+
+}  // namespace ripple
@@ -27,6 +27,9 @@ namespace ripple {
 extern std::unique_ptr<RelationalDatabase>
 getSQLiteDatabase(Application& app, Config const& config, JobQueue& jobQueue);
 
+extern std::unique_ptr<RelationalDatabase>
+getTxIndexDatabase(Application& app, Config const& config, JobQueue& jobQueue);
+
 extern std::unique_ptr<RelationalDatabase>
 getPostgresDatabase(Application& app, Config const& config, JobQueue& jobQueue);
 
@@ -37,6 +40,7 @@ RelationalDatabase::init(
     JobQueue& jobQueue)
 {
     bool use_sqlite = false;
+    bool use_txindex = false;
     bool use_postgres = false;
 
     if (config.reporting())
@@ -52,6 +56,10 @@ RelationalDatabase::init(
             {
                 use_sqlite = true;
             }
+            else if (boost::iequals(get(rdb_section, "backend"), "txindex"))
+            {
+                use_txindex = true;
+            }
             else
             {
                 Throw<std::runtime_error>(
@@ -69,6 +77,10 @@ RelationalDatabase::init(
     {
         return getSQLiteDatabase(app, config, jobQueue);
     }
+    else if (use_txindex)
+    {
+        return getTxIndexDatabase(app, config, jobQueue);
+    }
     else if (use_postgres)
     {
         return getPostgresDatabase(app, config, jobQueue);
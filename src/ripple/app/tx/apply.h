@@ -31,6 +31,7 @@
 namespace ripple {
 
 class Application;
+class CanonicalTXSet;
 class HashRouter;
 
 /** Describes the pre-processing validity of a transaction.
@@ -67,6 +68,20 @@ checkValidity(
     Config const& config,
     ApplyFlags const flags = tapNONE);
 
+/** Checks the validity of a set of transactions.
+
+    The signatures not already known to be good or bad are checked on
+    several threads at once. Results are cached exactly as when calling
+    checkValidity on each transaction, so that applying the transactions
+    afterwards finds them.
+*/
+void
+checkValidity(
+    HashRouter& router,
+    CanonicalTXSet const& txns,
+    Rules const& rules,
+    Config const& config);
+
 /** Sets the validity of a given transaction in the cache.
 
     @warning Use with extreme care.
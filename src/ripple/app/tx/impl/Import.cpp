@@ -19,6 +19,7 @@
 
 #include <ripple/app/misc/Manifest.h>
 #include <ripple/app/tx/impl/Import.h>
+#include <ripple/app/tx/impl/ImportVLCache.h>
 #include <ripple/app/tx/impl/SetSignerList.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/base64.h>
@@ -40,6 +41,176 @@
 
 namespace ripple {
 
+namespace {
+
+// Verify the unl section of an XPOP: the publisher manifest, the signature
+// over the validator list and the manifest of every listed validator. The
+// validity window is not checked against the current time here.
+std::shared_ptr<VerifiedVL const>
+verifyVL(
+    Json::Value const& unl,
+    PublicKey const& masterVLKey,
+    uint256 const& txid,
+    beast::Journal j)
+{
+    // check it was used to sign over the manifest
+    auto const m =
+        deserializeManifest(base64_decode(unl[jss::manifest].asString()));
+
+    if (!m)
+    {
+        JLOG(j.warn()) << "Import: failed to deserialize manifest on txid "
+                       << txid;
+        return nullptr;
+    }
+
+    // we will check the master key matches a known one in preclaim, because the
+    // import vl key might be from the on-ledger object
+    if (m->masterKey != masterVLKey)
+    {
+        JLOG(j.warn()) << "Import: manifest master key did not match top "
+                          "level master key in unl section of xpop "
+                       << txid;
+        return nullptr;
+    }
+
+    if (!m->verify())
+    {
+        JLOG(j.warn()) << "Import: manifest signature invalid " << txid;
+        return nullptr;
+    }
+
+    // manifest signing (ephemeral) key
+    auto const signingKey = m->signingKey;
+
+    // decode blob
+    auto const data = base64_decode(unl[jss::blob].asString());
+
+    Json::Reader r;
+    Json::Value list;
+    if (!r.parse(data, list))
+    {
+        JLOG(j.warn())
+            << "Import: unl blob was not valid json (after base64 decoding) "
+            << txid;
+        return nullptr;
+    }
+
+    if (!list.isMember(jss::sequence) || !list[jss::sequence].isInt())
+    {
+        JLOG(j.warn()) << "Import: unl blob json (after base64 decoding) "
+                          "lacked required field (sequence) and/or types "
+                       << txid;
+        return nullptr;
+    }
+    if (!list.isMember(jss::expiration) || !list[jss::expiration].isInt())
+    {
+        JLOG(j.warn()) << "Import: unl blob json (after base64 decoding) "
+                          "lacked required field (expiration) and/or types "
+                       << txid;
+        return nullptr;
+    }
+    if (list.isMember(jss::effective) && !list[jss::effective].isInt())
+    {
+        JLOG(j.warn()) << "Import: unl blob json (after base64 decoding) "
+                          "lacked required field (effective) and/or types "
+                       << txid;
+        return nullptr;
+    }
+    if (!list.isMember(jss::validators) || !list[jss::validators].isArray())
+    {
+        JLOG(j.warn()) << "Import: unl blob json (after base64 decoding) "
+                          "lacked required field (validators) and/or types "
+                       << txid;
+        return nullptr;
+    }
+
+    auto vl = std::make_shared<VerifiedVL>();
+    vl->masterKey = m->masterKey;
+    vl->validFrom = TimeKeeper::time_point{TimeKeeper::duration{
+        list.isMember(jss::effective) ? list[jss::effective].asUInt() : 0}};
+    vl->validUntil = TimeKeeper::time_point{
+        TimeKeeper::duration{list[jss::expiration].asUInt()}};
+    if (vl->validUntil <= vl->validFrom)
+    {
+        JLOG(j.warn()) << "Import: unl blob validUntil <= validFrom " << txid;
+        return nullptr;
+    }
+
+    auto const sig = strUnHex(unl[jss::signature].asString());
+    if (!sig || !ripple::verify(signingKey, makeSlice(data), makeSlice(*sig)))
+    {
+        JLOG(j.warn()) << "Import: unl blob not signed correctly " << txid;
+        return nullptr;
+    }
+
+    // parse the validator list
+    for (auto const& val : list[jss::validators])
+    {
+        vl->totalValidatorCount++;
+
+        if (!val.isObject() || !val.isMember(jss::validation_public_key) ||
+            !val[jss::validation_public_key].isString() ||
+            !val.isMember(jss::manifest) || !val[jss::manifest].isString())
+        {
+            JLOG(j.warn()) << "Import: unl blob contained invalid "
+                              "validator entry, skipping "
+                           << txid;
+            continue;
+        }
+
+        std::optional<Blob> const ret =
+            strUnHex(val[jss::validation_public_key].asString());
+
+        if (!ret || !publicKeyType(makeSlice(*ret)))
+        {
+            JLOG(j.warn()) << "Import: unl blob contained an invalid "
+                              "validator key, skipping "
+                           << val[jss::validation_public_key].asString()
+                           << " " << txid;
+            continue;
+        }
+
+        auto const m =
+            deserializeManifest(base64_decode(val[jss::manifest].asString()));
+
+        if (!m)
+        {
+            JLOG(j.warn())
+                << "Import: unl blob contained an invalid manifest, skipping "
+                << txid;
+            continue;
+        }
+
+        if (strHex(m->masterKey) != val[jss::validation_public_key])
+        {
+            JLOG(j.warn()) << "Import: unl blob list entry manifest master "
+                              "key did not match master key, skipping "
+                           << txid;
+            continue;
+        }
+
+        if (!m->verify())
+        {
+            JLOG(j.warn()) << "Import: unl blob list entry manifest "
+                              "signature invalid, skipping "
+                           << txid;
+            continue;
+        }
+
+        std::string const nodepub =
+            toBase58(TokenType::NodePublic, m->signingKey);
+        std::string const nodemaster =
+            toBase58(TokenType::NodePublic, m->masterKey);
+        vl->validators[nodepub] = strHex(m->signingKey);
+        vl->validatorsMaster[nodemaster] = nodepub;
+    }
+
+    return vl;
+}
+
+}  // namespace
+
 TxConsequences
 Import::makeTxConsequences(PreflightContext const& ctx)
 {
@@ -353,115 +524,34 @@ Import::preflight(PreflightContext const& ctx)
     // XPOP verify
     //
 
-    // check it was used to sign over the manifest
-    auto const m = deserializeManifest(base64_decode(
-        (*xpop)[jss::validation][jss::unl][jss::manifest].asString()));
-
-    if (!m)
+    // the unl section is usually shared by many imports, so its
+    // verification is cached
+    auto const& unl = (*xpop)[jss::validation][jss::unl];
+    auto const vlKey = ImportVLCache::key(unl);
+    auto vl = ImportVLCache::instance().fetch(vlKey);
+    if (!vl)
     {
-        JLOG(ctx.j.warn()) << "Import: failed to deserialize manifest on txid "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    // we will check the master key matches a known one in preclaim, because the
-    // import vl key might be from the on-ledger object
-    if (m->masterKey != masterVLKey)
-    {
-        JLOG(ctx.j.warn()) << "Import: manifest master key did not match top "
-                              "level master key in unl section of xpop "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    if (!m->verify())
-    {
-        JLOG(ctx.j.warn()) << "Import: manifest signature invalid "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    // manifest signing (ephemeral) key
-    auto const signingKey = m->signingKey;
-
-    // decode blob
-    auto const data =
-        base64_decode((*xpop)[jss::validation][jss::unl][jss::blob].asString());
-
-    Json::Reader r;
-    Json::Value list;
-    if (!r.parse(data, list))
-    {
-        JLOG(ctx.j.warn())
-            << "Import: unl blob was not valid json (after base64 decoding) "
-            << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    if (!list.isMember(jss::sequence) || !list[jss::sequence].isInt())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (sequence) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-    if (!list.isMember(jss::expiration) || !list[jss::expiration].isInt())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (expiration) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-    if (list.isMember(jss::effective) && !list[jss::effective].isInt())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (effective) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-    if (!list.isMember(jss::validators) || !list[jss::validators].isArray())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (validators) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
+        vl = verifyVL(unl, *masterVLKey, tx.getTransactionID(), ctx.j);
+        if (!vl)
+            return temMALFORMED;
+        ImportVLCache::instance().insert(vlKey, vl);
     }
 
-    auto const validFrom = TimeKeeper::time_point{TimeKeeper::duration{
-        list.isMember(jss::effective) ? list[jss::effective].asUInt() : 0}};
-    auto const validUntil = TimeKeeper::time_point{
-        TimeKeeper::duration{list[jss::expiration].asUInt()}};
     auto const now = ctx.app.timeKeeper().now();
-    if (validUntil <= validFrom)
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob validUntil <= validFrom "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    if (validUntil <= now)
+    if (vl->validUntil <= now)
     {
         JLOG(ctx.j.warn()) << "Import: unl blob expired "
                            << tx.getTransactionID();
         return temMALFORMED;
     }
 
-    if (validFrom > now)
+    if (vl->validFrom > now)
     {
         JLOG(ctx.j.warn()) << "Import: unl blob not yet valid "
                            << tx.getTransactionID();
         return temMALFORMED;
     }
 
-    auto const sig =
-        strUnHex((*xpop)[jss::validation][jss::unl][jss::signature].asString());
-    if (!sig || !ripple::verify(signingKey, makeSlice(data), makeSlice(*sig)))
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob not signed correctly "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
     auto const tx_hash =
         stpTrans->getTransactionID();  // sha512Half(HashPrefix::transactionID,
                                        // *rawTx);
@@ -627,74 +717,9 @@ Import::preflight(PreflightContext const& ctx)
     // validation section
     //
 
-    std::map<std::string /* nodepub */, std::string /* public key */>
-        validators;
-    std::map<std::string /* master pubkey */, std::string /* nodepub */>
-        validatorsMaster;
-
-    uint64_t totalValidatorCount{0};
-
-    // parse the validator list
-    for (auto const& val : list[jss::validators])
-    {
-        totalValidatorCount++;
-
-        if (!val.isObject() || !val.isMember(jss::validation_public_key) ||
-            !val[jss::validation_public_key].isString() ||
-            !val.isMember(jss::manifest) || !val[jss::manifest].isString())
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob contained invalid "
-                                  "validator entry, skipping "
-                               << tx.getTransactionID();
-            continue;
-        }
-
-        std::optional<Blob> const ret =
-            strUnHex(val[jss::validation_public_key].asString());
-
-        if (!ret || !publicKeyType(makeSlice(*ret)))
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob contained an invalid "
-                                  "validator key, skipping "
-                               << val[jss::validation_public_key].asString()
-                               << " " << tx.getTransactionID();
-            continue;
-        }
-
-        auto const m =
-            deserializeManifest(base64_decode(val[jss::manifest].asString()));
-
-        if (!m)
-        {
-            JLOG(ctx.j.warn())
-                << "Import: unl blob contained an invalid manifest, skipping "
-                << tx.getTransactionID();
-            continue;
-        }
-
-        if (strHex(m->masterKey) != val[jss::validation_public_key])
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob list entry manifest master "
-                                  "key did not match master key, skipping "
-                               << tx.getTransactionID();
-            continue;
-        }
-
-        if (!m->verify())
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob list entry manifest "
-                                  "signature invalid, skipping "
-                               << tx.getTransactionID();
-            continue;
-        }
-
-        std::string const nodepub =
-            toBase58(TokenType::NodePublic, m->signingKey);
-        std::string const nodemaster =
-            toBase58(TokenType::NodePublic, m->masterKey);
-        validators[nodepub] = strHex(m->signingKey);
-        validatorsMaster[nodemaster] = nodepub;
-    }
+    auto const& validators = vl->validators;
+    auto const& validatorsMaster = vl->validatorsMaster;
+    uint64_t const totalValidatorCount = vl->totalValidatorCount;
 
     JLOG(ctx.j.trace()) << "totalValidatorCount: " << totalValidatorCount;
 
@@ -713,6 +738,11 @@ Import::preflight(PreflightContext const& ctx)
     {
         auto const& data = (*xpop)[jss::validation][jss::data];
         std::set<std::string> used_key;
+
+        // validations passing every other check, with their nodepub, so that
+        // the signatures can be checked together
+        std::vector<std::pair<std::unique_ptr<STValidation>, std::string>>
+            signedBy;
         for (const auto& key : data.getMemberNames())
         {
             auto nodepub = key;
@@ -792,18 +822,7 @@ Import::preflight(PreflightContext const& ctx)
                     continue;
                 }
 
-                // signature check is expensive hence done after checking
-                // everything else
-                if (!val->isValid())
-                {
-                    JLOG(ctx.j.warn()) << "Import: validation inside xpop was "
-                                          "not correctly signed "
-                                       << "nodepub: " << nodepub
-                                       << " txid: " << tx.getTransactionID();
-                    continue;
-                }
-
-                validationCount++;
+                signedBy.emplace_back(std::move(val), nodepub);
             }
             catch (...)
             {
@@ -814,6 +833,28 @@ Import::preflight(PreflightContext const& ctx)
                 continue;
             }
         }
+
+        // signature check is expensive hence done after checking
+        // everything else
+        std::vector<STValidation const*> vals;
+        vals.reserve(signedBy.size());
+        for (auto const& [val, nodepub] : signedBy)
+            vals.push_back(val.get());
+        STValidation::checkSignatures(vals);
+
+        for (auto const& [val, nodepub] : signedBy)
+        {
+            if (!val->isValid())
+            {
+                JLOG(ctx.j.warn()) << "Import: validation inside xpop was "
+                                      "not correctly signed "
+                                   << "nodepub: " << nodepub
+                                   << " txid: " << tx.getTransactionID();
+                continue;
+            }
+
+            validationCount++;
+        }
     }
 
     JLOG(ctx.j.trace()) << "quorum: " << quorum
@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/tx/impl/ImportVLCache.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/jss.h>
+
+namespace ripple {
+
+ImportVLCache::ImportVLCache(std::size_t maxEntries) : maxEntries_(maxEntries)
+{
+}
+
+ImportVLCache&
+ImportVLCache::instance()
+{
+    static ImportVLCache cache;
+    return cache;
+}
+
+uint256
+ImportVLCache::key(Json::Value const& unl)
+{
+    // every field that feeds into the verification, length prefixed
+    Serializer s;
+    for (auto const& field :
+         {jss::public_key, jss::manifest, jss::blob, jss::signature})
+    {
+        auto const value = unl[field].asString();
+        s.addVL(value.data(), static_cast<int>(value.size()));
+    }
+    return s.getSHA512Half();
+}
+
+std::shared_ptr<VerifiedVL const>
+ImportVLCache::fetch(uint256 const& key)
+{
+    std::lock_guard lock(mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end())
+    {
+        ++misses_;
+        return nullptr;
+    }
+
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.vl;
+}
+
+void
+ImportVLCache::insert(uint256 const& key, std::shared_ptr<VerifiedVL const> vl)
+{
+    std::lock_guard lock(mutex_);
+    if (maxEntries_ == 0 || map_.count(key))
+        return;
+
+    lru_.push_front(key);
+    map_.emplace(key, Entry{std::move(vl), lru_.begin()});
+
+    while (map_.size() > maxEntries_)
+    {
+        map_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+void
+ImportVLCache::clear()
+{
+    std::lock_guard lock(mutex_);
+    map_.clear();
+    lru_.clear();
+}
+
+std::size_t
+ImportVLCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return map_.size();
+}
+
+std::uint64_t
+ImportVLCache::hits() const
+{
+    std::lock_guard lock(mutex_);
+    return hits_;
+}
+
+std::uint64_t
+ImportVLCache::misses() const
+{
+    std::lock_guard lock(mutex_);
+    return misses_;
+}
+
+}  // namespace ripple
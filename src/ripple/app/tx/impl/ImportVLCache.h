@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_TX_IMPORTVLCACHE_H_INCLUDED
+#define RIPPLE_TX_IMPORTVLCACHE_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/core/TimeKeeper.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/PublicKey.h>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** A validator list carried in the unl section of an XPOP, once verified.
+
+    Verification covers the publisher manifest, the list signature and the
+    manifest of every listed validator. The validity window is kept so that
+    it can be checked against the current time on every use.
+*/
+struct VerifiedVL
+{
+    PublicKey masterKey;  // publisher master key
+    TimeKeeper::time_point validFrom;
+    TimeKeeper::time_point validUntil;
+    std::uint64_t totalValidatorCount = 0;
+
+    // node public key (base58) -> signing key (hex)
+    std::map<std::string, std::string> validators;
+
+    // master public key (base58) -> node public key (base58)
+    std::map<std::string, std::string> validatorsMaster;
+};
+
+/** Process-wide cache of verified XPOP validator lists.
+
+    Imports produced from the same validator list carry byte for byte the
+    same unl section, so the costly part of verifying it only needs to be
+    done once. Entries are keyed by a hash of the whole unl section and the
+    least recently used entry is evicted first.
+*/
+class ImportVLCache
+{
+public:
+    static constexpr std::size_t defaultMaxEntries = 64;
+
+    explicit ImportVLCache(std::size_t maxEntries = defaultMaxEntries);
+
+    ImportVLCache(ImportVLCache const&) = delete;
+    ImportVLCache&
+    operator=(ImportVLCache const&) = delete;
+
+    static ImportVLCache&
+    instance();
+
+    // the key for an XPOP's validation.unl object
+    static uint256
+    key(Json::Value const& unl);
+
+    std::shared_ptr<VerifiedVL const>
+    fetch(uint256 const& key);
+
+    void
+    insert(uint256 const& key, std::shared_ptr<VerifiedVL const> vl);
+
+    void
+    clear();
+
+    std::size_t
+    size() const;
+
+    std::uint64_t
+    hits() const;
+
+    std::uint64_t
+    misses() const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<VerifiedVL const> vl;
+        std::list<uint256>::iterator lru;
+    };
+
+    std::size_t const maxEntries_;
+
+    mutable std::mutex mutex_;
+    hardened_hash_map<uint256, Entry> map_;
+    std::list<uint256> lru_;  // most recently used at the front
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
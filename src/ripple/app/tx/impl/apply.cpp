@@ -17,10 +17,12 @@
 */
 //==============================================================================
 
+#include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/app/tx/applySteps.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/parallel.h>
 #include <ripple/protocol/Feature.h>
 
 namespace ripple {
@@ -116,6 +118,36 @@ checkValidity(
     return {Validity::Valid, ""};
 }
 
+void
+checkValidity(
+    HashRouter& router,
+    CanonicalTXSet const& txns,
+    Rules const& rules,
+    Config const& config)
+{
+    std::vector<STTx const*> unchecked;
+    for (auto const& item : txns)
+    {
+        auto const flags = router.getFlags(item.second->getTransactionID());
+        if (!(flags & (SF_SIGGOOD | SF_SIGBAD)))
+            unchecked.push_back(item.second.get());
+    }
+
+    forEachSlice(unchecked.size(), 8, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+        {
+            try
+            {
+                checkValidity(router, *unchecked[i], rules, config);
+            }
+            catch (std::exception const&)
+            {
+                // checked again, and handled, when the transaction is applied
+            }
+        }
+    });
+}
+
 void
 forceValidity(HashRouter& router, uint256 const& txid, Validity validity)
 {
@@ -0,0 +1,502 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_INTRUSIVEPOINTER_H_INCLUDED
+#define RIPPLE_BASICS_INTRUSIVEPOINTER_H_INCLUDED
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace ripple {
+
+/** Strong and weak reference counts kept inside the counted object.
+
+    Both counts and two state bits are packed in one 32 bit word, so an
+    object that derives from this class grows by four bytes instead of
+    needing the separately counted control block of a std::shared_ptr. The
+    pointers that use it, SharedIntrusive and WeakIntrusive, are the size
+    of a raw pointer.
+
+    When the last strong reference is released while weak references
+    remain, the object cannot be destroyed yet because its counts are still
+    in use. Its partialDestructor() member is called instead, which should
+    release whatever the object owns. The object is destroyed with the last
+    weak reference.
+
+    @note There may be at most 2^20 - 1 strong and 2^10 - 1 weak references
+          to an object at once.
+*/
+class IntrusiveRefCounts
+{
+public:
+    enum class ReleaseStrongRefAction { noop, partialDestroy, destroy };
+    enum class ReleaseWeakRefAction { noop, destroy };
+
+    IntrusiveRefCounts(IntrusiveRefCounts const&) = delete;
+    IntrusiveRefCounts&
+    operator=(IntrusiveRefCounts const&) = delete;
+
+    void
+    addStrongRef() const noexcept
+    {
+        [[maybe_unused]] auto const prev =
+            refCounts_.fetch_add(strongDelta, std::memory_order_relaxed);
+        assert((prev & strongMask) != strongMask);
+    }
+
+    void
+    addWeakRef() const noexcept
+    {
+        [[maybe_unused]] auto const prev =
+            refCounts_.fetch_add(weakDelta, std::memory_order_relaxed);
+        assert((prev & weakMask) != weakMask);
+    }
+
+    ReleaseStrongRefAction
+    releaseStrongRef() const noexcept
+    {
+        auto prev = refCounts_.load(std::memory_order_acquire);
+        while (true)
+        {
+            assert(prev & strongMask);
+            auto next = prev - strongDelta;
+            auto action = ReleaseStrongRefAction::noop;
+            if ((next & strongMask) == 0)
+            {
+                if ((next & weakMask) == 0)
+                {
+                    action = ReleaseStrongRefAction::destroy;
+                }
+                else
+                {
+                    next |= partialDestroyStarted;
+                    action = ReleaseStrongRefAction::partialDestroy;
+                }
+            }
+            if (refCounts_.compare_exchange_weak(
+                    prev, next, std::memory_order_acq_rel))
+                return action;
+        }
+    }
+
+    ReleaseWeakRefAction
+    releaseWeakRef() const noexcept
+    {
+        auto const prev =
+            refCounts_.fetch_sub(weakDelta, std::memory_order_acq_rel);
+        assert(prev & weakMask);
+        if ((prev & weakMask) != weakDelta || (prev & strongMask) != 0)
+            return ReleaseWeakRefAction::noop;
+
+        // While the partial destructor runs, the thread running it owns
+        // the destruction.
+        if ((prev & partialDestroyStarted) && !(prev & partialDestroyFinished))
+            return ReleaseWeakRefAction::noop;
+        return ReleaseWeakRefAction::destroy;
+    }
+
+    /** Record that partialDestructor() returned.
+
+        @return destroy if the weak references were released meanwhile.
+    */
+    ReleaseWeakRefAction
+    partialDestructorFinished() const noexcept
+    {
+        auto const prev = refCounts_.fetch_or(
+            partialDestroyFinished, std::memory_order_acq_rel);
+        assert((prev & partialDestroyStarted) && !(prev & strongMask));
+        if (prev & weakMask)
+            return ReleaseWeakRefAction::noop;
+        return ReleaseWeakRefAction::destroy;
+    }
+
+    /** Take a strong reference if any remains.
+
+        Once the strong count has dropped to zero it stays there.
+    */
+    bool
+    checkoutStrongRefFromWeak() const noexcept
+    {
+        auto prev = refCounts_.load(std::memory_order_acquire);
+        while (prev & strongMask)
+        {
+            if (refCounts_.compare_exchange_weak(
+                    prev, prev + strongDelta, std::memory_order_acq_rel))
+                return true;
+        }
+        return false;
+    }
+
+    bool
+    expired() const noexcept
+    {
+        return (refCounts_.load(std::memory_order_acquire) & strongMask) == 0;
+    }
+
+    std::size_t
+    use_count() const noexcept
+    {
+        return refCounts_.load(std::memory_order_acquire) & strongMask;
+    }
+
+protected:
+    IntrusiveRefCounts() noexcept = default;
+
+    ~IntrusiveRefCounts() noexcept
+    {
+        assert(!(refCounts_.load() & (strongMask | weakMask)));
+    }
+
+private:
+    static constexpr std::uint32_t strongDelta = 1;
+    static constexpr std::uint32_t strongMask = (1u << 20) - 1;
+    static constexpr std::uint32_t weakDelta = 1u << 20;
+    static constexpr std::uint32_t weakMask = ((1u << 10) - 1) << 20;
+    static constexpr std::uint32_t partialDestroyStarted = 1u << 30;
+    static constexpr std::uint32_t partialDestroyFinished = 1u << 31;
+
+    mutable std::atomic<std::uint32_t> refCounts_{0};
+};
+
+/** A strong pointer to an object derived from IntrusiveRefCounts.
+
+    Used like a std::shared_ptr, but only eight bytes wide. The pointee
+    must provide a partialDestructor() member and, if it is deleted through
+    a base class, a virtual destructor.
+*/
+template <class T>
+class SharedIntrusive
+{
+public:
+    struct AdoptTag
+    {
+    };
+
+    SharedIntrusive() noexcept = default;
+
+    SharedIntrusive(std::nullptr_t) noexcept
+    {
+    }
+
+    explicit SharedIntrusive(T* p) noexcept : ptr_(p)
+    {
+        if (ptr_)
+            ptr_->addStrongRef();
+    }
+
+    /** Take over a strong reference that has already been counted. */
+    SharedIntrusive(T* p, AdoptTag) noexcept : ptr_(p)
+    {
+    }
+
+    SharedIntrusive(SharedIntrusive const& rhs) noexcept
+        : SharedIntrusive(rhs.ptr_)
+    {
+    }
+
+    template <
+        class U,
+        class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    SharedIntrusive(SharedIntrusive<U> const& rhs) noexcept
+        : SharedIntrusive(rhs.ptr_)
+    {
+    }
+
+    SharedIntrusive(SharedIntrusive&& rhs) noexcept
+        : ptr_(std::exchange(rhs.ptr_, nullptr))
+    {
+    }
+
+    template <
+        class U,
+        class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    SharedIntrusive(SharedIntrusive<U>&& rhs) noexcept
+        : ptr_(std::exchange(rhs.ptr_, nullptr))
+    {
+    }
+
+    SharedIntrusive&
+    operator=(SharedIntrusive const& rhs) noexcept
+    {
+        SharedIntrusive(rhs).swap(*this);
+        return *this;
+    }
+
+    SharedIntrusive&
+    operator=(SharedIntrusive&& rhs) noexcept
+    {
+        SharedIntrusive(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    template <
+        class U,
+        class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    SharedIntrusive&
+    operator=(SharedIntrusive<U> const& rhs) noexcept
+    {
+        SharedIntrusive(rhs).swap(*this);
+        return *this;
+    }
+
+    template <
+        class U,
+        class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    SharedIntrusive&
+    operator=(SharedIntrusive<U>&& rhs) noexcept
+    {
+        SharedIntrusive(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    ~SharedIntrusive()
+    {
+        release(ptr_);
+    }
+
+    void
+    swap(SharedIntrusive& rhs) noexcept
+    {
+        std::swap(ptr_, rhs.ptr_);
+    }
+
+    void
+    reset() noexcept
+    {
+        release(std::exchange(ptr_, nullptr));
+    }
+
+    T*
+    get() const noexcept
+    {
+        return ptr_;
+    }
+
+    T&
+    operator*() const noexcept
+    {
+        return *ptr_;
+    }
+
+    T*
+    operator->() const noexcept
+    {
+        return ptr_;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return ptr_ != nullptr;
+    }
+
+    std::size_t
+    use_count() const noexcept
+    {
+        return ptr_ ? ptr_->use_count() : 0;
+    }
+
+    template <class U>
+    bool
+    operator==(SharedIntrusive<U> const& rhs) const noexcept
+    {
+        return ptr_ == rhs.get();
+    }
+
+    bool
+    operator==(std::nullptr_t) const noexcept
+    {
+        return ptr_ == nullptr;
+    }
+
+    /** Give up the pointer without releasing its strong reference. */
+    [[nodiscard]] T*
+    detach() noexcept
+    {
+        return std::exchange(ptr_, nullptr);
+    }
+
+private:
+    template <class U>
+    friend class SharedIntrusive;
+
+    static void
+    release(T* p) noexcept
+    {
+        if (!p)
+            return;
+
+        using Action = IntrusiveRefCounts::ReleaseStrongRefAction;
+        switch (p->releaseStrongRef())
+        {
+            case Action::noop:
+                break;
+            case Action::destroy:
+                delete p;
+                break;
+            case Action::partialDestroy:
+                p->partialDestructor();
+                if (p->partialDestructorFinished() ==
+                    IntrusiveRefCounts::ReleaseWeakRefAction::destroy)
+                    delete p;
+                break;
+        }
+    }
+
+    T* ptr_ = nullptr;
+};
+
+/** A weak pointer to an object derived from IntrusiveRefCounts. */
+template <class T>
+class WeakIntrusive
+{
+public:
+    WeakIntrusive() noexcept = default;
+
+    WeakIntrusive(SharedIntrusive<T> const& rhs) noexcept : ptr_(rhs.get())
+    {
+        if (ptr_)
+            ptr_->addWeakRef();
+    }
+
+    WeakIntrusive(WeakIntrusive const& rhs) noexcept : ptr_(rhs.ptr_)
+    {
+        if (ptr_)
+            ptr_->addWeakRef();
+    }
+
+    WeakIntrusive(WeakIntrusive&& rhs) noexcept
+        : ptr_(std::exchange(rhs.ptr_, nullptr))
+    {
+    }
+
+    WeakIntrusive&
+    operator=(WeakIntrusive const& rhs) noexcept
+    {
+        WeakIntrusive(rhs).swap(*this);
+        return *this;
+    }
+
+    WeakIntrusive&
+    operator=(WeakIntrusive&& rhs) noexcept
+    {
+        WeakIntrusive(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    WeakIntrusive&
+    operator=(SharedIntrusive<T> const& rhs) noexcept
+    {
+        WeakIntrusive(rhs).swap(*this);
+        return *this;
+    }
+
+    ~WeakIntrusive()
+    {
+        release(ptr_);
+    }
+
+    void
+    swap(WeakIntrusive& rhs) noexcept
+    {
+        std::swap(ptr_, rhs.ptr_);
+    }
+
+    void
+    reset() noexcept
+    {
+        release(std::exchange(ptr_, nullptr));
+    }
+
+    /** Return a strong pointer, or null if the object is gone. */
+    SharedIntrusive<T>
+    lock() const noexcept
+    {
+        if (ptr_ && ptr_->checkoutStrongRefFromWeak())
+            return SharedIntrusive<T>(
+                ptr_, typename SharedIntrusive<T>::AdoptTag{});
+        return {};
+    }
+
+    bool
+    expired() const noexcept
+    {
+        return !ptr_ || ptr_->expired();
+    }
+
+private:
+    static void
+    release(T* p) noexcept
+    {
+        if (p &&
+            p->releaseWeakRef() ==
+                IntrusiveRefCounts::ReleaseWeakRefAction::destroy)
+            delete p;
+    }
+
+    T* ptr_ = nullptr;
+};
+
+template <class T, class... Args>
+SharedIntrusive<T>
+make_SharedIntrusive(Args&&... args)
+{
+    return SharedIntrusive<T>(new T(std::forward<Args>(args)...));
+}
+
+template <class T, class U>
+SharedIntrusive<T>
+static_pointer_cast(SharedIntrusive<U> const& p) noexcept
+{
+    return SharedIntrusive<T>(static_cast<T*>(p.get()));
+}
+
+template <class T, class U>
+SharedIntrusive<T>
+static_pointer_cast(SharedIntrusive<U>&& p) noexcept
+{
+    return SharedIntrusive<T>(
+        static_cast<T*>(p.detach()), typename SharedIntrusive<T>::AdoptTag{});
+}
+
+template <class T, class U>
+SharedIntrusive<T>
+dynamic_pointer_cast(SharedIntrusive<U> const& p) noexcept
+{
+    return SharedIntrusive<T>(dynamic_cast<T*>(p.get()));
+}
+
+template <class T, class U>
+SharedIntrusive<T>
+dynamic_pointer_cast(SharedIntrusive<U>&& p) noexcept
+{
+    if (auto const q = dynamic_cast<T*>(p.get()))
+    {
+        p.detach();
+        return SharedIntrusive<T>(q, typename SharedIntrusive<T>::AdoptTag{});
+    }
+    return {};
+}
+
+}  // namespace ripple
+
+#endif
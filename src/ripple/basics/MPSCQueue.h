@@ -0,0 +1,125 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_MPSCQUEUE_H_INCLUDED
+#define RIPPLE_BASICS_MPSCQUEUE_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ripple {
+
+/** A lock-free queue with many producers and a single consumer.
+
+    Any number of threads may push items concurrently without taking a
+    lock. One thread at a time takes every queued item at once, oldest
+    first.
+
+    Pushed items form a stack, linked with a compare and swap. The consumer
+    detaches the whole stack with a single exchange and reverses it, so it
+    never pops a node another thread may be pushing against, which rules
+    out the ABA problem.
+*/
+template <class T>
+class MPSCQueue
+{
+public:
+    MPSCQueue() = default;
+    MPSCQueue(MPSCQueue const&) = delete;
+    MPSCQueue&
+    operator=(MPSCQueue const&) = delete;
+
+    ~MPSCQueue()
+    {
+        consume([](T&&) {});
+    }
+
+    /** Adds an item. Safe to call from any thread.
+
+        @return `true` if the queue was empty, meaning the consumer may
+                need to be told there is something to take.
+    */
+    bool
+    push(T item)
+    {
+        auto node = new Node{std::move(item), nullptr};
+        Node* head = head_.load(std::memory_order_relaxed);
+        do
+        {
+            node->next = head;
+        } while (!head_.compare_exchange_weak(
+            head, node, std::memory_order_release, std::memory_order_relaxed));
+        return head == nullptr;
+    }
+
+    /** Takes every queued item, oldest first.
+
+        Must not be called by two threads at the same time.
+
+        @param f Called with each item, as an rvalue. Must not throw.
+        @return The number of items taken.
+    */
+    template <class F>
+    std::size_t
+    consume(F&& f)
+    {
+        Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+
+        Node* oldest = nullptr;
+        while (node)
+        {
+            Node* const next = node->next;
+            node->next = oldest;
+            oldest = node;
+            node = next;
+        }
+
+        std::size_t count = 0;
+        while (oldest)
+        {
+            std::unique_ptr<Node> taken(oldest);
+            oldest = taken->next;
+            f(std::move(taken->item));
+            ++count;
+        }
+        return count;
+    }
+
+    /** Returns `true` if nothing is queued. */
+    bool
+    empty() const
+    {
+        return head_.load(std::memory_order_relaxed) == nullptr;
+    }
+
+private:
+    struct Node
+    {
+        T item;
+        Node* next;
+    };
+
+    std::atomic<Node*> head_{nullptr};
+};
+
+}  // namespace ripple
+
+#endif
@@ -25,11 +25,14 @@
 #include <ripple/basics/hardened_hash.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
+#include <algorithm>
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ripple {
@@ -43,8 +46,23 @@ namespace ripple {
     If it stays in memory even after it is ejected from the cache,
     the map will track it.
 
+    Every partition of the map has its own lock, so operations on keys in
+    different partitions do not contend. Every hit records the time of the
+    use, and sweep() releases entries whose last use is older than the
+    target age. A reference bit alone would not keep that contract, since
+    it cannot tell a use just before a sweep from one just after the
+    previous sweep. While the cache holds more than its target size, the
+    target age is shortened, and each insertion also advances the clock
+    hand of its partition over a few entries, so that objects last used
+    before the shortened age are released between sweeps.
+
+    Objects are held through std::shared_ptr and std::weak_ptr unless other
+    pointer types with the same interface are given, such as SharedIntrusive
+    and WeakIntrusive for objects that count their own references.
+
     @note Callers must not modify data objects that are stored in the cache
-          unless they hold their own lock over all cache operations.
+          unless they hold their own lock over all cache operations. The
+          mutex returned by peekMutex() is not used by the cache itself.
 */
 template <
     class Key,
@@ -52,7 +70,9 @@ template <
     bool IsKeyCache = false,
     class Hash = hardened_hash<>,
     class KeyEqual = std::equal_to<Key>,
-    class Mutex = std::recursive_mutex>
+    class Mutex = std::recursive_mutex,
+    class SharedPointerType = std::shared_ptr<T>,
+    class WeakPointerType = std::weak_ptr<T>>
 class TaggedCache
 {
 public:
@@ -80,6 +100,7 @@ public:
         , m_target_size(size)
         , m_target_age(expiration)
         , m_cache_count(0)
+        , m_partitions(std::make_unique<Partition[]>(m_cache.partitions()))
         , m_hits(0)
         , m_misses(0)
     {
@@ -97,20 +118,26 @@ public:
     std::size_t
     size() const
     {
-        std::lock_guard lock(m_mutex);
-        return m_cache.size();
+        std::size_t ret = 0;
+        for (std::size_t p = 0; p < m_cache.partitions(); ++p)
+        {
+            std::lock_guard lock(m_partitions[p].mutex);
+            ret += m_cache.map()[p].size();
+        }
+        return ret;
     }
 
     void
     setTargetSize(int s)
     {
-        std::lock_guard lock(m_mutex);
         m_target_size = s;
 
         if (s > 0)
         {
-            for (auto& partition : m_cache.map())
+            for (std::size_t p = 0; p < m_cache.partitions(); ++p)
             {
+                std::lock_guard lock(m_partitions[p].mutex);
+                auto& partition = m_cache.map()[p];
                 partition.rehash(static_cast<std::size_t>(
                     (s + (s >> 2)) /
                         (partition.max_load_factor() * m_cache.partitions()) +
@@ -124,55 +151,47 @@ public:
     clock_type::duration
     getTargetAge() const
     {
-        std::lock_guard lock(m_mutex);
         return m_target_age;
     }
 
     void
     setTargetAge(clock_type::duration s)
     {
-        std::lock_guard lock(m_mutex);
         m_target_age = s;
         JLOG(m_journal.debug())
-            << m_name << " target age set to " << m_target_age.count();
+            << m_name << " target age set to " << s.count();
     }
 
     int
     getCacheSize() const
     {
-        std::lock_guard lock(m_mutex);
         return m_cache_count;
     }
 
     int
     getTrackSize() const
     {
-        std::lock_guard lock(m_mutex);
-        return m_cache.size();
+        return size();
     }
 
     float
     getHitRate()
     {
-        std::lock_guard lock(m_mutex);
-        auto const total = static_cast<float>(m_hits + m_misses);
-        return m_hits * (100.0f / std::max(1.0f, total));
+        auto const hits = m_hits.load();
+        auto const total = static_cast<float>(hits + m_misses);
+        return hits * (100.0f / std::max(1.0f, total));
     }
 
     void
     clear()
     {
-        std::lock_guard lock(m_mutex);
-        m_cache.clear();
-        m_cache_count = 0;
+        clearPartitions();
     }
 
     void
     reset()
     {
-        std::lock_guard lock(m_mutex);
-        m_cache.clear();
-        m_cache_count = 0;
+        clearPartitions();
         m_hits = 0;
         m_misses = 0;
     }
@@ -184,9 +203,11 @@ public:
     bool
     touch_if_exists(KeyComparable const& key)
     {
-        std::lock_guard lock(m_mutex);
-        auto const iter(m_cache.find(key));
-        if (iter == m_cache.end())
+        auto const p = partitionOf(key);
+        std::lock_guard lock(m_partitions[p].mutex);
+        auto& partition = m_cache.map()[p];
+        auto const iter(partition.find(key));
+        if (iter == partition.end())
         {
             ++m_stats.misses;
             return false;
@@ -197,45 +218,33 @@ public:
     }
 
     using SweptPointersVector = std::pair<
-        std::vector<std::shared_ptr<mapped_type>>,
-        std::vector<std::weak_ptr<mapped_type>>>;
+        std::vector<SharedPointerType>,
+        std::vector<WeakPointerType>>;
 
     void
     sweep()
     {
         // Keep references to all the stuff we sweep
         // For performance, each worker thread should exit before the swept data
-        // is destroyed but still within the main cache lock.
+        // is destroyed but still within its partition lock.
         std::vector<SweptPointersVector> allStuffToSweep(m_cache.partitions());
 
         clock_type::time_point const now(m_clock.now());
-        clock_type::time_point when_expire;
 
-        auto const start = std::chrono::steady_clock::now();
-        {
-            std::lock_guard lock(m_mutex);
+        auto const tracked = size();
+        clock_type::time_point const when_expire(expiry(now, tracked));
 
-            if (m_target_size == 0 ||
-                (static_cast<int>(m_cache.size()) <= m_target_size))
-            {
-                when_expire = now - m_target_age;
-            }
-            else
-            {
-                when_expire =
-                    now - m_target_age * m_target_size / m_cache.size();
-
-                clock_type::duration const minimumAge(std::chrono::seconds(1));
-                if (when_expire > (now - minimumAge))
-                    when_expire = now - minimumAge;
-
-                JLOG(m_journal.trace())
-                    << m_name << " is growing fast " << m_cache.size() << " of "
-                    << m_target_size << " aging at "
-                    << (now - when_expire).count() << " of "
-                    << m_target_age.count();
-            }
+        if (when_expire != now - getTargetAge())
+        {
+            JLOG(m_journal.trace())
+                << m_name << " is growing fast " << tracked << " of "
+                << m_target_size << " aging at "
+                << (now - when_expire).count() << " of "
+                << getTargetAge().count();
+        }
 
+        auto const start = std::chrono::steady_clock::now();
+        {
             std::vector<std::thread> workers;
             workers.reserve(m_cache.partitions());
             std::atomic<int> allRemovals = 0;
@@ -246,19 +255,19 @@ public:
                     when_expire,
                     now,
                     m_cache.map()[p],
+                    m_partitions[p].mutex,
                     allStuffToSweep[p],
-                    allRemovals,
-                    lock));
+                    allRemovals));
             }
             for (std::thread& worker : workers)
                 worker.join();
 
             m_cache_count -= allRemovals;
         }
-        // At this point allStuffToSweep will go out of scope outside the lock
+        // At this point allStuffToSweep will go out of scope outside the locks
         // and decrement the reference count on each strong pointer.
         JLOG(m_journal.debug())
-            << m_name << " TaggedCache sweep lock duration "
+            << m_name << " TaggedCache sweep duration "
             << std::chrono::duration_cast<std::chrono::milliseconds>(
                    std::chrono::steady_clock::now() - start)
                    .count()
@@ -270,11 +279,13 @@ public:
     {
         // Remove from cache, if !valid, remove from map too. Returns true if
         // removed from cache
-        std::lock_guard lock(m_mutex);
+        auto const p = partitionOf(key);
+        std::lock_guard lock(m_partitions[p].mutex);
+        auto& partition = m_cache.map()[p];
 
-        auto cit = m_cache.find(key);
+        auto cit = partition.find(key);
 
-        if (cit == m_cache.end())
+        if (cit == partition.end())
             return false;
 
         Entry& entry = cit->second;
@@ -289,7 +300,7 @@ public:
         }
 
         if (!valid || entry.isExpired())
-            m_cache.erase(cit);
+            partition.erase(cit);
 
         return ret;
     }
@@ -311,30 +322,36 @@ public:
     bool
     canonicalize(
         const key_type& key,
-        std::shared_ptr<T>& data,
-        std::function<bool(std::shared_ptr<T> const&)>&& replace)
+        SharedPointerType& data,
+        std::function<bool(SharedPointerType const&)>&& replace)
     {
         // Return canonical value, store if needed, refresh in cache
         // Return values: true=we had the data already
-        std::lock_guard lock(m_mutex);
+        std::vector<SharedPointerType> released;
+
+        auto const p = partitionOf(key);
+        std::lock_guard lock(m_partitions[p].mutex);
+        auto& partition = m_cache.map()[p];
 
-        auto cit = m_cache.find(key);
+        auto cit = partition.find(key);
 
-        if (cit == m_cache.end())
+        if (cit == partition.end())
         {
-            m_cache.emplace(
+            partition.emplace(
                 std::piecewise_construct,
                 std::forward_as_tuple(key),
                 std::forward_as_tuple(m_clock.now(), data));
             ++m_cache_count;
+            advanceHand(p, released);
             return false;
         }
 
         Entry& entry = cit->second;
-        entry.touch(m_clock.now());
 
         if (entry.isCached())
         {
+            entry.touch(m_clock.now());
+
             if (replace(entry.ptr))
             {
                 entry.ptr = data;
@@ -348,6 +365,8 @@ public:
             return true;
         }
 
+        entry.touch(m_clock.now());
+
         auto cachedData = entry.lock();
 
         if (cachedData)
@@ -364,12 +383,14 @@ public:
             }
 
             ++m_cache_count;
+            advanceHand(p, released);
             return true;
         }
 
         entry.ptr = data;
         entry.weak_ptr = data;
         ++m_cache_count;
+        advanceHand(p, released);
 
         return false;
     }
@@ -377,26 +398,29 @@ public:
     bool
     canonicalize_replace_cache(
         const key_type& key,
-        std::shared_ptr<T> const& data)
+        SharedPointerType const& data)
     {
         return canonicalize(
             key,
-            const_cast<std::shared_ptr<T>&>(data),
-            [](std::shared_ptr<T> const&) { return true; });
+            const_cast<SharedPointerType&>(data),
+            [](SharedPointerType const&) { return true; });
     }
 
     bool
-    canonicalize_replace_client(const key_type& key, std::shared_ptr<T>& data)
+    canonicalize_replace_client(const key_type& key, SharedPointerType& data)
     {
         return canonicalize(
-            key, data, [](std::shared_ptr<T> const&) { return false; });
+            key, data, [](SharedPointerType const&) { return false; });
     }
 
-    std::shared_ptr<T>
+    SharedPointerType
     fetch(const key_type& key)
     {
-        std::lock_guard<mutex_type> l(m_mutex);
-        auto ret = initialFetch(key, l);
+        std::vector<SharedPointerType> released;
+
+        auto const p = partitionOf(key);
+        std::lock_guard l(m_partitions[p].mutex);
+        auto ret = initialFetch(key, p, released, l);
         if (!ret)
             ++m_misses;
         return ret;
@@ -419,15 +443,21 @@ public:
     auto
     insert(key_type const& key) -> std::enable_if_t<IsKeyCache, ReturnType>
     {
-        std::lock_guard lock(m_mutex);
-        clock_type::time_point const now(m_clock.now());
-        auto [it, inserted] = m_cache.emplace(
+        auto const p = partitionOf(key);
+        std::lock_guard lock(m_partitions[p].mutex);
+        auto& partition = m_cache.map()[p];
+
+        if (auto const it = partition.find(key); it != partition.end())
+        {
+            it->second.touch(m_clock.now());
+            return false;
+        }
+
+        partition.emplace(
             std::piecewise_construct,
             std::forward_as_tuple(key),
-            std::forward_as_tuple(now));
-        if (!inserted)
-            it->second.last_access = now;
-        return inserted;
+            std::forward_as_tuple(m_clock.now()));
+        return true;
     }
 
     // VFALCO NOTE It looks like this returns a copy of the data in
@@ -458,11 +488,12 @@ public:
     getKeys() const
     {
         std::vector<key_type> v;
+        v.reserve(size());
 
+        for (std::size_t p = 0; p < m_cache.partitions(); ++p)
         {
-            std::lock_guard lock(m_mutex);
-            v.reserve(m_cache.size());
-            for (auto const& _ : m_cache)
+            std::lock_guard lock(m_partitions[p].mutex);
+            for (auto const& _ : m_cache.map()[p])
                 v.push_back(_.first);
         }
 
@@ -474,11 +505,11 @@ public:
     double
     rate() const
     {
-        std::lock_guard lock(m_mutex);
-        auto const tot = m_hits + m_misses;
+        auto const hits = m_hits.load();
+        auto const tot = hits + m_misses;
         if (tot == 0)
             return 0;
-        return double(m_hits) / tot;
+        return double(hits) / tot;
     }
 
     /** Fetch an item from the cache.
@@ -487,12 +518,15 @@ public:
             std::shared_ptr<SLE const>(void)
     */
     template <class Handler>
-    std::shared_ptr<T>
+    SharedPointerType
     fetch(key_type const& digest, Handler const& h)
     {
+        auto const p = partitionOf(digest);
+
         {
-            std::lock_guard l(m_mutex);
-            if (auto ret = initialFetch(digest, l))
+            std::vector<SharedPointerType> released;
+            std::lock_guard l(m_partitions[p].mutex);
+            if (auto ret = initialFetch(digest, p, released, l))
                 return ret;
         }
 
@@ -500,22 +534,39 @@ public:
         if (!sle)
             return {};
 
-        std::lock_guard l(m_mutex);
+        std::vector<SharedPointerType> released;
+        std::lock_guard l(m_partitions[p].mutex);
         ++m_misses;
-        auto const [it, inserted] =
-            m_cache.emplace(digest, Entry(m_clock.now(), std::move(sle)));
-        if (!inserted)
+        auto const [it, inserted] = m_cache.map()[p].emplace(
+            digest, Entry(m_clock.now(), std::move(sle)));
+        if (inserted)
+        {
+            ++m_cache_count;
+            advanceHand(p, released);
+        }
+        else
             it->second.touch(m_clock.now());
         return it->second.ptr;
     }
     // End CachedSLEs functions.
 
 private:
-    std::shared_ptr<T>
-    initialFetch(key_type const& key, std::lock_guard<mutex_type> const& l)
+    std::size_t
+    partitionOf(key_type const& key) const
+    {
+        return partitioner(key, m_cache.partitions());
+    }
+
+    SharedPointerType
+    initialFetch(
+        key_type const& key,
+        std::size_t p,
+        std::vector<SharedPointerType>& released,
+        std::lock_guard<std::mutex> const& l)
     {
-        auto cit = m_cache.find(key);
-        if (cit == m_cache.end())
+        auto& partition = m_cache.map()[p];
+        auto cit = partition.find(key);
+        if (cit == partition.end())
             return {};
 
         Entry& entry = cit->second;
@@ -531,13 +582,100 @@ private:
             // independent of cache size, so not counted as a hit
             ++m_cache_count;
             entry.touch(m_clock.now());
-            return entry.ptr;
+            auto ret = entry.ptr;
+            advanceHand(p, released);
+            return ret;
         }
 
-        m_cache.erase(cit);
+        partition.erase(cit);
         return {};
     }
 
+    /** The oldest last use that an entry may have and stay cached.
+
+        The target age is shortened when the cache holds more than its
+        target size, but not below one second.
+    */
+    clock_type::time_point
+    expiry(clock_type::time_point const& now, std::size_t size) const
+    {
+        int const target = m_target_size;
+        clock_type::duration const age = m_target_age;
+
+        if (target == 0 || (static_cast<int>(size) <= target))
+            return now - age;
+
+        clock_type::time_point when_expire = now - age * target / size;
+
+        clock_type::duration const minimumAge(std::chrono::seconds(1));
+        if (when_expire > (now - minimumAge))
+            when_expire = now - minimumAge;
+
+        return when_expire;
+    }
+
+    /** Advance the clock hand of a partition while the cache is too big.
+
+        The hand visits a few buckets of the partition. The strong pointers
+        of entries not used within the shortened target age are moved to
+        `released`, so that the objects are destroyed after the partition
+        lock is released.
+    */
+    void
+    advanceHand(
+        std::size_t p,
+        std::vector<SharedPointerType>& released)
+    {
+        if constexpr (!IsKeyCache)
+        {
+            int const target = m_target_size;
+            int const count = m_cache_count;
+            if (target <= 0 || count <= target)
+                return;
+
+            auto& partition = m_cache.map()[p];
+            auto& hand = m_partitions[p].hand;
+            auto const buckets = partition.bucket_count();
+            auto const now = m_clock.now();
+            auto const when_expire = expiry(now, count);
+
+            for (std::size_t i = 0; i < std::min(buckets, handStep); ++i)
+            {
+                auto const bucket = hand++ % buckets;
+                for (auto it = partition.begin(bucket);
+                     it != partition.end(bucket);
+                     ++it)
+                {
+                    auto& entry = it->second;
+                    if (entry.isCached() && entry.last_access <= when_expire)
+                    {
+                        released.push_back(std::move(entry.ptr));
+                        --m_cache_count;
+                    }
+                }
+            }
+        }
+    }
+
+    void
+    clearPartitions()
+    {
+        for (std::size_t p = 0; p < m_cache.partitions(); ++p)
+        {
+            std::lock_guard lock(m_partitions[p].mutex);
+            auto& partition = m_cache.map()[p];
+            if constexpr (!IsKeyCache)
+            {
+                for (auto const& item : partition)
+                {
+                    if (item.second.isCached())
+                        --m_cache_count;
+                }
+            }
+            partition.clear();
+        }
+    }
+
     void
     collect_metrics()
     {
@@ -546,10 +684,10 @@ private:
         {
             beast::insight::Gauge::value_type hit_rate(0);
             {
-                std::lock_guard lock(m_mutex);
-                auto const total(m_hits + m_misses);
+                auto const hits = m_hits.load();
+                auto const total(hits + m_misses);
                 if (total != 0)
-                    hit_rate = (m_hits * 100) / total;
+                    hit_rate = (hits * 100) / total;
             }
             m_stats.hit_rate.set(hit_rate);
         }
@@ -575,8 +713,8 @@ private:
         beast::insight::Gauge size;
         beast::insight::Gauge hit_rate;
 
-        std::size_t hits;
-        std::size_t misses;
+        std::atomic<std::size_t> hits;
+        std::atomic<std::size_t> misses;
     };
 
     class KeyOnlyEntry
@@ -599,13 +737,13 @@ private:
     class ValueEntry
     {
     public:
-        std::shared_ptr<mapped_type> ptr;
-        std::weak_ptr<mapped_type> weak_ptr;
+        SharedPointerType ptr;
+        WeakPointerType weak_ptr;
         clock_type::time_point last_access;
 
         ValueEntry(
             clock_type::time_point const& last_access_,
-            std::shared_ptr<mapped_type> const& ptr_)
+            SharedPointerType const& ptr_)
             : ptr(ptr_), weak_ptr(ptr_), last_access(last_access_)
         {
         }
@@ -625,7 +763,7 @@ private:
         {
             return weak_ptr.expired();
         }
-        std::shared_ptr<mapped_type>
+        SharedPointerType
         lock()
         {
             return weak_ptr.lock();
@@ -650,19 +788,32 @@ private:
     using cache_type =
         hardened_partitioned_hash_map<key_type, Entry, Hash, KeyEqual>;
 
+    // The lock and clock hand of a partition, kept apart from those of the
+    // other partitions to avoid false sharing.
+    struct alignas(64) Partition
+    {
+        std::mutex mutex;
+        std::size_t hand = 0;
+    };
+
+    // Buckets visited by the clock hand on each insertion
+    static constexpr std::size_t handStep = 8;
+
     [[nodiscard]] std::thread
     sweepHelper(
         clock_type::time_point const& when_expire,
         [[maybe_unused]] clock_type::time_point const& now,
         typename KeyValueCacheType::map_type& partition,
+        std::mutex& mutex,
         SweptPointersVector& stuffToSweep,
-        std::atomic<int>& allRemovals,
-        std::lock_guard<std::recursive_mutex> const&)
+        std::atomic<int>& allRemovals)
     {
         return std::thread([&, this]() {
             int cacheRemovals = 0;
             int mapRemovals = 0;
 
+            std::lock_guard lock(mutex);
+
             // Keep references to all the stuff we sweep
             // so that we can destroy them outside the lock.
             stuffToSweep.first.reserve(partition.size());
@@ -729,14 +880,16 @@ private:
         clock_type::time_point const& when_expire,
         clock_type::time_point const& now,
         typename KeyOnlyCacheType::map_type& partition,
+        std::mutex& mutex,
         SweptPointersVector&,
-        std::atomic<int>& allRemovals,
-        std::lock_guard<std::recursive_mutex> const&)
+        std::atomic<int>& allRemovals)
     {
         return std::thread([&, this]() {
             int cacheRemovals = 0;
             int mapRemovals = 0;
 
+            std::lock_guard lock(mutex);
+
             // Keep references to all the stuff we sweep
             // so that we can destroy them outside the lock.
             {
@@ -775,22 +928,24 @@ private:
     clock_type& m_clock;
     Stats m_stats;
 
+    // Held only by callers, to make a sequence of operations atomic
     mutex_type mutable m_mutex;
 
     // Used for logging
     std::string m_name;
 
     // Desired number of cache entries (0 = ignore)
-    int m_target_size;
+    std::atomic<int> m_target_size;
 
     // Desired maximum cache age
-    clock_type::duration m_target_age;
+    std::atomic<clock_type::duration> m_target_age;
 
     // Number of items cached
-    int m_cache_count;
-    cache_type m_cache;  // Hold strong reference to recent objects
-    std::uint64_t m_hits;
-    std::uint64_t m_misses;
+    std::atomic<int> m_cache_count;
+    cache_type mutable m_cache;  // Hold strong reference to recent objects
+    std::unique_ptr<Partition[]> m_partitions;
+    std::atomic<std::uint64_t> m_hits;
+    std::atomic<std::uint64_t> m_misses;
 };
 
 }  // namespace ripple
@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/parallel.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <string>
+
+namespace ripple {
+namespace detail {
+
+ParallelPool&
+ParallelPool::instance()
+{
+    static ParallelPool pool(
+        std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+ParallelPool::ParallelPool(std::size_t threads)
+{
+    threads_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        threads_.emplace_back(&ParallelPool::helper, this, i);
+}
+
+ParallelPool::~ParallelPool()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_)
+        t.join();
+}
+
+bool
+ParallelPool::Batch::work()
+{
+    auto const i = next++;
+    if (i >= n)
+        return false;
+
+    std::exception_ptr e;
+    try
+    {
+        task(i);
+    }
+    catch (...)
+    {
+        e = std::current_exception();
+    }
+
+    std::lock_guard lock(mutex);
+    if (e && !error)
+        error = e;
+    if (++done == n)
+        cv.notify_all();
+    return true;
+}
+
+void
+ParallelPool::run(std::size_t n, std::function<void(std::size_t)> task)
+{
+    if (n == 1)
+        task(0);
+    else if (n != 0)
+        finish(start(n, std::move(task)));
+}
+
+std::shared_ptr<ParallelPool::Batch>
+ParallelPool::start(std::size_t n, std::function<void(std::size_t)> task)
+{
+    auto const batch = std::make_shared<Batch>(std::move(task), n);
+    if (n > 0 && !threads_.empty())
+    {
+        {
+            std::lock_guard lock(mutex_);
+            batches_.push_back(batch);
+        }
+        if (n >= threads_.size())
+            cv_.notify_all();
+        else
+            for (std::size_t i = 0; i < n; ++i)
+                cv_.notify_one();
+    }
+    return batch;
+}
+
+void
+ParallelPool::finish(std::shared_ptr<Batch> const& batch)
+{
+    while (batch->work())
+        ;
+
+    {
+        std::lock_guard lock(mutex_);
+        batches_.remove(batch);
+    }
+
+    // Wait for the tasks started by helpers
+    std::unique_lock lock(batch->mutex);
+    batch->cv.wait(lock, [&batch] { return batch->done == batch->n; });
+    if (batch->error)
+        std::rethrow_exception(batch->error);
+}
+
+void
+ParallelPool::helper(std::size_t index)
+{
+    beast::setCurrentThreadName("parallel #" + std::to_string(index));
+
+    std::unique_lock lock(mutex_);
+    for (;;)
+    {
+        // Hold on to the batch: its caller may finish and remove it while
+        // this thread runs one of its tasks.
+        std::shared_ptr<Batch> batch;
+        cv_.wait(lock, [this, &batch] {
+            for (auto const& b : batches_)
+            {
+                if (b->next < b->n)
+                {
+                    batch = b;
+                    return true;
+                }
+            }
+            return stop_;
+        });
+        if (!batch)
+            return;
+
+        lock.unlock();
+        while (batch->work())
+            ;
+        lock.lock();
+    }
+}
+
+}  // namespace detail
+}  // namespace ripple
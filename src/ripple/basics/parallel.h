@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_PARALLEL_H_INCLUDED
+#define RIPPLE_BASICS_PARALLEL_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace detail {
+
+/** A fixed set of threads, shared by the process, that help run tasks.
+
+    The thread calling run() works on its own tasks too, and only waits for
+    those a helper has already started. So a call makes progress even when
+    every helper is busy, and a task may itself call run().
+*/
+class ParallelPool
+{
+public:
+    /** The pool, with one thread less than there are hardware threads. */
+    static ParallelPool&
+    instance();
+
+    explicit ParallelPool(std::size_t threads);
+
+    ParallelPool(ParallelPool const&) = delete;
+    ParallelPool&
+    operator=(ParallelPool const&) = delete;
+
+    ~ParallelPool();
+
+    /** Call task(i) for each i in [0, n) and wait for all of them.
+
+        If tasks throw, the first exception is rethrown here once every
+        started task is done.
+    */
+    void
+    run(std::size_t n, std::function<void(std::size_t)> task);
+
+    struct Batch;
+
+    /** Start calling task(i) for each i in [0, n) on the pool's threads.
+
+        Returns without waiting. finish() must be called on the result,
+        anything the task refers to must outlive that call.
+    */
+    std::shared_ptr<Batch>
+    start(std::size_t n, std::function<void(std::size_t)> task);
+
+    /** Run the tasks of a started batch that no thread has begun, then wait
+        for the others. Rethrows the first exception thrown by a task.
+    */
+    void
+    finish(std::shared_ptr<Batch> const& batch);
+
+    std::size_t
+    size() const
+    {
+        return threads_.size();
+    }
+
+    struct Batch
+    {
+        std::function<void(std::size_t)> const task;
+        std::size_t const n;
+        std::atomic<std::size_t> next{0};
+        std::size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        Batch(std::function<void(std::size_t)> task_, std::size_t n_)
+            : task(std::move(task_)), n(n_)
+        {
+        }
+
+        // Run the next task, if any. Returns false once none are left.
+        bool
+        work();
+    };
+
+private:
+    void
+    helper(std::size_t index);
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::list<std::shared_ptr<Batch>> batches_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace detail
+
+/** Split [0, n) into slices and call f(begin, end) for each of them.
+
+    Slices hold at least minSlice items, and there are no more of them than
+    there are hardware threads. The calling thread works on the slices along
+    with the threads of a pool shared by the process. Returns once every
+    slice is done, rethrowing the first exception thrown by f.
+
+    Meant for short bursts of CPU bound work on data already in hand, where
+    handing the work to the JobQueue would risk waiting on jobs queued behind
+    the caller.
+*/
+template <class F>
+void
+forEachSlice(std::size_t n, std::size_t minSlice, F const& f)
+{
+    if (n == 0)
+        return;
+
+    auto& pool = detail::ParallelPool::instance();
+    std::size_t const slices = std::clamp<std::size_t>(
+        n / std::max<std::size_t>(minSlice, 1), 1, pool.size() + 1);
+    std::size_t const perSlice = (n + slices - 1) / slices;
+
+    pool.run((n + perSlice - 1) / perSlice, [&](std::size_t slice) {
+        auto const begin = slice * perSlice;
+        f(begin, std::min(n, begin + perSlice));
+    });
+}
+
+/** Call f(i) for each i in [0, n), on up to the given number of threads.
+
+    Unlike forEachSlice, items are handed out one at a time to whichever
+    thread is free, so that items of very uneven cost keep all the threads
+    busy. The calling thread is one of them, the others come from the pool
+    used by forEachSlice.
+
+    If f throws, the items not yet started are skipped and the exception is
+    rethrown once every thread is done.
+*/
+template <class F>
+void
+forEachIndex(std::size_t n, std::size_t threads, F const& f)
+{
+    if (n == 0)
+        return;
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+
+    detail::ParallelPool::instance().run(
+        std::clamp<std::size_t>(threads, 1, n), [&](std::size_t) {
+            try
+            {
+                for (auto i = next++; i < n && !failed; i = next++)
+                    f(i);
+            }
+            catch (...)
+            {
+                failed = true;
+                throw;
+            }
+        });
+}
+
+}  // namespace ripple
+
+#endif
@@ -239,6 +239,9 @@ public:
     // Enable the experimental Ledger Replay functionality
     bool LEDGER_REPLAY = false;
 
+    // Exchange relayed transactions with peers in batches
+    bool TX_BATCH = false;
+
     // Work queue limits
     int MAX_TRANSACTIONS = 1000;
     static constexpr int MAX_JOB_QUEUE_TX = 1000;
@@ -251,6 +254,7 @@ public:
     int WORKERS = 0;           // jobqueue thread count. default: upto 6
     int IO_WORKERS = 0;        // io svc thread count. default: 2
     int PREFETCH_WORKERS = 0;  // prefetch thread count. default: 4
+    int FLUSH_WORKERS = 0;     // ledger flush thread count. default: 0 (serial)
 
     // Can only be set in code, specifically unit tests
     bool FORCE_MULTI_THREAD = false;
@@ -307,6 +311,14 @@ public:
     // First, attempt to load the latest ledger directly from disk.
     bool FAST_LOAD = false;
 
+    // Number of executions after which a hook is compiled to native code.
+    // Zero disables the native tier and all hooks are interpreted.
+    std::uint64_t HOOK_AOT_THRESHOLD = 0;
+
+    // Worker threads pre-executing transactions while a ledger is built.
+    // Zero applies every transaction serially.
+    std::size_t HOOK_SPECULATIVE_THREADS = 0;
+
 public:
     Config();
 
@@ -55,6 +55,7 @@ struct ConfigSection
 #define SECTION_ELB_SUPPORT "elb_support"
 #define SECTION_FEE_DEFAULT "fee_default"
 #define SECTION_FETCH_DEPTH "fetch_depth"
+#define SECTION_HOOKS "hooks"
 #define SECTION_HISTORICAL_SHARD_PATHS "historical_shard_paths"
 #define SECTION_INSIGHT "insight"
 #define SECTION_IPS "ips"
@@ -96,7 +97,9 @@ struct ConfigSection
 #define SECTION_WORKERS "workers"
 #define SECTION_IO_WORKERS "io_workers"
 #define SECTION_PREFETCH_WORKERS "prefetch_workers"
+#define SECTION_FLUSH_WORKERS "flush_workers"
 #define SECTION_LEDGER_REPLAY "ledger_replay"
+#define SECTION_TX_BATCH "tx_batch"
 #define SECTION_BETA_RPC_API "beta_rpc_api"
 #define SECTION_SWEEP_INTERVAL "sweep_interval"
 #define SECTION_NETWORK_ID "network_id"
@@ -102,9 +102,11 @@ JobQueue::Coro::resume()
     }
     auto saved = detail::getLocalValues().release();
     detail::getLocalValues().reset(&lvs_);
+    auto const savedArena = Json::Arena::exchange(arena_);
     std::lock_guard lock(mutex_);
     assert(coro_);
     coro_();
+    arena_ = Json::Arena::exchange(savedArena);
     detail::getLocalValues().release();
     detail::getLocalValues().reset(saved);
     std::lock_guard lk(mutex_run_);
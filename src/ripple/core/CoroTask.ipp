@@ -0,0 +1,165 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_COROTASK_H_INCLUDED
+#define RIPPLE_CORE_COROTASK_H_INCLUDED
+
+namespace ripple {
+
+template <class F>
+JobQueue::CoroTask::CoroTask(
+    Coro_create_t,
+    JobQueue& jq,
+    JobType type,
+    std::string const& name,
+    F&& f)
+    : jq_(jq)
+    , type_(type)
+    , name_(name)
+    , running_(false)
+    , fn_(std::forward<F>(f))
+{
+    // Counted as suspended until first resumed, as a Coro is
+    std::lock_guard lock(jq_.m_mutex);
+    ++jq_.nSuspend_;
+}
+
+inline JobQueue::CoroTask::~CoroTask()
+{
+    assert(finished_);
+}
+
+inline void
+JobQueue::CoroTask::Yield::await_suspend(std::coroutine_handle<> h) const
+{
+    coro_.suspended_ = h;
+    std::lock_guard lock(coro_.jq_.m_mutex);
+    ++coro_.jq_.nSuspend_;
+}
+
+inline JobQueue::CoroTask::Yield
+JobQueue::CoroTask::yield() const
+{
+    return Yield{*this};
+}
+
+inline bool
+JobQueue::CoroTask::post()
+{
+    {
+        std::lock_guard lk(mutex_run_);
+        running_ = true;
+    }
+
+    // sp keeps 'this' alive
+    if (jq_.addJob(
+            type_, name_, [this, sp = shared_from_this()]() { resume(); }))
+    {
+        return true;
+    }
+
+    // The coroutine will not run.  Clean up running_.
+    std::lock_guard lk(mutex_run_);
+    running_ = false;
+    cv_.notify_all();
+    return false;
+}
+
+inline void
+JobQueue::CoroTask::resume()
+{
+    {
+        std::lock_guard lk(mutex_run_);
+        running_ = true;
+    }
+    {
+        std::lock_guard lock(jq_.m_mutex);
+        --jq_.nSuspend_;
+    }
+    auto saved = detail::getLocalValues().release();
+    detail::getLocalValues().reset(&lvs_);
+    auto const savedArena = Json::Arena::exchange(arena_);
+    std::exception_ptr exception;
+    {
+        // As with a Coro, a resume() racing with the coroutine still on its
+        // way to suspending waits here until it has suspended.
+        std::lock_guard lock(mutex_);
+        assert(!finished_);
+        if (!body_)
+        {
+            body_.emplace(fn_(shared_from_this()));
+            suspended_ = body_->handle_;
+        }
+        std::exchange(suspended_, {}).resume();
+        if (body_->handle_.done())
+        {
+            exception = body_->handle_.promise().exception;
+            body_.reset();
+            fn_ = nullptr;
+            finished_ = true;
+        }
+    }
+    arena_ = Json::Arena::exchange(savedArena);
+    detail::getLocalValues().release();
+    detail::getLocalValues().reset(saved);
+    {
+        std::lock_guard lk(mutex_run_);
+        running_ = false;
+        cv_.notify_all();
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+inline bool
+JobQueue::CoroTask::runnable() const
+{
+    return !finished_;
+}
+
+inline void
+JobQueue::CoroTask::expectEarlyExit()
+{
+    if (!finished_)
+    {
+        // Only ever called from outside the coroutine, which is suspended
+        // and will not be resumed again. Its frame holds a reference to us,
+        // so destroy it now.
+        {
+            std::lock_guard lock(mutex_);
+            suspended_ = {};
+            body_.reset();
+            fn_ = nullptr;
+        }
+        std::lock_guard lock(jq_.m_mutex);
+        --jq_.nSuspend_;
+        finished_ = true;
+    }
+}
+
+inline void
+JobQueue::CoroTask::join()
+{
+    std::unique_lock<std::mutex> lk(mutex_run_);
+    cv_.wait(lk, [this]() { return running_ == false; });
+}
+
+}  // namespace ripple
+
+#endif
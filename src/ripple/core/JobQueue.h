@@ -25,10 +25,19 @@
 #include <ripple/core/JobTypeData.h>
 #include <ripple/core/JobTypes.h>
 #include <ripple/core/impl/Workers.h>
+#include <ripple/json/json_arena.h>
 #include <ripple/json/json_value.h>
 #include <boost/coroutine/all.hpp>
 #include <boost/range/begin.hpp>  // workaround for boost 1.72 bug
 #include <boost/range/end.hpp>    // workaround for boost 1.72 bug
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -42,6 +51,94 @@ struct Coro_create_t
     explicit Coro_create_t() = default;
 };
 
+namespace detail {
+
+// The part of the promise of a JobQueue::CoroTask::Task that does not depend
+// on its result.
+struct CoroTaskPromise
+{
+    std::exception_ptr exception;
+    // The coroutine awaiting this one, resumed once this one completes
+    std::coroutine_handle<> continuation;
+
+    struct FinalAwaiter
+    {
+        bool
+        await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<Promise> h) const noexcept
+        {
+            if (auto next = h.promise().continuation)
+                return next;
+            return std::noop_coroutine();
+        }
+
+        void
+        await_resume() const noexcept
+        {
+        }
+    };
+
+    // Runs only when first resumed or awaited
+    std::suspend_always
+    initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    // Keeps the frame until its owner has seen it complete
+    FinalAwaiter
+    final_suspend() noexcept
+    {
+        return {};
+    }
+
+    void
+    unhandled_exception() noexcept
+    {
+        exception = std::current_exception();
+    }
+};
+
+template <class T>
+struct CoroTaskValue : CoroTaskPromise
+{
+    std::optional<T> value;
+
+    // Taken by value so that `co_return {};` works as `return {};` would
+    void
+    return_value(T v)
+    {
+        value.emplace(std::move(v));
+    }
+
+    T
+    take()
+    {
+        return std::move(*value);
+    }
+};
+
+struct CoroTaskVoid : CoroTaskPromise
+{
+    void
+    return_void() noexcept
+    {
+    }
+
+    void
+    take() noexcept
+    {
+    }
+};
+
+}  // namespace detail
+
 /** A pool of threads to perform work.
 
     A job posted will always run to completion.
@@ -60,6 +157,8 @@ public:
     {
     private:
         detail::LocalValues lvs_;
+        // the Json::Arena the coroutine was using when it last suspended
+        Json::Arena* arena_ = nullptr;
         JobQueue& jq_;
         JobType type_;
         std::string name_;
@@ -138,6 +237,185 @@ public:
         join();
     };
 
+    /** A stackless coroutine, run by the JobQueue like a Coro.
+
+        The function it runs is a C++20 coroutine returning a CoroTask::Body.
+        It takes the std::shared_ptr<CoroTask> by value, and suspends with
+        `co_await coro->yield()`, directly or from a CoroTask::Task it
+        awaits. While suspended only the coroutine frames are kept, instead
+        of a whole stack as with a Coro.
+
+        Otherwise the two behave the same. See Coro for the meaning of each
+        member function.
+    */
+    class CoroTask : public std::enable_shared_from_this<CoroTask>
+    {
+    public:
+        /** The return type of a coroutine run by a CoroTask.
+
+            A Task starts when it is first resumed or awaited. Awaiting it
+            gives its result once it completes, or rethrows what it threw.
+            So the function run by a CoroTask may await other coroutines,
+            and any of them may suspend the CoroTask with
+            `co_await coro->yield()`.
+        */
+        template <class T = void>
+        class Task
+        {
+        public:
+            struct promise_type : std::conditional_t<
+                                      std::is_void_v<T>,
+                                      detail::CoroTaskVoid,
+                                      detail::CoroTaskValue<T>>
+            {
+                Task
+                get_return_object()
+                {
+                    return Task{
+                        std::coroutine_handle<promise_type>::from_promise(
+                            *this)};
+                }
+            };
+
+            Task(Task&& other) noexcept
+                : handle_(std::exchange(other.handle_, {}))
+            {
+            }
+
+            Task&
+            operator=(Task&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (handle_)
+                        handle_.destroy();
+                    handle_ = std::exchange(other.handle_, {});
+                }
+                return *this;
+            }
+
+            ~Task()
+            {
+                if (handle_)
+                    handle_.destroy();
+            }
+
+            bool
+            await_ready() const noexcept
+            {
+                return false;
+            }
+
+            // Runs this coroutine, which resumes the awaiting one when done
+            std::coroutine_handle<>
+            await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle_.promise().continuation = awaiting;
+                return handle_;
+            }
+
+            T
+            await_resume()
+            {
+                if (auto e = handle_.promise().exception)
+                    std::rethrow_exception(e);
+                return handle_.promise().take();
+            }
+
+        private:
+            friend class CoroTask;
+
+            explicit Task(std::coroutine_handle<promise_type> handle)
+                : handle_(handle)
+            {
+            }
+
+            std::coroutine_handle<promise_type> handle_;
+        };
+
+        /** The return type of the function run by a CoroTask. */
+        using Body = Task<>;
+
+        /** What CoroTask::yield() returns, for the coroutine to co_await. */
+        class Yield
+        {
+        public:
+            explicit Yield(CoroTask const& coro) : coro_(coro)
+            {
+            }
+
+            bool
+            await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void
+            await_suspend(std::coroutine_handle<> h) const;
+
+            void
+            await_resume() const noexcept
+            {
+            }
+
+        private:
+            CoroTask const& coro_;
+        };
+
+    private:
+        detail::LocalValues lvs_;
+        // the Json::Arena the coroutine was using when it last suspended
+        Json::Arena* arena_ = nullptr;
+        JobQueue& jq_;
+        JobType type_;
+        std::string name_;
+        bool running_;
+        bool finished_ = false;
+        std::mutex mutex_;
+        std::mutex mutex_run_;
+        std::condition_variable cv_;
+        std::function<Body(std::shared_ptr<CoroTask>)> fn_;
+        std::optional<Body> body_;
+        // The innermost coroutine awaiting yield(), which may be one awaited
+        // by the body rather than the body itself
+        mutable std::coroutine_handle<> suspended_;
+
+    public:
+        // Private: Used in the implementation
+        template <class F>
+        CoroTask(Coro_create_t, JobQueue&, JobType, std::string const&, F&&);
+
+        CoroTask(CoroTask const&) = delete;
+        CoroTask&
+        operator=(CoroTask const&) = delete;
+
+        ~CoroTask();
+
+        /** Suspend coroutine execution, with `co_await coro->yield()`. */
+        Yield
+        yield() const;
+
+        /** Schedule coroutine execution. */
+        bool
+        post();
+
+        /** Resume coroutine execution on this thread. */
+        void
+        resume();
+
+        /** Returns true if the CoroTask has not returned. */
+        bool
+        runnable() const;
+
+        /** Once called, the CoroTask allows early exit without an assert. */
+        void
+        expectEarlyExit();
+
+        /** Waits until coroutine returns from the user function. */
+        void
+        join();
+    };
+
     using JobFunction = std::function<void()>;
 
     JobQueue(
@@ -186,6 +464,22 @@ public:
     std::shared_ptr<Coro>
     postCoro(JobType t, std::string const& name, F&& f);
 
+    /** Creates a stackless coroutine and adds a job to the queue which will
+        run it.
+
+        @param t The type of job.
+        @param name Name of the job.
+        @param f A C++20 coroutine with a signature of
+        CoroTask::Body(std::shared_ptr<CoroTask>). Called when the job
+        executes.
+
+        @return shared_ptr to posted CoroTask. nullptr if post was not
+        successful.
+    */
+    template <class F>
+    std::shared_ptr<CoroTask>
+    postCoroTask(JobType t, std::string const& name, F&& f);
+
     /** Jobs waiting at this priority.
      */
     int
@@ -239,21 +533,40 @@ public:
 
 private:
     friend class Coro;
+    friend class CoroTask;
 
     using JobDataMap = std::map<JobType, JobTypeData>;
 
+    // Jobs waiting to run, indexed by JobType. There is one per worker so
+    // that threads adding and taking jobs rarely contend for a lock: a
+    // worker takes jobs from its own queue first and steals from the others
+    // when that has none of the type it picked.
+    struct alignas(64) RunQueue
+    {
+        std::mutex mutex;
+        std::atomic<int> size{0};
+        std::vector<std::deque<Job>> jobs;
+    };
+
     beast::Journal m_journal;
     mutable std::mutex m_mutex;
-    std::uint64_t m_lastJob;
-    std::set<Job> m_jobSet;
+    std::atomic<std::uint64_t> m_lastJob;
+    std::vector<std::unique_ptr<RunQueue>> m_queues;
+    std::atomic<std::size_t> m_nextQueue{0};
     JobCounter jobCounter_;
     std::atomic_bool stopping_{false};
     std::atomic_bool stopped_{false};
     JobDataMap m_jobData;
     JobTypeData m_invalidJobData;
 
+    // The types that can run, highest priority first
+    std::vector<JobTypeData*> m_runOrder;
+
+    // The number of jobs in the run queues
+    std::atomic<int> m_queued{0};
+
     // The number of jobs currently in processTask()
-    int m_processCount;
+    std::atomic<int> m_processCount;
 
     // The number of suspended coroutines
     int nSuspend_ = 0;
@@ -287,30 +600,47 @@ private:
         std::string const& name,
         JobFunction const& func);
 
+    // Adds a job to one of the run queues: the caller's own if it is one
+    // of our workers, otherwise the next one in turn.
+    void
+    pushJob(Job&& job);
+
+    // Reserves a waiting job of the given type if fewer than its limit are
+    // running.
+    //
+    // Post-conditions:
+    //  On success, the waiting job count of the type is decremented and the
+    //  running job count incremented.
+    //
+    // Invariants:
+    //  <none>
+    bool
+    claimJob(JobTypeData& data);
+
     // Returns the next Job we should run now.
     //
     // RunnableJob:
-    //  A Job in the JobSet whose slots count for its type is greater than zero.
+    //  A waiting Job whose type has fewer running jobs than its limit.
     //
     // Pre-conditions:
-    //  mJobSet must not be empty.
-    //  mJobSet holds at least one RunnableJob
+    //  A task was taken from m_workers, so a RunnableJob exists or will once
+    //  a job being added or finished has been accounted for.
     //
     // Post-conditions:
-    //  job is a valid Job object.
-    //  job is removed from mJobQueue.
+    //  job is a valid Job object of the highest priority RunnableJob type.
+    //  job is removed from the run queues, preferring the queue of slot.
     //  Waiting job count of its type is decremented
     //  Running job count of its type is incremented
     //
     // Invariants:
-    //  The calling thread owns the JobLock
+    //  <none>
     void
-    getNextJob(Job& job);
+    getNextJob(Job& job, std::size_t slot);
 
     // Indicates that a running Job has completed its task.
     //
     // Pre-conditions:
-    //  Job must not exist in mJobSet.
+    //  Job must not be in a run queue.
     //  The JobType must not be invalid.
     //
     // Post-conditions:
@@ -326,7 +656,7 @@ private:
     // Runs the next appropriate waiting Job.
     //
     // Pre-conditions:
-    //  A RunnableJob must exist in the JobSet
+    //  A task was taken from m_workers
     //
     // Post-conditions:
     //  The chosen RunnableJob will have Job::doJob() called.
@@ -403,6 +733,7 @@ private:
 }  // namespace ripple
 
 #include <ripple/core/Coro.ipp>
+#include <ripple/core/CoroTask.ipp>
 
 namespace ripple {
 
@@ -426,6 +757,20 @@ JobQueue::postCoro(JobType t, std::string const& name, F&& f)
     return coro;
 }
 
+template <class F>
+std::shared_ptr<JobQueue::CoroTask>
+JobQueue::postCoroTask(JobType t, std::string const& name, F&& f)
+{
+    auto coro = std::make_shared<CoroTask>(
+        Coro_create_t{}, *this, t, name, std::forward<F>(f));
+    if (!coro->post())
+    {
+        coro->expectEarlyExit();
+        coro.reset();
+    }
+    return coro;
+}
+
 }  // namespace ripple
 
 #endif
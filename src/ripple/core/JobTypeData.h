@@ -23,6 +23,9 @@
 #include <ripple/basics/Log.h>
 #include <ripple/beast/insight/Collector.h>
 #include <ripple/core/JobTypeInfo.h>
+#include <atomic>
+#include <limits>
+#include <mutex>
 
 namespace ripple {
 
@@ -39,13 +42,16 @@ public:
     JobTypeInfo const& info;
 
     /* The number of jobs waiting */
-    int waiting;
+    std::atomic<int> waiting;
 
     /* The number presently running */
-    int running;
+    std::atomic<int> running;
 
     /* And the number we deferred executing because of job limits */
-    int deferred;
+    std::atomic<int> deferred;
+
+    /* Serializes the counts above for a type with a limit */
+    std::mutex mutex;
 
     /* Notification callbacks */
     beast::insight::Event dequeue;
@@ -89,6 +95,12 @@ public:
         return info.type();
     }
 
+    bool
+    limited() const
+    {
+        return info.limit() != std::numeric_limits<int>::max();
+    }
+
     LoadMonitor&
     load()
     {
@@ -710,12 +710,25 @@ Config::loadFromString(std::string const& fileContents)
                 ": must be between 1 and 1024 inclusive.");
     }
 
+    if (getSingleSection(secConfig, SECTION_FLUSH_WORKERS, strTemp, j_))
+    {
+        FLUSH_WORKERS = beast::lexicalCastThrow<int>(strTemp);
+
+        if (FLUSH_WORKERS < 1 || FLUSH_WORKERS > 1024)
+            Throw<std::runtime_error>(
+                "Invalid " SECTION_FLUSH_WORKERS
+                ": must be between 1 and 1024 inclusive.");
+    }
+
     if (getSingleSection(secConfig, SECTION_COMPRESSION, strTemp, j_))
         COMPRESSION = beast::lexicalCastThrow<bool>(strTemp);
 
     if (getSingleSection(secConfig, SECTION_LEDGER_REPLAY, strTemp, j_))
         LEDGER_REPLAY = beast::lexicalCastThrow<bool>(strTemp);
 
+    if (getSingleSection(secConfig, SECTION_TX_BATCH, strTemp, j_))
+        TX_BATCH = beast::lexicalCastThrow<bool>(strTemp);
+
     if (exists(SECTION_REDUCE_RELAY))
     {
         auto sec = section(SECTION_REDUCE_RELAY);
@@ -734,6 +747,37 @@ Config::loadFromString(std::string const& fileContents)
                 "and less or equal to 100");
     }
 
+    if (exists(SECTION_HOOKS))
+    {
+        auto const sec = section(SECTION_HOOKS);
+
+        try
+        {
+            if (auto val = sec.get("aot_threshold"))
+                HOOK_AOT_THRESHOLD =
+                    beast::lexicalCastThrow<std::uint64_t>(*val);
+        }
+        catch (...)
+        {
+            Throw<std::runtime_error>(
+                "Invalid value 'aot_threshold' in " SECTION_HOOKS
+                ": must be of the form '<number>' of executions.");
+        }
+
+        try
+        {
+            if (auto val = sec.get("speculative_threads"))
+                HOOK_SPECULATIVE_THREADS =
+                    beast::lexicalCastThrow<std::size_t>(*val);
+        }
+        catch (...)
+        {
+            Throw<std::runtime_error>(
+                "Invalid value 'speculative_threads' in " SECTION_HOOKS
+                ": must be of the form '<number>' of threads.");
+        }
+    }
+
     if (getSingleSection(secConfig, SECTION_MAX_TRANSACTIONS, strTemp, j_))
     {
         MAX_TRANSACTIONS = std::clamp(
@@ -20,10 +20,25 @@
 #include <ripple/basics/PerfLog.h>
 #include <ripple/basics/contract.h>
 #include <ripple/core/JobQueue.h>
+#include <algorithm>
 #include <mutex>
+#include <thread>
 
 namespace ripple {
 
+namespace {
+
+// The run queue a thread takes its jobs from, if it is a worker of owner
+struct WorkerSlot
+{
+    JobQueue const* owner = nullptr;
+    std::size_t slot = 0;
+};
+
+thread_local WorkerSlot currentWorker;
+
+}  // namespace
+
 JobQueue::JobQueue(
     int threadCount,
     beast::insight::Collector::ptr const& collector,
@@ -58,6 +73,22 @@ JobQueue::JobQueue(
             assert(result.second == true);
             (void)result.second;
         }
+
+        for (auto iter = m_jobData.rbegin(); iter != m_jobData.rend(); ++iter)
+        {
+            if (!iter->second.info.special())
+                m_runOrder.push_back(&iter->second);
+        }
+    }
+
+    auto const types = static_cast<std::size_t>(m_jobData.rbegin()->first) + 1;
+    auto const queues = static_cast<std::size_t>(std::max(threadCount, 1));
+    m_queues.reserve(queues);
+    for (std::size_t i = 0; i < queues; ++i)
+    {
+        auto queue = std::make_unique<RunQueue>();
+        queue->jobs.resize(types);
+        m_queues.push_back(std::move(queue));
     }
 }
 
@@ -70,8 +101,7 @@ JobQueue::~JobQueue()
 void
 JobQueue::collect()
 {
-    std::lock_guard lock(m_mutex);
-    job_count = m_jobSet.size();
+    job_count = m_queued.load();
 }
 
 bool
@@ -97,48 +127,57 @@ JobQueue::addRefCountedJob(
         (type >= jtCLIENT && type <= jtCLIENT_WEBSOCKET) ||
         m_workers.getNumberOfThreads() > 0);
 
-    {
-        std::lock_guard lock(m_mutex);
-        auto result =
-            m_jobSet.emplace(type, name, ++m_lastJob, data.load(), func);
-        auto const& job = *result.first;
-
-        JobType const type(job.getType());
-        assert(type != jtINVALID);
-        assert(m_jobSet.find(job) != m_jobSet.end());
-        perfLog_.jobQueue(type);
+    pushJob(Job(type, name, ++m_lastJob, data.load(), func));
+    perfLog_.jobQueue(type);
 
-        JobTypeData& data(getJobTypeData(type));
-
-        if (data.waiting + data.running < getJobLimit(type))
-        {
-            m_workers.addTask();
-        }
-        else
-        {
-            // defer the task until we go below the limit
-            ++data.deferred;
-        }
+    // The job is counted as waiting only once it can be taken from a run
+    // queue, and before a worker is woken to take it.
+    if (!data.limited())
+    {
         ++data.waiting;
+        m_workers.addTask();
+        return true;
     }
+
+    std::lock_guard lock(data.mutex);
+    if (data.waiting + data.running < getJobLimit(type))
+    {
+        m_workers.addTask();
+    }
+    else
+    {
+        // defer the task until we go below the limit
+        ++data.deferred;
+    }
+    ++data.waiting;
     return true;
 }
 
+void
+JobQueue::pushJob(Job&& job)
+{
+    auto const slot = currentWorker.owner == this
+        ? currentWorker.slot
+        : m_nextQueue++ % m_queues.size();
+    RunQueue& queue = *m_queues[slot];
+
+    ++m_queued;
+    std::lock_guard lock(queue.mutex);
+    queue.jobs[job.getType()].push_back(std::move(job));
+    ++queue.size;
+}
+
 int
 JobQueue::getJobCount(JobType t) const
 {
-    std::lock_guard lock(m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find(t);
 
-    return (c == m_jobData.end()) ? 0 : c->second.waiting;
+    return (c == m_jobData.end()) ? 0 : c->second.waiting.load();
 }
 
 int
 JobQueue::getJobCountTotal(JobType t) const
 {
-    std::lock_guard lock(m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find(t);
 
     return (c == m_jobData.end()) ? 0 : (c->second.waiting + c->second.running);
@@ -150,8 +189,6 @@ JobQueue::getJobCountGE(JobType t) const
     // return the number of jobs at this priority level or greater
     int ret = 0;
 
-    std::lock_guard lock(m_mutex);
-
     for (auto const& x : m_jobData)
     {
         if (x.first >= t)
@@ -202,8 +239,6 @@ JobQueue::getJson(int c)
 
     Json::Value priorities = Json::arrayValue;
 
-    std::lock_guard lock(m_mutex);
-
     for (auto& x : m_jobData)
     {
         assert(x.first != jtINVALID);
@@ -254,7 +289,7 @@ void
 JobQueue::rendezvous()
 {
     std::unique_lock<std::mutex> lock(m_mutex);
-    cv_.wait(lock, [this] { return m_processCount == 0 && m_jobSet.empty(); });
+    cv_.wait(lock, [this] { return m_processCount == 0 && m_queued == 0; });
 }
 
 JobTypeData&
@@ -285,9 +320,9 @@ JobQueue::stop()
         // we must wait on the condition variable to make these assertions.
         std::unique_lock<std::mutex> lock(m_mutex);
         cv_.wait(
-            lock, [this] { return m_processCount == 0 && m_jobSet.empty(); });
+            lock, [this] { return m_processCount == 0 && m_queued == 0; });
         assert(m_processCount == 0);
-        assert(m_jobSet.empty());
+        assert(m_queued == 0);
         assert(nSuspend_ == 0);
         stopped_ = true;
     }
@@ -299,33 +334,80 @@ JobQueue::isStopped() const
     return stopped_;
 }
 
-void
-JobQueue::getNextJob(Job& job)
+bool
+JobQueue::claimJob(JobTypeData& data)
 {
-    assert(!m_jobSet.empty());
+    if (data.waiting.load(std::memory_order_relaxed) <= 0)
+        return false;
 
-    std::set<Job>::const_iterator iter;
-    for (iter = m_jobSet.begin(); iter != m_jobSet.end(); ++iter)
+    if (data.limited())
     {
-        JobType const type = iter->getType();
-        assert(type != jtINVALID);
-
-        JobTypeData& data(getJobTypeData(type));
-        assert(data.running <= getJobLimit(type));
+        std::lock_guard lock(data.mutex);
+        assert(data.running <= getJobLimit(data.type()));
 
         // Run this job if we're running below the limit.
-        if (data.running < getJobLimit(data.type()))
+        if (data.waiting == 0 || data.running >= getJobLimit(data.type()))
+            return false;
+
+        --data.waiting;
+        ++data.running;
+        return true;
+    }
+
+    int waiting = data.waiting.load();
+    do
+    {
+        if (waiting <= 0)
+            return false;
+    } while (!data.waiting.compare_exchange_weak(waiting, waiting - 1));
+
+    ++data.running;
+    return true;
+}
+
+void
+JobQueue::getNextJob(Job& job, std::size_t slot)
+{
+    auto const count = m_queues.size();
+
+    for (;;)
+    {
+        for (JobTypeData* data : m_runOrder)
         {
-            assert(data.waiting > 0);
-            --data.waiting;
-            ++data.running;
-            break;
+            if (!claimJob(*data))
+                continue;
+
+            // The claim guarantees that a job of this type is in one of the
+            // run queues until we take it, though another worker may move
+            // it under us by taking one we have already looked at.
+            auto const type = data->type();
+            for (;;)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    RunQueue& queue = *m_queues[(slot + i) % count];
+                    if (queue.size.load(std::memory_order_relaxed) == 0)
+                        continue;
+
+                    std::lock_guard lock(queue.mutex);
+                    auto& jobs = queue.jobs[type];
+                    if (jobs.empty())
+                        continue;
+
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                    --queue.size;
+                    --m_queued;
+                    return;
+                }
+                std::this_thread::yield();
+            }
         }
-    }
 
-    assert(iter != m_jobSet.end());
-    job = *iter;
-    m_jobSet.erase(iter);
+        // The job our task was added for went to another worker, whose own
+        // job has not been counted as waiting yet.
+        std::this_thread::yield();
+    }
 }
 
 void
@@ -335,6 +417,14 @@ JobQueue::finishJob(JobType type)
 
     JobTypeData& data = getJobTypeData(type);
 
+    if (!data.limited())
+    {
+        --data.running;
+        return;
+    }
+
+    std::lock_guard lock(data.mutex);
+
     // Queue a deferred task if possible
     if (data.deferred > 0)
     {
@@ -350,6 +440,9 @@ JobQueue::finishJob(JobType type)
 void
 JobQueue::processTask(int instance)
 {
+    auto const slot = static_cast<std::size_t>(instance) % m_queues.size();
+    currentWorker = {this, slot};
+
     JobType type;
 
     {
@@ -357,11 +450,8 @@ JobQueue::processTask(int instance)
         Job::clock_type::time_point const start_time(Job::clock_type::now());
         {
             Job job;
-            {
-                std::lock_guard lock(m_mutex);
-                getNextJob(job);
-                ++m_processCount;
-            }
+            ++m_processCount;
+            getNextJob(job, slot);
             type = job.getType();
             JobTypeData& data(getJobTypeData(type));
             JLOG(m_journal.trace()) << "Doing " << data.name() << "job";
@@ -386,13 +476,21 @@ JobQueue::processTask(int instance)
         }
     }
 
+    // Job should be destroyed before stopping
+    // otherwise destructors with side effects can access
+    // parent objects that are already destroyed.
+    finishJob(type);
+
+    // The count only drops to zero under the lock, so that a thread waiting
+    // for it can not go on to destroy us while we still use cv_.
+    int count = m_processCount.load();
+    while (count > 1 &&
+           !m_processCount.compare_exchange_weak(count, count - 1))
+        ;
+    if (count <= 1)
     {
         std::lock_guard lock(m_mutex);
-        // Job should be destroyed before stopping
-        // otherwise destructors with side effects can access
-        // parent objects that are already destroyed.
-        finishJob(type);
-        if (--m_processCount == 0 && m_jobSet.empty())
+        if (--m_processCount == 0 && m_queued == 0)
             cv_.notify_all();
     }
 
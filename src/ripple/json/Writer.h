@@ -211,6 +211,10 @@ public:
     void
     output(Json::Value const&);
 
+    /*** Output compact JSON text as is. */
+    void
+    output(Json::RawJson const&);
+
     /** Output a null. */
     void output(std::nullptr_t);
 
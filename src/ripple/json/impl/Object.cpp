@@ -152,6 +152,8 @@ Array::append(Json::Value const& v)
             return append(v.asDouble());
         case Json::stringValue:
             return append(v.asString());
+        case Json::rawValue:
+            return append(Json::RawJson{v.asRawText()});
         case Json::booleanValue:
             return append(v.asBool());
 
@@ -187,6 +189,8 @@ Object::set(std::string const& k, Json::Value const& v)
             return set(k, v.asDouble());
         case Json::stringValue:
             return set(k, v.asString());
+        case Json::rawValue:
+            return set(k, Json::RawJson{v.asRawText()});
         case Json::booleanValue:
             return set(k, v.asBool());
 
@@ -54,6 +54,11 @@ outputJson(Json::Value const& value, Writer& writer)
             break;
         }
 
+        case Json::rawValue: {
+            writer.output(Json::RawJson{value.asRawText()});
+            break;
+        }
+
         case Json::booleanValue: {
             writer.output(value.asBool());
             break;
@@ -273,6 +273,12 @@ Writer::output(Json::Value const& value)
     outputJson(value, impl_->getOutput());
 }
 
+void
+Writer::output(Json::RawJson const& raw)
+{
+    impl_->output({raw.text.data(), raw.text.size()});
+}
+
 void
 Writer::output(float f)
 {
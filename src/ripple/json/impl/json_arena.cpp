@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/json/json_arena.h>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace Json {
+
+namespace {
+
+constexpr std::size_t blockSize = 64 * 1024;
+
+// larger allocations are left to the heap
+constexpr std::size_t maxBlockAllocation = blockSize / 16;
+
+thread_local Arena* currentArena = nullptr;
+
+}  // namespace
+
+struct alignas(std::max_align_t) Arena::Block
+{
+    // Frees minus allocations. The allocations are only added once the
+    // block is retired by its arena, so the count can reach zero no sooner.
+    std::atomic<std::ptrdiff_t> refs{0};
+
+    static void
+    release(Block* block, std::ptrdiff_t count)
+    {
+        if (block->refs.fetch_add(count, std::memory_order_acq_rel) + count ==
+            0)
+        {
+            block->~Block();
+            ::operator delete(block);
+        }
+    }
+};
+
+namespace {
+
+// precedes every allocation, block is null for those made on the heap
+struct alignas(std::max_align_t) Header
+{
+    void* block;
+};
+
+}  // namespace
+
+Arena::Arena() : previous_(exchange(this))
+{
+}
+
+Arena::~Arena()
+{
+    assert(currentArena == this);
+    exchange(previous_);
+    retire();
+}
+
+void
+Arena::retire()
+{
+    if (block_)
+        Block::release(block_, allocated_);
+    block_ = nullptr;
+    next_ = end_ = nullptr;
+    allocated_ = 0;
+}
+
+Arena*
+Arena::current() noexcept
+{
+    return currentArena;
+}
+
+Arena*
+Arena::exchange(Arena* arena) noexcept
+{
+    return std::exchange(currentArena, arena);
+}
+
+void*
+Arena::allocate(std::size_t bytes)
+{
+    constexpr std::size_t align = alignof(std::max_align_t);
+    std::size_t const size =
+        sizeof(Header) + (bytes + align - 1) / align * align;
+
+    auto const a = currentArena;
+    if (!a || size > maxBlockAllocation)
+    {
+        auto h = ::new (::operator new(size)) Header{nullptr};
+        return h + 1;
+    }
+
+    if (static_cast<std::size_t>(a->end_ - a->next_) < size)
+    {
+        a->retire();
+        auto const p = static_cast<char*>(::operator new(blockSize));
+        a->block_ = ::new (p) Block;
+        a->next_ = p + sizeof(Block);
+        a->end_ = p + blockSize;
+    }
+
+    auto h = ::new (a->next_) Header{a->block_};
+    a->next_ += size;
+    ++a->allocated_;
+    return h + 1;
+}
+
+void
+Arena::deallocate(void* p) noexcept
+{
+    if (!p)
+        return;
+
+    auto const h = static_cast<Header*>(p) - 1;
+    if (h->block)
+        Block::release(static_cast<Block*>(h->block), -1);
+    else
+        ::operator delete(h);
+}
+
+}  // namespace Json
@@ -22,6 +22,7 @@
 #include <ripple/json/impl/json_assert.h>
 #include <ripple/json/json_writer.h>
 #include <ripple/json/to_string.h>
+#include <memory>
 
 namespace Json {
 
@@ -58,7 +59,7 @@ public:
         if (length == unknown)
             length = value ? (unsigned int)strlen(value) : 0;
 
-        char* newString = static_cast<char*>(malloc(length + 1));
+        char* newString = static_cast<char*>(Arena::allocate(length + 1));
         if (value)
             memcpy(newString, value, length);
         newString[length] = 0;
@@ -68,11 +69,33 @@ public:
     void
     releaseStringValue(char* value) override
     {
-        if (value)
-            free(value);
+        Arena::deallocate(value);
     }
 };
 
+template <class... Args>
+static Value::ObjectValues*
+makeObjectValues(Args&&... args)
+{
+    void* p = Arena::allocate(sizeof(Value::ObjectValues));
+    try
+    {
+        return ::new (p) Value::ObjectValues(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        Arena::deallocate(p);
+        throw;
+    }
+}
+
+static void
+destroyObjectValues(Value::ObjectValues* map)
+{
+    std::destroy_at(map);
+    Arena::deallocate(map);
+}
+
 static ValueAllocator*&
 valueAllocator()
 {
@@ -194,12 +217,13 @@ Value::Value(ValueType type) : type_(type), allocated_(0)
             break;
 
         case stringValue:
+        case rawValue:
             value_.string_ = 0;
             break;
 
         case arrayValue:
         case objectValue:
-            value_.map_ = new ObjectValues();
+            value_.map_ = makeObjectValues();
             break;
 
         case booleanValue:
@@ -237,6 +261,12 @@ Value::Value(std::string const& value) : type_(stringValue), allocated_(true)
         value.c_str(), (unsigned int)value.length());
 }
 
+Value::Value(RawJson value) : type_(rawValue), allocated_(true)
+{
+    value_.string_ = valueAllocator()->duplicateStringValue(
+        value.text.data(), (unsigned int)value.text.size());
+}
+
 Value::Value(const StaticString& value) : type_(stringValue), allocated_(false)
 {
     value_.string_ = const_cast<char*>(value.c_str());
@@ -260,6 +290,7 @@ Value::Value(const Value& other) : type_(other.type_)
             break;
 
         case stringValue:
+        case rawValue:
             if (other.value_.string_)
             {
                 value_.string_ = valueAllocator()->duplicateStringValue(
@@ -273,7 +304,7 @@ Value::Value(const Value& other) : type_(other.type_)
 
         case arrayValue:
         case objectValue:
-            value_.map_ = new ObjectValues(*other.value_.map_);
+            value_.map_ = makeObjectValues(*other.value_.map_);
             break;
 
         default:
@@ -293,6 +324,7 @@ Value::~Value()
             break;
 
         case stringValue:
+        case rawValue:
             if (allocated_)
                 valueAllocator()->releaseStringValue(value_.string_);
 
@@ -301,7 +333,7 @@ Value::~Value()
         case arrayValue:
         case objectValue:
             if (value_.map_)
-                delete value_.map_;
+                destroyObjectValues(value_.map_);
             break;
 
         default:
@@ -393,6 +425,7 @@ operator<(const Value& x, const Value& y)
             return x.value_.bool_ < y.value_.bool_;
 
         case stringValue:
+        case rawValue:
             return (x.value_.string_ == 0 && y.value_.string_) ||
                 (y.value_.string_ && x.value_.string_ &&
                  strcmp(x.value_.string_, y.value_.string_) < 0);
@@ -442,6 +475,7 @@ operator==(const Value& x, const Value& y)
             return x.value_.bool_ == y.value_.bool_;
 
         case stringValue:
+        case rawValue:
             return x.value_.string_ == y.value_.string_ ||
                 (y.value_.string_ && x.value_.string_ &&
                  !strcmp(x.value_.string_, y.value_.string_));
@@ -465,6 +499,13 @@ Value::asCString() const
     return value_.string_;
 }
 
+const char*
+Value::asRawText() const
+{
+    JSON_ASSERT(type_ == rawValue);
+    return value_.string_ ? value_.string_ : "null";
+}
+
 std::string
 Value::asString() const
 {
@@ -490,6 +531,7 @@ Value::asString() const
 
         case arrayValue:
         case objectValue:
+        case rawValue:
             JSON_ASSERT_MESSAGE(false, "Type is not convertible to string");
 
         default:
@@ -532,6 +574,7 @@ Value::asInt() const
 
         case arrayValue:
         case objectValue:
+        case rawValue:
             JSON_ASSERT_MESSAGE(false, "Type is not convertible to int");
 
         default:
@@ -574,6 +617,7 @@ Value::asUInt() const
 
         case arrayValue:
         case objectValue:
+        case rawValue:
             JSON_ASSERT_MESSAGE(false, "Type is not convertible to uint");
 
         default:
@@ -606,6 +650,7 @@ Value::asDouble() const
         case stringValue:
         case arrayValue:
         case objectValue:
+        case rawValue:
             JSON_ASSERT_MESSAGE(false, "Type is not convertible to double");
 
         default:
@@ -640,6 +685,9 @@ Value::asBool() const
         case objectValue:
             return value_.map_->size() != 0;
 
+        case rawValue:
+            return true;
+
         default:
             JSON_ASSERT_UNREACHABLE;
     }
@@ -694,6 +742,9 @@ Value::isConvertibleTo(ValueType other) const
             return other == objectValue ||
                 (other == nullValue && value_.map_->size() == 0);
 
+        case rawValue:
+            return other == rawValue;
+
         default:
             JSON_ASSERT_UNREACHABLE;
     }
@@ -713,6 +764,7 @@ Value::size() const
         case realValue:
         case booleanValue:
         case stringValue:
+        case rawValue:
             return 0;
 
         case arrayValue:  // size of the array is highest index + 1
@@ -1035,6 +1087,12 @@ Value::isObjectOrNull() const
     return type_ == nullValue || type_ == objectValue;
 }
 
+bool
+Value::isRaw() const
+{
+    return type_ == rawValue;
+}
+
 std::string
 Value::toStyledString() const
 {
@@ -222,6 +222,10 @@ FastWriter::writeValue(const Value& value)
             document_ += valueToQuotedString(value.asCString());
             break;
 
+        case rawValue:
+            document_ += value.asRawText();
+            break;
+
         case booleanValue:
             document_ += valueToString(value.asBool());
             break;
@@ -309,6 +313,10 @@ StyledWriter::writeValue(const Value& value)
             pushValue(valueToQuotedString(value.asCString()));
             break;
 
+        case rawValue:
+            pushValue(value.asRawText());
+            break;
+
         case booleanValue:
             pushValue(valueToString(value.asBool()));
             break;
@@ -531,6 +539,10 @@ StyledStreamWriter::writeValue(const Value& value)
             pushValue(valueToQuotedString(value.asCString()));
             break;
 
+        case rawValue:
+            pushValue(value.asRawText());
+            break;
+
         case booleanValue:
             pushValue(valueToString(value.asBool()));
             break;
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_JSON_JSON_ARENA_H_INCLUDED
+#define RIPPLE_JSON_JSON_ARENA_H_INCLUDED
+
+#include <cstddef>
+#include <new>
+
+namespace Json {
+
+/** Region allocator for the nodes and strings of Value trees.
+
+    While an Arena is in use, the member maps and strings of the Values
+    created by its thread are carved out of large blocks instead of being
+    allocated one at a time. A block is released in one step once everything
+    carved out of it has been freed, so a large response costs a handful of
+    allocations to build and to destroy.
+
+    An Arena is in use on the thread that creates it until it is destroyed,
+    or until exchange() swaps it for another one. Arenas nest, and when none
+    is in use allocate() falls back to the heap.
+
+    Values may outlive the Arena and may be destroyed on any thread, but
+    each one keeps its whole block alive. Values kept beyond the scope of an
+    Arena should be created, or copied, while it is suspended.
+*/
+class Arena
+{
+public:
+    Arena();
+    ~Arena();
+
+    Arena(Arena const&) = delete;
+    Arena&
+    operator=(Arena const&) = delete;
+
+    static void*
+    allocate(std::size_t bytes);
+
+    static void
+    deallocate(void* p) noexcept;
+
+    /** The Arena in use on the calling thread, if any. */
+    static Arena*
+    current() noexcept;
+
+    /** Put an Arena, or none, in use on the calling thread.
+
+        Lets an Arena follow a coroutine that suspends and resumes, possibly
+        on another thread.
+
+        @return The Arena that was in use.
+    */
+    static Arena*
+    exchange(Arena* arena) noexcept;
+
+    /** Suspends the Arena in use on the thread while it is alive. */
+    class Suspend
+    {
+    public:
+        Suspend() : saved_(exchange(nullptr))
+        {
+        }
+
+        ~Suspend()
+        {
+            exchange(saved_);
+        }
+
+        Suspend(Suspend const&) = delete;
+        Suspend&
+        operator=(Suspend const&) = delete;
+
+    private:
+        Arena* const saved_;
+    };
+
+private:
+    struct Block;
+
+    void
+    retire();
+
+    Arena* const previous_;
+
+    // the block being carved up
+    Block* block_ = nullptr;
+    char* next_ = nullptr;
+    char* end_ = nullptr;
+    std::ptrdiff_t allocated_ = 0;
+};
+
+/** Standard allocator which allocates from the calling thread's Arena. */
+template <class T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() = default;
+
+    template <class U>
+    ArenaAllocator(ArenaAllocator<U> const&) noexcept
+    {
+    }
+
+    T*
+    allocate(std::size_t n)
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t));
+        return static_cast<T*>(Arena::allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T* p, std::size_t) noexcept
+    {
+        Arena::deallocate(p);
+    }
+
+    template <class U>
+    bool
+    operator==(ArenaAllocator<U> const&) const noexcept
+    {
+        return true;
+    }
+
+    template <class U>
+    bool
+    operator!=(ArenaAllocator<U> const&) const noexcept
+    {
+        return false;
+    }
+};
+
+}  // namespace Json
+
+#endif
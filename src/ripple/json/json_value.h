@@ -20,10 +20,12 @@
 #ifndef RIPPLE_JSON_JSON_VALUE_H_INCLUDED
 #define RIPPLE_JSON_JSON_VALUE_H_INCLUDED
 
+#include <ripple/json/json_arena.h>
 #include <ripple/json/json_forwards.h>
 #include <cstring>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /** \brief JSON (JavaScript Object Notation).
@@ -40,7 +42,8 @@ enum ValueType {
     stringValue,    ///< UTF-8 string value
     booleanValue,   ///< bool value
     arrayValue,     ///< array value (ordered list)
-    objectValue     ///< object value (collection of name/value pairs).
+    objectValue,    ///< object value (collection of name/value pairs).
+    rawValue        ///< compact JSON text, written out as is
 };
 
 /** \brief Lightweight wrapper to tag static string.
@@ -115,6 +118,18 @@ operator!=(StaticString x, std::string const& y)
     return !(y == x);
 }
 
+/** \brief Lightweight wrapper to tag compact JSON text.
+ *
+ * A Value constructed from RawJson holds a copy of the text, which writers
+ * copy to their output unchanged. This lets part of a document be
+ * serialized ahead of time, without building a Value tree for it. The text
+ * must be exactly what FastWriter would produce for the equivalent Value.
+ */
+struct RawJson
+{
+    std::string_view text;
+};
+
 /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
  *
  * This class is a discriminated union wrapper that can represent a:
@@ -191,7 +206,11 @@ private:
     };
 
 public:
-    using ObjectValues = std::map<CZString, Value>;
+    using ObjectValues = std::map<
+        CZString,
+        Value,
+        std::less<CZString>,
+        ArenaAllocator<std::pair<const CZString, Value>>>;
 
 public:
     /** \brief Create a default Value of the given type.
@@ -227,6 +246,7 @@ public:
      */
     Value(const StaticString& value);
     Value(std::string const& value);
+    explicit Value(RawJson value);
     Value(bool value);
     Value(const Value& other);
     ~Value();
@@ -247,6 +267,9 @@ public:
 
     const char*
     asCString() const;
+    /** Returns the text of a rawValue. */
+    const char*
+    asRawText() const;
     /** Returns the unquoted string value. */
     std::string
     asString() const;
@@ -286,6 +309,8 @@ public:
     isObject() const;
     bool
     isObjectOrNull() const;
+    bool
+    isRaw() const;
 
     bool
     isConvertibleTo(ValueType other) const;
@@ -22,6 +22,7 @@
 
 #include <ripple/json/json_forwards.h>
 #include <ripple/json/json_value.h>
+#include <cstring>
 #include <ostream>
 #include <vector>
 
@@ -251,6 +252,12 @@ write_value(Write const& write, Value const& value)
             write_string(write, valueToQuotedString(value.asCString()));
             break;
 
+        case rawValue: {
+            char const* const text = value.asRawText();
+            write(text, std::strlen(text));
+            break;
+        }
+
         case booleanValue:
             write_string(write, valueToString(value.asBool()));
             break;
@@ -26,7 +26,9 @@
 #include <ripple/protocol/Book.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/resource/Consumer.h>
+#include <memory>
 #include <mutex>
+#include <string>
 
 namespace ripple {
 
@@ -189,6 +191,35 @@ public:
         tryRemoveRpcSub(std::string const& strUrl) = 0;
     };
 
+    /** An event published to many subscribers.
+
+        The JSON text is produced the first time a subscriber asks for it,
+        and every other subscriber is handed the same buffer.
+    */
+    class Message
+    {
+    public:
+        explicit Message(Json::Value json);
+
+        Message(Message const&) = delete;
+        Message&
+        operator=(Message const&) = delete;
+
+        Json::Value const&
+        json() const
+        {
+            return json_;
+        }
+
+        std::shared_ptr<std::string const> const&
+        text() const;
+
+    private:
+        Json::Value const json_;
+        mutable std::once_flag once_;
+        mutable std::shared_ptr<std::string const> text_;
+    };
+
 public:
     InfoSub(Source& source);
     InfoSub(Source& source, Consumer consumer);
@@ -201,6 +232,10 @@ public:
     virtual void
     send(Json::Value const& jvObj, bool broadcast) = 0;
 
+    // Subscribers that can take the serialized text override this.
+    virtual void
+    send(std::shared_ptr<Message const> const& message, bool broadcast);
+
     std::uint64_t
     getSeq();
 
@@ -220,6 +255,12 @@ public:
     void
     deleteSubAccountHistory(AccountID const& account);
 
+    void
+    insertSubBook(Book const& book);
+
+    void
+    deleteSubBook(Book const& book);
+
     void
     clearRequest();
 
@@ -240,6 +281,7 @@ private:
     std::shared_ptr<InfoSubRequest> request_;
     std::uint64_t mSeq;
     hash_set<AccountID> accountHistorySubscriptions_;
+    hash_set<Book> bookSubscriptions_;
 
     static int
     assign_id()
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/json/json_writer.h>
 #include <ripple/net/InfoSub.h>
 #include <atomic>
 
@@ -63,6 +64,32 @@ InfoSub::~InfoSub()
 
     for (auto const& account : accountHistorySubscriptions_)
         m_source.unsubAccountHistoryInternal(mSeq, account, false);
+
+    for (auto const& book : bookSubscriptions_)
+        m_source.unsubBook(mSeq, book);
+}
+
+InfoSub::Message::Message(Json::Value json) : json_(std::move(json))
+{
+}
+
+std::shared_ptr<std::string const> const&
+InfoSub::Message::text() const
+{
+    std::call_once(once_, [this]() {
+        auto text = std::make_shared<std::string>();
+        Json::stream(json_, [&text](void const* data, std::size_t n) {
+            text->append(static_cast<char const*>(data), n);
+        });
+        text_ = std::move(text);
+    });
+    return text_;
+}
+
+void
+InfoSub::send(std::shared_ptr<Message const> const& message, bool broadcast)
+{
+    send(message->json(), broadcast);
 }
 
 Resource::Consumer&
@@ -118,6 +145,20 @@ InfoSub::deleteSubAccountHistory(AccountID const& account)
     accountHistorySubscriptions_.erase(account);
 }
 
+void
+InfoSub::insertSubBook(Book const& book)
+{
+    std::lock_guard sl(mLock);
+    bookSubscriptions_.insert(book);
+}
+
+void
+InfoSub::deleteSubBook(Book const& book)
+{
+    std::lock_guard sl(mLock);
+    bookSubscriptions_.erase(book);
+}
+
 void
 InfoSub::clearRequest()
 {
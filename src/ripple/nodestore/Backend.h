@@ -124,6 +124,18 @@ public:
     virtual std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
     fetchBatch(std::vector<uint256 const*> const& hashes) = 0;
 
+    /** Hint that the given objects are about to be fetched.
+
+        A backend may use this to read them from disk together, so that the
+        fetches which follow are served from memory. It must not change what
+        those fetches return.
+        @note This will be called concurrently.
+    */
+    virtual void
+    prefetch(std::vector<uint256 const*> const& hashes)
+    {
+    }
+
     /** Store a single object.
         Depending on the implementation this may happen immediately
         or deferred using a scheduled task.
@@ -382,6 +382,14 @@ private:
         FetchReport& fetchReport,
         bool duplicate) = 0;
 
+    /** Hint to the backend that the given objects are about to be fetched
+        by a read thread.
+    */
+    virtual void
+    prefetch(std::vector<uint256 const*> const& hashes)
+    {
+    }
+
     /** Visit every object in the database
         This is usually called during import.
 
@@ -22,6 +22,7 @@
 #include <ripple/nodestore/Manager.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/NuDBPrefetcher.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <boost/filesystem.hpp>
 #include <cassert>
@@ -48,6 +49,11 @@ public:
     size_t const keyBytes_;
     std::size_t const burstSize_;
     std::string const name_;
+    std::string const dictionaryFile_;
+    bool const rotating_;
+    std::shared_ptr<ZstdDictionary const> dictionary_;
+    bool const ioUring_;
+    std::unique_ptr<NuDBPrefetcher> prefetcher_;
     nudb::store db_;
     std::atomic<bool> deletePath_;
     Scheduler& scheduler_;
@@ -62,6 +68,9 @@ public:
         , keyBytes_(keyBytes)
         , burstSize_(burstSize)
         , name_(get(keyValues, "path"))
+        , dictionaryFile_(get(keyValues, "zstd_dictionary"))
+        , rotating_(get<std::uint32_t>(keyValues, "online_delete", 0) != 0)
+        , ioUring_(useIoUring(keyValues))
         , deletePath_(false)
         , scheduler_(scheduler)
     {
@@ -81,6 +90,9 @@ public:
         , keyBytes_(keyBytes)
         , burstSize_(burstSize)
         , name_(get(keyValues, "path"))
+        , dictionaryFile_(get(keyValues, "zstd_dictionary"))
+        , rotating_(get<std::uint32_t>(keyValues, "online_delete", 0) != 0)
+        , ioUring_(useIoUring(keyValues))
         , db_(context)
         , deletePath_(false)
         , scheduler_(scheduler)
@@ -90,6 +102,62 @@ public:
                 "nodestore: Missing path in NuDB backend");
     }
 
+    /** Load the zstd dictionary of the database, if it has one.
+
+        Objects are written with zstd if there is a dictionary. Once some
+        are, the dictionary is needed to read them back, so a configured
+        dictionary is copied into the database directory and that copy is
+        used from then on. A database created later, as online_delete does,
+        gets a copy of the dictionary configured at the time.
+    */
+    void
+    openDictionary(boost::filesystem::path const& folder)
+    {
+        using namespace boost::filesystem;
+        auto const local = folder / ZstdDictionary::defaultFileName;
+
+        if (!dictionaryFile_.empty() && !exists(local))
+        {
+            if (!exists(dictionaryFile_))
+                Throw<std::runtime_error>(
+                    "nodestore: zstd dictionary " + dictionaryFile_ +
+                    " not found");
+            copy_file(dictionaryFile_, local);
+        }
+        else if (dictionaryFile_.empty() && exists(local) && rotating_)
+        {
+            // The databases that replace this one would go without
+            Throw<std::runtime_error>(
+                "nodestore: zstd_dictionary must be set with online_delete, "
+                "found " + local.string());
+        }
+
+        if (!exists(local))
+            return;
+
+        dictionary_ = ZstdDictionary::load(local);
+        JLOG(j_.info()) << "Using zstd dictionary " << local.string()
+                        << " with ID " << dictionary_->id();
+
+        if (!dictionaryFile_.empty() && exists(dictionaryFile_) &&
+            ZstdDictionary::load(dictionaryFile_)->id() != dictionary_->id())
+        {
+            JLOG(j_.warn()) << "Keeping zstd dictionary " << local.string()
+                            << " rather than " << dictionaryFile_
+                            << " for the objects already written";
+        }
+    }
+
+    static bool
+    useIoUring(Section const& keyValues)
+    {
+        auto const engine = get(keyValues, "read_engine", "threads");
+        if (engine != "threads" && engine != "io_uring")
+            Throw<std::runtime_error>(
+                "nodestore: Unknown read_engine " + engine);
+        return engine == "io_uring";
+    }
+
     ~NuDBBackend() override
     {
         try
@@ -149,6 +217,8 @@ public:
         if (ec)
             Throw<nudb::system_error>(ec);
 
+        openDictionary(folder);
+
         /** Old value currentType is accepted for appnum in traditional
          *  databases, new value is used for deterministic shard databases.
          *  New 64-bit value is constructed from fixed and random parts.
@@ -161,6 +231,24 @@ public:
             (db_.appnum() & deterministicMask) != deterministicType)
             Throw<std::runtime_error>("nodestore: unknown appnum");
         db_.set_burst(burstSize_);
+
+        if (ioUring_ && !IoUring::supported())
+        {
+            JLOG(j_.warn()) << "io_uring is not available, reading "
+                            << name_ << " with threads only";
+        }
+        else if (ioUring_)
+        {
+            try
+            {
+                prefetcher_ = std::make_unique<NuDBPrefetcher>(dp, kp);
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(j_.warn()) << "Reading " << name_
+                                << " with threads only: " << e.what();
+            }
+        }
     }
 
     bool
@@ -178,6 +266,8 @@ public:
     void
     close() override
     {
+        prefetcher_.reset();
+
         if (db_.is_open())
         {
             nudb::error_code ec;
@@ -209,9 +299,10 @@ public:
         nudb::error_code ec;
         db_.fetch(
             key,
-            [key, pno, &status](void const* data, std::size_t size) {
+            [this, key, pno, &status](void const* data, std::size_t size) {
                 nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
+                auto const result =
+                    nodeobject_decompress(data, size, bf, dictionary_.get());
                 DecodedBlob decoded(key, result.first, result.second);
                 if (!decoded.wasOk())
                 {
@@ -247,13 +338,31 @@ public:
         return {results, ok};
     }
 
+    void
+    prefetch(std::vector<uint256 const*> const& hashes) override
+    {
+        if (!prefetcher_)
+            return;
+
+        try
+        {
+            prefetcher_->prefetch(hashes);
+        }
+        catch (std::exception const& e)
+        {
+            // the fetches that follow will do the reads themselves
+            JLOG(j_.debug()) << "prefetch failed: " << e.what();
+        }
+    }
+
     void
     do_insert(std::shared_ptr<NodeObject> const& no)
     {
         EncodedBlob e(no);
         nudb::error_code ec;
         nudb::detail::buffer bf;
-        auto const result = nodeobject_compress(e.getData(), e.getSize(), bf);
+        auto const result = nodeobject_compress(
+            e.getData(), e.getSize(), bf, dictionary_.get());
         db_.insert(e.getKey(), result.first, result.second, ec);
         if (ec && ec != nudb::error::key_exists)
             Throw<nudb::system_error>(ec);
@@ -308,7 +417,8 @@ public:
                 std::size_t size,
                 nudb::error_code&) {
                 nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
+                auto const result =
+                    nodeobject_decompress(data, size, bf, dictionary_.get());
                 DecodedBlob decoded(key, result.first, result.second);
                 if (!decoded.wasOk())
                 {
@@ -360,7 +470,8 @@ public:
     int
     fdRequired() const override
     {
-        return 3;
+        // io_uring opens the data and key files again, and needs a ring
+        return ioUring_ ? 6 : 3;
     }
 };
 
@@ -67,6 +67,7 @@ Database::Database(
                     "db prefetch #" + std::to_string(i));
 
                 decltype(read_) read;
+                std::vector<uint256 const*> hashes;
 
                 while (true)
                 {
@@ -94,6 +95,15 @@ Database::Database(
                             read.insert(read_.extract(read_.begin()));
                     }
 
+                    // let the backend read the whole bundle at once
+                    if (read.size() > 1)
+                    {
+                        hashes.clear();
+                        for (auto const& r : read)
+                            hashes.push_back(&r.first);
+                        prefetch(hashes);
+                    }
+
                     for (auto it = read.begin(); it != read.end(); ++it)
                     {
                         assert(!it->second.empty());
@@ -70,6 +70,24 @@ DatabaseNodeImp::sweep()
         cache_->sweep();
 }
 
+void
+DatabaseNodeImp::prefetch(std::vector<uint256 const*> const& hashes)
+{
+    if (!cache_)
+        return backend_->prefetch(hashes);
+
+    std::vector<uint256 const*> misses;
+    misses.reserve(hashes.size());
+    for (auto const h : hashes)
+    {
+        if (!cache_->touch_if_exists(*h))
+            misses.push_back(h);
+    }
+
+    if (misses.size() > 1)
+        backend_->prefetch(misses);
+}
+
 std::shared_ptr<NodeObject>
 DatabaseNodeImp::fetchNodeObject(
     uint256 const& hash,
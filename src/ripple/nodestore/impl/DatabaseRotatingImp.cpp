@@ -121,6 +121,18 @@ DatabaseRotatingImp::sweep()
     // nothing to do
 }
 
+void
+DatabaseRotatingImp::prefetch(std::vector<uint256 const*> const& hashes)
+{
+    auto [writable, archive] = [&] {
+        std::lock_guard lock(mutex_);
+        return std::make_pair(writableBackend_, archiveBackend_);
+    }();
+
+    writable->prefetch(hashes);
+    archive->prefetch(hashes);
+}
+
 std::shared_ptr<NodeObject>
 DatabaseRotatingImp::fetchNodeObject(
     uint256 const& hash,
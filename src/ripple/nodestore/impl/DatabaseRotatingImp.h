@@ -91,6 +91,9 @@ private:
         FetchReport& fetchReport,
         bool duplicate) override;
 
+    void
+    prefetch(std::vector<uint256 const*> const& hashes) override;
+
     void
     for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override;
 };
@@ -0,0 +1,262 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/nodestore/impl/IoUring.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define RIPPLE_NODESTORE_HAS_IO_URING 1
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define RIPPLE_NODESTORE_HAS_IO_URING 0
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+#if RIPPLE_NODESTORE_HAS_IO_URING
+
+namespace {
+
+// Called directly, so that liburing is not needed
+int
+setup(unsigned entries, io_uring_params& p)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+}
+
+int
+enter(int fd, unsigned submit, unsigned wait, unsigned flags)
+{
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+}
+
+void*
+offset(void* base, std::uint32_t off)
+{
+    return static_cast<char*>(base) + off;
+}
+
+unsigned
+loadAcquire(unsigned const* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void
+storeRelease(unsigned* p, unsigned v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+}  // namespace
+
+IoUring::IoUring(unsigned entries)
+{
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+
+    ring_.fd = setup(entries, p);
+    if (ring_.fd < 0)
+        throw std::system_error(errno, std::system_category(), "io_uring");
+
+    // whatever was mapped before a failure is released by the members
+    auto map = [this](Mapping& m, std::size_t size, off_t off) {
+        void* ptr = mmap(
+            nullptr,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            ring_.fd,
+            off);
+        if (ptr == MAP_FAILED)
+            throw std::system_error(errno, std::system_category(), "io_uring");
+        m.ptr = ptr;
+        m.size = size;
+    };
+
+    entries_ = p.sq_entries;
+
+    map(sqRing_,
+        p.sq_off.array + p.sq_entries * sizeof(unsigned),
+        IORING_OFF_SQ_RING);
+    map(cqRing_,
+        p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe),
+        IORING_OFF_CQ_RING);
+    map(sqes_, p.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES);
+
+    auto const sq = sqRing_.ptr;
+    auto const cq = cqRing_.ptr;
+    sqTail_ = static_cast<unsigned*>(offset(sq, p.sq_off.tail));
+    sqMask_ = static_cast<unsigned*>(offset(sq, p.sq_off.ring_mask));
+    sqArray_ = static_cast<unsigned*>(offset(sq, p.sq_off.array));
+    cqHead_ = static_cast<unsigned*>(offset(cq, p.cq_off.head));
+    cqTail_ = static_cast<unsigned*>(offset(cq, p.cq_off.tail));
+    cqMask_ = static_cast<unsigned*>(offset(cq, p.cq_off.ring_mask));
+    cqes_ = offset(cq, p.cq_off.cqes);
+}
+
+IoUring::Descriptor::~Descriptor()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+IoUring::Mapping::~Mapping()
+{
+    if (ptr)
+        munmap(ptr, size);
+}
+
+bool
+IoUring::supported()
+{
+    static bool const result = []() {
+        int const fd = open("/dev/zero", O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        bool ok = false;
+        try
+        {
+            IoUring ring(1);
+            char c = 1;
+            if (ring.read(fd, &c, 1, 0, 0))
+                ring.wait([&](std::uint64_t, int res) {
+                    ok = (res == 1 && c == 0);
+                });
+        }
+        catch (std::exception const&)
+        {
+        }
+
+        close(fd);
+        return ok;
+    }();
+
+    return result;
+}
+
+bool
+IoUring::read(
+    int fd,
+    void* buffer,
+    std::uint32_t size,
+    std::uint64_t offset,
+    std::uint64_t tag)
+{
+    if (pending_ + queued_ >= entries_)
+        return false;
+
+    // only this thread moves the tail
+    auto const tail = *sqTail_;
+    auto const index = tail & *sqMask_;
+    auto& sqe = static_cast<io_uring_sqe*>(sqes_.ptr)[index];
+
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+    sqe.len = size;
+    sqe.off = offset;
+    sqe.user_data = tag;
+
+    sqArray_[index] = index;
+    storeRelease(sqTail_, tail + 1);
+    ++queued_;
+    return true;
+}
+
+void
+IoUring::wait(std::function<void(std::uint64_t tag, int result)> const& done)
+{
+    while (queued_ != 0 || pending_ != 0)
+    {
+        auto const ret = enter(
+            ring_.fd, queued_, pending_ + queued_, IORING_ENTER_GETEVENTS);
+        if (ret < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            throw std::system_error(errno, std::system_category(), "io_uring");
+        }
+
+        pending_ += ret;
+        queued_ -= ret;
+
+        auto head = *cqHead_;
+        auto const tail = loadAcquire(cqTail_);
+        auto const cqes = static_cast<io_uring_cqe*>(cqes_);
+        while (head != tail)
+        {
+            auto const& cqe = cqes[head & *cqMask_];
+            auto const tag = cqe.user_data;
+            auto const res = cqe.res;
+            ++head;
+            --pending_;
+            storeRelease(cqHead_, head);
+            done(tag, res);
+        }
+    }
+}
+
+#else
+
+IoUring::IoUring(unsigned)
+{
+    throw std::system_error(
+        std::make_error_code(std::errc::function_not_supported), "io_uring");
+}
+
+IoUring::Descriptor::~Descriptor() = default;
+
+IoUring::Mapping::~Mapping() = default;
+
+bool
+IoUring::supported()
+{
+    return false;
+}
+
+bool
+IoUring::read(int, void*, std::uint32_t, std::uint64_t, std::uint64_t)
+{
+    return false;
+}
+
+void
+IoUring::wait(std::function<void(std::uint64_t, int)> const&)
+{
+}
+
+#endif
+
+IoUring::~IoUring() = default;
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,136 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_IOURING_H_INCLUDED
+#define RIPPLE_NODESTORE_IOURING_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A minimal io_uring instance, used only to read files.
+
+    Many positioned reads are queued with read(), then submitted to the
+    kernel together with wait(), which returns once every one of them has
+    completed. This keeps hundreds of reads in flight from a single thread.
+
+    An instance must only be used by one thread at a time. Only Linux has
+    io_uring, and it can also be missing or disabled there, so callers must
+    check supported() and fall back to ordinary reads.
+*/
+class IoUring
+{
+public:
+    /** Create a ring with room for at least the given number of reads.
+
+        @throws std::system_error if io_uring is not available.
+    */
+    explicit IoUring(unsigned entries);
+
+    ~IoUring();
+
+    IoUring(IoUring const&) = delete;
+    IoUring&
+    operator=(IoUring const&) = delete;
+
+    /** Whether io_uring can be used for reads on this system. */
+    static bool
+    supported();
+
+    /** The number of reads that can be queued before calling wait(). */
+    unsigned
+    capacity() const
+    {
+        return entries_;
+    }
+
+    /** Queue a read of size bytes at offset of fd into buffer.
+
+        @return false if there is no room left, call wait() first.
+    */
+    bool
+    read(
+        int fd,
+        void* buffer,
+        std::uint32_t size,
+        std::uint64_t offset,
+        std::uint64_t tag);
+
+    /** Submit the queued reads and wait for all of them to complete.
+
+        For each read, calls done with its tag and the number of bytes read,
+        or a negated errno value on failure.
+    */
+    void
+    wait(std::function<void(std::uint64_t tag, int result)> const& done);
+
+private:
+    // a file descriptor, closed on destruction
+    struct Descriptor
+    {
+        int fd = -1;
+
+        Descriptor() = default;
+        Descriptor(Descriptor const&) = delete;
+        Descriptor&
+        operator=(Descriptor const&) = delete;
+        ~Descriptor();
+    };
+
+    // a memory mapping, unmapped on destruction
+    struct Mapping
+    {
+        void* ptr = nullptr;
+        std::size_t size = 0;
+
+        Mapping() = default;
+        Mapping(Mapping const&) = delete;
+        Mapping&
+        operator=(Mapping const&) = delete;
+        ~Mapping();
+    };
+
+    // the mappings are of the ring, so are declared after it to be released
+    // before it is closed
+    Descriptor ring_;
+    unsigned entries_ = 0;
+
+    Mapping sqRing_;
+    Mapping cqRing_;
+    Mapping sqes_;
+
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqMask_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned* cqMask_ = nullptr;
+    void* cqes_ = nullptr;
+
+    unsigned queued_ = 0;  // not yet submitted
+    unsigned pending_ = 0;  // not yet completed
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,264 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/NuDBPrefetcher.h>
+#include <nudb/xxhasher.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+#if defined(__linux__)
+
+namespace {
+
+// NuDB stores integers big endian, in fields of 2, 6 and 8 bytes
+std::uint64_t
+readBE(std::uint8_t const* p, std::size_t bytes)
+{
+    std::uint64_t v = 0;
+    for (std::size_t i = 0; i < bytes; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+// Offsets of the fields of the key file header
+constexpr std::size_t keyHeaderSize = 48;
+constexpr std::size_t keySizeOffset = 26;
+constexpr std::size_t saltOffset = 28;
+constexpr std::size_t blockSizeOffset = 44;
+
+// A bucket is a count and a spill offset followed by the entries, each an
+// offset and a size in the data file and the hash of the key.
+constexpr std::size_t bucketHeaderSize = 8;
+constexpr std::size_t bucketEntrySize = 18;
+
+// A data record is the size of the value, then the key, then the value.
+constexpr std::size_t recordHeaderSize = 6;
+
+constexpr std::uint64_t mask48 = 0xFFFFFFFFFFFFull;
+
+int
+openRead(std::string const& path)
+{
+    int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::system_category(), path);
+    return fd;
+}
+
+struct Read
+{
+    std::uint64_t offset;
+    std::uint32_t size;
+};
+
+// Read everything with as few submissions as the ring allows, returning the
+// number of reads which succeeded.
+std::size_t
+readAll(
+    IoUring& ring,
+    int fd,
+    std::vector<Read> const& reads,
+    std::vector<std::uint8_t>& buffer,
+    std::vector<std::size_t>& where)
+{
+    std::size_t total = 0;
+    where.resize(reads.size());
+    for (std::size_t i = 0; i < reads.size(); ++i)
+    {
+        where[i] = total;
+        total += reads[i].size;
+    }
+    buffer.assign(total, 0);
+
+    std::size_t good = 0;
+    auto const done = [&](std::uint64_t tag, int result) {
+        if (result == static_cast<int>(reads[tag].size))
+            ++good;
+    };
+
+    for (std::size_t i = 0; i < reads.size(); ++i)
+    {
+        auto const& r = reads[i];
+        while (!ring.read(fd, &buffer[where[i]], r.size, r.offset, i))
+            ring.wait(done);
+    }
+    ring.wait(done);
+    return good;
+}
+
+}  // namespace
+
+NuDBPrefetcher::NuDBPrefetcher(
+    std::string const& datPath,
+    std::string const& keyPath)
+    : datFd_(openRead(datPath))
+{
+    try
+    {
+        keyFd_ = openRead(keyPath);
+
+        std::uint8_t h[keyHeaderSize];
+        if (::pread(keyFd_, h, sizeof(h), 0) != sizeof(h) ||
+            std::memcmp(h, "nudb.key", 8) != 0)
+            Throw<std::runtime_error>("nodestore: bad key file " + keyPath);
+
+        keySize_ = readBE(h + keySizeOffset, 2);
+        salt_ = readBE(h + saltOffset, 8);
+        blockSize_ = readBE(h + blockSizeOffset, 2);
+
+        if (keySize_ != uint256::bytes || blockSize_ <= bucketHeaderSize)
+            Throw<std::runtime_error>("nodestore: bad key file " + keyPath);
+    }
+    catch (...)
+    {
+        if (keyFd_ >= 0)
+            ::close(keyFd_);
+        ::close(datFd_);
+        throw;
+    }
+}
+
+NuDBPrefetcher::~NuDBPrefetcher()
+{
+    ::close(keyFd_);
+    ::close(datFd_);
+}
+
+std::unique_ptr<IoUring>
+NuDBPrefetcher::acquire()
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (!rings_.empty())
+        {
+            auto ring = std::move(rings_.back());
+            rings_.pop_back();
+            return ring;
+        }
+    }
+    return std::make_unique<IoUring>(ringEntries);
+}
+
+void
+NuDBPrefetcher::release(std::unique_ptr<IoUring> ring)
+{
+    std::lock_guard lock(mutex_);
+    rings_.push_back(std::move(ring));
+}
+
+std::size_t
+NuDBPrefetcher::prefetch(std::vector<uint256 const*> const& hashes)
+{
+    if (hashes.empty())
+        return 0;
+
+    // The key file grows as buckets split, so look at it every time
+    struct stat st;
+    if (::fstat(keyFd_, &st) != 0 ||
+        static_cast<std::size_t>(st.st_size) < 2 * blockSize_)
+        return 0;
+
+    std::uint64_t const buckets = (st.st_size - blockSize_) / blockSize_;
+    std::uint64_t modulus = 1;
+    while (modulus < buckets)
+        modulus *= 2;
+
+    thread_local std::vector<Read> reads;
+    thread_local std::vector<std::uint64_t> keyHashes;
+    thread_local std::vector<std::uint8_t> buffer;
+    thread_local std::vector<std::size_t> where;
+
+    nudb::xxhasher const hasher(salt_);
+
+    reads.clear();
+    keyHashes.clear();
+    for (auto const h : hashes)
+    {
+        auto const hash = (hasher(h->data(), keySize_) >> 16) & mask48;
+        auto n = hash % modulus;
+        if (n >= buckets)
+            n -= modulus / 2;
+        keyHashes.push_back(hash);
+        reads.push_back(
+            {(n + 1) * blockSize_, static_cast<std::uint32_t>(blockSize_)});
+    }
+
+    // A bucket that could not be read is left zeroed, so it has no entries
+    auto ring = acquire();
+    readAll(*ring, keyFd_, reads, buffer, where);
+
+    std::vector<Read> records;
+    for (std::size_t i = 0; i < keyHashes.size(); ++i)
+    {
+        auto const* b = &buffer[where[i]];
+        auto const count = std::min<std::size_t>(
+            readBE(b, 2), (blockSize_ - bucketHeaderSize) / bucketEntrySize);
+
+        for (std::size_t j = 0; j < count; ++j)
+        {
+            auto const* e = b + bucketHeaderSize + j * bucketEntrySize;
+            if (readBE(e + 12, 6) != keyHashes[i])
+                continue;
+
+            auto const size = recordHeaderSize + keySize_ + readBE(e + 6, 6);
+            if (size <= maxRecordSize)
+                records.push_back(
+                    {readBE(e, 6), static_cast<std::uint32_t>(size)});
+        }
+    }
+
+    auto const found = readAll(*ring, datFd_, records, buffer, where);
+    release(std::move(ring));
+    return found;
+}
+
+#else
+
+// io_uring is only found on Linux
+NuDBPrefetcher::NuDBPrefetcher(std::string const&, std::string const&)
+{
+    throw std::system_error(
+        std::make_error_code(std::errc::function_not_supported), "io_uring");
+}
+
+NuDBPrefetcher::~NuDBPrefetcher() = default;
+
+std::size_t
+NuDBPrefetcher::prefetch(std::vector<uint256 const*> const&)
+{
+    return 0;
+}
+
+#endif
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_NUDBPREFETCHER_H_INCLUDED
+#define RIPPLE_NODESTORE_NUDBPREFETCHER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/nodestore/impl/IoUring.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Reads NuDB records into the page cache using io_uring.
+
+    Fetching from NuDB takes two dependent reads, the key file bucket and
+    then the data record, each done with a blocking pread. A bundle of
+    fetches therefore costs twice as many round trips to the disk as there
+    are keys. This reads the buckets for a whole bundle with one submission,
+    then the records they point to with another, so that the fetches which
+    follow find everything in memory.
+
+    Nothing read here is ever returned: the store's own fetch remains the
+    only source of objects. Records that are not yet written to the files,
+    or that live in spill buckets, are simply not prefetched.
+*/
+class NuDBPrefetcher
+{
+public:
+    // Reads queued per submission
+    static constexpr unsigned ringEntries = 128;
+
+    // Records larger than this are left for the fetch to read
+    static constexpr std::size_t maxRecordSize = 64 * 1024;
+
+    /** Open the files of a NuDB database for reading.
+
+        @throws std::system_error if the files cannot be opened, or
+                std::runtime_error if the key file is not recognized.
+    */
+    NuDBPrefetcher(std::string const& datPath, std::string const& keyPath);
+
+    ~NuDBPrefetcher();
+
+    NuDBPrefetcher(NuDBPrefetcher const&) = delete;
+    NuDBPrefetcher&
+    operator=(NuDBPrefetcher const&) = delete;
+
+    /** Read the records for the given keys.
+
+        @note This can be called concurrently.
+        @return The number of records read.
+    */
+    std::size_t
+    prefetch(std::vector<uint256 const*> const& hashes);
+
+private:
+    std::unique_ptr<IoUring>
+    acquire();
+
+    void
+    release(std::unique_ptr<IoUring> ring);
+
+    int datFd_ = -1;
+    int keyFd_ = -1;
+    std::uint64_t salt_ = 0;
+    std::size_t keySize_ = 0;
+    std::size_t blockSize_ = 0;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<IoUring>> rings_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/ZstdDictionary.h>
+#include <zdict.h>
+#include <zstd.h>
+#include <stdexcept>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+struct CCtxDeleter
+{
+    void
+    operator()(ZSTD_CCtx* ctx) const
+    {
+        ZSTD_freeCCtx(ctx);
+    }
+};
+
+struct DCtxDeleter
+{
+    void
+    operator()(ZSTD_DCtx* ctx) const
+    {
+        ZSTD_freeDCtx(ctx);
+    }
+};
+
+// Contexts are costly to create and can't be shared between threads
+ZSTD_CCtx*
+compressionContext()
+{
+    thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> const ctx{
+        ZSTD_createCCtx()};
+    if (!ctx)
+        Throw<std::runtime_error>("zstd: can't create compression context");
+    return ctx.get();
+}
+
+ZSTD_DCtx*
+decompressionContext()
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> const ctx{
+        ZSTD_createDCtx()};
+    if (!ctx)
+        Throw<std::runtime_error>("zstd: can't create decompression context");
+    return ctx.get();
+}
+
+}  // namespace
+
+ZstdDictionary::ZstdDictionary(Blob const& dictionary, int level)
+    : id_(ZDICT_getDictID(dictionary.data(), dictionary.size()))
+{
+    // Frames made with a trained dictionary carry its ID, so decompressing
+    // with another dictionary fails instead of returning garbage.
+    if (id_ == 0)
+        Throw<std::runtime_error>("zstd: not a trained dictionary");
+
+    cdict_ = ZSTD_createCDict(dictionary.data(), dictionary.size(), level);
+    ddict_ = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    if (!cdict_ || !ddict_)
+    {
+        ZSTD_freeCDict(cdict_);
+        ZSTD_freeDDict(ddict_);
+        Throw<std::runtime_error>("zstd: invalid dictionary");
+    }
+}
+
+ZstdDictionary::~ZstdDictionary()
+{
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+}
+
+std::shared_ptr<ZstdDictionary const>
+ZstdDictionary::load(boost::filesystem::path const& file)
+{
+    boost::system::error_code ec;
+    auto const contents = getFileContents(ec, file);
+    if (ec)
+        Throw<std::runtime_error>(
+            "zstd: can't read dictionary " + file.string() + ": " +
+            ec.message());
+
+    return std::make_shared<ZstdDictionary const>(
+        Blob(contents.begin(), contents.end()));
+}
+
+Blob
+ZstdDictionary::train(std::vector<Blob> const& samples, std::size_t capacity)
+{
+    Blob buffer;
+    std::vector<std::size_t> sizes;
+    sizes.reserve(samples.size());
+    for (auto const& sample : samples)
+    {
+        buffer.insert(buffer.end(), sample.begin(), sample.end());
+        sizes.push_back(sample.size());
+    }
+
+    Blob dictionary(capacity);
+    auto const size = ZDICT_trainFromBuffer(
+        dictionary.data(),
+        dictionary.size(),
+        buffer.data(),
+        sizes.data(),
+        static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(size))
+        Throw<std::runtime_error>(
+            std::string("zstd: training failed: ") +
+            ZDICT_getErrorName(size));
+
+    dictionary.resize(size);
+    return dictionary;
+}
+
+std::size_t
+ZstdDictionary::compressBound(std::size_t size)
+{
+    return ZSTD_compressBound(size);
+}
+
+std::size_t
+ZstdDictionary::compress(
+    void* out,
+    std::size_t capacity,
+    void const* in,
+    std::size_t size) const
+{
+    auto const result = ZSTD_compress_usingCDict(
+        compressionContext(), out, capacity, in, size, cdict_);
+    if (ZSTD_isError(result))
+        Throw<std::runtime_error>(
+            std::string("zstd compress: ") + ZSTD_getErrorName(result));
+    return result;
+}
+
+void
+ZstdDictionary::decompress(
+    void* out,
+    std::size_t capacity,
+    void const* in,
+    std::size_t size) const
+{
+    auto const result = ZSTD_decompress_usingDDict(
+        decompressionContext(), out, capacity, in, size, ddict_);
+    if (ZSTD_isError(result))
+        Throw<std::runtime_error>(
+            std::string("zstd decompress: ") + ZSTD_getErrorName(result));
+    if (result != capacity)
+        Throw<std::runtime_error>("zstd decompress: size mismatch");
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_ZSTDDICTIONARY_H_INCLUDED
+#define RIPPLE_NODESTORE_ZSTDDICTIONARY_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <boost/filesystem/path.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace ripple {
+namespace NodeStore {
+
+/** A zstd dictionary used to compress node objects.
+
+    Node objects are small and repeat the same field headers, account IDs
+    and amounts over and over, which a dictionary trained on a sample of a
+    database captures much better than compressing each object alone.
+
+    The dictionary is trained offline and stored in the database directory.
+    Every object compressed with it needs the very same dictionary to be
+    decompressed, and records its ID, so once a database holds such objects
+    the file must never be removed or replaced.
+*/
+class ZstdDictionary
+{
+public:
+    // Looked for in the database directory when no file is configured
+    static constexpr char const* defaultFileName = "zstd.dict";
+
+    // Size of dictionary train() makes unless asked otherwise
+    static constexpr std::size_t defaultCapacity = 112640;
+
+    /** Create from the contents of a dictionary.
+
+        @throws std::runtime_error if the dictionary cannot be used.
+    */
+    explicit ZstdDictionary(Blob const& dictionary, int level = 3);
+
+    ~ZstdDictionary();
+
+    ZstdDictionary(ZstdDictionary const&) = delete;
+    ZstdDictionary&
+    operator=(ZstdDictionary const&) = delete;
+
+    /** Load the dictionary from a file.
+
+        @throws std::runtime_error if the file cannot be read or used.
+    */
+    static std::shared_ptr<ZstdDictionary const>
+    load(boost::filesystem::path const& file);
+
+    /** Train a dictionary from sample node objects, as stored uncompressed.
+
+        @throws std::runtime_error if no dictionary could be trained, usually
+                because there are too few samples.
+    */
+    static Blob
+    train(
+        std::vector<Blob> const& samples,
+        std::size_t capacity = defaultCapacity);
+
+    /** The ID of the dictionary, recorded with every object using it. */
+    std::uint32_t
+    id() const
+    {
+        return id_;
+    }
+
+    /** The most compress() may write for size bytes of input. */
+    static std::size_t
+    compressBound(std::size_t size);
+
+    /** Compress into out, which holds at least compressBound(size) bytes.
+
+        @return the number of bytes written.
+        @throws std::runtime_error on failure.
+    */
+    std::size_t
+    compress(void* out, std::size_t capacity, void const* in, std::size_t size)
+        const;
+
+    /** Decompress exactly capacity bytes into out.
+
+        @throws std::runtime_error if the data is corrupt, was compressed
+                with another dictionary or does not decompress to exactly
+                capacity bytes.
+    */
+    void
+    decompress(
+        void* out,
+        std::size_t capacity,
+        void const* in,
+        std::size_t size) const;
+
+private:
+    ZSTD_CDict_s* cdict_ = nullptr;
+    ZSTD_DDict_s* ddict_ = nullptr;
+    std::uint32_t id_ = 0;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -26,6 +26,7 @@
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/ZstdDictionary.h>
 #include <ripple/nodestore/impl/varint.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <cstddef>
@@ -92,6 +93,58 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     return result;
 }
 
+// A zstd blob is the ID of the dictionary, the size of the data and the
+// zstd frame, so that an object is never decoded with another dictionary.
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_decompress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionary const& dict)
+{
+    auto p = reinterpret_cast<std::uint8_t const*>(in);
+
+    std::size_t id = 0;
+    auto n = read_varint(p, in_size, id);
+    if (n == 0 || n >= in_size)
+        Throw<std::runtime_error>("zstd_decompress: invalid blob");
+    if (id != dict.id())
+        Throw<std::runtime_error>(
+            "zstd_decompress: object uses dictionary " + std::to_string(id) +
+            ", not " + std::to_string(dict.id()));
+    p += n;
+    in_size -= n;
+
+    std::size_t outSize = 0;
+    n = read_varint(p, in_size, outSize);
+    if (n == 0 || n >= in_size || outSize == 0)
+        Throw<std::runtime_error>("zstd_decompress: invalid blob");
+
+    void* const out = bf(outSize);
+    dict.decompress(out, outSize, p + n, in_size - n);
+    return {out, outSize};
+}
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_compress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionary const& dict)
+{
+    using namespace nudb::detail;
+    std::array<std::uint8_t, 2 * varint_traits<std::size_t>::max> vi;
+    auto n = write_varint(vi.data(), dict.id());
+    n += write_varint(vi.data() + n, in_size);
+    auto const out_max = ZstdDictionary::compressBound(in_size);
+    std::uint8_t* out = reinterpret_cast<std::uint8_t*>(bf(n + out_max));
+    std::memcpy(out, vi.data(), n);
+    auto const out_size = dict.compress(out + n, out_max, in, in_size);
+    return {out, n + out_size};
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -101,11 +154,16 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     1 = lz4 compressed
     2 = inner node compressed
     3 = full inner node
+    4 = zstd compressed with a dictionary
 */
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_decompress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionary const* dict = nullptr)
 {
     using namespace nudb::detail;
 
@@ -199,6 +257,14 @@ nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
             write(os, is(512), 512);
             break;
         }
+        case 4:  // zstd
+        {
+            if (!dict)
+                Throw<std::runtime_error>(
+                    "nodeobject codec: zstd object but no dictionary");
+            result = zstd_decompress(p, in_size, bf, *dict);
+            break;
+        }
         default:
             Throw<std::runtime_error>(
                 "nodeobject codec: bad type=" + std::to_string(type));
@@ -214,9 +280,15 @@ zero32()
     return v.data();
 }
 
+// Objects other than inner nodes are compressed with zstd when given a
+// dictionary, and with lz4 otherwise.
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_compress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionary const* dict = nullptr)
 {
     using std::runtime_error;
     using namespace nudb::detail;
@@ -280,7 +352,7 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
 
     std::array<std::uint8_t, varint_traits<std::size_t>::max> vi;
 
-    constexpr std::size_t codecType = 1;
+    std::size_t const codecType = dict ? 4 : 1;
     auto const vn = write_varint(vi.data(), codecType);
     std::pair<void const*, std::size_t> result;
     switch (codecType)
@@ -299,6 +371,22 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
             result.second = vn + lzr.second;
             break;
         }
+        case 4:  // zstd
+        {
+            std::uint8_t* p;
+            auto const zr = NodeStore::zstd_compress(
+                in,
+                in_size,
+                [&p, &vn, &bf](std::size_t n) {
+                    p = reinterpret_cast<std::uint8_t*>(bf(vn + n));
+                    return p + vn;
+                },
+                *dict);
+            std::memcpy(p, vi.data(), vn);
+            result.first = p;
+            result.second = vn + zr.second;
+            break;
+        }
         default:
             Throw<std::logic_error>(
                 "nodeobject codec: unknown=" + std::to_string(codecType));
@@ -175,7 +175,8 @@ public:
 
     /** Relay a transaction. If the tx reduce-relay feature is enabled then
      * randomly select peers to relay to and queue transaction's hash
-     * for the rest of the peers.
+     * for the rest of the peers. Peers with the transaction batching
+     * feature enabled receive the transaction in their next batch.
      * @param hash transaction's hash
      * @param m transaction's protocol message to relay
      * @param toSkip peers which have already seen this transaction
@@ -136,6 +136,11 @@ public:
 
     virtual bool
     txReduceRelayEnabled() const = 0;
+
+    /** Returns true if relayed transactions are sent to the peer in
+        batches. */
+    virtual bool
+    txBatchEnabled() const = 0;
 };
 
 }  // namespace ripple
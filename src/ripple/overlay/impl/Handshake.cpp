@@ -75,7 +75,8 @@ makeFeaturesRequestHeader(
     bool comprEnabled,
     bool ledgerReplayEnabled,
     bool txReduceRelayEnabled,
-    bool vpReduceRelayEnabled)
+    bool vpReduceRelayEnabled,
+    bool txBatchEnabled)
 {
     std::stringstream str;
     if (comprEnabled)
@@ -86,6 +87,8 @@ makeFeaturesRequestHeader(
         str << FEATURE_TXRR << "=1" << DELIM_FEATURE;
     if (vpReduceRelayEnabled)
         str << FEATURE_VPRR << "=1" << DELIM_FEATURE;
+    if (txBatchEnabled)
+        str << FEATURE_TXBATCH << "=1" << DELIM_FEATURE;
     return str.str();
 }
 
@@ -95,7 +98,8 @@ makeFeaturesResponseHeader(
     bool comprEnabled,
     bool ledgerReplayEnabled,
     bool txReduceRelayEnabled,
-    bool vpReduceRelayEnabled)
+    bool vpReduceRelayEnabled,
+    bool txBatchEnabled)
 {
     std::stringstream str;
     if (comprEnabled && isFeatureValue(headers, FEATURE_COMPR, "lz4"))
@@ -106,6 +110,8 @@ makeFeaturesResponseHeader(
         str << FEATURE_TXRR << "=1" << DELIM_FEATURE;
     if (vpReduceRelayEnabled && featureEnabled(headers, FEATURE_VPRR))
         str << FEATURE_VPRR << "=1" << DELIM_FEATURE;
+    if (txBatchEnabled && featureEnabled(headers, FEATURE_TXBATCH))
+        str << FEATURE_TXBATCH << "=1" << DELIM_FEATURE;
     return str.str();
 }
 
@@ -372,7 +378,8 @@ makeRequest(
     bool comprEnabled,
     bool ledgerReplayEnabled,
     bool txReduceRelayEnabled,
-    bool vpReduceRelayEnabled) -> request_type
+    bool vpReduceRelayEnabled,
+    bool txBatchEnabled) -> request_type
 {
     request_type m;
     m.method(boost::beast::http::verb::get);
@@ -389,7 +396,8 @@ makeRequest(
             comprEnabled,
             ledgerReplayEnabled,
             txReduceRelayEnabled,
-            vpReduceRelayEnabled));
+            vpReduceRelayEnabled,
+            txBatchEnabled));
     return m;
 }
 
@@ -419,7 +427,8 @@ makeResponse(
             app.config().COMPRESSION,
             app.config().LEDGER_REPLAY,
             app.config().TX_REDUCE_RELAY_ENABLE,
-            app.config().VP_REDUCE_RELAY_ENABLE));
+            app.config().VP_REDUCE_RELAY_ENABLE,
+            app.config().TX_BATCH));
 
     buildHandshake(resp, sharedValue, networkID, public_ip, remote_ip, app);
 
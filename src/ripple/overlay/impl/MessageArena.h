@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_MESSAGEARENA_H_INCLUDED
+#define RIPPLE_OVERLAY_MESSAGEARENA_H_INCLUDED
+
+#include <ripple/basics/ByteUtilities.h>
+#include <google/protobuf/arena.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Recycles the protobuf arenas that inbound protocol messages live in.
+
+    Each message read from a peer is parsed into its own arena, so the
+    message and all of its repeated fields and sub-messages are carved out
+    of a few large blocks instead of being allocated one by one. The first
+    block is allocated together with the arena, and once the last reference
+    to the message is gone the arena is reset and kept for the next message,
+    so most messages are parsed without touching the heap at all.
+*/
+class MessageArenaPool
+{
+public:
+    /** Size of the block each arena starts with. */
+    static constexpr std::size_t initialBlockSize = 8 * 1024;
+
+    /** The largest block an arena allocates once the first one is full. */
+    static constexpr std::size_t maxBlockSize = megabytes(1);
+
+    /** The most idle arenas kept for reuse. */
+    static constexpr std::size_t maxIdle = 256;
+
+private:
+    struct Entry
+    {
+        alignas(std::max_align_t) char block[initialBlockSize];
+        google::protobuf::Arena arena;
+
+        Entry() : arena(options(block))
+        {
+        }
+
+        static google::protobuf::ArenaOptions
+        options(char* block)
+        {
+            google::protobuf::ArenaOptions o;
+            o.initial_block = block;
+            o.initial_block_size = initialBlockSize;
+            o.start_block_size = initialBlockSize;
+            o.max_block_size = maxBlockSize;
+            return o;
+        }
+    };
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Entry>> idle_;
+
+    std::unique_ptr<Entry>
+    acquire()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            if (!idle_.empty())
+            {
+                auto entry = std::move(idle_.back());
+                idle_.pop_back();
+                return entry;
+            }
+        }
+        return std::make_unique<Entry>();
+    }
+
+    void
+    release(std::unique_ptr<Entry> entry)
+    {
+        // Resetting frees any blocks beyond the first, so a large message
+        // does not pin its memory while the arena sits idle.
+        entry->arena.Reset();
+
+        std::lock_guard lock(mutex_);
+        if (idle_.size() < maxIdle)
+            idle_.push_back(std::move(entry));
+    }
+
+public:
+    static MessageArenaPool&
+    instance()
+    {
+        static MessageArenaPool pool;
+        return pool;
+    }
+
+    /** Returns a new, empty message allocated on a pooled arena.
+
+        The arena is owned by the returned pointer: it goes back to the
+        pool when the last copy is destroyed, on whichever thread that is.
+        Handlers may therefore keep or pass on the message exactly as they
+        would one allocated with std::make_shared.
+    */
+    template <class T>
+    std::shared_ptr<T>
+    make()
+    {
+        auto entry = acquire();
+        T* const m = google::protobuf::Arena::CreateMessage<T>(&entry->arena);
+
+        std::shared_ptr<Entry> owner(entry.release(), [](Entry* e) {
+            instance().release(std::unique_ptr<Entry>(e));
+        });
+
+        return std::shared_ptr<T>(std::move(owner), m);
+    }
+
+    /** The number of idle arenas held for reuse. */
+    std::size_t
+    idle()
+    {
+        std::lock_guard lock(mutex_);
+        return idle_.size();
+    }
+};
+
+/** Returns a scratch buffer of the given size for decompressing a message.
+
+    A decompressed payload is parsed, and so copied out of the buffer, before
+    the next message is read on the same thread, so each thread reuses a
+    single buffer. One that grew to hold an unusually large message is
+    released once a message of ordinary size comes along.
+*/
+inline std::vector<std::uint8_t>&
+decompressionBuffer(std::size_t size)
+{
+    constexpr std::size_t maxRetained = megabytes(1);
+
+    thread_local std::vector<std::uint8_t> buffer;
+
+    if (buffer.capacity() > maxRetained && size <= maxRetained)
+        std::vector<std::uint8_t>().swap(buffer);
+
+    buffer.resize(size);
+    return buffer;
+}
+
+}  // namespace ripple
+
+#endif
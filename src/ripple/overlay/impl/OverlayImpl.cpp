@@ -41,6 +41,8 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/utility/in_place_factory.hpp>
 
+#include <map>
+
 namespace ripple {
 
 namespace CrawlOptions {
@@ -114,6 +116,84 @@ OverlayImpl::Timer::on_timer(error_code ec)
 
 //------------------------------------------------------------------------------
 
+OverlayImpl::TxBatch::TxBatch(OverlayImpl& overlay)
+    : Child(overlay), timer_(overlay_.io_service_)
+{
+}
+
+void
+OverlayImpl::TxBatch::stop()
+{
+    // Called on the strand that calls TxBatch::on_timer. The transactions
+    // not yet sent are dropped.
+    stopping_ = true;
+    timer_.cancel();
+    std::lock_guard lock(overlay_.txBatchMutex_);
+    if (overlay_.txBatch_.get() == this)
+        overlay_.txBatch_.reset();
+}
+
+void
+OverlayImpl::TxBatch::async_wait()
+{
+    timer_.expires_after(Tuning::txBatchWindow);
+    timer_.async_wait(overlay_.strand_.wrap(std::bind(
+        &TxBatch::on_timer, shared_from_this(), std::placeholders::_1)));
+}
+
+void
+OverlayImpl::TxBatch::on_timer(error_code ec)
+{
+    if (ec || stopping_)
+    {
+        if (ec && ec != boost::asio::error::operation_aborted)
+        {
+            JLOG(overlay_.journal_.error()) << "on_timer: " << ec.message();
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(overlay_.txBatchMutex_);
+        // A full batch was sent already
+        if (overlay_.txBatch_.get() != this)
+            return;
+        overlay_.txBatch_.reset();
+    }
+
+    send();
+}
+
+void
+OverlayImpl::TxBatch::send()
+{
+    JLOG(overlay_.journal_.trace())
+        << "send tx batch " << txs_.size() << " to " << peers_.size();
+
+    // Keyed by the transactions a message holds
+    std::map<std::vector<std::uint16_t>, std::shared_ptr<Message>> messages;
+    for (auto const& [id, entry] : peers_)
+    {
+        auto const peer = entry.first.lock();
+        if (!peer)
+            continue;
+
+        auto& message = messages[entry.second];
+        if (!message)
+        {
+            protocol::TMTransactions batch;
+            batch.mutable_transactions()->Reserve(entry.second.size());
+            for (auto const i : entry.second)
+                *batch.add_transactions() = txs_[i];
+            message =
+                std::make_shared<Message>(batch, protocol::mtTRANSACTIONS);
+        }
+        peer->send(message);
+    }
+}
+
+//------------------------------------------------------------------------------
+
 OverlayImpl::OverlayImpl(
     Application& app,
     Setup const& setup,
@@ -1288,6 +1368,15 @@ OverlayImpl::relay(
     std::set<Peer::id_t> const& toSkip)
 {
     auto const sm = std::make_shared<Message>(m, protocol::mtTRANSACTION);
+    // Peers with the transaction batching feature enabled are sent the
+    // transaction in the next batch instead of sm
+    std::vector<std::shared_ptr<Peer>> batched;
+    auto send = [&](std::shared_ptr<Peer> const& p) {
+        if (p->txBatchEnabled())
+            batched.push_back(p);
+        else
+            p->send(sm);
+    };
     std::size_t total = 0;
     std::size_t disabled = 0;
     std::size_t enabledInSkip = 0;
@@ -1299,7 +1388,8 @@ OverlayImpl::relay(
     if (!app_.config().TX_REDUCE_RELAY_ENABLE || total <= minRelay)
     {
         for (auto const& p : peers)
-            p->send(sm);
+            send(p);
+        batchTransaction(m, batched);
         if (app_.config().TX_REDUCE_RELAY_ENABLE ||
             app_.config().TX_REDUCE_RELAY_METRICS)
             txMetrics_.addMetrics(total, toSkip.size(), 0);
@@ -1328,18 +1418,61 @@ OverlayImpl::relay(
         // always relay to a peer with the disabled feature
         if (!p->txReduceRelayEnabled())
         {
-            p->send(sm);
+            send(p);
         }
         else if (enabledAndRelayed < enabledTarget)
         {
             enabledAndRelayed++;
-            p->send(sm);
+            send(p);
         }
         else
         {
             p->addTxQueue(hash);
         }
     }
+    batchTransaction(m, batched);
+}
+
+void
+OverlayImpl::batchTransaction(
+    protocol::TMTransaction const& m,
+    std::vector<std::shared_ptr<Peer>> const& peers)
+{
+    if (peers.empty())
+        return;
+
+    std::shared_ptr<TxBatch> full;
+    {
+        std::lock_guard lock(txBatchMutex_);
+        if (!txBatch_)
+        {
+            std::lock_guard l(mutex_);
+            // The overlay is stopping
+            if (!work_)
+                return;
+            txBatch_ = std::make_shared<TxBatch>(*this);
+            txBatch_->async_wait();
+            list_.emplace(txBatch_.get(), txBatch_);
+        }
+
+        auto const index =
+            static_cast<std::uint16_t>(txBatch_->txs_.size());
+        txBatch_->txs_.push_back(m);
+        for (auto const& p : peers)
+        {
+            auto& entry = txBatch_->peers_[p->id()];
+            if (entry.second.empty())
+                entry.first = p;
+            entry.second.push_back(index);
+        }
+
+        // The timer finds the batch sent already when it expires
+        if (txBatch_->txs_.size() >= Tuning::txBatchMessages)
+            full = std::move(txBatch_);
+    }
+
+    if (full)
+        full->send();
 }
 
 //------------------------------------------------------------------------------
@@ -49,6 +49,7 @@
 #include <mutex>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace ripple {
 
@@ -96,6 +97,42 @@ private:
         on_timer(error_code ec);
     };
 
+    /** Transactions relayed to peers with the transaction batching feature
+        enabled, collected for Tuning::txBatchWindow or up to
+        Tuning::txBatchMessages transactions. Each peer is then sent the
+        transactions relayed to it as one TMTransactions message. Peers
+        sent the same transactions share the message, so it is serialized
+        and compressed once.
+    */
+    struct TxBatch : Child, std::enable_shared_from_this<TxBatch>
+    {
+        boost::asio::basic_waitable_timer<clock_type> timer_;
+        bool stopping_{false};
+        std::vector<protocol::TMTransaction> txs_;
+        // The peers and the indexes in txs_ of the transactions relayed
+        // to each
+        hash_map<
+            Peer::id_t,
+            std::pair<std::weak_ptr<Peer>, std::vector<std::uint16_t>>>
+            peers_;
+
+        explicit TxBatch(OverlayImpl& overlay);
+
+        void
+        stop() override;
+
+        void
+        async_wait();
+
+        void
+        on_timer(error_code ec);
+
+        /** Send the batch. It must no longer be the overlay's current one.
+         */
+        void
+        send();
+    };
+
     Application& app_;
     boost::asio::io_service& io_service_;
     std::optional<boost::asio::io_service::work> work_;
@@ -116,6 +153,8 @@ private:
     std::atomic<Peer::id_t> next_id_;
     int timer_count_;
     std::atomic<uint64_t> jqTransOverflow_{0};
+    // Transactions received in batches, waiting for the job checking them
+    std::atomic<std::size_t> jqTransBatched_{0};
     std::atomic<uint64_t> peerDisconnects_{0};
     std::atomic<uint64_t> peerDisconnectsCharges_{0};
 
@@ -130,6 +169,11 @@ private:
     // Transaction reduce-relay metrics
     metrics::TxMetrics txMetrics_;
 
+    // The batch relayed transactions are added to
+    std::shared_ptr<TxBatch> txBatch_;
+    // Protects txBatch_ and its transactions and peers
+    std::mutex txBatchMutex_;
+
     // A message with the list of manifests we send to peers
     std::shared_ptr<Message> manifestMessage_;
     // Used to track whether we need to update the cached list of manifests
@@ -362,6 +406,24 @@ public:
         return jqTransOverflow_;
     }
 
+    void
+    addJqTransBatched(std::size_t count)
+    {
+        jqTransBatched_ += count;
+    }
+
+    void
+    removeJqTransBatched(std::size_t count)
+    {
+        jqTransBatched_ -= count;
+    }
+
+    std::size_t
+    getJqTransBatched() const
+    {
+        return jqTransBatched_;
+    }
+
     void
     incPeerDisconnect() override
     {
@@ -565,6 +627,16 @@ private:
     void
     sendTxQueue();
 
+    /** Add a relayed transaction to the current batch.
+        @param m the transaction
+        @param peers the peers with the transaction batching feature enabled
+               the transaction is relayed to
+     */
+    void
+    batchTransaction(
+        protocol::TMTransaction const& m,
+        std::vector<std::shared_ptr<Peer>> const& peers);
+
     /** Check if peers stopped relaying messages
      * and if slots stopped receiving messages from the validator */
     void
@@ -46,6 +46,7 @@
 #include <boost/beast/core/ostream.hpp>
 
 #include <algorithm>
+#include <bit>
 #include <memory>
 #include <mutex>
 #include <numeric>
@@ -120,6 +121,8 @@ PeerImp::PeerImp(
           headers_,
           FEATURE_LEDGER_REPLAY,
           app_.config().LEDGER_REPLAY))
+    , txBatchEnabled_(
+          peerFeatureEnabled(headers_, FEATURE_TXBATCH, app_.config().TX_BATCH))
     , ledgerReplayMsgHandler_(app, app.getLedgerReplayer())
 {
     JLOG(journal_.info()) << "compression enabled "
@@ -240,55 +243,12 @@ PeerImp::stop()
 void
 PeerImp::send(std::shared_ptr<Message> const& m)
 {
-    if (!strand_.running_in_this_thread())
-        return post(strand_, std::bind(&PeerImp::send, shared_from_this(), m));
-    if (gracefulClose_)
-        return;
-    if (detaching_)
-        return;
-
-    auto validator = m->getValidatorKey();
-    if (validator && !squelch_.expireSquelch(*validator))
-        return;
-
-    overlay_.reportTraffic(
-        safe_cast<TrafficCount::category>(m->getCategory()),
-        false,
-        static_cast<int>(m->getBuffer(compressionEnabled_).size()));
-
-    auto sendq_size = send_queue_.size();
-
-    if (sendq_size < Tuning::targetSendQueue)
-    {
-        // To detect a peer that does not read from their
-        // side of the connection, we expect a peer to have
-        // a small senq periodically
-        large_sendq_ = 0;
-    }
-    else if (auto sink = journal_.debug();
-             sink && (sendq_size % Tuning::sendQueueLogFreq) == 0)
-    {
-        std::string const n = name();
-        sink << (n.empty() ? remote_address_.to_string() : n)
-             << " sendq: " << sendq_size;
-    }
-
-    send_queue_.push(m);
-
-    if (sendq_size != 0)
-        return;
-
-    boost::asio::async_write(
-        stream_,
-        boost::asio::buffer(
-            send_queue_.front()->getBuffer(compressionEnabled_)),
-        bind_executor(
-            strand_,
-            std::bind(
-                &PeerImp::onWriteMessage,
-                shared_from_this(),
-                std::placeholders::_1,
-                std::placeholders::_2)));
+    // Any thread may hand over a message without taking a lock. Only the
+    // one finding nothing waiting posts to the strand, so a burst of
+    // messages costs a single post.
+    ++sendq_size_;
+    if (send_inbox_.push(m))
+        post(strand_, std::bind(&PeerImp::onSend, shared_from_this()));
 }
 
 void
@@ -490,6 +450,8 @@ PeerImp::json()
         std::to_string(metrics_.recv.average_bytes());
     ret[jss::metrics][jss::avg_bps_sent] =
         std::to_string(metrics_.sent.average_bytes());
+    ret[jss::metrics][jss::send_batch_size] = metrics_.sendBatch.json();
+    ret[jss::metrics][jss::send_queue_size] = metrics_.sendQueue.json();
 
     return ret;
 }
@@ -945,6 +907,95 @@ PeerImp::onReadMessage(error_code ec, std::size_t bytes_transferred)
                 std::placeholders::_2)));
 }
 
+void
+PeerImp::takeSends()
+{
+    assert(strand_.running_in_this_thread());
+    send_inbox_.consume([this](std::shared_ptr<Message>&& m) {
+        if (gracefulClose_ || detaching_)
+        {
+            --sendq_size_;
+            return;
+        }
+
+        auto validator = m->getValidatorKey();
+        if (validator && !squelch_.expireSquelch(*validator))
+        {
+            --sendq_size_;
+            return;
+        }
+
+        overlay_.reportTraffic(
+            safe_cast<TrafficCount::category>(m->getCategory()),
+            false,
+            static_cast<int>(m->getBuffer(compressionEnabled_).size()));
+
+        auto sendq_size = send_queue_.size();
+
+        if (sendq_size < Tuning::targetSendQueue)
+        {
+            // To detect a peer that does not read from their
+            // side of the connection, we expect a peer to have
+            // a small senq periodically
+            large_sendq_ = 0;
+        }
+        else if (auto sink = journal_.debug();
+                 sink && (sendq_size % Tuning::sendQueueLogFreq) == 0)
+        {
+            std::string const n = name();
+            sink << (n.empty() ? remote_address_.to_string() : n)
+                 << " sendq: " << sendq_size;
+        }
+
+        send_queue_.push_back(std::move(m));
+        metrics_.sendQueue.add(send_queue_.size());
+    });
+}
+
+void
+PeerImp::onSend()
+{
+    takeSends();
+    if (writing_ == 0 && !send_queue_.empty())
+        writeSends();
+}
+
+void
+PeerImp::writeSends()
+{
+    assert(strand_.running_in_this_thread());
+    assert(writing_ == 0 && !send_queue_.empty());
+
+    // Gather as many queued messages as a batch holds into one write, so
+    // a burst of small messages costs few writes to the socket.
+    std::vector<boost::asio::const_buffer> buffers;
+    std::size_t bytes = 0;
+    for (auto const& m : send_queue_)
+    {
+        if (buffers.size() == Tuning::sendBatchMessages ||
+            bytes >= Tuning::sendBatchBytes)
+            break;
+
+        auto const& buffer = m->getBuffer(compressionEnabled_);
+        buffers.emplace_back(buffer.data(), buffer.size());
+        bytes += buffer.size();
+    }
+
+    writing_ = buffers.size();
+    metrics_.sendBatch.add(writing_);
+
+    boost::asio::async_write(
+        stream_,
+        buffers,
+        bind_executor(
+            strand_,
+            std::bind(
+                &PeerImp::onWriteMessage,
+                shared_from_this(),
+                std::placeholders::_1,
+                std::placeholders::_2)));
+}
+
 void
 PeerImp::onWriteMessage(error_code ec, std::size_t bytes_transferred)
 {
@@ -964,22 +1015,17 @@ PeerImp::onWriteMessage(error_code ec, std::size_t bytes_transferred)
 
     metrics_.sent.add_message(bytes_transferred);
 
-    assert(!send_queue_.empty());
-    send_queue_.pop();
+    assert(writing_ != 0 && send_queue_.size() >= writing_);
+    send_queue_.erase(send_queue_.begin(), send_queue_.begin() + writing_);
+    sendq_size_ -= writing_;
+    writing_ = 0;
+
+    // Messages handed over during the write join the next one
+    takeSends();
     if (!send_queue_.empty())
     {
         // Timeout on writes only
-        return boost::asio::async_write(
-            stream_,
-            boost::asio::buffer(
-                send_queue_.front()->getBuffer(compressionEnabled_)),
-            bind_executor(
-                strand_,
-                std::bind(
-                    &PeerImp::onWriteMessage,
-                    shared_from_this(),
-                    std::placeholders::_1,
-                    std::placeholders::_2)));
+        return writeSends();
     }
 
     if (gracefulClose_)
@@ -1535,7 +1581,82 @@ PeerImp::handleTransaction(
         return;
     }
 
-    SerialIter sit(makeSlice(m->rawtransaction()));
+    auto const tx = receiveTransaction(*m, eraseTxQueue);
+    if (!tx || checkableTransactions() == 0)
+        return;
+
+    app_.getJobQueue().addJob(
+        jtTRANSACTION,
+        "recvTransaction->checkTransaction",
+        [weak = std::weak_ptr<PeerImp>(shared_from_this()),
+         flags = tx->flags,
+         checkSignature = tx->checkSignature,
+         stx = tx->stx]() {
+            if (auto peer = weak.lock())
+                peer->checkTransaction(flags, checkSignature, stx);
+        });
+}
+
+void
+PeerImp::handleTransactions(
+    std::shared_ptr<protocol::TMTransactions> const& m,
+    bool eraseTxQueue)
+{
+    if (tracking_.load() == Tracking::diverged)
+        return;
+
+    if (app_.getOPs().isNeedNetworkLedger())
+    {
+        JLOG(p_journal_.debug()) << "Ignoring incoming transactions: "
+                                 << "Need network ledger";
+        return;
+    }
+
+    auto const room = checkableTransactions();
+    if (room == 0)
+        return;
+
+    std::vector<ReceivedTransaction> txs;
+    txs.reserve(std::min<std::size_t>(m->transactions_size(), room));
+    for (auto const& tm : m->transactions())
+    {
+        // The rest are left unmarked in the HashRouter, so that they are
+        // taken when relayed again
+        if (txs.size() == room)
+        {
+            overlay_.incJqTransOverflow();
+            JLOG(p_journal_.info()) << "Transaction queue is full";
+            break;
+        }
+
+        if (auto tx = receiveTransaction(tm, eraseTxQueue))
+            txs.push_back(std::move(*tx));
+    }
+
+    if (txs.empty())
+        return;
+
+    auto const count = txs.size();
+    overlay_.addJqTransBatched(count);
+    if (!app_.getJobQueue().addJob(
+            jtTRANSACTION,
+            "recvTransactions->checkTransactions",
+            [weak = std::weak_ptr<PeerImp>(shared_from_this()),
+             &overlay = overlay_,
+             txs = std::move(txs)]() {
+                overlay.removeJqTransBatched(txs.size());
+                if (auto peer = weak.lock())
+                    peer->checkTransactions(txs);
+            }))
+        overlay_.removeJqTransBatched(count);
+}
+
+std::optional<PeerImp::ReceivedTransaction>
+PeerImp::receiveTransaction(
+    protocol::TMTransaction const& m,
+    bool eraseTxQueue)
+{
+    SerialIter sit(makeSlice(m.rawtransaction()));
 
     try
     {
@@ -1548,7 +1669,7 @@ PeerImp::handleTransaction(
             JLOG(p_journal_.warn()) << "Ignoring Network relayed Tx containing "
                                        "sfEmitDetails (handleTransaction).";
             fee_ = Resource::feeHighBurdenPeer;
-            return;
+            return std::nullopt;
         }
 
         int flags;
@@ -1568,7 +1689,7 @@ PeerImp::handleTransaction(
             else if (eraseTxQueue && txReduceRelayEnabled())
                 removeTxQueue(txID);
 
-            return;
+            return std::nullopt;
         }
 
         JLOG(p_journal_.debug()) << "Got tx " << txID;
@@ -1576,7 +1697,7 @@ PeerImp::handleTransaction(
         bool checkSignature = true;
         if (cluster())
         {
-            if (!m->has_deferred() || !m->deferred())
+            if (!m.has_deferred() || !m.deferred())
             {
                 // Skip local checks if a server we trust
                 // put the transaction in its open ledger
@@ -1591,38 +1712,39 @@ PeerImp::handleTransaction(
             }
         }
 
-        if (app_.getLedgerMaster().getValidatedLedgerAge() > 4min)
-        {
-            JLOG(p_journal_.trace())
-                << "No new transactions until synchronized";
-        }
-        else if (
-            app_.getJobQueue().getJobCount(jtTRANSACTION) >
-            app_.config().MAX_TRANSACTIONS)
-        {
-            overlay_.incJqTransOverflow();
-            JLOG(p_journal_.info()) << "Transaction queue is full";
-        }
-        else
-        {
-            app_.getJobQueue().addJob(
-                jtTRANSACTION,
-                "recvTransaction->checkTransaction",
-                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
-                 flags,
-                 checkSignature,
-                 stx]() {
-                    if (auto peer = weak.lock())
-                        peer->checkTransaction(flags, checkSignature, stx);
-                });
-        }
+        return ReceivedTransaction{std::move(stx), flags, checkSignature};
     }
     catch (std::exception const& ex)
     {
         JLOG(p_journal_.warn())
-            << "Transaction invalid: " << strHex(m->rawtransaction())
+            << "Transaction invalid: " << strHex(m.rawtransaction())
             << ". Exception: " << ex.what();
     }
+
+    return std::nullopt;
+}
+
+std::size_t
+PeerImp::checkableTransactions()
+{
+    if (app_.getLedgerMaster().getValidatedLedgerAge() > 4min)
+    {
+        JLOG(p_journal_.trace()) << "No new transactions until synchronized";
+        return 0;
+    }
+
+    auto const queued = app_.getJobQueue().getJobCount(jtTRANSACTION) +
+        overlay_.getJqTransBatched();
+    auto const limit =
+        static_cast<std::size_t>(std::max(app_.config().MAX_TRANSACTIONS, 0));
+    if (queued >= limit)
+    {
+        overlay_.incJqTransOverflow();
+        JLOG(p_journal_.info()) << "Transaction queue is full";
+        return 0;
+    }
+
+    return limit - queued;
 }
 
 void
@@ -2650,7 +2772,7 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
     if (packet.query())
     {
         // this is a query
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        if (sendq_size_ >= Tuning::dropSendQueue)
         {
             JLOG(p_journal_.debug()) << "GetObject: Large send queue";
             return;
@@ -2867,16 +2989,25 @@ PeerImp::handleHaveTransactions(
         << "transaction request object is " << tmBH.objects_size();
 
     if (tmBH.objects_size() > 0)
+    {
+        // Bounded, since the peer may leave a request unanswered
+        std::size_t const count = tmBH.objects_size();
+        auto requested = txRequested_.load();
+        while (!txRequested_.compare_exchange_weak(
+            requested,
+            std::min(requested + count, reduce_relay::MAX_TX_QUEUE_SIZE)))
+            ;
         send(std::make_shared<Message>(tmBH, protocol::mtGET_OBJECTS));
+    }
 }
 
 void
 PeerImp::onMessage(std::shared_ptr<protocol::TMTransactions> const& m)
 {
-    if (!txReduceRelayEnabled())
+    if (!txReduceRelayEnabled() && !txBatchEnabled_)
     {
-        JLOG(p_journal_.error())
-            << "TMTransactions: tx reduce-relay is disabled";
+        JLOG(p_journal_.error()) << "TMTransactions: tx reduce-relay and "
+                                    "tx batching are disabled";
         fee_ = Resource::feeInvalidRequest;
         return;
     }
@@ -2884,13 +3015,29 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMTransactions> const& m)
     JLOG(p_journal_.trace())
         << "received TMTransactions " << m->transactions_size();
 
+    // A reply to a tx reduce-relay request holds up to the number of
+    // transactions requested. Any other message is a batch, which holds
+    // at most Tuning::txBatchMessages.
+    std::size_t const size = m->transactions_size();
+    auto requested = txRequested_.load();
+    auto replied = std::min(requested, size);
+    while (!txRequested_.compare_exchange_weak(requested, requested - replied))
+        replied = std::min(requested, size);
+
+    std::size_t const batch = txBatchEnabled_ ? Tuning::txBatchMessages : 0;
+    if (size - replied > batch)
+    {
+        JLOG(p_journal_.warn())
+            << "TMTransactions: too many transactions " << size;
+        fee_ = Resource::feeInvalidRequest;
+        return;
+    }
+
     overlay_.addTxMetrics(m->transactions_size());
 
-    for (std::uint32_t i = 0; i < m->transactions_size(); ++i)
-        handleTransaction(
-            std::shared_ptr<protocol::TMTransaction>(
-                m->mutable_transactions(i), [](protocol::TMTransaction*) {}),
-            false);
+    // A peer batching its transactions relays them in TMTransactions, so
+    // they are erased from txQueue_ as they would be for TMTransaction.
+    handleTransactions(m, txBatchEnabled_);
 }
 
 void
@@ -3059,6 +3206,45 @@ PeerImp::checkTransaction(
     int flags,
     bool checkSignature,
     std::shared_ptr<STTx const> const& stx)
+{
+    if (auto tx = validateTransaction(checkSignature, stx))
+    {
+        bool const trusted(flags & SF_TRUSTED);
+        app_.getOPs().processTransaction(
+            tx, trusted, false, NetworkOPs::FailHard::no);
+    }
+}
+
+// Called from our JobQueue
+void
+PeerImp::checkTransactions(std::vector<ReceivedTransaction> const& txs)
+{
+    // Transactions are handed over in two sets, since NetworkOPs applies
+    // those from a trusted source differently.
+    std::vector<std::shared_ptr<Transaction>> trusted;
+    std::vector<std::shared_ptr<Transaction>> untrusted;
+
+    for (auto const& [stx, flags, checkSignature] : txs)
+    {
+        if (auto tx = validateTransaction(checkSignature, stx))
+        {
+            if (flags & SF_TRUSTED)
+                trusted.push_back(std::move(tx));
+            else
+                untrusted.push_back(std::move(tx));
+        }
+    }
+
+    if (!trusted.empty())
+        app_.getOPs().processTransactionSet(trusted, true);
+    if (!untrusted.empty())
+        app_.getOPs().processTransactionSet(untrusted, false);
+}
+
+std::shared_ptr<Transaction>
+PeerImp::validateTransaction(
+    bool checkSignature,
+    std::shared_ptr<STTx const> const& stx)
 {
     // VFALCO TODO Rewrite to not use exceptions
     try
@@ -3069,7 +3255,7 @@ PeerImp::checkTransaction(
             JLOG(p_journal_.warn()) << "Ignoring Network relayed Tx containing "
                                        "sfEmitDetails (checkSignature).";
             charge(Resource::feeHighBurdenPeer);
-            return;
+            return nullptr;
         }
 
         // Expired?
@@ -3079,7 +3265,7 @@ PeerImp::checkTransaction(
         {
             app_.getHashRouter().setFlags(stx->getTransactionID(), SF_BAD);
             charge(Resource::feeUnwantedData);
-            return;
+            return nullptr;
         }
 
         if (checkSignature)
@@ -3101,7 +3287,7 @@ PeerImp::checkTransaction(
                 // Probably not necessary to set SF_BAD, but doesn't hurt.
                 app_.getHashRouter().setFlags(stx->getTransactionID(), SF_BAD);
                 charge(Resource::feeInvalidSignature);
-                return;
+                return nullptr;
             }
         }
         else
@@ -3122,12 +3308,10 @@ PeerImp::checkTransaction(
             }
             app_.getHashRouter().setFlags(stx->getTransactionID(), SF_BAD);
             charge(Resource::feeInvalidSignature);
-            return;
+            return nullptr;
         }
 
-        bool const trusted(flags & SF_TRUSTED);
-        app_.getOPs().processTransaction(
-            tx, trusted, false, NetworkOPs::FailHard::no);
+        return tx;
     }
     catch (std::exception const& ex)
     {
@@ -3136,6 +3320,8 @@ PeerImp::checkTransaction(
         app_.getHashRouter().setFlags(stx->getTransactionID(), SF_BAD);
         charge(Resource::feeBadData);
     }
+
+    return nullptr;
 }
 
 // Called from our JobQueue
@@ -3494,7 +3680,7 @@ PeerImp::processLedgerRequest(std::shared_ptr<protocol::TMGetLedger> const& m)
     }
     else
     {
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        if (sendq_size_ >= Tuning::dropSendQueue)
         {
             JLOG(p_journal_.debug())
                 << "processLedgerRequest: Large send queue";
@@ -3729,4 +3915,36 @@ PeerImp::Metrics::total_bytes() const
     return totalBytes_;
 }
 
+void
+PeerImp::Histogram::add(std::size_t value)
+{
+    std::size_t const i = std::min<std::size_t>(
+        std::bit_width(value), counts_.size() - 1);
+    counts_[i].fetch_add(1, std::memory_order_relaxed);
+}
+
+Json::Value
+PeerImp::Histogram::json() const
+{
+    Json::Value ret(Json::objectValue);
+    for (std::size_t i = 0; i < counts_.size(); ++i)
+    {
+        auto const count = counts_[i].load(std::memory_order_relaxed);
+        if (count == 0)
+            continue;
+
+        std::string range;
+        if (i < 2)
+            range = std::to_string(i);
+        else if (i + 1 == counts_.size())
+            range = std::to_string(1ull << (i - 1)) + "+";
+        else
+            range = std::to_string(1ull << (i - 1)) + "-" +
+                std::to_string((1ull << i) - 1);
+
+        ret[range] = std::to_string(count);
+    }
+    return ret;
+}
+
 }  // namespace ripple
@@ -23,6 +23,7 @@
 #include <ripple/app/consensus/RCLCxPeerPos.h>
 #include <ripple/app/ledger/impl/LedgerReplayMsgHandler.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/MPSCQueue.h>
 #include <ripple/basics/RangeSet.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/beast/utility/WrappedSink.h>
@@ -40,14 +41,18 @@
 #include <boost/circular_buffer.hpp>
 #include <boost/endian/conversion.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <optional>
-#include <queue>
+#include <vector>
 
 namespace ripple {
 
 struct ValidatorBlobInfo;
 class SHAMap;
+class Transaction;
 
 class PeerImp : public Peer,
                 public std::enable_shared_from_this<PeerImp>,
@@ -155,7 +160,15 @@ private:
     http_request_type request_;
     http_response_type response_;
     boost::beast::http::fields const& headers_;
-    std::queue<std::shared_ptr<Message>> send_queue_;
+    // Messages handed to send(), from any thread, which the strand has
+    // not yet moved to send_queue_.
+    MPSCQueue<std::shared_ptr<Message>> send_inbox_;
+    // Messages to write, oldest first. The first `writing_` of them are
+    // being written.
+    std::deque<std::shared_ptr<Message>> send_queue_;
+    std::size_t writing_ = 0;
+    // The messages in send_inbox_ and send_queue_, for use off the strand.
+    std::atomic<std::size_t> sendq_size_{0};
     bool gracefulClose_ = false;
     int large_sendq_ = 0;
     std::unique_ptr<LoadEvent> load_event_;
@@ -179,6 +192,11 @@ private:
     // on the peer.
     bool vpReduceRelayEnabled_ = false;
     bool ledgerReplayEnabled_ = false;
+    // true if transaction batching feature is enabled on the peer.
+    bool txBatchEnabled_ = false;
+    // Number of transactions requested from the peer by tx reduce-relay
+    // and not yet received. A reply may hold more than a batch.
+    std::atomic<std::size_t> txRequested_{0};
     LedgerReplayMsgHandler ledgerReplayMsgHandler_;
 
     friend class OverlayImpl;
@@ -210,10 +228,30 @@ private:
         std::uint64_t rollingAvgBytes_{0};
     };
 
+    /** Counts how often a value fell in each power of two range. */
+    class Histogram
+    {
+    public:
+        void
+        add(std::size_t value);
+
+        /** Returns the counts of the ranges with any, keyed by range. */
+        Json::Value
+        json() const;
+
+    private:
+        // The ranges 0, 1, 2-3, 4-7, ... and the open ended last range.
+        std::array<std::atomic<std::uint64_t>, 12> counts_{};
+    };
+
     struct
     {
         Metrics sent;
         Metrics recv;
+        // Messages per write.
+        Histogram sendBatch;
+        // Messages queued, counted as each message is queued.
+        Histogram sendQueue;
     } metrics_;
 
 public:
@@ -431,6 +469,12 @@ public:
         return txReduceRelayEnabled_;
     }
 
+    bool
+    txBatchEnabled() const override
+    {
+        return txBatchEnabled_;
+    }
+
 private:
     void
     close();
@@ -479,6 +523,19 @@ private:
     void
     onReadMessage(error_code ec, std::size_t bytes_transferred);
 
+    // Moves the messages handed to send() to the send queue
+    void
+    takeSends();
+
+    // Takes the messages handed to send() and writes them, unless a write
+    // is in progress
+    void
+    onSend();
+
+    // Writes a batch of messages from the front of the send queue
+    void
+    writeSends();
+
     // Called when protocol messages bytes are sent
     void
     onWriteMessage(error_code ec, std::size_t bytes_transferred);
@@ -497,6 +554,38 @@ private:
         std::shared_ptr<protocol::TMTransaction> const& m,
         bool eraseTxQueue);
 
+    /** Called from onMessage(TMTransactions). The transactions are checked
+       by a single job and handed to NetworkOPs together.
+       @param m Transactions protocol message
+       @param eraseTxQueue see handleTransaction()
+     */
+    void
+    handleTransactions(
+        std::shared_ptr<protocol::TMTransactions> const& m,
+        bool eraseTxQueue);
+
+    // A transaction received from the peer, waiting to be checked
+    struct ReceivedTransaction
+    {
+        std::shared_ptr<STTx const> stx;
+        int flags;
+        bool checkSignature;
+    };
+
+    /** Deserialize a transaction received from the peer.
+       @return the transaction, or nothing if it is malformed or has been
+       seen recently
+     */
+    std::optional<ReceivedTransaction>
+    receiveTransaction(protocol::TMTransaction const& m, bool eraseTxQueue);
+
+    /** Returns how many more received transactions may be queued to be
+       checked. Each transaction of a batch counts against MAX_TRANSACTIONS
+       as a job for one transaction does.
+     */
+    std::size_t
+    checkableTransactions();
+
     /** Handle protocol message with hashes of transactions that have not
        been relayed by an upstream node down to its peers - request
        transactions, which have not been relayed to this peer.
@@ -617,6 +706,15 @@ private:
         bool checkSignature,
         std::shared_ptr<STTx const> const& stx);
 
+    void
+    checkTransactions(std::vector<ReceivedTransaction> const& txs);
+
+    // Returns the transaction if it passes the checks, nullptr otherwise
+    std::shared_ptr<Transaction>
+    validateTransaction(
+        bool checkSignature,
+        std::shared_ptr<STTx const> const& stx);
+
     void
     checkPropose(
         bool isTrusted,
@@ -705,6 +803,8 @@ PeerImp::PeerImp(
           headers_,
           FEATURE_LEDGER_REPLAY,
           app_.config().LEDGER_REPLAY))
+    , txBatchEnabled_(
+          peerFeatureEnabled(headers_, FEATURE_TXBATCH, app_.config().TX_BATCH))
     , ledgerReplayMsgHandler_(app, app.getLedgerReplayer())
 {
     read_buffer_.commit(boost::asio::buffer_copy(
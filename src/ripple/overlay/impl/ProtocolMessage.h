@@ -23,6 +23,7 @@
 #include <ripple/basics/ByteUtilities.h>
 #include <ripple/overlay/Compression.h>
 #include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/MessageArena.h>
 #include <ripple/overlay/impl/ZeroCopyStream.h>
 #include <ripple/protocol/messages.h>
 #include <boost/asio/buffer.hpp>
@@ -272,15 +273,14 @@ template <
 std::shared_ptr<T>
 parseMessageContent(MessageHeader const& header, Buffers const& buffers)
 {
-    auto const m = std::make_shared<T>();
+    auto const m = MessageArenaPool::instance().make<T>();
 
     ZeroCopyInputStream<Buffers> stream(buffers);
     stream.Skip(header.header_size);
 
     if (header.algorithm != compression::Algorithm::None)
     {
-        std::vector<std::uint8_t> payload;
-        payload.resize(header.uncompressed_size);
+        auto& payload = decompressionBuffer(header.uncompressed_size);
 
         auto const payloadSize = ripple::compression::decompress(
             stream,
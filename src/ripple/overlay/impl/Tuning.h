@@ -54,6 +54,12 @@ enum {
     /** How often to log send queue size */
     sendQueueLogFreq = 64,
 
+    /** The most messages written to a peer at once */
+    sendBatchMessages = 64,
+
+    /** The most transactions sent to a peer in one batch */
+    txBatchMessages = 256,
+
     /** How often we check for idle peers (seconds) */
     checkIdlePeers = 4,
 
@@ -64,6 +70,14 @@ enum {
 /** Size of buffer used to read from the socket. */
 std::size_t constexpr readBufferBytes = 16384;
 
+/** Once a batch of messages written to a peer at once holds this many
+    bytes, no more messages are added to it. */
+std::size_t constexpr sendBatchBytes = 262144;
+
+/** How long relayed transactions are collected before being sent to a peer
+    with the transaction batching feature enabled. */
+std::chrono::milliseconds constexpr txBatchWindow{20};
+
 }  // namespace Tuning
 
 }  // namespace ripple
@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_JSONMEMBERS_H_INCLUDED
+#define RIPPLE_PROTOCOL_JSONMEMBERS_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/STObject.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** A JSON object made of the fields of an STObject plus members of its own.
+
+    The object is written straight to compact JSON text, walking the fields
+    instead of building a Json::Value tree for them first. The text is byte
+    for byte what Json::FastWriter produces for the equivalent Value, whose
+    members are sorted by name, so it can be embedded in a larger document
+    as a Json::rawValue.
+
+    Members are added with operator[], as with a Json::Value, and replace
+    any field of the same name.
+*/
+class JsonMembers
+{
+public:
+    JsonMembers() = default;
+
+    /** The object holding the fields of object, as STObject::getJson(options)
+        returns them. Whatever overrides of getJson add is not included.
+
+        The object must outlive this.
+    */
+    explicit JsonMembers(
+        STObject const& object,
+        JsonOptions options = JsonOptions::none);
+
+    JsonMembers(JsonMembers&&) = default;
+    JsonMembers&
+    operator=(JsonMembers&&) = default;
+
+    Json::Value&
+    operator[](Json::StaticString const& key);
+
+    /** Append the object to out as compact JSON text. */
+    void
+    write(std::string& out) const;
+
+    /** The object as a single Json::rawValue. */
+    Json::Value
+    raw() const;
+
+    /** The object as an objectValue whose object and array members are
+        rawValues. Use when members still have to be added to the result.
+    */
+    Json::Value
+    object() const;
+
+    /** Append the JSON text of a field, as field.getJson(options). */
+    static void
+    write(std::string& out, STBase const& field, JsonOptions options);
+
+private:
+    STObject const* object_ = nullptr;
+    JsonOptions options_ = JsonOptions::none;
+    std::vector<std::pair<Json::StaticString, Json::Value>> members_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -31,6 +31,7 @@
 #include <optional>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -257,6 +258,38 @@ verify(
     Slice const& sig,
     bool mustBeFullyCanonical = true) noexcept;
 
+/** A signature to be checked as part of a batch. */
+struct SignatureCheck
+{
+    PublicKey publicKey;
+
+    // The signed message, unused when a digest is given
+    Slice message;
+
+    // For secp256k1 signatures made on a digest, see verifyDigest
+    std::optional<uint256> digest;
+
+    Slice signature;
+    bool mustBeFullyCanonical = true;
+};
+
+/** Verify many signatures at once.
+
+    Returns whether each signature is valid, in the order of the checks.
+    Ed25519 signatures are checked together using the batch verification
+    of ed25519-donna, which falls back to checking them one at a time only
+    when a batch fails. The other signatures are checked one at a time.
+    Large batches are spread over several threads.
+
+    @note Unlike verify(), the batch equation is randomized, and may accept
+          an Ed25519 signature deliberately built with small order
+          components by the holder of the key. Signatures from untrusted
+          keys whose acceptance must be the same on every server should be
+          checked with verify().
+*/
+std::vector<bool>
+verifyBatch(std::vector<SignatureCheck> const& checks);
+
 /** Calculate the 160-bit node ID from a node public key. */
 NodeID
 calcNodeID(PublicKey const&);
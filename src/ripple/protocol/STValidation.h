@@ -30,6 +30,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace ripple {
 
@@ -117,6 +118,15 @@ public:
     bool
     isValid() const noexcept;
 
+    /** Check the signatures of many validations at once.
+
+        Afterwards isValid() returns the result of the check for each of
+        them without checking again. A validation that is not signed with a
+        secp256k1 key, or whose signature cannot be read, is invalid.
+    */
+    static void
+    checkSignatures(std::vector<STValidation const*> const& validations);
+
     bool
     isFull() const noexcept;
 
@@ -237,6 +237,26 @@ sha512Half_s(Args const&... args)
     return static_cast<typename sha512_half_hasher_s::result_type>(h);
 }
 
+/** Computes the SHA512-Half of many messages of the same size.
+
+    When the processor has AVX2 or AVX-512, several messages are hashed at
+    once, one in each lane of the vector registers. Otherwise, or for a
+    single message, this is the same as calling sha512Half on each.
+
+    @param messages The messages, each size bytes long.
+    @param digests Receives the digest of each message.
+*/
+void
+sha512HalfBatch(
+    std::uint8_t const* const* messages,
+    std::size_t size,
+    uint256* digests,
+    std::size_t count);
+
+/** Returns how many messages sha512HalfBatch hashes at once. */
+std::size_t
+sha512HalfBatchLanes();
+
 }  // namespace ripple
 
 #endif
@@ -0,0 +1,228 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/json/json_writer.h>
+#include <ripple/protocol/JsonMembers.h>
+#include <ripple/protocol/STArray.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ripple {
+
+namespace {
+
+// appends s quoted, as Json::valueToQuotedString does
+void
+appendQuoted(std::string& out, char const* s)
+{
+    for (char const* c = s; *c; ++c)
+    {
+        if ((*c > 0 && *c <= 0x1F) || *c == '"' || *c == '\\')
+        {
+            out += Json::valueToQuotedString(s);
+            return;
+        }
+    }
+
+    out += '"';
+    out += s;
+    out += '"';
+}
+
+void
+appendValue(std::string& out, Json::Value const& value)
+{
+    if (value.isString())
+        return appendQuoted(out, value.asCString());
+
+    Json::detail::write_value(
+        [&out](void const* data, std::size_t n) {
+            out.append(static_cast<char const*>(data), n);
+        },
+        value);
+}
+
+struct Entry
+{
+    char const* key;
+    STBase const* field;
+    Json::Value const* value;
+};
+
+void
+writeObject(
+    std::string& out,
+    STObject const* object,
+    JsonOptions options,
+    std::vector<std::pair<Json::StaticString, Json::Value>> const* members)
+{
+    std::vector<Entry> entries;
+    entries.reserve(
+        (object ? object->getCount() : 0) + (members ? members->size() : 0));
+
+    if (object)
+    {
+        for (auto const& field : *object)
+        {
+            if (field.getSType() != STI_NOTPRESENT)
+                entries.push_back(
+                    {field.getFName().getJsonName().c_str(), &field, nullptr});
+        }
+    }
+
+    if (members)
+    {
+        for (auto const& [key, value] : *members)
+            entries.push_back({key.c_str(), nullptr, &value});
+    }
+
+    // Sorted as the members of a Json::Value are. Of entries with the same
+    // name the last one wins, so members replace fields.
+    std::stable_sort(
+        entries.begin(), entries.end(), [](Entry const& a, Entry const& b) {
+            return std::strcmp(a.key, b.key) < 0;
+        });
+
+    out += '{';
+    bool first = true;
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        auto const next = std::next(it);
+        if (next != entries.end() && std::strcmp(it->key, next->key) == 0)
+            continue;
+
+        if (!first)
+            out += ',';
+        first = false;
+
+        appendQuoted(out, it->key);
+        out += ':';
+        if (it->field)
+            JsonMembers::write(out, *it->field, options);
+        else
+            appendValue(out, *it->value);
+    }
+    out += '}';
+}
+
+}  // namespace
+
+JsonMembers::JsonMembers(STObject const& object, JsonOptions options)
+    : object_(&object), options_(options)
+{
+}
+
+Json::Value&
+JsonMembers::operator[](Json::StaticString const& key)
+{
+    for (auto& [k, value] : members_)
+    {
+        if (k == key)
+            return value;
+    }
+    return members_.emplace_back(key, Json::Value{}).second;
+}
+
+void
+JsonMembers::write(std::string& out) const
+{
+    writeObject(out, object_, options_, &members_);
+}
+
+Json::Value
+JsonMembers::raw() const
+{
+    std::string text;
+    write(text);
+    return Json::Value{Json::RawJson{text}};
+}
+
+Json::Value
+JsonMembers::object() const
+{
+    Json::Value ret{Json::objectValue};
+
+    if (object_)
+    {
+        std::string text;
+        for (auto const& field : *object_)
+        {
+            auto const type = field.getSType();
+            if (type == STI_NOTPRESENT)
+                continue;
+
+            auto& value = ret[field.getFName().getJsonName()];
+            if (type == STI_OBJECT || type == STI_ARRAY)
+            {
+                text.clear();
+                write(text, field, options_);
+                value = Json::Value{Json::RawJson{text}};
+            }
+            else
+            {
+                value = field.getJson(options_);
+            }
+        }
+    }
+
+    for (auto const& [key, value] : members_)
+        ret[key] = value;
+
+    return ret;
+}
+
+void
+JsonMembers::write(std::string& out, STBase const& field, JsonOptions options)
+{
+    switch (field.getSType())
+    {
+        case STI_OBJECT:
+            writeObject(
+                out, static_cast<STObject const*>(&field), options, nullptr);
+            break;
+
+        case STI_ARRAY: {
+            out += '[';
+            bool first = true;
+            for (auto const& object : static_cast<STArray const&>(field))
+            {
+                if (object.getSType() == STI_NOTPRESENT)
+                    continue;
+
+                if (!first)
+                    out += ',';
+                first = false;
+
+                out += '{';
+                appendQuoted(out, object.getFName().getJsonName().c_str());
+                out += ':';
+                writeObject(out, &object, options, nullptr);
+                out += '}';
+            }
+            out += ']';
+            break;
+        }
+
+        default:
+            appendValue(out, field.getJson(options));
+            break;
+    }
+}
+
+}  // namespace ripple
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/basics/contract.h>
+#include <ripple/basics/parallel.h>
 #include <ripple/basics/strHex.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/digest.h>
@@ -298,6 +299,75 @@ verify(
     return false;
 }
 
+std::vector<bool>
+verifyBatch(std::vector<SignatureCheck> const& checks)
+{
+    // written concurrently, so not a std::vector<bool>
+    std::vector<std::uint8_t> valid(checks.size(), 0);
+
+    std::vector<std::size_t> ed25519;
+    std::vector<std::size_t> secp256k1;
+    for (std::size_t i = 0; i < checks.size(); ++i)
+    {
+        auto const& check = checks[i];
+        auto const type = publicKeyType(check.publicKey);
+        if (type == KeyType::secp256k1)
+            secp256k1.push_back(i);
+        else if (
+            type == KeyType::ed25519 && !check.digest &&
+            ed25519Canonical(check.signature))
+            ed25519.push_back(i);
+    }
+
+    // ed25519-donna verifies up to 64 signatures per batch
+    forEachSlice(
+        ed25519.size(), 64, [&](std::size_t begin, std::size_t end) {
+            auto const n = end - begin;
+            std::vector<unsigned char const*> m(n);
+            std::vector<std::size_t> mlen(n);
+            std::vector<unsigned char const*> pk(n);
+            std::vector<unsigned char const*> rs(n);
+            std::vector<int> ok(n, 0);
+
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                auto const& check = checks[ed25519[begin + j]];
+                m[j] = check.message.data();
+                mlen[j] = check.message.size();
+                // strip the 0xED prefix, as in verify
+                pk[j] = check.publicKey.data() + 1;
+                rs[j] = check.signature.data();
+            }
+
+            ed25519_sign_open_batch(
+                m.data(), mlen.data(), pk.data(), rs.data(), n, ok.data());
+
+            for (std::size_t j = 0; j < n; ++j)
+                valid[ed25519[begin + j]] = ok[j] == 1;
+        });
+
+    forEachSlice(
+        secp256k1.size(), 16, [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i)
+            {
+                auto const& check = checks[secp256k1[i]];
+                valid[secp256k1[i]] = check.digest
+                    ? verifyDigest(
+                          check.publicKey,
+                          *check.digest,
+                          check.signature,
+                          check.mustBeFullyCanonical)
+                    : verify(
+                          check.publicKey,
+                          check.message,
+                          check.signature,
+                          check.mustBeFullyCanonical);
+            }
+        });
+
+    return {valid.begin(), valid.end()};
+}
+
 NodeID
 calcNodeID(PublicKey const& pk)
 {
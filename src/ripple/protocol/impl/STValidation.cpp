@@ -107,18 +107,67 @@ STValidation::isValid() const noexcept
 {
     if (!valid_)
     {
-        assert(publicKeyType(getSignerPublic()) == KeyType::secp256k1);
-
-        valid_ = verifyDigest(
-            getSignerPublic(),
-            getSigningHash(),
-            makeSlice(getFieldVL(sfSignature)),
-            getFlags() & vfFullyCanonicalSig);
+        // Validations are only ever signed with secp256k1 keys
+        if (publicKeyType(getSignerPublic()) != KeyType::secp256k1)
+            valid_ = false;
+        else
+            valid_ = verifyDigest(
+                getSignerPublic(),
+                getSigningHash(),
+                makeSlice(getFieldVL(sfSignature)),
+                getFlags() & vfFullyCanonicalSig);
     }
 
     return valid_.value();
 }
 
+void
+STValidation::checkSignatures(
+    std::vector<STValidation const*> const& validations)
+{
+    std::vector<STValidation const*> unchecked;
+    std::vector<Blob> signatures;
+    std::vector<SignatureCheck> checks;
+    unchecked.reserve(validations.size());
+    signatures.reserve(validations.size());
+    checks.reserve(validations.size());
+
+    for (auto const val : validations)
+    {
+        if (val->valid_)
+            continue;
+
+        // Fails, like isValid, rather than being checked as another type
+        if (publicKeyType(val->getSignerPublic()) != KeyType::secp256k1)
+        {
+            val->valid_ = false;
+            continue;
+        }
+
+        try
+        {
+            auto const hash = val->getSigningHash();
+            auto signature = val->getFieldVL(sfSignature);
+            signatures.push_back(std::move(signature));
+            checks.push_back(
+                {val->getSignerPublic(),
+                 Slice{},
+                 hash,
+                 makeSlice(signatures.back()),
+                 (val->getFlags() & vfFullyCanonicalSig) != 0});
+            unchecked.push_back(val);
+        }
+        catch (std::exception const&)
+        {
+            val->valid_ = false;
+        }
+    }
+
+    auto const valid = verifyBatch(checks);
+    for (std::size_t i = 0; i < unchecked.size(); ++i)
+        unchecked[i]->valid_ = valid[i];
+}
+
 bool
 STValidation::isFull() const noexcept
 {
@@ -0,0 +1,282 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Slice.h>
+#include <ripple/protocol/digest.h>
+#include <cstring>
+
+// The multi-buffer kernels use the vector extensions of GCC and Clang, built
+// for AVX2 and AVX-512 and chosen at run time.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RIPPLE_SHA512_BATCH_X86 1
+#else
+#define RIPPLE_SHA512_BATCH_X86 0
+#endif
+
+namespace ripple {
+
+namespace {
+
+#if RIPPLE_SHA512_BATCH_X86
+
+constexpr std::uint64_t K[80] = {
+    0x428a2f98d728ae22ull, 0x7137449123ef65cdull, 0xb5c0fbcfec4d3b2full,
+    0xe9b5dba58189dbbcull, 0x3956c25bf348b538ull, 0x59f111f1b605d019ull,
+    0x923f82a4af194f9bull, 0xab1c5ed5da6d8118ull, 0xd807aa98a3030242ull,
+    0x12835b0145706fbeull, 0x243185be4ee4b28cull, 0x550c7dc3d5ffb4e2ull,
+    0x72be5d74f27b896full, 0x80deb1fe3b1696b1ull, 0x9bdc06a725c71235ull,
+    0xc19bf174cf692694ull, 0xe49b69c19ef14ad2ull, 0xefbe4786384f25e3ull,
+    0x0fc19dc68b8cd5b5ull, 0x240ca1cc77ac9c65ull, 0x2de92c6f592b0275ull,
+    0x4a7484aa6ea6e483ull, 0x5cb0a9dcbd41fbd4ull, 0x76f988da831153b5ull,
+    0x983e5152ee66dfabull, 0xa831c66d2db43210ull, 0xb00327c898fb213full,
+    0xbf597fc7beef0ee4ull, 0xc6e00bf33da88fc2ull, 0xd5a79147930aa725ull,
+    0x06ca6351e003826full, 0x142929670a0e6e70ull, 0x27b70a8546d22ffcull,
+    0x2e1b21385c26c926ull, 0x4d2c6dfc5ac42aedull, 0x53380d139d95b3dfull,
+    0x650a73548baf63deull, 0x766a0abb3c77b2a8ull, 0x81c2c92e47edaee6ull,
+    0x92722c851482353bull, 0xa2bfe8a14cf10364ull, 0xa81a664bbc423001ull,
+    0xc24b8b70d0f89791ull, 0xc76c51a30654be30ull, 0xd192e819d6ef5218ull,
+    0xd69906245565a910ull, 0xf40e35855771202aull, 0x106aa07032bbd1b8ull,
+    0x19a4c116b8d2d0c8ull, 0x1e376c085141ab53ull, 0x2748774cdf8eeb99ull,
+    0x34b0bcb5e19b48a8ull, 0x391c0cb3c5c95a63ull, 0x4ed8aa4ae3418acbull,
+    0x5b9cca4f7763e373ull, 0x682e6ff3d6b2b8a3ull, 0x748f82ee5defb2fcull,
+    0x78a5636f43172f60ull, 0x84c87814a1f0ab72ull, 0x8cc702081a6439ecull,
+    0x90befffa23631e28ull, 0xa4506cebde82bde9ull, 0xbef9a3f7b2c67915ull,
+    0xc67178f2e372532bull, 0xca273eceea26619cull, 0xd186b8c721c0c207ull,
+    0xeada7dd6cde0eb1eull, 0xf57d4f7fee6ed178ull, 0x06f067aa72176fbaull,
+    0x0a637dc5a2c898a6ull, 0x113f9804bef90daeull, 0x1b710b35131c471bull,
+    0x28db77f523047d84ull, 0x32caab7b40c72493ull, 0x3c9ebe0a15c9bebcull,
+    0x431d67c49c100d4cull, 0x4cc5d4becb3e42b6ull, 0x597f299cfc657e2aull,
+    0x5fcb6fab3ad6faecull, 0x6c44198c4a475817ull};
+
+constexpr std::uint64_t IV[8] = {
+    0x6a09e667f3bcc908ull,
+    0xbb67ae8584caa73bull,
+    0x3c6ef372fe94f82bull,
+    0xa54ff53a5f1d36f1ull,
+    0x510e527fade682d1ull,
+    0x9b05688c2b3e6c1full,
+    0x1f83d9abfb41bd6bull,
+    0x5be0cd19137e2179ull};
+
+using u64x4 = std::uint64_t __attribute__((vector_size(32)));
+using u64x8 = std::uint64_t __attribute__((vector_size(64)));
+
+// Macros, as functions taking or returning vectors warn about their ABI
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#define SIGMA0(x) (ROTR(x, 28) ^ ROTR(x, 34) ^ ROTR(x, 39))
+#define SIGMA1(x) (ROTR(x, 14) ^ ROTR(x, 18) ^ ROTR(x, 41))
+#define GAMMA0(x) (ROTR(x, 1) ^ ROTR(x, 8) ^ ((x) >> 7))
+#define GAMMA1(x) (ROTR(x, 19) ^ ROTR(x, 61) ^ ((x) >> 6))
+
+inline std::uint64_t
+load64(std::uint8_t const* p)
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return __builtin_bswap64(v);
+}
+
+inline void
+store64(std::uint8_t* p, std::uint64_t v)
+{
+    v = __builtin_bswap64(v);
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// One SHA-512 compression in each of the lanes, the n-th lane processing
+// the 128 byte block at blocks[n].
+template <class V, int Lanes>
+[[gnu::always_inline]] inline void
+compress(V* state, std::uint8_t const* const* blocks)
+{
+    V w[16];
+    for (int t = 0; t < 16; ++t)
+        for (int n = 0; n < Lanes; ++n)
+            w[t][n] = load64(blocks[n] + 8 * t);
+
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+    V e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int t = 0; t < 80; ++t)
+    {
+        if (t >= 16)
+        {
+            w[t & 15] += GAMMA1(w[(t - 2) & 15]) + w[(t - 7) & 15] +
+                GAMMA0(w[(t - 15) & 15]);
+        }
+
+        V const t1 = h + SIGMA1(e) + ((e & f) ^ (~e & g)) + K[t] + w[t & 15];
+        V const t2 = SIGMA0(a) + ((a & b) ^ (a & c) ^ (b & c));
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+// Hash up to Lanes messages, of the same size, together
+template <class V, int Lanes>
+[[gnu::always_inline]] inline void
+hashLanes(
+    std::uint8_t const* const* messages,
+    std::size_t size,
+    uint256* digests,
+    std::size_t count)
+{
+    // The padding and length go in one or two blocks after the last full
+    // block of the message
+    std::size_t const full = size / 128;
+    std::size_t const rest = size % 128;
+    std::size_t const blocks = (size + 17 + 127) / 128;
+
+    alignas(64) std::uint8_t tail[Lanes][256];
+    std::uint8_t const* message[Lanes];
+    for (int n = 0; n < Lanes; ++n)
+    {
+        // unused lanes repeat the last message
+        message[n] = messages[std::min<std::size_t>(n, count - 1)];
+        std::memset(tail[n], 0, sizeof(tail[n]));
+        std::memcpy(tail[n], message[n] + full * 128, rest);
+        tail[n][rest] = 0x80;
+        store64(tail[n] + (blocks - full) * 128 - 8, size * 8);
+    }
+
+    V state[8];
+    for (int i = 0; i < 8; ++i)
+        for (int n = 0; n < Lanes; ++n)
+            state[i][n] = IV[i];
+
+    std::uint8_t const* block[Lanes];
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        for (int n = 0; n < Lanes; ++n)
+            block[n] = i < full ? message[n] + i * 128
+                                : tail[n] + (i - full) * 128;
+        compress<V, Lanes>(state, block);
+    }
+
+    for (std::size_t n = 0; n < count; ++n)
+    {
+        auto const out = digests[n].data();
+        for (int i = 0; i < 4; ++i)
+            store64(out + 8 * i, state[i][n]);
+    }
+}
+
+__attribute__((target("avx2"))) void
+hash4(
+    std::uint8_t const* const* messages,
+    std::size_t size,
+    uint256* digests,
+    std::size_t count)
+{
+    hashLanes<u64x4, 4>(messages, size, digests, count);
+}
+
+__attribute__((target("avx512f"))) void
+hash8(
+    std::uint8_t const* const* messages,
+    std::size_t size,
+    uint256* digests,
+    std::size_t count)
+{
+    hashLanes<u64x8, 8>(messages, size, digests, count);
+}
+
+#undef ROTR
+#undef SIGMA0
+#undef SIGMA1
+#undef GAMMA0
+#undef GAMMA1
+
+#endif
+
+struct Kernel
+{
+    void (*hash)(
+        std::uint8_t const* const*,
+        std::size_t,
+        uint256*,
+        std::size_t);
+    std::size_t lanes;
+};
+
+Kernel
+selectKernel()
+{
+#if RIPPLE_SHA512_BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return {hash8, 8};
+    if (__builtin_cpu_supports("avx2"))
+        return {hash4, 4};
+#endif
+    return {nullptr, 1};
+}
+
+}  // namespace
+
+std::size_t
+sha512HalfBatchLanes()
+{
+    static Kernel const kernel = selectKernel();
+    return kernel.lanes;
+}
+
+void
+sha512HalfBatch(
+    std::uint8_t const* const* messages,
+    std::size_t size,
+    uint256* digests,
+    std::size_t count)
+{
+    static Kernel const kernel = selectKernel();
+
+    std::size_t i = 0;
+
+    // a lane costs less than a separate hash, even if others are unused
+    if (kernel.hash)
+    {
+        for (; count - i > 1; i += std::min(kernel.lanes, count - i))
+            kernel.hash(
+                messages + i,
+                size,
+                digests + i,
+                std::min(kernel.lanes, count - i));
+    }
+
+    for (; i != count; ++i)
+        digests[i] = sha512Half(Slice(messages[i], size));
+}
+
+}  // namespace ripple
@@ -194,6 +194,7 @@ JSS(auth_change_queued);  // out: AccountInfo
 JSS(available);           // out: ValidatorList
 JSS(avg_bps_recv);        // out: Peers
 JSS(avg_bps_sent);        // out: Peers
+JSS(avg_write_ms);        // out: NetworkOPs
 JSS(balance);             // out: AccountLines
 JSS(balances);            // out: GatewayBalances
 JSS(base);                // out: LogLevel
@@ -335,6 +336,7 @@ JSS(full);                  // in: LedgerClearer, handlers/Ledger
 JSS(full_reply);            // out: PathFind
 JSS(fullbelow_size);        // out: GetCounts
 JSS(good);                  // out: RPCVersion
+JSS(groups);                // out: NetworkOPs
 JSS(hash);                  // out: NetworkOPs, InboundLedger,
                             //      LedgerToJson, STTx; field
 JSS(hashes);                // in: AccountObjects
@@ -384,9 +386,11 @@ JSS(last);                        // out: RPCVersion
 JSS(lastSequence);                // out: NodeToShardStatus
 JSS(lastShardIndex);              // out: NodeToShardStatus
 JSS(last_close);                  // out: NetworkOPs
+JSS(last_group_size);             // out: NetworkOPs
 JSS(last_refresh_time);           // out: ValidatorSite
 JSS(last_refresh_status);         // out: ValidatorSite
 JSS(last_refresh_message);        // out: ValidatorSite
+JSS(last_write_ms);               // out: NetworkOPs
 JSS(ledger);                      // in: NetworkOPs, LedgerCleaner,
                                   //     RPCHelpers
                                   // out: NetworkOPs, PeerImp
@@ -407,6 +411,8 @@ JSS(ledger_index_min);            // in, out: AccountTx*
 JSS(ledger_max);                  // in, out: AccountTx*
 JSS(ledger_min);                  // in, out: AccountTx*
 JSS(ledger_time);                 // out: NetworkOPs
+JSS(ledger_writes);               // out: NetworkOPs
+JSS(ledgers);                     // out: NetworkOPs
 JSS(LEDGER_ENTRY_TYPES);          // out: RPC server_definitions
 JSS(levels);                      // LogLevels
 JSS(limit);                       // in/out: AccountTx*, AccountOffers,
@@ -446,10 +452,12 @@ JSS(master_key);                  // out: WalletPropose, NetworkOPs,
 JSS(master_seed);                 // out: WalletPropose
 JSS(master_seed_hex);             // out: WalletPropose
 JSS(master_signature);            // out: pubManifest
+JSS(max_group_size);              // out: NetworkOPs
 JSS(max_ledger);                  // in/out: LedgerCleaner
 JSS(max_queue_size);              // out: TxQ
 JSS(max_spend_drops);             // out: AccountInfo
 JSS(max_spend_drops_total);       // out: AccountInfo
+JSS(max_write_ms);                // out: NetworkOPs
 JSS(median_fee);                  // out: TxQ
 JSS(median_level);                // out: TxQ
 JSS(message);                     // error.
@@ -590,8 +598,10 @@ JSS(secret);                    // in: TransactionSign,
                                 //     channel_authorize
 JSS(seed);                      //
 JSS(seed_hex);                  // in: WalletPropose, TransactionSign
+JSS(send_batch_size);           // out: Peers
 JSS(send_currencies);           // out: AccountCurrencies
 JSS(send_max);                  // in: PathRequest, RipplePathFind
+JSS(send_queue_size);           // out: Peers
 JSS(seq);                       // in: LedgerEntry;
                                 // out: NetworkOPs, RPCSub, AccountOffers,
                                 //      ValidatorList, ValidatorInfo, Manifest
@@ -24,6 +24,7 @@
 #include <ripple/core/JobQueue.h>
 #include <ripple/net/InfoSub.h>
 #include <ripple/rpc/Role.h>
+#include <ripple/server/Writer.h>
 
 #include <ripple/beast/utility/Journal.h>
 
@@ -45,7 +46,7 @@ struct Context
     LedgerMaster& ledgerMaster;
     Resource::Consumer& consumer;
     Role role;
-    std::shared_ptr<JobQueue::Coro> coro{};
+    std::shared_ptr<JobQueue::CoroTask> coro{};
     InfoSub::pointer infoSub{};
     unsigned int apiVersion;
 };
@@ -64,6 +65,12 @@ struct JsonContext : public Context
     Json::Value params;
 
     Headers headers{};
+
+    /**
+     * Set where the response body can be streamed. A handler may pass it a
+     * Writer, which is then sent instead of the result it returns.
+     */
+    std::function<void(std::shared_ptr<Writer>)> stream{};
 };
 
 template <class RequestType>
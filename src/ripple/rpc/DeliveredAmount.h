@@ -32,6 +32,7 @@ class Value;
 
 namespace ripple {
 
+class JsonMembers;
 class ReadView;
 class Transaction;
 class TxMeta;
@@ -72,6 +73,19 @@ insertDeliveredAmount(
     std::shared_ptr<STTx const> const&,
     TxMeta const&);
 
+void
+insertDeliveredAmount(
+    JsonMembers& meta,
+    ReadView const&,
+    std::shared_ptr<STTx const> const& serializedTx,
+    TxMeta const&);
+void
+insertDeliveredAmount(
+    JsonMembers& meta,
+    RPC::JsonContext const&,
+    std::shared_ptr<Transaction> const&,
+    TxMeta const&);
+
 std::optional<STAmount>
 getDeliveredAmount(
     RPC::Context const& context,
@@ -30,8 +30,12 @@ namespace RPC {
 
 struct JsonContext;
 
-/** Execute an RPC command and store the results in a Json::Value. */
-Status
+/** Execute an RPC command and store the results in a Json::Value.
+
+    Awaited from the JobQueue::CoroTask in the context, which the command
+    may suspend.
+*/
+JobQueue::CoroTask::Task<Status>
 doCommand(RPC::JsonContext&, Json::Value&);
 
 Role
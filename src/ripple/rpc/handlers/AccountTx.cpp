@@ -29,6 +29,7 @@
 #include <ripple/ledger/ReadView.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/JsonMembers.h>
 #include <ripple/protocol/UintTypes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/resource/Fees.h>
@@ -299,14 +300,15 @@ populateJsonResponse(
                 {
                     Json::Value& jvObj = jvTxns.append(Json::objectValue);
 
-                    jvObj[jss::tx] = txn->getJson(JsonOptions::include_date);
+                    jvObj[jss::tx] =
+                        txn->getJsonMembers(JsonOptions::include_date).raw();
                     if (txnMeta)
                     {
-                        jvObj[jss::meta] =
-                            txnMeta->getJson(JsonOptions::include_date);
+                        auto const object = txnMeta->getAsObject();
+                        JsonMembers meta(object, JsonOptions::include_date);
+                        insertDeliveredAmount(meta, context, txn, *txnMeta);
+                        jvObj[jss::meta] = meta.raw();
                         jvObj[jss::validated] = true;
-                        insertDeliveredAmount(
-                            jvObj[jss::meta], context, txn, *txnMeta);
                     }
                 }
             }
@@ -85,6 +85,8 @@ doLedgerData(RPC::JsonContext&);
 Json::Value
 doLedgerEntry(RPC::JsonContext&);
 Json::Value
+doLedgerExport(RPC::JsonContext&);
+Json::Value
 doLedgerHeader(RPC::JsonContext&);
 Json::Value
 doLedgerRequest(RPC::JsonContext&);
@@ -124,7 +126,7 @@ Json::Value
 doPeerReservationsDel(RPC::JsonContext&);
 Json::Value
 doPeerReservationsList(RPC::JsonContext&);
-Json::Value
+JobQueue::CoroTask::Task<Json::Value>
 doRipplePathFind(RPC::JsonContext&);
 Json::Value
 doServerDefinitions(RPC::JsonContext&);
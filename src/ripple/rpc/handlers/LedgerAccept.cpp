@@ -21,6 +21,7 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/core/Config.h>
+#include <ripple/json/json_arena.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/Indexes.h>
@@ -43,7 +44,11 @@ doLedgerAccept(RPC::JsonContext& context)
     else
     {
         std::unique_lock lock{context.app.getMasterMutex()};
-        context.netOps.acceptLedger();
+        {
+            // the accepted ledger caches the JSON of its transactions
+            Json::Arena::Suspend suspend;
+            context.netOps.acceptLedger();
+        }
         jvResult[jss::ledger_current_index] =
             context.ledgerMaster.getCurrentLedgerIndex();
     }
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/RPCHelpers.h>
+#include <ripple/rpc/impl/StateExportWriter.h>
+#include <algorithm>
+
+namespace ripple {
+
+// Stream the state of a closed ledger as binary frames, described in
+// StateExport.h, in the body of a chunked HTTP response.
+//   Inputs:
+//     ledger_hash:  chosen ledger's hash
+//     ledger_index: chosen ledger's index
+//     marker:       opaque, resume point
+//     limit:        integer, maximum number of entries
+Json::Value
+doLedgerExport(RPC::JsonContext& context)
+{
+    if (!context.stream)
+        return RPC::make_error(
+            rpcNOT_SUPPORTED, "Only available as a single HTTP request.");
+
+    std::shared_ptr<ReadView const> view;
+    auto result = RPC::lookupLedger(view, context);
+    if (!view)
+        return result;
+
+    auto ledger = std::dynamic_pointer_cast<Ledger const>(view);
+    if (!ledger || !ledger->isImmutable())
+        return RPC::make_param_error("A closed ledger is required.");
+
+    auto const& params = context.params;
+
+    uint256 marker;
+    if (params.isMember(jss::marker))
+    {
+        Json::Value const& jMarker = params[jss::marker];
+        if (!(jMarker.isString() && marker.parseHex(jMarker.asString())))
+            return RPC::expected_field_error(jss::marker, "valid");
+    }
+
+    std::uint64_t limit = StateExport::noLimit;
+    if (params.isMember(jss::limit))
+    {
+        Json::Value const& jLimit = params[jss::limit];
+        if (!(jLimit.isUInt() || (jLimit.isInt() && jLimit.asInt() >= 0)))
+            return RPC::expected_field_error(jss::limit, "unsigned integer");
+        limit = std::max(jLimit.asUInt(), 1u);
+    }
+
+    context.stream(std::make_shared<RPC::StateExportWriter>(
+        context.app.getJobQueue(),
+        StateExport(std::move(ledger), marker, limit)));
+    return result;
+}
+
+}  // namespace ripple
@@ -28,11 +28,11 @@
 namespace ripple {
 
 // This interface is deprecated.
-Json::Value
+JobQueue::CoroTask::Task<Json::Value>
 doRipplePathFind(RPC::JsonContext& context)
 {
     if (context.app.config().PATH_SEARCH_MAX == 0)
-        return rpcError(rpcNOT_SUPPORTED);
+        co_return rpcError(rpcNOT_SUPPORTED);
 
     context.loadType = Resource::feeHighBurdenRPC;
 
@@ -50,20 +50,21 @@ doRipplePathFind(RPC::JsonContext& context)
             RPC::Tuning::maxValidatedLedgerAge)
         {
             if (context.apiVersion == 1)
-                return rpcError(rpcNO_NETWORK);
-            return rpcError(rpcNOT_SYNCED);
+                co_return rpcError(rpcNO_NETWORK);
+            co_return rpcError(rpcNOT_SYNCED);
         }
 
         PathRequest::pointer request;
         lpLedger = context.ledgerMaster.getClosedLedger();
 
         // It doesn't look like there's much odd happening here, but you should
-        // be aware this code runs in a JobQueue::Coro, which is a coroutine.
-        // And we may be flipping around between threads.  Here's an overview:
+        // be aware this code runs in a JobQueue::CoroTask, which is a
+        // coroutine. And we may be flipping around between threads.  Here's an
+        // overview:
         //
         // 1. We're running doRipplePathFind() due to a call to
         //    ripple_path_find.  doRipplePathFind() is currently running
-        //    inside of a JobQueue::Coro using a JobQueue thread.
+        //    inside of a JobQueue::CoroTask using a JobQueue thread.
         //
         // 2. doRipplePathFind's call to makeLegacyPathRequest() enqueues the
         //    path-finding request.  That request will (probably) run at some
@@ -87,7 +88,7 @@ doRipplePathFind(RPC::JsonContext& context)
         //    same coroutine (!) to the JobQueue.
         //
         // 6. When the JobQueue calls this coroutine, this coroutine resumes
-        //    from the line below the coro->yield() and returns the
+        //    from the line below the co_await coro->yield() and returns the
         //    path-finding result.
         //
         // With so many moving parts, what could go wrong?
@@ -103,11 +104,11 @@ doRipplePathFind(RPC::JsonContext& context)
         //    makeLegacyPathRequest() cannot get a thread to run the path-find
         //    on, then it returns an empty request.
         //
-        // 2. The path-finding job might run, but the Coro::post() might be
+        // 2. The path-finding job might run, but the CoroTask::post() might be
         //    rejected by the JobQueue (because we're shutting down).
         //
-        //    We handle this case by resuming (not posting) the Coro.
-        //    By resuming the Coro, we allow the Coro to run to completion
+        //    We handle this case by resuming (not posting) the CoroTask.
+        //    By resuming the CoroTask, we allow it to run to completion
         //    on the current thread instead of requiring that it run on a
         //    new thread from the JobQueue.
         //
@@ -133,12 +134,12 @@ doRipplePathFind(RPC::JsonContext& context)
                 // captured reference could evaporate when we return from
                 // coroCopy->resume().  This is not strictly necessary, but
                 // will make maintenance easier.
-                std::shared_ptr<JobQueue::Coro> coroCopy{context.coro};
+                std::shared_ptr<JobQueue::CoroTask> coroCopy{context.coro};
                 if (!coroCopy->post())
                 {
                     // The post() failed, so we won't get a thread to let
-                    // the Coro finish.  We'll call Coro::resume() so the
-                    // Coro can finish on our thread.  Otherwise the
+                    // the CoroTask finish.  We'll call CoroTask::resume() so
+                    // it can finish on our thread.  Otherwise the
                     // application will hang on shutdown.
                     coroCopy->resume();
                 }
@@ -148,21 +149,21 @@ doRipplePathFind(RPC::JsonContext& context)
             context.params);
         if (request)
         {
-            context.coro->yield();
+            co_await context.coro->yield();
             jvResult = request->doStatus(context.params);
         }
 
-        return jvResult;
+        co_return jvResult;
     }
 
     // The caller specified a ledger
     jvResult = RPC::lookupLedger(lpLedger, context);
     if (!lpLedger)
-        return jvResult;
+        co_return jvResult;
 
     RPC::LegacyPathFind lpf(isUnlimited(context.role), context.app);
     if (!lpf.isOk())
-        return rpcError(rpcTOO_BUSY);
+        co_return rpcError(rpcTOO_BUSY);
 
     auto result = context.app.getPathRequests().doLegacyPathRequest(
         context.consumer, lpLedger, context.params);
@@ -170,7 +171,7 @@ doRipplePathFind(RPC::JsonContext& context)
     for (auto& fieldName : jvResult.getMemberNames())
         result[fieldName] = std::move(jvResult[fieldName]);
 
-    return result;
+    co_return result;
 }
 
 }  // namespace ripple
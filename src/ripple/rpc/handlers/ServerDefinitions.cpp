@@ -23,6 +23,7 @@
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/reporting/P2pProxy.h>
+#include <ripple/json/json_arena.h>
 #include <ripple/json/json_value.h>
 #include <ripple/json/json_writer.h>
 #include <ripple/net/RPCErr.h>
@@ -508,6 +509,9 @@ doServerDefinitions(RPC::JsonContext& context)
     // update the cache above
     if (curLgrSeq > ((lastGenerated >> 8) + 1) << 8 || lastGenerated == 0)
     {
+        // kept across requests
+        Json::Arena::Suspend suspend;
+
         majorityAmendments_t majorities;
         if (auto const valLedger = context.ledgerMaster.getValidatedLedger())
             majorities = getMajorityAmendments(*valLedger);
@@ -525,7 +529,10 @@ doServerDefinitions(RPC::JsonContext& context)
         }
     }
 
-    static const Definitions defs{};
+    static const Definitions defs = [] {
+        Json::Arena::Suspend suspend;
+        return Definitions{};
+    }();
 
     // the hash is the xor of the two parts
     uint256 retHash = lastFeatureHash ^ defs.getHash();
@@ -24,6 +24,7 @@
 #include <ripple/basics/ToString.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/JsonMembers.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/CTID.h>
 #include <ripple/rpc/Context.h>
@@ -313,7 +314,12 @@ populateJsonResponse(
     // no errors
     else if (result.txn)
     {
-        response = result.txn->getJson(JsonOptions::include_date, args.binary);
+        if (args.binary)
+            response =
+                result.txn->getJson(JsonOptions::include_date, args.binary);
+        else
+            response =
+                result.txn->getJsonMembers(JsonOptions::include_date).object();
 
         // populate binary metadata
         if (auto blob = std::get_if<Blob>(&result.meta))
@@ -327,9 +333,10 @@ populateJsonResponse(
             auto& meta = *m;
             if (meta)
             {
-                response[jss::meta] = meta->getJson(JsonOptions::none);
-                insertDeliveredAmount(
-                    response[jss::meta], context, result.txn, *meta);
+                auto const object = meta->getAsObject();
+                JsonMembers members(object);
+                insertDeliveredAmount(members, context, result.txn, *meta);
+                response[jss::meta] = members.raw();
             }
         }
         response[jss::validated] = result.validated;
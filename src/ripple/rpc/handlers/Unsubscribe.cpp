@@ -229,12 +229,14 @@ doUnsubscribe(RPC::JsonContext& context)
                 return rpcError(rpcBAD_MARKET);
             }
 
+            ispSub->deleteSubBook(book);
             context.netOps.unsubBook(ispSub->getSeq(), book);
 
             // both_sides is deprecated.
             if ((jv.isMember(jss::both) && jv[jss::both].asBool()) ||
                 (jv.isMember(jss::both_sides) && jv[jss::both_sides].asBool()))
             {
+                ispSub->deleteSubBook(reversed(book));
                 context.netOps.unsubBook(ispSub->getSeq(), reversed(book));
             }
         }
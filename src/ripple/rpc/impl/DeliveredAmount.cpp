@@ -26,6 +26,7 @@
 #include <ripple/net/RPCErr.h>
 #include <ripple/protocol/AccountID.h>
 #include <ripple/protocol/Feature.h>
+#include <ripple/protocol/JsonMembers.h>
 #include <ripple/rpc/Context.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 #include <boost/algorithm/string/case_conv.hpp>
@@ -125,9 +126,10 @@ canHaveDeliveredAmount(
         getFix1623Enabled, serializedTx, transactionMeta);
 }
 
-void
-insertDeliveredAmount(
-    Json::Value& meta,
+template <class Meta>
+static void
+insertDeliveredAmountImpl(
+    Meta& meta,
     ReadView const& ledger,
     std::shared_ptr<STTx const> const& serializedTx,
     TxMeta const& transactionMeta)
@@ -159,6 +161,26 @@ insertDeliveredAmount(
     }
 }
 
+void
+insertDeliveredAmount(
+    Json::Value& meta,
+    ReadView const& ledger,
+    std::shared_ptr<STTx const> const& serializedTx,
+    TxMeta const& transactionMeta)
+{
+    insertDeliveredAmountImpl(meta, ledger, serializedTx, transactionMeta);
+}
+
+void
+insertDeliveredAmount(
+    JsonMembers& meta,
+    ReadView const& ledger,
+    std::shared_ptr<STTx const> const& serializedTx,
+    TxMeta const& transactionMeta)
+{
+    insertDeliveredAmountImpl(meta, ledger, serializedTx, transactionMeta);
+}
+
 template <class GetLedgerIndex>
 static std::optional<STAmount>
 getDeliveredAmount(
@@ -205,9 +227,10 @@ insertDeliveredAmount(
         meta, context, transaction->getSTransaction(), transactionMeta);
 }
 
-void
-insertDeliveredAmount(
-    Json::Value& meta,
+template <class Meta>
+static void
+insertDeliveredAmountImpl(
+    Meta& meta,
     RPC::JsonContext const& context,
     std::shared_ptr<STTx const> const& transaction,
     TxMeta const& transactionMeta)
@@ -233,5 +256,26 @@ insertDeliveredAmount(
     }
 }
 
+void
+insertDeliveredAmount(
+    Json::Value& meta,
+    RPC::JsonContext const& context,
+    std::shared_ptr<STTx const> const& transaction,
+    TxMeta const& transactionMeta)
+{
+    insertDeliveredAmountImpl(meta, context, transaction, transactionMeta);
+}
+
+void
+insertDeliveredAmount(
+    JsonMembers& meta,
+    RPC::JsonContext const& context,
+    std::shared_ptr<Transaction> const& transaction,
+    TxMeta const& transactionMeta)
+{
+    insertDeliveredAmountImpl(
+        meta, context, transaction->getSTransaction(), transactionMeta);
+}
+
 }  // namespace RPC
 }  // namespace ripple
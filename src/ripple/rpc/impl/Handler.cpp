@@ -43,6 +43,24 @@ byRef(Function const& f)
     };
 }
 
+/** Adjust a coroutine handler to be call-by-reference. */
+template <typename Function>
+Handler::CoroMethod<Json::Value>
+byCoro(Function const& f)
+{
+    return [f](JsonContext& context, Json::Value& result)
+               -> JobQueue::CoroTask::Task<Status> {
+        result = co_await f(context);
+        if (result.type() != Json::objectValue)
+        {
+            assert(false);
+            result = RPC::makeObjectValue(result);
+        }
+
+        co_return Status();
+    };
+}
+
 template <class Object, class HandlerImpl>
 Status
 handle(JsonContext& context, Object& object)
@@ -109,6 +127,7 @@ Handler const handlerArray[]{
      NEEDS_CURRENT_LEDGER},
     {"ledger_data", byRef(&doLedgerData), Role::USER, NO_CONDITION},
     {"ledger_entry", byRef(&doLedgerEntry), Role::USER, NO_CONDITION},
+    {"ledger_export", byRef(&doLedgerExport), Role::ADMIN, NO_CONDITION},
     {"ledger_header", byRef(&doLedgerHeader), Role::USER, NO_CONDITION},
     {"ledger_request", byRef(&doLedgerRequest), Role::ADMIN, NO_CONDITION},
     {"log_level", byRef(&doLogLevel), Role::ADMIN, NO_CONDITION},
@@ -138,7 +157,11 @@ Handler const handlerArray[]{
      byRef(&doPeerReservationsList),
      Role::ADMIN,
      NO_CONDITION},
-    {"ripple_path_find", byRef(&doRipplePathFind), Role::USER, NO_CONDITION},
+    {"ripple_path_find",
+     {},
+     Role::USER,
+     NO_CONDITION,
+     byCoro(&doRipplePathFind)},
     {"sign", byRef(&doSign), Role::USER, NO_CONDITION},
     {"sign_for", byRef(&doSignFor), Role::USER, NO_CONDITION},
     {"inject", byRef(&doInject), Role::ADMIN, NEEDS_CURRENT_LEDGER},
@@ -48,10 +48,17 @@ struct Handler
     template <class JsonValue>
     using Method = std::function<Status(JsonContext&, JsonValue&)>;
 
+    // A method that may suspend the coroutine running the request, see
+    // JsonContext::coro.
+    template <class JsonValue>
+    using CoroMethod = std::function<
+        JobQueue::CoroTask::Task<Status>(JsonContext&, JsonValue&)>;
+
     const char* name_;
     Method<Json::Value> valueMethod_;
     Role role_;
     RPC::Condition condition_;
+    CoroMethod<Json::Value> coroMethod_{};
 };
 
 Handler const*
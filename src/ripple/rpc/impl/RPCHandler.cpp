@@ -29,6 +29,7 @@
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/json/Object.h>
+#include <ripple/json/json_arena.h>
 #include <ripple/json/to_string.h>
 #include <ripple/net/InfoSub.h>
 #include <ripple/net/RPCErr.h>
@@ -179,11 +180,11 @@ fillHandler(JsonContext& context, Handler const*& result)
     return rpcSUCCESS;
 }
 
-template <class Object, class Method>
-Status
+template <class Object>
+JobQueue::CoroTask::Task<Status>
 callMethod(
     JsonContext& context,
-    Method method,
+    Handler const& handler,
     std::string const& name,
     Object& result)
 {
@@ -197,19 +198,23 @@ callMethod(
             context.app.getJobQueue().makeLoadEvent(jtGENERIC, "cmd:" + name);
 
         auto start = std::chrono::system_clock::now();
-        auto ret = method(context, result);
+        Status ret;
+        if (handler.coroMethod_)
+            ret = co_await handler.coroMethod_(context, result);
+        else
+            ret = handler.valueMethod_(context, result);
         auto end = std::chrono::system_clock::now();
 
         JLOG(context.j.debug())
             << "RPC call " << name << " completed in "
             << ((end - start).count() / 1000000000.0) << "seconds";
         perfLog.rpcFinish(name, curId);
-        return ret;
+        co_return ret;
     }
     catch (ReportingShouldProxy&)
     {
         result = forwardToP2p(context);
-        return rpcSUCCESS;
+        co_return rpcSUCCESS;
     }
     catch (std::exception& e)
     {
@@ -220,7 +225,7 @@ callMethod(
             context.loadType = Resource::feeExceptionRPC;
 
         inject_error(rpcINTERNAL, result);
-        return rpcINTERNAL;
+        co_return rpcINTERNAL;
     }
 }
 
@@ -246,24 +251,31 @@ injectReportingWarning(RPC::JsonContext& context, Json::Value& result)
     }
 }
 
-Status
+JobQueue::CoroTask::Task<Status>
 doCommand(RPC::JsonContext& context, Json::Value& result)
 {
+    // Responses can hold a great many small values, which are carved out
+    // of an arena and so freed in bulk once the response has been written.
+    // The arena lives in this coroutine's frame and moves with the CoroTask
+    // running the request, see JobQueue::CoroTask::resume(). Values kept
+    // after the request are built with the arena suspended.
+    Json::Arena arena;
+
     if (shouldForwardToP2p(context))
     {
         result = forwardToP2p(context);
         injectReportingWarning(context, result);
         // this return value is ignored
-        return rpcSUCCESS;
+        co_return rpcSUCCESS;
     }
     Handler const* handler = nullptr;
     if (auto error = fillHandler(context, handler))
     {
         inject_error(error, result);
-        return error;
+        co_return error;
     }
 
-    if (auto method = handler->valueMethod_)
+    if (handler->valueMethod_ || handler->coroMethod_)
     {
         if (!context.headers.user.empty() ||
             !context.headers.forwardedFor.empty())
@@ -273,24 +285,26 @@ doCommand(RPC::JsonContext& context, Json::Value& result)
                 << ", user: " << context.headers.user
                 << ", forwarded for: " << context.headers.forwardedFor;
 
-            auto ret = callMethod(context, method, handler->name_, result);
+            auto ret =
+                co_await callMethod(context, *handler, handler->name_, result);
 
             JLOG(context.j.debug())
                 << "finish command: " << handler->name_
                 << ", user: " << context.headers.user
                 << ", forwarded for: " << context.headers.forwardedFor;
 
-            return ret;
+            co_return ret;
         }
         else
         {
-            auto ret = callMethod(context, method, handler->name_, result);
+            auto ret =
+                co_await callMethod(context, *handler, handler->name_, result);
             injectReportingWarning(context, result);
-            return ret;
+            co_return ret;
         }
     }
 
-    return rpcUNKNOWN_COMMAND;
+    co_return rpcUNKNOWN_COMMAND;
 }
 
 Role
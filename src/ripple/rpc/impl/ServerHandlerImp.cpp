@@ -292,11 +292,12 @@ ServerHandlerImp::onRequest(Session& session)
     }
 
     std::shared_ptr<Session> detachedSession = session.detach();
-    auto const postResult = m_jobQueue.postCoro(
+    auto const postResult = m_jobQueue.postCoroTask(
         jtCLIENT_RPC,
         "RPC-Client",
-        [this, detachedSession](std::shared_ptr<JobQueue::Coro> coro) {
-            processSession(detachedSession, coro);
+        [this, detachedSession](std::shared_ptr<JobQueue::CoroTask> coro)
+            -> JobQueue::CoroTask::Body {
+            co_await processSession(detachedSession, coro);
         });
     if (postResult == nullptr)
     {
@@ -339,12 +340,13 @@ ServerHandlerImp::onWSMessage(
 
     JLOG(m_journal.trace()) << "Websocket received '" << jv << "'";
 
-    auto const postResult = m_jobQueue.postCoro(
+    auto const postResult = m_jobQueue.postCoroTask(
         jtCLIENT_WEBSOCKET,
         "WS-Client",
         [this, session, jv = std::move(jv)](
-            std::shared_ptr<JobQueue::Coro> const& coro) {
-            auto const jr = this->processSession(session, coro, jv);
+            std::shared_ptr<JobQueue::CoroTask> coro)
+            -> JobQueue::CoroTask::Body {
+            auto const jr = co_await this->processSession(session, coro, jv);
             auto const s = to_string(jr);
             auto const n = s.length();
             boost::beast::multi_buffer sb(n);
@@ -397,10 +399,10 @@ logDuration(
                 << " microseconds. request = " << request;
 }
 
-Json::Value
+JobQueue::CoroTask::Task<Json::Value>
 ServerHandlerImp::processSession(
     std::shared_ptr<WSSession> const& session,
-    std::shared_ptr<JobQueue::Coro> const& coro,
+    std::shared_ptr<JobQueue::CoroTask> const& coro,
     Json::Value const& jv)
 {
     auto is = std::static_pointer_cast<WSInfoSub>(session->appDefined);
@@ -410,7 +412,7 @@ ServerHandlerImp::processSession(
             {boost::beast::websocket::policy_error, "threshold exceeded"});
         // FIX: This rpcError is not delivered since the session
         // was just closed.
-        return rpcError(rpcSLOW_DOWN);
+        co_return rpcError(rpcSLOW_DOWN);
     }
 
     // Requests without "command" are invalid.
@@ -443,7 +445,7 @@ ServerHandlerImp::processSession(
                 jr[jss::api_version] = jv[jss::api_version];
 
             is->getConsumer().charge(Resource::feeInvalidRPC);
-            return jr;
+            co_return jr;
         }
 
         auto required = RPC::roleRequired(
@@ -479,7 +481,7 @@ ServerHandlerImp::processSession(
                 {is->user(), is->forwarded_for()}};
 
             auto start = std::chrono::system_clock::now();
-            RPC::doCommand(context, jr[jss::result]);
+            co_await RPC::doCommand(context, jr[jss::result]);
             auto end = std::chrono::system_clock::now();
             logDuration(jv, end - start, m_journal);
         }
@@ -540,16 +542,15 @@ ServerHandlerImp::processSession(
         jr[jss::api_version] = jv[jss::api_version];
 
     jr[jss::type] = jss::response;
-    return jr;
+    co_return jr;
 }
 
-// Run as a coroutine.
-void
+JobQueue::CoroTask::Body
 ServerHandlerImp::processSession(
     std::shared_ptr<Session> const& session,
-    std::shared_ptr<JobQueue::Coro> coro)
+    std::shared_ptr<JobQueue::CoroTask> coro)
 {
-    processRequest(
+    auto const writer = co_await processRequest(
         session->port(),
         buffers_to_string(session->request().body().data()),
         session->remoteAddress().at_port(0),
@@ -563,6 +564,14 @@ ServerHandlerImp::processSession(
             return boost::beast::string_view{};
         }());
 
+    // A streamed response completes the session once it has been sent
+    if (writer)
+    {
+        session->write(
+            writer, beast::rfc2616::is_keep_alive(session->request()));
+        co_return;
+    }
+
     if (beast::rfc2616::is_keep_alive(session->request()))
         session->complete();
     else
@@ -585,13 +594,13 @@ Json::Int constexpr server_overloaded = -32604;
 Json::Int constexpr forbidden = -32605;
 Json::Int constexpr wrong_version = -32606;
 
-void
+JobQueue::CoroTask::Task<std::shared_ptr<Writer>>
 ServerHandlerImp::processRequest(
     Port const& port,
     std::string const& request,
     beast::IP::Endpoint const& remoteIPAddress,
     Output&& output,
-    std::shared_ptr<JobQueue::Coro> coro,
+    std::shared_ptr<JobQueue::CoroTask> coro,
     boost::string_view forwardedFor,
     boost::string_view user)
 {
@@ -609,7 +618,7 @@ ServerHandlerImp::processRequest(
                 "Unable to parse request: " + reader.getFormatedErrorMessages(),
                 output,
                 rpcJ);
-            return;
+            co_return {};
         }
     }
 
@@ -621,7 +630,7 @@ ServerHandlerImp::processRequest(
         if (!jsonOrig.isMember(jss::params) || !jsonOrig[jss::params].isArray())
         {
             HTTPReply(400, "Malformed batch request", output, rpcJ);
-            return;
+            co_return {};
         }
         size = jsonOrig[jss::params].size();
     }
@@ -665,7 +674,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, jss::invalid_API_version.c_str(), output, rpcJ);
-                return;
+                co_return {};
             }
             Json::Value r(Json::objectValue);
             r[jss::request] = jsonRPC;
@@ -715,7 +724,7 @@ ServerHandlerImp::processRequest(
                 if (!batch)
                 {
                     HTTPReply(503, "Server is overloaded", output, rpcJ);
-                    return;
+                    co_return {};
                 }
                 Json::Value r = jsonRPC;
                 r[jss::error] =
@@ -731,7 +740,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(403, "Forbidden", output, rpcJ);
-                return;
+                co_return {};
             }
             Json::Value r = jsonRPC;
             r[jss::error] = make_json_error(forbidden, "Forbidden");
@@ -745,7 +754,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, "Null method", output, rpcJ);
-                return;
+                co_return {};
             }
             Json::Value r = jsonRPC;
             r[jss::error] = make_json_error(method_not_found, "Null method");
@@ -760,7 +769,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, "method is not string", output, rpcJ);
-                return;
+                co_return {};
             }
             Json::Value r = jsonRPC;
             r[jss::error] =
@@ -776,7 +785,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, "method is empty", output, rpcJ);
-                return;
+                co_return {};
             }
             Json::Value r = jsonRPC;
             r[jss::error] =
@@ -802,7 +811,7 @@ ServerHandlerImp::processRequest(
             {
                 usage.charge(Resource::feeInvalidRPC);
                 HTTPReply(400, "params unparseable", output, rpcJ);
-                return;
+                co_return {};
             }
             else
             {
@@ -811,7 +820,7 @@ ServerHandlerImp::processRequest(
                 {
                     usage.charge(Resource::feeInvalidRPC);
                     HTTPReply(400, "params unparseable", output, rpcJ);
-                    return;
+                    co_return {};
                 }
             }
         }
@@ -829,7 +838,7 @@ ServerHandlerImp::processRequest(
                 if (!batch)
                 {
                     HTTPReply(400, "ripplerpc is not a string", output, rpcJ);
-                    return;
+                    co_return {};
                 }
 
                 Json::Value r = jsonRPC;
@@ -873,13 +882,18 @@ ServerHandlerImp::processRequest(
              apiVersion},
             params,
             {user, forwardedFor}};
+        std::shared_ptr<Writer> streamed;
+        if (!batch)
+            context.stream = [&streamed](std::shared_ptr<Writer> writer) {
+                streamed = std::move(writer);
+            };
         Json::Value result;
 
         auto start = std::chrono::system_clock::now();
 
         try
         {
-            RPC::doCommand(context, result);
+            co_await RPC::doCommand(context, result);
         }
         catch (std::exception const& ex)
         {
@@ -894,6 +908,12 @@ ServerHandlerImp::processRequest(
         logDuration(params, end - start, m_journal);
 
         usage.charge(loadType);
+
+        if (streamed)
+        {
+            ++rpc_requests_;
+            co_return streamed;
+        }
         if (usage.warn())
             result[jss::warning] = jss::load;
 
@@ -1013,6 +1033,7 @@ ServerHandlerImp::processRequest(
     }
 
     HTTPReply(httpStatus, response, output, rpcJ);
+    co_return {};
 }
 
 //------------------------------------------------------------------------------
@@ -171,24 +171,29 @@ public:
     onStopped(Server&);
 
 private:
-    Json::Value
+    // These run in the CoroTask they are given, which a request may
+    // suspend. Each is awaited by its caller, so the references they take
+    // stay valid while they are suspended.
+    JobQueue::CoroTask::Task<Json::Value>
     processSession(
         std::shared_ptr<WSSession> const& session,
-        std::shared_ptr<JobQueue::Coro> const& coro,
+        std::shared_ptr<JobQueue::CoroTask> const& coro,
         Json::Value const& jv);
 
-    void
+    JobQueue::CoroTask::Body
     processSession(
         std::shared_ptr<Session> const&,
-        std::shared_ptr<JobQueue::Coro> coro);
+        std::shared_ptr<JobQueue::CoroTask> coro);
 
-    void
+    // Returns the Writer of a response body that a handler streams, which
+    // the caller must send. Any other reply has been written to output.
+    JobQueue::CoroTask::Task<std::shared_ptr<Writer>>
     processRequest(
         Port const& port,
         std::string const& request,
         beast::IP::Endpoint const& remoteIPAddress,
         Output&&,
-        std::shared_ptr<JobQueue::Coro> coro,
+        std::shared_ptr<JobQueue::CoroTask> coro,
         boost::string_view forwardedFor,
         boost::string_view user);
 
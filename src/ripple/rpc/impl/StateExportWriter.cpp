@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/core/JobQueue.h>
+#include <ripple/protocol/BuildInfo.h>
+#include <ripple/protocol/SystemParameters.h>
+#include <ripple/rpc/impl/StateExportWriter.h>
+#include <ripple/server/impl/JSONRPCUtil.h>
+#include <boost/format.hpp>
+
+namespace ripple {
+namespace RPC {
+
+StateExportWriter::StateExportWriter(
+    JobQueue& jobQueue,
+    StateExport state,
+    std::size_t chunkBytes)
+    : jobQueue_(jobQueue), state_(std::move(state)), chunkBytes_(chunkBytes)
+{
+    buffer_ = "HTTP/1.1 200 OK\r\n";
+    buffer_ += getHTTPHeaderTimestamp();
+    buffer_ +=
+        "Content-Type: application/octet-stream\r\n"
+        "Transfer-Encoding: chunked\r\n";
+    buffer_ += "Server: " + systemName() + "-json-rpc/" +
+        BuildInfo::getFullVersionString() + "\r\n\r\n";
+}
+
+bool
+StateExportWriter::complete()
+{
+    return !more_ && consumed_ == buffer_.size();
+}
+
+void
+StateExportWriter::consume(std::size_t bytes)
+{
+    consumed_ += bytes;
+}
+
+bool
+StateExportWriter::prepare(std::size_t, std::function<void(void)> resume)
+{
+    if (consumed_ != buffer_.size() || !more_)
+        return true;
+
+    buffer_.clear();
+    consumed_ = 0;
+
+    // resume holds on to this writer until it is called
+    if (jobQueue_.addJob(jtCLIENT, "ledger_export", [this, resume]() {
+            fill();
+            resume();
+        }))
+        return false;
+
+    // Shutting down. The client sees the export end without an end frame.
+    buffer_ = "0\r\n\r\n";
+    more_ = false;
+    return true;
+}
+
+std::vector<boost::asio::const_buffer>
+StateExportWriter::data()
+{
+    return {boost::asio::buffer(
+        buffer_.data() + consumed_, buffer_.size() - consumed_)};
+}
+
+void
+StateExportWriter::fill()
+{
+    Serializer s(chunkBytes_ + 4096);
+    more_ = state_.next(s, chunkBytes_);
+
+    buffer_ = (boost::format("%x\r\n") % s.size()).str();
+    buffer_.append(static_cast<char const*>(s.data()), s.size());
+    buffer_ += "\r\n";
+    if (!more_)
+        buffer_ += "0\r\n\r\n";
+}
+
+}  // namespace RPC
+}  // namespace ripple
@@ -0,0 +1,76 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_STATEEXPORTWRITER_H_INCLUDED
+#define RIPPLE_RPC_STATEEXPORTWRITER_H_INCLUDED
+
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/server/Writer.h>
+#include <string>
+
+namespace ripple {
+
+class JobQueue;
+
+namespace RPC {
+
+/** Sends the frames of a StateExport as the chunks of an HTTP response.
+
+    The state is read on the job queue, a chunk at a time, and the next
+    chunk is only read once the connection has consumed the last one.
+*/
+class StateExportWriter : public Writer
+{
+public:
+    // the payload of each chunk
+    static constexpr std::size_t defaultChunkBytes = 256 * 1024;
+
+    StateExportWriter(
+        JobQueue& jobQueue,
+        StateExport state,
+        std::size_t chunkBytes = defaultChunkBytes);
+
+    bool
+    complete() override;
+
+    void
+    consume(std::size_t bytes) override;
+
+    bool
+    prepare(std::size_t bytes, std::function<void(void)> resume) override;
+
+    std::vector<boost::asio::const_buffer>
+    data() override;
+
+private:
+    void
+    fill();
+
+    JobQueue& jobQueue_;
+    StateExport state_;
+    std::size_t const chunkBytes_;
+    std::string buffer_;
+    std::size_t consumed_ = 0;
+    bool more_ = true;
+};
+
+}  // namespace RPC
+}  // namespace ripple
+
+#endif
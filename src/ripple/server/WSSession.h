@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -104,6 +105,32 @@ public:
     }
 };
 
+/** A message whose data is shared with other messages. */
+class SharedWSMsg : public WSMsg
+{
+    std::shared_ptr<std::string const> data_;
+    std::size_t pos_ = 0;
+    std::size_t n_ = 0;
+
+public:
+    explicit SharedWSMsg(std::shared_ptr<std::string const> data)
+        : data_(std::move(data))
+    {
+    }
+
+    std::pair<boost::tribool, std::vector<boost::asio::const_buffer>>
+    prepare(std::size_t bytes, std::function<void(void)>) override
+    {
+        pos_ += n_;
+        auto const left = data_->size() - pos_;
+        if (left == 0)
+            return {true, {}};
+        n_ = std::min(bytes, left);
+        boost::tribool const done = n_ == left;
+        return {done, {boost::asio::const_buffer(data_->data() + pos_, n_)}};
+    }
+};
+
 struct WSSession
 {
     std::shared_ptr<void> appDefined;
@@ -25,6 +25,10 @@
 
 namespace ripple {
 
+// The Date header of an HTTP response, terminated by CRLF
+std::string
+getHTTPHeaderTimestamp();
+
 void
 HTTPReply(
     int nStatus,
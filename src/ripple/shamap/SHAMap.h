@@ -104,7 +104,7 @@ private:
     /** The sequence of the ledger that this map references, if any. */
     std::uint32_t ledgerSeq_ = 0;
 
-    std::shared_ptr<SHAMapTreeNode> root_;
+    SharedIntrusive<SHAMapTreeNode> root_;
     mutable SHAMapState state_;
     SHAMapType const type_;
     bool backed_ = true;         // Map is backed by the database
@@ -336,9 +336,14 @@ public:
     int
     unshare();
 
-    /** Flush modified nodes to the nodestore and convert them to shared. */
+    /** Flush modified nodes to the nodestore and convert them to shared.
+
+        @param workers With more than one, the subtrees below the top two
+                       levels of the map are flushed by that many threads.
+        @return The number of nodes flushed.
+    */
     int
-    flushDirty(NodeObjectType t);
+    flushDirty(NodeObjectType t, std::size_t workers = 0);
 
     void
     walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
@@ -359,28 +364,28 @@ public:
 
 private:
     using SharedPtrNodeStack =
-        std::stack<std::pair<std::shared_ptr<SHAMapTreeNode>, SHAMapNodeID>>;
+        std::stack<std::pair<SharedIntrusive<SHAMapTreeNode>, SHAMapNodeID>>;
     using DeltaRef = std::pair<
         std::shared_ptr<SHAMapItem const> const&,
         std::shared_ptr<SHAMapItem const> const&>;
 
     // tree node cache operations
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     cacheLookup(SHAMapHash const& hash) const;
     void
-    canonicalize(SHAMapHash const& hash, std::shared_ptr<SHAMapTreeNode>&)
+    canonicalize(SHAMapHash const& hash, SharedIntrusive<SHAMapTreeNode>&)
         const;
 
     // database operations
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     fetchNodeFromDB(SHAMapHash const& hash) const;
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     fetchNodeNT(SHAMapHash const& hash) const;
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     fetchNodeNT(SHAMapHash const& hash, SHAMapSyncFilter* filter) const;
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     fetchNode(SHAMapHash const& hash) const;
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     checkFilter(SHAMapHash const& hash, SHAMapSyncFilter* filter) const;
 
     /** Update hashes up to the root */
@@ -388,7 +393,7 @@ private:
     dirtyUp(
         SharedPtrNodeStack& stack,
         uint256 const& target,
-        std::shared_ptr<SHAMapTreeNode> terminal);
+        SharedIntrusive<SHAMapTreeNode> terminal);
 
     /** Walk towards the specified id, returning the node.  Caller must check
         if the return is nullptr, and if not, if the node->peekItem()->key() ==
@@ -402,36 +407,36 @@ private:
 
     /** Unshare the node, allowing it to be modified */
     template <class Node>
-    std::shared_ptr<Node>
-    unshareNode(std::shared_ptr<Node>, SHAMapNodeID const& nodeID);
+    SharedIntrusive<Node>
+    unshareNode(SharedIntrusive<Node>, SHAMapNodeID const& nodeID);
 
     /** prepare a node to be modified before flushing */
     template <class Node>
-    std::shared_ptr<Node>
-    preFlushNode(std::shared_ptr<Node> node) const;
+    SharedIntrusive<Node>
+    preFlushNode(SharedIntrusive<Node> node) const;
 
     /** write and canonicalize modified node */
-    std::shared_ptr<SHAMapTreeNode>
-    writeNode(NodeObjectType t, std::shared_ptr<SHAMapTreeNode> node) const;
+    SharedIntrusive<SHAMapTreeNode>
+    writeNode(NodeObjectType t, SharedIntrusive<SHAMapTreeNode> node) const;
 
     // returns the first item at or below this node
     SHAMapLeafNode*
     firstBelow(
-        std::shared_ptr<SHAMapTreeNode>,
+        SharedIntrusive<SHAMapTreeNode>,
         SharedPtrNodeStack& stack,
         int branch = 0) const;
 
     // returns the last item at or below this node
     SHAMapLeafNode*
     lastBelow(
-        std::shared_ptr<SHAMapTreeNode> node,
+        SharedIntrusive<SHAMapTreeNode> node,
         SharedPtrNodeStack& stack,
         int branch = branchFactor) const;
 
     // helper function for firstBelow and lastBelow
     SHAMapLeafNode*
     belowHelper(
-        std::shared_ptr<SHAMapTreeNode> node,
+        SharedIntrusive<SHAMapTreeNode> node,
         SharedPtrNodeStack& stack,
         int branch,
         std::tuple<
@@ -445,15 +450,15 @@ private:
     descend(SHAMapInnerNode*, int branch) const;
     SHAMapTreeNode*
     descendThrow(SHAMapInnerNode*, int branch) const;
-    std::shared_ptr<SHAMapTreeNode>
-    descend(std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
-    std::shared_ptr<SHAMapTreeNode>
-    descendThrow(std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
+    SharedIntrusive<SHAMapTreeNode>
+    descend(SharedIntrusive<SHAMapInnerNode> const&, int branch) const;
+    SharedIntrusive<SHAMapTreeNode>
+    descendThrow(SharedIntrusive<SHAMapInnerNode> const&, int branch) const;
 
     // Descend with filter
     // If pending, callback is called as if it called fetchNodeNT
     using descendCallback =
-        std::function<void(std::shared_ptr<SHAMapTreeNode>, SHAMapHash const&)>;
+        std::function<void(SharedIntrusive<SHAMapTreeNode>, SHAMapHash const&)>;
     SHAMapTreeNode*
     descendAsync(
         SHAMapInnerNode* parent,
@@ -471,8 +476,8 @@ private:
 
     // Non-storing
     // Does not hook the returned node to its parent
-    std::shared_ptr<SHAMapTreeNode>
-    descendNoStore(std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
+    SharedIntrusive<SHAMapTreeNode>
+    descendNoStore(SharedIntrusive<SHAMapInnerNode> const&, int branch) const;
 
     /** If there is only one leaf below this node, get its contents */
     std::shared_ptr<SHAMapItem const> const&
@@ -495,7 +500,23 @@ private:
         Delta& differences,
         int& maxCount) const;
     int
-    walkSubTree(bool doWrite, NodeObjectType t);
+    walkSubTree(bool doWrite, NodeObjectType t, std::size_t workers = 0);
+
+    // Hash, share and maybe write a node of ours and the dirty nodes below
+    // it. Returns the node to link in its place and the number flushed.
+    std::pair<SharedIntrusive<SHAMapTreeNode>, int>
+    flushSubTree(
+        SharedIntrusive<SHAMapTreeNode> node,
+        bool doWrite,
+        NodeObjectType t) const;
+
+    // Like flushSubTree, for the root, sharing the work between threads
+    std::pair<SharedIntrusive<SHAMapTreeNode>, int>
+    flushParallel(
+        SharedIntrusive<SHAMapInnerNode> root,
+        bool doWrite,
+        NodeObjectType t,
+        std::size_t workers) const;
 
     // Structure to track information about call to
     // getMissingNodes while it's in progress
@@ -536,7 +557,7 @@ private:
             SHAMapInnerNode*,                  // parent node
             SHAMapNodeID,                      // parent node ID
             int,                               // branch
-            std::shared_ptr<SHAMapTreeNode>>;  // node
+            SharedIntrusive<SHAMapTreeNode>>;  // node
 
         int deferred_;
         std::mutex deferLock_;
@@ -570,7 +591,7 @@ private:
     gmn_ProcessDeferredReads(MissingNodes&);
 
     // fetch from DB helper function
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     finishFetch(
         SHAMapHash const& hash,
         std::shared_ptr<NodeObject> const& object) const;
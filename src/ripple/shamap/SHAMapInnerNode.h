@@ -35,6 +35,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace ripple {
 
@@ -48,7 +49,7 @@ public:
 private:
     /** Opaque type that contains the `hashes` array (array of type
        `SHAMapHash`) and the `children` array (array of type
-       `std::shared_ptr<SHAMapInnerNode>`).
+       `SharedIntrusive<SHAMapInnerNode>`).
      */
     TaggedPointer hashesAndChildren_;
 
@@ -103,6 +104,10 @@ private:
     void
     iterNonEmptyChildIndexes(F&& f) const;
 
+    /** Copy the hash of each child held into the hashes array. */
+    void
+    updateChildHashes();
+
 public:
     explicit SHAMapInnerNode(
         std::uint32_t cowid,
@@ -113,9 +118,12 @@ public:
     operator=(SHAMapInnerNode const&) = delete;
     ~SHAMapInnerNode();
 
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     clone(std::uint32_t cowid) const override;
 
+    void
+    partialDestructor() override;
+
     SHAMapNodeType
     getType() const override
     {
@@ -147,19 +155,19 @@ public:
     getChildHash(int m) const;
 
     void
-    setChild(int m, std::shared_ptr<SHAMapTreeNode> child);
+    setChild(int m, SharedIntrusive<SHAMapTreeNode> child);
 
     void
-    shareChild(int m, std::shared_ptr<SHAMapTreeNode> const& child);
+    shareChild(int m, SharedIntrusive<SHAMapTreeNode> const& child);
 
     SHAMapTreeNode*
     getChildPointer(int branch);
 
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     getChild(int branch);
 
-    std::shared_ptr<SHAMapTreeNode>
-    canonicalizeChild(int branch, std::shared_ptr<SHAMapTreeNode> node);
+    SharedIntrusive<SHAMapTreeNode>
+    canonicalizeChild(int branch, SharedIntrusive<SHAMapTreeNode> node);
 
     // sync functions
     bool
@@ -175,6 +183,14 @@ public:
     void
     updateHashDeep();
 
+    /** Call updateHashDeep on each node, hashing several nodes at once.
+
+        No node may be a descendant of another, so the nodes of a map are
+        rehashed a level at a time, starting from the deepest.
+    */
+    static void
+    updateHashesDeep(std::vector<SHAMapInnerNode*> const& nodes);
+
     void
     serializeForWire(Serializer&) const override;
 
@@ -187,10 +203,10 @@ public:
     void
     invariants(bool is_root = false) const override;
 
-    static std::shared_ptr<SHAMapTreeNode>
+    static SharedIntrusive<SHAMapTreeNode>
     makeFullInner(Slice data, SHAMapHash const& hash, bool hashValid);
 
-    static std::shared_ptr<SHAMapTreeNode>
+    static SharedIntrusive<SHAMapTreeNode>
     makeCompressedInner(Slice data);
 };
 
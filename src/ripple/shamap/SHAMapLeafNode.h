@@ -45,6 +45,12 @@ public:
     SHAMapLeafNode&
     operator=(const SHAMapLeafNode&) = delete;
 
+    void
+    partialDestructor() final override
+    {
+        item_.reset();
+    }
+
     bool
     isLeaf() const final override
     {
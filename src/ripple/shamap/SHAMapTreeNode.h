@@ -21,6 +21,7 @@
 #define RIPPLE_SHAMAP_SHAMAPTREENODE_H_INCLUDED
 
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/IntrusivePointer.h>
 #include <ripple/basics/SHAMapHash.h>
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/beast/utility/Journal.h>
@@ -50,7 +51,12 @@ enum class SHAMapNodeType {
     tnACCOUNT_STATE = 4
 };
 
-class SHAMapTreeNode
+/** A node of a SHAMap.
+
+    Nodes count their own references, so that the children of an inner node
+    can be held through eight byte SharedIntrusive pointers.
+*/
+class SHAMapTreeNode : public IntrusiveRefCounts
 {
 protected:
     SHAMapHash hash_;
@@ -89,6 +95,14 @@ protected:
 public:
     virtual ~SHAMapTreeNode() noexcept = default;
 
+    /** Release what the node owns once no strong reference remains.
+
+        Called instead of the destructor while the node is still weakly
+        referenced from a TreeNodeCache.
+     */
+    virtual void
+    partialDestructor() = 0;
+
     /** \defgroup SHAMap Copy-on-Write Support
 
         By nature, a node may appear in multiple SHAMap instances. Rather than
@@ -130,7 +144,7 @@ public:
     }
 
     /** Make a copy of this node, setting the owner. */
-    virtual std::shared_ptr<SHAMapTreeNode>
+    virtual SharedIntrusive<SHAMapTreeNode>
     clone(std::uint32_t cowid) const = 0;
     /** @} */
 
@@ -171,20 +185,20 @@ public:
     virtual void
     invariants(bool is_root = false) const = 0;
 
-    static std::shared_ptr<SHAMapTreeNode>
+    static SharedIntrusive<SHAMapTreeNode>
     makeFromPrefix(Slice rawNode, SHAMapHash const& hash);
 
-    static std::shared_ptr<SHAMapTreeNode>
+    static SharedIntrusive<SHAMapTreeNode>
     makeFromWire(Slice rawNode);
 
 private:
-    static std::shared_ptr<SHAMapTreeNode>
+    static SharedIntrusive<SHAMapTreeNode>
     makeTransaction(Slice data, SHAMapHash const& hash, bool hashValid);
 
-    static std::shared_ptr<SHAMapTreeNode>
+    static SharedIntrusive<SHAMapTreeNode>
     makeAccountState(Slice data, SHAMapHash const& hash, bool hashValid);
 
-    static std::shared_ptr<SHAMapTreeNode>
+    static SharedIntrusive<SHAMapTreeNode>
     makeTransactionWithMeta(Slice data, SHAMapHash const& hash, bool hashValid);
 };
 
@@ -50,10 +50,10 @@ public:
     {
     }
 
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     clone(std::uint32_t cowid) const final override
     {
-        return std::make_shared<SHAMapTxLeafNode>(item_, cowid, hash_);
+        return make_SharedIntrusive<SHAMapTxLeafNode>(item_, cowid, hash_);
     }
 
     SHAMapNodeType
@@ -51,10 +51,11 @@ public:
     {
     }
 
-    std::shared_ptr<SHAMapTreeNode>
+    SharedIntrusive<SHAMapTreeNode>
     clone(std::uint32_t cowid) const override
     {
-        return std::make_shared<SHAMapTxPlusMetaLeafNode>(item_, cowid, hash_);
+        return make_SharedIntrusive<SHAMapTxPlusMetaLeafNode>(
+            item_, cowid, hash_);
     }
 
     SHAMapNodeType
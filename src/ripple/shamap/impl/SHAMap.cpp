@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/basics/contract.h>
+#include <ripple/basics/parallel.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapAccountStateLeafNode.h>
 #include <ripple/shamap/SHAMapNodeID.h>
@@ -27,21 +28,21 @@
 
 namespace ripple {
 
-[[nodiscard]] std::shared_ptr<SHAMapLeafNode>
+[[nodiscard]] SharedIntrusive<SHAMapLeafNode>
 makeTypedLeaf(
     SHAMapNodeType type,
     std::shared_ptr<SHAMapItem const> item,
     std::uint32_t owner)
 {
     if (type == SHAMapNodeType::tnTRANSACTION_NM)
-        return std::make_shared<SHAMapTxLeafNode>(std::move(item), owner);
+        return make_SharedIntrusive<SHAMapTxLeafNode>(std::move(item), owner);
 
     if (type == SHAMapNodeType::tnTRANSACTION_MD)
-        return std::make_shared<SHAMapTxPlusMetaLeafNode>(
+        return make_SharedIntrusive<SHAMapTxPlusMetaLeafNode>(
             std::move(item), owner);
 
     if (type == SHAMapNodeType::tnACCOUNT_STATE)
-        return std::make_shared<SHAMapAccountStateLeafNode>(
+        return make_SharedIntrusive<SHAMapAccountStateLeafNode>(
             std::move(item), owner);
 
     LogicError(
@@ -53,7 +54,7 @@ makeTypedLeaf(
 SHAMap::SHAMap(SHAMapType t, Family& f)
     : f_(f), journal_(f.journal()), state_(SHAMapState::Modifying), type_(t)
 {
-    root_ = std::make_shared<SHAMapInnerNode>(cowid_);
+    root_ = make_SharedIntrusive<SHAMapInnerNode>(cowid_);
 }
 
 // The `hash` parameter is unused. It is part of the interface so it's clear
@@ -63,7 +64,7 @@ SHAMap::SHAMap(SHAMapType t, Family& f)
 SHAMap::SHAMap(SHAMapType t, uint256 const& hash, Family& f)
     : f_(f), journal_(f.journal()), state_(SHAMapState::Synching), type_(t)
 {
-    root_ = std::make_shared<SHAMapInnerNode>(cowid_);
+    root_ = make_SharedIntrusive<SHAMapInnerNode>(cowid_);
 }
 
 std::shared_ptr<SHAMap>
@@ -94,7 +95,7 @@ void
 SHAMap::dirtyUp(
     SharedPtrNodeStack& stack,
     uint256 const& target,
-    std::shared_ptr<SHAMapTreeNode> child)
+    SharedIntrusive<SHAMapTreeNode> child)
 {
     // walk the tree up from through the inner nodes to the root_
     // update hashes and links
@@ -109,7 +110,7 @@ SHAMap::dirtyUp(
     while (!stack.empty())
     {
         auto node =
-            std::dynamic_pointer_cast<SHAMapInnerNode>(stack.top().first);
+            dynamic_pointer_cast<SHAMapInnerNode>(stack.top().first);
         SHAMapNodeID nodeID = stack.top().second;
         stack.pop();
         assert(node != nullptr);
@@ -128,15 +129,33 @@ SHAMapLeafNode*
 SHAMap::walkTowardsKey(uint256 const& id, SharedPtrNodeStack* stack) const
 {
     assert(stack == nullptr || stack->empty());
-    auto inNode = root_;
     SHAMapNodeID nodeID;
 
+    if (stack == nullptr)
+    {
+        // The map holds every node on the path, so the walk needs no
+        // references of its own.
+        SHAMapTreeNode* node = root_.get();
+        while (node->isInner())
+        {
+            auto const inner = static_cast<SHAMapInnerNode*>(node);
+            auto const branch = selectBranch(nodeID, id);
+            if (inner->isEmptyBranch(branch))
+                return nullptr;
+
+            node = descendThrow(inner, branch);
+            nodeID = nodeID.getChildNodeID(branch);
+        }
+        return static_cast<SHAMapLeafNode*>(node);
+    }
+
+    auto inNode = root_;
+
     while (inNode->isInner())
     {
-        if (stack != nullptr)
-            stack->push({inNode, nodeID});
+        stack->push({inNode, nodeID});
 
-        auto const inner = std::static_pointer_cast<SHAMapInnerNode>(inNode);
+        auto const inner = static_pointer_cast<SHAMapInnerNode>(inNode);
         auto const branch = selectBranch(nodeID, id);
         if (inner->isEmptyBranch(branch))
             return nullptr;
@@ -145,8 +164,7 @@ SHAMap::walkTowardsKey(uint256 const& id, SharedPtrNodeStack* stack) const
         nodeID = nodeID.getChildNodeID(branch);
     }
 
-    if (stack != nullptr)
-        stack->push({inNode, nodeID});
+    stack->push({inNode, nodeID});
     return static_cast<SHAMapLeafNode*>(inNode.get());
 }
 
@@ -159,7 +177,7 @@ SHAMap::findKey(uint256 const& id) const
     return leaf;
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::fetchNodeFromDB(SHAMapHash const& hash) const
 {
     assert(backed_);
@@ -167,14 +185,14 @@ SHAMap::fetchNodeFromDB(SHAMapHash const& hash) const
     return finishFetch(hash, obj);
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::finishFetch(
     SHAMapHash const& hash,
     std::shared_ptr<NodeObject> const& object) const
 {
     assert(backed_);
 
-    std::shared_ptr<SHAMapTreeNode> node;
+    SharedIntrusive<SHAMapTreeNode> node;
     try
     {
         if (!object)
@@ -207,11 +225,11 @@ SHAMap::finishFetch(
         JLOG(journal_.warn()) << "Invalid DB node " << hash;
     }
 
-    return std::shared_ptr<SHAMapTreeNode>();
+    return SharedIntrusive<SHAMapTreeNode>();
 }
 
 // See if a sync filter has a node
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::checkFilter(SHAMapHash const& hash, SHAMapSyncFilter* filter) const
 {
     if (auto nodeData = filter->getNode(hash))
@@ -244,7 +262,7 @@ SHAMap::checkFilter(SHAMapHash const& hash, SHAMapSyncFilter* filter) const
 
 // Get a node without throwing
 // Used on maps where missing nodes are expected
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::fetchNodeNT(SHAMapHash const& hash, SHAMapSyncFilter* filter) const
 {
     auto node = cacheLookup(hash);
@@ -267,7 +285,7 @@ SHAMap::fetchNodeNT(SHAMapHash const& hash, SHAMapSyncFilter* filter) const
     return node;
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::fetchNodeNT(SHAMapHash const& hash) const
 {
     auto node = cacheLookup(hash);
@@ -279,7 +297,7 @@ SHAMap::fetchNodeNT(SHAMapHash const& hash) const
 }
 
 // Throw if the node is missing
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::fetchNode(SHAMapHash const& hash) const
 {
     auto node = fetchNodeNT(hash);
@@ -301,11 +319,11 @@ SHAMap::descendThrow(SHAMapInnerNode* parent, int branch) const
     return ret;
 }
 
-std::shared_ptr<SHAMapTreeNode>
-SHAMap::descendThrow(std::shared_ptr<SHAMapInnerNode> const& parent, int branch)
+SharedIntrusive<SHAMapTreeNode>
+SHAMap::descendThrow(SharedIntrusive<SHAMapInnerNode> const& parent, int branch)
     const
 {
-    std::shared_ptr<SHAMapTreeNode> ret = descend(parent, branch);
+    SharedIntrusive<SHAMapTreeNode> ret = descend(parent, branch);
 
     if (!ret && !parent->isEmptyBranch(branch))
         Throw<SHAMapMissingNode>(type_, parent->getChildHash(branch));
@@ -320,7 +338,7 @@ SHAMap::descend(SHAMapInnerNode* parent, int branch) const
     if (ret || !backed_)
         return ret;
 
-    std::shared_ptr<SHAMapTreeNode> node =
+    SharedIntrusive<SHAMapTreeNode> node =
         fetchNodeNT(parent->getChildHash(branch));
     if (!node)
         return nullptr;
@@ -329,11 +347,11 @@ SHAMap::descend(SHAMapInnerNode* parent, int branch) const
     return node.get();
 }
 
-std::shared_ptr<SHAMapTreeNode>
-SHAMap::descend(std::shared_ptr<SHAMapInnerNode> const& parent, int branch)
+SharedIntrusive<SHAMapTreeNode>
+SHAMap::descend(SharedIntrusive<SHAMapInnerNode> const& parent, int branch)
     const
 {
-    std::shared_ptr<SHAMapTreeNode> node = parent->getChild(branch);
+    SharedIntrusive<SHAMapTreeNode> node = parent->getChild(branch);
     if (node || !backed_)
         return node;
 
@@ -347,12 +365,12 @@ SHAMap::descend(std::shared_ptr<SHAMapInnerNode> const& parent, int branch)
 
 // Gets the node that would be hooked to this branch,
 // but doesn't hook it up.
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::descendNoStore(
-    std::shared_ptr<SHAMapInnerNode> const& parent,
+    SharedIntrusive<SHAMapInnerNode> const& parent,
     int branch) const
 {
-    std::shared_ptr<SHAMapTreeNode> ret = parent->getChild(branch);
+    SharedIntrusive<SHAMapTreeNode> ret = parent->getChild(branch);
     if (!ret && backed_)
         ret = fetchNode(parent->getChildHash(branch));
     return ret;
@@ -374,7 +392,7 @@ SHAMap::descend(
     if (!child)
     {
         auto const& childHash = parent->getChildHash(branch);
-        std::shared_ptr<SHAMapTreeNode> childNode =
+        SharedIntrusive<SHAMapTreeNode> childNode =
             fetchNodeNT(childHash, filter);
 
         if (childNode)
@@ -431,8 +449,8 @@ SHAMap::descendAsync(
 }
 
 template <class Node>
-std::shared_ptr<Node>
-SHAMap::unshareNode(std::shared_ptr<Node> node, SHAMapNodeID const& nodeID)
+SharedIntrusive<Node>
+SHAMap::unshareNode(SharedIntrusive<Node> node, SHAMapNodeID const& nodeID)
 {
     // make sure the node is suitable for the intended operation (copy on write)
     assert(node->cowid() <= cowid_);
@@ -440,7 +458,7 @@ SHAMap::unshareNode(std::shared_ptr<Node> node, SHAMapNodeID const& nodeID)
     {
         // have a CoW
         assert(state_ != SHAMapState::Immutable);
-        node = std::static_pointer_cast<Node>(node->clone(cowid_));
+        node = static_pointer_cast<Node>(node->clone(cowid_));
         if (nodeID.isRoot())
             root_ = node;
     }
@@ -449,7 +467,7 @@ SHAMap::unshareNode(std::shared_ptr<Node> node, SHAMapNodeID const& nodeID)
 
 SHAMapLeafNode*
 SHAMap::belowHelper(
-    std::shared_ptr<SHAMapTreeNode> node,
+    SharedIntrusive<SHAMapTreeNode> node,
     SharedPtrNodeStack& stack,
     int branch,
     std::tuple<int, std::function<bool(int)>, std::function<void(int&)>> const&
@@ -458,11 +476,11 @@ SHAMap::belowHelper(
     auto& [init, cmp, incr] = loopParams;
     if (node->isLeaf())
     {
-        auto n = std::static_pointer_cast<SHAMapLeafNode>(node);
+        auto n = static_pointer_cast<SHAMapLeafNode>(node);
         stack.push({node, {leafDepth, n->peekItem()->key()}});
         return n.get();
     }
-    auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+    auto inner = static_pointer_cast<SHAMapInnerNode>(node);
     if (stack.empty())
         stack.push({inner, SHAMapNodeID{}});
     else
@@ -475,11 +493,11 @@ SHAMap::belowHelper(
             assert(!stack.empty());
             if (node->isLeaf())
             {
-                auto n = std::static_pointer_cast<SHAMapLeafNode>(node);
+                auto n = static_pointer_cast<SHAMapLeafNode>(node);
                 stack.push({n, {leafDepth, n->peekItem()->key()}});
                 return n.get();
             }
-            inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+            inner = static_pointer_cast<SHAMapInnerNode>(node);
             stack.push({inner, stack.top().second.getChildNodeID(branch)});
             i = init;  // descend and reset loop
         }
@@ -490,7 +508,7 @@ SHAMap::belowHelper(
 }
 SHAMapLeafNode*
 SHAMap::lastBelow(
-    std::shared_ptr<SHAMapTreeNode> node,
+    SharedIntrusive<SHAMapTreeNode> node,
     SharedPtrNodeStack& stack,
     int branch) const
 {
@@ -502,7 +520,7 @@ SHAMap::lastBelow(
 }
 SHAMapLeafNode*
 SHAMap::firstBelow(
-    std::shared_ptr<SHAMapTreeNode> node,
+    SharedIntrusive<SHAMapTreeNode> node,
     SharedPtrNodeStack& stack,
     int branch) const
 {
@@ -574,7 +592,7 @@ SHAMap::peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const
     {
         auto [node, nodeID] = stack.top();
         assert(!node->isLeaf());
-        auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+        auto inner = static_pointer_cast<SHAMapInnerNode>(node);
         for (auto i = selectBranch(nodeID, id) + 1; i < branchFactor; ++i)
         {
             if (!inner->isEmptyBranch(i))
@@ -633,7 +651,7 @@ SHAMap::upper_bound(uint256 const& id) const
         }
         else
         {
-            auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+            auto inner = static_pointer_cast<SHAMapInnerNode>(node);
             for (auto branch = selectBranch(nodeID, id) + 1;
                  branch < branchFactor;
                  ++branch)
@@ -670,7 +688,7 @@ SHAMap::lower_bound(uint256 const& id) const
         }
         else
         {
-            auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+            auto inner = static_pointer_cast<SHAMapInnerNode>(node);
             for (int branch = selectBranch(nodeID, id) - 1; branch >= 0;
                  --branch)
             {
@@ -709,7 +727,7 @@ SHAMap::delItem(uint256 const& id)
     if (stack.empty())
         Throw<SHAMapMissingNode>(type_, id);
 
-    auto leaf = std::dynamic_pointer_cast<SHAMapLeafNode>(stack.top().first);
+    auto leaf = dynamic_pointer_cast<SHAMapLeafNode>(stack.top().first);
     stack.pop();
 
     if (!leaf || (leaf->peekItem()->key() != id))
@@ -719,12 +737,12 @@ SHAMap::delItem(uint256 const& id)
 
     // What gets attached to the end of the chain
     // (For now, nothing, since we deleted the leaf)
-    std::shared_ptr<SHAMapTreeNode> prevNode;
+    SharedIntrusive<SHAMapTreeNode> prevNode;
 
     while (!stack.empty())
     {
         auto node =
-            std::static_pointer_cast<SHAMapInnerNode>(stack.top().first);
+            static_pointer_cast<SHAMapInnerNode>(stack.top().first);
         SHAMapNodeID nodeID = stack.top().second;
         stack.pop();
 
@@ -795,7 +813,7 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
 
     if (node->isLeaf())
     {
-        auto leaf = std::static_pointer_cast<SHAMapLeafNode>(node);
+        auto leaf = static_pointer_cast<SHAMapLeafNode>(node);
         if (leaf->peekItem()->key() == tag)
             return false;
     }
@@ -803,7 +821,7 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
     if (node->isInner())
     {
         // easy case, we end on an inner node
-        auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+        auto inner = static_pointer_cast<SHAMapInnerNode>(node);
         int branch = selectBranch(nodeID, tag);
         assert(inner->isEmptyBranch(branch));
         inner->setChild(branch, makeTypedLeaf(type, std::move(item), cowid_));
@@ -812,11 +830,11 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
     {
         // this is a leaf node that has to be made an inner node holding two
         // items
-        auto leaf = std::static_pointer_cast<SHAMapLeafNode>(node);
+        auto leaf = static_pointer_cast<SHAMapLeafNode>(node);
         std::shared_ptr<SHAMapItem const> otherItem = leaf->peekItem();
         assert(otherItem && (tag != otherItem->key()));
 
-        node = std::make_shared<SHAMapInnerNode>(node->cowid());
+        node = make_SharedIntrusive<SHAMapInnerNode>(node->cowid());
 
         unsigned int b1, b2;
 
@@ -828,7 +846,7 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
             // we need a new inner node, since both go on same branch at this
             // level
             nodeID = nodeID.getChildNodeID(b1);
-            node = std::make_shared<SHAMapInnerNode>(cowid_);
+            node = make_SharedIntrusive<SHAMapInnerNode>(cowid_);
         }
 
         // we can add the two leaf nodes here
@@ -877,7 +895,7 @@ SHAMap::updateGiveItem(
     if (stack.empty())
         Throw<SHAMapMissingNode>(type_, tag);
 
-    auto node = std::dynamic_pointer_cast<SHAMapLeafNode>(stack.top().first);
+    auto node = dynamic_pointer_cast<SHAMapLeafNode>(stack.top().first);
     auto nodeID = stack.top().second;
     stack.pop();
 
@@ -947,8 +965,8 @@ SHAMap::fetchRoot(SHAMapHash const& hash, SHAMapSyncFilter* filter)
     @note The node must have already been unshared by having the caller
           first call SHAMapTreeNode::unshare().
  */
-std::shared_ptr<SHAMapTreeNode>
-SHAMap::writeNode(NodeObjectType t, std::shared_ptr<SHAMapTreeNode> node) const
+SharedIntrusive<SHAMapTreeNode>
+SHAMap::writeNode(NodeObjectType t, SharedIntrusive<SHAMapTreeNode> node) const
 {
     assert(node->cowid() == 0);
     assert(backed_);
@@ -966,8 +984,8 @@ SHAMap::writeNode(NodeObjectType t, std::shared_ptr<SHAMapTreeNode> node) const
 // pointer to because flushing modifies inner nodes -- it
 // makes them point to canonical/shared nodes.
 template <class Node>
-std::shared_ptr<Node>
-SHAMap::preFlushNode(std::shared_ptr<Node> node) const
+SharedIntrusive<Node>
+SHAMap::preFlushNode(SharedIntrusive<Node> node) const
 {
     // A shared node should never need to be flushed
     // because that would imply someone modified it
@@ -977,7 +995,7 @@ SHAMap::preFlushNode(std::shared_ptr<Node> node) const
     {
         // Node is not uniquely ours, so unshare it before
         // possibly modifying it
-        node = std::static_pointer_cast<Node>(node->clone(cowid_));
+        node = static_pointer_cast<Node>(node->clone(cowid_));
     }
     return node;
 }
@@ -990,21 +1008,19 @@ SHAMap::unshare()
 }
 
 int
-SHAMap::flushDirty(NodeObjectType t)
+SHAMap::flushDirty(NodeObjectType t, std::size_t workers)
 {
     // We only write back if this map is backed.
-    return walkSubTree(backed_, t);
+    return walkSubTree(backed_, t, workers);
 }
 
 int
-SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
+SHAMap::walkSubTree(bool doWrite, NodeObjectType t, std::size_t workers)
 {
     assert(!doWrite || backed_);
 
-    int flushed = 0;
-
     if (!root_ || (root_->cowid() == 0))
-        return flushed;
+        return 0;
 
     if (root_->isLeaf())
     {  // special case -- root_ is leaf
@@ -1018,107 +1034,210 @@ SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
         return 1;
     }
 
-    auto node = std::static_pointer_cast<SHAMapInnerNode>(root_);
+    auto node = static_pointer_cast<SHAMapInnerNode>(root_);
 
     if (node->isEmpty())
     {  // replace empty root with a new empty root
-        root_ = std::make_shared<SHAMapInnerNode>(0);
+        root_ = make_SharedIntrusive<SHAMapInnerNode>(0);
         return 1;
     }
 
-    // Stack of {parent,index,child} pointers representing
-    // inner nodes we are in the process of flushing
-    using StackEntry = std::pair<std::shared_ptr<SHAMapInnerNode>, int>;
-    std::stack<StackEntry, std::vector<StackEntry>> stack;
-
     node = preFlushNode(std::move(node));
 
-    int pos = 0;
+    auto [root, flushed] = workers > 1
+        ? flushParallel(std::move(node), doWrite, t, workers)
+        : flushSubTree(std::move(node), doWrite, t);
+    root_ = std::move(root);
+
+    return flushed;
+}
+
+std::pair<SharedIntrusive<SHAMapTreeNode>, int>
+SHAMap::flushSubTree(
+    SharedIntrusive<SHAMapTreeNode> node,
+    bool doWrite,
+    NodeObjectType t) const
+{
+    assert(node->cowid() == cowid_);
+
+    int flushed = 0;
+
+    // Every node that needs to be flushed, in breadth first order, with
+    // the index of its parent and the branch it hangs from. Parents come
+    // before their children, so going backwards visits children first.
+    struct Dirty
+    {
+        SharedIntrusive<SHAMapTreeNode> node;
+        std::size_t parent;
+        int branch;
+    };
+    std::vector<Dirty> dirty;
+
+    // The dirty inner nodes at each depth, to be hashed a level at a time
+    std::vector<std::vector<SHAMapInnerNode*>> levels;
 
-    // We can't flush an inner node until we flush its children
-    while (1)
+    if (node->isInner())
+        levels.push_back({static_cast<SHAMapInnerNode*>(node.get())});
+    else
+        node->updateHash();
+    dirty.push_back({std::move(node), 0, 0});
+
+    // the nodes before levelEnd are at depth
+    std::size_t depth = 0;
+    std::size_t levelEnd = 1;
+
+    for (std::size_t i = 0; i != dirty.size(); ++i)
     {
-        while (pos < branchFactor)
+        if (i == levelEnd)
         {
-            if (node->isEmptyBranch(pos))
-            {
-                ++pos;
-            }
-            else
-            {
-                // No need to do I/O. If the node isn't linked,
-                // it can't need to be flushed
-                int branch = pos;
-                auto child = node->getChild(pos++);
+            ++depth;
+            levelEnd = dirty.size();
+        }
 
-                if (child && (child->cowid() != 0))
-                {
-                    // This is a node that needs to be flushed
+        if (!dirty[i].node->isInner())
+            continue;
 
-                    child = preFlushNode(std::move(child));
+        auto inner = static_cast<SHAMapInnerNode*>(dirty[i].node.get());
+        assert(inner->cowid() == cowid_);
 
-                    if (child->isInner())
-                    {
-                        // save our place and work on this node
-
-                        stack.emplace(std::move(node), branch);
-                        // The semantics of this changes when we move to c++-20
-                        // Right now no move will occur; With c++-20 child will
-                        // be moved from.
-                        node = std::static_pointer_cast<SHAMapInnerNode>(
-                            std::move(child));
-                        pos = 0;
-                    }
-                    else
-                    {
-                        // flush this leaf
-                        ++flushed;
+        for (int branch = 0; branch < branchFactor; ++branch)
+        {
+            if (inner->isEmptyBranch(branch))
+                continue;
 
-                        assert(node->cowid() == cowid_);
-                        child->updateHash();
-                        child->unshare();
+            // No need to do I/O. If the node isn't linked,
+            // it can't need to be flushed
+            auto child = inner->getChild(branch);
+            if (!child || child->cowid() == 0)
+                continue;
 
-                        if (doWrite)
-                            child = writeNode(t, std::move(child));
+            child = preFlushNode(std::move(child));
+            inner->shareChild(branch, child);
 
-                        node->shareChild(branch, child);
-                    }
-                }
+            if (child->isInner())
+            {
+                if (levels.size() == depth + 1)
+                    levels.emplace_back();
+                levels[depth + 1].push_back(
+                    static_cast<SHAMapInnerNode*>(child.get()));
+            }
+            else
+            {
+                child->updateHash();
             }
+
+            dirty.push_back({std::move(child), i, branch});
         }
+    }
 
-        // update the hash of this inner node
-        node->updateHashDeep();
+    // Hash the inner nodes, children before parents
+    for (auto it = levels.rbegin(); it != levels.rend(); ++it)
+        SHAMapInnerNode::updateHashesDeep(*it);
 
-        // This inner node can now be shared
-        node->unshare();
+    // Share and write the nodes, children before parents, hooking each one
+    // to its parent in place of the node it was cloned from
+    for (auto i = dirty.size(); i-- != 0;)
+    {
+        auto child = std::move(dirty[i].node);
+
+        // This node can now be shared
+        child->unshare();
 
         if (doWrite)
-            node = std::static_pointer_cast<SHAMapInnerNode>(
-                writeNode(t, std::move(node)));
+            child = writeNode(t, std::move(child));
 
         ++flushed;
 
-        if (stack.empty())
-            break;
+        // The top node takes the place of the one we were given
+        if (i == 0)
+            return {std::move(child), flushed};
 
-        auto parent = std::move(stack.top().first);
-        pos = stack.top().second;
-        stack.pop();
-
-        // Hook this inner node to its parent
+        auto& parent = dirty[dirty[i].parent].node;
         assert(parent->cowid() == cowid_);
-        parent->shareChild(pos, node);
+        static_cast<SHAMapInnerNode*>(parent.get())
+            ->shareChild(dirty[i].branch, child);
+    }
 
-        // Continue with parent's next child, if any
-        node = std::move(parent);
-        ++pos;
+    return {nullptr, flushed};
+}
+
+std::pair<SharedIntrusive<SHAMapTreeNode>, int>
+SHAMap::flushParallel(
+    SharedIntrusive<SHAMapInnerNode> root,
+    bool doWrite,
+    NodeObjectType t,
+    std::size_t workers) const
+{
+    // The dirty nodes two levels below the root, or one for leaves, are
+    // flushed by the workers with all the nodes below them. The top two
+    // levels are done here once they are finished.
+    struct Task
+    {
+        SHAMapInnerNode* parent;
+        int branch;
+        SharedIntrusive<SHAMapTreeNode> node;
+        int flushed = 0;
+    };
+    std::vector<Task> tasks;
+    std::vector<std::pair<int, SharedIntrusive<SHAMapInnerNode>>> top;
+
+    auto forDirtyChildren = [this](SHAMapInnerNode& parent, auto&& f) {
+        for (int branch = 0; branch < branchFactor; ++branch)
+        {
+            if (parent.isEmptyBranch(branch))
+                continue;
+
+            auto child = parent.getChild(branch);
+            if (!child || child->cowid() == 0)
+                continue;
+
+            child = preFlushNode(std::move(child));
+            parent.shareChild(branch, child);
+            f(branch, std::move(child));
+        }
+    };
+
+    forDirtyChildren(*root, [&](int branch, auto child) {
+        if (child->isLeaf())
+        {
+            tasks.push_back({root.get(), branch, std::move(child)});
+            return;
+        }
+
+        auto inner = static_pointer_cast<SHAMapInnerNode>(child);
+        forDirtyChildren(*inner, [&](int b, auto grandchild) {
+            tasks.push_back({inner.get(), b, std::move(grandchild)});
+        });
+        top.emplace_back(branch, std::move(inner));
+    });
+
+    forEachIndex(tasks.size(), workers, [&](std::size_t i) {
+        auto& task = tasks[i];
+        std::tie(task.node, task.flushed) =
+            flushSubTree(std::move(task.node), doWrite, t);
+    });
+
+    int flushed = 0;
+    for (auto const& task : tasks)
+    {
+        task.parent->shareChild(task.branch, task.node);
+        flushed += task.flushed;
     }
 
-    // Last inner node is the new root_
-    root_ = std::move(node);
+    auto finish = [&](SharedIntrusive<SHAMapInnerNode> node) {
+        node->updateHashDeep();
+        node->unshare();
+        ++flushed;
+        if (doWrite)
+            return writeNode(t, std::move(node));
+        return SharedIntrusive<SHAMapTreeNode>(std::move(node));
+    };
 
-    return flushed;
+    for (auto& [branch, inner] : top)
+        root->shareChild(branch, finish(std::move(inner)));
+
+    auto node = finish(std::move(root));
+    return {std::move(node), flushed};
 }
 
 void
@@ -1164,7 +1283,7 @@ SHAMap::dump(bool hash) const
     JLOG(journal_.info()) << leafCount << " resident leaves";
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMap::cacheLookup(SHAMapHash const& hash) const
 {
     auto ret = f_.getTreeNodeCache(ledgerSeq_)->fetch(hash.as_uint256());
@@ -1175,7 +1294,7 @@ SHAMap::cacheLookup(SHAMapHash const& hash) const
 void
 SHAMap::canonicalize(
     SHAMapHash const& hash,
-    std::shared_ptr<SHAMapTreeNode>& node) const
+    SharedIntrusive<SHAMapTreeNode>& node) const
 {
     assert(backed_);
     assert(node->cowid() == 0);
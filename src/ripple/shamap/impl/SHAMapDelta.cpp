@@ -255,28 +255,28 @@ SHAMap::walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing)
     if (!root_->isInner())  // root_ is only node, and we have it
         return;
 
-    using StackEntry = std::shared_ptr<SHAMapInnerNode>;
+    using StackEntry = SharedIntrusive<SHAMapInnerNode>;
     std::stack<StackEntry, std::vector<StackEntry>> nodeStack;
 
-    nodeStack.push(std::static_pointer_cast<SHAMapInnerNode>(root_));
+    nodeStack.push(static_pointer_cast<SHAMapInnerNode>(root_));
 
     while (!nodeStack.empty())
     {
-        std::shared_ptr<SHAMapInnerNode> node = std::move(nodeStack.top());
+        SharedIntrusive<SHAMapInnerNode> node = std::move(nodeStack.top());
         nodeStack.pop();
 
         for (int i = 0; i < 16; ++i)
         {
             if (!node->isEmptyBranch(i))
             {
-                std::shared_ptr<SHAMapTreeNode> nextNode =
+                SharedIntrusive<SHAMapTreeNode> nextNode =
                     descendNoStore(node, i);
 
                 if (nextNode)
                 {
                     if (nextNode->isInner())
                         nodeStack.push(
-                            std::static_pointer_cast<SHAMapInnerNode>(
+                            static_pointer_cast<SHAMapInnerNode>(
                                 nextNode));
                 }
                 else
@@ -298,11 +298,11 @@ SHAMap::walkMapParallel(
     if (!root_->isInner())  // root_ is only node, and we have it
         return false;
 
-    using StackEntry = std::shared_ptr<SHAMapInnerNode>;
-    std::array<std::shared_ptr<SHAMapTreeNode>, 16> topChildren;
+    using StackEntry = SharedIntrusive<SHAMapInnerNode>;
+    std::array<SharedIntrusive<SHAMapTreeNode>, 16> topChildren;
     {
         auto const& innerRoot =
-            std::static_pointer_cast<SHAMapInnerNode>(root_);
+            static_pointer_cast<SHAMapInnerNode>(root_);
         for (int i = 0; i < 16; ++i)
         {
             if (!innerRoot->isEmptyBranch(i))
@@ -327,7 +327,7 @@ SHAMap::walkMapParallel(
             continue;
 
         nodeStacks[rootChildIndex].push(
-            std::static_pointer_cast<SHAMapInnerNode>(child));
+            static_pointer_cast<SHAMapInnerNode>(child));
 
         JLOG(journal_.debug()) << "starting worker " << rootChildIndex;
         workers.push_back(std::thread(
@@ -337,7 +337,7 @@ SHAMap::walkMapParallel(
                 {
                     while (!nodeStack.empty())
                     {
-                        std::shared_ptr<SHAMapInnerNode> node =
+                        SharedIntrusive<SHAMapInnerNode> node =
                             std::move(nodeStack.top());
                         assert(node);
                         nodeStack.pop();
@@ -346,13 +346,13 @@ SHAMap::walkMapParallel(
                         {
                             if (node->isEmptyBranch(i))
                                 continue;
-                            std::shared_ptr<SHAMapTreeNode> nextNode =
+                            SharedIntrusive<SHAMapTreeNode> nextNode =
                                 descendNoStore(node, i);
 
                             if (nextNode)
                             {
                                 if (nextNode->isInner())
-                                    nodeStack.push(std::static_pointer_cast<
+                                    nodeStack.push(static_pointer_cast<
                                                    SHAMapInnerNode>(nextNode));
                             }
                             else
@@ -30,6 +30,7 @@
 #include <ripple/shamap/impl/TaggedPointer.ipp>
 
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <utility>
 
@@ -44,6 +45,16 @@ SHAMapInnerNode::SHAMapInnerNode(
 
 SHAMapInnerNode::~SHAMapInnerNode() = default;
 
+void
+SHAMapInnerNode::partialDestructor()
+{
+    // no strong reference remains, so nothing else can reach the children
+    auto [numAllocated, _, children] =
+        hashesAndChildren_.getHashesAndChildren();
+    for (std::size_t i = 0; i < numAllocated; ++i)
+        children[i].reset();
+}
+
 template <class F>
 void
 SHAMapInnerNode::iterChildren(F&& f) const
@@ -71,17 +82,17 @@ SHAMapInnerNode::getChildIndex(int i) const
     return hashesAndChildren_.getChildIndex(isBranch_, i);
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapInnerNode::clone(std::uint32_t cowid) const
 {
     auto const branchCount = getBranchCount();
     auto const thisIsSparse = !hashesAndChildren_.isDense();
-    auto p = std::make_shared<SHAMapInnerNode>(cowid, branchCount);
+    auto p = make_SharedIntrusive<SHAMapInnerNode>(cowid, branchCount);
     p->hash_ = hash_;
     p->isBranch_ = isBranch_;
     p->fullBelowGen_ = fullBelowGen_;
     SHAMapHash *cloneHashes, *thisHashes;
-    std::shared_ptr<SHAMapTreeNode>*cloneChildren, *thisChildren;
+    SharedIntrusive<SHAMapTreeNode>*cloneChildren, *thisChildren;
     // structured bindings can't be captured in c++ 17; use tie instead
     std::tie(std::ignore, cloneHashes, cloneChildren) =
         p->hashesAndChildren_.getHashesAndChildren();
@@ -122,7 +133,7 @@ SHAMapInnerNode::clone(std::uint32_t cowid) const
     return p;
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapInnerNode::makeFullInner(
     Slice data,
     SHAMapHash const& hash,
@@ -132,7 +143,7 @@ SHAMapInnerNode::makeFullInner(
     if (data.size() != branchFactor * uint256::bytes)
         Throw<std::runtime_error>("Invalid FI node");
 
-    auto ret = std::make_shared<SHAMapInnerNode>(0, branchFactor);
+    auto ret = make_SharedIntrusive<SHAMapInnerNode>(0, branchFactor);
 
     SerialIter si(data);
 
@@ -156,7 +167,7 @@ SHAMapInnerNode::makeFullInner(
     return ret;
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapInnerNode::makeCompressedInner(Slice data)
 {
     // A compressed inner node is serialized as a series of 33 byte chunks,
@@ -169,7 +180,7 @@ SHAMapInnerNode::makeCompressedInner(Slice data)
 
     SerialIter si(data);
 
-    auto ret = std::make_shared<SHAMapInnerNode>(0, branchFactor);
+    auto ret = make_SharedIntrusive<SHAMapInnerNode>(0, branchFactor);
 
     auto hashes = ret->hashesAndChildren_.getHashes();
 
@@ -208,10 +219,10 @@ SHAMapInnerNode::updateHash()
 }
 
 void
-SHAMapInnerNode::updateHashDeep()
+SHAMapInnerNode::updateChildHashes()
 {
     SHAMapHash* hashes;
-    std::shared_ptr<SHAMapTreeNode>* children;
+    SharedIntrusive<SHAMapTreeNode>* children;
     // structured bindings can't be captured in c++ 17; use tie instead
     std::tie(std::ignore, hashes, children) =
         hashesAndChildren_.getHashesAndChildren();
@@ -219,9 +230,69 @@ SHAMapInnerNode::updateHashDeep()
         if (children[indexNum] != nullptr)
             hashes[indexNum] = children[indexNum]->getHash();
     });
+}
+
+void
+SHAMapInnerNode::updateHashDeep()
+{
+    updateChildHashes();
     updateHash();
 }
 
+void
+SHAMapInnerNode::updateHashesDeep(std::vector<SHAMapInnerNode*> const& nodes)
+{
+    // What updateHash hashes: the prefix and all 16 child hashes
+    constexpr std::size_t size = 4 + branchFactor * uint256::bytes;
+
+    // Enough nodes to fill the lanes many times over, in little memory
+    constexpr std::size_t chunk = 256;
+
+    std::vector<std::uint8_t> buffer(chunk * size);
+    std::vector<std::uint8_t const*> messages;
+    std::vector<SHAMapInnerNode*> hashing;
+    std::vector<uint256> digests(chunk);
+
+    auto flush = [&]() {
+        sha512HalfBatch(
+            messages.data(), size, digests.data(), messages.size());
+        for (std::size_t i = 0; i < hashing.size(); ++i)
+            hashing[i]->hash_ = SHAMapHash{digests[i]};
+        messages.clear();
+        hashing.clear();
+    };
+
+    for (auto const node : nodes)
+    {
+        node->updateChildHashes();
+
+        if (node->isBranch_ == 0)
+        {
+            node->hash_ = SHAMapHash{};
+            continue;
+        }
+
+        auto p = buffer.data() + messages.size() * size;
+        messages.push_back(p);
+        hashing.push_back(node);
+
+        auto const prefix = boost::endian::native_to_big(
+            static_cast<std::uint32_t>(HashPrefix::innerNode));
+        std::memcpy(p, &prefix, sizeof(prefix));
+        p += sizeof(prefix);
+        node->iterChildren([&](SHAMapHash const& hh) {
+            std::memcpy(p, hh.as_uint256().data(), uint256::bytes);
+            p += uint256::bytes;
+        });
+
+        if (messages.size() == chunk)
+            flush();
+    }
+
+    if (!messages.empty())
+        flush();
+}
+
 void
 SHAMapInnerNode::serializeForWire(Serializer& s) const
 {
@@ -284,7 +355,7 @@ SHAMapInnerNode::getString(const SHAMapNodeID& id) const
 
 // We are modifying an inner node
 void
-SHAMapInnerNode::setChild(int m, std::shared_ptr<SHAMapTreeNode> child)
+SHAMapInnerNode::setChild(int m, SharedIntrusive<SHAMapTreeNode> child)
 {
     assert((m >= 0) && (m < branchFactor));
     assert(cowid_ != 0);
@@ -320,7 +391,7 @@ SHAMapInnerNode::setChild(int m, std::shared_ptr<SHAMapTreeNode> child)
 
 // finished modifying, now make shareable
 void
-SHAMapInnerNode::shareChild(int m, std::shared_ptr<SHAMapTreeNode> const& child)
+SHAMapInnerNode::shareChild(int m, SharedIntrusive<SHAMapTreeNode> const& child)
 {
     assert((m >= 0) && (m < branchFactor));
     assert(cowid_ != 0);
@@ -344,7 +415,7 @@ SHAMapInnerNode::getChildPointer(int branch)
     return hashesAndChildren_.getChildren()[index].get();
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapInnerNode::getChild(int branch)
 {
     assert(branch >= 0 && branch < branchFactor);
@@ -367,10 +438,10 @@ SHAMapInnerNode::getChildHash(int m) const
     return zeroSHAMapHash;
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapInnerNode::canonicalizeChild(
     int branch,
-    std::shared_ptr<SHAMapTreeNode> node)
+    SharedIntrusive<SHAMapTreeNode> node)
 {
     assert(branch >= 0 && branch < branchFactor);
     assert(node);
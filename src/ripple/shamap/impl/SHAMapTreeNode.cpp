@@ -36,7 +36,7 @@
 
 namespace ripple {
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapTreeNode::makeTransaction(
     Slice data,
     SHAMapHash const& hash,
@@ -46,12 +46,12 @@ SHAMapTreeNode::makeTransaction(
         sha512Half(HashPrefix::transactionID, data), data);
 
     if (hashValid)
-        return std::make_shared<SHAMapTxLeafNode>(std::move(item), 0, hash);
+        return make_SharedIntrusive<SHAMapTxLeafNode>(std::move(item), 0, hash);
 
-    return std::make_shared<SHAMapTxLeafNode>(std::move(item), 0);
+    return make_SharedIntrusive<SHAMapTxLeafNode>(std::move(item), 0);
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapTreeNode::makeTransactionWithMeta(
     Slice data,
     SHAMapHash const& hash,
@@ -74,13 +74,13 @@ SHAMapTreeNode::makeTransactionWithMeta(
     auto item = std::make_shared<SHAMapItem const>(tag, s.slice());
 
     if (hashValid)
-        return std::make_shared<SHAMapTxPlusMetaLeafNode>(
+        return make_SharedIntrusive<SHAMapTxPlusMetaLeafNode>(
             std::move(item), 0, hash);
 
-    return std::make_shared<SHAMapTxPlusMetaLeafNode>(std::move(item), 0);
+    return make_SharedIntrusive<SHAMapTxPlusMetaLeafNode>(std::move(item), 0);
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapTreeNode::makeAccountState(
     Slice data,
     SHAMapHash const& hash,
@@ -106,13 +106,13 @@ SHAMapTreeNode::makeAccountState(
     auto item = std::make_shared<SHAMapItem const>(tag, s.slice());
 
     if (hashValid)
-        return std::make_shared<SHAMapAccountStateLeafNode>(
+        return make_SharedIntrusive<SHAMapAccountStateLeafNode>(
             std::move(item), 0, hash);
 
-    return std::make_shared<SHAMapAccountStateLeafNode>(std::move(item), 0);
+    return make_SharedIntrusive<SHAMapAccountStateLeafNode>(std::move(item), 0);
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapTreeNode::makeFromWire(Slice rawNode)
 {
     if (rawNode.empty())
@@ -144,7 +144,7 @@ SHAMapTreeNode::makeFromWire(Slice rawNode)
         "wire: Unknown type (" + std::to_string(type) + ")");
 }
 
-std::shared_ptr<SHAMapTreeNode>
+SharedIntrusive<SHAMapTreeNode>
 SHAMapTreeNode::makeFromPrefix(Slice rawNode, SHAMapHash const& hash)
 {
     if (rawNode.size() < 4)
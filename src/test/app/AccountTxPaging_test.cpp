@@ -17,6 +17,7 @@
 */
 //==============================================================================
 #include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
 #include <ripple/protocol/SField.h>
 #include <ripple/protocol/jss.h>
 #include <cstdlib>
@@ -61,12 +62,18 @@ class AccountTxPaging_test : public beast::unit_test::suite
     }
 
     void
-    testAccountTxPaging(FeatureBitset features)
+    testAccountTxPaging(FeatureBitset features, bool txIndex)
     {
-        testcase("Paging for Single Account");
+        testcase(
+            std::string("Paging for Single Account") +
+            (txIndex ? " txindex" : ""));
         using namespace test::jtx;
 
-        Env env(*this, features);
+        beast::temp_dir dir;
+        Env env(
+            *this,
+            txIndex ? envconfig(txindex, dir.path()) : envconfig(),
+            features);
         Account A1{"A1"};
         Account A2{"A2"};
         Account A3{"A3"};
@@ -269,7 +276,8 @@ public:
     {
         using namespace test::jtx;
         auto const sa = supported_amendments();
-        testAccountTxPaging(sa - featureXahauGenesis);
+        testAccountTxPaging(sa - featureXahauGenesis, false);
+        testAccountTxPaging(sa - featureXahauGenesis, true);
     }
 };
 
@@ -0,0 +1,203 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/basics/Blob.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/digest.h>
+
+namespace ripple {
+namespace test {
+
+class HookModuleCache_test : public beast::unit_test::suite
+{
+    // an empty but valid module padded with a custom section so that
+    // modules of different sizes and hashes can be produced
+    static Blob
+    makeModule(std::uint8_t pad)
+    {
+        assert(pad <= 120);
+        Blob wasm{0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00};
+        wasm.push_back(0x00);  // custom section
+        wasm.push_back(static_cast<std::uint8_t>(pad + 2));
+        wasm.push_back(0x01);  // name length
+        wasm.push_back('x');
+        wasm.insert(wasm.end(), pad, 0xFF);
+        return wasm;
+    }
+
+    static uint256
+    hashOf(Blob const& wasm)
+    {
+        return sha512Half_s(Slice(wasm.data(), wasm.size()));
+    }
+
+    void
+    testHitMiss()
+    {
+        testcase("hit and miss");
+
+        hook::ModuleCache cache;
+        auto const wasm = makeModule(0);
+        auto const hash = hashOf(wasm);
+
+        auto const first = cache.fetch(hash, wasm.data(), wasm.size());
+        BEAST_EXPECT(first.has_value());
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.bytes() == wasm.size());
+        BEAST_EXPECT(cache.misses() == 1 && cache.hits() == 0);
+
+        auto const second = cache.fetch(hash, wasm.data(), wasm.size());
+        BEAST_EXPECT(second.has_value());
+        BEAST_EXPECT(cache.misses() == 1 && cache.hits() == 1);
+        BEAST_EXPECT(first->get() == second->get());
+
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(cache.bytes() == 0);
+
+        // a module held by an execution outlives its cache entry
+        BEAST_EXPECT(first->use_count() == 2);
+    }
+
+    void
+    testInvalid()
+    {
+        testcase("invalid modules are not cached");
+
+        hook::ModuleCache cache;
+        Blob const garbage{0x00, 0x61, 0x73, 0x6d, 0x02, 0x00, 0x00};
+        auto const hash = hashOf(garbage);
+
+        auto const result = cache.fetch(hash, garbage.data(), garbage.size());
+        BEAST_EXPECT(!result.has_value());
+        BEAST_EXPECT(!result.error().empty());
+        BEAST_EXPECT(cache.size() == 0);
+
+        BEAST_EXPECT(!cache.fetch(hash, garbage.data(), garbage.size()));
+        BEAST_EXPECT(cache.misses() == 2);
+    }
+
+    void
+    testEviction()
+    {
+        testcase("least recently used eviction");
+
+        std::vector<Blob> modules;
+        for (std::uint8_t i = 0; i < 4; ++i)
+            modules.push_back(makeModule(i * 10));
+
+        auto fetch = [&](hook::ModuleCache& cache, int i) {
+            auto const& wasm = modules[i];
+            return cache.fetch(hashOf(wasm), wasm.data(), wasm.size())
+                .has_value();
+        };
+
+        {
+            // bounded by entry count
+            hook::ModuleCache cache{2};
+            BEAST_EXPECT(fetch(cache, 0));
+            BEAST_EXPECT(fetch(cache, 1));
+            BEAST_EXPECT(fetch(cache, 0));  // 1 is now least recent
+            BEAST_EXPECT(fetch(cache, 2));
+            BEAST_EXPECT(cache.size() == 2);
+            BEAST_EXPECT(cache.hits() == 1);
+
+            BEAST_EXPECT(fetch(cache, 0));
+            BEAST_EXPECT(cache.hits() == 2);
+            BEAST_EXPECT(fetch(cache, 1));
+            BEAST_EXPECT(cache.misses() == 4);
+        }
+
+        {
+            // bounded by bytecode size
+            auto const budget = modules[2].size() + modules[3].size();
+            hook::ModuleCache cache{100, budget};
+            BEAST_EXPECT(fetch(cache, 0));
+            BEAST_EXPECT(fetch(cache, 1));
+            BEAST_EXPECT(fetch(cache, 2));
+            BEAST_EXPECT(cache.bytes() <= budget);
+            BEAST_EXPECT(fetch(cache, 3));
+            BEAST_EXPECT(cache.size() == 2);
+            BEAST_EXPECT(cache.bytes() == budget);
+        }
+
+        {
+            // a module larger than the whole budget is usable but not kept
+            hook::ModuleCache cache{100, modules[0].size()};
+            BEAST_EXPECT(fetch(cache, 3));
+            BEAST_EXPECT(cache.size() == 0);
+        }
+    }
+
+    void
+    testPromotion()
+    {
+        testcase("native promotion");
+
+        hook::ModuleCache cache;
+        auto const wasm = makeModule(0);
+        auto const hash = hashOf(wasm);
+
+        // nothing to promote until the module is cached
+        BEAST_EXPECT(!cache.claimCompilation(hash, 0));
+
+        for (int i = 0; i < 3; ++i)
+        {
+            BEAST_EXPECT(cache.fetch(hash, wasm.data(), wasm.size()));
+            BEAST_EXPECT(!cache.claimCompilation(hash, 4));
+        }
+
+        BEAST_EXPECT(cache.fetch(hash, wasm.data(), wasm.size()));
+        BEAST_EXPECT(cache.claimCompilation(hash, 4));
+        BEAST_EXPECT(!cache.claimCompilation(hash, 4));
+        BEAST_EXPECT(!cache.isNative(hash));
+
+        // any validated module stands in for a natively compiled one here
+        auto const replacement =
+            hook::ModuleCache::load(wasm.data(), wasm.size());
+        BEAST_EXPECT(replacement);
+        BEAST_EXPECT(cache.installNative(hash, *replacement));
+        BEAST_EXPECT(cache.isNative(hash));
+
+        auto const fetched = cache.fetch(hash, wasm.data(), wasm.size());
+        BEAST_EXPECT(fetched && fetched->get() == replacement->get());
+        BEAST_EXPECT(!cache.claimCompilation(hash, 0));
+
+        // an evicted entry does not accept a native module
+        cache.clear();
+        BEAST_EXPECT(!cache.installNative(hash, *replacement));
+        BEAST_EXPECT(!cache.isNative(hash));
+    }
+
+public:
+    void
+    run() override
+    {
+        testHitMiss();
+        testInvalid();
+        testEviction();
+        testPromotion();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookModuleCache, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
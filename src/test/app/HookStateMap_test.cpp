@@ -0,0 +1,290 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/applyHook.h>
+#include <ripple/basics/Blob.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/digest.h>
+#include <test/jtx.h>
+#include <chrono>
+
+namespace ripple {
+namespace test {
+
+static uint256
+stateKey(std::uint32_t i)
+{
+    return sha512Half(i);
+}
+
+class HookStateMap_test : public beast::unit_test::suite
+{
+    void
+    testInsertFind()
+    {
+        testcase("insert and find");
+
+        hook::HookStateMap map;
+        AccountID const acc{1};
+        uint256 const ns{2};
+
+        BEAST_EXPECT(!map.find(acc, ns, stateKey(0)));
+        BEAST_EXPECT(!map.findAccount(acc));
+        BEAST_EXPECT(!map.hasNamespace(acc, ns));
+
+        map.insertAccount(acc, 10, 1);
+        BEAST_EXPECT(map.findAccount(acc)->availableReserves == 10);
+
+        // enough entries to force the table to grow several times
+        for (std::uint32_t i = 0; i < 1000; ++i)
+        {
+            Blob const value(i % 300, static_cast<std::uint8_t>(i));
+            map.insert(acc, ns, stateKey(i), i % 2, makeSlice(value));
+        }
+
+        BEAST_EXPECT(map.size() == 1000);
+        BEAST_EXPECT(map.hasNamespace(acc, ns));
+        BEAST_EXPECT(!map.hasNamespace(acc, uint256{3}));
+
+        bool ok = true;
+        for (std::uint32_t i = 0; i < 1000; ++i)
+        {
+            auto const* entry = map.find(acc, ns, stateKey(i));
+            Blob const value(i % 300, static_cast<std::uint8_t>(i));
+            ok = ok && entry && entry->modified == bool(i % 2) &&
+                entry->value() == makeSlice(value);
+        }
+        BEAST_EXPECT(ok);
+
+        BEAST_EXPECT(!map.find(acc, uint256{3}, stateKey(0)));
+        BEAST_EXPECT(!map.find(AccountID{4}, ns, stateKey(0)));
+
+        map.clear();
+        BEAST_EXPECT(map.size() == 0);
+        BEAST_EXPECT(map.arenaBytes() == 0);
+        BEAST_EXPECT(!map.find(acc, ns, stateKey(0)));
+    }
+
+    void
+    testAssign()
+    {
+        testcase("assign");
+
+        hook::HookStateMap map;
+        AccountID const acc{1};
+        map.insertAccount(acc, 10, 0);
+
+        Blob const small(8, 0xAA);
+        Blob const large(4096, 0xBB);
+        Blob const empty;
+
+        auto& entry = map.insert(acc, uint256{}, stateKey(0), false, {});
+        BEAST_EXPECT(entry.value().empty());
+
+        map.assign(entry, makeSlice(small));
+        BEAST_EXPECT(entry.value() == makeSlice(small));
+
+        // a larger value moves, a smaller one reuses the storage
+        map.assign(entry, makeSlice(large));
+        BEAST_EXPECT(entry.value() == makeSlice(large));
+        auto const* storage = entry.data;
+        map.assign(entry, makeSlice(small));
+        BEAST_EXPECT(entry.value() == makeSlice(small));
+        BEAST_EXPECT(entry.data == storage);
+
+        map.assign(entry, makeSlice(empty));
+        BEAST_EXPECT(entry.size == 0);
+    }
+
+    void
+    testOrdering()
+    {
+        testcase("ordering and equality");
+
+        std::vector<hook::HookStateMap::Key> keys;
+        for (std::uint8_t a = 1; a <= 3; ++a)
+            for (std::uint8_t n = 1; n <= 3; ++n)
+                for (std::uint32_t k = 0; k < 3; ++k)
+                    keys.push_back({AccountID{a}, uint256{n}, stateKey(k)});
+
+        Blob const value{1, 2, 3};
+        auto fill = [&](hook::HookStateMap& map, auto first, auto last) {
+            for (; first != last; ++first)
+            {
+                if (!map.findAccount(first->account))
+                    map.insertAccount(first->account, 100, 0);
+                map.insert(
+                    first->account,
+                    first->ns,
+                    first->key,
+                    first->key != stateKey(1),
+                    makeSlice(value));
+            }
+            map.modified_entry_count = 18;
+        };
+
+        hook::HookStateMap forward;
+        hook::HookStateMap backward;
+        fill(forward, keys.begin(), keys.end());
+        fill(backward, keys.rbegin(), keys.rend());
+        BEAST_EXPECT(forward == backward);
+
+        auto const sorted = backward.sortedModified();
+        BEAST_EXPECT(sorted.size() == 18);
+        BEAST_EXPECT(std::is_sorted(
+            sorted.begin(), sorted.end(), [](auto const* a, auto const* b) {
+                return std::tie(a->id.account, a->id.ns, a->id.key) <
+                    std::tie(b->id.account, b->id.ns, b->id.key);
+            }));
+
+        backward.assign(
+            *backward.find(keys[0].account, keys[0].ns, keys[0].key), {});
+        BEAST_EXPECT(!(forward == backward));
+    }
+
+public:
+    void
+    run() override
+    {
+        testInsertFind();
+        testAssign();
+        testOrdering();
+    }
+};
+
+// Drives the state cache the way state(), state_set() and state_foreign()
+// do, with thousands of distinct keys, and reports the time taken.
+class HookStateMapBench_test : public beast::unit_test::suite
+{
+    template <class F>
+    std::chrono::nanoseconds
+    measure(F&& f)
+    {
+        using clock_type = std::chrono::steady_clock;
+        auto const start = clock_type::now();
+        f();
+        return clock_type::now() - start;
+    }
+
+    void
+    report(char const* what, std::chrono::nanoseconds elapsed, std::size_t n)
+    {
+        log << "  " << what << ": " << elapsed.count() / n << " ns/op"
+            << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+
+        std::size_t const keys = 4096;
+        int const rounds = 10;
+
+        Env env{*this};
+        auto const alice = Account{"alice"};
+        env.fund(XRP(1000000), alice);
+        env.close();
+
+        auto const jt = env.jt(noop(alice));
+        std::map<std::vector<uint8_t>, std::vector<uint8_t>> const params;
+        std::map<
+            uint256,
+            std::map<std::vector<uint8_t>, std::vector<uint8_t>>> const
+            overrides;
+
+        Blob const value(128, 0x5A);
+        uint256 const ns{1};
+
+        testcase("state cache with " + std::to_string(keys) + " keys");
+
+        std::chrono::nanoseconds insert{}, lookup{}, update{};
+        for (int round = 0; round < rounds; ++round)
+        {
+            OpenView ov{*env.current()};
+            ApplyContext ac{
+                env.app(),
+                ov,
+                *jt.stx,
+                tesSUCCESS,
+                env.current()->fees().base,
+                tapNONE,
+                env.journal};
+
+            hook::HookStateMap stateMap;
+            hook::HookContext hookCtx{
+                .applyCtx = ac,
+                .result = {
+                    .accountKeylet = keylet::account(alice.id()),
+                    .ownerDirKeylet = keylet::ownerDir(alice.id()),
+                    .hookKeylet = keylet::hook(alice.id()),
+                    .account = alice.id(),
+                    .otxnAccount = alice.id(),
+                    .hookNamespace = ns,
+                    .stateMap = stateMap,
+                    .hookParamOverrides = overrides,
+                    .hookParams = params}};
+
+            // values read from the ledger are cached unmodified
+            insert += measure([&] {
+                for (std::uint32_t i = 0; i < keys; ++i)
+                    hook::set_state_cache(
+                        hookCtx,
+                        alice.id(),
+                        ns,
+                        stateKey(i),
+                        makeSlice(value),
+                        false);
+            });
+
+            lookup += measure([&] {
+                for (std::uint32_t i = 0; i < keys; ++i)
+                    BEAST_EXPECT(hook::lookup_state_cache(
+                        hookCtx, alice.id(), ns, stateKey(i)));
+            });
+
+            // writes are bounded by max_state_modifications per transaction
+            update += measure([&] {
+                for (std::uint32_t i = 0;
+                     i < hook_api::max_state_modifications - 1;
+                     ++i)
+                    BEAST_EXPECT(
+                        hook::set_state_cache(
+                            hookCtx,
+                            alice.id(),
+                            ns,
+                            stateKey(i * 7 % keys),
+                            makeSlice(value),
+                            true) == 1);
+            });
+        }
+
+        report("insert", insert, keys * rounds);
+        report("lookup", lookup, keys * rounds);
+        report(
+            "update", update, (hook_api::max_state_modifications - 1) * rounds);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookStateMap, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(HookStateMapBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
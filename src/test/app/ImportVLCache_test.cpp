@@ -0,0 +1,190 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/tx/impl/Import.h>
+#include <ripple/app/tx/impl/ImportVLCache.h>
+#include <ripple/protocol/jss.h>
+#include <test/app/Import_json.h>
+#include <test/jtx.h>
+#include <chrono>
+
+namespace ripple {
+namespace test {
+
+static std::vector<std::string> const importVLKeys = {
+    "ED74D4036C6591A4BDF9C54CEFA39B996A5DCE5F86D11FDA1874481CE9D5A1CDC1"};
+
+// run Import preflight on an XPOP submitted by alice
+static TER
+preflightImport(jtx::Env& env, std::string const& xpop)
+{
+    using namespace jtx;
+
+    auto const alice = Account("alice");
+    Json::Value tx = import::import(alice, import::loadXpop(xpop));
+    tx[jss::Sequence] = 0;
+    tx[jss::Fee] = 0;
+
+    auto const jt = env.jt(tx, alice);
+    PreflightContext const ctx(
+        env.app(), *jt.stx, env.current()->rules(), tapNONE, env.journal);
+    return Import::preflight(ctx);
+}
+
+class ImportVLCache_test : public beast::unit_test::suite
+{
+    void
+    testCache()
+    {
+        testcase("lookup and eviction");
+
+        ImportVLCache cache{2};
+        auto const vl = std::make_shared<VerifiedVL const>();
+
+        BEAST_EXPECT(!cache.fetch(uint256{1}));
+        cache.insert(uint256{1}, vl);
+        cache.insert(uint256{2}, vl);
+        BEAST_EXPECT(cache.fetch(uint256{1}) == vl);  // 2 is least recent
+        cache.insert(uint256{3}, vl);
+
+        BEAST_EXPECT(cache.size() == 2);
+        BEAST_EXPECT(cache.fetch(uint256{1}));
+        BEAST_EXPECT(!cache.fetch(uint256{2}));
+        BEAST_EXPECT(cache.fetch(uint256{3}));
+        BEAST_EXPECT(cache.hits() == 3 && cache.misses() == 2);
+
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+    }
+
+    void
+    testKey()
+    {
+        testcase("key covers the whole unl section");
+
+        auto const xpop = jtx::import::loadXpop(ImportTCAccountSet::w_seed);
+        auto const& unl = xpop[jss::validation][jss::unl];
+        auto const key = ImportVLCache::key(unl);
+        BEAST_EXPECT(key == ImportVLCache::key(unl));
+
+        for (auto const& field :
+             {jss::public_key, jss::manifest, jss::blob, jss::signature})
+        {
+            auto altered = unl;
+            altered[field] = altered[field].asString() + "00";
+            BEAST_EXPECT(ImportVLCache::key(altered) != key);
+        }
+    }
+
+    void
+    testPreflight()
+    {
+        testcase("preflight uses the cache");
+
+        using namespace jtx;
+        Env env{*this, network::makeNetworkVLConfig(21337, importVLKeys)};
+
+        auto& cache = ImportVLCache::instance();
+        cache.clear();
+        auto const misses = cache.misses();
+        auto const hits = cache.hits();
+
+        auto const cold = preflightImport(env, ImportTCAccountSet::w_seed);
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.misses() == misses + 1);
+
+        auto const warm = preflightImport(env, ImportTCAccountSet::w_seed);
+        BEAST_EXPECT(cache.hits() == hits + 1);
+        BEAST_EXPECT(cold == warm);
+
+        cache.clear();
+    }
+
+public:
+    void
+    run() override
+    {
+        testCache();
+        testKey();
+        testPreflight();
+    }
+};
+
+// Replays the XPOP fixtures through Import preflight, with the validator list
+// verified every time and with it served from the cache.
+class ImportVLCacheBench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+        using clock_type = std::chrono::steady_clock;
+
+        Env env{*this, network::makeNetworkVLConfig(21337, importVLKeys)};
+
+        std::vector<std::string> const fixtures = {
+            ImportTCAccountSet::min,
+            ImportTCAccountSet::max,
+            ImportTCAccountSet::w_seed,
+            ImportTCAccountSet::w_regular_key,
+            ImportTCAccountSet::w_signers,
+            ImportTCAccountSet::w_flags};
+
+        int const rounds = 200;
+        auto& cache = ImportVLCache::instance();
+
+        auto replay = [&](bool cached) {
+            std::vector<TER> results;
+            auto const start = clock_type::now();
+            for (int i = 0; i < rounds; ++i)
+            {
+                for (auto const& xpop : fixtures)
+                {
+                    if (!cached)
+                        cache.clear();
+                    results.push_back(preflightImport(env, xpop));
+                }
+            }
+            auto const elapsed = clock_type::now() - start;
+            log << "  " << (cached ? "cached" : "uncached") << ": "
+                << std::chrono::duration_cast<std::chrono::microseconds>(
+                       elapsed)
+                        .count() /
+                    (rounds * fixtures.size())
+                << " us/import" << std::endl;
+            return results;
+        };
+
+        testcase("replay " + std::to_string(fixtures.size()) + " XPOPs");
+
+        auto const uncached = replay(false);
+        cache.clear();
+        auto const cached = replay(true);
+        BEAST_EXPECT(uncached == cached);
+
+        cache.clear();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ImportVLCache, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(ImportVLCacheBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -314,6 +314,11 @@ public:
     {
         return false;
     }
+    bool
+    txBatchEnabled() const override
+    {
+        return false;
+    }
 
     bool ledgerReplayEnabled_;
 };
@@ -1089,7 +1094,7 @@ struct LedgerReplayer_test : public beast::unit_test::suite
         testcase("handshake test");
         auto handshake = [&](bool client, bool server, bool expecting) -> bool {
             auto request =
-                ripple::makeRequest(true, false, client, false, false);
+                ripple::makeRequest(true, false, client, false, false, false);
             http_request_type http_request;
             http_request.version(request.version());
             http_request.base() = request.base();
@@ -0,0 +1,246 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/rdb/backend/detail/LedgerWriter.h>
+#include <ripple/basics/contract.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/jss.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace ripple {
+namespace test {
+
+class LedgerWriter_test : public beast::unit_test::suite
+{
+    using LedgerWriter = detail::LedgerWriter;
+
+    // Lets a test hold the writer inside a write.
+    class Gate
+    {
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool open_ = false;
+        int entered_ = 0;
+
+    public:
+        void
+        pass()
+        {
+            std::unique_lock lock(mutex_);
+            ++entered_;
+            cv_.notify_all();
+            cv_.wait(lock, [this] { return open_; });
+        }
+
+        void
+        awaitEntered(int n)
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this, n] { return entered_ >= n; });
+        }
+
+        void
+        open()
+        {
+            std::lock_guard lock(mutex_);
+            open_ = true;
+            cv_.notify_all();
+        }
+    };
+
+    beast::Journal const journal_{beast::Journal::getNullSink()};
+
+    void
+    testGroups()
+    {
+        testcase("groups");
+
+        Gate gate;
+        std::mutex mutex;
+        std::vector<std::size_t> groups;
+        std::vector<int> saved;
+
+        LedgerWriter writer(
+            {3, 16},
+            [&](LedgerWriter::AcceptedLedgers const& aLedgers) {
+                gate.pass();
+                std::lock_guard lock(mutex);
+                groups.push_back(aLedgers.size());
+            },
+            journal_);
+
+        auto const save = [&](int i) {
+            writer.save({}, [&, i](bool ok) {
+                BEAST_EXPECT(ok);
+                std::lock_guard lock(mutex);
+                saved.push_back(i);
+            });
+        };
+
+        // The first ledger is written alone, the ones arriving while it is
+        // written in groups of at most three.
+        save(0);
+        gate.awaitEntered(1);
+        for (int i = 1; i < 6; ++i)
+            save(i);
+        gate.open();
+        writer.stop();
+
+        BEAST_EXPECT((groups == std::vector<std::size_t>{1, 3, 2}));
+        BEAST_EXPECT((saved == std::vector<int>{0, 1, 2, 3, 4, 5}));
+
+        auto const info = writer.getInfo();
+        BEAST_EXPECT(info[jss::groups].asString() == "3");
+        BEAST_EXPECT(info[jss::ledgers].asString() == "6");
+        BEAST_EXPECT(info[jss::last_group_size].asUInt() == 2);
+        BEAST_EXPECT(info[jss::max_group_size].asUInt() == 3);
+        BEAST_EXPECT(info[jss::queued].asUInt() == 0);
+    }
+
+    void
+    testBackpressure()
+    {
+        testcase("backpressure");
+
+        Gate gate;
+        std::atomic<int> saved{0};
+
+        LedgerWriter writer(
+            {1, 2},
+            [&](LedgerWriter::AcceptedLedgers const&) { gate.pass(); },
+            journal_);
+
+        auto const onSaved = [&](bool) { ++saved; };
+
+        // One ledger is being written and two are waiting, so the next
+        // save blocks until the writer moves on.
+        writer.save({}, onSaved);
+        gate.awaitEntered(1);
+        writer.save({}, onSaved);
+        writer.save({}, onSaved);
+
+        std::atomic<bool> returned{false};
+        std::thread blocked([&] {
+            writer.save({}, onSaved);
+            returned = true;
+        });
+
+        using namespace std::chrono_literals;
+        std::this_thread::sleep_for(100ms);
+        BEAST_EXPECT(!returned);
+        BEAST_EXPECT(writer.getInfo()[jss::queued].asUInt() == 2);
+
+        gate.open();
+        blocked.join();
+        BEAST_EXPECT(returned);
+
+        writer.stop();
+        BEAST_EXPECT(saved == 4);
+    }
+
+    void
+    testFailure()
+    {
+        testcase("failure");
+
+        int calls = 0;
+        LedgerWriter writer(
+            {4, 8},
+            [&](LedgerWriter::AcceptedLedgers const&) {
+                if (++calls == 1)
+                    Throw<std::runtime_error>("disk full");
+            },
+            journal_);
+
+        std::vector<bool> results;
+        std::mutex mutex;
+        auto const onSaved = [&](bool ok) {
+            std::lock_guard lock(mutex);
+            results.push_back(ok);
+        };
+
+        writer.save({}, onSaved);
+        writer.stop();
+        writer.save({}, onSaved);
+
+        BEAST_EXPECT((results == std::vector<bool>{false, true}));
+    }
+
+    void
+    testStop()
+    {
+        testcase("stop");
+
+        Gate gate;
+        std::vector<std::thread::id> threads;
+
+        LedgerWriter writer(
+            {8, 8},
+            [&](LedgerWriter::AcceptedLedgers const& aLedgers) {
+                gate.pass();
+                for (std::size_t i = 0; i < aLedgers.size(); ++i)
+                    threads.push_back(std::this_thread::get_id());
+            },
+            journal_);
+
+        int saved = 0;
+        auto const onSaved = [&](bool ok) {
+            BEAST_EXPECT(ok);
+            ++saved;
+        };
+
+        // Ledgers waiting when the writer stops are still written.
+        writer.save({}, onSaved);
+        gate.awaitEntered(1);
+        writer.save({}, onSaved);
+        writer.save({}, onSaved);
+        gate.open();
+        writer.stop();
+        BEAST_EXPECT(saved == 3);
+
+        // Once stopped, ledgers are written by the thread saving them.
+        writer.save({}, onSaved);
+        BEAST_EXPECT(saved == 4);
+        BEAST_EXPECT(threads.size() == 4);
+        BEAST_EXPECT(threads[0] != std::this_thread::get_id());
+        BEAST_EXPECT(threads[3] == std::this_thread::get_id());
+
+        // Stopping again does nothing.
+        writer.stop();
+    }
+
+public:
+    void
+    run() override
+    {
+        testGroups();
+        testBackpressure();
+        testFailure();
+        testStop();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerWriter, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/OrderBookDB.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class OrderBookDB_test : public beast::unit_test::suite
+{
+    void
+    testBooks()
+    {
+        testcase("books follow validated ledgers");
+
+        using namespace jtx;
+        Env env{*this};
+
+        auto const gw = Account("gw");
+        auto const alice = Account("alice");
+        auto const USD = gw["USD"];
+
+        env.fund(XRP(10000), gw, alice);
+        env.close();
+        env.trust(USD(1000), alice);
+        env(pay(gw, alice, USD(100)));
+        env.close();
+
+        auto& db = env.app().getOrderBookDB();
+        BEAST_EXPECT(db.getBookSize(xrpIssue()) == 0);
+
+        // Two quality directories of the same book
+        auto const seq = env.seq(alice);
+        env(offer(alice, XRP(10), USD(10)));
+        env(offer(alice, XRP(20), USD(10)));
+        env.close();
+        BEAST_EXPECT(db.getBookSize(xrpIssue()) == 1);
+
+        env(offer_cancel(alice, seq));
+        env.close();
+        BEAST_EXPECT(db.getBookSize(xrpIssue()) == 1);
+
+        env(offer_cancel(alice, seq + 1));
+        env.close();
+        BEAST_EXPECT(db.getBookSize(xrpIssue()) == 0);
+
+        // A book to XRP
+        env(offer(alice, USD(10), XRP(10)));
+        env.close();
+        BEAST_EXPECT(db.isBookToXRP(USD.issue()));
+        BEAST_EXPECT(db.getBookSize(USD.issue()) == 1);
+
+        env(offer_cancel(alice, seq + 2));
+        env.close();
+        BEAST_EXPECT(!db.isBookToXRP(USD.issue()));
+        BEAST_EXPECT(db.getBookSize(USD.issue()) == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBooks();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OrderBookDB, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -264,11 +264,14 @@ public:
 
         Json::Value result;
         gate g;
-        app.getJobQueue().postCoro(
-            jtCLIENT, "RPC-Client", [&](auto const& coro) {
+        app.getJobQueue().postCoroTask(
+            jtCLIENT,
+            "RPC-Client",
+            [&](std::shared_ptr<JobQueue::CoroTask> coro)
+                -> JobQueue::CoroTask::Body {
                 context.params = std::move(params);
                 context.coro = coro;
-                RPC::doCommand(context, result);
+                co_await RPC::doCommand(context, result);
                 g.signal();
             });
 
@@ -356,26 +359,32 @@ public:
         Json::Value result;
         gate g;
         // Test RPC::Tuning::max_src_cur source currencies.
-        app.getJobQueue().postCoro(
-            jtCLIENT, "RPC-Client", [&](auto const& coro) {
+        app.getJobQueue().postCoroTask(
+            jtCLIENT,
+            "RPC-Client",
+            [&](std::shared_ptr<JobQueue::CoroTask> coro)
+                -> JobQueue::CoroTask::Body {
                 context.params = rpf(
                     Account("alice"), Account("bob"), RPC::Tuning::max_src_cur);
                 context.coro = coro;
-                RPC::doCommand(context, result);
+                co_await RPC::doCommand(context, result);
                 g.signal();
             });
         BEAST_EXPECT(g.wait_for(5s));
         BEAST_EXPECT(!result.isMember(jss::error));
 
         // Test more than RPC::Tuning::max_src_cur source currencies.
-        app.getJobQueue().postCoro(
-            jtCLIENT, "RPC-Client", [&](auto const& coro) {
+        app.getJobQueue().postCoroTask(
+            jtCLIENT,
+            "RPC-Client",
+            [&](std::shared_ptr<JobQueue::CoroTask> coro)
+                -> JobQueue::CoroTask::Body {
                 context.params =
                     rpf(Account("alice"),
                         Account("bob"),
                         RPC::Tuning::max_src_cur + 1);
                 context.coro = coro;
-                RPC::doCommand(context, result);
+                co_await RPC::doCommand(context, result);
                 g.signal();
             });
         BEAST_EXPECT(g.wait_for(5s));
@@ -384,11 +393,14 @@ public:
         // Test RPC::Tuning::max_auto_src_cur source currencies.
         for (auto i = 0; i < (RPC::Tuning::max_auto_src_cur - 1); ++i)
             env.trust(Account("alice")[std::to_string(i + 100)](100), "bob");
-        app.getJobQueue().postCoro(
-            jtCLIENT, "RPC-Client", [&](auto const& coro) {
+        app.getJobQueue().postCoroTask(
+            jtCLIENT,
+            "RPC-Client",
+            [&](std::shared_ptr<JobQueue::CoroTask> coro)
+                -> JobQueue::CoroTask::Body {
                 context.params = rpf(Account("alice"), Account("bob"), 0);
                 context.coro = coro;
-                RPC::doCommand(context, result);
+                co_await RPC::doCommand(context, result);
                 g.signal();
             });
         BEAST_EXPECT(g.wait_for(5s));
@@ -396,11 +408,14 @@ public:
 
         // Test more than RPC::Tuning::max_auto_src_cur source currencies.
         env.trust(Account("alice")["AUD"](100), "bob");
-        app.getJobQueue().postCoro(
-            jtCLIENT, "RPC-Client", [&](auto const& coro) {
+        app.getJobQueue().postCoroTask(
+            jtCLIENT,
+            "RPC-Client",
+            [&](std::shared_ptr<JobQueue::CoroTask> coro)
+                -> JobQueue::CoroTask::Body {
                 context.params = rpf(Account("alice"), Account("bob"), 0);
                 context.coro = coro;
-                RPC::doCommand(context, result);
+                co_await RPC::doCommand(context, result);
                 g.signal();
             });
         BEAST_EXPECT(g.wait_for(5s));
@@ -17,15 +17,24 @@
 */
 //==============================================================================
 #include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/ModuleCompiler.h>
+#include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/tx/impl/ApplyContext.h>
 #include <ripple/app/tx/impl/SetHook.h>
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/json_writer.h>
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/protocol/jss.h>
 #include <test/app/SetHook_wasm.h>
 #include <test/jtx.h>
+#include <test/jtx/CaptureLogs.h>
 #include <test/jtx/hook.h>
+#include <regex>
 #include <unordered_map>
 
 namespace ripple {
@@ -2327,416 +2336,96 @@ public:
         env.fund(XRP(10000), alice);
         env.fund(XRP(10000), bob);
 
-        TestHook hook = wasm[R"[test.hook](
-        #include <stdint.h>
-        extern int32_t _g(uint32_t, uint32_t);
-        extern int64_t accept (uint32_t read_ptr, uint32_t read_len, int64_t error_code);
-        extern int64_t rollback (uint32_t read_ptr, uint32_t read_len, int64_t error_code);
-        extern int64_t emit (uint32_t, uint32_t, uint32_t, uint32_t);
-        extern int64_t etxn_reserve(uint32_t);
-        extern int64_t otxn_param(uint32_t, uint32_t, uint32_t, uint32_t);
-        extern int64_t hook_account(uint32_t, uint32_t);
-        extern int64_t otxn_field (
-            uint32_t write_ptr,
-            uint32_t write_len,
-            uint32_t field_id
-        );
-        #define GUARD(maxiter) _g((1ULL << 31U) + __LINE__, (maxiter)+1)
-        #define OUT_OF_BOUNDS (-1)
-        #define ttPAYMENT 0
-        #define tfCANONICAL 0x80000000UL
-        #define amAMOUNT 1U
-        #define amFEE 8U
-        #define atACCOUNT 1U
-        #define DOESNT_EXIST (-5)
-        #define atDESTINATION 3U
-        #define SBUF(x) (uint32_t)x,sizeof(x)
+        env(ripple::test::jtx::hook(
+                alice, {{hso(emit_wasm, overrideFlag)}}, 0),
+            M("set emit"),
+            HSFEE);
+        env.close();
 
-        #define PREREQUISITE_NOT_MET -9
-        #define ENCODE_DROPS_SIZE 9
-        #define ENCODE_DROPS(buf_out, drops, amount_type ) \
-            {\
-                uint8_t uat = amount_type; \
-                uint64_t udrops = drops; \
-                buf_out[0] = 0x60U +(uat & 0x0FU ); \
-                buf_out[1] = 0b01000000 + (( udrops >> 56 ) & 0b00111111 ); \
-                buf_out[2] = (udrops >> 48) & 0xFFU; \
-                buf_out[3] = (udrops >> 40) & 0xFFU; \
-                buf_out[4] = (udrops >> 32) & 0xFFU; \
-                buf_out[5] = (udrops >> 24) & 0xFFU; \
-                buf_out[6] = (udrops >> 16) & 0xFFU; \
-                buf_out[7] = (udrops >>  8) & 0xFFU; \
-                buf_out[8] = (udrops >>  0) & 0xFFU; \
-                buf_out += ENCODE_DROPS_SIZE; \
-            }
+        Json::Value invoke;
+        invoke[jss::TransactionType] = "Invoke";
+        invoke[jss::Account] = alice.human();
 
-        #define _06_XX_ENCODE_DROPS(buf_out, drops, amount_type )\
-            ENCODE_DROPS(buf_out, drops, amount_type );
+        Json::Value params{Json::arrayValue};
+        params[0U][jss::HookParameter][jss::HookParameterName] =
+            strHex(std::string("bob"));
+        params[0U][jss::HookParameter][jss::HookParameterValue] =
+            strHex(bob.id());
 
-        #define ENCODE_DROPS_AMOUNT(buf_out, drops )\
-            ENCODE_DROPS(buf_out, drops, amAMOUNT );
-        #define _06_01_ENCODE_DROPS_AMOUNT(buf_out, drops )\
-            ENCODE_DROPS_AMOUNT(buf_out, drops );
+        invoke[jss::HookParameters] = params;
 
-        #define ENCODE_DROPS_FEE(buf_out, drops )\
-            ENCODE_DROPS(buf_out, drops, amFEE );
-        #define _06_08_ENCODE_DROPS_FEE(buf_out, drops )\
-            ENCODE_DROPS_FEE(buf_out, drops );
+        env(invoke, M("test emit"), fee(XRP(1)));
 
-        #define ENCODE_TT_SIZE 3
-        #define ENCODE_TT(buf_out, tt )\
-            {\
-                uint8_t utt = tt;\
-                buf_out[0] = 0x12U;\
-                buf_out[1] =(utt >> 8 ) & 0xFFU;\
-                buf_out[2] =(utt >> 0 ) & 0xFFU;\
-                buf_out += ENCODE_TT_SIZE; \
-            }
-        #define _01_02_ENCODE_TT(buf_out, tt)\
-            ENCODE_TT(buf_out, tt);
+        bool const fixV2 = env.current()->rules().enabled(fixXahauV2);
 
+        std::optional<uint256> emithash;
+        {
+            auto meta = env.meta();  // meta can close
 
-        #define ENCODE_ACCOUNT_SIZE 22
-        #define ENCODE_ACCOUNT(buf_out, account_id, account_type)\
-            {\
-                uint8_t uat = account_type;\
-                buf_out[0] = 0x80U + uat;\
-                buf_out[1] = 0x14U;\
-                *(uint64_t*)(buf_out +  2) = *(uint64_t*)(account_id +  0);\
-                *(uint64_t*)(buf_out + 10) = *(uint64_t*)(account_id +  8);\
-                *(uint32_t*)(buf_out + 18) = *(uint32_t*)(account_id + 16);\
-                buf_out += ENCODE_ACCOUNT_SIZE;\
-            }
-        #define _08_XX_ENCODE_ACCOUNT(buf_out, account_id, account_type)\
-            ENCODE_ACCOUNT(buf_out, account_id, account_type);
+            // ensure hook execution occured
+            BEAST_REQUIRE(meta);
+            BEAST_REQUIRE(meta->isFieldPresent(sfHookExecutions));
 
-        #define ENCODE_ACCOUNT_SRC_SIZE 22
-        #define ENCODE_ACCOUNT_SRC(buf_out, account_id)\
-            ENCODE_ACCOUNT(buf_out, account_id, atACCOUNT);
-        #define _08_01_ENCODE_ACCOUNT_SRC(buf_out, account_id)\
-            ENCODE_ACCOUNT_SRC(buf_out, account_id);
+            auto const hookEmissions = meta->getFieldArray(sfHookEmissions);
+            BEAST_EXPECT(
+                hookEmissions[0u].isFieldPresent(sfEmitNonce) == fixV2 ? true
+                                                                       : false);
+            BEAST_EXPECT(
+                hookEmissions[0u].getAccountID(sfHookAccount) == alice.id());
 
-        #define ENCODE_ACCOUNT_DST_SIZE 22
-        #define ENCODE_ACCOUNT_DST(buf_out, account_id)\
-            ENCODE_ACCOUNT(buf_out, account_id, atDESTINATION);
-        #define _08_03_ENCODE_ACCOUNT_DST(buf_out, account_id)\
-            ENCODE_ACCOUNT_DST(buf_out, account_id);
+            auto const hookExecutions = meta->getFieldArray(sfHookExecutions);
+            BEAST_REQUIRE(hookExecutions.size() == 1);
 
-        #define ENCODE_ACCOUNT_OWNER_SIZE 22
-        #define ENCODE_ACCOUNT_OWNER(buf_out, account_id) \
-            ENCODE_ACCOUNT(buf_out, account_id, atOWNER);
-        #define _08_02_ENCODE_ACCOUNT_OWNER(buf_out, account_id) \
-            ENCODE_ACCOUNT_OWNER(buf_out, account_id);
+            // ensure there was one emitted txn
+            BEAST_EXPECT(hookExecutions[0].getFieldU16(sfHookEmitCount) == 1);
 
-        #define ENCODE_UINT32_COMMON_SIZE 5U
-        #define ENCODE_UINT32_COMMON(buf_out, i, field)\
-            {\
-                uint32_t ui = i; \
-                uint8_t uf = field; \
-                buf_out[0] = 0x20U +(uf & 0x0FU); \
-                buf_out[1] =(ui >> 24 ) & 0xFFU; \
-                buf_out[2] =(ui >> 16 ) & 0xFFU; \
-                buf_out[3] =(ui >>  8 ) & 0xFFU; \
-                buf_out[4] =(ui >>  0 ) & 0xFFU; \
-                buf_out += ENCODE_UINT32_COMMON_SIZE; \
-            }
-        #define _02_XX_ENCODE_UINT32_COMMON(buf_out, i, field)\
-            ENCODE_UINT32_COMMON(buf_out, i, field)\
+            BEAST_REQUIRE(meta->isFieldPresent(sfAffectedNodes));
 
-        #define ENCODE_UINT32_UNCOMMON_SIZE 6U
-        #define ENCODE_UINT32_UNCOMMON(buf_out, i, field)\
-            {\
-                uint32_t ui = i; \
-                uint8_t uf = field; \
-                buf_out[0] = 0x20U; \
-                buf_out[1] = uf; \
-                buf_out[2] =(ui >> 24 ) & 0xFFU; \
-                buf_out[3] =(ui >> 16 ) & 0xFFU; \
-                buf_out[4] =(ui >>  8 ) & 0xFFU; \
-                buf_out[5] =(ui >>  0 ) & 0xFFU; \
-                buf_out += ENCODE_UINT32_UNCOMMON_SIZE; \
-            }
-        #define _02_XX_ENCODE_UINT32_UNCOMMON(buf_out, i, field)\
-            ENCODE_UINT32_UNCOMMON(buf_out, i, field)\
+            BEAST_REQUIRE(meta->getFieldArray(sfAffectedNodes).size() == 3);
 
-        #define ENCODE_LLS_SIZE 6U
-        #define ENCODE_LLS(buf_out, lls )\
-            ENCODE_UINT32_UNCOMMON(buf_out, lls, 0x1B );
-        #define _02_27_ENCODE_LLS(buf_out, lls )\
-            ENCODE_LLS(buf_out, lls );
+            for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+            {
+                SField const& metaType = node.getFName();
+                uint16_t nodeType = node.getFieldU16(sfLedgerEntryType);
+                if (metaType == sfCreatedNode && nodeType == ltEMITTED_TXN)
+                {
+                    BEAST_REQUIRE(node.isFieldPresent(sfNewFields));
 
-        #define ENCODE_FLS_SIZE 6U
-        #define ENCODE_FLS(buf_out, fls )\
-            ENCODE_UINT32_UNCOMMON(buf_out, fls, 0x1A );
-        #define _02_26_ENCODE_FLS(buf_out, fls )\
-            ENCODE_FLS(buf_out, fls );
+                    auto const& nf = const_cast<ripple::STObject&>(node)
+                                         .getField(sfNewFields)
+                                         .downcast<STObject>();
 
-        #define ENCODE_TAG_SRC_SIZE 5
-        #define ENCODE_TAG_SRC(buf_out, tag )\
-            ENCODE_UINT32_COMMON(buf_out, tag, 0x3U );
-        #define _02_03_ENCODE_TAG_SRC(buf_out, tag )\
-            ENCODE_TAG_SRC(buf_out, tag );
+                    auto const& et = const_cast<ripple::STObject&>(nf)
+                                         .getField(sfEmittedTxn)
+                                         .downcast<STObject>();
 
-        #define ENCODE_TAG_DST_SIZE 5
-        #define ENCODE_TAG_DST(buf_out, tag )\
-            ENCODE_UINT32_COMMON(buf_out, tag, 0xEU );
-        #define _02_14_ENCODE_TAG_DST(buf_out, tag )\
-            ENCODE_TAG_DST(buf_out, tag );
+                    auto const& em = const_cast<ripple::STObject&>(et)
+                                         .getField(sfEmitDetails)
+                                         .downcast<STObject>();
 
-        #define ENCODE_SEQUENCE_SIZE 5
-        #define ENCODE_SEQUENCE(buf_out, sequence )\
-            ENCODE_UINT32_COMMON(buf_out, sequence, 0x4U );
-        #define _02_04_ENCODE_SEQUENCE(buf_out, sequence )\
-            ENCODE_SEQUENCE(buf_out, sequence );
+                    BEAST_EXPECT(em.getFieldU32(sfEmitGeneration) == 1);
+                    BEAST_EXPECT(em.getFieldU64(sfEmitBurden) == 1);
 
-        #define ENCODE_FLAGS_SIZE 5
-        #define ENCODE_FLAGS(buf_out, tag )\
-            ENCODE_UINT32_COMMON(buf_out, tag, 0x2U );
-        #define _02_02_ENCODE_FLAGS(buf_out, tag )\
-            ENCODE_FLAGS(buf_out, tag );
+                    Blob txBlob = et.getSerializer().getData();
+                    auto const tx = std::make_unique<STTx>(
+                        Slice{txBlob.data(), txBlob.size()});
+                    emithash = tx->getTransactionID();
 
-        #define ENCODE_SIGNING_PUBKEY_SIZE 35
-        #define ENCODE_SIGNING_PUBKEY(buf_out, pkey )\
-            {\
-                buf_out[0] = 0x73U;\
-                buf_out[1] = 0x21U;\
-                *(uint64_t*)(buf_out +  2) = *(uint64_t*)(pkey +  0);\
-                *(uint64_t*)(buf_out + 10) = *(uint64_t*)(pkey +  8);\
-                *(uint64_t*)(buf_out + 18) = *(uint64_t*)(pkey + 16);\
-                *(uint64_t*)(buf_out + 26) = *(uint64_t*)(pkey + 24);\
-                buf[34] = pkey[32];\
-                buf_out += ENCODE_SIGNING_PUBKEY_SIZE;\
+                    break;
+                }
             }
 
-        #define _07_03_ENCODE_SIGNING_PUBKEY(buf_out, pkey )\
-            ENCODE_SIGNING_PUBKEY(buf_out, pkey );
+            BEAST_REQUIRE(emithash);
+            BEAST_EXPECT(
+                emithash == hookEmissions[0u].getFieldH256(sfEmittedTxnID));
+        }
 
-        #define ENCODE_SIGNING_PUBKEY_NULL_SIZE 35
-        #define ENCODE_SIGNING_PUBKEY_NULL(buf_out )\
-            {\
-                buf_out[0] = 0x73U;\
-                buf_out[1] = 0x21U;\
-                *(uint64_t*)(buf_out+2) = 0;\
-                *(uint64_t*)(buf_out+10) = 0;\
-                *(uint64_t*)(buf_out+18) = 0;\
-                *(uint64_t*)(buf_out+25) = 0;\
-                buf_out += ENCODE_SIGNING_PUBKEY_NULL_SIZE;\
-            }
+        {
+            auto balbefore = env.balance(bob).value().xrp().drops();
 
-        #define _07_03_ENCODE_SIGNING_PUBKEY_NULL(buf_out )\
-            ENCODE_SIGNING_PUBKEY_NULL(buf_out );
+            env.close();
 
-        extern int64_t etxn_fee_base (
-            uint32_t read_ptr,
-          	uint32_t read_len
-        );
-        extern int64_t etxn_details (
-            uint32_t write_ptr,
-          	uint32_t write_len
-        );
-        extern int64_t ledger_seq (void);
-
-        #define PREPARE_PAYMENT_SIMPLE_SIZE 270U
-        #define PREPARE_PAYMENT_SIMPLE(buf_out_master, drops_amount_raw, to_address, dest_tag_raw, src_tag_raw)\
-            {\
-                uint8_t* buf_out = buf_out_master;\
-                uint8_t acc[20];\
-                uint64_t drops_amount = (drops_amount_raw);\
-                uint32_t dest_tag = (dest_tag_raw);\
-                uint32_t src_tag = (src_tag_raw);\
-                uint32_t cls = (uint32_t)ledger_seq();\
-                hook_account(SBUF(acc));\
-                _01_02_ENCODE_TT                   (buf_out, ttPAYMENT                      );      /* uint16  | size   3 */ \
-                _02_02_ENCODE_FLAGS                (buf_out, tfCANONICAL                    );      /* uint32  | size   5 */ \
-                _02_03_ENCODE_TAG_SRC              (buf_out, src_tag                        );      /* uint32  | size   5 */ \
-                _02_04_ENCODE_SEQUENCE             (buf_out, 0                              );      /* uint32  | size   5 */ \
-                _02_14_ENCODE_TAG_DST              (buf_out, dest_tag                       );      /* uint32  | size   5 */ \
-                _02_26_ENCODE_FLS                  (buf_out, cls + 1                        );      /* uint32  | size   6 */ \
-                _02_27_ENCODE_LLS                  (buf_out, cls + 5                        );      /* uint32  | size   6 */ \
-                _06_01_ENCODE_DROPS_AMOUNT         (buf_out, drops_amount                   );      /* amount  | size   9 */ \
-                uint8_t* fee_ptr = buf_out;\
-                _06_08_ENCODE_DROPS_FEE            (buf_out, 0                              );      /* amount  | size   9 */ \
-                _07_03_ENCODE_SIGNING_PUBKEY_NULL  (buf_out                                 );      /* pk      | size  35 */ \
-                _08_01_ENCODE_ACCOUNT_SRC          (buf_out, acc                            );      /* account | size  22 */ \
-                _08_03_ENCODE_ACCOUNT_DST          (buf_out, to_address                     );      /* account | size  22 */ \
-                int64_t edlen = etxn_details((uint32_t)buf_out, PREPARE_PAYMENT_SIMPLE_SIZE);       /* emitdet | size 1?? */ \
-                int64_t fee = etxn_fee_base(buf_out_master, PREPARE_PAYMENT_SIMPLE_SIZE);                                    \
-                _06_08_ENCODE_DROPS_FEE            (fee_ptr, fee                            );                               \
-            }
-
-        #define UINT16_FROM_BUF(buf)\
-            (((uint64_t)((buf)[0]) <<  8U) +\
-             ((uint64_t)((buf)[1]) <<  0U))
-
-        #define BUFFER_EQUAL_32(buf1, buf2)\
-            (\
-                *(((uint64_t*)(buf1)) + 0) == *(((uint64_t*)(buf2)) + 0) &&\
-                *(((uint64_t*)(buf1)) + 1) == *(((uint64_t*)(buf2)) + 1) &&\
-                *(((uint64_t*)(buf1)) + 2) == *(((uint64_t*)(buf2)) + 2) &&\
-                *(((uint64_t*)(buf1)) + 3) == *(((uint64_t*)(buf2)) + 3) &&\
-                *(((uint64_t*)(buf1)) + 4) == *(((uint64_t*)(buf2)) + 4) &&\
-                *(((uint64_t*)(buf1)) + 5) == *(((uint64_t*)(buf2)) + 5) &&\
-                *(((uint64_t*)(buf1)) + 6) == *(((uint64_t*)(buf2)) + 6) &&\
-                *(((uint64_t*)(buf1)) + 7) == *(((uint64_t*)(buf2)) + 7))
-
-        #define ASSERT(x)\
-             if (!(x))\
-                rollback((uint32_t)#x,sizeof(#x),__LINE__)
-
-        #define sfDestination ((8U << 16U) + 3U)
-
-        extern int64_t etxn_generation(void);
-        extern int64_t otxn_generation(void);
-        extern int64_t otxn_burden(void);
-        extern int64_t etxn_burden(void);
-
-        int64_t cbak(uint32_t r)
-        {
-            // on callback we emit 2 more txns
-            uint8_t bob[20];
-            ASSERT(otxn_field(SBUF(bob), sfDestination) == 20);
-
-            ASSERT(otxn_generation() + 1 == etxn_generation());
-
-            ASSERT(etxn_burden() == PREREQUISITE_NOT_MET);
-
-            ASSERT(etxn_reserve(2) == 2);
-            
-            ASSERT(otxn_burden() > 0);
-            ASSERT(etxn_burden() == otxn_burden() * 2);
-
-            uint8_t tx[PREPARE_PAYMENT_SIMPLE_SIZE];
-            PREPARE_PAYMENT_SIMPLE(tx, 1000, bob, 0, 0);
-
-            uint8_t hash1[32];
-            ASSERT(emit(SBUF(hash1), SBUF(tx)) == 32);
-
-            ASSERT(etxn_details(tx + 132, 138) == 138);
-            uint8_t hash2[32];
-            ASSERT(emit(SBUF(hash2), SBUF(tx)) == 32);
-
-            ASSERT(!BUFFER_EQUAL_32(hash1, hash2)); 
-
-            return accept(0,0,0);
-        }
-
-        int64_t hook(uint32_t r)
-        {
-            _g(1,1);
-
-            etxn_reserve(1);
-            
-            // bounds checks
-            ASSERT(emit(1000000, 32, 0, 32) == OUT_OF_BOUNDS);
-            ASSERT(emit(0,1000000, 0, 32) == OUT_OF_BOUNDS);
-            ASSERT(emit(0,32, 1000000, 32) == OUT_OF_BOUNDS);
-            ASSERT(emit(0,32, 0, 1000000) == OUT_OF_BOUNDS);
-
-            ASSERT(otxn_generation() == 0);
-            ASSERT(otxn_burden == 1);
-
-            uint8_t bob[20];
-            ASSERT(otxn_param(SBUF(bob), "bob", 3) == 20);
-
-            uint8_t tx[PREPARE_PAYMENT_SIMPLE_SIZE];
-            PREPARE_PAYMENT_SIMPLE(tx, 1000, bob, 0, 0);
-
-            uint8_t hash[32];
-            ASSERT(emit(SBUF(hash), SBUF(tx)) == 32);
-
-            return accept(0,0,0);
-        }
-        )[test.hook]"];
-
-        env(ripple::test::jtx::hook(alice, {{hso(hook, overrideFlag)}}, 0),
-            M("set emit"),
-            HSFEE);
-        env.close();
-
-        Json::Value invoke;
-        invoke[jss::TransactionType] = "Invoke";
-        invoke[jss::Account] = alice.human();
-
-        Json::Value params{Json::arrayValue};
-        params[0U][jss::HookParameter][jss::HookParameterName] =
-            strHex(std::string("bob"));
-        params[0U][jss::HookParameter][jss::HookParameterValue] =
-            strHex(bob.id());
-
-        invoke[jss::HookParameters] = params;
-
-        env(invoke, M("test emit"), fee(XRP(1)));
-
-        bool const fixV2 = env.current()->rules().enabled(fixXahauV2);
-
-        std::optional<uint256> emithash;
-        {
-            auto meta = env.meta();  // meta can close
-
-            // ensure hook execution occured
-            BEAST_REQUIRE(meta);
-            BEAST_REQUIRE(meta->isFieldPresent(sfHookExecutions));
-
-            auto const hookEmissions = meta->getFieldArray(sfHookEmissions);
-            BEAST_EXPECT(
-                hookEmissions[0u].isFieldPresent(sfEmitNonce) == fixV2 ? true
-                                                                       : false);
-            BEAST_EXPECT(
-                hookEmissions[0u].getAccountID(sfHookAccount) == alice.id());
-
-            auto const hookExecutions = meta->getFieldArray(sfHookExecutions);
-            BEAST_REQUIRE(hookExecutions.size() == 1);
-
-            // ensure there was one emitted txn
-            BEAST_EXPECT(hookExecutions[0].getFieldU16(sfHookEmitCount) == 1);
-
-            BEAST_REQUIRE(meta->isFieldPresent(sfAffectedNodes));
-
-            BEAST_REQUIRE(meta->getFieldArray(sfAffectedNodes).size() == 3);
-
-            for (auto const& node : meta->getFieldArray(sfAffectedNodes))
-            {
-                SField const& metaType = node.getFName();
-                uint16_t nodeType = node.getFieldU16(sfLedgerEntryType);
-                if (metaType == sfCreatedNode && nodeType == ltEMITTED_TXN)
-                {
-                    BEAST_REQUIRE(node.isFieldPresent(sfNewFields));
-
-                    auto const& nf = const_cast<ripple::STObject&>(node)
-                                         .getField(sfNewFields)
-                                         .downcast<STObject>();
-
-                    auto const& et = const_cast<ripple::STObject&>(nf)
-                                         .getField(sfEmittedTxn)
-                                         .downcast<STObject>();
-
-                    auto const& em = const_cast<ripple::STObject&>(et)
-                                         .getField(sfEmitDetails)
-                                         .downcast<STObject>();
-
-                    BEAST_EXPECT(em.getFieldU32(sfEmitGeneration) == 1);
-                    BEAST_EXPECT(em.getFieldU64(sfEmitBurden) == 1);
-
-                    Blob txBlob = et.getSerializer().getData();
-                    auto const tx = std::make_unique<STTx>(
-                        Slice{txBlob.data(), txBlob.size()});
-                    emithash = tx->getTransactionID();
-
-                    break;
-                }
-            }
-
-            BEAST_REQUIRE(emithash);
-            BEAST_EXPECT(
-                emithash == hookEmissions[0u].getFieldH256(sfEmittedTxnID));
-        }
-
-        {
-            auto balbefore = env.balance(bob).value().xrp().drops();
-
-            env.close();
-
-            auto const ledger = env.closed();
+            auto const ledger = env.closed();
 
             int txcount = 0;
             for (auto& i : ledger->txs)
@@ -11952,71 +11641,489 @@ public:
         env(pay(bob, alice, XRP(1)), M("test util_verify"), fee(XRP(1)));
     }
 
+    // Every hook in this suite is executed once interpreted and once compiled
+    // to native code, against the same ledger and the same transaction. The
+    // two tiers must agree on everything recorded about an execution, most
+    // importantly the instruction count which determines the fee.
     void
-    testWithFeatures(FeatureBitset features)
+    testNativeDifferential(FeatureBitset features)
     {
-        testHooksOwnerDir(features);
-        testHooksDisabled(features);
-        testTxStructure(features);
-        testInferHookSetOperation();
-        testParams(features);
-        testGrants(features);
+        testcase("Test native tier matches interpreter");
 
-        testDelete(features);
-        testInstall(features);
-        testCreate(features);
-        testWithTickets(features);
+        using namespace jtx;
 
-        testUpdate(features);
+        Env env{*this, features};
 
-        testNSDelete(features);
-        testNSDeletePartial(features);
-        testPageCap(features);
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
 
-        testWasm(features);
-        test_accept(features);
-        test_rollback(features);
+        auto const jt = env.jt(pay(alice, bob, XRP(1)), fee(XRP(1)));
+        BEAST_REQUIRE(jt.stx);
+
+        std::map<std::vector<uint8_t>, std::vector<uint8_t>> const params;
+        std::map<
+            uint256,
+            std::map<std::vector<uint8_t>, std::vector<uint8_t>>> const
+            overrides;
+
+        auto execute = [&](Blob const& code,
+                           uint256 const& hash,
+                           hook::HookStateMap& stateMap) {
+            OpenView ov{*env.current()};
+            ApplyContext ac{
+                env.app(),
+                ov,
+                *jt.stx,
+                tesSUCCESS,
+                env.current()->fees().base,
+                tapNONE,
+                env.journal};
+            return hook::apply(
+                uint256{},
+                hash,
+                uint256{},
+                code,
+                params,
+                overrides,
+                stateMap,
+                ac,
+                bob.id(),
+                false,
+                false,
+                true,
+                0,
+                0,
+                nullptr);
+        };
 
-        testGuards(features);
+        auto emittedIDs = [](hook::HookResult const& result) {
+            std::vector<uint256> ids;
+            auto emitted = result.emittedTxn;
+            for (; !emitted.empty(); emitted.pop())
+                ids.push_back(emitted.front()->getID());
+            return ids;
+        };
 
-        test_emit(features);  //
-        // test_etxn_burden(features);       // tested above
-        // test_etxn_generation(features);   // tested above
-        // test_otxn_burden(features);       // tested above
-        // test_otxn_generation(features);   // tested above
-        test_etxn_details(features);   //
-        test_etxn_fee_base(features);  //
-        test_etxn_nonce(features);     //
-        test_etxn_reserve(features);   //
-        test_fee_base(features);       //
+        beast::temp_dir dir;
+        auto& cache = hook::ModuleCache::instance();
 
-        test_otxn_field(features);  //
+        for (auto const& [source, code] : wasm)
+        {
+            if (hook::HookExecutor::validateWasm(code.data(), code.size()))
+                continue;
 
-        test_ledger_keylet(features);  //
+            uint256 const hash = sha512Half_s(Slice(code.data(), code.size()));
+            cache.clear();
 
-        test_float_compare(features);   //
-        test_float_divide(features);    //
-        test_float_int(features);       //
-        test_float_invert(features);    //
-        test_float_log(features);       //
-        test_float_mantissa(features);  //
-        test_float_mulratio(features);  //
-        test_float_multiply(features);  //
-        test_float_negate(features);    //
-        test_float_one(features);       //
-        test_float_root(features);      //
-        test_float_set(features);       //
-        test_float_sign(features);      //
-        test_float_sto(features);       //
-        test_float_sto_set(features);   //
-        test_float_sum(features);       //
+            hook::HookStateMap interpretedState;
+            auto const interpreted = execute(code, hash, interpretedState);
+            BEAST_EXPECT(!cache.isNative(hash));
 
-        test_hook_account(features);    //
-        test_hook_again(features);      //
-        test_hook_hash(features);       //
-        test_hook_param(features);      //
-        test_hook_param_set(features);  //
-        test_hook_pos(features);        //
+            auto const path = hook::nativeModulePath(dir.path(), hash);
+            auto const err =
+                hook::compileNative(code.data(), code.size(), path);
+            if (!BEAST_EXPECTS(!err, err.value_or("")))
+                continue;
+
+            // an artifact is only loaded for the bytecode it was built from
+            BEAST_EXPECT(!hook::loadNative(path, uint256{}));
+
+            auto native = hook::loadNative(path, hash);
+            if (!BEAST_EXPECT(native))
+                continue;
+            BEAST_EXPECT(cache.installNative(hash, std::move(*native)));
+
+            hook::HookStateMap compiledState;
+            auto const compiled = execute(code, hash, compiledState);
+            BEAST_EXPECT(cache.isNative(hash));
+
+            BEAST_EXPECT(interpreted.exitType == compiled.exitType);
+            BEAST_EXPECT(interpreted.exitCode == compiled.exitCode);
+            BEAST_EXPECT(interpreted.exitReason == compiled.exitReason);
+            BEAST_EXPECTS(
+                interpreted.instructionCount == compiled.instructionCount,
+                to_string(hash) + ": " +
+                    std::to_string(interpreted.instructionCount) +
+                    " != " + std::to_string(compiled.instructionCount));
+            BEAST_EXPECT(
+                interpreted.changedStateCount == compiled.changedStateCount);
+            BEAST_EXPECT(interpretedState == compiledState);
+            BEAST_EXPECT(emittedIDs(interpreted) == emittedIDs(compiled));
+        }
+
+        cache.clear();
+    }
+
+    // Ledgers built by a node running hot hooks natively and by one that
+    // only interprets them must be identical. The hooks loop under guards,
+    // emit transactions whose callbacks emit more, and write state, so any
+    // difference in instruction counts, and so in fees, or in emissions and
+    // state changes shows up in the ledger hashes.
+    void
+    testNativeLedgerDifferential(FeatureBitset features)
+    {
+        testcase("Test native tier matches interpreter in ledgers");
+
+        using namespace jtx;
+
+        // hooks of other tests in this suite, found by their source
+        auto find = [this](
+                        std::string_view needle, std::string_view unless = {}) {
+            for (auto const& [source, code] : wasm)
+            {
+                if (source.find(needle) != std::string::npos &&
+                    (unless.empty() ||
+                     source.find(unless) == std::string::npos))
+                    return code;
+            }
+            fail("no hook found");
+            return std::vector<uint8_t>{};
+        };
+
+        auto const loops = find("_g(4, 120);", "guard missing");
+        auto const nonces = find("TOO_MANY_NONCES -12");
+        auto const emits = find("on callback we emit 2 more txns");
+        std::vector<uint8_t> const states = makestate_wasm;
+
+        auto hashOf = [](std::vector<uint8_t> const& code) {
+            return sha512Half_s(Slice(code.data(), code.size()));
+        };
+
+        auto& cache = hook::ModuleCache::instance();
+
+        // returns the hashes of the last ledger and the instruction count of
+        // every hook execution
+        auto build = [&](bool native) {
+            beast::temp_dir dir;
+            Env env{
+                *this,
+                envconfig([&](std::unique_ptr<Config> cfg) {
+                    cfg->HOOK_AOT_THRESHOLD = native ? 1 : 0;
+                    cfg->legacy("database_path", dir.path());
+                    return cfg;
+                }),
+                features};
+
+            cache.clear();
+
+            auto const alice = Account{"alice"};
+            auto const bob = Account{"bob"};
+            auto const carol = Account{"carol"};
+            auto const dave = Account{"dave"};
+            env.fund(XRP(10000), alice, bob, carol, dave);
+            env.close();
+
+            env(ripple::test::jtx::hook(
+                    alice, {{hso(loops, overrideFlag)}}, 0),
+                HSFEE);
+            env(ripple::test::jtx::hook(
+                    bob, {{hso(emits, overrideFlag)}}, 0),
+                HSFEE);
+            env(ripple::test::jtx::hook(
+                    carol,
+                    {{hso(nonces, overrideFlag), hso(states, overrideFlag)}},
+                    0),
+                HSFEE);
+            env.close();
+
+            Json::Value invoke;
+            invoke[jss::TransactionType] = "Invoke";
+            invoke[jss::Account] = bob.human();
+            invoke[jss::HookParameters][0U][jss::HookParameter]
+                  [jss::HookParameterName] = strHex(std::string("bob"));
+            invoke[jss::HookParameters][0U][jss::HookParameter]
+                  [jss::HookParameterValue] = strHex(dave.id());
+
+            std::vector<std::uint64_t> counts;
+            auto trigger = [&]() {
+                env(pay(dave, alice, XRP(1)), fee(XRP(1)));
+                env(pay(dave, carol, XRP(1)), fee(XRP(1)));
+                env(invoke, fee(XRP(1)));
+                env.close();
+
+                for (auto const& [tx, meta] : env.closed()->txs)
+                {
+                    if (!meta || !meta->isFieldPresent(sfHookExecutions))
+                        continue;
+                    for (auto const& e : meta->getFieldArray(sfHookExecutions))
+                        counts.push_back(e.getFieldU64(sfHookInstructionCount));
+                }
+            };
+
+            // hooks become hot on their first execution
+            trigger();
+            env.app().getJobQueue().rendezvous();
+
+            for (auto const& code : {loops, nonces, emits, states})
+            {
+                auto const hash = hashOf(code);
+                BEAST_EXPECT(cache.isNative(hash) == native);
+                if (!native)
+                    continue;
+
+                auto const path = hook::nativeModulePath(
+                    boost::filesystem::path(dir.path()) / "hooks_native", hash);
+                BEAST_EXPECT(
+                    boost::filesystem::exists(hook::nativeHeaderPath(path)));
+                BEAST_EXPECT(hook::loadNative(path, hash));
+            }
+
+            for (int i = 0; i < 3; ++i)
+                trigger();
+
+            if (native)
+            {
+                // a damaged header makes the artifact unusable
+                auto const path = hook::nativeModulePath(
+                    boost::filesystem::path(dir.path()) / "hooks_native",
+                    hashOf(loops));
+                boost::system::error_code ec;
+                writeFileContents(ec, hook::nativeHeaderPath(path), "x");
+                BEAST_EXPECT(!ec && !hook::loadNative(path, hashOf(loops)));
+            }
+
+            cache.clear();
+
+            auto const& info = env.closed()->info();
+            return std::make_tuple(info.accountHash, info.txHash, counts);
+        };
+
+        auto const interpreted = build(false);
+        auto const compiled = build(true);
+        BEAST_EXPECT(!std::get<2>(interpreted).empty());
+        BEAST_EXPECT(std::get<2>(interpreted) == std::get<2>(compiled));
+        BEAST_EXPECT(std::get<0>(interpreted) == std::get<0>(compiled));
+        BEAST_EXPECT(std::get<1>(interpreted) == std::get<1>(compiled));
+    }
+
+    // A ledger built while transactions, and their hooks, are speculatively
+    // executed on worker threads must be identical to one built serially.
+    void
+    testSpeculativeApply(FeatureBitset features)
+    {
+        testcase("Test speculative apply matches serial apply");
+
+        using namespace jtx;
+
+        // returns the ledger's hashes and how many speculative results the
+        // ledger builder reported committing
+        auto build = [&](std::size_t threads) {
+            std::string messages;
+            std::pair<uint256, uint256> hashes;
+            {
+                Env env{
+                    *this,
+                    envconfig([threads](std::unique_ptr<Config> cfg) {
+                        cfg->HOOK_SPECULATIVE_THREADS = threads;
+                        return cfg;
+                    }),
+                    features,
+                    std::make_unique<CaptureLogs>(&messages),
+                    beast::severities::kDebug};
+
+                std::vector<Account> hooks;
+                for (int i = 0; i < 4; ++i)
+                    hooks.emplace_back("hook" + std::to_string(i));
+
+                std::vector<Account> senders;
+                for (int i = 0; i < 12; ++i)
+                    senders.emplace_back("sender" + std::to_string(i));
+
+                for (auto const& a : hooks)
+                    env.fund(XRP(10000), a);
+                for (auto const& a : senders)
+                    env.fund(XRP(10000), a);
+                env.close();
+
+                for (auto const& a : hooks)
+                    env(ripple::test::jtx::hook(
+                            a, {{hso(makestate_wasm)}}, 0),
+                        HSFEE);
+                env.close();
+
+                // payments into each hook account run its hook, several
+                // senders share a hook account and every sender also pays its
+                // neighbour, so some speculative results conflict and some
+                // do not
+                for (std::size_t i = 0; i < senders.size(); ++i)
+                {
+                    env(pay(senders[i], hooks[i % hooks.size()], XRP(1)),
+                        fee(XRP(1)));
+                    env(pay(
+                        senders[i],
+                        senders[(i + 1) % senders.size()],
+                        XRP(1)));
+                }
+                env.close();
+
+                for (auto const& a : hooks)
+                    BEAST_EXPECT((*env.le(a))[sfHookStateCount] == 1);
+
+                auto const& info = env.closed()->info();
+                hashes = std::make_pair(info.accountHash, info.txHash);
+            }
+
+            std::size_t committed = 0;
+            std::regex const re("committed ([0-9]+) speculative results");
+            for (std::sregex_iterator it(messages.begin(), messages.end(), re);
+                 it != std::sregex_iterator();
+                 ++it)
+                committed += std::stoul((*it)[1]);
+            return std::make_pair(hashes, committed);
+        };
+
+        auto const serial = build(0);
+        auto const speculative = build(4);
+        BEAST_EXPECT(serial.first == speculative.first);
+        BEAST_EXPECT(serial.second == 0);
+        BEAST_EXPECT(speculative.second > 0);
+    }
+
+    // A speculative execution that is thrown away must not mark the
+    // transactions its hooks emitted as emitted in the HashRouter, which
+    // would let them skip the signature check.
+    void
+    testSpeculativeEmissions(FeatureBitset features)
+    {
+        testcase("Test discarded speculation does not mark emissions");
+
+        using namespace jtx;
+
+        // dave pays alice, whose hook emits, using a ticket. When drain is
+        // set dave first spends most of his balance using his sequence,
+        // which orders it before the ticket, so the payment to alice only
+        // succeeds when speculated against the start of the pass. Returns
+        // the transaction alice's hook emitted, if any, and whether the
+        // HashRouter marks `probe`, or else that transaction, as emitted.
+        auto run = [&](bool drain, std::optional<uint256> const& probe) {
+            Env env{
+                *this,
+                envconfig([](std::unique_ptr<Config> cfg) {
+                    cfg->HOOK_SPECULATIVE_THREADS = 4;
+                    return cfg;
+                }),
+                features};
+
+            auto const alice = Account{"alice"};
+            auto const bob = Account{"bob"};
+            auto const carol = Account{"carol"};
+            auto const dave = Account{"dave"};
+            env.fund(XRP(10000), alice, bob, carol, dave);
+            env.close();
+
+            env(ripple::test::jtx::hook(
+                    alice, {{hso(emit_wasm, overrideFlag)}}, 0),
+                HSFEE);
+            std::uint32_t const ticket = env.seq(dave) + 1;
+            env(ticket::create(dave, 1));
+            env.close();
+
+            Json::Value params{Json::arrayValue};
+            params[0U][jss::HookParameter][jss::HookParameterName] =
+                strHex(std::string("bob"));
+            params[0U][jss::HookParameter][jss::HookParameterValue] =
+                strHex(bob.id());
+
+            Json::Value payment = pay(dave, alice, XRP(5000));
+            payment[jss::HookParameters] = params;
+
+            if (drain)
+                env(pay(dave, carol, XRP(6000)));
+            env(payment,
+                ticket::use(ticket),
+                fee(XRP(1)),
+                ter(drain ? TER{tecUNFUNDED_PAYMENT} : TER{tesSUCCESS}));
+
+            std::optional<uint256> emitted;
+            auto const meta = env.meta();  // closes the ledger
+            if (BEAST_EXPECT(meta) && meta->isFieldPresent(sfHookEmissions))
+                emitted = meta->getFieldArray(sfHookEmissions)[0u]
+                              .getFieldH256(sfEmittedTxnID);
+
+            auto const id = probe ? probe : emitted;
+            bool const marked = id &&
+                (env.app().getHashRouter().getFlags(*id) & SF_EMITTED);
+            return std::make_pair(emitted, marked);
+        };
+
+        auto const kept = run(false, std::nullopt);
+        BEAST_REQUIRE(kept.first);
+        BEAST_EXPECT(kept.second);
+
+        // the same emission happens when the payment is speculated, but the
+        // speculation conflicts with the earlier payment and is discarded
+        auto const discarded = run(true, kept.first);
+        BEAST_EXPECT(!discarded.first);
+        BEAST_EXPECT(!discarded.second);
+    }
+
+    void
+    testWithFeatures(FeatureBitset features)
+    {
+        testHooksOwnerDir(features);
+        testHooksDisabled(features);
+        testTxStructure(features);
+        testInferHookSetOperation();
+        testParams(features);
+        testGrants(features);
+
+        testDelete(features);
+        testInstall(features);
+        testCreate(features);
+        testWithTickets(features);
+
+        testUpdate(features);
+
+        testNSDelete(features);
+        testNSDeletePartial(features);
+        testPageCap(features);
+
+        testWasm(features);
+        test_accept(features);
+        test_rollback(features);
+
+        testGuards(features);
+
+        test_emit(features);  //
+        // test_etxn_burden(features);       // tested above
+        // test_etxn_generation(features);   // tested above
+        // test_otxn_burden(features);       // tested above
+        // test_otxn_generation(features);   // tested above
+        test_etxn_details(features);   //
+        test_etxn_fee_base(features);  //
+        test_etxn_nonce(features);     //
+        test_etxn_reserve(features);   //
+        test_fee_base(features);       //
+
+        test_otxn_field(features);  //
+
+        test_ledger_keylet(features);  //
+
+        test_float_compare(features);   //
+        test_float_divide(features);    //
+        test_float_int(features);       //
+        test_float_invert(features);    //
+        test_float_log(features);       //
+        test_float_mantissa(features);  //
+        test_float_mulratio(features);  //
+        test_float_multiply(features);  //
+        test_float_negate(features);    //
+        test_float_one(features);       //
+        test_float_root(features);      //
+        test_float_set(features);       //
+        test_float_sign(features);      //
+        test_float_sto(features);       //
+        test_float_sto_set(features);   //
+        test_float_sum(features);       //
+
+        test_hook_account(features);    //
+        test_hook_again(features);      //
+        test_hook_hash(features);       //
+        test_hook_param(features);      //
+        test_hook_param_set(features);  //
+        test_hook_pos(features);        //
         test_hook_skip(features);       //
 
         test_ledger_last_hash(features);  //
@@ -12075,6 +12182,10 @@ public:
         testWithFeatures(sa - fixXahauV1 - fixXahauV2 - fixNSDelete);
         testWithFeatures(
             sa - fixXahauV1 - fixXahauV2 - fixNSDelete - fixPageCap);
+        testNativeDifferential(sa);
+        testNativeLedgerDifferential(sa);
+        testSpeculativeApply(sa);
+        testSpeculativeEmissions(sa);
     }
 
 private:
@@ -12213,6 +12324,331 @@ private:
         )[test.hook]"];
 
     HASH_WASM(accept2);
+
+    // emits a payment to the account in its "bob" parameter, its callback
+    // emits two more
+    TestHook emit_wasm =
+        wasm[
+            R"[test.hook](
+        #include <stdint.h>
+        extern int32_t _g(uint32_t, uint32_t);
+        extern int64_t accept (uint32_t read_ptr, uint32_t read_len, int64_t error_code);
+        extern int64_t rollback (uint32_t read_ptr, uint32_t read_len, int64_t error_code);
+        extern int64_t emit (uint32_t, uint32_t, uint32_t, uint32_t);
+        extern int64_t etxn_reserve(uint32_t);
+        extern int64_t otxn_param(uint32_t, uint32_t, uint32_t, uint32_t);
+        extern int64_t hook_account(uint32_t, uint32_t);
+        extern int64_t otxn_field (
+            uint32_t write_ptr,
+            uint32_t write_len,
+            uint32_t field_id
+        );
+        #define GUARD(maxiter) _g((1ULL << 31U) + __LINE__, (maxiter)+1)
+        #define OUT_OF_BOUNDS (-1)
+        #define ttPAYMENT 0
+        #define tfCANONICAL 0x80000000UL
+        #define amAMOUNT 1U
+        #define amFEE 8U
+        #define atACCOUNT 1U
+        #define DOESNT_EXIST (-5)
+        #define atDESTINATION 3U
+        #define SBUF(x) (uint32_t)x,sizeof(x)
+
+        #define PREREQUISITE_NOT_MET -9
+        #define ENCODE_DROPS_SIZE 9
+        #define ENCODE_DROPS(buf_out, drops, amount_type ) \
+            {\
+                uint8_t uat = amount_type; \
+                uint64_t udrops = drops; \
+                buf_out[0] = 0x60U +(uat & 0x0FU ); \
+                buf_out[1] = 0b01000000 + (( udrops >> 56 ) & 0b00111111 ); \
+                buf_out[2] = (udrops >> 48) & 0xFFU; \
+                buf_out[3] = (udrops >> 40) & 0xFFU; \
+                buf_out[4] = (udrops >> 32) & 0xFFU; \
+                buf_out[5] = (udrops >> 24) & 0xFFU; \
+                buf_out[6] = (udrops >> 16) & 0xFFU; \
+                buf_out[7] = (udrops >>  8) & 0xFFU; \
+                buf_out[8] = (udrops >>  0) & 0xFFU; \
+                buf_out += ENCODE_DROPS_SIZE; \
+            }
+
+        #define _06_XX_ENCODE_DROPS(buf_out, drops, amount_type )\
+            ENCODE_DROPS(buf_out, drops, amount_type );
+
+        #define ENCODE_DROPS_AMOUNT(buf_out, drops )\
+            ENCODE_DROPS(buf_out, drops, amAMOUNT );
+        #define _06_01_ENCODE_DROPS_AMOUNT(buf_out, drops )\
+            ENCODE_DROPS_AMOUNT(buf_out, drops );
+
+        #define ENCODE_DROPS_FEE(buf_out, drops )\
+            ENCODE_DROPS(buf_out, drops, amFEE );
+        #define _06_08_ENCODE_DROPS_FEE(buf_out, drops )\
+            ENCODE_DROPS_FEE(buf_out, drops );
+
+        #define ENCODE_TT_SIZE 3
+        #define ENCODE_TT(buf_out, tt )\
+            {\
+                uint8_t utt = tt;\
+                buf_out[0] = 0x12U;\
+                buf_out[1] =(utt >> 8 ) & 0xFFU;\
+                buf_out[2] =(utt >> 0 ) & 0xFFU;\
+                buf_out += ENCODE_TT_SIZE; \
+            }
+        #define _01_02_ENCODE_TT(buf_out, tt)\
+            ENCODE_TT(buf_out, tt);
+
+
+        #define ENCODE_ACCOUNT_SIZE 22
+        #define ENCODE_ACCOUNT(buf_out, account_id, account_type)\
+            {\
+                uint8_t uat = account_type;\
+                buf_out[0] = 0x80U + uat;\
+                buf_out[1] = 0x14U;\
+                *(uint64_t*)(buf_out +  2) = *(uint64_t*)(account_id +  0);\
+                *(uint64_t*)(buf_out + 10) = *(uint64_t*)(account_id +  8);\
+                *(uint32_t*)(buf_out + 18) = *(uint32_t*)(account_id + 16);\
+                buf_out += ENCODE_ACCOUNT_SIZE;\
+            }
+        #define _08_XX_ENCODE_ACCOUNT(buf_out, account_id, account_type)\
+            ENCODE_ACCOUNT(buf_out, account_id, account_type);
+
+        #define ENCODE_ACCOUNT_SRC_SIZE 22
+        #define ENCODE_ACCOUNT_SRC(buf_out, account_id)\
+            ENCODE_ACCOUNT(buf_out, account_id, atACCOUNT);
+        #define _08_01_ENCODE_ACCOUNT_SRC(buf_out, account_id)\
+            ENCODE_ACCOUNT_SRC(buf_out, account_id);
+
+        #define ENCODE_ACCOUNT_DST_SIZE 22
+        #define ENCODE_ACCOUNT_DST(buf_out, account_id)\
+            ENCODE_ACCOUNT(buf_out, account_id, atDESTINATION);
+        #define _08_03_ENCODE_ACCOUNT_DST(buf_out, account_id)\
+            ENCODE_ACCOUNT_DST(buf_out, account_id);
+
+        #define ENCODE_ACCOUNT_OWNER_SIZE 22
+        #define ENCODE_ACCOUNT_OWNER(buf_out, account_id) \
+            ENCODE_ACCOUNT(buf_out, account_id, atOWNER);
+        #define _08_02_ENCODE_ACCOUNT_OWNER(buf_out, account_id) \
+            ENCODE_ACCOUNT_OWNER(buf_out, account_id);
+
+        #define ENCODE_UINT32_COMMON_SIZE 5U
+        #define ENCODE_UINT32_COMMON(buf_out, i, field)\
+            {\
+                uint32_t ui = i; \
+                uint8_t uf = field; \
+                buf_out[0] = 0x20U +(uf & 0x0FU); \
+                buf_out[1] =(ui >> 24 ) & 0xFFU; \
+                buf_out[2] =(ui >> 16 ) & 0xFFU; \
+                buf_out[3] =(ui >>  8 ) & 0xFFU; \
+                buf_out[4] =(ui >>  0 ) & 0xFFU; \
+                buf_out += ENCODE_UINT32_COMMON_SIZE; \
+            }
+        #define _02_XX_ENCODE_UINT32_COMMON(buf_out, i, field)\
+            ENCODE_UINT32_COMMON(buf_out, i, field)\
+
+        #define ENCODE_UINT32_UNCOMMON_SIZE 6U
+        #define ENCODE_UINT32_UNCOMMON(buf_out, i, field)\
+            {\
+                uint32_t ui = i; \
+                uint8_t uf = field; \
+                buf_out[0] = 0x20U; \
+                buf_out[1] = uf; \
+                buf_out[2] =(ui >> 24 ) & 0xFFU; \
+                buf_out[3] =(ui >> 16 ) & 0xFFU; \
+                buf_out[4] =(ui >>  8 ) & 0xFFU; \
+                buf_out[5] =(ui >>  0 ) & 0xFFU; \
+                buf_out += ENCODE_UINT32_UNCOMMON_SIZE; \
+            }
+        #define _02_XX_ENCODE_UINT32_UNCOMMON(buf_out, i, field)\
+            ENCODE_UINT32_UNCOMMON(buf_out, i, field)\
+
+        #define ENCODE_LLS_SIZE 6U
+        #define ENCODE_LLS(buf_out, lls )\
+            ENCODE_UINT32_UNCOMMON(buf_out, lls, 0x1B );
+        #define _02_27_ENCODE_LLS(buf_out, lls )\
+            ENCODE_LLS(buf_out, lls );
+
+        #define ENCODE_FLS_SIZE 6U
+        #define ENCODE_FLS(buf_out, fls )\
+            ENCODE_UINT32_UNCOMMON(buf_out, fls, 0x1A );
+        #define _02_26_ENCODE_FLS(buf_out, fls )\
+            ENCODE_FLS(buf_out, fls );
+
+        #define ENCODE_TAG_SRC_SIZE 5
+        #define ENCODE_TAG_SRC(buf_out, tag )\
+            ENCODE_UINT32_COMMON(buf_out, tag, 0x3U );
+        #define _02_03_ENCODE_TAG_SRC(buf_out, tag )\
+            ENCODE_TAG_SRC(buf_out, tag );
+
+        #define ENCODE_TAG_DST_SIZE 5
+        #define ENCODE_TAG_DST(buf_out, tag )\
+            ENCODE_UINT32_COMMON(buf_out, tag, 0xEU );
+        #define _02_14_ENCODE_TAG_DST(buf_out, tag )\
+            ENCODE_TAG_DST(buf_out, tag );
+
+        #define ENCODE_SEQUENCE_SIZE 5
+        #define ENCODE_SEQUENCE(buf_out, sequence )\
+            ENCODE_UINT32_COMMON(buf_out, sequence, 0x4U );
+        #define _02_04_ENCODE_SEQUENCE(buf_out, sequence )\
+            ENCODE_SEQUENCE(buf_out, sequence );
+
+        #define ENCODE_FLAGS_SIZE 5
+        #define ENCODE_FLAGS(buf_out, tag )\
+            ENCODE_UINT32_COMMON(buf_out, tag, 0x2U );
+        #define _02_02_ENCODE_FLAGS(buf_out, tag )\
+            ENCODE_FLAGS(buf_out, tag );
+
+        #define ENCODE_SIGNING_PUBKEY_SIZE 35
+        #define ENCODE_SIGNING_PUBKEY(buf_out, pkey )\
+            {\
+                buf_out[0] = 0x73U;\
+                buf_out[1] = 0x21U;\
+                *(uint64_t*)(buf_out +  2) = *(uint64_t*)(pkey +  0);\
+                *(uint64_t*)(buf_out + 10) = *(uint64_t*)(pkey +  8);\
+                *(uint64_t*)(buf_out + 18) = *(uint64_t*)(pkey + 16);\
+                *(uint64_t*)(buf_out + 26) = *(uint64_t*)(pkey + 24);\
+                buf[34] = pkey[32];\
+                buf_out += ENCODE_SIGNING_PUBKEY_SIZE;\
+            }
+
+        #define _07_03_ENCODE_SIGNING_PUBKEY(buf_out, pkey )\
+            ENCODE_SIGNING_PUBKEY(buf_out, pkey );
+
+        #define ENCODE_SIGNING_PUBKEY_NULL_SIZE 35
+        #define ENCODE_SIGNING_PUBKEY_NULL(buf_out )\
+            {\
+                buf_out[0] = 0x73U;\
+                buf_out[1] = 0x21U;\
+                *(uint64_t*)(buf_out+2) = 0;\
+                *(uint64_t*)(buf_out+10) = 0;\
+                *(uint64_t*)(buf_out+18) = 0;\
+                *(uint64_t*)(buf_out+25) = 0;\
+                buf_out += ENCODE_SIGNING_PUBKEY_NULL_SIZE;\
+            }
+
+        #define _07_03_ENCODE_SIGNING_PUBKEY_NULL(buf_out )\
+            ENCODE_SIGNING_PUBKEY_NULL(buf_out );
+
+        extern int64_t etxn_fee_base (
+            uint32_t read_ptr,
+          	uint32_t read_len
+        );
+        extern int64_t etxn_details (
+            uint32_t write_ptr,
+          	uint32_t write_len
+        );
+        extern int64_t ledger_seq (void);
+
+        #define PREPARE_PAYMENT_SIMPLE_SIZE 270U
+        #define PREPARE_PAYMENT_SIMPLE(buf_out_master, drops_amount_raw, to_address, dest_tag_raw, src_tag_raw)\
+            {\
+                uint8_t* buf_out = buf_out_master;\
+                uint8_t acc[20];\
+                uint64_t drops_amount = (drops_amount_raw);\
+                uint32_t dest_tag = (dest_tag_raw);\
+                uint32_t src_tag = (src_tag_raw);\
+                uint32_t cls = (uint32_t)ledger_seq();\
+                hook_account(SBUF(acc));\
+                _01_02_ENCODE_TT                   (buf_out, ttPAYMENT                      );      /* uint16  | size   3 */ \
+                _02_02_ENCODE_FLAGS                (buf_out, tfCANONICAL                    );      /* uint32  | size   5 */ \
+                _02_03_ENCODE_TAG_SRC              (buf_out, src_tag                        );      /* uint32  | size   5 */ \
+                _02_04_ENCODE_SEQUENCE             (buf_out, 0                              );      /* uint32  | size   5 */ \
+                _02_14_ENCODE_TAG_DST              (buf_out, dest_tag                       );      /* uint32  | size   5 */ \
+                _02_26_ENCODE_FLS                  (buf_out, cls + 1                        );      /* uint32  | size   6 */ \
+                _02_27_ENCODE_LLS                  (buf_out, cls + 5                        );      /* uint32  | size   6 */ \
+                _06_01_ENCODE_DROPS_AMOUNT         (buf_out, drops_amount                   );      /* amount  | size   9 */ \
+                uint8_t* fee_ptr = buf_out;\
+                _06_08_ENCODE_DROPS_FEE            (buf_out, 0                              );      /* amount  | size   9 */ \
+                _07_03_ENCODE_SIGNING_PUBKEY_NULL  (buf_out                                 );      /* pk      | size  35 */ \
+                _08_01_ENCODE_ACCOUNT_SRC          (buf_out, acc                            );      /* account | size  22 */ \
+                _08_03_ENCODE_ACCOUNT_DST          (buf_out, to_address                     );      /* account | size  22 */ \
+                int64_t edlen = etxn_details((uint32_t)buf_out, PREPARE_PAYMENT_SIMPLE_SIZE);       /* emitdet | size 1?? */ \
+                int64_t fee = etxn_fee_base(buf_out_master, PREPARE_PAYMENT_SIMPLE_SIZE);                                    \
+                _06_08_ENCODE_DROPS_FEE            (fee_ptr, fee                            );                               \
+            }
+
+        #define UINT16_FROM_BUF(buf)\
+            (((uint64_t)((buf)[0]) <<  8U) +\
+             ((uint64_t)((buf)[1]) <<  0U))
+
+        #define BUFFER_EQUAL_32(buf1, buf2)\
+            (\
+                *(((uint64_t*)(buf1)) + 0) == *(((uint64_t*)(buf2)) + 0) &&\
+                *(((uint64_t*)(buf1)) + 1) == *(((uint64_t*)(buf2)) + 1) &&\
+                *(((uint64_t*)(buf1)) + 2) == *(((uint64_t*)(buf2)) + 2) &&\
+                *(((uint64_t*)(buf1)) + 3) == *(((uint64_t*)(buf2)) + 3) &&\
+                *(((uint64_t*)(buf1)) + 4) == *(((uint64_t*)(buf2)) + 4) &&\
+                *(((uint64_t*)(buf1)) + 5) == *(((uint64_t*)(buf2)) + 5) &&\
+                *(((uint64_t*)(buf1)) + 6) == *(((uint64_t*)(buf2)) + 6) &&\
+                *(((uint64_t*)(buf1)) + 7) == *(((uint64_t*)(buf2)) + 7))
+
+        #define ASSERT(x)\
+             if (!(x))\
+                rollback((uint32_t)#x,sizeof(#x),__LINE__)
+
+        #define sfDestination ((8U << 16U) + 3U)
+
+        extern int64_t etxn_generation(void);
+        extern int64_t otxn_generation(void);
+        extern int64_t otxn_burden(void);
+        extern int64_t etxn_burden(void);
+
+        int64_t cbak(uint32_t r)
+        {
+            // on callback we emit 2 more txns
+            uint8_t bob[20];
+            ASSERT(otxn_field(SBUF(bob), sfDestination) == 20);
+
+            ASSERT(otxn_generation() + 1 == etxn_generation());
+
+            ASSERT(etxn_burden() == PREREQUISITE_NOT_MET);
+
+            ASSERT(etxn_reserve(2) == 2);
+            
+            ASSERT(otxn_burden() > 0);
+            ASSERT(etxn_burden() == otxn_burden() * 2);
+
+            uint8_t tx[PREPARE_PAYMENT_SIMPLE_SIZE];
+            PREPARE_PAYMENT_SIMPLE(tx, 1000, bob, 0, 0);
+
+            uint8_t hash1[32];
+            ASSERT(emit(SBUF(hash1), SBUF(tx)) == 32);
+
+            ASSERT(etxn_details(tx + 132, 138) == 138);
+            uint8_t hash2[32];
+            ASSERT(emit(SBUF(hash2), SBUF(tx)) == 32);
+
+            ASSERT(!BUFFER_EQUAL_32(hash1, hash2)); 
+
+            return accept(0,0,0);
+        }
+
+        int64_t hook(uint32_t r)
+        {
+            _g(1,1);
+
+            etxn_reserve(1);
+            
+            // bounds checks
+            ASSERT(emit(1000000, 32, 0, 32) == OUT_OF_BOUNDS);
+            ASSERT(emit(0,1000000, 0, 32) == OUT_OF_BOUNDS);
+            ASSERT(emit(0,32, 1000000, 32) == OUT_OF_BOUNDS);
+            ASSERT(emit(0,32, 0, 1000000) == OUT_OF_BOUNDS);
+
+            ASSERT(otxn_generation() == 0);
+            ASSERT(otxn_burden == 1);
+
+            uint8_t bob[20];
+            ASSERT(otxn_param(SBUF(bob), "bob", 3) == 20);
+
+            uint8_t tx[PREPARE_PAYMENT_SIMPLE_SIZE];
+            PREPARE_PAYMENT_SIMPLE(tx, 1000, bob, 0, 0);
+
+            uint8_t hash[32];
+            ASSERT(emit(SBUF(hash), SBUF(tx)) == 32);
+
+            return accept(0,0,0);
+        }
+        )[test.hook]"];
 };
 BEAST_DEFINE_TESTSUITE(SetHook, app, ripple);
 }  // namespace test
@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SubscriptionMatcher.h>
+#include <test/jtx.h>
+#include <algorithm>
+
+namespace ripple {
+namespace test {
+
+class SubscriptionMatcher_test : public beast::unit_test::suite
+{
+    class Sub : public InfoSub
+    {
+    public:
+        using InfoSub::InfoSub;
+
+        void
+        send(Json::Value const&, bool) override
+        {
+        }
+    };
+
+    using Subs = std::vector<std::shared_ptr<InfoSub>>;
+
+    static bool
+    same(SubscriptionMatcher::Subscribers found, Subs expected)
+    {
+        std::sort(found.begin(), found.end());
+        std::sort(expected.begin(), expected.end());
+        return found == expected;
+    }
+
+    void
+    testAccounts()
+    {
+        testcase("accounts");
+
+        using namespace jtx;
+        Env env{*this};
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        Account const carol{"carol"};
+
+        auto& source = env.app().getOPs();
+        auto const a = std::make_shared<Sub>(source);
+        auto const b = std::make_shared<Sub>(source);
+        auto const c = std::make_shared<Sub>(source);
+
+        SubscriptionMatcher matcher;
+        BEAST_EXPECT(!matcher.hasAccounts(false));
+        BEAST_EXPECT(!matcher.hasAccounts(true));
+
+        matcher.addAccount(a, alice.id(), false);
+        matcher.addAccount(a, bob.id(), false);
+        matcher.addAccount(a, bob.id(), false);
+        matcher.addAccount(b, bob.id(), true);
+        matcher.addAccount(c, carol.id(), false);
+        BEAST_EXPECT(matcher.hasAccounts(false));
+        BEAST_EXPECT(matcher.hasAccounts(true));
+        BEAST_EXPECT(matcher.size() == 3);
+
+        std::vector<AccountID> const both{alice.id(), bob.id()};
+        BEAST_EXPECT(same(matcher.matchAccounts(both, true), {a, b}));
+        BEAST_EXPECT(same(matcher.matchAccounts(both, false), {b}));
+        BEAST_EXPECT(same(
+            matcher.matchAccounts(std::vector{carol.id()}, true), {c}));
+
+        // a keeps its slot until its last subscription goes
+        matcher.removeAccount(a->getSeq(), bob.id(), false);
+        BEAST_EXPECT(same(matcher.matchAccounts(both, true), {a, b}));
+        BEAST_EXPECT(matcher.size() == 3);
+        matcher.removeAccount(a->getSeq(), alice.id(), false);
+        BEAST_EXPECT(same(matcher.matchAccounts(both, true), {b}));
+        BEAST_EXPECT(matcher.size() == 2);
+
+        // removing what is not there changes nothing
+        matcher.removeAccount(a->getSeq(), alice.id(), false);
+        matcher.removeAccount(c->getSeq(), carol.id(), true);
+        BEAST_EXPECT(matcher.size() == 2);
+
+        // the free slot is reused
+        auto const d = std::make_shared<Sub>(source);
+        matcher.addAccount(d, alice.id(), true);
+        BEAST_EXPECT(matcher.size() == 3);
+        BEAST_EXPECT(same(matcher.matchAccounts(both, false), {b, d}));
+
+        matcher.removeAccount(b->getSeq(), bob.id(), true);
+        matcher.removeAccount(d->getSeq(), alice.id(), true);
+        BEAST_EXPECT(!matcher.hasAccounts(true));
+        BEAST_EXPECT(matcher.matchAccounts(both, false).empty());
+    }
+
+    void
+    testBooks()
+    {
+        testcase("books");
+
+        using namespace jtx;
+        Env env{*this};
+        Account const gw{"gw"};
+        Account const alice{"alice"};
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+        env.fund(XRP(10000), gw, alice);
+        env(trust(alice, USD(1000)));
+        env.close();
+
+        auto& source = env.app().getOPs();
+        auto const a = std::make_shared<Sub>(source);
+        auto const b = std::make_shared<Sub>(source);
+        auto const c = std::make_shared<Sub>(source);
+
+        Book const xrpUsd{xrpIssue(), USD.issue()};
+        SubscriptionMatcher matcher;
+        matcher.addBook(a, xrpUsd);
+        matcher.addBook(a, reversed(xrpUsd));
+        matcher.addBook(b, xrpUsd);
+        matcher.addBook(c, Book{xrpIssue(), EUR.issue()});
+
+        env(offer(alice, USD(10), XRP(100)));
+        auto const meta = env.meta();
+        TxMeta const txMeta(env.tx()->getTransactionID(), 0, *meta);
+        BEAST_EXPECT(same(matcher.matchBooks(txMeta), {a, b}));
+
+        matcher.removeBook(a->getSeq(), xrpUsd);
+        BEAST_EXPECT(same(matcher.matchBooks(txMeta), {b}));
+
+        // subscribers that have gone away are skipped
+        matcher.addBook(std::make_shared<Sub>(source), xrpUsd);
+        BEAST_EXPECT(same(matcher.matchBooks(txMeta), {b}));
+    }
+
+public:
+    void
+    run() override
+    {
+        testAccounts();
+        testBooks();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SubscriptionMatcher, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
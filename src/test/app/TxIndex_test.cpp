@@ -0,0 +1,513 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/DBInit.h>
+#include <ripple/app/rdb/MigrateTxIndex.h>
+#include <ripple/app/rdb/backend/detail/TxIndex.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/protocol/TxMeta.h>
+#include <test/jtx.h>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+
+namespace ripple {
+namespace test {
+
+class TxIndex_test : public beast::unit_test::suite
+{
+    using TxIndex = detail::TxIndex;
+    using Position = TxIndex::Position;
+
+    // What the index should hold, kept alongside it.
+    struct Model
+    {
+        std::map<std::uint32_t, std::vector<TxIndex::Tx>> ledgers;
+
+        std::vector<Position>
+        positions(
+            AccountID const& account,
+            std::uint32_t min,
+            std::uint32_t max) const
+        {
+            std::vector<Position> result;
+            for (auto const& [seq, txs] : ledgers)
+            {
+                if (seq < min || seq > max)
+                    continue;
+                std::set<std::uint32_t> found;
+                for (auto const& tx : txs)
+                {
+                    if (tx.accounts.count(account))
+                        found.insert(tx.txnSeq);
+                }
+                for (auto const txnSeq : found)
+                    result.push_back({seq, txnSeq});
+            }
+            return result;
+        }
+    };
+
+    beast::Journal const journal_{beast::Journal::getNullSink()};
+    std::mt19937 rng_{42};
+    std::vector<AccountID> accounts_;
+
+    AccountID
+    account(std::size_t i)
+    {
+        while (accounts_.size() <= i)
+        {
+            AccountID a;
+            for (auto& b : a)
+                b = static_cast<std::uint8_t>(rng_());
+            accounts_.push_back(a);
+        }
+        return accounts_[i];
+    }
+
+    std::vector<TxIndex::Tx>
+    makeLedger(std::uint32_t seq, std::size_t count)
+    {
+        std::vector<TxIndex::Tx> txs;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            TxIndex::Tx tx;
+            for (auto& b : tx.id)
+                b = static_cast<std::uint8_t>(rng_());
+            tx.txnSeq = i;
+            tx.status = 'V';
+            tx.txn.assign(1 + rng_() % 64, static_cast<std::uint8_t>(seq));
+            tx.meta.assign(rng_() % 128, static_cast<std::uint8_t>(i));
+            tx.accounts.insert(account(rng_() % 8));
+            tx.accounts.insert(account(rng_() % 8));
+            txs.push_back(std::move(tx));
+        }
+        return txs;
+    }
+
+    void
+    save(TxIndex& index, Model& model, std::uint32_t seq, std::size_t count)
+    {
+        auto txs = makeLedger(seq, count);
+        index.saveLedger(seq, txs);
+        model.ledgers[seq] = std::move(txs);
+    }
+
+    std::vector<Position>
+    walk(
+        TxIndex const& index,
+        AccountID const& account,
+        std::uint32_t min,
+        std::uint32_t max,
+        bool forward,
+        std::optional<Position> const& from = std::nullopt,
+        std::size_t limit = std::numeric_limits<std::size_t>::max())
+    {
+        std::vector<Position> result;
+        index.forEach(
+            account, min, max, forward, from, [&](Position const& p) {
+                result.push_back(p);
+                return result.size() < limit;
+            });
+        return result;
+    }
+
+    void
+    check(TxIndex const& index, Model const& model)
+    {
+        std::uint64_t transactions = 0;
+        for (auto const& [seq, txs] : model.ledgers)
+        {
+            transactions += txs.size();
+            BEAST_EXPECT(index.transactionsIn(seq) == txs.size());
+            auto const records = index.fetchLedger(seq);
+            if (BEAST_EXPECT(records.size() == txs.size()))
+            {
+                for (std::size_t i = 0; i < txs.size(); ++i)
+                    BEAST_EXPECT(records[i].id == txs[i].id);
+            }
+            for (auto const& tx : txs)
+            {
+                auto const record = index.fetch(tx.id);
+                if (!BEAST_EXPECT(record))
+                    continue;
+                BEAST_EXPECT(record->position == (Position{seq, tx.txnSeq}));
+                BEAST_EXPECT(record->status == tx.status);
+                BEAST_EXPECT(record->txn == tx.txn);
+                BEAST_EXPECT(record->meta == tx.meta);
+            }
+        }
+        BEAST_EXPECT(index.transactionCount() == transactions);
+
+        if (model.ledgers.empty())
+        {
+            BEAST_EXPECT(!index.minLedger() && !index.maxLedger());
+        }
+        else
+        {
+            BEAST_EXPECT(index.minLedger() == model.ledgers.begin()->first);
+            BEAST_EXPECT(index.maxLedger() == model.ledgers.rbegin()->first);
+        }
+
+        std::set<AccountID> accounts;
+        for (std::size_t i = 0; i < 8; ++i)
+            accounts.insert(account(i));
+        for (auto const& [seq, txs] : model.ledgers)
+        {
+            for (auto const& tx : txs)
+                accounts.insert(tx.accounts.begin(), tx.accounts.end());
+        }
+
+        for (auto const& a : accounts)
+        {
+            auto expected = model.positions(a, 0, 1000);
+            BEAST_EXPECT(walk(index, a, 0, 1000, true) == expected);
+            std::reverse(expected.begin(), expected.end());
+            BEAST_EXPECT(walk(index, a, 0, 1000, false) == expected);
+
+            BEAST_EXPECT(
+                walk(index, a, 20, 30, true) == model.positions(a, 20, 30));
+        }
+    }
+
+    void
+    checkPages(TxIndex const& index, Model const& model, AccountID const& a)
+    {
+        for (bool forward : {true, false})
+        {
+            auto expected = model.positions(a, 0, 1000);
+            if (!forward)
+                std::reverse(expected.begin(), expected.end());
+
+            // Resume each page from where the last one stopped
+            std::vector<Position> all;
+            std::optional<Position> from;
+            while (true)
+            {
+                auto page = walk(index, a, 0, 1000, forward, from, 33);
+                if (!from)
+                    all.insert(all.end(), page.begin(), page.end());
+                else if (!page.empty())
+                {
+                    BEAST_EXPECT(page.front() == *from);
+                    all.insert(all.end(), page.begin() + 1, page.end());
+                }
+                if (page.size() < 33)
+                    break;
+                from = page.back();
+            }
+            BEAST_EXPECT(all == expected);
+        }
+    }
+
+    void
+    testSaveAndFetch()
+    {
+        testcase("save and fetch");
+
+        beast::temp_dir dir;
+        TxIndex index(dir.path(), {}, journal_);
+        Model model;
+
+        BEAST_EXPECT(!index.minLedger());
+        BEAST_EXPECT(!index.fetch(uint256{1}));
+
+        for (std::uint32_t seq = 10; seq < 50; ++seq)
+            save(index, model, seq, seq % 7);
+        check(index, model);
+
+        BEAST_EXPECT(!index.transactionsIn(5));
+        BEAST_EXPECT(index.ledgersIn(0, 100) == 40);
+        BEAST_EXPECT(index.ledgersIn(20, 29) == 10);
+        BEAST_EXPECT(!index.fetch(Position{20, 100}));
+
+        // Saving a ledger again replaces it
+        save(index, model, 20, 3);
+        check(index, model);
+    }
+
+    void
+    testPaging()
+    {
+        testcase("paging");
+
+        beast::temp_dir dir;
+        TxIndex::Setup setup;
+        setup.memtablePositions = 50;
+        setup.mergeWidth = 100;
+        // Loaded in bulk, so saved ledgers are synced with each segment
+        setup.sync = false;
+        Model model;
+        {
+            TxIndex index(dir.path(), setup, journal_);
+
+            // Enough positions for many blocks in a segment
+            for (std::uint32_t seq = 1; seq < 400; ++seq)
+                save(index, model, seq, 5);
+            index.flush();
+            BEAST_EXPECT(index.segmentCount() > 1);
+
+            checkPages(index, model, account(0));
+            check(index, model);
+
+            // One segment holds several blocks of positions for each account
+            index.compact();
+            BEAST_EXPECT(index.segmentCount() == 1);
+            checkPages(index, model, account(0));
+            check(index, model);
+        }
+
+        TxIndex index(dir.path(), setup, journal_);
+        BEAST_EXPECT(index.segmentCount() == 1);
+        check(index, model);
+    }
+
+    void
+    testDelete()
+    {
+        testcase("delete");
+
+        beast::temp_dir dir;
+        TxIndex::Setup setup;
+        setup.memtablePositions = 40;
+        setup.mergeWidth = 2;
+        Model model;
+        {
+            TxIndex index(dir.path(), setup, journal_);
+
+            for (std::uint32_t seq = 1; seq < 100; ++seq)
+                save(index, model, seq, 4);
+            index.flush();
+
+            // Deleted ledgers stay hidden in older segments
+            for (std::uint32_t seq : {1u, 20u, 50u, 99u})
+            {
+                for (auto const& tx : model.ledgers[seq])
+                    BEAST_EXPECT(index.fetch(tx.id));
+                index.deleteLedger(seq);
+                for (auto const& tx : model.ledgers[seq])
+                    BEAST_EXPECT(!index.fetch(tx.id));
+                model.ledgers.erase(seq);
+            }
+            check(index, model);
+
+            // A ledger saved again after it was deleted is visible again
+            save(index, model, 50, 6);
+            index.flush();
+            check(index, model);
+
+            index.deleteBefore(30);
+            model.ledgers.erase(
+                model.ledgers.begin(), model.ledgers.lower_bound(30));
+            check(index, model);
+
+            index.compact();
+            BEAST_EXPECT(index.segmentCount() == 1);
+            check(index, model);
+
+            // Unflushed work is in the pending log and the manifest
+            index.deleteLedger(60);
+            model.ledgers.erase(60);
+            for (std::uint32_t seq = 100; seq < 110; ++seq)
+                save(index, model, seq, 2);
+        }
+        {
+            TxIndex index(dir.path(), setup, journal_);
+            check(index, model);
+
+            index.deleteBefore(1000);
+            model.ledgers.clear();
+            check(index, model);
+            BEAST_EXPECT(index.transactionCount() == 0);
+            BEAST_EXPECT(index.positionCount() == 0);
+        }
+    }
+
+    // Appends bytes to a file, or overwrites them at an offset
+    static void
+    scribble(
+        boost::filesystem::path const& path,
+        std::string const& bytes,
+        std::optional<std::size_t> offset = std::nullopt)
+    {
+        std::fstream f(
+            path.string(), std::ios::in | std::ios::out | std::ios::binary);
+        if (offset)
+            f.seekp(*offset);
+        else
+            f.seekp(0, std::ios::end);
+        f.write(bytes.data(), bytes.size());
+    }
+
+    void
+    testTornTail()
+    {
+        testcase("torn tail");
+
+        using namespace boost::filesystem;
+
+        beast::temp_dir dir;
+        TxIndex::Setup setup;
+        setup.memtablePositions = 60;
+        Model model;
+        {
+            TxIndex index(dir.path(), setup, journal_);
+            for (std::uint32_t seq = 1; seq < 20; ++seq)
+                save(index, model, seq, 4);
+            index.flush();
+            for (std::uint32_t seq = 20; seq < 30; ++seq)
+                save(index, model, seq, 2);
+        }
+
+        // Rewritten whole, holding just what is not yet in a segment
+        path const root(dir.path());
+        BEAST_EXPECT(!exists(root / "pending.tmp"));
+        BEAST_EXPECT(!exists(root / "MANIFEST.tmp"));
+        BEAST_EXPECT(file_size(root / "pending") % 4 == 0);
+        BEAST_EXPECT(file_size(root / "pending") < 30 * 4);
+
+        // A crash in the middle of saving a ledger leaves part of a block
+        // at the end of the log and part of a sequence in the pending file
+        scribble(root / "txs-0.log", std::string(100, 'x'));
+        scribble(root / "pending", std::string(2, '\x01'));
+        {
+            // Keep what follows in the pending file
+            TxIndex index(dir.path(), {}, journal_);
+            check(index, model);
+            BEAST_EXPECT(file_size(root / "pending") % 4 == 0);
+
+            for (std::uint32_t seq = 30; seq < 35; ++seq)
+                save(index, model, seq, 3);
+            check(index, model);
+        }
+
+        // A torn directory entry drops its ledger rather than the index
+        scribble(root / "ledgers.dir", std::string(4, '\xff'), 32 * 24 + 8);
+        {
+            TxIndex index(dir.path(), {}, journal_);
+            BEAST_EXPECT(!index.transactionsIn(32));
+            BEAST_EXPECT(index.fetchLedger(32).empty());
+            for (auto const& tx : model.ledgers[31])
+                BEAST_EXPECT(index.fetch(tx.id));
+            BEAST_EXPECT(index.maxLedger() == 34);
+        }
+    }
+
+    void
+    testMigrate()
+    {
+        testcase("migrate");
+
+        using namespace jtx;
+
+        // The migration reads the accounts from the metadata, so the
+        // transactions are real ones
+        Env env(*this);
+        std::vector<Account> accounts;
+        for (int i = 0; i < 6; ++i)
+            accounts.emplace_back("A" + std::to_string(i));
+        for (auto const& a : accounts)
+            env.fund(XRP(10000), a);
+        env.close();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            auto const& a = accounts[i % accounts.size()];
+            auto const& b = accounts[(i + 1) % accounts.size()];
+            env(pay(a, b, XRP(1 + i)));
+            if (i % 3 == 0)
+                env(trust(b, a["USD"](1000)));
+            if (i % 4 == 0)
+                env.close();
+        }
+        env.close();
+
+        // Store the closed ledgers in a SQLite transaction database the way
+        // the server does
+        beast::temp_dir dir;
+        auto setup = setup_DatabaseCon(env.app().config());
+        setup.standAlone = false;
+        setup.dataDir = dir.path();
+
+        Model model;
+        {
+            DatabaseCon txdb(setup, TxDBName, TxDBPragma, TxDBInit);
+            auto& session = txdb.getSession();
+            for (std::uint32_t seq = 1; seq <= env.closed()->info().seq; ++seq)
+            {
+                auto const ledger =
+                    env.app().getLedgerMaster().getLedgerBySeq(seq);
+                if (!BEAST_EXPECT(ledger))
+                    continue;
+                for (auto const& [tx, meta] : ledger->txs)
+                {
+                    TxMeta const txMeta(tx->getTransactionID(), seq, *meta);
+                    auto const metaBlob = meta->getSerializer().peekData();
+                    session << STTx::getMetaSQLInsertReplaceHeader() +
+                            tx->getMetaSQL(seq, sqlBlobLiteral(metaBlob));
+
+                    TxIndex::Tx t;
+                    t.id = tx->getTransactionID();
+                    t.txnSeq = txMeta.getIndex();
+                    t.status = txnSqlValidated;
+                    t.txn = tx->getSerializer().peekData();
+                    t.meta = metaBlob;
+                    t.accounts = txMeta.getAffectedAccounts();
+                    model.ledgers[seq].push_back(std::move(t));
+                }
+            }
+        }
+        for (auto& [seq, txs] : model.ledgers)
+        {
+            std::sort(txs.begin(), txs.end(), [](auto const& a, auto const& b) {
+                return a.txnSeq < b.txnSeq;
+            });
+        }
+        BEAST_EXPECT(model.ledgers.size() > 5);
+
+        BEAST_EXPECT(doMigrateTxIndex(setup));
+        {
+            TxIndex index(setup.dataDir / "txindex", {}, journal_);
+            check(index, model);
+        }
+
+        // An index that already holds transactions is left alone
+        BEAST_EXPECT(!doMigrateTxIndex(setup));
+    }
+
+public:
+    void
+    run() override
+    {
+        testSaveAndFetch();
+        testPaging();
+        testDelete();
+        testTornTail();
+        testMigrate();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxIndex, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,234 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/IntrusivePointer.h>
+#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/Protocol.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace {
+
+struct Counts
+{
+    std::atomic<int> partial{0};
+    std::atomic<int> destroyed{0};
+};
+
+class Base : public IntrusiveRefCounts
+{
+    Counts& counts_;
+
+public:
+    explicit Base(Counts& counts) : counts_(counts)
+    {
+    }
+
+    virtual ~Base()
+    {
+        ++counts_.destroyed;
+    }
+
+    virtual void
+    partialDestructor()
+    {
+        ++counts_.partial;
+    }
+};
+
+class Derived final : public Base
+{
+public:
+    int value;
+
+    Derived(Counts& counts, int v) : Base(counts), value(v)
+    {
+    }
+};
+
+}  // namespace
+
+class IntrusivePointer_test : public beast::unit_test::suite
+{
+    void
+    testStrong()
+    {
+        testcase("strong references");
+
+        static_assert(sizeof(SharedIntrusive<Base>) == sizeof(Base*));
+        static_assert(sizeof(WeakIntrusive<Base>) == sizeof(Base*));
+
+        Counts counts;
+        {
+            auto a = make_SharedIntrusive<Derived>(counts, 7);
+            BEAST_EXPECT(a.use_count() == 1);
+
+            SharedIntrusive<Base> b = a;
+            BEAST_EXPECT(a.use_count() == 2);
+            BEAST_EXPECT(b == a);
+
+            auto c = static_pointer_cast<Derived>(std::move(b));
+            BEAST_EXPECT(!b);
+            BEAST_EXPECT(c->value == 7);
+            BEAST_EXPECT(a.use_count() == 2);
+
+            SharedIntrusive<Base> d = c;
+            BEAST_EXPECT(dynamic_pointer_cast<Derived>(d) == a);
+
+            c.reset();
+            d.reset();
+            BEAST_EXPECT(a.use_count() == 1);
+            BEAST_EXPECT(counts.destroyed == 0);
+        }
+        BEAST_EXPECT(counts.destroyed == 1);
+        BEAST_EXPECT(counts.partial == 0);
+    }
+
+    void
+    testWeak()
+    {
+        testcase("weak references");
+
+        Counts counts;
+        auto strong = make_SharedIntrusive<Base>(counts);
+        WeakIntrusive<Base> weak = strong;
+        BEAST_EXPECT(!weak.expired());
+        BEAST_EXPECT(weak.lock() == strong);
+
+        // the last strong reference only partially destroys the object
+        strong.reset();
+        BEAST_EXPECT(weak.expired());
+        BEAST_EXPECT(!weak.lock());
+        BEAST_EXPECT(counts.partial == 1);
+        BEAST_EXPECT(counts.destroyed == 0);
+
+        auto copy = weak;
+        weak.reset();
+        BEAST_EXPECT(counts.destroyed == 0);
+        copy.reset();
+        BEAST_EXPECT(counts.destroyed == 1);
+
+        // without weak references the object is destroyed outright
+        WeakIntrusive<Base> gone;
+        {
+            auto p = make_SharedIntrusive<Base>(counts);
+            gone = p;
+            gone.reset();
+        }
+        BEAST_EXPECT(counts.partial == 1);
+        BEAST_EXPECT(counts.destroyed == 2);
+    }
+
+    void
+    testThreads()
+    {
+        testcase("concurrent release");
+
+        Counts counts;
+        int const rounds = 2000;
+        for (int round = 0; round < rounds; ++round)
+        {
+            auto strong = make_SharedIntrusive<Base>(counts);
+            WeakIntrusive<Base> weak = strong;
+
+            std::thread t1([p = std::move(strong)]() mutable {
+                for (int i = 0; i < 10; ++i)
+                {
+                    auto q = p;
+                }
+                p.reset();
+            });
+            std::thread t2([w = std::move(weak)]() mutable {
+                for (int i = 0; i < 10; ++i)
+                    (void)w.lock();
+                w.reset();
+            });
+            t1.join();
+            t2.join();
+        }
+        BEAST_EXPECT(counts.destroyed == rounds);
+    }
+
+    void
+    testCache()
+    {
+        testcase("tagged cache");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("IntrusivePointer_test", *this);
+        TestStopwatch clock;
+        clock.set(0);
+
+        using Cache = TaggedCache<
+            LedgerIndex,
+            Base,
+            false,
+            hardened_hash<>,
+            std::equal_to<LedgerIndex>,
+            std::recursive_mutex,
+            SharedIntrusive<Base>,
+            WeakIntrusive<Base>>;
+        Cache c("test", 1, 1s, clock, journal);
+
+        Counts counts;
+        auto held = make_SharedIntrusive<Base>(counts);
+        BEAST_EXPECT(!c.canonicalize_replace_client(1, held));
+
+        auto dup = make_SharedIntrusive<Base>(counts);
+        BEAST_EXPECT(c.canonicalize_replace_client(1, dup));
+        BEAST_EXPECT(dup == held);
+        BEAST_EXPECT(counts.destroyed == 1);
+        dup.reset();
+
+        // aged out of the cache, but still tracked
+        ++clock;
+        c.sweep();
+        BEAST_EXPECT(c.getCacheSize() == 0);
+        BEAST_EXPECT(c.getTrackSize() == 1);
+        BEAST_EXPECT(c.fetch(1) == held);
+
+        ++clock;
+        c.sweep();
+        held.reset();
+        BEAST_EXPECT(counts.partial == 1);
+        BEAST_EXPECT(!c.fetch(1));
+        BEAST_EXPECT(counts.destroyed == 2);
+        BEAST_EXPECT(c.getTrackSize() == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testStrong();
+        testWeak();
+        testThreads();
+        testCache();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(IntrusivePointer, basics, ripple);
+
+}  // namespace ripple
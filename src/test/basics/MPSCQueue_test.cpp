@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/MPSCQueue.h>
+#include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class MPSCQueue_test : public beast::unit_test::suite
+{
+    void
+    testOrder()
+    {
+        testcase("order");
+
+        MPSCQueue<std::unique_ptr<int>> q;
+        BEAST_EXPECT(q.empty());
+        BEAST_EXPECT(q.push(std::make_unique<int>(1)));
+        BEAST_EXPECT(!q.push(std::make_unique<int>(2)));
+        BEAST_EXPECT(!q.push(std::make_unique<int>(3)));
+        BEAST_EXPECT(!q.empty());
+
+        std::vector<int> taken;
+        auto const take = [&](std::unique_ptr<int>&& p) {
+            taken.push_back(*p);
+        };
+        BEAST_EXPECT(q.consume(take) == 3);
+        BEAST_EXPECT((taken == std::vector<int>{1, 2, 3}));
+        BEAST_EXPECT(q.empty());
+        BEAST_EXPECT(q.consume(take) == 0);
+
+        // After taking everything, the next push finds the queue empty.
+        BEAST_EXPECT(q.push(std::make_unique<int>(4)));
+        BEAST_EXPECT(q.consume(take) == 1);
+        BEAST_EXPECT(taken.back() == 4);
+
+        // Items left in the queue are destroyed with it.
+        auto shared = std::make_shared<int>(5);
+        {
+            MPSCQueue<std::shared_ptr<int>> left;
+            left.push(shared);
+            left.push(shared);
+            BEAST_EXPECT(shared.use_count() == 3);
+        }
+        BEAST_EXPECT(shared.use_count() == 1);
+    }
+
+    void
+    testConcurrent()
+    {
+        testcase("concurrent");
+
+        struct Item
+        {
+            int producer;
+            int seq;
+        };
+
+        int const producers = 4;
+        int const perProducer = 20000;
+
+        MPSCQueue<Item> q;
+        std::atomic<int> wakeups{0};
+        std::atomic<int> done{0};
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p] {
+                for (int i = 0; i < perProducer; ++i)
+                {
+                    if (q.push({p, i}))
+                        ++wakeups;
+                }
+                ++done;
+            });
+        }
+
+        // Each producer's items must arrive in the order it pushed them.
+        std::vector<int> next(producers, 0);
+        bool ordered = true;
+        std::size_t total = 0;
+        auto const take = [&](Item&& item) {
+            if (item.seq != next[item.producer]++)
+                ordered = false;
+        };
+        while (done < producers || !q.empty())
+            total += q.consume(take);
+        for (auto& t : threads)
+            t.join();
+        total += q.consume(take);
+
+        BEAST_EXPECT(ordered);
+        BEAST_EXPECT(total == producers * perProducer);
+        BEAST_EXPECT(wakeups >= 1);
+        for (int p = 0; p < producers; ++p)
+            BEAST_EXPECT(next[p] == perProducer);
+    }
+
+public:
+    void
+    run() override
+    {
+        testOrder();
+        testConcurrent();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MPSCQueue, basics, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -21,8 +21,13 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/clock/manual_clock.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
 #include <ripple/protocol/Protocol.h>
+#include <ripple/protocol/digest.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <atomic>
+#include <random>
+#include <thread>
 
 namespace ripple {
 
@@ -38,6 +43,76 @@ original object.
 
 class TaggedCache_test : public beast::unit_test::suite
 {
+    void
+    testClockHand(beast::Journal journal)
+    {
+        testcase("clock hand");
+
+        using namespace std::chrono_literals;
+
+        TestStopwatch clock;
+        clock.set(0);
+
+        using Cache = TaggedCache<LedgerIndex, std::string>;
+        Cache c("test", 10, 100s, clock, journal);
+
+        for (LedgerIndex i = 0; i < 100; ++i)
+            c.insert(i, "old");
+        BEAST_EXPECT(c.getCacheSize() == 100);
+
+        // Once the old entries are past their shortened age, inserting into
+        // a partition releases those the hand passes over.
+        // An entry used since then is kept, as its last use is recent.
+        clock.advance(100s);
+        BEAST_EXPECT(c.fetch(0));
+        for (LedgerIndex i = 100; i < 10100; ++i)
+            c.insert(i, "new");
+        BEAST_EXPECT(c.getCacheSize() == 10001);
+        BEAST_EXPECT(c.getTrackSize() == 10100);
+        BEAST_EXPECT(c.fetch(0));
+        BEAST_EXPECT(!c.fetch(1));
+
+        // The released entries are no longer tracked after a sweep
+        c.sweep();
+        BEAST_EXPECT(c.getCacheSize() == 10001);
+        BEAST_EXPECT(c.getTrackSize() == 10001);
+    }
+
+    void
+    testHotEntry(beast::Journal journal)
+    {
+        testcase("hot entry");
+
+        using namespace std::chrono_literals;
+
+        TestStopwatch clock;
+        clock.set(0);
+
+        using Cache = TaggedCache<LedgerIndex, std::string>;
+        Cache c("test", 10, 100s, clock, journal);
+
+        for (LedgerIndex i = 0; i < 100; ++i)
+            c.insert(i, "value");
+
+        // A sweep while the cache is over its target keeps an entry that
+        // was just used, however long ago it was inserted.
+        clock.advance(100s);
+        BEAST_EXPECT(c.fetch(0));
+        BEAST_EXPECT(c.touch_if_exists(1));
+        clock.advance(2s);
+        c.sweep();
+        BEAST_EXPECT(c.getCacheSize() == 2);
+        BEAST_EXPECT(c.getTrackSize() == 2);
+        BEAST_EXPECT(c.fetch(0));
+        BEAST_EXPECT(c.fetch(1));
+
+        // It goes once it is no longer used
+        clock.advance(200s);
+        c.sweep();
+        BEAST_EXPECT(c.getCacheSize() == 0);
+        BEAST_EXPECT(c.getTrackSize() == 0);
+    }
+
 public:
     void
     run() override
@@ -148,9 +223,87 @@ public:
             BEAST_EXPECT(c.getCacheSize() == 0);
             BEAST_EXPECT(c.getTrackSize() == 0);
         }
+
+        testClockHand(journal);
+        testHotEntry(journal);
+    }
+};
+
+// Threads fetching random keys and inserting those that are missing, while
+// another thread sweeps the cache.
+class TaggedCacheBench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono_literals;
+        using clock_type = std::chrono::steady_clock;
+
+        test::SuiteJournal journal("TaggedCacheBench_test", *this);
+
+        std::size_t const keyCount = 1 << 20;
+        std::size_t const opsPerThread = 1000000;
+
+        std::vector<uint256> keys;
+        keys.reserve(keyCount);
+        for (std::size_t i = 0; i < keyCount; ++i)
+            keys.push_back(sha512Half(i));
+
+        for (std::size_t threads : {1, 2, 4, 8, 16})
+        {
+            TaggedCache<uint256, int> c(
+                "bench", keyCount / 2, 60s, stopwatch(), journal);
+
+            std::atomic<bool> done = false;
+            std::thread sweeper([&]() {
+                while (!done)
+                {
+                    c.sweep();
+                    std::this_thread::sleep_for(1s);
+                }
+            });
+
+            auto const start = clock_type::now();
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t]() {
+                    beast::xor_shift_engine gen(t + 1);
+                    std::uniform_int_distribution<std::size_t> dist(
+                        0, keyCount - 1);
+                    for (std::size_t i = 0; i < opsPerThread; ++i)
+                    {
+                        auto const& key = keys[dist(gen)];
+                        if (!c.fetch(key))
+                        {
+                            auto value = std::make_shared<int>(1);
+                            c.canonicalize_replace_client(key, value);
+                        }
+                    }
+                });
+            }
+            for (auto& worker : workers)
+                worker.join();
+            auto const elapsed = clock_type::now() - start;
+
+            done = true;
+            sweeper.join();
+
+            testcase(std::to_string(threads) + " threads");
+            auto const ms =
+                std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                    .count();
+            log << "  " << threads * opsPerThread * 1000 / std::max<long>(ms, 1)
+                << " ops/s, hit rate " << c.getHitRate() << "%, cached "
+                << c.getCacheSize() << " of " << c.getTrackSize()
+                << std::endl;
+            pass();
+        }
     }
 };
 
 BEAST_DEFINE_TESTSUITE(TaggedCache, common, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(TaggedCacheBench, common, ripple);
 
 }  // namespace ripple
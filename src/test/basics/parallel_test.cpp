@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/basics/parallel.h>
+#include <ripple/beast/unit_test.h>
+#include <set>
+#include <stdexcept>
+
+namespace ripple {
+
+class parallel_test : public beast::unit_test::suite
+{
+    void
+    testSlices()
+    {
+        testcase("slices");
+
+        for (std::size_t const n : {0, 1, 7, 100, 10000})
+        {
+            std::vector<std::atomic<int>> seen(n);
+            std::mutex mutex;
+            std::set<std::thread::id> threads;
+            forEachSlice(n, 10, [&](std::size_t begin, std::size_t end) {
+                BEAST_EXPECT(begin < end && end <= n);
+                BEAST_EXPECT(n < 10 || end - begin >= 10 || end == n);
+                for (auto i = begin; i < end; ++i)
+                    ++seen[i];
+                std::lock_guard lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            });
+            BEAST_EXPECT(std::all_of(seen.begin(), seen.end(), [](auto& s) {
+                return s == 1;
+            }));
+            BEAST_EXPECT(
+                threads.size() <=
+                detail::ParallelPool::instance().size() + 1);
+        }
+    }
+
+    void
+    testIndices()
+    {
+        testcase("indices");
+
+        std::vector<std::atomic<int>> seen(1000);
+        forEachIndex(seen.size(), 64, [&](std::size_t i) { ++seen[i]; });
+        BEAST_EXPECT(std::all_of(
+            seen.begin(), seen.end(), [](auto& s) { return s == 1; }));
+
+        // Nested calls do not wait on each other
+        std::atomic<int> count = 0;
+        forEachIndex(16, 16, [&](std::size_t) {
+            forEachSlice(100, 1, [&](std::size_t begin, std::size_t end) {
+                count += end - begin;
+            });
+        });
+        BEAST_EXPECT(count == 1600);
+    }
+
+    void
+    testExceptions()
+    {
+        testcase("exceptions");
+
+        // Thrown on any thread, rethrown on the caller's
+        for (std::size_t const bad : {0, 5, 99})
+        {
+            std::atomic<int> done = 0;
+            try
+            {
+                forEachSlice(100, 1, [&](std::size_t begin, std::size_t end) {
+                    if (begin <= bad && bad < end)
+                        Throw<std::runtime_error>("slice failed");
+                    done += end - begin;
+                });
+                fail("no exception");
+            }
+            catch (std::runtime_error const& e)
+            {
+                BEAST_EXPECT(std::string(e.what()) == "slice failed");
+            }
+            BEAST_EXPECT(done < 100);
+        }
+
+        std::atomic<int> done = 0;
+        try
+        {
+            forEachIndex(1000, 8, [&](std::size_t i) {
+                if (i == 10)
+                    Throw<std::logic_error>("index failed");
+                ++done;
+            });
+            fail("no exception");
+        }
+        catch (std::logic_error const& e)
+        {
+            BEAST_EXPECT(std::string(e.what()) == "index failed");
+        }
+        BEAST_EXPECT(done < 1000);
+
+        // The pool is still usable afterwards
+        done = 0;
+        forEachSlice(100, 1, [&](std::size_t begin, std::size_t end) {
+            done += end - begin;
+        });
+        BEAST_EXPECT(done == 100);
+    }
+
+    void
+    testPool()
+    {
+        testcase("pool");
+
+        // Helpers take part whatever the hardware
+        detail::ParallelPool pool(4);
+        BEAST_EXPECT(pool.size() == 4);
+
+        for (int round = 0; round < 100; ++round)
+        {
+            std::vector<std::atomic<int>> seen(64);
+            std::atomic<int> failures = 0;
+            try
+            {
+                pool.run(seen.size(), [&](std::size_t i) {
+                    ++seen[i];
+                    if (i % 16 == 3)
+                    {
+                        ++failures;
+                        Throw<std::runtime_error>("task failed");
+                    }
+                    // nested, on the same pool
+                    pool.run(3, [&](std::size_t) {});
+                });
+                fail("no exception");
+            }
+            catch (std::runtime_error const&)
+            {
+            }
+            // Every task ran, and all of them were done before the rethrow
+            BEAST_EXPECT(failures == 4);
+            BEAST_EXPECT(std::all_of(seen.begin(), seen.end(), [](auto& s) {
+                return s == 1;
+            }));
+        }
+
+        // A started batch runs on the helpers while the caller goes on
+        {
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::size_t started = 0;
+            auto batch = pool.start(4, [&](std::size_t) {
+                std::unique_lock lock(mutex);
+                ++started;
+                cv.notify_all();
+                cv.wait(lock, [&] { return started == 4; });
+            });
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [&] { return started == 4; });
+            }
+            pool.finish(batch);
+            BEAST_EXPECT(started == 4);
+        }
+
+        // Tasks no helper has begun are run by finish
+        {
+            detail::ParallelPool none(0);
+            int ran = 0;
+            auto batch = none.start(3, [&](std::size_t) { ++ran; });
+            BEAST_EXPECT(ran == 0);
+            none.finish(batch);
+            BEAST_EXPECT(ran == 3);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testPool();
+        testSlices();
+        testIndices();
+        testExceptions();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(parallel, basics, ripple);
+
+}  // namespace ripple
@@ -0,0 +1,316 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/core/JobQueue.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+// The tests of Coroutine_test, for the stackless JobQueue::CoroTask
+class CoroTask_test : public beast::unit_test::suite
+{
+public:
+    using Body = JobQueue::CoroTask::Body;
+
+    class gate
+    {
+    private:
+        std::condition_variable cv_;
+        std::mutex mutex_;
+        bool signaled_ = false;
+
+    public:
+        // Thread safe, blocks until signaled or period expires.
+        // Returns `true` if signaled.
+        template <class Rep, class Period>
+        bool
+        wait_for(std::chrono::duration<Rep, Period> const& rel_time)
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            auto b = cv_.wait_for(lk, rel_time, [this] { return signaled_; });
+            signaled_ = false;
+            return b;
+        }
+
+        void
+        signal()
+        {
+            std::lock_guard lk(mutex_);
+            signaled_ = true;
+            cv_.notify_all();
+        }
+    };
+
+    void
+    correct_order()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+
+        testcase("correct order");
+
+        Env env(*this, envconfig([](std::unique_ptr<Config> cfg) {
+            cfg->FORCE_MULTI_THREAD = true;
+            return cfg;
+        }));
+
+        gate g1, g2;
+        std::shared_ptr<JobQueue::CoroTask> c;
+        env.app().getJobQueue().postCoroTask(
+            jtCLIENT,
+            "CoroTask-Test",
+            [&](std::shared_ptr<JobQueue::CoroTask> cr) -> Body {
+                c = cr;
+                g1.signal();
+                co_await c->yield();
+                g2.signal();
+            });
+        BEAST_EXPECT(g1.wait_for(5s));
+        c->join();
+        c->post();
+        BEAST_EXPECT(g2.wait_for(5s));
+        c->join();
+        BEAST_EXPECT(!c->runnable());
+    }
+
+    void
+    incorrect_order()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+
+        testcase("incorrect order");
+
+        Env env(*this, envconfig([](std::unique_ptr<Config> cfg) {
+            cfg->FORCE_MULTI_THREAD = true;
+            return cfg;
+        }));
+
+        gate g;
+        env.app().getJobQueue().postCoroTask(
+            jtCLIENT,
+            "CoroTask-Test",
+            [&](std::shared_ptr<JobQueue::CoroTask> c) -> Body {
+                c->post();
+                co_await c->yield();
+                g.signal();
+            });
+        BEAST_EXPECT(g.wait_for(5s));
+    }
+
+    void
+    thread_specific_storage()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+
+        testcase("thread specific storage");
+        Env env(*this);
+
+        auto& jq = env.app().getJobQueue();
+
+        static int const N = 4;
+        std::array<std::shared_ptr<JobQueue::CoroTask>, N> a;
+
+        LocalValue<int> lv(-1);
+        BEAST_EXPECT(*lv == -1);
+
+        gate g;
+        jq.addJob(jtCLIENT, "LocalValue-Test", [&]() {
+            this->BEAST_EXPECT(*lv == -1);
+            *lv = -2;
+            this->BEAST_EXPECT(*lv == -2);
+            g.signal();
+        });
+        BEAST_EXPECT(g.wait_for(5s));
+        BEAST_EXPECT(*lv == -1);
+
+        for (int i = 0; i < N; ++i)
+        {
+            jq.postCoroTask(
+                jtCLIENT,
+                "CoroTask-Test",
+                [&, id = i](std::shared_ptr<JobQueue::CoroTask> c) -> Body {
+                    a[id] = c;
+                    g.signal();
+                    co_await c->yield();
+
+                    this->BEAST_EXPECT(*lv == -1);
+                    *lv = id;
+                    this->BEAST_EXPECT(*lv == id);
+                    g.signal();
+                    co_await c->yield();
+
+                    this->BEAST_EXPECT(*lv == id);
+                });
+            BEAST_EXPECT(g.wait_for(5s));
+            a[i]->join();
+        }
+        for (auto const& c : a)
+        {
+            c->post();
+            BEAST_EXPECT(g.wait_for(5s));
+            c->join();
+        }
+        for (auto const& c : a)
+        {
+            c->post();
+            c->join();
+        }
+
+        jq.addJob(jtCLIENT, "LocalValue-Test", [&]() {
+            this->BEAST_EXPECT(*lv == -2);
+            g.signal();
+        });
+        BEAST_EXPECT(g.wait_for(5s));
+        BEAST_EXPECT(*lv == -1);
+    }
+
+    void
+    many_suspended()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+
+        testcase("many suspended");
+
+        Env env(*this, envconfig([](std::unique_ptr<Config> cfg) {
+            cfg->FORCE_MULTI_THREAD = true;
+            return cfg;
+        }));
+
+        auto& jq = env.app().getJobQueue();
+
+        static int const N = 10000;
+        std::vector<std::shared_ptr<JobQueue::CoroTask>> coros(N);
+        std::atomic<int> suspended{0};
+        std::atomic<int> finished{0};
+
+        for (int i = 0; i < N; ++i)
+        {
+            jq.postCoroTask(
+                jtCLIENT,
+                "CoroTask-Test",
+                [&, id = i](std::shared_ptr<JobQueue::CoroTask> c) -> Body {
+                    coros[id] = c;
+                    ++suspended;
+                    co_await c->yield();
+                    ++finished;
+                });
+        }
+        jq.rendezvous();
+        BEAST_EXPECT(suspended == N);
+        BEAST_EXPECT(finished == 0);
+
+        for (auto const& c : coros)
+            c->post();
+        jq.rendezvous();
+        BEAST_EXPECT(finished == N);
+        BEAST_EXPECT(std::none_of(coros.begin(), coros.end(), [](auto& c) {
+            return c->runnable();
+        }));
+    }
+
+    // Suspends the CoroTask awaiting it, from a coroutine it awaits
+    static JobQueue::CoroTask::Task<int>
+    doubled(std::shared_ptr<JobQueue::CoroTask> c, gate& g, int v)
+    {
+        g.signal();
+        co_await c->yield();
+        if (v < 0)
+            Throw<std::runtime_error>("negative");
+        co_return v * 2;
+    }
+
+    static JobQueue::CoroTask::Task<std::string>
+    summed(std::shared_ptr<JobQueue::CoroTask> c, gate& g)
+    {
+        int const a = co_await doubled(c, g, 1);
+        int const b = co_await doubled(c, g, 2);
+        co_return std::to_string(a + b);
+    }
+
+    void
+    nested_tasks()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+
+        testcase("nested tasks");
+
+        Env env(*this, envconfig([](std::unique_ptr<Config> cfg) {
+            cfg->FORCE_MULTI_THREAD = true;
+            return cfg;
+        }));
+
+        gate g;
+        std::string result;
+        std::shared_ptr<JobQueue::CoroTask> c;
+        env.app().getJobQueue().postCoroTask(
+            jtCLIENT,
+            "CoroTask-Test",
+            [&](std::shared_ptr<JobQueue::CoroTask> cr) -> Body {
+                c = cr;
+                result = co_await summed(cr, g);
+                try
+                {
+                    co_await doubled(cr, g, -1);
+                }
+                catch (std::runtime_error const& e)
+                {
+                    result += e.what();
+                }
+                g.signal();
+            });
+
+        // Each await of doubled() suspends the whole CoroTask once
+        for (int i = 0; i < 3; ++i)
+        {
+            BEAST_EXPECT(g.wait_for(5s));
+            c->join();
+            BEAST_EXPECT(c->runnable());
+            c->post();
+        }
+        BEAST_EXPECT(g.wait_for(5s));
+        c->join();
+        BEAST_EXPECT(!c->runnable());
+        BEAST_EXPECT(result == "6negative");
+    }
+
+    void
+    run() override
+    {
+        correct_order();
+        incorrect_order();
+        thread_specific_storage();
+        many_suspended();
+        nested_tasks();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CoroTask, core, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -174,12 +174,74 @@ public:
         BEAST_EXPECT(*lv == -1);
     }
 
+    void
+    json_arena()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+
+        testcase("json arena");
+
+        Env env(*this, envconfig([](std::unique_ptr<Config> cfg) {
+            cfg->FORCE_MULTI_THREAD = true;
+            return cfg;
+        }));
+
+        auto& jq = env.app().getJobQueue();
+
+        // The arena of a coroutine is only in use while it runs, on
+        // whichever thread resumes it
+        gate g;
+        std::shared_ptr<JobQueue::Coro> c;
+        Json::Arena const* arena = nullptr;
+        jq.postCoro(jtCLIENT, "Coroutine-Test", [&](auto const& cr) {
+            c = cr;
+            Json::Arena a;
+            arena = &a;
+            Json::Value v = "a value in the arena";
+            g.signal();
+            c->yield();
+
+            this->BEAST_EXPECT(Json::Arena::current() == &a);
+            v["member"] = "another";
+            {
+                Json::Arena::Suspend suspend;
+                this->BEAST_EXPECT(Json::Arena::current() == nullptr);
+            }
+            this->BEAST_EXPECT(Json::Arena::current() == &a);
+            g.signal();
+        });
+        BEAST_EXPECT(g.wait_for(5s));
+        c->join();
+        BEAST_EXPECT(arena != nullptr);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            jq.addJob(jtCLIENT, "JsonArena-Test", [&]() {
+                this->BEAST_EXPECT(Json::Arena::current() == nullptr);
+                g.signal();
+            });
+            BEAST_EXPECT(g.wait_for(5s));
+        }
+
+        c->post();
+        BEAST_EXPECT(g.wait_for(5s));
+        c->join();
+
+        jq.addJob(jtCLIENT, "JsonArena-Test", [&]() {
+            this->BEAST_EXPECT(Json::Arena::current() == nullptr);
+            g.signal();
+        });
+        BEAST_EXPECT(g.wait_for(5s));
+    }
+
     void
     run() override
     {
         correct_order();
         incorrect_order();
         thread_specific_storage();
+        json_arena();
     }
 };
 
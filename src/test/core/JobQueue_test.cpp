@@ -17,9 +17,15 @@
 */
 //==============================================================================
 
+#include <ripple/basics/PerfLog.h>
+#include <ripple/beast/insight/NullCollector.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/core/JobQueue.h>
 #include <test/jtx/Env.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -149,16 +155,152 @@ class JobQueue_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testLimit()
+    {
+        testcase("limit");
+
+        jtx::Env env{*this};
+
+        // the application's queue has a single worker when standalone
+        int const limit = JobTypes::instance().get(jtLEDGER_DATA).limit();
+        JobQueue jQueue(
+            limit + 2,
+            beast::insight::NullCollector::New(),
+            env.journal,
+            env.app().logs(),
+            env.app().getPerfLog());
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        int running = 0;
+        int peak = 0;
+        bool release = false;
+
+        int const count = limit * 4;
+        for (int i = 0; i < count; ++i)
+        {
+            BEAST_EXPECT(jQueue.addJob(jtLEDGER_DATA, "LimitTest", [&]() {
+                std::unique_lock lock(mutex);
+                peak = std::max(peak, ++running);
+                cv.notify_all();
+                cv.wait(lock, [&] { return release; });
+                --running;
+            }));
+        }
+
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return running == limit; });
+            BEAST_EXPECT(jQueue.getJobCountTotal(jtLEDGER_DATA) == count);
+            release = true;
+            cv.notify_all();
+        }
+
+        jQueue.rendezvous();
+        BEAST_EXPECT(peak == limit);
+        BEAST_EXPECT(jQueue.getJobCountTotal(jtLEDGER_DATA) == 0);
+        jQueue.stop();
+    }
+
 public:
     void
     run() override
     {
         testAddJob();
         testPostCoro();
+        testLimit();
+    }
+};
+
+// Pushes tiny jobs of mixed types through job queues with different numbers
+// of workers, reporting the throughput and the time the jobs spent queued.
+// The optional argument is the number of jobs for each run.
+class JobQueueBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    void
+    bench(jtx::Env& env, int workers, std::size_t jobs)
+    {
+        JobQueue jQueue(
+            workers,
+            beast::insight::NullCollector::New(),
+            env.journal,
+            env.app().logs(),
+            env.app().getPerfLog());
+
+        static std::array<JobType, 8> const types = {
+            jtCLIENT,
+            jtRPC,
+            jtTRANSACTION,
+            jtLEDGER_DATA,
+            jtPROPOSAL_t,
+            jtVALIDATION_t,
+            jtWRITE,
+            jtADMIN};
+
+        std::vector<std::uint32_t> waits(jobs);  // in microseconds
+        int const producers = 4;
+
+        auto const start = clock_type::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]() {
+                for (std::size_t i = p; i < jobs; i += producers)
+                {
+                    jQueue.addJob(
+                        types[i % types.size()],
+                        "bench",
+                        [&waits, i, queued = clock_type::now()]() {
+                            waits[i] = static_cast<std::uint32_t>(
+                                std::chrono::duration_cast<
+                                    std::chrono::microseconds>(
+                                    clock_type::now() - queued)
+                                    .count());
+                        });
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        jQueue.rendezvous();
+        auto const elapsed = clock_type::now() - start;
+        jQueue.stop();
+
+        std::sort(waits.begin(), waits.end());
+        auto const percentile = [&](double p) {
+            return waits[static_cast<std::size_t>(p * (jobs - 1))];
+        };
+        auto const seconds = std::chrono::duration<double>(elapsed).count();
+
+        log << "  " << workers << " workers: "
+            << static_cast<std::uint64_t>(jobs / seconds) << " jobs/s, wait"
+            << " p50 " << percentile(0.5) << "us"
+            << " p99 " << percentile(0.99) << "us"
+            << " p99.9 " << percentile(0.999) << "us"
+            << " max " << waits.back() << "us" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        std::size_t const jobs =
+            arg().empty() ? 2'000'000 : std::stoul(arg());
+
+        jtx::Env env{*this};
+
+        testcase(std::to_string(jobs) + " jobs");
+        for (int workers : {1, 2, 4, 8, 16, 32})
+            bench(env, workers, jobs);
+        pass();
     }
 };
 
 BEAST_DEFINE_TESTSUITE(JobQueue, core, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(JobQueueBench, core, ripple);
 
 }  // namespace test
 }  // namespace ripple
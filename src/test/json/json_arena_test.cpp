@@ -0,0 +1,322 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_arena.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/json/json_value.h>
+#include <ripple/json/to_string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace {
+
+// an account_tx entry: a payment and its metadata
+char const* const sampleTx = R"json({
+    "meta" : {
+        "AffectedNodes" : [
+            {"ModifiedNode" : {
+                "FinalFields" : {
+                    "Account" : "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                    "Balance" : "99999989999999990",
+                    "Flags" : 0, "OwnerCount" : 0, "Sequence" : 2},
+                "LedgerEntryType" : "AccountRoot",
+                "LedgerIndex" :
+                    "2B6AC232AA4C4BE41BF49D2459FA4A0347E1B543A4C92FCEE0821C0201E2E9A8",
+                "PreviousFields" : {
+                    "Balance" : "100000000000000000", "Sequence" : 1},
+                "PreviousTxnID" :
+                    "3A5A1BE1AE2E8C8B1C2E7C2A1F2B2E3A5A1BE1AE2E8C8B1C2E7C2A1F2B2E3A5A",
+                "PreviousTxnLgrSeq" : 3}},
+            {"CreatedNode" : {
+                "LedgerEntryType" : "AccountRoot",
+                "LedgerIndex" :
+                    "4F83A2CF7E70F77F79A307E6A472BFC2585B806A70833CCD1C26105BAE0D6E05",
+                "NewFields" : {
+                    "Account" : "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn",
+                    "Balance" : "10000000", "Sequence" : 3}}}
+        ],
+        "TransactionIndex" : 0,
+        "TransactionResult" : "tesSUCCESS",
+        "delivered_amount" : "10000000"
+    },
+    "tx" : {
+        "Account" : "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+        "Amount" : "10000000",
+        "Destination" : "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn",
+        "Fee" : "10",
+        "Flags" : 2147483648,
+        "Sequence" : 1,
+        "SigningPubKey" :
+            "0330E7FC9D56BB25D6893BA3F317AE5BCF33B3291BD63DB32654A313222F7FD020",
+        "TransactionType" : "Payment",
+        "TxnSignature" :
+            "3045022100F0B0D9AE0BDA0D6BD5E6EA86C8E1E94DDD2E0B5D9A2E0CF6ECA4D5C1",
+        "date" : 749862960,
+        "hash" :
+            "B1F4C8A6C9E6D3A2F9E0D2C3B4A5968778695A4B3C2D1E0F1A2B3C4D5E6F7A8B",
+        "inLedger" : 4,
+        "ledger_index" : 4
+    },
+    "validated" : true
+})json";
+
+Json::Value
+parse(char const* text)
+{
+    Json::Value v;
+    Json::Reader().parse(text, v);
+    return v;
+}
+
+// builds an account_tx style response holding count transactions
+Json::Value
+makeResponse(Json::Value const& tx, int count)
+{
+    Json::Value result{Json::objectValue};
+    result["account"] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
+    result["ledger_index_min"] = 1;
+    result["ledger_index_max"] = 100000;
+    Json::Value& txs = result["transactions"] = Json::arrayValue;
+    for (int i = 0; i < count; ++i)
+    {
+        Json::Value& entry = txs.append(tx);
+        entry["tx"]["Sequence"] = i + 1;
+        entry["tx"]["hash"] = std::to_string(i) + "/" + std::to_string(count);
+    }
+    return result;
+}
+
+}  // namespace
+
+struct json_arena_test : beast::unit_test::suite
+{
+    void
+    testOutliveArena()
+    {
+        testcase("values outlive the arena");
+
+        auto const tx = parse(sampleTx);
+        auto const expected = makeResponse(tx, 50);
+
+        Json::Value inner;
+        Json::Value outer;
+        {
+            Json::Arena arena;
+            {
+                Json::Arena nested;
+                inner = makeResponse(tx, 50);
+            }
+            outer = makeResponse(tx, 50);
+
+            // too large for a block
+            outer["blob"] = std::string(64 * 1024, 'x');
+        }
+        BEAST_EXPECT(inner == expected);
+        BEAST_EXPECT(outer.removeMember("blob").asString().size() == 64 * 1024);
+        BEAST_EXPECT(outer == expected);
+
+        // mixing values from the arena and the heap
+        Json::Value copy = expected;
+        {
+            Json::Arena arena;
+            copy["transactions"][0u] = outer["transactions"][0u];
+            outer["transactions"][1u] = expected["transactions"][1u];
+        }
+        inner = Json::Value{};
+        BEAST_EXPECT(copy == expected);
+        BEAST_EXPECT(outer == expected);
+        BEAST_EXPECT(to_string(outer) == to_string(expected));
+    }
+
+    void
+    testOtherThread()
+    {
+        testcase("values freed on other threads");
+
+        auto const tx = parse(sampleTx);
+        auto const expected = makeResponse(tx, 20);
+
+        std::vector<Json::Value> responses;
+        {
+            Json::Arena arena;
+            for (int i = 0; i < 20; ++i)
+                responses.push_back(makeResponse(tx, 20));
+        }
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (std::size_t i = t; i < responses.size(); i += 4)
+                {
+                    if (responses[i] == expected)
+                        responses[i] = Json::Value{};
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        BEAST_EXPECT(std::all_of(
+            responses.begin(), responses.end(), [](Json::Value const& v) {
+                return v.isNull();
+            }));
+    }
+
+    void
+    testScope()
+    {
+        testcase("scope");
+
+        BEAST_EXPECT(Json::Arena::current() == nullptr);
+        {
+            Json::Arena arena;
+            BEAST_EXPECT(Json::Arena::current() == &arena);
+            {
+                Json::Arena nested;
+                BEAST_EXPECT(Json::Arena::current() == &nested);
+                {
+                    Json::Arena::Suspend suspend;
+                    BEAST_EXPECT(Json::Arena::current() == nullptr);
+                }
+                BEAST_EXPECT(Json::Arena::current() == &nested);
+            }
+            BEAST_EXPECT(Json::Arena::current() == &arena);
+        }
+        BEAST_EXPECT(Json::Arena::current() == nullptr);
+    }
+
+    void
+    testMoveThread()
+    {
+        testcase("arena moved between threads");
+
+        auto const tx = parse(sampleTx);
+
+        // As a coroutine does when it suspends on one thread and resumes
+        // on another
+        Json::Value first;
+        Json::Value second;
+        std::optional<Json::Arena> arena;
+        arena.emplace();
+        first = makeResponse(tx, 10);
+        auto const saved = Json::Arena::exchange(nullptr);
+        BEAST_EXPECT(saved == &*arena);
+
+        std::thread([&]() {
+            BEAST_EXPECT(Json::Arena::current() == nullptr);
+            auto const previous = Json::Arena::exchange(saved);
+            BEAST_EXPECT(previous == nullptr);
+            second = makeResponse(tx, 10);
+            BEAST_EXPECT(Json::Arena::exchange(previous) == saved);
+        }).join();
+
+        BEAST_EXPECT(Json::Arena::current() == nullptr);
+        Json::Arena::exchange(saved);
+        arena.reset();
+        BEAST_EXPECT(Json::Arena::current() == nullptr);
+
+        BEAST_EXPECT(first == makeResponse(tx, 10));
+        BEAST_EXPECT(second == first);
+    }
+
+    void
+    run() override
+    {
+        testScope();
+        testOutliveArena();
+        testOtherThread();
+        testMoveThread();
+    }
+};
+
+// Builds, serializes and destroys account_tx style responses, with the
+// values allocated from the heap and from an arena.
+struct json_arena_bench_test : beast::unit_test::suite
+{
+    void
+    bench(Json::Value const& tx, int txs, int requests, bool arena)
+    {
+        using clock_type = std::chrono::steady_clock;
+
+        std::vector<double> times;
+        times.reserve(requests);
+        std::size_t bytes = 0;
+
+        auto const start = clock_type::now();
+        for (int i = 0; i < requests; ++i)
+        {
+            auto const begin = clock_type::now();
+            {
+                std::optional<Json::Arena> scope;
+                if (arena)
+                    scope.emplace();
+                auto const response = makeResponse(tx, txs);
+                bytes += to_string(response).size();
+            }
+            times.push_back(
+                std::chrono::duration<double, std::micro>(
+                    clock_type::now() - begin)
+                    .count());
+        }
+        auto const elapsed = clock_type::now() - start;
+
+        std::sort(times.begin(), times.end());
+        auto const percentile = [&](double p) {
+            return static_cast<std::uint64_t>(
+                times[static_cast<std::size_t>(p * (requests - 1))]);
+        };
+        auto const seconds = std::chrono::duration<double>(elapsed).count();
+
+        log << "  " << (arena ? "arena" : "heap ") << ": "
+            << static_cast<std::uint64_t>(requests / seconds)
+            << " responses/s, " << bytes / requests << " bytes,"
+            << " p50 " << percentile(0.5) << "us"
+            << " p99 " << percentile(0.99) << "us" << std::endl;
+    }
+
+    void
+    run() override
+    {
+        auto const tx = parse(sampleTx);
+
+        for (int txs : {10, 200, 2000})
+        {
+            int const requests = std::max(20, 200'000 / txs);
+            testcase(
+                std::to_string(requests) + " responses of " +
+                std::to_string(txs) + " transactions");
+            bench(tx, txs, requests, false);
+            bench(tx, txs, requests, true);
+            pass();
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(json_arena, json, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(json_arena_bench, json, ripple);
+
+}  // namespace ripple
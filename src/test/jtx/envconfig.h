@@ -139,6 +139,19 @@ addGrpcConfigWithSecureGateway(
     std::unique_ptr<Config>,
     std::string const& secureGateway);
 
+/// @brief store transactions with the txindex relational database
+///
+/// This is intended for use with envconfig, as in
+/// envconfig(txindex, dir.path())
+///
+/// @param cfg config instance to be modified
+/// @param dir an empty directory for the databases, which must outlive
+/// the Env
+///
+/// @return unique_ptr to Config instance
+std::unique_ptr<Config>
+txindex(std::unique_ptr<Config>, std::string const& dir);
+
 }  // namespace jtx
 }  // namespace test
 }  // namespace ripple
@@ -166,6 +166,14 @@ addGrpcConfigWithSecureGateway(
     return cfg;
 }
 
+std::unique_ptr<Config>
+txindex(std::unique_ptr<Config> cfg, std::string const& dir)
+{
+    (*cfg)[SECTION_RELATIONAL_DB].set("backend", "txindex");
+    cfg->legacy("database_path", dir);
+    return cfg;
+}
+
 }  // namespace jtx
 }  // namespace test
 }  // namespace ripple
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/IoUring.h>
+#include <ripple/nodestore/impl/NuDBPrefetcher.h>
+#include <boost/filesystem.hpp>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+
+namespace ripple {
+namespace NodeStore {
+
+class NuDBPrefetcher_test : public TestBase
+{
+public:
+    void
+    testPrefetch()
+    {
+        testcase("prefetch");
+
+        if (!IoUring::supported())
+        {
+            log << "io_uring is not available, skipping" << std::endl;
+            return;
+        }
+
+        DummyScheduler scheduler;
+        beast::temp_dir tempDir;
+        test::SuiteJournal journal("NuDBPrefetcher_test", *this);
+
+        Section params;
+        params.set("type", "nudb");
+        params.set("path", tempDir.path());
+
+        beast::xor_shift_engine rng(50);
+        auto const batch = createPredictableBatch(numObjectsToTest, rng());
+
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+            // closing commits every record to the data and key files
+            backend->close();
+        }
+
+        boost::filesystem::path const dir(tempDir.path());
+        NuDBPrefetcher prefetcher(
+            (dir / "nudb.dat").string(), (dir / "nudb.key").string());
+
+        std::vector<uint256 const*> hashes;
+        for (auto const& object : batch)
+            hashes.push_back(&object->getHash());
+        BEAST_EXPECT(prefetcher.prefetch(hashes) == batch.size());
+
+        // a second pass reuses the rings of the first
+        BEAST_EXPECT(prefetcher.prefetch(hashes) == batch.size());
+
+        // keys that were never stored have no record to read
+        auto const missing = createPredictableBatch(numObjectsToTest, rng());
+        hashes.clear();
+        for (auto const& object : missing)
+            hashes.push_back(&object->getHash());
+        BEAST_EXPECT(prefetcher.prefetch(hashes) == 0);
+    }
+
+    void
+    run() override
+    {
+        testPrefetch();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(NuDBPrefetcher, ripple_core, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -28,6 +28,7 @@
 #include <ripple/nodestore/Manager.h>
 #include <ripple/unity/rocksdb.h>
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 #include <atomic>
 #include <chrono>
 #include <iterator>
@@ -42,6 +43,9 @@
 #include <type_traits>
 #include <utility>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #ifndef NODESTORE_TIMING_DO_VERIFY
 #define NODESTORE_TIMING_DO_VERIFY 0
 #endif
@@ -145,7 +149,10 @@ class Timing_test : public beast::unit_test::suite
 public:
     enum {
         // percent of fetches for missing nodes
-        missingNodePercent = 20
+        missingNodePercent = 20,
+
+        // keys fetched together by do_random, the most a read thread takes
+        randomBundle = 64
     };
 
     std::size_t const default_repeat = 3;
@@ -392,6 +399,109 @@ public:
         backend->close();
     }
 
+    // Evict the files of the backend from the page cache, so that reads go
+    // to the disk. Only the pages already written back can be dropped.
+    static void
+    drop_cache(Section const& config)
+    {
+#ifdef POSIX_FADV_DONTNEED
+        namespace fs = boost::filesystem;
+        for (fs::directory_iterator it(get(config, "path")), end; it != end;
+             ++it)
+        {
+            int const fd = ::open(it->path().c_str(), O_RDONLY);
+            if (fd < 0)
+                continue;
+            ::fdatasync(fd);
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+#endif
+    }
+
+    // Fetch existing keys in random order from a cold cache, a bundle at a
+    // time as the database read threads do, to compare read engines.
+    void
+    do_random(
+        Section const& config,
+        Params const& params,
+        beast::Journal journal)
+    {
+        DummyScheduler scheduler;
+        auto backend = make_Backend(config, scheduler, journal);
+        BEAST_EXPECT(backend != nullptr);
+        backend->open();
+        drop_cache(config);
+
+        class Body
+        {
+        private:
+            suite& suite_;
+            Backend& backend_;
+            Sequence seq1_;
+            beast::xor_shift_engine gen_;
+            std::uniform_int_distribution<std::size_t> dist_;
+
+        public:
+            Body(
+                std::size_t id,
+                suite& s,
+                Params const& params,
+                Backend& backend)
+                : suite_(s)
+                , backend_(backend)
+                , seq1_(1)
+                , gen_(id + 1)
+                , dist_(0, params.items - 1)
+            {
+            }
+
+            void
+            operator()(std::size_t i)
+            {
+                try
+                {
+                    std::vector<uint256> keys;
+                    for (int n = 0; n < randomBundle; ++n)
+                        keys.push_back(seq1_.obj(dist_(gen_))->getHash());
+
+                    std::vector<uint256 const*> hashes;
+                    for (auto const& key : keys)
+                        hashes.push_back(&key);
+                    backend_.prefetch(hashes);
+
+                    for (auto const& key : keys)
+                    {
+                        std::shared_ptr<NodeObject> result;
+                        backend_.fetch(key.data(), &result);
+                        suite_.expect(result && result->getHash() == key);
+                    }
+                }
+                catch (std::exception const& e)
+                {
+                    suite_.fail(e.what());
+                }
+            }
+        };
+        try
+        {
+            parallel_for_id<Body>(
+                params.items / randomBundle,
+                params.threads,
+                std::ref(*this),
+                std::ref(params),
+                std::ref(*backend));
+        }
+        catch (std::exception const&)
+        {
+#if NODESTORE_TIMING_DO_VERIFY
+            backend->verify();
+#endif
+            Rethrow();
+        }
+        backend->close();
+    }
+
     // Perform lookups of non-existent keys
     void
     do_missing(
@@ -704,6 +814,7 @@ public:
             ss << std::left << setw(10) << "Backend" << std::right;
             for (auto const& test : tests)
                 ss << " " << setw(w) << test.first;
+            ss << " " << setw(w) << "Reads/s";
             log << ss.str() << std::endl;
         }
 
@@ -723,10 +834,16 @@ public:
                 std::stringstream ss;
                 ss << std::left << setw(10)
                    << get(config, "type", std::string()) << std::right;
+                std::size_t rate = 0;
                 for (auto const& test : tests)
-                    ss << " " << setw(w)
-                       << to_string(
-                              do_test(test.second, config, params, journal));
+                {
+                    auto const d =
+                        do_test(test.second, config, params, journal);
+                    if (test.second == &Timing_test::do_random)
+                        rate = params.items * 1000 / (d.count() + 1);
+                    ss << " " << setw(w) << to_string(d);
+                }
+                ss << " " << setw(w) << rate;
                 ss << "   " << to_string(config);
                 log << ss.str() << std::endl;
             }
@@ -743,9 +860,13 @@ public:
             repeat          Number of times to repeat each test
             items           Number of objects to create in the database
 
+            The Random test reports the rate in the Reads/s column. It reads
+            from the disk only if the files can be evicted from the page
+            cache, so that the two NuDB read engines can be compared.
         */
         std::string default_args =
             "type=nudb"
+            ";type=nudb,read_engine=io_uring"
 #if RIPPLE_ROCKSDB_AVAILABLE
             ";type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256,"
             "file_size_mb=8,file_size_mult=2"
@@ -759,6 +880,7 @@ public:
             {"Insert", &Timing_test::do_insert},
             {"Fetch", &Timing_test::do_fetch},
             {"Missing", &Timing_test::do_missing},
+            {"Random", &Timing_test::do_random},
             {"Mixed", &Timing_test::do_mixed},
             {"Work", &Timing_test::do_work}};
 
@@ -0,0 +1,623 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/rfc2616.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <nudb/nudb.hpp>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+// An account root, as the node store holds it
+std::shared_ptr<NodeObject>
+makeAccountNode(beast::xor_shift_engine& rng)
+{
+    AccountID id;
+    beast::rngfill(id.data(), id.size(), rng);
+
+    SLE sle(keylet::account(id));
+    sle.setAccountID(sfAccount, id);
+    std::uint32_t const maxSeq = 80'000'000;
+    std::int64_t const maxDrops = 100'000'000'000;
+    sle.setFieldAmount(
+        sfBalance, XRPAmount{rand_int(rng, std::int64_t(1), maxDrops)});
+    sle.setFieldU32(sfSequence, rand_int(rng, std::uint32_t(1), maxSeq));
+    sle.setFieldU32(sfOwnerCount, rand_int(rng, std::uint32_t(20)));
+    sle.setFieldU32(sfFlags, 0);
+    uint256 previous;
+    beast::rngfill(previous.data(), previous.size(), rng);
+    sle.setFieldH256(sfPreviousTxnID, previous);
+    sle.setFieldU32(
+        sfPreviousTxnLgrSeq, rand_int(rng, std::uint32_t(1), maxSeq));
+
+    Serializer s;
+    s.add32(HashPrefix::leafNode);
+    sle.add(s);
+    s.addBitString(sle.key());
+
+    uint256 hash;
+    beast::rngfill(hash.data(), hash.size(), rng);
+    return NodeObject::createObject(
+        hotACCOUNT_NODE, std::move(s.modData()), hash);
+}
+
+std::shared_ptr<NodeObject>
+makeInnerNode(beast::xor_shift_engine& rng, int branches)
+{
+    Serializer s;
+    s.add32(HashPrefix::innerNode);
+    for (int i = 0; i < 16; ++i)
+    {
+        uint256 child;
+        if (i < branches)
+            beast::rngfill(child.data(), child.size(), rng);
+        s.addBitString(child);
+    }
+
+    uint256 hash;
+    beast::rngfill(hash.data(), hash.size(), rng);
+    return NodeObject::createObject(
+        hotACCOUNT_NODE, std::move(s.modData()), hash);
+}
+
+Blob
+encode(std::shared_ptr<NodeObject> const& object)
+{
+    EncodedBlob e(object);
+    auto const data = static_cast<std::uint8_t const*>(e.getData());
+    return Blob(data, data + e.getSize());
+}
+
+std::size_t
+codecType(std::pair<void const*, std::size_t> const& compressed)
+{
+    std::size_t type = 0;
+    read_varint(
+        static_cast<std::uint8_t const*>(compressed.first),
+        compressed.second,
+        type);
+    return type;
+}
+
+std::vector<Blob>
+makeSamples(std::uint64_t seed, int count)
+{
+    beast::xor_shift_engine rng(seed);
+    std::vector<Blob> samples;
+    for (int i = 0; i < count; ++i)
+        samples.push_back(encode(makeAccountNode(rng)));
+    return samples;
+}
+
+}  // namespace
+
+class ZstdCodec_test : public TestBase
+{
+    void
+    testCodec()
+    {
+        testcase("codec");
+
+        ZstdDictionary const dict(ZstdDictionary::train(makeSamples(1, 2000)));
+        ZstdDictionary const other(
+            ZstdDictionary::train(makeSamples(2, 2000)));
+        BEAST_EXPECT(dict.id() != 0 && dict.id() != other.id());
+
+        beast::xor_shift_engine rng(3);
+        std::size_t lz4Bytes = 0;
+        std::size_t zstdBytes = 0;
+
+        for (int i = 0; i < 500; ++i)
+        {
+            auto const blob = encode(makeAccountNode(rng));
+
+            nudb::detail::buffer lz4Buf;
+            auto const lz4 =
+                nodeobject_compress(blob.data(), blob.size(), lz4Buf);
+            BEAST_EXPECT(codecType(lz4) == 1);
+            lz4Bytes += lz4.second;
+
+            nudb::detail::buffer zstdBuf;
+            auto const zstd =
+                nodeobject_compress(blob.data(), blob.size(), zstdBuf, &dict);
+            BEAST_EXPECT(codecType(zstd) == 4);
+            zstdBytes += zstd.second;
+
+            // both are read back when there is a dictionary
+            for (auto const& compressed : {lz4, zstd})
+            {
+                nudb::detail::buffer out;
+                auto const result = nodeobject_decompress(
+                    compressed.first, compressed.second, out, &dict);
+                BEAST_EXPECT(
+                    result.second == blob.size() &&
+                    std::memcmp(result.first, blob.data(), blob.size()) == 0);
+            }
+
+            // but zstd objects only with the dictionary they were made with
+            nudb::detail::buffer out;
+            try
+            {
+                nodeobject_decompress(zstd.first, zstd.second, out);
+                fail("no dictionary");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+            try
+            {
+                nodeobject_decompress(zstd.first, zstd.second, out, &other);
+                fail("other dictionary");
+            }
+            catch (std::runtime_error const& e)
+            {
+                // told apart by the ID recorded with the object
+                BEAST_EXPECT(
+                    std::string(e.what()).find(std::to_string(dict.id())) !=
+                    std::string::npos);
+            }
+        }
+
+        log << "lz4: " << lz4Bytes << " bytes, zstd: " << zstdBytes
+            << " bytes" << std::endl;
+        BEAST_EXPECT(zstdBytes < lz4Bytes);
+
+        // inner nodes keep their own encodings
+        for (int branches : {3, 16})
+        {
+            auto const blob = encode(makeInnerNode(rng, branches));
+            nudb::detail::buffer buf;
+            auto const compressed =
+                nodeobject_compress(blob.data(), blob.size(), buf, &dict);
+            BEAST_EXPECT(codecType(compressed) == (branches == 16 ? 3 : 2));
+        }
+    }
+
+    void
+    testBackend()
+    {
+        testcase("NuDB backend");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("ZstdCodec_test", *this);
+        beast::temp_dir tempDir;
+
+        auto const dict = ZstdDictionary::train(makeSamples(4, 2000));
+        boost::system::error_code ec;
+        writeFileContents(
+            ec,
+            tempDir.file(ZstdDictionary::defaultFileName),
+            std::string(dict.begin(), dict.end()));
+        BEAST_EXPECT(!ec);
+
+        Section params;
+        params.set("type", "nudb");
+        params.set("path", tempDir.path());
+
+        auto batch = createPredictableBatch(numObjectsToTest, 5);
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+
+        // a configured dictionary must exist
+        beast::temp_dir otherDir;
+        params.set("path", otherDir.path());
+        params.set("zstd_dictionary", tempDir.file("missing.dict"));
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            try
+            {
+                backend->open();
+                fail("missing dictionary");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+        }
+    }
+
+    void
+    testRotation()
+    {
+        testcase("NuDB rotation");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("ZstdCodec_test", *this);
+        beast::temp_dir configDir;
+        beast::temp_dir firstDir;
+        beast::temp_dir secondDir;
+
+        auto const writeDictionary = [&](std::uint64_t seed) {
+            auto const dict = ZstdDictionary::train(makeSamples(seed, 2000));
+            boost::system::error_code ec;
+            writeFileContents(
+                ec,
+                configDir.file("node.dict"),
+                std::string(dict.begin(), dict.end()));
+            BEAST_EXPECT(!ec);
+            return ZstdDictionary(dict).id();
+        };
+
+        auto const localCopy = [](beast::temp_dir const& dir) {
+            return ZstdDictionary::load(
+                       dir.file(ZstdDictionary::defaultFileName))
+                ->id();
+        };
+
+        Section params;
+        params.set("type", "nudb");
+        params.set("online_delete", "256");
+
+        // Without a configured dictionary, one in the database directory
+        // would not follow the databases replacing it
+        {
+            beast::temp_dir dir;
+            auto const dict = ZstdDictionary::train(makeSamples(6, 2000));
+            boost::system::error_code ec;
+            writeFileContents(
+                ec,
+                dir.file(ZstdDictionary::defaultFileName),
+                std::string(dict.begin(), dict.end()));
+            params.set("path", dir.path());
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            try
+            {
+                backend->open();
+                fail("dictionary without zstd_dictionary");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+        }
+
+        // Each database gets a copy of the configured dictionary
+        auto const firstId = writeDictionary(7);
+        params.set("zstd_dictionary", configDir.file("node.dict"));
+        params.set("path", firstDir.path());
+        auto batch = createPredictableBatch(numObjectsToTest, 8);
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+        }
+        BEAST_EXPECT(localCopy(firstDir) == firstId);
+
+        // A new dictionary is used by the next database, while the first
+        // keeps reading its objects with its own copy
+        auto const secondId = writeDictionary(9);
+        BEAST_EXPECT(secondId != firstId);
+        params.set("path", secondDir.path());
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+        }
+        BEAST_EXPECT(localCopy(secondDir) == secondId);
+
+        for (auto const& dir : {&firstDir, &secondDir})
+        {
+            params.set("path", dir->path());
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+        BEAST_EXPECT(localCopy(firstDir) == firstId);
+    }
+
+public:
+    void
+    run() override
+    {
+        testCodec();
+        testBackend();
+        testRotation();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ZstdCodec, NodeStore, ripple);
+
+//------------------------------------------------------------------------------
+
+// Trains a zstd dictionary from a NuDB database, and reports how each kind
+// of object compresses and decodes with lz4 and with zstd. Run it against a
+// copy of the database, not the one in use by a server.
+class zstd_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        std::size_t count = 0;
+        std::size_t rawBytes = 0;
+        std::size_t storedBytes = 0;
+        std::size_t lz4Bytes = 0;
+        std::size_t zstdBytes = 0;
+        clock_type::duration lz4Time{};
+        clock_type::duration zstdTime{};
+    };
+
+    static std::map<std::string, std::string>
+    parseArgs(std::string const& s)
+    {
+        std::map<std::string, std::string> args;
+        for (auto const& kv : beast::rfc2616::split(s.begin(), s.end(), ','))
+        {
+            auto const eq = kv.find('=');
+            if (eq == std::string::npos)
+                Throw<std::runtime_error>("invalid parameter " + kv);
+            args[kv.substr(0, eq)] = kv.substr(eq + 1);
+        }
+        return args;
+    }
+
+    static bool
+    isInner(void const* data, std::size_t size)
+    {
+        return size == 525 &&
+            std::memcmp(
+                static_cast<std::uint8_t const*>(data) + 9,
+                "MIN\0",
+                4) == 0;
+    }
+
+    static std::string
+    kind(void const* data, std::size_t size)
+    {
+        if (size < 9)
+            return "other";
+
+        bool const inner = isInner(data, size);
+        switch (static_cast<std::uint8_t const*>(data)[8])
+        {
+            case hotLEDGER:
+                return "ledger";
+            case hotACCOUNT_NODE:
+                return inner ? "state inner" : "state leaf";
+            case hotTRANSACTION_NODE:
+                return inner ? "tx inner" : "tx leaf";
+            default:
+                return inner ? "inner" : "other";
+        }
+    }
+
+    template <class F>
+    void
+    visit(std::string const& dat, F&& f)
+    {
+        nudb::error_code ec;
+        nudb::visit(
+            dat,
+            [&](void const*,
+                std::size_t,
+                void const* data,
+                std::size_t size,
+                nudb::error_code&) { f(data, size); },
+            nudb::no_progress{},
+            ec);
+        if (ec)
+            Throw<nudb::system_error>(ec);
+    }
+
+    void
+    train(
+        std::string const& dat,
+        ZstdDictionary const* current,
+        std::string const& file,
+        std::size_t samples)
+    {
+        // a uniform sample of everything but inner nodes, which are hashes
+        beast::xor_shift_engine rng(default_prng()());
+        std::vector<Blob> sample;
+        std::size_t seen = 0;
+        visit(dat, [&](void const* data, std::size_t size) {
+            nudb::detail::buffer bf;
+            auto const raw = nodeobject_decompress(data, size, bf, current);
+            if (isInner(raw.first, raw.second))
+                return;
+            auto const p = static_cast<std::uint8_t const*>(raw.first);
+            if (sample.size() < samples)
+                sample.emplace_back(p, p + raw.second);
+            else if (auto const i = rand_int(rng, seen); i < samples)
+                sample[i].assign(p, p + raw.second);
+            ++seen;
+        });
+
+        auto const dict = ZstdDictionary::train(sample);
+        boost::system::error_code ec;
+        writeFileContents(ec, file, std::string(dict.begin(), dict.end()));
+        if (ec)
+            Throw<std::runtime_error>(
+                "can't write " + file + ": " + ec.message());
+
+        log << "Trained a " << dict.size() << " byte dictionary from "
+            << sample.size() << " of " << seen << " objects into " << file
+            << std::endl;
+    }
+
+    void
+    report(
+        std::string const& dat,
+        ZstdDictionary const* current,
+        ZstdDictionary const& dict)
+    {
+        std::map<std::string, Stats> stats;
+        visit(dat, [&](void const* data, std::size_t size) {
+            nudb::detail::buffer bf;
+            auto const raw = nodeobject_decompress(data, size, bf, current);
+            auto& s = stats[kind(raw.first, raw.second)];
+            ++s.count;
+            s.rawBytes += raw.second;
+            s.storedBytes += size;
+
+            auto decode = [&](ZstdDictionary const* d,
+                              std::size_t& bytes,
+                              clock_type::duration& time) {
+                nudb::detail::buffer in;
+                auto const c =
+                    nodeobject_compress(raw.first, raw.second, in, d);
+                bytes += c.second;
+
+                nudb::detail::buffer out;
+                auto const start = clock_type::now();
+                auto const result =
+                    nodeobject_decompress(c.first, c.second, out, d);
+                time += clock_type::now() - start;
+                if (result.second != raw.second ||
+                    std::memcmp(result.first, raw.first, raw.second) != 0)
+                    Throw<std::runtime_error>("round trip mismatch");
+            };
+            decode(nullptr, s.lz4Bytes, s.lz4Time);
+            decode(&dict, s.zstdBytes, s.zstdTime);
+        });
+
+        auto ratio = [](std::size_t raw, std::size_t bytes) {
+            return bytes ? double(raw) / bytes : 0.0;
+        };
+        auto throughput = [](std::size_t raw, clock_type::duration time) {
+            auto const us =
+                std::chrono::duration_cast<std::chrono::microseconds>(time)
+                    .count();
+            return us ? double(raw) / us : 0.0;  // bytes per us, or MB/s
+        };
+
+        log << std::left << std::setw(12) << "type" << std::right
+            << std::setw(12) << "objects" << std::setw(14) << "raw bytes"
+            << std::setw(14) << "stored" << std::setw(14) << "lz4"
+            << std::setw(14) << "zstd" << std::setw(10) << "lz4 MB/s"
+            << std::setw(10) << "zstd MB/s" << std::endl;
+
+        Stats total;
+        for (auto const& [name, s] : stats)
+        {
+            log << std::left << std::setw(12) << name << std::right
+                << std::setw(12) << s.count << std::setw(14) << s.rawBytes
+                << std::setw(14) << s.storedBytes << std::fixed
+                << std::setprecision(2) << std::setw(8)
+                << ratio(s.rawBytes, s.lz4Bytes) << "x" << std::setw(5) << ""
+                << std::setw(8) << ratio(s.rawBytes, s.zstdBytes) << "x"
+                << std::setw(5) << "" << std::setprecision(0) << std::setw(10)
+                << throughput(s.rawBytes, s.lz4Time) << std::setw(10)
+                << throughput(s.rawBytes, s.zstdTime) << std::endl;
+
+            total.count += s.count;
+            total.rawBytes += s.rawBytes;
+            total.storedBytes += s.storedBytes;
+            total.lz4Bytes += s.lz4Bytes;
+            total.zstdBytes += s.zstdBytes;
+        }
+
+        log << "Total: " << total.count << " objects, " << total.rawBytes
+            << " raw bytes, " << total.storedBytes << " stored, "
+            << total.lz4Bytes << " with lz4, " << total.zstdBytes
+            << " with zstd" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase(beast::unit_test::abort_on_fail) << arg();
+        pass();
+
+        auto const args = parseArgs(arg());
+        auto get = [&args](std::string const& key) -> std::string {
+            auto const it = args.find(key);
+            return it == args.end() ? "" : it->second;
+        };
+
+        if (get("path").empty() ||
+            (get("dict").empty() && get("train").empty()))
+        {
+            log << "Usage:\n"
+                << "--unittest-arg=path=<path>[,dict=<dict>]"
+                   "[,train=<file>[,samples=<n>]]\n"
+                << "path:    NuDB database directory, a copy of the one in "
+                   "use\n"
+                << "dict:    dictionary the database was written with, if "
+                   "any,\n"
+                << "         and the one to report on unless training\n"
+                << "train:   train a dictionary into this file, and report "
+                   "on it\n"
+                << "samples: objects to train from, default 100000"
+                << std::endl;
+            return;
+        }
+
+        auto const dat =
+            (boost::filesystem::path(get("path")) / "nudb.dat").string();
+
+        std::shared_ptr<ZstdDictionary const> current;
+        if (!get("dict").empty())
+            current = ZstdDictionary::load(get("dict"));
+
+        std::shared_ptr<ZstdDictionary const> dict = current;
+        if (auto const file = get("train"); !file.empty())
+        {
+            auto const samples = get("samples");
+            train(
+                dat,
+                current.get(),
+                file,
+                samples.empty() ? 100000 : std::stoull(samples));
+            dict = ZstdDictionary::load(file);
+        }
+
+        report(dat, current.get(), *dict);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(zstd, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
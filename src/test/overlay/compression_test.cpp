@@ -140,6 +140,15 @@ public:
             uncompressed.begin() + ripple::compression::headerBytes,
             uncompressed.end(),
             decompressed.begin()));
+
+        // The message handed to the handlers is parsed into a pooled arena
+        // and must match the one parsed above.
+        auto const proto2 = ripple::detail::parseMessageContent<T>(
+            *header, buffers.data());
+        BEAST_EXPECT(proto2);
+        if (proto2)
+            BEAST_EXPECT(
+                proto2->SerializeAsString() == proto1->SerializeAsString());
     }
 
     std::shared_ptr<protocol::TMManifests>
@@ -490,7 +499,8 @@ public:
                 env->app().config().COMPRESSION,
                 false,
                 env->app().config().TX_REDUCE_RELAY_ENABLE,
-                env->app().config().VP_REDUCE_RELAY_ENABLE);
+                env->app().config().VP_REDUCE_RELAY_ENABLE,
+                false);
             http_request_type http_request;
             http_request.version(request.version());
             http_request.base() = request.base();
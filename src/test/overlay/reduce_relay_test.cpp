@@ -176,6 +176,11 @@ public:
     removeTxQueue(const uint256&) override
     {
     }
+    bool
+    txBatchEnabled() const override
+    {
+        return false;
+    }
 };
 
 /** Manually advanced clock. */
@@ -1514,7 +1519,8 @@ vp_squelched=1
                     env_.app().config().COMPRESSION,
                     false,
                     env_.app().config().TX_REDUCE_RELAY_ENABLE,
-                    env_.app().config().VP_REDUCE_RELAY_ENABLE);
+                    env_.app().config().VP_REDUCE_RELAY_ENABLE,
+                    false);
                 http_request_type http_request;
                 http_request.version(request.version());
                 http_request.base() = request.base();
@@ -16,12 +16,19 @@
     OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 //==============================================================================
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/misc/LoadFeeTrack.h>
+#include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/Transaction.h>
 #include <ripple/basics/make_SSLContext.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/overlay/Cluster.h>
+#include <ripple/overlay/Compression.h>
 #include <ripple/overlay/impl/OverlayImpl.h>
 #include <ripple/overlay/impl/PeerImp.h>
+#include <ripple/overlay/impl/Tuning.h>
 #include <ripple/peerfinder/impl/SlotImp.h>
-#include <test/jtx/Env.h>
+#include <test/jtx.h>
 
 namespace ripple {
 
@@ -122,9 +129,11 @@ private:
         {
         }
         void
-        send(std::shared_ptr<Message> const&) override
+        send(std::shared_ptr<Message> const& m) override
         {
+            std::lock_guard lock(sentMutex_);
             sendTx_++;
+            sent_.push_back(m);
         }
         void
         addTxQueue(const uint256& hash) override
@@ -134,13 +143,34 @@ private:
         static void
         init()
         {
+            std::lock_guard lock(sentMutex_);
             queueTx_ = 0;
             sendTx_ = 0;
             sid_ = 0;
+            sent_.clear();
+        }
+        // Returns the number of transactions in each TMTransactions sent
+        static std::vector<int>
+        batches()
+        {
+            std::lock_guard lock(sentMutex_);
+            std::vector<int> result;
+            for (auto const& m : sent_)
+            {
+                auto const& buffer = m->getBuffer(compression::Compressed::Off);
+                protocol::TMTransactions batch;
+                if (batch.ParseFromArray(
+                        buffer.data() + compression::headerBytes,
+                        buffer.size() - compression::headerBytes))
+                    result.push_back(batch.transactions_size());
+            }
+            return result;
         }
         inline static std::size_t sid_ = 0;
         inline static std::uint16_t queueTx_ = 0;
         inline static std::uint16_t sendTx_ = 0;
+        inline static std::mutex sentMutex_;
+        inline static std::vector<std::shared_ptr<Message>> sent_;
     };
 
     std::uint16_t lid_{0};
@@ -167,7 +197,7 @@ private:
         (nDisabled == 0)
             ? (void)request.insert(
                   "X-Protocol-Ctl",
-                  makeFeaturesRequestHeader(false, false, true, false))
+                  makeFeaturesRequestHeader(false, false, true, false, false))
             : (void)nDisabled--;
         auto stream_ptr = std::make_unique<stream_type>(
             socket_type(std::forward<boost::asio::io_service&>(
@@ -196,6 +226,83 @@ private:
         assert(lid_ <= 254);
     }
 
+    // Returns a peer with tx batching enabled, whose socket is open so that
+    // it sends as a connected peer would.
+    std::shared_ptr<PeerTest>
+    addBatchPeer(jtx::Env& env, PublicKey const& key)
+    {
+        auto& overlay = dynamic_cast<OverlayImpl&>(env.app().overlay());
+        http_request_type request;
+        request.insert(
+            "X-Protocol-Ctl",
+            makeFeaturesRequestHeader(false, false, false, false, true));
+        auto stream_ptr = std::make_unique<stream_type>(
+            socket_type(env.app().getIOService()), *context_);
+        stream_ptr->next_layer().socket().open(boost::asio::ip::tcp::v4());
+        beast::IP::Endpoint local(
+            beast::IP::Address::from_string("172.1.1." + std::to_string(lid_)));
+        beast::IP::Endpoint remote(
+            beast::IP::Address::from_string("172.1.1." + std::to_string(rid_)));
+        auto consumer = overlay.resourceManager().newInboundEndpoint(remote);
+        auto slot = overlay.peerFinder().new_inbound_slot(local, remote);
+        auto const peer = std::make_shared<PeerTest>(
+            env.app(),
+            slot,
+            std::move(request),
+            key,
+            protocolVersion_,
+            consumer,
+            std::move(stream_ptr),
+            overlay);
+        overlay.add_active(peer);
+        lid_ += 2;
+        rid_ += 2;
+        assert(lid_ <= 254);
+        return peer;
+    }
+
+    // Returns a batch of transactions from the account, starting from
+    // its next sequence, followed by the number of malformed ones given
+    static std::shared_ptr<protocol::TMTransactions>
+    makeBatch(
+        jtx::Env& env,
+        jtx::Account const& account,
+        std::size_t count,
+        std::size_t malformed = 0)
+    {
+        auto m = std::make_shared<protocol::TMTransactions>();
+        auto const first = env.seq(account);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const jt = env.jt(jtx::noop(account), jtx::seq(first + i));
+            Serializer s;
+            jt.stx->add(s);
+            auto tx = m->add_transactions();
+            tx->set_rawtransaction(s.data(), s.size());
+            tx->set_status(protocol::tsNEW);
+            tx->set_deferred(false);
+        }
+        for (std::size_t i = 0; i < malformed; ++i)
+        {
+            auto tx = m->add_transactions();
+            tx->set_rawtransaction("transaction");
+            tx->set_status(protocol::tsNEW);
+        }
+        return m;
+    }
+
+    // Raises the local fee within what privileged transactions may
+    // ignore. LoadManager lowers it again, but not within a test step.
+    void
+    raiseLocalFee(jtx::Env& env)
+    {
+        for (int i = 0; i < 5; ++i)
+            env.app().getFeeTrack().raiseLocalFee();
+        auto const [local, remote] =
+            env.app().getFeeTrack().getScalingFactors();
+        BEAST_EXPECT(local > remote && local < 4 * remote);
+    }
+
     void
     testRelay(
         std::string const& test,
@@ -229,12 +336,240 @@ private:
             PeerTest::queueTx_ == expectQueue);
     }
 
+    void
+    testBatchHandshake()
+    {
+        testcase("tx batching handshake");
+        // The feature is enabled only if both sides are configured for it
+        for (bool const requested : {false, true})
+        {
+            for (bool const configured : {false, true})
+            {
+                http_request_type request;
+                request.insert(
+                    "X-Protocol-Ctl",
+                    makeFeaturesRequestHeader(
+                        false, false, true, false, requested));
+                BEAST_EXPECT(
+                    featureEnabled(request, FEATURE_TXBATCH) == requested);
+                BEAST_EXPECT(
+                    peerFeatureEnabled(request, FEATURE_TXBATCH, configured) ==
+                    (requested && configured));
+
+                http_response_type response;
+                response.insert(
+                    "X-Protocol-Ctl",
+                    makeFeaturesResponseHeader(
+                        request, false, false, true, false, configured));
+                BEAST_EXPECT(
+                    peerFeatureEnabled(response, FEATURE_TXBATCH, true) ==
+                    (requested && configured));
+                // Other features are unaffected
+                BEAST_EXPECT(featureEnabled(response, FEATURE_TXRR));
+            }
+        }
+    }
+
+    void
+    testBatchSend()
+    {
+        testcase("tx batching send");
+        using namespace std::chrono;
+
+        jtx::Env env(*this);
+        env.app().config().TX_BATCH = true;
+        PeerTest::init();
+        lid_ = 0;
+        rid_ = 1;
+        std::vector<std::shared_ptr<PeerTest>> peers;
+        for (int i = 0; i < 3; ++i)
+            peers.push_back(addBatchPeer(
+                env, std::get<0>(randomKeyPair(KeyType::ed25519))));
+
+        std::uint32_t hash = 0;
+        auto relay = [&](std::size_t count,
+                         std::set<Peer::id_t> const& toSkip = {}) {
+            for (std::size_t i = 0; i < count; ++i, ++hash)
+            {
+                protocol::TMTransaction m;
+                m.set_rawtransaction("transaction " + std::to_string(hash));
+                m.set_deferred(false);
+                m.set_status(protocol::TransactionStatus::tsNEW);
+                env.app().overlay().relay(uint256{hash}, m, toSkip);
+            }
+        };
+        auto waitFor = [&](std::size_t count) {
+            for (int i = 0; i < 200 && PeerTest::batches().size() < count; ++i)
+                std::this_thread::sleep_for(10ms);
+            return PeerTest::batches();
+        };
+        auto shared = [&](std::size_t i, std::size_t j) {
+            std::lock_guard lock(PeerTest::sentMutex_);
+            return PeerTest::sent_.size() > std::max(i, j) &&
+                PeerTest::sent_[i] == PeerTest::sent_[j];
+        };
+
+        // A batch short of full is sent once the window has passed. The
+        // peers sent the same transactions share one message.
+        auto const start = steady_clock::now();
+        relay(3);
+        BEAST_EXPECT(waitFor(3) == (std::vector<int>{3, 3, 3}));
+        BEAST_EXPECT(steady_clock::now() - start >= Tuning::txBatchWindow);
+        BEAST_EXPECT(shared(0, 1) && shared(0, 2));
+
+        // A peer that has a transaction already is sent the others
+        PeerTest::init();
+        relay(1, {peers[0]->id()});
+        relay(2);
+        auto batches = waitFor(3);
+        std::sort(batches.begin(), batches.end());
+        BEAST_EXPECT(batches == (std::vector<int>{2, 3, 3}));
+        BEAST_EXPECT(shared(0, 1) + shared(0, 2) + shared(1, 2) == 1);
+
+        // A full batch is sent at once, and the rest when the window passes
+        PeerTest::init();
+        relay(Tuning::txBatchMessages + 1);
+        auto const full = Tuning::txBatchMessages;
+        BEAST_EXPECT(
+            waitFor(6) == (std::vector<int>{full, full, full, 1, 1, 1}));
+    }
+
+    void
+    testBatchReceive()
+    {
+        testcase("tx batching receive");
+        using namespace jtx;
+
+        Env env(*this);
+        env.app().config().TX_BATCH = true;
+        Account const alice("alice");
+        Account const bob("bob");
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        lid_ = 0;
+        rid_ = 1;
+        auto const peer =
+            addBatchPeer(env, std::get<0>(randomKeyPair(KeyType::ed25519)));
+        auto receive = [&](std::shared_ptr<protocol::TMTransactions> const& m) {
+            peer->onMessage(m);
+            env.app().getJobQueue().rendezvous();
+        };
+
+        // A batch is checked and applied as a whole
+        auto seq = env.seq(alice);
+        receive(makeBatch(env, alice, 3));
+        BEAST_EXPECT(env.seq(alice) == seq + 3);
+
+        // A batch larger than a peer sends is refused. Its transactions
+        // are not marked as seen, so they are taken from a smaller one.
+        seq = env.seq(alice);
+        receive(makeBatch(env, alice, 3, Tuning::txBatchMessages - 2));
+        BEAST_EXPECT(env.seq(alice) == seq);
+        receive(makeBatch(env, alice, 3, Tuning::txBatchMessages - 3));
+        BEAST_EXPECT(env.seq(alice) == seq + 3);
+
+        // Each transaction counts against MAX_TRANSACTIONS. Those that do
+        // not fit are taken when they are relayed again.
+        env.app().config().MAX_TRANSACTIONS = 2;
+        seq = env.seq(alice);
+        auto const batch = makeBatch(env, alice, 3);
+        receive(batch);
+        BEAST_EXPECT(env.seq(alice) == seq + 2);
+        receive(batch);
+        BEAST_EXPECT(env.seq(alice) == seq + 3);
+        env.app().config().MAX_TRANSACTIONS = 1000;
+
+        // Transactions relayed by a cluster peer may pay the normal fee
+        // while the local fee is raised; those of other peers may not.
+        auto const clusterKey = std::get<0>(randomKeyPair(KeyType::ed25519));
+        env.app().cluster().update(clusterKey, "cluster peer");
+        auto const clusterPeer = addBatchPeer(env, clusterKey);
+        auto const aliceSeq = env.seq(alice);
+        auto const bobSeq = env.seq(bob);
+        auto const untrusted = makeBatch(env, alice, 1);
+        auto const trusted = makeBatch(env, bob, 1);
+        raiseLocalFee(env);
+        receive(untrusted);
+        clusterPeer->onMessage(trusted);
+        env.app().getJobQueue().rendezvous();
+        BEAST_EXPECT(env.seq(alice) == aliceSeq);
+        BEAST_EXPECT(env.seq(bob) == bobSeq + 1);
+        while (env.app().getFeeTrack().lowerLocalFee())
+            ;
+    }
+
+    void
+    testProcessTransactionSet()
+    {
+        testcase("process transaction set");
+        using namespace jtx;
+
+        Env env(*this);
+        Account const alice("alice");
+        Account const bob("bob");
+        Account const carol("carol");
+        env.fund(XRP(10000), alice, bob, carol);
+        env.close();
+
+        auto makeSet = [&](Account const& account, std::size_t count) {
+            std::vector<std::shared_ptr<Transaction>> set;
+            auto const first = env.seq(account);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                std::string reason;
+                set.push_back(std::make_shared<Transaction>(
+                    env.jt(noop(account), jtx::seq(first + i)).stx,
+                    reason,
+                    env.app()));
+            }
+            return set;
+        };
+        auto process = [&](std::vector<std::shared_ptr<Transaction>> set,
+                           bool unlimited) {
+            env.app().getOPs().processTransactionSet(set, unlimited);
+            env.app().getJobQueue().rendezvous();
+        };
+
+        // The transactions of a set are applied together
+        auto seq = env.seq(alice);
+        process(makeSet(alice, 4), false);
+        BEAST_EXPECT(env.seq(alice) == seq + 4);
+
+        // A transaction known to be bad is left out, with those that
+        // follow it in sequence
+        seq = env.seq(carol);
+        auto set = makeSet(carol, 3);
+        env.app().getHashRouter().setFlags(set[1]->getID(), SF_BAD);
+        process(set, false);
+        BEAST_EXPECT(env.seq(carol) == seq + 1);
+        BEAST_EXPECT(set[1]->getStatus() == INVALID);
+
+        // A set from a trusted source may pay the normal fee while the
+        // local fee is raised; an untrusted one may not.
+        auto const aliceSeq = env.seq(alice);
+        auto const bobSeq = env.seq(bob);
+        auto const untrusted = makeSet(alice, 1);
+        auto const trusted = makeSet(bob, 1);
+        raiseLocalFee(env);
+        process(untrusted, false);
+        process(trusted, true);
+        BEAST_EXPECT(env.seq(alice) == aliceSeq);
+        BEAST_EXPECT(env.seq(bob) == bobSeq + 1);
+        while (env.app().getFeeTrack().lowerLocalFee())
+            ;
+    }
+
     void
     run() override
     {
         bool log = false;
         std::set<Peer::id_t> skip = {0, 1, 2, 3, 4};
         testConfig(log);
+        testBatchHandshake();
+        testBatchSend();
+        testBatchReceive();
+        testProcessTransactionSet();
         // relay to all peers, no hash queue
         testRelay("feature disabled", false, 10, 0, 10, 25, 10, 0);
         // relay to nPeers - skip (10-5=5)
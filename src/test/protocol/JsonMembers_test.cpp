@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/json/Output.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/JsonMembers.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class JsonMembers_test : public beast::unit_test::suite
+{
+    // Check that obj is written exactly as the Json::Value of its fields
+    // would be. What overrides of getJson add, such as the hash of an STTx
+    // or the index of an STLedgerEntry, is left to the caller.
+    void
+    expectSame(STObject const& obj, JsonOptions options = JsonOptions::none)
+    {
+        auto const expected = to_string(obj.STObject::getJson(options));
+
+        JsonMembers members(obj, options);
+        BEAST_EXPECT(to_string(members.raw()) == expected);
+        BEAST_EXPECT(to_string(members.object()) == expected);
+
+        std::string text;
+        members.write(text);
+        BEAST_EXPECT(text == expected);
+    }
+
+    void
+    testLedger()
+    {
+        testcase("transactions, metadata and ledger entries");
+
+        using namespace jtx;
+        Env env{*this};
+        Account const gw{"gateway"};
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        auto const USD = gw["USD"];
+
+        env.fund(XRP(10000), gw, alice, bob);
+        env.close();
+        env(trust(alice, USD(1000)));
+        env(trust(bob, USD(1000)));
+        env.close();
+        env(pay(gw, alice, USD(100)), memo("6461746131", "", "7479706531"));
+        env(pay(alice, bob, USD(12.5)));
+        env(offer(alice, XRP(100), USD(10)));
+        env(offer(bob, USD(5), XRP(50)));
+        env.close();
+
+        std::size_t txs = 0;
+        for (auto const& [tx, meta] : env.closed()->txs)
+        {
+            expectSame(*tx);
+            expectSame(*meta);
+            expectSame(*meta, JsonOptions::include_date);
+            ++txs;
+        }
+        BEAST_EXPECT(txs == 4);
+
+        for (auto const& sle : env.closed()->sles)
+            expectSame(*sle);
+    }
+
+    void
+    testMembers()
+    {
+        testcase("members");
+
+        using namespace jtx;
+        Env env{*this};
+        env.fund(XRP(1000), "alice");
+        env.close();
+
+        auto const tx = env.closed()->txs.begin()->first;
+
+        // members are merged with the fields, in order, and replace them
+        Json::Value expected = tx->STObject::getJson(JsonOptions::none);
+        expected[jss::Account] = "replaced";
+        expected[jss::date] = 42;
+        expected[jss::hash] = "a\"b\n/c";
+
+        JsonMembers members(*tx);
+        members[jss::date] = 1;
+        members[jss::Account] = "replaced";
+        members[jss::hash] = "a\"b\n/c";
+        members[jss::date] = 42;
+        BEAST_EXPECT(to_string(members.raw()) == to_string(expected));
+        BEAST_EXPECT(to_string(members.object()) == to_string(expected));
+
+        Json::Value only = Json::objectValue;
+        only[jss::validated] = true;
+        JsonMembers empty;
+        empty[jss::validated] = true;
+        BEAST_EXPECT(to_string(empty.raw()) == to_string(only));
+    }
+
+    void
+    testRawValue()
+    {
+        testcase("raw values");
+
+        Json::Value inner = Json::objectValue;
+        inner[jss::Account] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
+        inner[jss::Flags] = 0;
+        auto const text = to_string(inner);
+
+        Json::Value raw{Json::RawJson{text}};
+        BEAST_EXPECT(raw.isRaw());
+        BEAST_EXPECT(raw.type() == Json::rawValue);
+        BEAST_EXPECT(raw.asRawText() == text);
+
+        Json::Value copy = raw;
+        BEAST_EXPECT(copy == raw);
+        BEAST_EXPECT(copy.asRawText() == text);
+
+        Json::Value withRaw = Json::objectValue;
+        Json::Value withValue = Json::objectValue;
+        withRaw[jss::tx] = raw;
+        withValue[jss::tx] = inner;
+
+        // every writer emits the text as is, so the documents are identical
+        BEAST_EXPECT(to_string(withRaw) == to_string(withValue));
+
+        std::string streamed;
+        Json::stream(withRaw, [&streamed](void const* data, std::size_t n) {
+            streamed.append(static_cast<char const*>(data), n);
+        });
+        BEAST_EXPECT(streamed == to_string(withValue));
+
+        std::string output;
+        Json::outputJson(withRaw, Json::stringOutput(output));
+        BEAST_EXPECT(output == to_string(withValue));
+
+        Json::StyledWriter styled;
+        BEAST_EXPECT(styled.write(withRaw).find(text) != std::string::npos);
+    }
+
+public:
+    void
+    run() override
+    {
+        testLedger();
+        testMembers();
+        testRawValue();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JsonMembers, protocol, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -20,6 +20,8 @@
 #include <ripple/beast/unit_test.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/digest.h>
+#include <algorithm>
 #include <vector>
 
 namespace ripple {
@@ -453,12 +455,80 @@ public:
         BEAST_EXPECT(pk1 == pk3);
     }
 
+    void
+    testVerifyBatch()
+    {
+        testcase("Batch verification");
+
+        auto const ed = randomKeyPair(KeyType::ed25519);
+        auto const secp = randomKeyPair(KeyType::secp256k1);
+
+        // enough ed25519 signatures for several batches
+        std::size_t const count = 300;
+        std::vector<std::string> messages;
+        std::vector<Buffer> sigs;
+        std::vector<bool> expected;
+        messages.reserve(count);
+        sigs.reserve(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const& [pk, sk] = (i % 5 == 0) ? secp : ed;
+            messages.push_back("message " + std::to_string(i));
+            auto sig = sign(pk, sk, makeSlice(messages.back()));
+
+            // spoil some signatures, and some messages
+            if (i % 17 == 3)
+                sig.data()[10] ^= 0x01;
+            if (i % 23 == 7)
+                messages.back() += "!";
+
+            sigs.push_back(std::move(sig));
+            expected.push_back(i % 17 != 3 && i % 23 != 7);
+        }
+
+        std::vector<SignatureCheck> checks;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const& pk = (i % 5 == 0) ? secp.first : ed.first;
+            checks.push_back(
+                {pk, makeSlice(messages[i]), std::nullopt, Slice{sigs[i]}});
+            BEAST_EXPECT(
+                verify(pk, checks.back().message, checks.back().signature) ==
+                expected[i]);
+        }
+
+        // digest signatures are only made with secp256k1 keys
+        auto const digest = sha512Half(makeSlice(messages[1]));
+        auto const digestSig = signDigest(secp.first, secp.second, digest);
+        checks.push_back({secp.first, {}, digest, Slice{digestSig}});
+        expected.push_back(true);
+        checks.push_back({ed.first, {}, digest, Slice{sigs[1]}});
+        expected.push_back(false);
+
+        BEAST_EXPECT(verifyBatch(checks) == expected);
+
+        // a batch made only of good signatures
+        std::vector<SignatureCheck> good;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (expected[i] && i % 5 != 0)
+                good.push_back(checks[i]);
+        }
+        auto const results = verifyBatch(good);
+        BEAST_EXPECT(std::all_of(
+            results.begin(), results.end(), [](bool ok) { return ok; }));
+
+        BEAST_EXPECT(verifyBatch({}).empty());
+    }
+
     void
     run() override
     {
         testBase58();
         testCanonical();
         testMiscOperations();
+        testVerifyBatch();
     }
 };
 
@@ -20,6 +20,7 @@
 #include <ripple/app/hook/Enum.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
@@ -67,6 +68,14 @@ class AccountTx_test : public beast::unit_test::suite
         }
     };
 
+    // Transactions are stored in SQLite, or with the txindex backend in dir
+    static std::unique_ptr<Config>
+    makeConfig(bool txIndex, beast::temp_dir const& dir)
+    {
+        using namespace test::jtx;
+        return txIndex ? envconfig(txindex, dir.path()) : envconfig();
+    }
+
     // A helper method tests can use to validate returned JSON vs NodeSanity.
     void
     checkSanity(Json::Value const& txNode, NodeSanity const& sane)
@@ -111,11 +120,15 @@ class AccountTx_test : public beast::unit_test::suite
     };
 
     void
-    testParameters()
+    testParameters(bool txIndex)
     {
         using namespace test::jtx;
 
-        Env env(*this, supported_amendments() - featureXahauGenesis);
+        beast::temp_dir dir;
+        Env env(
+            *this,
+            makeConfig(txIndex, dir),
+            supported_amendments() - featureXahauGenesis);
         Account A1{"A1"};
         env.fund(XRP(10000), A1);
         env.close();
@@ -248,14 +261,18 @@ class AccountTx_test : public beast::unit_test::suite
     }
 
     void
-    testContents()
+    testContents(bool txIndex)
     {
         // Get results for all transaction types that can be associated
         // with an account.  Start by generating all transaction types.
         using namespace test::jtx;
         using namespace std::chrono_literals;
 
-        Env env(*this, supported_amendments() - featureXahauGenesis);
+        beast::temp_dir dir;
+        Env env(
+            *this,
+            makeConfig(txIndex, dir),
+            supported_amendments() - featureXahauGenesis);
         Account const alice{"alice"};
         Account const alie{"alie"};
         Account const gw{"gw"};
@@ -644,7 +661,7 @@ class AccountTx_test : public beast::unit_test::suite
     }
 
     void
-    testAccountDelete()
+    testAccountDelete(bool txIndex)
     {
         // Verify that if an account is resurrected then the account_tx RPC
         // command still recovers all transactions on that account before
@@ -652,7 +669,11 @@ class AccountTx_test : public beast::unit_test::suite
         using namespace test::jtx;
         using namespace std::chrono_literals;
 
-        Env env(*this, supported_amendments() - featureXahauGenesis);
+        beast::temp_dir dir;
+        Env env(
+            *this,
+            makeConfig(txIndex, dir),
+            supported_amendments() - featureXahauGenesis);
         Account const alice{"alice"};
         Account const becky{"becky"};
 
@@ -780,9 +801,13 @@ public:
     void
     run() override
     {
-        testParameters();
-        testContents();
-        testAccountDelete();
+        for (bool const txIndex : {false, true})
+        {
+            testcase(txIndex ? "txindex" : "sqlite");
+            testParameters(txIndex);
+            testContents(txIndex);
+            testAccountDelete(txIndex);
+        }
     }
 };
 BEAST_DEFINE_TESTSUITE(AccountTx, app, ripple);
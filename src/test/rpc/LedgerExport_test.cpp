@@ -0,0 +1,459 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/impl/StateExportWriter.h>
+#include <test/jtx.h>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/multi_buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <future>
+#include <optional>
+#include <sstream>
+
+namespace ripple {
+
+class LedgerExport_test : public beast::unit_test::suite
+{
+    // The frames of an export, decoded
+    struct Decoded
+    {
+        std::uint32_t seq = 0;
+        uint256 hash;
+        uint256 accountHash;
+        std::vector<std::pair<uint256, Blob>> entries;
+        std::optional<std::uint64_t> count;
+        std::optional<uint256> resume;
+        std::optional<std::string> error;
+        std::size_t frames = 0;
+        bool valid = true;
+    };
+
+    static Decoded
+    decode(std::string const& data)
+    {
+        Decoded d;
+        SerialIter sit(makeSlice(data));
+        try
+        {
+            while (!sit.empty())
+            {
+                // Nothing may follow the end or error frame
+                if (d.count || d.error)
+                    Throw<std::runtime_error>("trailing frame");
+
+                auto const type = static_cast<StateExport::Frame>(sit.get8());
+                auto const length = sit.get32();
+                SerialIter payload(sit.getSlice(length));
+
+                // The header is always first, and only first
+                if ((type == StateExport::Frame::header) != (d.frames == 0))
+                    Throw<std::runtime_error>("misplaced header");
+                ++d.frames;
+
+                switch (type)
+                {
+                    case StateExport::Frame::header:
+                        d.seq = payload.get32();
+                        d.hash = payload.get256();
+                        d.accountHash = payload.get256();
+                        break;
+                    case StateExport::Frame::entries:
+                        if (payload.empty())
+                            Throw<std::runtime_error>("empty entries");
+                        while (!payload.empty())
+                        {
+                            auto const key = payload.get256();
+                            auto const size = payload.get32();
+                            auto const blob = payload.getSlice(size);
+                            d.entries.emplace_back(
+                                key, Blob(blob.begin(), blob.end()));
+                        }
+                        break;
+                    case StateExport::Frame::end:
+                        d.count = payload.get64();
+                        if (!payload.empty())
+                            d.resume = payload.get256();
+                        break;
+                    case StateExport::Frame::error: {
+                        auto const s = payload.getSlice(payload.getBytesLeft());
+                        d.error.emplace(s.begin(), s.end());
+                        break;
+                    }
+                    default:
+                        Throw<std::runtime_error>("unknown frame");
+                }
+
+                if (!payload.empty())
+                    Throw<std::runtime_error>("frame too long");
+            }
+            if (!d.count && !d.error)
+                Throw<std::runtime_error>("missing end");
+        }
+        catch (std::exception const&)
+        {
+            d.valid = false;
+        }
+        return d;
+    }
+
+    // Every state entry of the ledger, in key order
+    static std::vector<std::pair<uint256, Blob>>
+    stateOf(Ledger const& ledger)
+    {
+        std::vector<std::pair<uint256, Blob>> state;
+        for (auto const& item : ledger.stateMap())
+            state.emplace_back(
+                item.key(), Blob(item.slice().begin(), item.slice().end()));
+        return state;
+    }
+
+    static std::shared_ptr<Ledger const>
+    populate(test::jtx::Env& env, int accounts)
+    {
+        using namespace test::jtx;
+        for (int i = 0; i < accounts; ++i)
+            env.fund(XRP(1000), Account{"alice" + std::to_string(i)});
+        env.close();
+        return env.app().getLedgerMaster().getClosedLedger();
+    }
+
+    static std::string
+    exportAll(StateExport& state, std::size_t bytes)
+    {
+        std::string data;
+        Serializer s;
+        bool more;
+        do
+        {
+            s.erase();
+            more = state.next(s, bytes);
+            data.append(static_cast<char const*>(s.data()), s.size());
+        } while (more);
+        return data;
+    }
+
+    void
+    testFrames()
+    {
+        testcase("Frames");
+
+        using namespace test::jtx;
+        Env env{*this};
+        auto const ledger = populate(env, 20);
+        if (!BEAST_EXPECT(ledger && ledger->isImmutable()))
+            return;
+
+        std::ostringstream out;
+        BEAST_EXPECT(exportState(ledger, out));
+        auto const d = decode(out.str());
+        BEAST_EXPECT(d.valid);
+        BEAST_EXPECT(d.seq == ledger->info().seq);
+        BEAST_EXPECT(d.hash == ledger->info().hash);
+        BEAST_EXPECT(d.accountHash == ledger->info().accountHash);
+        BEAST_EXPECT(!d.error);
+        BEAST_EXPECT(!d.resume);
+
+        auto const state = stateOf(*ledger);
+        BEAST_EXPECT(d.entries == state);
+        BEAST_EXPECT(d.count && *d.count == state.size());
+
+        // Small frames hold the same entries
+        StateExport small(ledger);
+        auto const ds = decode(exportAll(small, 64));
+        BEAST_EXPECT(ds.valid);
+        BEAST_EXPECT(ds.frames > d.frames);
+        BEAST_EXPECT(ds.entries == state);
+        BEAST_EXPECT(small.count() == state.size());
+        BEAST_EXPECT(!small.failed());
+    }
+
+    void
+    testResume()
+    {
+        testcase("Resume");
+
+        using namespace test::jtx;
+        Env env{*this};
+        auto const ledger = populate(env, 20);
+        if (!BEAST_EXPECT(ledger))
+            return;
+        auto const state = stateOf(*ledger);
+        BEAST_EXPECT(state.size() > 10);
+
+        // Follow the marker in steps of three entries
+        std::vector<std::pair<uint256, Blob>> entries;
+        uint256 marker;
+        std::size_t exports = 0;
+        for (;;)
+        {
+            StateExport part(ledger, marker, 3);
+            auto const d = decode(exportAll(part, 1024));
+            ++exports;
+            if (!BEAST_EXPECT(d.valid && d.count))
+                return;
+            BEAST_EXPECT(*d.count == d.entries.size());
+            BEAST_EXPECT(*d.count <= 3);
+            BEAST_EXPECT(d.seq == ledger->info().seq);
+            entries.insert(entries.end(), d.entries.begin(), d.entries.end());
+            if (!d.resume)
+                break;
+            BEAST_EXPECT(*d.count == 3);
+            BEAST_EXPECT(*d.resume == d.entries.back().first);
+            marker = *d.resume;
+        }
+        BEAST_EXPECT(entries == state);
+        BEAST_EXPECT(exports == (state.size() + 2) / 3);
+
+        // A limit equal to the remaining entries has nothing to resume
+        StateExport all(ledger, beast::zero, state.size());
+        auto const d = decode(exportAll(all, 1024));
+        BEAST_EXPECT(d.count && *d.count == state.size());
+        BEAST_EXPECT(!d.resume);
+
+        // Resuming from the last key exports nothing
+        StateExport none(ledger, state.back().first);
+        auto const dn = decode(exportAll(none, 1024));
+        BEAST_EXPECT(dn.valid);
+        BEAST_EXPECT(dn.entries.empty());
+        BEAST_EXPECT(dn.count && *dn.count == 0);
+    }
+
+    // Decode the body of a chunked HTTP response
+    static std::optional<std::string>
+    unchunk(std::string const& response)
+    {
+        auto pos = response.find("\r\n\r\n");
+        if (pos == std::string::npos)
+            return std::nullopt;
+        pos += 4;
+
+        std::string body;
+        for (;;)
+        {
+            auto const eol = response.find("\r\n", pos);
+            if (eol == std::string::npos)
+                return std::nullopt;
+            auto const size = std::stoul(
+                response.substr(pos, eol - pos), nullptr, 16);
+            pos = eol + 2;
+            if (size == 0)
+                break;
+            if (response.compare(pos + size, 2, "\r\n") != 0)
+                return std::nullopt;
+            body.append(response, pos, size);
+            pos += size + 2;
+        }
+        if (response.compare(pos, std::string::npos, "\r\n") != 0)
+            return std::nullopt;
+        return body;
+    }
+
+    void
+    testWriter()
+    {
+        testcase("Writer");
+
+        using namespace test::jtx;
+        Env env{*this};
+        auto const ledger = populate(env, 20);
+        if (!BEAST_EXPECT(ledger))
+            return;
+
+        std::size_t constexpr chunkBytes = 512;
+        RPC::StateExportWriter writer(
+            env.app().getJobQueue(), StateExport(ledger), chunkBytes);
+
+        auto const take = [&writer](std::size_t most) {
+            std::string s;
+            for (auto const& b : writer.data())
+                s.append(static_cast<char const*>(b.data()), b.size());
+            s.resize(std::min(s.size(), most));
+            writer.consume(s.size());
+            return s;
+        };
+
+        // The status line and headers are ready before any state is read
+        BEAST_EXPECT(!writer.complete());
+        BEAST_EXPECT(writer.prepare(0, [] {}));
+        std::string response = take(std::string::npos);
+        BEAST_EXPECT(
+            response.find("Transfer-Encoding: chunked") != std::string::npos);
+
+        std::size_t chunks = 0;
+        while (!writer.complete())
+        {
+            // The next chunk is only read once the last one was consumed
+            std::promise<void> resumed;
+            if (!BEAST_EXPECT(!writer.prepare(0, [&] { resumed.set_value(); })))
+                return;
+            if (!BEAST_EXPECT(
+                    resumed.get_future().wait_for(std::chrono::seconds(10)) ==
+                    std::future_status::ready))
+                return;
+            ++chunks;
+
+            // A partly consumed chunk holds off the next one
+            while (boost::asio::buffer_size(writer.data()) != 0)
+            {
+                bool called = false;
+                BEAST_EXPECT(writer.prepare(0, [&] { called = true; }));
+                BEAST_EXPECT(!called);
+                response += take(100);
+            }
+        }
+
+        // Each chunk but the last is about chunkBytes of frames
+        std::ostringstream out;
+        exportState(ledger, out);
+        BEAST_EXPECT(chunks > out.str().size() / (chunkBytes + 4096));
+        BEAST_EXPECT(chunks > 2);
+
+        auto const body = unchunk(response);
+        if (!BEAST_EXPECT(body))
+            return;
+        auto const d = decode(*body);
+        BEAST_EXPECT(d.valid);
+        BEAST_EXPECT(d.entries == stateOf(*ledger));
+        BEAST_EXPECT(d.count && *d.count == d.entries.size());
+    }
+
+    // Send a request for ledger_export over HTTP
+    static std::pair<unsigned, std::string>
+    request(Config const& cfg, Json::Value const& params)
+    {
+        using namespace boost::asio;
+        namespace http = boost::beast::http;
+
+        auto const& section = cfg["port_rpc"];
+        ip::tcp::endpoint const ep{
+            ip::make_address(get(section, "ip")),
+            get<std::uint16_t>(section, "port", 0)};
+
+        io_service ios;
+        ip::tcp::socket stream{ios};
+        stream.connect(ep);
+
+        Json::Value jr;
+        jr[jss::method] = "ledger_export";
+        jr[jss::params] = Json::arrayValue;
+        jr[jss::params].append(params);
+
+        http::request<http::string_body> req{http::verb::post, "/", 11};
+        req.set(http::field::host, "localhost");
+        req.set(http::field::content_type, "application/json");
+        req.body() = to_string(jr);
+        req.prepare_payload();
+        http::write(stream, req);
+
+        boost::beast::multi_buffer buffer;
+        http::response_parser<http::string_body> parser;
+        parser.body_limit(64 * 1024 * 1024);
+        http::read(stream, buffer, parser);
+        return {parser.get().result_int(), parser.get().body()};
+    }
+
+    void
+    testRPC()
+    {
+        testcase("RPC");
+
+        using namespace test::jtx;
+        Env env{*this};
+        auto const ledger = populate(env, 10);
+        if (!BEAST_EXPECT(ledger))
+            return;
+        auto const state = stateOf(*ledger);
+
+        Json::Value params;
+        params[jss::ledger_index] = ledger->info().seq;
+
+        {
+            // Without an HTTP connection to stream to
+            auto const jrr = env.rpc(
+                "json", "ledger_export", to_string(params))[jss::result];
+            BEAST_EXPECT(jrr[jss::error] == "notSupported");
+        }
+        {
+            auto const [status, body] = request(env.app().config(), params);
+            BEAST_EXPECT(status == 200);
+            auto const d = decode(body);
+            BEAST_EXPECT(d.valid);
+            BEAST_EXPECT(d.seq == ledger->info().seq);
+            BEAST_EXPECT(d.entries == state);
+        }
+        {
+            // A limit beyond the range of a signed integer
+            auto p = params;
+            p[jss::limit] = Json::UInt(3000000000u);
+            auto const [status, body] = request(env.app().config(), p);
+            BEAST_EXPECT(status == 200);
+            auto const d = decode(body);
+            BEAST_EXPECT(d.valid && d.entries == state && !d.resume);
+        }
+        {
+            // A zero limit is raised to one entry, with the marker given
+            auto p = params;
+            p[jss::limit] = 0;
+            p[jss::marker] = to_string(state[1].first);
+            auto const [status, body] = request(env.app().config(), p);
+            BEAST_EXPECT(status == 200);
+            auto const d = decode(body);
+            BEAST_EXPECT(d.valid && d.entries.size() == 1);
+            BEAST_EXPECT(d.entries.front() == state[2]);
+            BEAST_EXPECT(d.resume && *d.resume == state[2].first);
+        }
+        {
+            auto p = params;
+            p[jss::limit] = -1;
+            auto const [status, body] = request(env.app().config(), p);
+            Json::Value jv;
+            BEAST_EXPECT(Json::Reader().parse(body, jv));
+            BEAST_EXPECT(
+                jv[jss::result][jss::error_message] ==
+                "Invalid field 'limit', not unsigned integer.");
+        }
+        {
+            auto p = params;
+            p[jss::marker] = "not a marker";
+            auto const [status, body] = request(env.app().config(), p);
+            Json::Value jv;
+            BEAST_EXPECT(Json::Reader().parse(body, jv));
+            BEAST_EXPECT(jv[jss::result][jss::error] == "invalidParams");
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testFrames();
+        testResume();
+        testWriter();
+        testRPC();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerExport, app, ripple);
+
+}  // namespace ripple
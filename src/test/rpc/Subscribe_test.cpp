@@ -289,6 +289,71 @@ public:
         BEAST_EXPECT(jv[jss::status] == "success");
     }
 
+    void
+    testSharedMessages()
+    {
+        testcase("Transactions published to many subscribers");
+
+        using namespace std::chrono_literals;
+        using namespace jtx;
+        Env env(*this);
+        Account const gw{"gw"};
+        Account const alice{"alice"};
+        auto const USD = gw["USD"];
+        env.fund(XRP(10000), gw, alice);
+        env(trust(alice, USD(1000)));
+        env.close();
+
+        Json::Value transactions;
+        transactions[jss::streams] = Json::arrayValue;
+        transactions[jss::streams].append("transactions");
+
+        Json::Value accounts;
+        accounts[jss::accounts] = Json::arrayValue;
+        accounts[jss::accounts].append(alice.human());
+
+        Json::Value books;
+        books[jss::books] = Json::arrayValue;
+        {
+            auto& book = books[jss::books].append(Json::objectValue);
+            book[jss::taker_gets][jss::currency] = "XAH";
+            book[jss::taker_pays][jss::currency] = "USD";
+            book[jss::taker_pays][jss::issuer] = gw.human();
+        }
+
+        // every stream, with clients of both API versions
+        std::vector<std::unique_ptr<WSClient>> clients;
+        for (auto const& stream : {transactions, accounts, books})
+        {
+            for (unsigned const version : {1u, 2u})
+            {
+                auto& client = clients.emplace_back(
+                    makeWSClient(env.app().config(), true, version));
+                auto const jv = client->invoke("subscribe", stream);
+                BEAST_EXPECT(jv[jss::status] == "success");
+            }
+        }
+
+        env(offer(alice, USD(10), XRP(100)));
+        env.close();
+
+        std::optional<Json::Value> first;
+        for (auto& client : clients)
+        {
+            auto const jv = client->findMsg(5s, [&](auto const& jv) {
+                return jv[jss::transaction][jss::TransactionType] ==
+                    jss::OfferCreate;
+            });
+            if (!BEAST_EXPECT(jv))
+                continue;
+            BEAST_EXPECT((*jv)[jss::meta].isMember("AffectedNodes"));
+            if (!first)
+                first = jv;
+            else
+                BEAST_EXPECT(*jv == *first);
+        }
+    }
+
     void
     testManifests()
     {
@@ -1148,6 +1213,7 @@ public:
         testServer();
         testLedger();
         testTransactions();
+        testSharedMessages();
         testManifests();
         testValidations(all - xrpFees);
         testValidations(all);
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/app/rdb/backend/SQLiteDatabase.h>
+#include <ripple/beast/utility/temp_dir.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/CTID.h>
@@ -42,9 +43,10 @@ class Transaction_test : public beast::unit_test::suite
     }
 
     void
-    testRangeRequest(FeatureBitset features)
+    testRangeRequest(FeatureBitset features, bool txIndex)
     {
-        testcase("Test Range Request");
+        testcase(
+            std::string("Test Range Request") + (txIndex ? " txindex" : ""));
 
         using namespace test::jtx;
         using std::to_string;
@@ -56,7 +58,11 @@ class Transaction_test : public beast::unit_test::suite
         const char* EXCESSIVE =
             RPC::get_error_info(rpcEXCESSIVE_LGR_RANGE).token;
 
-        Env env{*this, features};
+        beast::temp_dir dir;
+        Env env{
+            *this,
+            txIndex ? envconfig(txindex, dir.path()) : envconfig(),
+            features};
         auto const alice = Account("alice");
         env.fund(XRP(1000), alice);
         env.close();
@@ -731,7 +737,8 @@ public:
     void
     testWithFeats(FeatureBitset features)
     {
-        testRangeRequest(features);
+        testRangeRequest(features, false);
+        testRangeRequest(features, true);
         testRangeCTIDRequest(features);
         testCTIDValidation(features);
         testCTIDRPC(features);
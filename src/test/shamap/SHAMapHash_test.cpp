@@ -0,0 +1,357 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Slice.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace ripple {
+namespace tests {
+
+namespace {
+
+uint256
+randomKey(beast::xor_shift_engine& rng)
+{
+    uint256 key;
+    for (auto& b : key)
+        b = static_cast<std::uint8_t>(rng());
+    return key;
+}
+
+Blob
+randomData(beast::xor_shift_engine& rng, std::size_t size)
+{
+    Blob data(size);
+    for (auto& b : data)
+        b = static_cast<std::uint8_t>(rng());
+    return data;
+}
+
+// The inner nodes of a map, by depth
+std::vector<std::vector<SHAMapInnerNode*>>
+innerLevels(SHAMap const& map)
+{
+    std::vector<std::vector<SHAMapInnerNode*>> levels(1);
+    map.visitNodes([&](SHAMapTreeNode& node) {
+        levels[0].push_back(static_cast<SHAMapInnerNode*>(&node));
+        return false;
+    });
+
+    while (!levels.back().empty())
+    {
+        std::vector<SHAMapInnerNode*> next;
+        for (auto const node : levels.back())
+        {
+            for (int b = 0; b < SHAMapInnerNode::branchFactor; ++b)
+            {
+                if (node->isEmptyBranch(b))
+                    continue;
+                if (auto child = node->getChildPointer(b);
+                    child && child->isInner())
+                    next.push_back(static_cast<SHAMapInnerNode*>(child));
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+    levels.pop_back();
+    return levels;
+}
+
+}  // namespace
+
+class SHAMapHash_test : public beast::unit_test::suite
+{
+    void
+    testBatch()
+    {
+        testcase("batched SHA512-Half");
+
+        beast::xor_shift_engine rng(1);
+
+        // sizes around the block and padding boundaries, and inner nodes
+        for (std::size_t size : {0, 1, 111, 112, 127, 128, 240, 516, 1000})
+        {
+            for (std::size_t count = 1; count <= 17; ++count)
+            {
+                std::vector<Blob> data;
+                std::vector<std::uint8_t const*> messages;
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    data.push_back(randomData(rng, size));
+                    messages.push_back(data.back().data());
+                }
+
+                std::vector<uint256> digests(count);
+                sha512HalfBatch(messages.data(), size, digests.data(), count);
+
+                bool same = true;
+                for (std::size_t i = 0; i < count; ++i)
+                    same &= digests[i] == sha512Half(makeSlice(data[i]));
+                BEAST_EXPECTS(same, std::to_string(size));
+            }
+        }
+    }
+
+    // Every node hash is what hashing the node by itself gives
+    bool
+    hashesValid(SHAMap const& map)
+    {
+        bool valid = true;
+        map.visitNodes([&](SHAMapTreeNode& node) {
+            auto const hash = node.getHash();
+            if (node.isInner())
+                static_cast<SHAMapInnerNode&>(node).updateHashDeep();
+            else
+                node.updateHash();
+            valid &= node.getHash() == hash;
+            return true;
+        });
+        return valid;
+    }
+
+    void
+    testRehash(bool backed)
+    {
+        testcase(std::string("rehash by level ") + (backed ? "backed" : ""));
+
+        using namespace beast::severities;
+        test::SuiteJournal journal("SHAMapHash_test", *this);
+
+        beast::xor_shift_engine rng(2);
+        std::vector<std::pair<uint256, Blob>> items;
+        for (int i = 0; i < 5000; ++i)
+            items.emplace_back(randomKey(rng), randomData(rng, 64 + i % 64));
+
+        TestNodeFamily f(journal);
+        SHAMap map(SHAMapType::FREE, f);
+        if (!backed)
+            map.setUnbacked();
+        for (auto const& [key, data] : items)
+            map.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                SHAMapItem{key, makeSlice(data)});
+
+        if (backed)
+            BEAST_EXPECT(map.flushDirty(hotACCOUNT_NODE) > 5000);
+        else
+            BEAST_EXPECT(map.unshare() > 5000);
+        BEAST_EXPECT(hashesValid(map));
+
+        // change some entries, leaving most of the tree shared
+        for (std::size_t i = 0; i < items.size(); i += 10)
+        {
+            items[i].second = randomData(rng, 100);
+            map.updateGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                std::make_shared<SHAMapItem const>(
+                    items[i].first, makeSlice(items[i].second)));
+        }
+        auto snap = map.snapShot(true);
+        for (std::size_t i = 5; i < items.size(); i += 10)
+            snap->delItem(items[i].first);
+
+        BEAST_EXPECT(map.getHash() != snap->getHash());
+        BEAST_EXPECT(hashesValid(map));
+        BEAST_EXPECT(hashesValid(*snap));
+
+        // the same contents, built in another order
+        TestNodeFamily f2(journal);
+        SHAMap other(SHAMapType::FREE, f2);
+        other.setUnbacked();
+        for (auto it = items.rbegin(); it != items.rend(); ++it)
+            other.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                SHAMapItem{it->first, makeSlice(it->second)});
+        BEAST_EXPECT(other.getHash() == map.getHash());
+    }
+
+    void
+    testParallelFlush()
+    {
+        testcase("parallel flush");
+
+        using namespace beast::severities;
+        test::SuiteJournal journal("SHAMapHash_test", *this);
+
+        beast::xor_shift_engine rng(4);
+        std::vector<std::pair<uint256, Blob>> items;
+        for (int i = 0; i < 5000; ++i)
+            items.emplace_back(randomKey(rng), randomData(rng, 80));
+
+        TestNodeFamily f1(journal);
+        TestNodeFamily f2(journal);
+        SHAMap serial(SHAMapType::FREE, f1);
+        SHAMap parallel(SHAMapType::FREE, f2);
+        for (auto map : {&serial, &parallel})
+            for (auto const& [key, data] : items)
+                map->addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    SHAMapItem{key, makeSlice(data)});
+
+        auto const flushed = serial.flushDirty(hotACCOUNT_NODE);
+        BEAST_EXPECT(parallel.flushDirty(hotACCOUNT_NODE, 4) == flushed);
+        BEAST_EXPECT(parallel.getHash() == serial.getHash());
+        BEAST_EXPECT(hashesValid(parallel));
+
+        // a few changes, some of them in the top two levels only
+        for (std::size_t i = 0; i < items.size(); i += 50)
+        {
+            auto const data = randomData(rng, 90);
+            for (auto map : {&serial, &parallel})
+                map->updateGiveItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    std::make_shared<SHAMapItem const>(
+                        items[i].first, makeSlice(data)));
+        }
+
+        BEAST_EXPECT(
+            parallel.flushDirty(hotACCOUNT_NODE, 4) ==
+            serial.flushDirty(hotACCOUNT_NODE));
+        BEAST_EXPECT(parallel.getHash() == serial.getHash());
+        BEAST_EXPECT(hashesValid(parallel));
+
+        // everything was written
+        SHAMap reloaded(SHAMapType::FREE, parallel.getHash().as_uint256(), f2);
+        BEAST_EXPECT(reloaded.fetchRoot(parallel.getHash(), nullptr));
+        BEAST_EXPECT(reloaded.deepCompare(parallel));
+    }
+
+public:
+    void
+    run() override
+    {
+        testBatch();
+        testRehash(false);
+        testRehash(true);
+        testParallelFlush();
+    }
+};
+
+// Measures rehashing a state map of a million leaves
+class SHAMapHashBench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        using clock_type = std::chrono::steady_clock;
+        using namespace std::chrono;
+
+        test::SuiteJournal journal("SHAMapHashBench_test", *this);
+
+        std::size_t const leaves = 1000000;
+
+        testcase(
+            "rehash " + std::to_string(leaves) + " leaves, " +
+            std::to_string(sha512HalfBatchLanes()) + " lanes");
+
+        beast::xor_shift_engine rng(3);
+        TestNodeFamily f(journal);
+        SHAMap map(SHAMapType::FREE, f);
+        map.setUnbacked();
+        std::vector<uint256> keys;
+        for (std::size_t i = 0; i < leaves; ++i)
+        {
+            keys.push_back(randomKey(rng));
+            map.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                SHAMapItem{keys.back(), makeSlice(randomData(rng, 120))});
+        }
+
+        auto report = [&](char const* what, auto start) {
+            log << "  " << what << ": "
+                << duration_cast<milliseconds>(clock_type::now() - start)
+                       .count()
+                << " ms" << std::endl;
+        };
+
+        auto start = clock_type::now();
+        map.unshare();
+        report("full rehash", start);
+        auto const hash = map.getHash();
+
+        // the same, flushed by several threads
+        {
+            auto const workers =
+                std::max(2u, std::thread::hardware_concurrency());
+            TestNodeFamily f2(journal);
+            SHAMap copy(SHAMapType::FREE, f2);
+            copy.setUnbacked();
+            map.visitLeaves([&](auto const& item) {
+                copy.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE, SHAMapItem{*item});
+            });
+            start = clock_type::now();
+            copy.flushDirty(hotACCOUNT_NODE, workers);
+            report(
+                ("full rehash, " + std::to_string(workers) + " workers")
+                    .c_str(),
+                start);
+            BEAST_EXPECT(copy.getHash() == hash);
+        }
+
+        for (std::size_t i = 0; i < leaves; i += 10)
+            map.updateGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                std::make_shared<SHAMapItem const>(
+                    keys[i], makeSlice(randomData(rng, 120))));
+        start = clock_type::now();
+        map.unshare();
+        report("rehash after changing 10%", start);
+
+        // the inner nodes alone, one at a time and a level at a time
+        auto const levels = innerLevels(map);
+        std::size_t inner = 0;
+        for (auto const& level : levels)
+            inner += level.size();
+        log << "  " << inner << " inner nodes in " << levels.size()
+            << " levels" << std::endl;
+
+        auto const changed = map.getHash();
+        BEAST_EXPECT(changed != hash);
+
+        start = clock_type::now();
+        for (auto it = levels.rbegin(); it != levels.rend(); ++it)
+            for (auto const node : *it)
+                node->updateHashDeep();
+        report("inner nodes, one by one", start);
+        BEAST_EXPECT(map.getHash() == changed);
+
+        start = clock_type::now();
+        for (auto it = levels.rbegin(); it != levels.rend(); ++it)
+            SHAMapInnerNode::updateHashesDeep(*it);
+        report("inner nodes, batched", start);
+        BEAST_EXPECT(map.getHash() == changed);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SHAMapHash, shamap, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapHashBench, shamap, ripple);
+
+}  // namespace tests
+}  // namespace ripple
@@ -0,0 +1,268 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Slice.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapAccountStateLeafNode.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace ripple {
+namespace tests {
+
+namespace {
+
+uint256
+randomKey(beast::xor_shift_engine& rng)
+{
+    uint256 key;
+    for (auto& b : key)
+        b = static_cast<std::uint8_t>(rng());
+    return key;
+}
+
+std::shared_ptr<SHAMapItem const>
+randomItem(beast::xor_shift_engine& rng, uint256 const& key)
+{
+    Blob data(120);
+    for (auto& b : data)
+        b = static_cast<std::uint8_t>(rng());
+    return std::make_shared<SHAMapItem const>(key, makeSlice(data));
+}
+
+}  // namespace
+
+class SHAMapNode_test : public beast::unit_test::suite
+{
+    void
+    testLookup()
+    {
+        testcase("lookup");
+
+        test::SuiteJournal journal("SHAMapNode_test", *this);
+        beast::xor_shift_engine rng(1);
+        TestNodeFamily f(journal);
+        SHAMap map(SHAMapType::FREE, f);
+        map.setUnbacked();
+
+        std::vector<uint256> keys;
+        for (int i = 0; i < 1000; ++i)
+        {
+            keys.push_back(randomKey(rng));
+            map.addGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE, randomItem(rng, keys.back()));
+        }
+        auto const snap = map.snapShot(false);
+
+        bool found = true;
+        for (auto const& key : keys)
+        {
+            found &= map.peekItem(key) && map.peekItem(key)->key() == key;
+            found &= snap->peekItem(key) == map.peekItem(key);
+        }
+        BEAST_EXPECT(found);
+        BEAST_EXPECT(!map.hasItem(randomKey(rng)));
+    }
+
+    void
+    testCachedNodes()
+    {
+        testcase("weakly cached nodes");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("SHAMapNode_test", *this);
+        beast::xor_shift_engine rng(2);
+        TestNodeFamily f(journal);
+        auto const& cache = *f.getTreeNodeCache(0);
+
+        auto const key = randomKey(rng);
+        auto const item = randomItem(rng, key);
+        SHAMapHash hash;
+        {
+            SHAMap map(SHAMapType::STATE, f);
+            map.addGiveItem(SHAMapNodeType::tnACCOUNT_STATE, item);
+            for (int i = 0; i < 100; ++i)
+                map.addGiveItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    randomItem(rng, randomKey(rng)));
+            map.flushDirty(hotACCOUNT_NODE);
+            hash = map.getHash();
+            BEAST_EXPECT(cache.getCacheSize() > 0);
+
+            // aged out of the cache, the nodes are still tracked while the
+            // map holds them
+            f.clock().advance(2min);
+            f.sweep();
+            BEAST_EXPECT(cache.getCacheSize() == 0);
+            BEAST_EXPECT(cache.getTrackSize() > 0);
+
+            // and another map finds them there
+            SHAMap other(SHAMapType::STATE, hash.as_uint256(), f);
+            BEAST_EXPECT(other.fetchRoot(hash, nullptr));
+            BEAST_EXPECT(other.peekItem(key) == item);
+        }
+
+        // fetching the root cached it again; once that ages out no map
+        // holds a node, and a node that is only tracked holds nothing
+        f.clock().advance(2min);
+        f.sweep();
+        BEAST_EXPECT(cache.getCacheSize() == 0);
+        BEAST_EXPECT(cache.getTrackSize() > 0);
+        BEAST_EXPECT(item.use_count() == 1);
+
+        f.sweep();
+        BEAST_EXPECT(cache.getTrackSize() == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testLookup();
+        testCachedNodes();
+    }
+};
+
+// Reports the memory taken by the nodes of a state map and the rate at
+// which keys are looked up in it.
+class SHAMapNodeBench_test : public beast::unit_test::suite
+{
+    // The bytes taken by an inner node, with its children arrays allocated
+    // the way TaggedPointer allocates them.
+    static std::size_t
+    innerBytes(int branchCount)
+    {
+        constexpr std::array<int, 4> boundaries{2, 4, 6, 16};
+        auto const capacity = *std::lower_bound(
+            boundaries.begin(), boundaries.end(), branchCount);
+        return sizeof(SHAMapInnerNode) +
+            capacity *
+            (sizeof(SHAMapHash) + sizeof(SharedIntrusive<SHAMapTreeNode>));
+    }
+
+public:
+    void
+    run() override
+    {
+        using clock_type = std::chrono::steady_clock;
+        using namespace std::chrono;
+
+        test::SuiteJournal journal("SHAMapNodeBench_test", *this);
+
+        std::size_t const leaves = 1000000;
+        testcase("state map of " + std::to_string(leaves) + " leaves");
+
+        beast::xor_shift_engine rng(3);
+        TestNodeFamily f(journal);
+        SHAMap map(SHAMapType::FREE, f);
+        map.setUnbacked();
+        std::vector<uint256> keys;
+        keys.reserve(leaves);
+        for (std::size_t i = 0; i < leaves; ++i)
+        {
+            keys.push_back(randomKey(rng));
+            map.addGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE, randomItem(rng, keys.back()));
+        }
+        map.setImmutable();
+
+        std::size_t inner = 0;
+        std::size_t innerTotal = 0;
+        std::size_t leaf = 0;
+        map.visitNodes([&](SHAMapTreeNode& node) {
+            if (node.isInner())
+            {
+                ++inner;
+                innerTotal += innerBytes(
+                    static_cast<SHAMapInnerNode&>(node).getBranchCount());
+            }
+            else
+                ++leaf;
+            return true;
+        });
+        auto const leafTotal = leaf * sizeof(SHAMapAccountStateLeafNode);
+
+        log << "  child pointer: " << sizeof(SharedIntrusive<SHAMapTreeNode>)
+            << " bytes" << std::endl;
+        log << "  " << inner << " inner nodes: " << innerTotal / inner
+            << " bytes per node" << std::endl;
+        log << "  " << leaf << " leaf nodes: "
+            << sizeof(SHAMapAccountStateLeafNode)
+            << " bytes per node, items excluded" << std::endl;
+        log << "  all nodes: " << (innerTotal + leafTotal) / (inner + leaf)
+            << " bytes per node" << std::endl;
+
+        auto lookups = [&](std::size_t threads, bool hit) {
+            std::vector<uint256> probes = keys;
+            if (!hit)
+            {
+                for (auto& key : probes)
+                    key = randomKey(rng);
+            }
+            std::shuffle(probes.begin(), probes.end(), rng);
+
+            std::atomic<std::size_t> found = 0;
+            auto const start = clock_type::now();
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t]() {
+                    std::size_t n = 0;
+                    auto const offset = t * probes.size() / threads;
+                    for (std::size_t i = 0; i < probes.size(); ++i)
+                    {
+                        auto const& key =
+                            probes[(i + offset) % probes.size()];
+                        if (map.peekItem(key))
+                            ++n;
+                    }
+                    found += n;
+                });
+            }
+            for (auto& worker : workers)
+                worker.join();
+            auto const elapsed =
+                duration_cast<microseconds>(clock_type::now() - start);
+
+            BEAST_EXPECT(found == (hit ? threads * probes.size() : 0));
+            log << "  " << (hit ? "found" : "missing") << " keys, " << threads
+                << (threads == 1 ? " thread: " : " threads: ")
+                << threads * probes.size() * 1000 /
+                    std::max<std::int64_t>(1, elapsed.count())
+                << " thousand lookups/s" << std::endl;
+        };
+
+        lookups(1, true);
+        lookups(1, false);
+        auto const threads = std::max(2u, std::thread::hardware_concurrency());
+        lookups(threads, true);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SHAMapNode, shamap, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapNodeBench, shamap, ripple);
+
+}  // namespace tests
+}  // namespace ripple
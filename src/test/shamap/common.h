@@ -34,10 +34,12 @@ class TestNodeFamily : public Family
 private:
     std::unique_ptr<NodeStore::Database> db_;
 
+    // Declared before the caches, which keep a reference to it.
+    TestStopwatch clock_;
+
     std::shared_ptr<FullBelowCache> fbCache_;
     std::shared_ptr<TreeNodeCache> tnCache_;
 
-    TestStopwatch clock_;
     NodeStore::DummyScheduler scheduler_;
 
     beast::Journal const j_;
@@ -125,7 +127,7 @@ public:
         tnCache_->reset();
     }
 
-    beast::manual_clock<std::chrono::steady_clock>
+    TestStopwatch&
     clock()
     {
         return clock_;